@@ -85,6 +85,13 @@ class SWCreateAvatar
          */
         void lastRadialProjection(cv::Mat &oFilteredRadialProj) const;
 
+        /**
+         * @brief Return the temporal mean of the radial projections of the clouds added since the reset, before the
+         *        spatial filtering (live preview of the capture).
+         * @param [out] oRadialProj : radial projection mat (CV_32FC1), empty if no cloud has been added
+         */
+        void currentRadialProjection(cv::Mat &oRadialProj);
+
         /**
          * @brief Return the last face mesh computed.
          * @param [out] oResultMesh : face mesh
@@ -221,6 +228,12 @@ class SWCreateAvatar
 
     private:
 
+        /**
+         * @brief Recompute the running radial projection from the accumulated clouds if the projection parameters
+         *        have been modified since the clouds were added.
+         */
+        void updateRadialProjection();
+
         // parameters
         //  miscellaneous
         bool m_bVerbose;                        /**< enable verbose display info mode */
@@ -263,6 +276,15 @@ class SWCreateAvatar
         swCloud::SWCloud m_oAccumulatedFaceClouds;          /**< addition of all the aligned face clouds  */
         swMesh::SWMesh m_oLastResultFaceMesh;               /**< last face mesh computed */
 
+        // running radial projection
+        swCloud::SWCloudBBox m_oRadialProjBBox;             /**< bbox defining the cylinder of the projection (reference face cloud) */
+        cv::Mat m_oRadialProjSum;                           /**< sum of the radial projections of the added clouds */
+        cv::Mat m_oRadialProjCount;                         /**< number of projected values in each cell */
+        uint m_ui32RadialProjCloudsNb;                      /**< number of clouds in the running projection */
+        int m_i32RadialProjWidth;                           /**< width used for the running projection */
+        int m_i32RadialProjHeight;                          /**< height used for the running projection */
+        float m_fRadialProjRadius;                          /**< cylinder radius used for the running projection */
+
         // detection
         //  haar cascade
         cv::Rect m_oLastRectFace;                           /**< last face rectangle */
@@ -42,6 +42,16 @@
 
 namespace swCloud
 {
+    /**
+     * \brief Devices available for the emicp computing.
+     */
+    enum SWEmicpDevice
+    {
+        EMICP_AUTO_DEVICE,  /**< CUDA if a device is available, else CPU */
+        EMICP_CUDA_DEVICE,  /**< emicp.cu */
+        EMICP_CPU_DEVICE    /**< multithreaded CPU version (emicp_cpu.cpp) */
+    };
+
     /**
      * \class SWAlignClouds
      * \brief Compute alignment between two SWCloud and retrieve the rigid motion.
@@ -103,6 +113,17 @@ namespace swCloud
              */
             void setEmicpParams(cfloat fP2, cfloat fINF, cfloat fFactor, cfloat fD02);
 
+            /**
+             * \brief Set the device used for the emicp computing, the annealing parameters are the same for all the devices.
+             * \param [in] eDevice : EMICP_AUTO_DEVICE (default), EMICP_CUDA_DEVICE or EMICP_CPU_DEVICE
+             */
+            void setEmicpDevice(const SWEmicpDevice eDevice);
+
+            /**
+             * \brief Return the device used for the emicp computing (EMICP_AUTO_DEVICE is resolved at the first alignment).
+             */
+            SWEmicpDevice emicpDevice() const;
+
             /**
              * \brief Parameters used for smooth the rigid motion
              * \param [in] ui32K    : number of previous computed rigidMotion used for temporal filtering on the current result (if == 0, no smoothing will occur)
@@ -159,6 +180,7 @@ namespace swCloud
             float m_fHRot;                                  /**< emipiric value used to compute the rotation smoothing for the rigid motion */
             float m_fHTrans;                                /**< emipiric value used to compute the translation smoothing for the rigid motion */
             registration::registrationParameters m_SParam;  /**< emicp parameters */
+            SWEmicpDevice m_eEmicpDevice;                   /**< emicp device */
 
             // rigid motion
             float m_fRotationMatrix[9];                     /**< rotation matrix  */
@@ -43,6 +43,28 @@ typedef boost::shared_ptr<swDetect::SWFaceDetection> SWFaceDetectionPtr;	/**< bo
 
 namespace swCloud
 {	
+    /**
+     * \struct SWHeadDetection
+     * \brief Result of the detection stage of SWCaptureHeadMotion (see detectHead), input of the alignment stage (see alignHead).
+     */
+    struct SWHeadDetection
+    {
+        /**
+         * \brief SWHeadDetection constructor.
+         */
+        SWHeadDetection() : m_bValid(false), m_ui32FrameId(0), m_i64CaptureTime(0)
+        {}
+
+        bool m_bValid;                              /**< has a face been detected in the frame or in a previous one ? */
+        uint m_ui32FrameId;                         /**< sequence number of the input frame, set by the caller */
+        int64 m_i64CaptureTime;                     /**< capture time of the input frame in us, set by the caller */
+
+        cv::Rect m_oFaceRect;                       /**< face rectangle */
+        cv::Rect m_oNoseRect;                       /**< rectangle around the nose tip, used to build the face cloud */
+        cv::Mat m_oDisplayDetectFace;               /**< face detection display rgb image */
+        boost::shared_ptr<SWCloud> m_pFaceCloud;    /**< face cloud to align (shared to be queued without copy) */
+    };
+
 	/**
 	 * \class SWCaptureHeadMotion
      * \brief Capture Head motion from rgbd device using haarcascade for face detection and emicp to compute the head
@@ -82,11 +104,46 @@ namespace swCloud
             int computeHeadMotion(SWRigidMotion &oHeadRigidMotion, const cv::Mat &oRgb, const cv::Mat &oDepth, cv::Mat &oDisplayDetectFace,
                                   cv::Point3f oNoseTip = cv::Point3f(0.f,0.f,0.f));
 
+            /**
+             * \brief Detection stage of computeHeadMotion : background removal, face and nose detection, nose tip and face cloud.
+             *
+             *  detectHead and alignHead do not share any state, so the detection of a frame can run in a thread while the
+             *  previous frame is aligned in another one. detectHead must always be called from the same thread.
+             *
+             * \param [in] oRgb                 : input rgb image
+             * \param [in] oDepth               : input depth image
+             * \param [out] oDetection          : detection result (m_ui32FrameId and m_i64CaptureTime are not modified)
+             * \return false if no face has been detected since the last reset
+             */
+            bool detectHead(const cv::Mat &oRgb, const cv::Mat &oDepth, SWHeadDetection &oDetection);
+
+            /**
+             * \brief Alignment stage of computeHeadMotion : reference cloud initialization and emicp alignment.
+             *  The first valid detection will init the reference cloud. alignHead must always be called from the same thread.
+             *
+             * \param [out] oHeadRigidMotion    : result computed head rigid motion
+             * \param [in] oDetection           : result of detectHead
+             * \return same values as computeHeadMotion
+             */
+            int alignHead(SWRigidMotion &oHeadRigidMotion, const SWHeadDetection &oDetection);
+
 			/**
              * \brief reset reference cloud
 			 */			
             void reset();
 
+            /**
+             * \brief Reset the face detection state (last face rectangle and face tracking), the reference cloud is kept.
+             *  The next detectHead will run a full face detection.
+             */
+            void resetDetection();
+
+            /**
+             * \brief Set the device used for the emicp alignment (see SWAlignClouds::setEmicpDevice).
+             * \param [in] eDevice : EMICP_AUTO_DEVICE (default), EMICP_CUDA_DEVICE or EMICP_CPU_DEVICE
+             */
+            void setEmicpDevice(const SWEmicpDevice eDevice);
+
             /**
              * @brief setParameters
              * @param [in] dTemplateCoeffReduc  : template cloud coefficient reduction
@@ -137,7 +194,7 @@ namespace swCloud
 
             cv::Rect m_oFaceRectToDisplay;              /**< face rectangle returned by getRect */
             cv::Rect m_oNoseRectToDisplay;              /**< nose rectangle returned by getRect */
-            cv::Rect m_oLastDetectedRectFace;           /**< last detected face rectangle */
+            cv::Rect m_oLastDetectedRectFace;           /**< last detected face rectangle (detection stage) */
 
             swCloud::SWRigidMotion m_oLastRigidMotion;
 
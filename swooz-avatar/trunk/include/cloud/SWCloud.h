@@ -80,6 +80,8 @@
 //! namespace for classes based on the use of SWCloud
 namespace swCloud
 {
+    class SWCloudKdTree;
+
 	/**
 	 * \struct SWCloudBBox
 	 * \brief Defines a Cloud point bbox.
@@ -548,21 +550,25 @@ namespace swCloud
 			bool transform(cfloat *m_aFRotationMatrix, cfloat *m_aFTranslationMatrix);
 			
 			/**
-             * \brief compute a "distanc" value of the cloud from the input cloud
-			 * \param [in] oCloud          : input cloud
-             * \param [in] bReduce         : reduce the cloud ?
-			 * \param [in] ui32CoeffReduce : reduce factor of the cloud
-			 * \return the square distance mean	 
+             * \brief compute a "distance" value of the cloud from the input cloud : the mean of the square distances between
+             *        each point of the input cloud and its nearest point in this cloud.
+             *        The result does not depend on the number of threads.
+			 * \param [in] oCloud           : input cloud
+             * \param [in] bReduce          : reduce the input cloud ?
+             * \param [in] ui32CoeffReduce  : reduce factor of the input cloud, one point out of ui32CoeffReduce is used
+             * \param [in] bUseSpatialIndex : use the spatial index of this cloud instead of a brute force scan
+             *                                (worth it when this cloud is not modified between several calls)
+			 * \return the square distance mean, -1.f if one of the clouds is empty (a distance is never negative)
 			 */				
-			float squareDistanceCloud(const SWCloud &oCloud, cbool bReduce = false, cfloat ui32CoeffReduce = 50);
+            float squareDistanceCloud(const SWCloud &oCloud, cbool bReduce = false, cfloat ui32CoeffReduce = 50, cbool bUseSpatialIndex = false) const;
 			
 			/**
-			 * \brief get the distance of the point from the cloud
+			 * \brief get the square distance of the point from the cloud (brute force, SSE kernel)
 			 * \param [in] oCloud       : input cloud
-			 * \param [in] ui32IndiceP  : index of hte point
+			 * \param [in] ui32IndiceP  : index of the point
 			 * \return the square distance		 
 			 */				
-			float squareDistancePoint(const SWCloud &oCloud, cuint ui32IndiceP);
+            float squareDistancePoint(const SWCloud &oCloud, cuint ui32IndiceP) const;
 			
 			/**
 			 * \brief Move the SWCloud to the origin by computing a vector with the origin and the mean point of the SWCloud
@@ -612,10 +618,73 @@ namespace swCloud
 			
             /**
              * \brief Compute the id of the nearest cloud point from the input point.
-             * \param [in] oPt : point to compare
+             * \param [in] oPt      : point to compare
+             * \param [in] fDistMin : if not 0, the points closer than this distance are not considered
              * \return the id of the nearset cloud point.
              */
             int idNearestPoint(const std::vector<float> &oPt, cfloat fDistMin = 0.f) const;
+
+            /**
+             * \brief Compute the id of the nearest cloud point from the input point.
+             * \param [in] a3FPt    : point to compare [x,y,z]
+             * \param [in] fDistMin : if not 0, the points closer than this distance are not considered
+             * \return the id of the nearset cloud point.
+             */
+            int idNearestPoint(cfloat *a3FPt, cfloat fDistMin = 0.f) const;
+
+            /**
+             * \brief Compute for each point of the input cloud the id of the nearest point of the current cloud (computed in parallel).
+             * \param [in] oQueryCloud  : points to compare
+             * \param [out] vIds        : ids of the nearest points, one by point of oQueryCloud
+             * \param [in] fDistMin     : if not 0, the points closer than this distance are not considered
+             */
+            void idNearestPoints(const SWCloud &oQueryCloud, std::vector<int> &vIds, cfloat fDistMin = 0.f) const;
+
+            /**
+             * \brief Compute the ids of the k nearest cloud points from the input point, sorted by increasing distance.
+             * \param [in] oPt          : point to compare
+             * \param [in] ui32K        : number of points to retrieve
+             * \param [out] vIds        : ids of the points
+             * \param [out] vSquareDists: square distances of the points
+             */
+            void kNearestPoints(const std::vector<float> &oPt, cuint ui32K, std::vector<int> &vIds, std::vector<float> &vSquareDists) const;
+
+            /**
+             * \brief Compute for each point of the input cloud the ids of the k nearest points of the current cloud (computed in parallel).
+             * \param [in] oQueryCloud  : points to compare
+             * \param [in] ui32K        : number of points to retrieve
+             * \param [out] vIds        : ids of the points, k values by point of oQueryCloud sorted by increasing distance,
+             *                            filled with -1 if the current cloud has less than k points
+             */
+            void kNearestPoints(const SWCloud &oQueryCloud, cuint ui32K, std::vector<int> &vIds) const;
+
+            /**
+             * \brief Compute the ids of all the cloud points inside the input sphere, sorted by increasing distance.
+             * \param [in] oPt          : center of the sphere
+             * \param [in] fRadius      : radius of the sphere
+             * \param [out] vIds        : ids of the points
+             */
+            void pointsInRadius(const std::vector<float> &oPt, cfloat fRadius, std::vector<int> &vIds) const;
+
+            /**
+             * \brief Compute for each point of the input cloud the ids of the points of the current cloud inside the sphere centered on it (computed in parallel).
+             * \param [in] oQueryCloud  : centers of the spheres
+             * \param [in] fRadius      : radius of the spheres
+             * \param [out] vIds        : ids of the points, one array by point of oQueryCloud
+             */
+            void pointsInRadius(const SWCloud &oQueryCloud, cfloat fRadius, std::vector<std::vector<int> > &vIds) const;
+
+            /**
+             * \brief Build the spatial index used by the nearest points queries if it doesn't exist.
+             *        The queries build it when needed, it must be called before using the same cloud in several threads.
+             */
+            void buildSpatialIndex() const;
+
+            /**
+             * \brief Delete the spatial index, it will be rebuilt by the next query.
+             *        The methods of SWCloud modifying the points call it, it must be called after modifying the points directly with coord().
+             */
+            void invalidateSpatialIndex() const;
 			
             static int m_i32NumberOfCreatedClouds;	/**< DEBUG : number of cloud created since the launch of the program */
 			
@@ -632,6 +701,8 @@ namespace swCloud
             uint8 *m_aUi8Colors;        /**< pointer on the color of the points
                                         [R1, R2, ..., Rn, G1, ..., Gn, B1, ..., Bn] */
 
+            mutable SWCloudKdTree *m_pKdTree; /**< spatial index of the points, NULL if not built or invalidated */
+
 //            bool m_bBuffersComputed;
 //            int *m_aI32IntedxBuffer;
 //            float *m_aFVertexBuffer;
@@ -0,0 +1,133 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWCloudKdTree.h
+ * \brief defines SWCloudKdTree, a spatial index used for the nearest points queries of SWCloud
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#ifndef _SWCLOUDKDTREE_
+#define _SWCLOUDKDTREE_
+
+#include "commonTypes.h"
+
+#include <vector>
+
+namespace swCloud
+{
+    /**
+     * \class SWCloudKdTree
+     * \brief Static 3D k-d tree.
+     *        The nodes are stored in depth first order in a single array and the points of each leaf are copied
+     *        contiguously as [x,y,z] triplets, so a query only reads a few cache lines per visited leaf.
+     *        The tree is not updated when the points move, it must be rebuilt.
+     * \author Florian Lance
+     * \date 16/10/26
+     */
+    class SWCloudKdTree
+    {
+        public :
+
+            // ############################################# CONSTRUCTORS / DESTRUCTORS
+
+            /**
+             * \brief Default constructor of SWCloudKdTree
+             */
+            SWCloudKdTree();
+
+            // ############################################# METHODS
+
+            /**
+             * \brief Build the tree from a SWCloud coordinates array.
+             * \param [in] ui32PointsNb : number of points
+             * \param [in] aFCoords     : coordinates of the points [x1, x2, ..., xn, y1, ..., yn, z1, ...,zn]
+             * \param [in] ui32LeafSize : maximum number of points in a leaf
+             */
+            void build(cuint ui32PointsNb, cfloat *aFCoords, cuint ui32LeafSize = 16);
+
+            /**
+             * \brief Return the number of points of the tree.
+             */
+            uint size() const;
+
+            /**
+             * \brief Compute the id of the nearest point. When several points are at the same distance, the lowest id is returned.
+             * \param [in] a3FPt        : point to compare [x,y,z]
+             * \param [in] fDistMin     : if not 0, the points closer than this distance are not considered
+             * \param [out] pFSquareDist: if not NULL, the square distance of the nearest point
+             * \return the id of the nearest point, -1 if there is no valid point
+             */
+            int nearest(cfloat *a3FPt, cfloat fDistMin = 0.f, float *pFSquareDist = NULL) const;
+
+            /**
+             * \brief Compute the ids of the k nearest points, sorted by increasing distance.
+             * \param [in] a3FPt         : point to compare [x,y,z]
+             * \param [in] ui32K         : number of points to retrieve
+             * \param [out] vIds         : ids of the points (less than k if the tree is smaller)
+             * \param [out] vSquareDists : square distances of the points
+             */
+            void kNearest(cfloat *a3FPt, cuint ui32K, std::vector<int> &vIds, std::vector<float> &vSquareDists) const;
+
+            /**
+             * \brief Compute the ids of all the points inside the input sphere, sorted by increasing distance.
+             * \param [in] a3FPt         : center of the sphere [x,y,z]
+             * \param [in] fRadius       : radius of the sphere
+             * \param [out] vIds         : ids of the points
+             * \param [out] vSquareDists : square distances of the points
+             */
+            void radius(cfloat *a3FPt, cfloat fRadius, std::vector<int> &vIds, std::vector<float> &vSquareDists) const;
+
+        private :
+
+            /**
+             * \struct SWKdNode
+             * \brief Node of the tree, the left child is always the next node in the array.
+             */
+            struct SWKdNode
+            {
+                int m_i32Dim;       /**< split dimension, -1 for a leaf */
+                float m_fSplit;     /**< split value */
+                int m_i32Begin;     /**< first point of the node */
+                int m_i32End;       /**< last point of the node + 1 */
+                int m_i32Right;     /**< id of the right child */
+            };
+
+            /**
+             * \brief Build recursively the node containing the points [i32Begin, i32End) of m_vIds.
+             * \return the id of the node
+             */
+            int buildNode(cfloat *aFCoords, cint i32Begin, cint i32End);
+
+            uint m_ui32PointsNb;            /**< number of points */
+            uint m_ui32LeafSize;            /**< maximum number of points in a leaf */
+            std::vector<SWKdNode> m_vNodes; /**< nodes in depth first order */
+            std::vector<float> m_vPoints;   /**< points coordinates in the tree order [x1,y1,z1,x2,...] */
+            std::vector<int> m_vIds;        /**< cloud id of the points in the tree order */
+    };
+}
+
+#endif
@@ -38,6 +38,11 @@
 #include <math.h>
 #include <stack>
 
+#if defined(_M_X64) || defined(__SSE2__)
+    #define SW_RADIAL_PROJ_SSE
+    #include <emmintrin.h>
+#endif
+
 // swooz
 #include "commonTypes.h"
 #include "cloud/SWCloud.h"
@@ -262,159 +267,244 @@ namespace swCloud
         }
     }
 
+#ifdef SW_RADIAL_PROJ_SSE
+
     /**
-     * \brief  Project the points of a SWCloud on a cylinder and put the result in a mat gray image
+     * \brief  Compute the angle around the axe in [0, 2pi[ of 4 points : atan2f(fDX, fDZ) brought in [0, 2pi[.
+     *
+     *  atan(dx/dz) uses the cephes atanf range reduction and polynomial (error of a few float ulps), dz < 0 adds pi,
+     *  a negative angle with dz >= 0 adds 2pi. The angle of a point on the axe (0/0) is 0, as atan2f.
+     */
+    static inline __m128 radialProjAngle_ps(const __m128 fDX, const __m128 fDZ)
+    {
+        const __m128 l_oSignMask = _mm_set1_ps(-0.f);
+        const __m128 l_oOne      = _mm_set1_ps(1.f);
+
+        // atan(|x|) with x = dx/dz
+            __m128 x      = _mm_div_ps(fDX, fDZ);
+            __m128 l_oSign = _mm_and_ps(x, l_oSignMask);
+            x = _mm_andnot_ps(l_oSignMask, x);
+
+            __m128 l_oBig = _mm_cmpgt_ps(x, _mm_set1_ps(2.414213562373095f));                              // x > tan(3pi/8)
+            __m128 l_oMid = _mm_andnot_ps(l_oBig, _mm_cmpgt_ps(x, _mm_set1_ps(0.4142135623730950f)));      // x > tan(pi/8)
+
+            __m128 l_oOffset = _mm_or_ps(_mm_and_ps(l_oBig, _mm_set1_ps(0.5f * (float)M_PI)), _mm_and_ps(l_oMid, _mm_set1_ps(0.25f * (float)M_PI)));
+            __m128 l_oXBig   = _mm_div_ps(_mm_set1_ps(-1.f), x);
+            __m128 l_oXMid   = _mm_div_ps(_mm_sub_ps(x, l_oOne), _mm_add_ps(x, l_oOne));
+            x = _mm_or_ps(_mm_and_ps(l_oBig, l_oXBig), _mm_andnot_ps(l_oBig, _mm_or_ps(_mm_and_ps(l_oMid, l_oXMid), _mm_andnot_ps(l_oMid, x))));
+
+            __m128 z = _mm_mul_ps(x, x);
+            __m128 y = _mm_set1_ps(8.05374449538e-2f);
+            y = _mm_sub_ps(_mm_mul_ps(y, z), _mm_set1_ps(1.38776856032E-1f));
+            y = _mm_add_ps(_mm_mul_ps(y, z), _mm_set1_ps(1.99777106478E-1f));
+            y = _mm_sub_ps(_mm_mul_ps(y, z), _mm_set1_ps(3.33329491539E-1f));
+            y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, z), x), x), l_oOffset);
+
+        // atan(x) in [-pi/2, pi/2] brought in [0, 2pi[
+            __m128 l_oAtan  = _mm_or_ps(y, l_oSign);
+            __m128 l_oDZNeg = _mm_cmplt_ps(fDZ, _mm_setzero_ps());
+            __m128 l_oAdd   = _mm_or_ps(_mm_and_ps(l_oDZNeg, _mm_set1_ps((float)M_PI)),
+                                        _mm_andnot_ps(l_oDZNeg, _mm_and_ps(_mm_cmplt_ps(l_oAtan, _mm_setzero_ps()), _mm_set1_ps(2.f * (float)M_PI))));
+            __m128 l_oAlpha = _mm_add_ps(l_oAtan, l_oAdd);
+
+        return _mm_and_ps(l_oAlpha, _mm_cmpord_ps(l_oAlpha, l_oAlpha)); // 0/0 -> 0
+    }
+
+#endif
+
+    /**
+     * \brief  Compute the cell of the radial projection image and the gray value of each point of a SWCloud.
+     *
+     *  The cylinder axe is vertical and goes through (center x, min y, min z + 0.1) of the bbox. The column of a point
+     *  is its angle around the axe (from +z toward +x), its row its height and its value its distance to the axe
+     *  (0 on the axe, 255 on the cylinder). The points are independent : the loop works on the coordinates arrays
+     *  and is shared between the threads, with SSE2 4 points are computed at once (radialProjAngle_ps for the angle,
+     *  the cell id is computed in float, exact for images up to 2^24 cells).
      * \param  [in] oCloud            : input SWCloud to project
-     * \param  [in] oGrayImageResult  : result mat gray image
-     * \param  [in] oCloudTemp        : cloud containing projected points on the cylinder and on the axe
-     * \param  [in] sBBox             : ...
-     * \param  [in] ui32WidthImage    : width of the result image
-     * \param  [in] ui32HeightImage   : height of the result image
+     * \param  [in] sBBox             : bbox defining the cylinder axe and the height of the image
+     * \param  [in] ui32WidthImage    : width of the image
+     * \param  [in] ui32HeightImage   : height of the image
      * \param  [in] fCylinderRadius   : radius of the cylinder
+     * \param  [out] vI32Cells        : id of the cell of each point in the image, -1 if the point is outside
+     * \param  [out] vFValues         : gray value of each point
      */
-    static void radialProjCloudOnMat(const SWCloud &oCloud, cv::Mat &oGrayImageResult, SWCloud &oCloudTemp, const SWCloudBBox &sBBox,
-                     cuint32 ui32WidthImage = 800, cuint32 ui32HeightImage = 400, cfloat fCylinderRadius = 0.3f) // , cv::Mat &oProjectedResult
+    static void radialProjCloudCells(const SWCloud &oCloud, const SWCloudBBox &sBBox, cuint32 ui32WidthImage, cuint32 ui32HeightImage,
+                                     cfloat fCylinderRadius, std::vector<int> &vI32Cells, std::vector<float> &vFValues)
     {
-        float l_fDistToUse, l_fAngleToAdd;
+        cint l_i32PointsNb = static_cast<int>(oCloud.size());
+        cint l_i32Width    = static_cast<int>(ui32WidthImage);
+        cint l_i32Height   = static_cast<int>(ui32HeightImage);
 
-        // defines distances bewteen current point and reference points
-            float l_fDistCRef1, l_fDistCRef2, l_fDistCRef3, l_fDistCRef4;
-            float l_fMinDist = FLT_MAX, l_fMaxDist = 0.f, l_fCurrDist;
+        vI32Cells.resize(l_i32PointsNb);
+        vFValues.resize(l_i32PointsNb);
 
-        // defines vectors
-            cv::Vec3f l_oAxeVector(0.f, 1.f, 0.f), l_oCurrPoint, l_oCurrVector, l_oNormCurrVector;
-            cv::Vec3f l_oAxePoint, l_oProjectedOnAxePoint, l_oProjectedOnCylinderPoint;
-            cv::Vec3f l_oCurrRefProjectedOnCylinderPoint1, l_oCurrRefProjectedOnCylinderPoint2;
-            cv::Vec3f l_oCurrRefProjectedOnCylinderPoint3, l_oCurrRefProjectedOnCylinderPoint4;
-
-        // defines display cloud vectors (temp)
-//             std::vector<float> l_vFX,  l_vFY,  l_vFZ;
-//             std::vector<float> l_vFX2, l_vFY2, l_vFZ2;
-//             std::vector<float> l_vFX3, l_vFY3, l_vFZ3;
-//             std::vector<float> l_vFX4, l_vFY4, l_vFZ4;
-//             std::vector<float> l_vFX5, l_vFY5, l_vFZ5;
-//             std::vector<float> l_vFX6, l_vFY6, l_vFZ6;
+        if(l_i32PointsNb == 0)
+        {
+            return;
+        }
 
+        const float *l_aFX = oCloud.coord(0);
+        const float *l_aFY = oCloud.coord(1);
+        const float *l_aFZ = oCloud.coord(2);
 
-        // init cylinder axe point
-            l_oAxePoint[0] = 0.5f * (sBBox.m_fMinX + sBBox.m_fMaxX);
-            l_oAxePoint[1] = sBBox.m_fMinY;
-            l_oAxePoint[2] = sBBox.m_fMinZ + 0.1f;//0.5f * (sBBox.m_fMinZ + sBBox.m_fMaxZ);
-            l_fMinDist = 0.f;
-            l_fMaxDist = fCylinderRadius;
+        // cylinder axe and scales
+            cfloat l_fAxeX        = 0.5f * (sBBox.m_fMinX + sBBox.m_fMaxX);
+            cfloat l_fAxeZ        = sBBox.m_fMinZ + 0.1f;
+            cfloat l_fMinY        = sBBox.m_fMinY;
+            cfloat l_fRowScale    = ui32HeightImage / check0Div(sBBox.m_fMaxY - sBBox.m_fMinY);
+            cfloat l_fColScale    = ui32WidthImage / (2.f * (float)M_PI);
+            cfloat l_fValueScale  = 255.f / check0Div(fCylinderRadius);
 
-        // init result mat
-            float l_fMaxHeight = (sBBox.m_fMaxY - sBBox.m_fMinY);
+        int *l_aI32Cells  = &vI32Cells[0];
+        float *l_aFValues = &vFValues[0];
+        int l_i32FirstScalar = 0;
 
-        // cv::Mat l_oProjectedMat(ui32HeightImage, ui32WidthImage, CV_8UC1);
-            cv::Mat l_oProjectedMat(ui32HeightImage, ui32WidthImage , CV_32FC1);
+#ifdef SW_RADIAL_PROJ_SSE
+        cint l_i32BlocksNb = l_i32PointsNb / 4;
+        l_i32FirstScalar   = 4 * l_i32BlocksNb;
 
-        // set the mat to 0
-            cv::Scalar l_oScalInit;
-            l_oScalInit[0] = 0.f;
-            l_oProjectedMat = l_oScalInit;
-
-        for(uint ii = 0; ii < oCloud.size(); ++ii)
+        #pragma omp parallel for
+        for(int ib = 0; ib < l_i32BlocksNb; ++ib)
         {
-            // retrieve current point
-                l_oCurrPoint[0] = oCloud.coord(0)[ii];
-                l_oCurrPoint[1] = oCloud.coord(1)[ii];
-                l_oCurrPoint[2] = oCloud.coord(2)[ii];
-
-            // project the current point on the cylinder axe
-                l_oProjectedOnAxePoint = projectOnAxe(l_oCurrPoint, l_oAxePoint, l_oAxeVector);
+            cint ii = 4 * ib;
 
-            // init of the current vector
-                l_oCurrVector = l_oCurrPoint - l_oProjectedOnAxePoint;
-                cv::normalize(l_oCurrVector, l_oNormCurrVector);
-                l_oProjectedOnCylinderPoint = l_oProjectedOnAxePoint + fCylinderRadius * l_oNormCurrVector;
+            __m128 l_oDX    = _mm_sub_ps(_mm_loadu_ps(l_aFX + ii), _mm_set1_ps(l_fAxeX));
+            __m128 l_oDZ    = _mm_sub_ps(_mm_loadu_ps(l_aFZ + ii), _mm_set1_ps(l_fAxeZ));
+            __m128 l_oAlpha = radialProjAngle_ps(l_oDX, l_oDZ);
 
-                l_fCurrDist = (float)cv::norm(l_oCurrVector);
+            const __m128i l_oHeight = _mm_set1_epi32(l_i32Height);
+            __m128i l_oRow = _mm_sub_epi32(l_oHeight, _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(l_aFY + ii), _mm_set1_ps(l_fMinY)), _mm_set1_ps(l_fRowScale))));
+            l_oRow = _mm_add_epi32(l_oRow, _mm_cmpeq_epi32(l_oRow, l_oHeight)); // row == height -> height - 1
+            __m128i l_oCol = _mm_cvttps_epi32(_mm_mul_ps(l_oAlpha, _mm_set1_ps(l_fColScale)));
 
-            // defines ref points
-                l_oCurrRefProjectedOnCylinderPoint1 = l_oProjectedOnAxePoint;
-                l_oCurrRefProjectedOnCylinderPoint1[2] += fCylinderRadius;
+            __m128i l_oInside = _mm_and_si128(_mm_andnot_si128(_mm_cmplt_epi32(l_oRow, _mm_setzero_si128()), _mm_cmplt_epi32(l_oRow, l_oHeight)),
+                                              _mm_andnot_si128(_mm_cmplt_epi32(l_oCol, _mm_setzero_si128()), _mm_cmplt_epi32(l_oCol, _mm_set1_epi32(l_i32Width))));
+            __m128i l_oCell   = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(l_oRow), _mm_set1_ps((float)l_i32Width)), _mm_cvtepi32_ps(l_oCol)));
+            l_oCell = _mm_or_si128(_mm_and_si128(l_oInside, l_oCell), _mm_andnot_si128(l_oInside, _mm_set1_epi32(-1)));
 
-                l_oCurrRefProjectedOnCylinderPoint2 = l_oProjectedOnAxePoint;
-                l_oCurrRefProjectedOnCylinderPoint2[0] += fCylinderRadius;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(l_aI32Cells + ii), l_oCell);
+            _mm_storeu_ps(l_aFValues + ii, _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(l_oDX, l_oDX), _mm_mul_ps(l_oDZ, l_oDZ))), _mm_set1_ps(l_fValueScale)));
+        }
+#endif
 
-                l_oCurrRefProjectedOnCylinderPoint3 = l_oProjectedOnAxePoint;
-                l_oCurrRefProjectedOnCylinderPoint3[2] -= fCylinderRadius;
+        // remaining points, all the points without SSE2
+        #pragma omp parallel for
+        for(int ii = l_i32FirstScalar; ii < l_i32PointsNb; ++ii)
+        {
+            float l_fDX = l_aFX[ii] - l_fAxeX;
+            float l_fDZ = l_aFZ[ii] - l_fAxeZ;
 
-                l_oCurrRefProjectedOnCylinderPoint4 = l_oProjectedOnAxePoint;
-                l_oCurrRefProjectedOnCylinderPoint4[0] -= fCylinderRadius;
+            // angle around the axe in [0, 2pi[
+            float l_fAlpha = atan2f(l_fDX, l_fDZ);
+            if(l_fAlpha < 0.f)
+            {
+                l_fAlpha += 2.f * (float)M_PI;
+            }
 
-            // add points to display cloud vectors
-//                l_vFX.push_back(l_oProjectedOnCylinderPoint[0]);
-//                l_vFY.push_back(l_oProjectedOnCylinderPoint[1]);
-//                l_vFZ.push_back(l_oProjectedOnCylinderPoint[2]);
+            int l_i32Row = l_i32Height - (int)((l_aFY[ii] - l_fMinY) * l_fRowScale);
+            if(l_i32Row == l_i32Height)
+            {
+                --l_i32Row;
+            }
+            int l_i32Col = (int)(l_fAlpha * l_fColScale);
 
-//                l_vFX2.push_back(l_oProjectedOnAxePoint[0]);
-//                l_vFY2.push_back(l_oProjectedOnAxePoint[1]);
-//                l_vFZ2.push_back(l_oProjectedOnAxePoint[2]);
+            l_aI32Cells[ii] = (l_i32Row >= 0 && l_i32Row < l_i32Height && l_i32Col >= 0 && l_i32Col < l_i32Width) ? l_i32Row * l_i32Width + l_i32Col : -1;
+            l_aFValues[ii]  = sqrtf(l_fDX*l_fDX + l_fDZ*l_fDZ) * l_fValueScale;
+        }
+    }
 
+    /**
+     * \brief  Project the points of a SWCloud on a cylinder and put the result in a mat gray image
+     * \param  [in] oCloud            : input SWCloud to project
+     * \param  [in] oGrayImageResult  : result mat gray image
+     * \param  [in] oCloudTemp        : unused
+     * \param  [in] sBBox             : bbox defining the cylinder axe and the height of the image
+     * \param  [in] ui32WidthImage    : width of the result image
+     * \param  [in] ui32HeightImage   : height of the result image
+     * \param  [in] fCylinderRadius   : radius of the cylinder
+     */
+    static void radialProjCloudOnMat(const SWCloud &oCloud, cv::Mat &oGrayImageResult, SWCloud &oCloudTemp, const SWCloudBBox &sBBox,
+                     cuint32 ui32WidthImage = 800, cuint32 ui32HeightImage = 400, cfloat fCylinderRadius = 0.3f)
+    {
+        std::vector<int> l_vI32Cells;
+        std::vector<float> l_vFValues;
+        radialProjCloudCells(oCloud, sBBox, ui32WidthImage, ui32HeightImage, fCylinderRadius, l_vI32Cells, l_vFValues);
 
-            // set the current distances
-                l_fDistCRef1 = (float)cv::norm(l_oCurrRefProjectedOnCylinderPoint1 - l_oProjectedOnCylinderPoint);
-                l_fDistCRef2 = (float)cv::norm(l_oCurrRefProjectedOnCylinderPoint2 - l_oProjectedOnCylinderPoint);
-                l_fDistCRef3 = (float)cv::norm(l_oCurrRefProjectedOnCylinderPoint3 - l_oProjectedOnCylinderPoint);
-                l_fDistCRef4 = (float)cv::norm(l_oCurrRefProjectedOnCylinderPoint4 - l_oProjectedOnCylinderPoint);
+        // when several points fall in the same cell, the last one is kept
+            cv::Mat l_oProjectedMat = cv::Mat::zeros(ui32HeightImage, ui32WidthImage , CV_32FC1);
+            float *l_aFProjected = l_oProjectedMat.ptr<float>(0);
 
-                if(l_fDistCRef1  < l_fDistCRef3)
-                {
-                    if(l_fDistCRef2 < l_fDistCRef4)
-                    {
-                        l_fDistToUse = l_fDistCRef1;
-                        l_fAngleToAdd = 0.f;
-                    }
-                    else
-                    {
-                        l_fDistToUse = l_fDistCRef4;
-                        l_fAngleToAdd = 270.f;
-                    }
-                }
-                else
+            for(uint ii = 0; ii < l_vI32Cells.size(); ++ii)
+            {
+                if(l_vI32Cells[ii] >= 0)
                 {
-                    if(l_fDistCRef2 < l_fDistCRef4)
-                    {
-                        l_fDistToUse = l_fDistCRef2;
-                        l_fAngleToAdd = 90.f;
-                    }
-                    else
-                    {
-                        l_fDistToUse = l_fDistCRef3;
-                        l_fAngleToAdd = 180.f;
-                    }
+                    l_aFProjected[l_vI32Cells[ii]] = l_vFValues[ii];
                 }
+            }
 
-            // compute the current angle
-                float l_fAlpha = asin( (l_fDistToUse/2.f)/check0Div(fCylinderRadius)); // compute alpha rad value
-                l_fAlpha *= 360.f / (float)M_PI; ; // conv rad to deg and add the good angle
-                l_fAlpha += l_fAngleToAdd;
+        // set the projected mat
+            oGrayImageResult = l_oProjectedMat;
+    }
 
-                float l_fGrayValue =  (l_fCurrDist - l_fMinDist)/check0Div(l_fMaxDist - l_fMinDist);
+    /**
+     * \brief  Project the points of a SWCloud on a cylinder and add the result to a running projection, the mean of
+     *         the running projection is the temporal filtering of the projections of all the added clouds.
+     * \param  [in] oCloud              : input SWCloud to project
+     * \param  [in,out] oSumMat         : sum of the values of each cell (CV_32FC1), allocated at the first call
+     * \param  [in,out] oCountMat       : number of clouds with a value in each cell (CV_32FC1), allocated at the first call
+     * \param  [in] sBBox               : bbox defining the cylinder axe and the height of the image
+     * \param  [in] ui32WidthImage      : width of the image
+     * \param  [in] ui32HeightImage     : height of the image
+     * \param  [in] fCylinderRadius     : radius of the cylinder
+     */
+    static void accumulateRadialProjCloud(const SWCloud &oCloud, cv::Mat &oSumMat, cv::Mat &oCountMat, const SWCloudBBox &sBBox,
+                     cuint32 ui32WidthImage = 800, cuint32 ui32HeightImage = 400, cfloat fCylinderRadius = 0.3f)
+    {
+        if(oSumMat.rows != (int)ui32HeightImage || oSumMat.cols != (int)ui32WidthImage)
+        {
+            oSumMat   = cv::Mat::zeros(ui32HeightImage, ui32WidthImage, CV_32FC1);
+            oCountMat = cv::Mat::zeros(ui32HeightImage, ui32WidthImage, CV_32FC1);
+        }
 
-                uint l_ii = ui32HeightImage - (int)((l_oCurrPoint[1] - sBBox.m_fMinY) * ((ui32HeightImage)/check0Div(l_fMaxHeight)));
-                if(l_ii == ui32HeightImage) // TODO : recompute values to write
-                    l_ii--;
+        cv::Mat l_oProjectedMat;
+        SWCloud l_oUnused;
+        radialProjCloudOnMat(oCloud, l_oProjectedMat, l_oUnused, sBBox, ui32WidthImage, ui32HeightImage, fCylinderRadius);
 
-            // projection image
-                uint l_jj = (int)(((ui32WidthImage)/360.f)*l_fAlpha);
-                l_oProjectedMat.at<float>(l_ii, l_jj) = l_fGrayValue*255.f;
+        const float *l_aFProjected = l_oProjectedMat.ptr<float>(0);
+        float *l_aFSum   = oSumMat.ptr<float>(0);
+        float *l_aFCount = oCountMat.ptr<float>(0);
+
+        for(int ii = 0; ii < l_oProjectedMat.rows * l_oProjectedMat.cols; ++ii)
+        {
+            if(l_aFProjected[ii] > 0.f)
+            {
+                l_aFSum[ii]   += l_aFProjected[ii];
+                l_aFCount[ii] += 1.f;
+            }
         }
+    }
 
-        // set clouds to display (temp)
-//             SWCloud newCloud(l_vFX, l_vFY, l_vFZ);
-//             SWCloud newCloud1(l_vFX2, l_vFY2, l_vFZ2);
-//             newCloud.setUnicolor(255,215,0);
-//             newCloud1.setUnicolor(0,32,144);
-//             newCloud += newCloud1;
-//             oCloudTemp.copy(newCloud);
+    /**
+     * \brief  Compute the mean of a running projection.
+     * \param  [in] oSumMat       : sum of the values of each cell (CV_32FC1)
+     * \param  [in] oCountMat     : number of clouds with a value in each cell (CV_32FC1)
+     * \param  [out] oMeanMat     : mean value of each cell, 0 if no value (CV_32FC1)
+     */
+    static void meanRadialProj(const cv::Mat &oSumMat, const cv::Mat &oCountMat, cv::Mat &oMeanMat)
+    {
+        oMeanMat = cv::Mat::zeros(oSumMat.rows, oSumMat.cols, CV_32FC1);
 
-//             swCloud::SWVisualizeCloud l_oVisualizeCloud2(oCloudTemp,true);
+        const float *l_aFSum   = oSumMat.ptr<float>(0);
+        const float *l_aFCount = oCountMat.ptr<float>(0);
+        float *l_aFMean        = oMeanMat.ptr<float>(0);
 
-        // set the projected mat
-            oGrayImageResult = l_oProjectedMat;
+        for(int ii = 0; ii < oSumMat.rows * oSumMat.cols; ++ii)
+        {
+            if(l_aFCount[ii] > 0.f)
+            {
+                l_aFMean[ii] = l_aFSum[ii] / l_aFCount[ii];
+            }
+        }
     }
 
     /**
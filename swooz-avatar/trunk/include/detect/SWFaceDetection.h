@@ -36,6 +36,7 @@
 
 #include "boost/shared_ptr.hpp"
 #include "detect/SWHaarCascade.h"
+#include "track/SWTrackFlow.h"
 
 #include "opencvUtility.h"
 
@@ -89,6 +90,29 @@ namespace swDetect
              */
             bool detectFace(const cv::Mat &oRgbImg);
 
+            /**
+             * \brief Detect or track one face in a sequence of images.
+             *
+             *  The face rectangle is followed with the pyramidal optical flow of features points between two haar cascade
+             *  detections. The cascade runs every "detection period" frames or when the tracking is lost, first in a region
+             *  around the last face rectangle and then in the whole image if the face is not found.
+             *
+             * \param [in] oRgbImg : input rgb image, the next image of the sequence given to the previous call
+             * \return false if no face has been detected or tracked, else return true (see faceRect)
+             */
+            bool trackFace(const cv::Mat &oRgbImg);
+
+            /**
+             * \brief Set the number of frames between two haar cascade detections in trackFace (1 : detection at each frame).
+             * \param [in] i32FramesNb : detection period
+             */
+            void setDetectionPeriod(cint i32FramesNb);
+
+            /**
+             * \brief Reset the tracking, the next call of trackFace will run a detection in the whole image.
+             */
+            void resetTracking();
+
             /**
             * @brief Detect one nose with haar cascade
             * @param [in] oRgbImg : input rgb image
@@ -133,6 +157,29 @@ namespace swDetect
 				
 		private:
 
+            /**
+             * \brief Detect one face with haar cascade in a part of the image.
+             * \param [in] oRgbImg : input rgb image
+             * \param [in] oRoi    : part of the image where the face is searched
+             * \return if no face detected return false, else return true
+             */
+            bool detectFaceInRoi(const cv::Mat &oRgbImg, const cv::Rect &oRoi);
+
+            /**
+             * \brief Move the last face rectangle with the optical flow of its features points.
+             * \param [in] oGrayImg : current gray image
+             * \return false if the tracking is lost
+             */
+            bool trackFaceFlow(const cv::Mat &oGrayImg);
+
+            /**
+             * \brief Check if a haar cascade face rectangle is in the central part of the image defined by the detection ratios.
+             * \param [in] oFaceRect : face rectangle before its resizing
+             * \param [in] oImgSize  : size of the image
+             * \return true if the rectangle is inside this part
+             */
+            bool isInDetectionArea(const cv::Rect &oFaceRect, const cv::Size &oImgSize) const;
+
             bool m_bVerbose;                        /**< display verbose info */
             bool m_bHaarCascadeFilesLoaded;         /**< are the haar cascade files loaded */
 				
@@ -152,6 +199,7 @@ namespace swDetect
             cv::Size    m_oMaxDetectNoseSize;       /**< maximum size of the detected nose */
 
             cv::Rect m_oLastDetectFace;             /**< last detected face rectangle */
+            cv::Rect m_oLastHaarFace;               /**< last face rectangle before its resizing, moved by the tracking */
             cv::Rect m_oLastDetectNose;             /**< last detected nose rectangle */
             std::vector<cv::Rect> m_oRects;         /**< vector of rectangles, will contain the haar cascade detection result */
 
@@ -159,6 +207,13 @@ namespace swDetect
             SWHaarCascadePtr m_CHaarCascadeNosePtr; /**< nose haar cascade */
 
             std::list<cv::Rect> m_lFaceRects;
+
+            bool m_bFaceTracked;                    /**< has the face been detected or tracked in the previous image given to trackFace ? */
+            int m_i32DetectionPeriod;               /**< number of frames between two haar cascade detections in trackFace */
+            int m_i32FramesSinceDetection;          /**< number of frames tracked since the last haar cascade detection */
+            cv::Mat m_oPreviousGray;                /**< gray image of the previous frame given to trackFace */
+            std::vector<cv::Point2f> m_vP2fFeatures;/**< features points of the face in m_oPreviousGray */
+            swTrack::SWTrackFlow m_oTrackFlow;      /**< optical flow computing */
 	};
 }
 
@@ -43,6 +43,9 @@
 #include "opencv2/highgui/highgui.hpp"
 #include "opencv2/imgproc/imgproc.hpp"
 
+// boost
+#include <boost/shared_ptr.hpp>
+
 // swooz
 #include "commonTypes.h"
 #include "SWExceptions.h"
@@ -50,12 +53,27 @@
 
 namespace swDetect
 {
+	/**
+	 * \struct SWStasmModels
+	 * \brief Stasm models read from a pair of config files, shared (read only) by the SWStasm instances using the same files.
+	 */
+	struct SWStasmModels
+	{
+		int m_i32ModelsNb;           /**< number of models initialized */
+		double m_dVjScale;           /**< scale of the face rectangle read in the config files */
+		ASM_MODEL m_aModels[2];      /**< asm models loaded */
+	};
+
+	typedef boost::shared_ptr<const SWStasmModels> SWStasmModelsPtr;	/**< boost shared pointer for SWStasmModels */
 
 	/**
 	 * \class SWStasm
 	 * \brief Stasm wrapper.
 	 * \author Florian Lance
 	 * \date 18/02/13
+	 *
+	 *  The search state and the scratch buffers are kept in each instance, several instances can search
+	 *  at the same time in different threads (an instance must not be used by two threads at the same time).
 	 */
 	class SWStasm
 	{
@@ -123,6 +141,18 @@ namespace swDetect
 			 * \return the vector of right eye brow cv point
 			 */					
 			std::vector<cv::Point2i> rightEyeBrowPoints();
+
+			/**
+			 * \brief Convert a bgr cv::Mat to a gray stasm image in a single pass.
+			 *
+			 *  Gives the same pixels as filling an rgb stasm image with the flipped rows of the mat and converting it
+			 *  with ConvertRgbImageToGray, without the intermediate rgb image.
+			 *
+			 * \param [in]  oBgrMat         : input bgr mat (CV_8UC3, can be a roi)
+			 * \param [out] oStasmGrayImage : gray stasm image, its buffer is reused if the size doesn't change
+			 * \return false if the mat is not a CV_8UC3 mat
+			 */
+			static bool convMatToStasmGrayImage(const cv::Mat &oBgrMat, Image &oStasmGrayImage);
 						
 			std::vector<cv::Point2i> m_oFeaturesPoints;   /**< array of detected features points */
 
@@ -139,7 +169,13 @@ namespace swDetect
 			SHAPE 	  m_oInitShape;		 /**< precedent computed shape used for the next computing */
 			SHAPE 	  m_oCombinedShape;	 /**< ... */
 		
-			ASM_MODEL m_oModels[2];	         /**< asm models loaded */
+			SWStasmModelsPtr m_pModels;	 /**< asm models loaded, shared with the other instances using the same config files */
+			ASM_WORKSPACE m_oWorkspace;	 /**< scratch buffers of the search, reused from one search to the next */
+
+			Image m_oStasmGrayImage;	 /**< gray face image, reused from one search to the next */
+			Image m_oWorkingImage;		 /**< gray face image scaled for the current model, ditto */
+			Image m_oScaleImage;		 /**< scratch image of the bilinear scalings, ditto */
+			SEARCH_IMAGES m_oSearchImages;	 /**< working image reduced to the current pyramid level and its gradients, ditto */
 		
 		
 			// ############################################# METHODS
@@ -151,13 +187,6 @@ namespace swDetect
 			 * \param [out] oDetParams    	       : stasm rectangle
 			 */		
 			void convRectToStasmDetParams(const cv::Rect &oCurrAugmentedRectFace, const cv::Rect &oCurrRectFace, DET_PARAMS &oDetParams);
-			
-			/**
-			 * \brief Convert a rgb cv::Mat to a rgb stasm image.
-			 * \param [in]  oCurrRgbMat : input rgb mat
-			 * \param [out] oStasmImage : the rgb stasm image result
-			 */			
-			void convMatToStasmImage(const cv::Mat &oCurrRgbMat, ImageT<RGB_TRIPLE> &oStasmImage);			
 		
 	};
 }
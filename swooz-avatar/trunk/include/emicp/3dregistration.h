@@ -84,6 +84,9 @@ namespace registration
 
     void initCuda();
 
+	// return true if a CUDA device can be used by emicp (emicp_device.cpp, always false when built without CUDA)
+	bool cudaDeviceAvailable();
+
 	// do not call if another library uses the device
 	void cudaReset();
 
@@ -101,7 +104,8 @@ namespace registration
 		   registration::registrationParameters param
 		   );
 		   
-	void emicp_cpu(int Xsize, int Ysize,
+	// CPU version of emicp (multithreaded with OpenMP), does not need CUDA
+	bool emicp_cpu(int Xsize, int Ysize,
 		       const float* h_X,
 		       const float* h_Y,
 		       float* h_R, float* h_t,
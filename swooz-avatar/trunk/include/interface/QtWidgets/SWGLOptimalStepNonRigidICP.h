@@ -168,6 +168,12 @@ class SWGLOptimalStepNonRigidICP : public SWGLWidget
          */
         void setUseLandMarks(bool bVal);
 
+        /**
+         * \brief Set use CPU sparse solver boolean value (the CUDA dense solver is used otherwise)
+         * \param [in] bVal : value
+         */
+        void setUseSparseSolver(bool bVal);
+
         /**
          * \brief Set vertices normals source display boolean value
          * \param [in] bVal : value
@@ -493,6 +499,7 @@ class SWGLOptimalStepNonRigidICP : public SWGLWidget
         bool m_bTrianglesNormalsTDisplay;   /**< display the triangles normales of the target ? */
 
         bool m_bUseLandMarks;               /**< use landmarks with the morphing ? */
+        bool m_bUseSparseSolver;            /**< use the CPU sparse solver with the morphing ? */
 
         float m_fXRotTarget;                /**< x rotation target */
         float m_fYRotTarget;                /**< y rotation target */
@@ -301,6 +301,7 @@ class SWCreateAvatarWorker : public QObject
         // mat
         cv::Mat *m_pRadialProjectionToDisplay;      /**< filtered radial projection mat to be displayed */
         cv::Mat *m_pFaceTexture;                    /**< face mesh texture */
+        cv::Mat m_oResizedBGR;                      /**< kinect rgb image resized to the cloud size, reused between the frames */
 
         // cloud
         swCloud::SWCloud *m_pCloudToDisplay;        /**< cloud to be displayed */
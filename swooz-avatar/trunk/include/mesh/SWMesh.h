@@ -60,9 +60,11 @@ namespace swMesh
 
             /**
              * \brief Constructor of SWMesh
-             * \param [in] sPathObjFile  : path of the obj file to load
+             * \param [in] sPathObjFile     : path of the obj file to load
+             * \param [in] bUseBinaryCache  : if true, the mesh is loaded from the binary cache "name.swmesh" if it is up to date,
+             *                                else the obj file is loaded and the cache is written (see SWObjLoader.h)
              */
-            SWMesh(const std::string &sPathObjFile);
+            SWMesh(const std::string &sPathObjFile, cbool bUseBinaryCache = false);
 
             /**
              * @brief Constructor of SWMesh
@@ -227,8 +229,6 @@ namespace swMesh
 
                 if(3*ui32IdVertex < m_a3FNormals.size())
                 {
-                    deleteAndNullifyArray(a3FNormal);
-                    a3FNormal = new float[3];
                     a3FNormal[0] = m_a3FNormals[ui32IdVertex*3];
                     a3FNormal[1] = m_a3FNormals[ui32IdVertex*3+1];
                     a3FNormal[2] = m_a3FNormals[ui32IdVertex*3+2];
@@ -387,9 +387,23 @@ namespace swMesh
 
             /**
              * \brief Update the array containing the non oriented normal for each vertex (m_a3DNonOrientedVerticesNormals)
+             *
+             *  Each vertex gathers the normals of its triangles (m_aUi32VertexCorners) in the order of the triangles ids,
+             *  the vertices are computed in parallel and the result is the same as a serial pass over the triangles.
              */
             void updateNonOrientedVerticesNormals();
 
+            /**
+             * \brief Update the triangles and vertices normals.
+             *
+             *  In incremental mode, the positions of the vertices are compared with the ones of the last call and only the normals
+             *  of the triangles containing a moved vertex and of the vertices of these triangles are updated. The first call, or a
+             *  call after a topology change, updates all the normals. The normal of a vertex without triangle points to the mean point
+             *  of the mesh, it is only updated if the vertex has moved.
+             * \param [in] bOnlyMovedVertices : incremental mode
+             */
+            void updateNormals(cbool bOnlyMovedVertices = false);
+
             /**
              * @brief invertAllNormals
              */
@@ -461,13 +475,27 @@ namespace swMesh
             void buildEdgeVertexGraph();
 
             /**
-             * \brief Build the array containing the linked neighbors for each vertex (m_a2VertexNeighbors)
+             * \brief Build the linked neighbors of each vertex (m_aUi32VertexNeighborsOffsets, m_aUi32VertexNeighbors)
              */
             void buildVerticesNeighbors();
 
+            /**
+             * \brief Build the triangles corners of each vertex (m_aUi32VertexCornersOffsets, m_aUi32VertexCorners) from m_aIdFaces.
+             */
+            void buildVerticesCorners();
 
-            bool isQuadFace(std::ifstream &l_oFileStream);
-            void checkObjFile(std::ifstream &l_oFileStream, bool &bIsTextureCoords, bool &bIsNormals);
+            /**
+             * \brief Update the normal of a triangle (m_a3FNonOrientedTrianglesNormals).
+             * \param [in] ui32IdTriangle : triangle id
+             */
+            void updateTriangleNormal(cuint ui32IdTriangle);
+
+            /**
+             * \brief Update the normal of a vertex (m_a3FNonOrientedVerticesNormals and m_a3FNormals) from the normals of its triangles.
+             * \param [in] ui32IdVertex   : vertex id
+             * \param [in] oMeanPoint     : mean point of the mesh, used if the vertex doesn't belong to a triangle
+             */
+            void updateVertexNormal(cuint ui32IdVertex, const swUtil::Vec3f &oMeanPoint);
 
 
             uint m_ui32EdgesNumber;             /**< number of edges of the mesh */
@@ -476,17 +504,22 @@ namespace swMesh
             std::vector<float> m_a2FTextures;   /**< texture coordinates of each vertex [v0x, v0y, v1x, v1y, ..., vnx, vny] */
             std::vector<float> m_a3FNormals;    /**< normals of each vertex [v0x, v0y, v0z, v1x, v1y, ..., vnx, vny, vnz] */
 
-            std::vector<std::vector<float> > m_a3FNonOrientedVerticesNormals;  /**< non oriented normals of each vertex [v0x, v0y, v0z, v1x, v1y, ..., vnx, vny, vnz] */
-            std::vector<std::vector<float> > m_a3FNonOrientedTrianglesNormals;  /**< non oriented normals of each triangle [v0x, v0y, v0z, v1x, v1y, ..., vtnx, vtny, vtnz] */
+            std::vector<swUtil::Vec3f> m_a3FNonOrientedVerticesNormals;  /**< non oriented normals of each vertex [v0, v1, ..., vn] */
+            std::vector<swUtil::Vec3f> m_a3FNonOrientedTrianglesNormals; /**< non oriented normals of each triangle [t0, t1, ..., tn] */
 
             std::vector<uint> m_aIdFaces;       /**< id points composing each triangle [f0_id0, f0_id1, f0_id2, f1_id0, ..., ftn_id0, ftn_id1, ftn_id2] */
             std::vector<uint> m_aIdTextures;    /**< id texture for each triangle vertex (m_a2FTextures)[f0_id0, f0_id1, f0_id2, f1_id0, ..., ftn_id0, ftn_id1, ftn_id2] */
             std::vector<uint> m_aIdNormals;     /**< id normal for each triangle vertex (m_a3FNormals) [f0_id0, f0_id1, f0_id2, f1_id0, ..., ftn_id0, ftn_id1, ftn_id2] */
-            std::vector<std::vector<uint> > m_vVertexIdTriangle; /**< all the triangles id which are composed by a particular vertex */
+
+            std::vector<uint> m_aUi32VertexCornersOffsets;      /**< compressed rows of m_aUi32VertexCorners : the corners of the vertex i are in [offsets[i], offsets[i+1]) */
+            std::vector<uint> m_aUi32VertexCorners;             /**< corners (3 * triangle id + position in the triangle) of each vertex, sorted by triangle id */
+            std::vector<uint> m_aUi32VertexNeighborsOffsets;    /**< compressed rows of m_aUi32VertexNeighbors : the neighbors of the vertex i are in [offsets[i], offsets[i+1]) */
+            std::vector<uint> m_aUi32VertexNeighbors;           /**< id neighbors point for each vertex */
 
             std::vector<std::vector<uint> > m_aIdTriangles;     /**< array of id point for each mesh triangle */
             std::vector<std::vector<uint> > m_a2VertexLinks;    /**< array of id linked point for each vertex, no duplicate */
-            std::vector<std::vector<uint> > m_a2VertexNeighbors;/**< array of id neighbors point for each vertex */
+
+            std::vector<float> m_aFNormalsCoords;               /**< coordinates of the vertices at the last updateNormals call [x0, ..., xn, y0, ..., yn, z0, ..., zn] */
 
             swCloud::SWCloud m_oCloud;          /**< cloud containg mesh points */
 
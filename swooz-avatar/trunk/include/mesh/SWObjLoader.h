@@ -0,0 +1,159 @@
+
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWObjLoader.h
+ * \brief Defines the obj file loader and the binary mesh cache used by SWMesh and SWCloud.
+ * \author Florian Lance
+ * \date 16/10/26
+ *
+ *  The obj file is memory-mapped and cut in chunks at lines boundaries. A first pass counts the lines of each type
+ *  in each chunk, the offsets of the chunks in the final arrays are then known and the second pass parses the chunks
+ *  in parallel directly in the final arrays, so the result does not depend on the number of threads.
+ *
+ *  Binary mesh cache "name.swmesh" :
+ *      - SWMeshCacheHeader
+ *      - coordinates (3 * vertices number floats, planar like SWCloud)
+ *      - colors      (3 * vertices number uint8, planar like SWCloud)
+ *      - textures coordinates, normals, faces id, textures id, normals id (sizes given by the header)
+ *
+ *  The size and the modification time of the obj file are stored in the header, the cache is ignored if the obj file
+ *  has been modified since the cache creation.
+ */
+
+#ifndef _SWOBJLOADER_
+#define _SWOBJLOADER_
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include "commonTypes.h"
+
+#define SW_MESH_CACHE_MAGIC     "SWMESH"
+#define SW_MESH_CACHE_VERSION   1
+#define SW_MESH_CACHE_EXTENSION ".swmesh"
+
+namespace swMesh
+{
+    /**
+     * \struct SWObjData
+     * \brief Data read from an obj file or from a binary mesh cache.
+     */
+    struct SWObjData
+    {
+        /**
+         * \brief SWObjData constructor.
+         */
+        SWObjData();
+
+        /**
+         * \brief SWObjData destructor, the coordinates and colors arrays are deleted if they have not been released.
+         */
+        ~SWObjData();
+
+        /**
+         * \brief Release the coordinates and colors arrays, they must then be deleted by the caller (see SWCloud::set).
+         */
+        void release();
+
+        uint m_ui32VerticesNumber;          /**< number of vertices */
+        float *m_aFCoords;                  /**< vertices coordinates [x0, ..., xn, y0, ..., yn, z0, ..., zn] (allocated with new[]) */
+        uint8 *m_aUi8Colors;                /**< vertices colors [r0, ..., rn, g0, ..., gn, b0, ..., bn] (allocated with new[]),
+                                                 set to red if the colors are not defined for all the vertices */
+
+        std::vector<float> m_a2FTextures;   /**< textures coordinates [vt0x, vt0y, vt1x, vt1y, ...] */
+        std::vector<float> m_a3FNormals;    /**< normals [vn0x, vn0y, vn0z, vn1x, ...] */
+
+        std::vector<uint> m_aIdFaces;       /**< id vertices of each triangle [f0_id0, f0_id1, f0_id2, f1_id0, ...] */
+        std::vector<uint> m_aIdTextures;    /**< id texture of each triangle vertex, empty if the faces have no texture id */
+        std::vector<uint> m_aIdNormals;     /**< id normal of each triangle vertex, empty if the faces have no normal id */
+
+        private :
+
+            SWObjData(const SWObjData &);
+            SWObjData &operator=(const SWObjData &);
+    };
+
+    /**
+     * \struct SWMeshCacheHeader
+     * \brief Header of a binary mesh cache.
+     */
+    struct SWMeshCacheHeader
+    {
+        char m_aCMagic[8];                  /**< SW_MESH_CACHE_MAGIC */
+        int m_i32Version;                   /**< SW_MESH_CACHE_VERSION */
+        int m_i32Reserved;                  /**< unused */
+        int64 m_i64ObjSize;                 /**< size of the obj file used to create the cache */
+        int64 m_i64ObjTime;                 /**< modification time of the obj file used to create the cache */
+        uint m_ui32VerticesNumber;          /**< number of vertices */
+        uint m_ui32TexturesSize;            /**< size of the textures coordinates array */
+        uint m_ui32NormalsSize;             /**< size of the normals array */
+        uint m_ui32IdFacesSize;             /**< size of the faces id array */
+        uint m_ui32IdTexturesSize;          /**< size of the textures id array */
+        uint m_ui32IdNormalsSize;           /**< size of the normals id array */
+    };
+
+    /**
+     * \brief Load an obj file.
+     *
+     *  Supported lines : "v x y z", "v x y z r g b", "vt u v", "vn x y z" and "f" with "v", "v/vt", "v//vn" or "v/vt/vn" vertices,
+     *  the format of the faces is given by the first face of the file. Only the first three vertices of a face are read.
+     *
+     * \param [in] sPathObjFile     : path of the obj file
+     * \param [out] oData           : loaded data
+     * \param [in] bVerticesOnly    : if true, only the vertices lines are parsed
+     * \return false if the file can't be opened or is not valid
+     */
+    bool loadObjFile(const std::string &sPathObjFile, SWObjData &oData, cbool bVerticesOnly = false);
+
+    /**
+     * \brief Return the path of the binary mesh cache of an obj file ("mesh.obj" -> "mesh.swmesh").
+     * \param [in] sPathObjFile     : path of the obj file
+     * \return path of the cache
+     */
+    std::string meshCachePath(const std::string &sPathObjFile);
+
+    /**
+     * \brief Load a binary mesh cache.
+     * \param [in] sPathCacheFile   : path of the cache
+     * \param [in] sPathObjFile     : path of the obj file used to create the cache
+     * \param [out] oData           : loaded data
+     * \return false if the cache doesn't exist, is corrupted or is older than the obj file
+     */
+    bool loadMeshCacheFile(const std::string &sPathCacheFile, const std::string &sPathObjFile, SWObjData &oData);
+
+    /**
+     * \brief Save a binary mesh cache.
+     * \param [in] sPathCacheFile   : path of the cache
+     * \param [in] sPathObjFile     : path of the obj file corresponding to the data
+     * \param [in] oData            : data to save
+     * \return false if the cache can't be written
+     */
+    bool saveMeshCacheFile(const std::string &sPathCacheFile, const std::string &sPathObjFile, const SWObjData &oData);
+};
+
+#endif
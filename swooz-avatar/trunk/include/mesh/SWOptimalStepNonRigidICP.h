@@ -37,11 +37,21 @@
 
 #include "cloud/SWAlignClouds.h"
 #include "mesh/SWMesh.h"
+#include "mesh/SWSparseLDLT.h"
 
 #include "opencv2/imgproc/imgproc.hpp"
 
 namespace swMesh
 {
+    /**
+     * \brief Linear solvers available for the resolution of the NRICP normal equations.
+     */
+    enum SWNRICPSolver
+    {
+        NRICP_DENSE_CUDA_SOLVER,    /**< dense T(A)A inversion with CULA/CUDA */
+        NRICP_SPARSE_CPU_SOLVER     /**< sparse LDL^T factorization on the CPU */
+    };
+
     class SWOptimalStepNonRigidICP
     {
         public :
@@ -67,13 +77,35 @@ namespace swMesh
             SWMesh m_oTargetMesh;   /**< target mesh */
             SWMesh m_oOriginalTargetMesh;
 
+            /**
+             * \brief Update the normals of the source mesh around the vertices moved since the last update (called before each iteration).
+             */
             void updateSourceMeshNormals();
             void computeDistanceWeights();
             void computeCorrespondences();
             void associateTextureCoordinates();
 
+            /**
+             * \brief Solve the deformation of the source mesh for the current correspondences and apply it.
+             * \param [in] fAlpha        : stiffness weight
+             * \param [in] fBeta         : landmarks weight
+             * \param [in] fGama         : weight of the translation in the stiffness term
+             * \param [in] bUseLandMarks : use the landmarks
+             * \return the difference between the previous and the new deformation, -1 if the system can't be solved
+             */
             float resolve(cfloat fAlpha, cfloat fBeta, cfloat fGama, cbool bUseLandMarks);
 
+            /**
+             * \brief Set the linear solver used by resolve.
+             * \param [in] eSolver : dense CUDA solver (default) or sparse CPU solver
+             */
+            void setSolver(const SWNRICPSolver eSolver);
+
+            /**
+             * \brief Return the linear solver used by resolve.
+             */
+            SWNRICPSolver solver() const;
+
             float totalEnergy() const;
 
             void updateLandmarksWithSTASM();
@@ -104,6 +136,29 @@ namespace swMesh
 //            void buildTAB(cv::SparseMat_<float> &oA, cv::SparseMat_<float> &oB, cv::Mat &oTAB);
             float computeDiff(cv::Mat &newX);
 
+            /**
+             * \brief Compute the new X with the dense T(A)A inversion on the GPU.
+             */
+            void resolveDense(cfloat fAlpha, cfloat fBeta, cfloat fGama, cbool bUseLandMarks, cv::Mat &oNewX);
+
+            /**
+             * \brief Compute the new X with the sparse LDL^T factorization of T(A)A on the CPU.
+             * \return false if the factorization failed
+             */
+            bool resolveSparse(cfloat fAlpha, cfloat fBeta, cfloat fGama, cbool bUseLandMarks, cv::Mat &oNewX);
+
+            /**
+             * \brief Build the sparsity pattern of T(A)A from the source mesh topology and analyze it.
+             */
+            void buildSparsePattern();
+
+            SWNRICPSolver m_eSolver;                /**< solver used by resolve */
+            SWSparseMatrix m_oSparseTAA;            /**< upper part of T(A)A, the pattern depends only on the source mesh topology */
+            SWSparseLDLT m_oSparseLDLT;             /**< sparse factorization of m_oSparseTAA */
+            std::vector<int> m_vSparseEdges;        /**< source mesh edges (pairs of vertices ids) */
+            std::vector<int> m_vSparseEdgeIndex;    /**< index in m_oSparseTAA of the 4 off-diagonal values of each edge */
+            std::vector<int> m_vSparseBlockIndex;   /**< index in m_oSparseTAA of the 10 upper values of each vertex diagonal block */
+
             float m_fMaxTemplateTargetDistance;
             void buildU(cv::Mat &oU);
             void buildD(cv::Mat &oD);
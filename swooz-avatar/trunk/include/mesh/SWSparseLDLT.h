@@ -0,0 +1,168 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWSparseLDLT.h
+ * \brief defines SWSparseMatrix and SWSparseLDLT, a CPU sparse symmetric solver
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#ifndef _SWSPARSELDLT_
+#define _SWSPARSELDLT_
+
+#include "commonTypes.h"
+
+#include <vector>
+
+namespace swMesh
+{
+    /**
+     * \struct SWSparseMatrix
+     * \brief Square matrix stored in compressed sparse column format.
+     *        For symmetric matrices only the upper triangular part (row <= col) is stored.
+     * \author Florian Lance
+     * \date 16/10/26
+     */
+    struct SWSparseMatrix
+    {
+        /**
+         * \brief Default constructor of SWSparseMatrix
+         */
+        SWSparseMatrix() : m_i32Size(0)
+        {}
+
+        /**
+         * \brief Return the index in m_vValues of the (i32Row, i32Col) element.
+         * \param [in] i32Row : row of the element
+         * \param [in] i32Col : column of the element
+         * \return the index, or -1 if the element is not in the sparsity pattern
+         */
+        int valueIndex(cint i32Row, cint i32Col) const;
+
+        /**
+         * \brief Set all the values of the matrix to zero, the sparsity pattern is kept.
+         */
+        void setZero();
+
+        /**
+         * \brief Return the number of stored elements.
+         */
+        int nonZeros() const;
+
+        int m_i32Size;                  /**< number of rows/cols */
+        std::vector<int> m_vColPtr;     /**< start of each column in m_vRowId/m_vValues, size : m_i32Size + 1 */
+        std::vector<int> m_vRowId;      /**< row of each stored element, sorted inside each column */
+        std::vector<double> m_vValues;  /**< value of each stored element */
+    };
+
+
+    /**
+     * \class SWSparseLDLT
+     * \brief Sparse LDL^T factorization of a symmetric positive definite matrix.
+     *        The fill reducing ordering and the symbolic factorization are computed once with analyzePattern,
+     *        factorize can then be called as many times as needed with new values sharing the same pattern.
+     * \author Florian Lance
+     * \date 16/10/26
+     */
+    class SWSparseLDLT
+    {
+        public :
+
+            // ############################################# CONSTRUCTORS / DESTRUCTORS
+
+            /**
+             * \brief Default constructor of SWSparseLDLT
+             */
+            SWSparseLDLT();
+
+            // ############################################# METHODS
+
+            /**
+             * \brief Compute a nested dissection ordering and the symbolic factorization of the input matrix pattern.
+             * \param [in] oA               : upper triangular symmetric matrix, only the pattern is used
+             * \param [in] ui32BlockSize    : size of the dense blocks of the matrix (4 for the NRICP affine unknowns),
+             *                                the ordering is computed on the block graph and keeps the blocks contiguous
+             */
+            void analyzePattern(const SWSparseMatrix &oA, cuint ui32BlockSize = 1);
+
+            /**
+             * \brief Compute the numerical factorization, the pattern of the input matrix must be the one given to analyzePattern.
+             * \param [in] oA : upper triangular symmetric matrix
+             * \return false if the matrix is singular or if analyzePattern has not been called, else return true
+             */
+            bool factorize(const SWSparseMatrix &oA);
+
+            /**
+             * \brief Solve A x = b in place with the last factorization.
+             * \param [in,out] aDRhs : in -> b, out -> x (size of the matrix)
+             */
+            void solve(double *aDRhs) const;
+
+            /**
+             * \brief Does the symbolic factorization exist ?
+             * \return true if analyzePattern has been called
+             */
+            bool isAnalyzed() const;
+
+            /**
+             * \brief Return the number of non zeros elements of the L factor (used for checking the ordering quality).
+             */
+            int factorNonZeros() const;
+
+        private :
+
+            /**
+             * \brief Order the vertices of a graph with a recursive level set nested dissection.
+             * \param [in]  vAdjPtr     : CSR start of the adjacency list of each vertex
+             * \param [in]  vAdjId      : CSR adjacency lists
+             * \param [out] vOrder      : vertices ids in elimination order
+             */
+            static void nestedDissection(const std::vector<int> &vAdjPtr, const std::vector<int> &vAdjId, std::vector<int> &vOrder);
+
+            bool m_bAnalyzed;               /**< is the symbolic factorization done ? */
+            int m_i32Size;                  /**< size of the matrix */
+
+            std::vector<int> m_vPerm;       /**< permutation : new id -> old id */
+            std::vector<int> m_vPermInv;    /**< permutation : old id -> new id */
+            std::vector<int> m_vValueMap;   /**< index in the permuted matrix of each value of the input matrix */
+
+            SWSparseMatrix m_oPA;           /**< permuted upper triangular matrix P A P^T */
+
+            std::vector<int> m_vParent;     /**< elimination tree */
+            std::vector<int> m_vLp;         /**< column pointers of L */
+            std::vector<int> m_vLi;         /**< row indices of L */
+            std::vector<double> m_vLx;      /**< values of L */
+            std::vector<double> m_vD;       /**< diagonal D */
+
+            std::vector<int> m_vLnz;        /**< work : number of elements in each column of L */
+            std::vector<int> m_vFlag;       /**< work : visited flags */
+            std::vector<int> m_vPattern;    /**< work : row pattern of the current row of L */
+            std::vector<double> m_vY;       /**< work : dense current row */
+            mutable std::vector<double> m_vX;/**< work : permuted rhs */
+    };
+}
+
+#endif
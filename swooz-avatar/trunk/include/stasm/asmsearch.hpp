@@ -20,7 +20,8 @@
 	SEARCH_IMAGES &SearchImgs,  // in
 	const ASM_MODEL &Model,     // in
 	int iLev,                   // in
-	const LANDMARK LandTab[]   // in
+	const LANDMARK LandTab[],   // in
+	ASM_WORKSPACE &Ws           // io: scratch buffers, one workspace per concurrent search
 	);
 // };
 
@@ -15,9 +15,17 @@
 	void ScaleImage(Image &Img,                                                     // io
 		    const int nNewWidth, const int nNewHeight, const bool fBilinear);   // in
 
+	void ScaleImageInto(Image &OutImg, Image &TmpImg,                                  // out, io: scratch
+			    const Image &InImg,                                                 // in
+			    const int nNewWidth, const int nNewHeight, const bool fBilinear);   // in
+
 	void ReduceImage(Image &Img,                        // io
 			 double Scale, int ReduceMethod);   // in
 
+	void ReduceImageInto(Image &OutImg, Image &TmpImg,     // out, io: scratch
+			     const Image &InImg,               // in
+			     double Scale, int ReduceMethod);  // in
+
 	void FillImage (Image &Img,         // io
 			byte Color);        // in
 
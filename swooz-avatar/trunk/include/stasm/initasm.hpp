@@ -7,7 +7,7 @@
 	extern bool CONF_fMe17;
 	extern bool CONF_fStasmSkipIfNotInShapeFile;
 
-	int                                      // returns the number of models
+	int                                      // returns the number of models, not thread safe
 	nInitAsmModels(ASM_MODEL  Models[],      // out: two ASM models
 		       const char sConfFile0[],  // in: 1st config filename
 		       const char sConfFile1[]); // in: 2nd config filename, "" if none
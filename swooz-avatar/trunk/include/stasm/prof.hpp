@@ -178,7 +178,8 @@
 	    int nPoints);                      // in:
 
 	void
-	PrepareProf1D(const Image &Img, const GslMat::StasmMat &Shape,               // in: all
+	PrepareProf1D(ASM_WORKSPACE &Ws,                                             // out
+		      const Image &Img, const GslMat::StasmMat &Shape,               // in: all the others
 		      unsigned SubProfSpec,
 		      const LANDMARK LandTab[],
 		      int iPoint, int nProfWidth,
@@ -186,7 +187,8 @@
 
 	void
 	Get1dProf(GslMat::StasmVec &Prof,                                                    // out
-	     unsigned SubProfSpec, const Image &Img, int iPoint, int iOffset);  // in
+	     unsigned SubProfSpec, const Image &Img, int iPoint, int iOffset,   // in
+	     const ASM_WORKSPACE &Ws);                                          // in: prepared by PrepareProf1D
 
 	void
 	Get2dProf(GslMat::StasmVec &Prof,                                            // out
@@ -194,7 +196,8 @@
 	    const GslMat::StasmMat   &Grads,                                         // in
 	    const GslMat::SHAPE &Shape, const int iPoint, const int ixOffset,   // in
 	    const int iyOffset, const int nProfWidth,                   // in
-	    const double SigmoidScale);                                 // in
+	    const double SigmoidScale,                                  // in
+	    const double NormalizedProfLen);                            // in
 
 	void InitGrads(GslMat::StasmMat &Grads,                          // out
 		   const Image &Img, unsigned ProfSpec);    // in
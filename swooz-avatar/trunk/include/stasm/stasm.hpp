@@ -74,6 +74,7 @@ class stasmComputeError : public std::exception
 
 static const int MAX_NBR_LEVS     = 6;   // max levs in image pyr
 static const int ASM_FILE_VERSION = 1;   // ASM file version
+static const int MAX_PROF_WIDTH_1D = 50; // max number of elems in a 1D profile including nPixSearch on each end
 
 typedef struct SEARCH_IMAGES    // the images for one pyr level during a search
 {
@@ -120,6 +121,7 @@ typedef struct ASM_MODEL  // an ASM model
 	int    nPixSearch2d;      		 // ditto but for for 2d profiles
 	bool   fExplicitPrevNext;  		 // use iPrev and iNext in LandTab? see landmarks.hpp
 	bool   fBilinearRescale;
+	double NormalizedProfLen; 		 // root mean square length of profiles
 	GslMat::SHAPE  FileMeanShape;      	 // mean shape read from .asm file
 	GslMat::SHAPE  VjAv;
 	GslMat::SHAPE  RowleyAv;
@@ -129,6 +131,29 @@ typedef struct ASM_MODEL  // an ASM model
 	
 } ASM_MODEL;
 
+// Scratch buffers and per-search state of an ASM search.
+// The search routines only read the models and write in the workspace given
+// by the caller, so concurrent searches are possible if each one uses its
+// own workspace. The buffers are kept between searches to avoid a malloc
+// and free for each profile.
+
+typedef struct ASM_WORKSPACE
+{
+	GslMat::StasmVec Prof;            // profile at the current offset (GetProfDist)
+	GslMat::StasmVec Prof1d;          // 1D profile along the whole whisker (PrepareProf1D)
+	int              nProf1dWidth;    // number of elems used in Prof1d
+	int              iProf1dPoint;    // for sanity checking in Get1dProf
+	const byte      *pProf1dImage;    // ditto
+	unsigned         Prof1dSpec;      // ditto
+	double           NormalizedProfLen; // of the model being searched
+	GslMat::SHAPE    SuggestedShape;  // shape after profile matching (AsmLevSearch)
+	GslMat::StasmVec b;               // shape model params (AsmLevSearch)
+
+	ASM_WORKSPACE() : Prof1d(1, MAX_PROF_WIDTH_1D), nProf1dWidth(0), iProf1dPoint(-1),
+	                  pProf1dImage(NULL), Prof1dSpec(0), NormalizedProfLen(1) {}
+
+} ASM_WORKSPACE;
+
 using namespace GslMat;
 
 #include "shapemodel.hpp"
@@ -66,7 +66,18 @@ namespace swTrack
 			 * \param [in,out] vP2fPoints : current features points
 			 */	
 			bool track(const cv::Mat &oPreGray, const cv::Mat &oGray, 
-				   const std::vector<cv::Point2f> &vP2fPrePoints, const std::vector<cv::Point2f> &vP2fPoints);
+				   const std::vector<cv::Point2f> &vP2fPrePoints, std::vector<cv::Point2f> &vP2fPoints);
+
+			/**
+			 * \brief Launch the tracking
+			 * \param [in] oPreGray       : previous gray image
+			 * \param [in] oGray          : current gray image
+			 * \param [in] vP2fPrePoints  : previous features points
+			 * \param [in,out] vP2fPoints : current features points
+			 * \param [out] vU8Status     : 1 for each feature point found in the current image, else 0
+			 */
+			bool track(const cv::Mat &oPreGray, const cv::Mat &oGray,
+				   const std::vector<cv::Point2f> &vP2fPrePoints, std::vector<cv::Point2f> &vP2fPoints, std::vector<uchar> &vU8Status);
 			
 		private:
 			
@@ -37,6 +37,7 @@
 #include "cloud/SWConvCloud.h"
 #include "cloud/SWRadialProjectionCloud.h"
 #include "opencvUtility.h"
+#include "SWProfiler.h"
 
 // UTILITY
 #include <time.h>
@@ -45,7 +46,8 @@ using namespace swDevice;
 
 // ############################################# CONSTRUCTORS / DESTRUCTORS
 
-SWCreateAvatar::SWCreateAvatar(cbool bVerbose) : m_bVerbose(bVerbose), m_i32NumCloud(0)
+SWCreateAvatar::SWCreateAvatar(cbool bVerbose) : m_bVerbose(bVerbose), m_i32NumCloud(0), m_ui32RadialProjCloudsNb(0),
+    m_i32RadialProjWidth(0), m_i32RadialProjHeight(0), m_fRadialProjRadius(0.f)
 {
     // detection
         m_bDetectStasmPoints        = false;
@@ -105,11 +107,17 @@ void SWCreateAvatar::resetData()
     m_i32NumCloud = 0;
     m_oLastRectFace.width = 0;
     m_oLastRectNose.width = 0;
+    m_CFaceDetectPtr->resetTracking();
     m_oFaceCloudRef.erase();
     m_oNoseCloudRef.erase();
     m_oAccumulatedFaceClouds.erase();
     m_vUi32CloudNumbersOfPoints.clear();
 
+    // running radial projection
+    m_oRadialProjSum.release();
+    m_oRadialProjCount.release();
+    m_ui32RadialProjCloudsNb = 0;
+
     // stasm
     m_vStasm3DPoints.clear();
     m_vP3FStasm3DPoints.clear();
@@ -228,10 +236,7 @@ void SWCreateAvatar::lastRadialProjection(cv::Mat &oFilteredRadialProj) const
 
 bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth)
 {
-    clock_t l_timeTraining = clock();
-    std::cout << "1 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
-
+    swUtil::SWScopedTimer l_oTimer("avatar/background_removal");
 
    // copy input data
        cv::Mat l_oRgb   = oRgb.clone();
@@ -248,10 +253,9 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
    // remove background
        cv::Mat l_oRgbForeGround    = swImage::swUtil::removeBackground(l_oRgb, l_oDepth, m_fRemoveBackGroundDistance);
 
-//       std::cout << "2 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
    // detect face
-       if(!m_CFaceDetectPtr->detectFace(l_oRgbForeGround))
+       l_oTimer.next("avatar/face_detection");
+       if(!m_CFaceDetectPtr->trackFace(l_oRgbForeGround))
        {
            if(m_oLastRectFace.width == 0)
            {
@@ -275,14 +279,11 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
                 m_oLastRectFace.height += (int)(m_oLastRectFace.height *0.1);
         }
 
-//       std::cout << "3 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
     // detect nose
        cv::Rect l_oCurrentNoseRect = m_CFaceDetectPtr->detectNose(l_oRgbForeGround(m_oLastRectFace));
 
-//       std::cout << "4 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
    // compute nose tip
+       l_oTimer.next("avatar/nose_tip");
        int l_i32IdNoseX, l_i32IdNoseY;
        cv::Point3f l_oNoseTip;
 
@@ -302,13 +303,12 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
             l_oRectangleFromNoseTip.y = m_oLastRectFace.y + l_i32IdNoseY - 50;
        }
 
-//       std::cout << "5 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
        l_oRectangleFromNoseTip.width   = 60;
        l_oRectangleFromNoseTip.height  = 70;
        m_oLastRectNose = l_oRectangleFromNoseTip;
 
    // detect stasm features points
+        l_oTimer.next("avatar/stasm");
         cv::Mat l_oStasmMask;
         if(m_bDetectStasmPoints && m_vStasm3DPoints.size() < 5)
         {
@@ -319,14 +319,12 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
             m_CStasmDetectPtr->compute3DPoints(l_oDepth, m_vP3FStasm3DPoints);           
         }
 
-//        std::cout << "6 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
     // create cloud
+        l_oTimer.next("avatar/cloud_conversion");
         swCloud::SWCloud l_oFaceCloud, l_oNoseCloud;
         swCloud::convCloudMat2SWCloud(l_oDepth(m_oLastRectFace), l_oRgb(m_oLastRectFace), l_oFaceCloud, l_oNoseTip.z-0.5f, m_fDepthCloud+0.5f);
         swCloud::convCloudMat2SWCloud(l_oDepth(m_oLastRectNose), l_oRgb(m_oLastRectNose), l_oNoseCloud, l_oNoseTip.z-0.5f, m_fDepthCloud+0.5f );
-
-//        std::cout << "7 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
+        l_oTimer.stop();
 
     bool l_bIsLastCloudValid = false;
 
@@ -348,36 +346,41 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
 
         // compute cloud bbox of the texture
             swImage::swUtil::computeSizeCloudRect(m_oLastRectFace, oDepth, m_oCloudFaceBBox);
+
+        // the next clouds are aligned on the reference, its bbox defines the cylinder of the radial projection
+            m_oRadialProjBBox = m_oFaceCloudRef.bBox();
        }
    // save next clouds
        else
        {
            // align clouds
-//        std::cout << "7_1 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
+           l_oTimer.next("avatar/emicp_alignment");
            m_oAlignClouds.setClouds(m_oNoseCloudRef, l_oNoseCloud);
-//        std::cout << "7_2 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
 //           m_oAlignClouds.setCloudDownscale(m_fTargetDownScale, m_fTemplateDownScale);
            m_oAlignClouds.setCloudDownscale(40, 40);
-//        std::cout << "7_3 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
            m_oAlignClouds.alignClouds();
 
-//           std::cout << "8_1 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
            // transform clouds
            m_oAlignClouds.transformedCloud(l_oFaceCloud);
 
-//            std::cout << "8_2 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
-
+           // score the alignment
+           l_oTimer.next("avatar/scoring");
 //           float l_fScore = m_oFaceCloudRef.squareDistanceCloud(l_oFaceCloud, true, 0.1f);
            float l_fScore = m_oFaceCloudRef.squareDistanceCloud(l_oFaceCloud, true, 40);
-//           std::cout << "8_3 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
+           l_oTimer.stop();
 
            if(m_bVerbose)
            {
                std::cout << "Score : " << l_fScore << " --- " << m_fDistMaxAlignment << " : " << endl;
            }
 
-           if(l_fScore > m_fDistMaxAlignment)
+           if(l_fScore < 0.f)
+           {
+               l_bIsLastCloudValid = false;
+               std::cerr << "The alignment of the current cloud cannot be scored, rejected. " << std::endl;
+               return false;
+           }
+           else if(l_fScore > m_fDistMaxAlignment)
            {
                l_bIsLastCloudValid = false;
                std::cerr << "Distance too hight between current cloud and reference cloud, rejected. " << std::endl;
@@ -387,18 +390,26 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
            {
                l_bIsLastCloudValid = true;
            }
-
-//           std::cout << "9_1 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
        }
 
    // add cloud to the sum of clouds
        if(l_bIsLastCloudValid)
        {
-//           std::cout << "9_2 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
+           l_oTimer.next("avatar/radial_projection");
            m_oAccumulatedFaceClouds += l_oFaceCloud;
-//           std::cout << "9_3 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
            m_vUi32CloudNumbersOfPoints.push_back(l_oFaceCloud.size());
-//           std::cout << "9_4 debug -> " << static_cast<double>((clock() - l_timeTraining)) / CLOCKS_PER_SEC << std::endl;
+
+           // add the cloud to the running radial projection
+           if(m_ui32RadialProjCloudsNb == 0)
+           {
+               m_i32RadialProjWidth  = m_i32WidthRadialProj;
+               m_i32RadialProjHeight = m_i32HeightRadialProj;
+               m_fRadialProjRadius   = m_fCylinderRadius;
+           }
+           swCloud::accumulateRadialProjCloud(l_oFaceCloud, m_oRadialProjSum, m_oRadialProjCount, m_oRadialProjBBox,
+                                              m_i32RadialProjWidth, m_i32RadialProjHeight, m_fRadialProjRadius);
+           ++m_ui32RadialProjCloudsNb;
+           l_oTimer.stop();
 
            if(m_bDetectStasmPoints && m_vStasm3DPoints.size() < 5)
            {
@@ -410,58 +421,60 @@ bool SWCreateAvatar::addCloudToAvatar(const cv::Mat &oRgb, const cv::Mat &oDepth
 }
 
 
-void SWCreateAvatar::constructAvatar()
+void SWCreateAvatar::updateRadialProjection()
 {
-    // init
-        uint l_ui32CurrPointNumber = 0;
-        swCloud::SWCloud l_oCloudPart, l_oCloudParCylinderProj;
-        std::vector<cv::Mat> l_vMatProj;
-        swCloud::SWCloudBBox l_oBBox = m_oAccumulatedFaceClouds.bBox();
-
-    // compute 2D images with the total cloud
-        for(uint ii = 0; ii < m_vUi32CloudNumbersOfPoints.size(); ++ii)
-        {
-            cv::Mat l_oRadialProjMat;
+    if(m_ui32RadialProjCloudsNb == m_vUi32CloudNumbersOfPoints.size() && m_i32RadialProjWidth == m_i32WidthRadialProj &&
+       m_i32RadialProjHeight == m_i32HeightRadialProj && m_fRadialProjRadius == m_fCylinderRadius)
+    {
+        return;
+    }
 
-            // retrieve the good parts
-                m_oAccumulatedFaceClouds.retrieveCloudPart(l_oCloudPart, l_ui32CurrPointNumber, l_ui32CurrPointNumber + m_vUi32CloudNumbersOfPoints[ii]);
-                l_ui32CurrPointNumber += m_vUi32CloudNumbersOfPoints[ii];
+    m_oRadialProjSum.release();
+    m_oRadialProjCount.release();
+    m_ui32RadialProjCloudsNb = 0;
+    m_i32RadialProjWidth     = m_i32WidthRadialProj;
+    m_i32RadialProjHeight    = m_i32HeightRadialProj;
+    m_fRadialProjRadius      = m_fCylinderRadius;
 
-            // project the cloud on a cylinder
-                swCloud::radialProjCloudOnMat(l_oCloudPart, l_oRadialProjMat, l_oCloudParCylinderProj, l_oBBox, m_i32WidthRadialProj, m_i32HeightRadialProj, m_fCylinderRadius);
+    uint l_ui32CurrPointNumber = 0;
+    swCloud::SWCloud l_oCloudPart;
 
-            // stock current mat image
-                l_vMatProj.push_back(l_oRadialProjMat);
-        }
+    for(uint ii = 0; ii < m_vUi32CloudNumbersOfPoints.size(); ++ii)
+    {
+        m_oAccumulatedFaceClouds.retrieveCloudPart(l_oCloudPart, l_ui32CurrPointNumber, l_ui32CurrPointNumber + m_vUi32CloudNumbersOfPoints[ii]);
+        l_ui32CurrPointNumber += m_vUi32CloudNumbersOfPoints[ii];
 
-    // temporal filtering
-        uint l_ui32CurrNumberOfPoints;
-        float l_fCurrTotalValue;
-        cv::Mat l_oFinalMat = cv::Mat(l_vMatProj.back().rows, l_vMatProj.back().cols, l_vMatProj.back().depth());
+        swCloud::accumulateRadialProjCloud(l_oCloudPart, m_oRadialProjSum, m_oRadialProjCount, m_oRadialProjBBox,
+                                           m_i32RadialProjWidth, m_i32RadialProjHeight, m_fRadialProjRadius);
+        ++m_ui32RadialProjCloudsNb;
+    }
+}
 
-        for(int ii = 0; ii < l_oFinalMat.rows * l_oFinalMat.cols; ++ii)
-        {
-            l_ui32CurrNumberOfPoints = 0;
-            l_fCurrTotalValue        = 0.f;
+void SWCreateAvatar::currentRadialProjection(cv::Mat &oRadialProj)
+{
+    updateRadialProjection();
 
-            for(uint jj = 0; jj < l_vMatProj.size(); ++jj)
-            {
-                if(l_vMatProj[jj].at<float>(ii) > 0.f)
-                {
-                    l_fCurrTotalValue += l_vMatProj[jj].at<float>(ii);
-                    l_ui32CurrNumberOfPoints++;
-                }
-            }
-
-            if(l_ui32CurrNumberOfPoints > 0)
-            {
-                l_oFinalMat.at<float>(ii) = l_fCurrTotalValue  / (float)l_ui32CurrNumberOfPoints;
-            }
-            else
-            {
-                l_oFinalMat.at<float>(ii) = 0.f;
-            }
+    if(m_ui32RadialProjCloudsNb == 0)
+    {
+        oRadialProj.release();
+        return;
+    }
+
+    swCloud::meanRadialProj(m_oRadialProjSum, m_oRadialProjCount, oRadialProj);
+}
+
+void SWCreateAvatar::constructAvatar()
+{
+    // temporal filtering : mean of the radial projections of the clouds, accumulated when they were added
+        cv::Mat l_oFinalMat;
+        currentRadialProjection(l_oFinalMat);
+
+        if(l_oFinalMat.empty())
+        {
+            std::cerr << "No cloud added, the avatar can't be constructed. " << std::endl;
+            return;
         }
+
         cv::imwrite("../data/images/radialProj/1_finalTemporal.png" ,l_oFinalMat);
 
     // keep only one connex aggregat
@@ -529,7 +542,7 @@ void SWCreateAvatar::constructAvatar()
         m_oFilteredRadialProjection = l_oFinalFilteredMat.clone();
 
     // compute vertex and faces
-        swCloud::transformRadialProjToMesh(l_oFinalFilteredMat, m_oLastResultFaceMesh, l_oBBox, m_oCloudFaceBBox, m_i32WidthRadialProj, m_i32HeightRadialProj, 0.15f);
+        swCloud::transformRadialProjToMesh(l_oFinalFilteredMat, m_oLastResultFaceMesh, m_oRadialProjBBox, m_oCloudFaceBBox, m_i32WidthRadialProj, m_i32HeightRadialProj, 0.15f);
 
     if(m_bDetectStasmPoints)
     {
@@ -466,6 +466,8 @@ void swAnimation::SWAnimation::transformMeshWithCorrId(cuint transformationId, s
         mesh.cloud()->coord(1)[ii] += 3* m_animationMod.m_vty[m_idCorr[ii]][transformationId];
         mesh.cloud()->coord(2)[ii] += 3* m_animationMod.m_vtz[m_idCorr[ii]][transformationId];
     }
+
+    mesh.cloud()->invalidateSpatialIndex();
 }
 
 void swAnimation::SWAnimation::setCloudCorr(QString pathFile)
@@ -44,7 +44,7 @@ using namespace swCloud;
 // ############################################# CONSTRUCTORS / DESTRUCTORS
 
 SWAlignClouds::SWAlignClouds(cbool bVerbose) :  m_bVerbose(bVerbose), m_fReductionCloud1(1.f), m_fReductionCloud2(1.f), m_ui32K(0), m_fHTrans(25), m_fHRot(25),
-    m_oTemplate(NULL), m_oTarget(NULL)
+    m_oTemplate(NULL), m_oTarget(NULL), m_eEmicpDevice(EMICP_AUTO_DEVICE)
 {
     // set default emicp parameters
         m_SParam.sigma_p2     = 0.01f;
@@ -93,6 +93,16 @@ void SWAlignClouds::setEmicpParams(cfloat fP2, cfloat fINF, cfloat fFactor, cflo
     m_SParam.d_02         = fD02;
 }
 
+void SWAlignClouds::setEmicpDevice(const SWEmicpDevice eDevice)
+{
+    m_eEmicpDevice = eDevice;
+}
+
+SWEmicpDevice SWAlignClouds::emicpDevice() const
+{
+    return m_eEmicpDevice;
+}
+
 void SWAlignClouds::setSmoothingParams(cuint ui32K, cfloat fSmoothTransConst, cfloat fSmoothRotConst)
 {
     m_ui32K   = ui32K;
@@ -277,8 +287,40 @@ bool SWAlignClouds::computeEmicp()
     // reinitialize rigid motion for avoiding persistent bad alignment
     initRT();
 
-    if(!emicp(m_oTarget->size(), m_oTemplate->size(), m_oTarget->coord(0), m_oTemplate->coord(0),
-          m_fRotationMatrix, m_fTranslationMatrix, m_SParam))
+    if(m_eEmicpDevice == EMICP_AUTO_DEVICE)
+    {
+        m_eEmicpDevice = cudaDeviceAvailable() ? EMICP_CUDA_DEVICE : EMICP_CPU_DEVICE;
+
+        if(m_bVerbose)
+        {
+            std::cout << "Emicp device : " << (m_eEmicpDevice == EMICP_CUDA_DEVICE ? "CUDA" : "CPU") << std::endl;
+        }
+    }
+
+    bool l_bNoError;
+
+#ifndef SW_EMICP_CUDA
+    if(m_eEmicpDevice == EMICP_CUDA_DEVICE)
+    {
+        std::cerr << "Error SWAlignClouds::computeEmicp : built without CUDA, the CPU emicp is used. " << std::endl;
+        m_eEmicpDevice = EMICP_CPU_DEVICE;
+    }
+#endif
+
+#ifdef SW_EMICP_CUDA
+    if(m_eEmicpDevice == EMICP_CUDA_DEVICE)
+    {
+        l_bNoError = emicp(m_oTarget->size(), m_oTemplate->size(), m_oTarget->coord(0), m_oTemplate->coord(0),
+                           m_fRotationMatrix, m_fTranslationMatrix, m_SParam);
+    }
+    else
+#endif
+    {
+        l_bNoError = emicp_cpu(m_oTarget->size(), m_oTemplate->size(), m_oTarget->coord(0), m_oTemplate->coord(0),
+                               m_fRotationMatrix, m_fTranslationMatrix, m_SParam);
+    }
+
+    if(!l_bNoError)
     {
         initRT();
         return false;
@@ -36,6 +36,7 @@
 #include "cloud/SWImageProcessing.h"
 #include "cloud/SWConvCloud.h"
 #include "opencvUtility.h"
+#include "SWProfiler.h"
 
 using namespace swCloud;
 using namespace swDevice;
@@ -64,21 +65,37 @@ SWCaptureHeadMotion::SWCaptureHeadMotion(cfloat fAlignmentReducCoeff, cfloat fSc
 int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, const cv::Mat &oRgb, const cv::Mat &oDepth,
                                            cv::Mat &oDisplayDetectFace, cv::Point3f oNoseTip)
 {
-     clock_t l_oFirstTime = clock();
+    SWHeadDetection l_oDetection;
+    bool l_bDetected   = detectHead(oRgb, oDepth, l_oDetection);
+    oDisplayDetectFace = l_oDetection.m_oDisplayDetectFace;
 
+    if(!l_bDetected)
+    {
+        return -1;
+    }
 
-    cv::Mat l_oRgbForeGround    = swImage::swUtil::removeBackground(oRgb, oDepth, 1.5);//, 5, cv::Vec3b(0,255,0 ));
-    oDisplayDetectFace          = l_oRgbForeGround.clone();
+    return alignHead(oHeadRigidMotion, l_oDetection);
+}
 
-    std::cout << "1 -> " << (float)(clock() - l_oFirstTime) / CLOCKS_PER_SEC << std::endl;
+bool SWCaptureHeadMotion::detectHead(const cv::Mat &oRgb, const cv::Mat &oDepth, SWHeadDetection &oDetection)
+{
+    swUtil::SWScopedTimer l_oTimer("head/background_removal");
+
+    oDetection.m_bValid = false;
+    oDetection.m_pFaceCloud.reset();
+
+    cv::Mat l_oRgbForeGround    = swImage::swUtil::removeBackground(oRgb, oDepth, 1.5);//, 5, cv::Vec3b(0,255,0 ));
+    cv::Mat &l_oDisplayDetectFace = oDetection.m_oDisplayDetectFace;
+    l_oDisplayDetectFace          = l_oRgbForeGround.clone();
 
     // detect face
-        if(!m_CFaceDetectPtr->detectFace(l_oRgbForeGround))
+        l_oTimer.next("head/face_detection");
+        if(!m_CFaceDetectPtr->trackFace(l_oRgbForeGround))
         {
             if(m_oLastDetectedRectFace.width == 0)
             {
                 std::cerr << "Face not detected. Head rigid motion cannot be computed. " << std::endl;
-                return -1;
+                return false;
             }
             else
             {
@@ -93,12 +110,11 @@ int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, cons
             m_oLastDetectedRectFace = m_CFaceDetectPtr->faceRect();
         }
 
-    std::cout << "2 -> " << (float)(clock() - l_oFirstTime) / CLOCKS_PER_SEC << std::endl;
-
     // detect nose
        cv::Rect l_oCurrentNoseRect = m_CFaceDetectPtr->detectNose(l_oRgbForeGround(m_oLastDetectedRectFace));
 
        // compute nose tip
+           l_oTimer.next("head/nose_tip");
            int l_i32IdNoseX, l_i32IdNoseY;
            cv::Point3f l_oNoseTip;
 
@@ -120,32 +136,50 @@ int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, cons
 
         l_oRectangleFromNoseTip.width  = 60;
         l_oRectangleFromNoseTip.height  = 70;
+        l_oTimer.stop();
 
-         std::cout << "3 -> " << (float)(clock() - l_oFirstTime) / CLOCKS_PER_SEC << std::endl;
     // display
-        if(swUtil::isInside(m_oLastDetectedRectFace, oDisplayDetectFace))
+        if(swUtil::isInside(m_oLastDetectedRectFace, l_oDisplayDetectFace))
         {
-            cv::rectangle(oDisplayDetectFace, cv::Point(m_oLastDetectedRectFace.x, m_oLastDetectedRectFace.y),
+            cv::rectangle(l_oDisplayDetectFace, cv::Point(m_oLastDetectedRectFace.x, m_oLastDetectedRectFace.y),
                 cv::Point(m_oLastDetectedRectFace.x+m_oLastDetectedRectFace.width, m_oLastDetectedRectFace.y+m_oLastDetectedRectFace.height), RED,1);
         }
 
-        if(swUtil::isInside(l_oRectangleFromNoseTip,oDisplayDetectFace))
+        if(swUtil::isInside(l_oRectangleFromNoseTip,l_oDisplayDetectFace))
         {
-            cv::rectangle(oDisplayDetectFace, cv::Point(l_oRectangleFromNoseTip.x, l_oRectangleFromNoseTip.y),
+            cv::rectangle(l_oDisplayDetectFace, cv::Point(l_oRectangleFromNoseTip.x, l_oRectangleFromNoseTip.y),
                     cv::Point(l_oRectangleFromNoseTip.x + l_oRectangleFromNoseTip.width, l_oRectangleFromNoseTip.y + l_oRectangleFromNoseTip.height), GREEN,1);
         }
 
-    // update rectangles returned by the getRect function
-        m_oFaceRectToDisplay = m_oLastDetectedRectFace;
-        m_oNoseRectToDisplay = l_oRectangleFromNoseTip;
+        oDetection.m_oFaceRect = m_oLastDetectedRectFace;
+        oDetection.m_oNoseRect = l_oRectangleFromNoseTip;
 
     // init face depth images
         cv::Mat l_oFaceDepth      = oDepth(l_oRectangleFromNoseTip);
 
     // create cloud
-        SWCloud l_oFaceCloud;
-        swCloud::convCloudMat2SWCloud(l_oFaceDepth, l_oFaceCloud, l_oNoseTip.z-0.10f, m_fDepthCloud + 0.10f, 0, 0, 255);
-        uint l_ui32SizeCurrentFaceCloud = l_oFaceCloud.size();       
+        l_oTimer.next("head/cloud_conversion");
+        oDetection.m_pFaceCloud = boost::shared_ptr<SWCloud>(new SWCloud());
+        swCloud::convCloudMat2SWCloud(l_oFaceDepth, *oDetection.m_pFaceCloud, l_oNoseTip.z-0.10f, m_fDepthCloud + 0.10f, 0, 0, 255);
+
+    oDetection.m_bValid = true;
+
+    return true;
+}
+
+int SWCaptureHeadMotion::alignHead(SWRigidMotion &oHeadRigidMotion, const SWHeadDetection &oDetection)
+{
+    if(!oDetection.m_bValid)
+    {
+        return -1;
+    }
+
+    // update rectangles returned by the getRect function
+        m_oFaceRectToDisplay = oDetection.m_oFaceRect;
+        m_oNoseRectToDisplay = oDetection.m_oNoseRect;
+
+    const SWCloud &l_oFaceCloud = *oDetection.m_pFaceCloud;
+    uint l_ui32SizeCurrentFaceCloud = l_oFaceCloud.size();
 
     // save reference cloud
         if(!m_bReferenceCloudInitialized)
@@ -159,7 +193,6 @@ int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, cons
             return 0;
         }
 
-
     // check if the cloud is valid
         if(m_ui32SizeFaceCloudRef > 3 * l_ui32SizeCurrentFaceCloud)
         {
@@ -175,6 +208,7 @@ int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, cons
 //        }
 
     // align the clouds
+        swUtil::SWScopedTimer l_oTimer("head/emicp_alignment");
         m_oAlignClouds.setClouds(m_oFaceCloudRef, l_oFaceCloud);
         m_oAlignClouds.setCloudDownscale(1.f, m_fAlignmentReductionCoeffTarget);
         m_oAlignClouds.alignClouds();
@@ -182,6 +216,7 @@ int SWCaptureHeadMotion::computeHeadMotion(SWRigidMotion &oHeadRigidMotion, cons
         SWCloud l_oTransformedFaceCloud;
         l_oTransformedFaceCloud.copy(l_oFaceCloud);
         m_oAlignClouds.transformedCloud(l_oTransformedFaceCloud);
+        l_oTimer.stop();
 
     // update display clouds
         m_oDisplayFaceCloud.copy(l_oFaceCloud);
@@ -213,13 +248,24 @@ void SWCaptureHeadMotion::reset()
 {
     m_bReferenceCloudInitialized = false;
     m_oLastRigidMotion = SWRigidMotion();
-    m_oLastDetectedRectFace = cv::Rect();
+    resetDetection();
 
     m_oFaceCloudRef.erase();
     m_oDisplayFaceCloud.erase();
     m_oDisplayTransformedFaceCloud.erase();
 }
 
+void SWCaptureHeadMotion::resetDetection()
+{
+    m_oLastDetectedRectFace = cv::Rect();
+    m_CFaceDetectPtr->resetTracking();
+}
+
+void SWCaptureHeadMotion::setEmicpDevice(const SWEmicpDevice eDevice)
+{
+    m_oAlignClouds.setEmicpDevice(eDevice);
+}
+
 void SWCaptureHeadMotion::setParameters(cdouble dTemplateCoeffReduc, cdouble dTargetCoeffReduc, cdouble dScoreComputingReduc,
                                         cint i32KSmooth, cdouble dKTransSmooth, cdouble dKRotSmooth,
                                         cdouble dP2, cdouble dINF, cdouble dFactor, cdouble dD02)
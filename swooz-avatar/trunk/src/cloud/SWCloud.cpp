@@ -32,16 +32,23 @@
  */
 
 #include "cloud/SWCloud.h"
+#include "cloud/SWCloudKdTree.h"
 #include "SWExceptions.h"
 
 #include <iostream>
 #include <fstream>
 
 #include <time.h>
+#include <algorithm>
 #include <iterator>
 #include <sstream>
 
+#if defined(_M_X64) || defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
 #include "geometryUtility.h"
+#include "mesh/SWObjLoader.h"
 
 using namespace std;
 using namespace swCloud;
@@ -419,25 +426,25 @@ void SWRigidMotion::displayRotMatrix()
 
 // ############################################# CONSTRUCTORS / DESTRUCTORS - SWCloud
 
-SWCloud::SWCloud() : m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL)
+SWCloud::SWCloud() : m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL), m_pKdTree(NULL)
 {
     ++m_i32NumberOfCreatedClouds;
 }
 
 SWCloud::SWCloud(cuint ui32NumberOfPoint, float *aCoords, uint8 *aUi8Colors) : 
-	m_ui32NumberOfPoints(ui32NumberOfPoint), m_ui32ArraySize(3*ui32NumberOfPoint), m_aFCoords(aCoords), m_aUi8Colors(aUi8Colors)
+	m_ui32NumberOfPoints(ui32NumberOfPoint), m_ui32ArraySize(3*ui32NumberOfPoint), m_aFCoords(aCoords), m_aUi8Colors(aUi8Colors), m_pKdTree(NULL)
 {
 	++m_i32NumberOfCreatedClouds;    
 }
 
-SWCloud::SWCloud(const std::string &sPathObjFile) : m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL)
+SWCloud::SWCloud(const std::string &sPathObjFile) : m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL), m_pKdTree(NULL)
 {
     ++m_i32NumberOfCreatedClouds;
     loadObj(sPathObjFile);
 }
 
 SWCloud::SWCloud(const std::vector<float> &vPX, const std::vector<float> &vPY, const std::vector<float> &vPZ) :
-                 m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL)
+                 m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL), m_pKdTree(NULL)
 {
 	++m_i32NumberOfCreatedClouds;		
 	
@@ -483,7 +490,7 @@ SWCloud::SWCloud(const std::vector<float> &vPX, const std::vector<float> &vPY, c
 
 SWCloud::SWCloud(const std::vector<float> &vPX, const std::vector<float> &vPY, const std::vector<float> &vPZ, 
          const std::vector<uint8> &vR,  const std::vector<uint8> &vG,  const std::vector<uint8> &vB) :
-         m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL)
+         m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL), m_pKdTree(NULL)
 {
 	++m_i32NumberOfCreatedClouds;	
 	
@@ -528,7 +535,7 @@ SWCloud::SWCloud(const std::vector<float> &vPX, const std::vector<float> &vPY, c
 }
 
 SWCloud::SWCloud(cfloat fPX, cfloat fPY, cfloat fPZ, cuint8 ui8R, cuint8 ui8G, cuint8 ui8B) :
-                 m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL)
+                 m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL), m_pKdTree(NULL)
 {
 	++m_i32NumberOfCreatedClouds;
 	
@@ -554,7 +561,7 @@ SWCloud::SWCloud(cfloat fPX, cfloat fPY, cfloat fPZ, cuint8 ui8R, cuint8 ui8G, c
     }
 }
 
-SWCloud::SWCloud(const SWCloud &oCloud) : m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL)
+SWCloud::SWCloud(const SWCloud &oCloud) : m_ui32NumberOfPoints(0), m_ui32ArraySize(0), m_aFCoords(NULL), m_aUi8Colors(NULL), m_pKdTree(NULL)
 {
     ++m_i32NumberOfCreatedClouds;
     copy(oCloud);
@@ -578,6 +585,8 @@ SWCloud::~SWCloud(void)
 
 SWCloud& SWCloud::operator+=(const std::vector<float> &oPoint) // TODO : it can't be working in this state
 {
+    invalidateSpatialIndex();
+
     if(oPoint.size() == 3)
 	{
 		for(uint ii = 0; ii < m_ui32NumberOfPoints; ++ii)
@@ -600,6 +609,8 @@ SWCloud& SWCloud::operator+=(const std::vector<float> &oPoint) // TODO : it can'
 
 SWCloud& SWCloud::operator+=(const SWCloud &oCloud)
 {	
+    invalidateSpatialIndex();
+
 	if(oCloud.size() > 0)
 	{	
 		if(m_ui32ArraySize < 3 * size() + 3*oCloud.size())
@@ -638,6 +649,8 @@ SWCloud& SWCloud::operator+=(const SWCloud &oCloud)
 
 SWCloud &SWCloud::operator *=(cfloat fScaleValue)
 {
+    invalidateSpatialIndex();
+
     for(uint ii = 0; ii < size(); ++ii)
     {
         coord(0)[ii] *= fScaleValue;
@@ -651,103 +664,17 @@ SWCloud &SWCloud::operator *=(cfloat fScaleValue)
 
 bool SWCloud::loadObj(const string &sPathObjFile)
 {
-    bool l_bEndFile = false;
-    string l_sType = "";
-
-    vector<float> l_vFX, l_vFY, l_vFZ;
-    vector<uint8> l_vUI8R, l_vUI8G, l_vUI8B;
-
-    ifstream  l_oFileStream(sPathObjFile);
-
-    if (l_oFileStream.is_open())
-    {                                
-        while(!l_bEndFile)
-        {
-            l_oFileStream >> l_sType;
+    swMesh::SWObjData l_oData;
 
-            if(l_sType.size() > 0)
-            {
-                if(l_sType.at(0) == '#' || l_sType == "vn" || l_sType == "vt" || l_sType == "f")
-                {
-                    string l_sLine;
-                    getline(l_oFileStream, l_sLine);
-                    l_sType = "";
-                }
-                else if(l_sType == "v")
-                {
-                    int l_i32Pos = static_cast<int>(l_oFileStream.tellg());
-
-                    string l_sLine;
-                    getline(l_oFileStream, l_sLine);
-
-                    // count white spaces
-                    std::vector<uint> l_vUI32SpacePos;
-                    for(uint ii = 0; ii < l_sLine.size(); ++ii)
-                    {
-                        if(l_sLine[ii] == ' ')
-                        {
-                            l_vUI32SpacePos.push_back(ii);
-                        }
-                    }
-
-                    if(l_vUI32SpacePos.size() != 3 && l_vUI32SpacePos.size() != 6)
-                    {
-                        std::cerr << "Obj file not valid (SWCloud::loadObj) " << std::endl;
-                        return false;
-                    }
-
-                    l_oFileStream.seekg(l_i32Pos);
-
-                    // add vertices
-                    float l_fX, l_fY, l_fZ;                    
-                    l_oFileStream >> l_fX;
-                    l_oFileStream >> l_fY;
-                    l_oFileStream >> l_fZ;
-
-                    l_vFX.push_back(l_fX);
-                    l_vFY.push_back(l_fY);
-                    l_vFZ.push_back(l_fZ);
-
-                    // add colors
-                    float l_fR, l_fG, l_fB;
-                    if(l_vUI32SpacePos.size() == 6)
-                    {
-                        l_oFileStream >> l_fR;
-                        l_oFileStream >> l_fG;
-                        l_oFileStream >> l_fB;
-
-                        l_vUI8R.push_back(static_cast<uint8>(l_fR * 255));
-                        l_vUI8G.push_back(static_cast<uint8>(l_fG * 255));
-                        l_vUI8B.push_back(static_cast<uint8>(l_fB * 255));
-                    }
-
-                    l_sType = "";
-                }
-            }
-            else
-            {
-                l_oFileStream.close();
-                l_bEndFile = true;
-            }
-        }
-    }
-    else
+    if(!swMesh::loadObjFile(sPathObjFile, l_oData, true))
     {
-        cerr << "Can't open obj file (SWCloud::loadObj). " << endl;
+        cerr << "Can't load obj file (SWCloud::loadObj). " << endl;
         return false;
     }
 
-    if(l_vUI8B.size() == l_vFX.size())
-    {
-//        std::cout << " aa " << l_vUI8R.size() <<" " << l_vUI8R[10] << " " < << std::endl;
-//        for(int ii = 0; ii < l_vUI8R.size(); ++ii)
-//            std::cout << static_cast<int>(l_vUI8R[ii]) << " " << static_cast<int>(l_vUI8G[ii]) << " " << static_cast<int>(l_vUI8B[ii]) << " | ";
-        set(l_vFX, l_vFY, l_vFZ, l_vUI8R, l_vUI8G, l_vUI8B);
-    }
-    else
-    {
-        set(l_vFX, l_vFY, l_vFZ);
-    }
+    // the cloud takes the ownership of the planar arrays filled by the loader
+    set(l_oData.m_ui32VerticesNumber, l_oData.m_aFCoords, l_oData.m_aUi8Colors);
+    l_oData.release();
 
     return true;
 }
@@ -771,6 +698,8 @@ void SWCloud::point(float *a3FXYZ, cuint ui32IndexPoint) const
 
 void SWCloud::upSize(cuint ui32SizeToAdd)
 {
+    invalidateSpatialIndex();
+
 	ulong l_ulNewSize;
 
 	if(ui32SizeToAdd == 0)
@@ -882,6 +811,8 @@ void SWCloud::set(const std::vector<float> &vPX, const std::vector<float> &vPY,
 
 void SWCloud::set(cuint ui32NumberOfPoints, float *aFCoords, uint8 *aUi8Colors)
 {	
+    invalidateSpatialIndex();
+
 	erase(); // delete current data
 	
 	// init new data
@@ -998,6 +929,8 @@ void SWCloud::copy(cuint ui32NumberOfPoints, const float *aCoords, cuint8 ui8Col
 
 void SWCloud::erase()
 {
+    invalidateSpatialIndex();
+
     deleteAndNullifyArray(m_aFCoords);
     deleteAndNullifyArray(m_aUi8Colors);
 
@@ -1007,6 +940,8 @@ void SWCloud::erase()
 
 void SWCloud::reduce2(int randomSamplingPercentage)
 {
+    invalidateSpatialIndex();
+
     bool *keepPoints = new bool[size()];
 
     int l_newNbOfPoints = 0;
@@ -1060,6 +995,8 @@ void SWCloud::reduce2(int randomSamplingPercentage)
 
 bool SWCloud::reduce(float fRandomSamplingPercentage, float fMinDistBeforeReduction)
 {
+    invalidateSpatialIndex();
+
     if(fRandomSamplingPercentage < 0.f || fMinDistBeforeReduction < 0)
     {
         cerr << "Error reduce SWCloud : bad parameters ." << endl;
@@ -1158,6 +1095,8 @@ bool SWCloud::reduce(float fRandomSamplingPercentage, float fMinDistBeforeReduct
 
 bool SWCloud::transform(cfloat *m_aFRotationMatrix, cfloat *m_aFTranslationMatrix)
 {
+    invalidateSpatialIndex();
+
     for(uint ii = 0; ii < m_ui32NumberOfPoints; ++ii)
     {
         float l_fNewX,l_fNewY,l_fNewZ;
@@ -1183,54 +1122,113 @@ bool SWCloud::transform(cfloat *m_aFRotationMatrix, cfloat *m_aFTranslationMatri
 }
 
 
-float SWCloud::squareDistancePoint(const SWCloud &oCloud, cuint ui32IndiceP)
+float SWCloud::squareDistancePoint(const SWCloud &oCloud, cuint ui32IndiceP) const
 {
-	float l_fX = oCloud.coord(0)[ui32IndiceP];
-	float l_fY = oCloud.coord(1)[ui32IndiceP];
-	float l_fZ = oCloud.coord(2)[ui32IndiceP];
-	
-	float l_fCurrentDist, l_fMinDist = FLT_MAX;
-	float l_fDX, l_fDY, l_fDZ;
-	
-	for(uint ii = 0; ii < size(); ++ii)
-	{
-		l_fDX = coord(0)[ii] - l_fX;
-		l_fDY = coord(1)[ii] - l_fY;
-		l_fDZ = coord(2)[ii] - l_fZ;
-		
-		l_fCurrentDist = l_fDX*l_fDX + l_fDY*l_fDY + l_fDZ*l_fDZ;
-		
-		if(l_fCurrentDist < l_fMinDist)
-		{
-			l_fMinDist = l_fCurrentDist;
-		}
-	}	
-	
-	return l_fMinDist;
+    cfloat l_fX = oCloud.coord(0)[ui32IndiceP];
+    cfloat l_fY = oCloud.coord(1)[ui32IndiceP];
+    cfloat l_fZ = oCloud.coord(2)[ui32IndiceP];
+
+    cfloat *l_aFX = &m_aFCoords[m_ui32NumberOfPoints*0];
+    cfloat *l_aFY = &m_aFCoords[m_ui32NumberOfPoints*1];
+    cfloat *l_aFZ = &m_aFCoords[m_ui32NumberOfPoints*2];
+
+    float l_fMinDist = FLT_MAX;
+    uint ii = 0;
+
+#if defined(_M_X64) || defined(__SSE2__)
+    // 4 points per iteration on the X/Y/Z planes, the lanes minimums are merged at the end
+    if(m_ui32NumberOfPoints >= 4)
+    {
+        const __m128 l_oX = _mm_set1_ps(l_fX), l_oY = _mm_set1_ps(l_fY), l_oZ = _mm_set1_ps(l_fZ);
+        __m128 l_oMin = _mm_set1_ps(FLT_MAX);
+
+        for(; ii + 4 <= m_ui32NumberOfPoints; ii += 4)
+        {
+            __m128 l_oDX = _mm_sub_ps(_mm_loadu_ps(l_aFX + ii), l_oX);
+            __m128 l_oDY = _mm_sub_ps(_mm_loadu_ps(l_aFY + ii), l_oY);
+            __m128 l_oDZ = _mm_sub_ps(_mm_loadu_ps(l_aFZ + ii), l_oZ);
+
+            __m128 l_oDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l_oDX, l_oDX), _mm_mul_ps(l_oDY, l_oDY)), _mm_mul_ps(l_oDZ, l_oDZ));
+            l_oMin = _mm_min_ps(l_oMin, l_oDist);
+        }
+
+        float l_a4FMin[4];
+        _mm_storeu_ps(l_a4FMin, l_oMin);
+        l_fMinDist = std::min(std::min(l_a4FMin[0], l_a4FMin[1]), std::min(l_a4FMin[2], l_a4FMin[3]));
+    }
+#endif
+
+    // remaining points
+    for(; ii < m_ui32NumberOfPoints; ++ii)
+    {
+        float l_fDX = l_aFX[ii] - l_fX;
+        float l_fDY = l_aFY[ii] - l_fY;
+        float l_fDZ = l_aFZ[ii] - l_fZ;
+
+        float l_fCurrentDist = l_fDX*l_fDX + l_fDY*l_fDY + l_fDZ*l_fDZ;
+
+        if(l_fCurrentDist < l_fMinDist)
+        {
+            l_fMinDist = l_fCurrentDist;
+        }
+    }
+
+    return l_fMinDist;
 }
 
-float SWCloud::squareDistanceCloud(const SWCloud &oCloud, cbool bReduce, cfloat ui32CoeffReduce)
+float SWCloud::squareDistanceCloud(const SWCloud &oCloud, cbool bReduce, cfloat ui32CoeffReduce, cbool bUseSpatialIndex) const
 {
-	SWCloud l_oCloud;
-	l_oCloud.copy(oCloud);
-	
-	float l_squareDistance = 0;
-	
-	if(bReduce)
-	{
-        l_oCloud.reduce2(static_cast<int>(ui32CoeffReduce));
-	}
-    #pragma omp parallel for num_threads(4)
-        for(int ii = 0; ii < static_cast<int>(l_oCloud.size()); ++ii)
+    // select the points of the input cloud to use, without copying it
+    int l_i32Step = 1;
+    if(bReduce && static_cast<int>(ui32CoeffReduce) > 1)
+    {
+        l_i32Step = static_cast<int>(ui32CoeffReduce);
+    }
+
+    int l_i32PointsNb = (static_cast<int>(oCloud.size()) + l_i32Step - 1) / l_i32Step;
+
+    if(l_i32PointsNb == 0 || m_ui32NumberOfPoints == 0)
+    {
+        std::cerr << "Error : squareDistanceCloud -> empty cloud. " << std::endl;
+        return -1.f;
+    }
+
+    if(bUseSpatialIndex)
+    {
+        buildSpatialIndex();
+    }
+
+    // each point distance is stored at its own index, the sum is then done in the same order whatever the number of threads
+    std::vector<float> l_vSquareDistances(l_i32PointsNb);
+
+    #pragma omp parallel for
+        for(int ii = 0; ii < l_i32PointsNb; ++ii)
         {
-            l_squareDistance += squareDistancePoint(l_oCloud,ii);
+            if(bUseSpatialIndex)
+            {
+                float l_a3FPt[3];
+                oCloud.point(l_a3FPt, ii * l_i32Step);
+                m_pKdTree->nearest(l_a3FPt, 0.f, &l_vSquareDistances[ii]);
+            }
+            else
+            {
+                l_vSquareDistances[ii] = squareDistancePoint(oCloud, ii * l_i32Step);
+            }
         }
-	
-	return l_squareDistance/l_oCloud.size();
+
+    double l_dSquareDistance = 0.0;
+    for(int ii = 0; ii < l_i32PointsNb; ++ii)
+    {
+        l_dSquareDistance += l_vSquareDistances[ii];
+    }
+
+    return static_cast<float>(l_dSquareDistance / l_i32PointsNb);
 }
 
 std::vector<float> SWCloud::moveToOrigine()
 {
+    invalidateSpatialIndex();
+
     std::vector<float> l_v3fMeanVector = meanPoint();
 
     float *l_uifX = &m_aFCoords[m_ui32NumberOfPoints*0];
@@ -1323,6 +1321,8 @@ bool SWCloud::retrieveCloudPart(SWCloud &oCloudPart, cuint32 ui32BeginIndexPoint
 
 void SWCloud::keepOnlyPointInsideBBox(const SWCloudBBox &oCloudBBox)
 {
+    invalidateSpatialIndex();
+
     std::vector<float> l_vX, l_vY, l_vZ;
     std::vector<uint8> l_vR, l_vG, l_vB;
 
@@ -1515,6 +1515,8 @@ void SWCloud::cloudBBox(SWCloud &oCloudBBox, cuint i32RidgeNumberOfPoints)
 
 void SWCloud::bBox2DFilter(const SWCloudBBox &oBBox)
 {
+    invalidateSpatialIndex();
+
 	vector<float> l_vX, l_vY, l_vZ;
 	vector<uint8> l_vR, l_vG, l_vB;
 	
@@ -1602,34 +1604,110 @@ float *SWCloud::colorBuffer() const
 
 
 int SWCloud::idNearestPoint(const std::vector<float> &oPt, cfloat fDistMin) const
-{        
-    int l_i32IdNearestPoint = 0;
-    float l_fMin = FLT_MAX;
+{
+    return idNearestPoint(&oPt[0], fDistMin);
+}
 
-    for(uint ii = 0; ii < size(); ++ii)
-    {
-        float l_fCurrSquareDist = (oPt[0]-coord(0)[ii])*(oPt[0]-coord(0)[ii])+
-                                  (oPt[1]-coord(1)[ii])*(oPt[1]-coord(1)[ii])+
-                                  (oPt[2]-coord(2)[ii])*(oPt[2]-coord(2)[ii]);       
+int SWCloud::idNearestPoint(cfloat *a3FPt, cfloat fDistMin) const
+{
+    buildSpatialIndex();
 
-        if(l_fCurrSquareDist < l_fMin)
+    int l_i32IdNearestPoint = m_pKdTree->nearest(a3FPt, fDistMin);
+
+    return l_i32IdNearestPoint != -1 ? l_i32IdNearestPoint : 0;
+}
+
+void SWCloud::idNearestPoints(const SWCloud &oQueryCloud, std::vector<int> &vIds, cfloat fDistMin) const
+{
+    buildSpatialIndex();
+
+    int l_i32QueriesNb = static_cast<int>(oQueryCloud.size());
+    vIds.resize(l_i32QueriesNb);
+
+    #pragma omp parallel for
+        for(int ii = 0; ii < l_i32QueriesNb; ++ii)
         {
-            bool l_bUpdate = true;
+            float l_a3FPt[3];
+            oQueryCloud.point(l_a3FPt, ii);
 
-            if(fDistMin != 0.f)
+            int l_i32IdNearestPoint = m_pKdTree->nearest(l_a3FPt, fDistMin);
+            vIds[ii] = l_i32IdNearestPoint != -1 ? l_i32IdNearestPoint : 0;
+        }
+}
+
+void SWCloud::kNearestPoints(const std::vector<float> &oPt, cuint ui32K, std::vector<int> &vIds, std::vector<float> &vSquareDists) const
+{
+    buildSpatialIndex();
+
+    m_pKdTree->kNearest(&oPt[0], ui32K, vIds, vSquareDists);
+}
+
+void SWCloud::kNearestPoints(const SWCloud &oQueryCloud, cuint ui32K, std::vector<int> &vIds) const
+{
+    buildSpatialIndex();
+
+    int l_i32QueriesNb = static_cast<int>(oQueryCloud.size());
+    vIds.assign(l_i32QueriesNb * ui32K, -1);
+
+    #pragma omp parallel
+    {
+        std::vector<int> l_vIds;
+        std::vector<float> l_vSquareDists;
+
+        #pragma omp for
+            for(int ii = 0; ii < l_i32QueriesNb; ++ii)
             {
-                l_bUpdate = (sqrt(l_fCurrSquareDist) > fDistMin);                
+                float l_a3FPt[3];
+                oQueryCloud.point(l_a3FPt, ii);
+
+                m_pKdTree->kNearest(l_a3FPt, ui32K, l_vIds, l_vSquareDists);
+                std::copy(l_vIds.begin(), l_vIds.end(), vIds.begin() + ii * ui32K);
             }
+    }
+}
+
+void SWCloud::pointsInRadius(const std::vector<float> &oPt, cfloat fRadius, std::vector<int> &vIds) const
+{
+    buildSpatialIndex();
 
-            if(l_bUpdate)
+    std::vector<float> l_vSquareDists;
+    m_pKdTree->radius(&oPt[0], fRadius, vIds, l_vSquareDists);
+}
+
+void SWCloud::pointsInRadius(const SWCloud &oQueryCloud, cfloat fRadius, std::vector<std::vector<int> > &vIds) const
+{
+    buildSpatialIndex();
+
+    int l_i32QueriesNb = static_cast<int>(oQueryCloud.size());
+    vIds.resize(l_i32QueriesNb);
+
+    #pragma omp parallel
+    {
+        std::vector<float> l_vSquareDists;
+
+        #pragma omp for
+            for(int ii = 0; ii < l_i32QueriesNb; ++ii)
             {
-                l_fMin = l_fCurrSquareDist;
-                l_i32IdNearestPoint = ii;
+                float l_a3FPt[3];
+                oQueryCloud.point(l_a3FPt, ii);
+
+                m_pKdTree->radius(l_a3FPt, fRadius, vIds[ii], l_vSquareDists);
             }
-        }
     }
+}
 
-    return l_i32IdNearestPoint;
+void SWCloud::buildSpatialIndex() const
+{
+    if(!m_pKdTree)
+    {
+        m_pKdTree = new SWCloudKdTree();
+        m_pKdTree->build(m_ui32NumberOfPoints, m_aFCoords);
+    }
+}
+
+void SWCloud::invalidateSpatialIndex() const
+{
+    deleteAndNullify(m_pKdTree);
 }
 
 
@@ -0,0 +1,398 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWCloudKdTree.cpp
+ * \brief defines SWCloudKdTree
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#include "cloud/SWCloudKdTree.h"
+
+#include <algorithm>
+#include <utility>
+#include <cfloat>
+
+using namespace swCloud;
+
+namespace
+{
+    /**
+     * \brief Compare the ids of the points with one coordinate of a SWCloud array.
+     */
+    struct SWCompareCoord
+    {
+        SWCompareCoord(cfloat *aFCoord) : m_aFCoord(aFCoord)
+        {}
+
+        bool operator()(cint i32Id1, cint i32Id2) const
+        {
+            return m_aFCoord[i32Id1] < m_aFCoord[i32Id2];
+        }
+
+        cfloat *m_aFCoord;
+    };
+
+    /**
+     * \brief Element of the traversal stack : node id and square distance lower bound of its points.
+     */
+    typedef std::pair<int, float> SWKdStackElement;
+
+    /**
+     * \brief Candidate point of the k nearest search : square distance and id, the heap top is the farthest candidate.
+     */
+    typedef std::pair<float, int> SWKdCandidate;
+}
+
+SWCloudKdTree::SWCloudKdTree() : m_ui32PointsNb(0), m_ui32LeafSize(16)
+{}
+
+void SWCloudKdTree::build(cuint ui32PointsNb, cfloat *aFCoords, cuint ui32LeafSize)
+{
+    m_ui32PointsNb = ui32PointsNb;
+    m_ui32LeafSize = ui32LeafSize > 0 ? ui32LeafSize : 1;
+
+    m_vNodes.clear();
+    m_vIds.resize(ui32PointsNb);
+    m_vPoints.resize(3 * ui32PointsNb);
+
+    if(ui32PointsNb == 0)
+    {
+        return;
+    }
+
+    for(uint ii = 0; ii < ui32PointsNb; ++ii)
+    {
+        m_vIds[ii] = ii;
+    }
+
+    m_vNodes.reserve(2 * (ui32PointsNb / m_ui32LeafSize + 1));
+    buildNode(aFCoords, 0, ui32PointsNb);
+
+    // copy the points in the tree order
+    for(uint ii = 0; ii < ui32PointsNb; ++ii)
+    {
+        m_vPoints[3 * ii]     = aFCoords[m_vIds[ii]];
+        m_vPoints[3 * ii + 1] = aFCoords[ui32PointsNb + m_vIds[ii]];
+        m_vPoints[3 * ii + 2] = aFCoords[2 * ui32PointsNb + m_vIds[ii]];
+    }
+}
+
+int SWCloudKdTree::buildNode(cfloat *aFCoords, cint i32Begin, cint i32End)
+{
+    int l_i32NodeId = static_cast<int>(m_vNodes.size());
+    m_vNodes.push_back(SWKdNode());
+    m_vNodes[l_i32NodeId].m_i32Dim   = -1;
+    m_vNodes[l_i32NodeId].m_fSplit   = 0.f;
+    m_vNodes[l_i32NodeId].m_i32Begin = i32Begin;
+    m_vNodes[l_i32NodeId].m_i32End   = i32End;
+    m_vNodes[l_i32NodeId].m_i32Right = -1;
+
+    if(i32End - i32Begin <= static_cast<int>(m_ui32LeafSize))
+    {
+        return l_i32NodeId;
+    }
+
+    // split along the largest extent of the node bbox
+        float l_aFMin[3] = { FLT_MAX,  FLT_MAX,  FLT_MAX};
+        float l_aFMax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+        for(int ii = i32Begin; ii < i32End; ++ii)
+        {
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                float l_fValue = aFCoords[jj * m_ui32PointsNb + m_vIds[ii]];
+                l_aFMin[jj] = std::min(l_aFMin[jj], l_fValue);
+                l_aFMax[jj] = std::max(l_aFMax[jj], l_fValue);
+            }
+        }
+
+        int l_i32Dim = 0;
+        for(int jj = 1; jj < 3; ++jj)
+        {
+            if(l_aFMax[jj] - l_aFMin[jj] > l_aFMax[l_i32Dim] - l_aFMin[l_i32Dim])
+            {
+                l_i32Dim = jj;
+            }
+        }
+
+        if(l_aFMax[l_i32Dim] - l_aFMin[l_i32Dim] <= 0.f)
+        {
+            // all the points are identical
+            return l_i32NodeId;
+        }
+
+    // median split
+        cfloat *l_aFCoord = aFCoords + l_i32Dim * m_ui32PointsNb;
+        int l_i32Mid = i32Begin + (i32End - i32Begin) / 2;
+        std::nth_element(m_vIds.begin() + i32Begin, m_vIds.begin() + l_i32Mid, m_vIds.begin() + i32End, SWCompareCoord(l_aFCoord));
+
+        m_vNodes[l_i32NodeId].m_i32Dim = l_i32Dim;
+        m_vNodes[l_i32NodeId].m_fSplit = l_aFCoord[m_vIds[l_i32Mid]];
+
+        buildNode(aFCoords, i32Begin, l_i32Mid);
+        int l_i32Right = buildNode(aFCoords, l_i32Mid, i32End);
+        m_vNodes[l_i32NodeId].m_i32Right = l_i32Right;
+
+    return l_i32NodeId;
+}
+
+uint SWCloudKdTree::size() const
+{
+    return m_ui32PointsNb;
+}
+
+int SWCloudKdTree::nearest(cfloat *a3FPt, cfloat fDistMin, float *pFSquareDist) const
+{
+    int   l_i32IdMin   = -1;
+    float l_fBestDist  = FLT_MAX;
+    float l_fSquareDistMin = fDistMin * fDistMin;
+    bool  l_bCheckMin  = (fDistMin != 0.f);
+
+    if(m_vNodes.empty())
+    {
+        return l_i32IdMin;
+    }
+
+    SWKdStackElement l_aStack[128];
+    int l_i32StackSize = 0;
+    l_aStack[l_i32StackSize++] = SWKdStackElement(0, 0.f);
+
+    while(l_i32StackSize > 0)
+    {
+        SWKdStackElement l_oElement = l_aStack[--l_i32StackSize];
+
+        if(l_oElement.second > l_fBestDist)
+        {
+            continue;
+        }
+
+        const SWKdNode &l_oNode = m_vNodes[l_oElement.first];
+
+        if(l_oNode.m_i32Dim == -1)
+        {
+            cfloat *l_aFPoint = &m_vPoints[3 * l_oNode.m_i32Begin];
+            for(int ii = l_oNode.m_i32Begin; ii < l_oNode.m_i32End; ++ii, l_aFPoint += 3)
+            {
+                float l_fDX = a3FPt[0] - l_aFPoint[0];
+                float l_fDY = a3FPt[1] - l_aFPoint[1];
+                float l_fDZ = a3FPt[2] - l_aFPoint[2];
+                float l_fDist = l_fDX * l_fDX + l_fDY * l_fDY + l_fDZ * l_fDZ;
+
+                if(l_bCheckMin && l_fDist <= l_fSquareDistMin)
+                {
+                    continue;
+                }
+
+                if(l_fDist < l_fBestDist || (l_fDist == l_fBestDist && m_vIds[ii] < l_i32IdMin))
+                {
+                    l_fBestDist = l_fDist;
+                    l_i32IdMin  = m_vIds[ii];
+                }
+            }
+
+            continue;
+        }
+
+        float l_fDiff = a3FPt[l_oNode.m_i32Dim] - l_oNode.m_fSplit;
+        float l_fFarBound = std::max(l_oElement.second, l_fDiff * l_fDiff);
+        int l_i32Left = l_oElement.first + 1;
+
+        // the nearest child is pushed last to be visited first
+        if(l_fDiff <= 0.f)
+        {
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_oNode.m_i32Right, l_fFarBound);
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_i32Left, l_oElement.second);
+        }
+        else
+        {
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_i32Left, l_fFarBound);
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_oNode.m_i32Right, l_oElement.second);
+        }
+    }
+
+    if(pFSquareDist)
+    {
+        *pFSquareDist = l_fBestDist;
+    }
+
+    return l_i32IdMin;
+}
+
+void SWCloudKdTree::kNearest(cfloat *a3FPt, cuint ui32K, std::vector<int> &vIds, std::vector<float> &vSquareDists) const
+{
+    vIds.clear();
+    vSquareDists.clear();
+
+    if(m_vNodes.empty() || ui32K == 0)
+    {
+        return;
+    }
+
+    std::vector<SWKdCandidate> l_vHeap;
+    l_vHeap.reserve(ui32K + 1);
+
+    SWKdStackElement l_aStack[128];
+    int l_i32StackSize = 0;
+    l_aStack[l_i32StackSize++] = SWKdStackElement(0, 0.f);
+
+    while(l_i32StackSize > 0)
+    {
+        SWKdStackElement l_oElement = l_aStack[--l_i32StackSize];
+
+        if(l_vHeap.size() == ui32K && l_oElement.second > l_vHeap.front().first)
+        {
+            continue;
+        }
+
+        const SWKdNode &l_oNode = m_vNodes[l_oElement.first];
+
+        if(l_oNode.m_i32Dim == -1)
+        {
+            cfloat *l_aFPoint = &m_vPoints[3 * l_oNode.m_i32Begin];
+            for(int ii = l_oNode.m_i32Begin; ii < l_oNode.m_i32End; ++ii, l_aFPoint += 3)
+            {
+                float l_fDX = a3FPt[0] - l_aFPoint[0];
+                float l_fDY = a3FPt[1] - l_aFPoint[1];
+                float l_fDZ = a3FPt[2] - l_aFPoint[2];
+                SWKdCandidate l_oCandidate(l_fDX * l_fDX + l_fDY * l_fDY + l_fDZ * l_fDZ, m_vIds[ii]);
+
+                if(l_vHeap.size() < ui32K)
+                {
+                    l_vHeap.push_back(l_oCandidate);
+                    std::push_heap(l_vHeap.begin(), l_vHeap.end());
+                }
+                else if(l_oCandidate < l_vHeap.front())
+                {
+                    std::pop_heap(l_vHeap.begin(), l_vHeap.end());
+                    l_vHeap.back() = l_oCandidate;
+                    std::push_heap(l_vHeap.begin(), l_vHeap.end());
+                }
+            }
+
+            continue;
+        }
+
+        float l_fDiff = a3FPt[l_oNode.m_i32Dim] - l_oNode.m_fSplit;
+        float l_fFarBound = std::max(l_oElement.second, l_fDiff * l_fDiff);
+        int l_i32Left = l_oElement.first + 1;
+
+        if(l_fDiff <= 0.f)
+        {
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_oNode.m_i32Right, l_fFarBound);
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_i32Left, l_oElement.second);
+        }
+        else
+        {
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_i32Left, l_fFarBound);
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_oNode.m_i32Right, l_oElement.second);
+        }
+    }
+
+    std::sort_heap(l_vHeap.begin(), l_vHeap.end());
+
+    vIds.resize(l_vHeap.size());
+    vSquareDists.resize(l_vHeap.size());
+    for(uint ii = 0; ii < l_vHeap.size(); ++ii)
+    {
+        vSquareDists[ii] = l_vHeap[ii].first;
+        vIds[ii]         = l_vHeap[ii].second;
+    }
+}
+
+void SWCloudKdTree::radius(cfloat *a3FPt, cfloat fRadius, std::vector<int> &vIds, std::vector<float> &vSquareDists) const
+{
+    vIds.clear();
+    vSquareDists.clear();
+
+    if(m_vNodes.empty() || fRadius < 0.f)
+    {
+        return;
+    }
+
+    float l_fSquareRadius = fRadius * fRadius;
+    std::vector<SWKdCandidate> l_vFound;
+
+    SWKdStackElement l_aStack[128];
+    int l_i32StackSize = 0;
+    l_aStack[l_i32StackSize++] = SWKdStackElement(0, 0.f);
+
+    while(l_i32StackSize > 0)
+    {
+        SWKdStackElement l_oElement = l_aStack[--l_i32StackSize];
+
+        if(l_oElement.second > l_fSquareRadius)
+        {
+            continue;
+        }
+
+        const SWKdNode &l_oNode = m_vNodes[l_oElement.first];
+
+        if(l_oNode.m_i32Dim == -1)
+        {
+            cfloat *l_aFPoint = &m_vPoints[3 * l_oNode.m_i32Begin];
+            for(int ii = l_oNode.m_i32Begin; ii < l_oNode.m_i32End; ++ii, l_aFPoint += 3)
+            {
+                float l_fDX = a3FPt[0] - l_aFPoint[0];
+                float l_fDY = a3FPt[1] - l_aFPoint[1];
+                float l_fDZ = a3FPt[2] - l_aFPoint[2];
+                float l_fDist = l_fDX * l_fDX + l_fDY * l_fDY + l_fDZ * l_fDZ;
+
+                if(l_fDist <= l_fSquareRadius)
+                {
+                    l_vFound.push_back(SWKdCandidate(l_fDist, m_vIds[ii]));
+                }
+            }
+
+            continue;
+        }
+
+        float l_fDiff = a3FPt[l_oNode.m_i32Dim] - l_oNode.m_fSplit;
+        float l_fFarBound = std::max(l_oElement.second, l_fDiff * l_fDiff);
+        int l_i32Left = l_oElement.first + 1;
+
+        if(l_fDiff <= 0.f)
+        {
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_oNode.m_i32Right, l_fFarBound);
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_i32Left, l_oElement.second);
+        }
+        else
+        {
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_i32Left, l_fFarBound);
+            l_aStack[l_i32StackSize++] = SWKdStackElement(l_oNode.m_i32Right, l_oElement.second);
+        }
+    }
+
+    std::sort(l_vFound.begin(), l_vFound.end());
+
+    vIds.resize(l_vFound.size());
+    vSquareDists.resize(l_vFound.size());
+    for(uint ii = 0; ii < l_vFound.size(); ++ii)
+    {
+        vSquareDists[ii] = l_vFound[ii].first;
+        vIds[ii]         = l_vFound[ii].second;
+    }
+}
@@ -33,6 +33,8 @@
 
 #include "detect/SWFaceDetection.h"
 
+#include <algorithm>
+
 
 using namespace swDetect;
 using namespace swExcept;
@@ -80,6 +82,11 @@ SWFaceDetection::SWFaceDetection(const cv::Size &oMinDetectFaceSize, cbool bVerb
     // init rects
     m_oLastDetectFace.width = 0;
     m_oLastDetectNose.width = 0;
+
+    // init tracking
+    m_bFaceTracked            = false;
+    m_i32DetectionPeriod      = 15;
+    m_i32FramesSinceDetection = 0;
 }
 
 SWFaceDetection::SWFaceDetection(const cv::Size &oMinDetectFaceSize, const cv::Size &oMaxDetectFaceSize, cbool bVerbose, std::string sClassifierFilePath):
@@ -125,6 +132,11 @@ SWFaceDetection::SWFaceDetection(const cv::Size &oMinDetectFaceSize, const cv::S
     // init rects
         m_oLastDetectFace.width = 0;
         m_oLastDetectNose.width = 0;
+
+    // init tracking
+        m_bFaceTracked            = false;
+        m_i32DetectionPeriod      = 15;
+        m_i32FramesSinceDetection = 0;
 }
 
 void SWFaceDetection::setRectRatios(cfloat fWidthRatio, cfloat fHeightRatio)
@@ -144,6 +156,11 @@ cv::Rect SWFaceDetection::noseRect() const
 }
 
 bool SWFaceDetection::detectFace(const cv::Mat &oRgbImg)
+{
+    return detectFaceInRoi(oRgbImg, cv::Rect(0, 0, oRgbImg.cols, oRgbImg.rows));
+}
+
+bool SWFaceDetection::detectFaceInRoi(const cv::Mat &oRgbImg, const cv::Rect &oRoi)
 {
     if(!m_bHaarCascadeFilesLoaded)
     {
@@ -151,23 +168,27 @@ bool SWFaceDetection::detectFace(const cv::Mat &oRgbImg)
         return false;
     }
 
-    if(m_oMinDetectFaceSize.width > oRgbImg.cols || m_oMinDetectFaceSize.height > oRgbImg.rows)
+    if(m_oMinDetectFaceSize.width > oRoi.width || m_oMinDetectFaceSize.height > oRoi.height)
     {
         std::cerr << "-ERROR : (SWFaceDetection::detectFace) -> The input rgb image is too small for the wanted minimum face size,  the face detection can't be done. " << std::endl;
         return false;
     }
 
     m_oRects.clear();
-    if(m_CHaarCascadeFacePtr->detect(oRgbImg, m_oRects))
+    if(m_CHaarCascadeFacePtr->detect(oRgbImg(oRoi), m_oRects))
     {
-        if(m_oRects[0].x < oRgbImg.cols * (1-m_fWidthRatioImageToDetect)  || m_oRects[0].x + m_oRects[0].width  > m_fWidthRatioImageToDetect  * oRgbImg.cols ||
-           m_oRects[0].y < oRgbImg.rows * (1-m_fHeightRatioImageToDetect) || m_oRects[0].y + m_oRects[0].height > m_fHeightRatioImageToDetect * oRgbImg.rows)
+        // rectangle in the whole image
+        m_oRects[0] += oRoi.tl();
+
+        if(!isInDetectionArea(m_oRects[0], oRgbImg.size()))
         {
             // detected face is not in the part of the image defined by the ratios
             m_oRects.clear();
             return false;
         }
 
+        m_oLastHaarFace = m_oRects[0];
+
         // resize face
         m_oRects[0].y      -= (int)(m_fFaceHeightRatio * m_oRects[0].height);
         m_oRects[0].height += (int)(m_fFaceHeightRatio * 2 * m_oRects[0].height);
@@ -202,6 +223,160 @@ bool SWFaceDetection::detectFace(const cv::Mat &oRgbImg)
     return  false;
 }
 
+bool SWFaceDetection::isInDetectionArea(const cv::Rect &oFaceRect, const cv::Size &oImgSize) const
+{
+    return !(oFaceRect.x < oImgSize.width  * (1-m_fWidthRatioImageToDetect)  || oFaceRect.x + oFaceRect.width  > m_fWidthRatioImageToDetect  * oImgSize.width ||
+             oFaceRect.y < oImgSize.height * (1-m_fHeightRatioImageToDetect) || oFaceRect.y + oFaceRect.height > m_fHeightRatioImageToDetect * oImgSize.height);
+}
+
+bool SWFaceDetection::trackFace(const cv::Mat &oRgbImg)
+{
+    cv::Mat l_oGrayImg;
+    cv::cvtColor(oRgbImg, l_oGrayImg, CV_BGR2GRAY);
+
+    bool l_bFaceFound = false;
+
+    // follow the face between two detections
+        if(m_bFaceTracked && m_i32FramesSinceDetection + 1 < m_i32DetectionPeriod && m_oPreviousGray.size() == l_oGrayImg.size())
+        {
+            l_bFaceFound = trackFaceFlow(l_oGrayImg);
+            ++m_i32FramesSinceDetection;
+        }
+
+    // detect the face, first around its last position
+        if(!l_bFaceFound)
+        {
+            cv::Rect l_oImageRect(0, 0, oRgbImg.cols, oRgbImg.rows);
+
+            if(m_bFaceTracked)
+            {
+                cv::Rect l_oRoi(m_oLastDetectFace.x - m_oLastDetectFace.width/2, m_oLastDetectFace.y - m_oLastDetectFace.height/2,
+                                m_oLastDetectFace.width * 2, m_oLastDetectFace.height * 2);
+                l_oRoi &= l_oImageRect;
+
+                if(l_oRoi.width >= m_oMinDetectFaceSize.width && l_oRoi.height >= m_oMinDetectFaceSize.height)
+                {
+                    l_bFaceFound = detectFaceInRoi(oRgbImg, l_oRoi);
+                }
+            }
+
+            if(!l_bFaceFound)
+            {
+                l_bFaceFound = detectFaceInRoi(oRgbImg, l_oImageRect);
+            }
+
+            m_i32FramesSinceDetection = 0;
+            m_vP2fFeatures.clear();
+
+            // init the features points to track
+            if(l_bFaceFound)
+            {
+                cv::Rect l_oFaceRect = m_oLastDetectFace & l_oImageRect;
+
+                try
+                {
+                    cv::goodFeaturesToTrack(l_oGrayImg(l_oFaceRect), m_vP2fFeatures, 50, 0.01, 3);
+                }
+                catch(const cv::Exception &e)
+                {
+                    std::cerr << "-ERROR : (SWFaceDetection::trackFace) -> " << e.what() << std::endl;
+                    m_vP2fFeatures.clear();
+                }
+
+                for(uint ii = 0; ii < m_vP2fFeatures.size(); ++ii)
+                {
+                    m_vP2fFeatures[ii].x += l_oFaceRect.x;
+                    m_vP2fFeatures[ii].y += l_oFaceRect.y;
+                }
+            }
+        }
+
+    m_bFaceTracked  = l_bFaceFound;
+    m_oPreviousGray = l_oGrayImg;
+
+    return l_bFaceFound;
+}
+
+bool SWFaceDetection::trackFaceFlow(const cv::Mat &oGrayImg)
+{
+    const uint l_ui32MinFeaturesNb = 5;
+
+    if(m_vP2fFeatures.size() < l_ui32MinFeaturesNb)
+    {
+        return false;
+    }
+
+    std::vector<cv::Point2f> l_vP2fPoints;
+    std::vector<uchar> l_vU8Status;
+
+    try
+    {
+        m_oTrackFlow.track(m_oPreviousGray, oGrayImg, m_vP2fFeatures, l_vP2fPoints, l_vU8Status);
+    }
+    catch(const swExcept::opticalFlowError &e)
+    {
+        std::cerr << "-ERROR : (SWFaceDetection::trackFaceFlow) -> " << e.what() << std::endl;
+        return false;
+    }
+
+    // keep the points found in the current image
+        std::vector<float> l_vFDx, l_vFDy;
+        std::vector<cv::Point2f> l_vP2fFound;
+
+        for(uint ii = 0; ii < l_vU8Status.size(); ++ii)
+        {
+            if(l_vU8Status[ii])
+            {
+                l_vFDx.push_back(l_vP2fPoints[ii].x - m_vP2fFeatures[ii].x);
+                l_vFDy.push_back(l_vP2fPoints[ii].y - m_vP2fFeatures[ii].y);
+                l_vP2fFound.push_back(l_vP2fPoints[ii]);
+            }
+        }
+
+    // the tracking is lost if half of the points are not found
+        if(l_vP2fFound.size() < l_ui32MinFeaturesNb || 2 * l_vP2fFound.size() < m_vP2fFeatures.size())
+        {
+            return false;
+        }
+
+    // move the rectangle with the median displacement of the points (robust to the points sliding on the background)
+        std::nth_element(l_vFDx.begin(), l_vFDx.begin() + l_vFDx.size()/2, l_vFDx.end());
+        std::nth_element(l_vFDy.begin(), l_vFDy.begin() + l_vFDy.size()/2, l_vFDy.end());
+
+        cv::Point l_oMedianMove(cvRound(l_vFDx[l_vFDx.size()/2]), cvRound(l_vFDy[l_vFDy.size()/2]));
+        cv::Rect l_oFaceRect     = m_oLastDetectFace + l_oMedianMove;
+        cv::Rect l_oHaarFaceRect = m_oLastHaarFace   + l_oMedianMove;
+
+        if((l_oFaceRect & cv::Rect(0, 0, oGrayImg.cols, oGrayImg.rows)) != l_oFaceRect)
+        {
+            return false;
+        }
+
+    // the tracked face must stay in the part of the image defined by the ratios, as the detected faces
+        if(!isInDetectionArea(l_oHaarFaceRect, oGrayImg.size()))
+        {
+            return false;
+        }
+
+    m_oLastDetectFace = l_oFaceRect;
+    m_oLastHaarFace   = l_oHaarFaceRect;
+    m_vP2fFeatures    = l_vP2fFound;
+
+    return true;
+}
+
+void SWFaceDetection::setDetectionPeriod(cint i32FramesNb)
+{
+    m_i32DetectionPeriod = std::max(1, i32FramesNb);
+}
+
+void SWFaceDetection::resetTracking()
+{
+    m_bFaceTracked            = false;
+    m_i32FramesSinceDetection = 0;
+    m_vP2fFeatures.clear();
+    m_oPreviousGray.release();
+}
 
 cv::Rect SWFaceDetection::detectNose(const cv::Mat &oRgbImg)
 {
@@ -222,7 +397,29 @@ cv::Rect SWFaceDetection::detectNose(const cv::Mat &oRgbImg)
 
     m_oRects.clear();
 
-    if(m_CHaarCascadeNosePtr->detect(oRgbImg, m_oRects))
+    bool l_bNoseDetected = false;
+
+    // search the nose around its last position first
+        if(m_oLastDetectNose.width > 0)
+        {
+            cv::Rect l_oRoi(m_oLastDetectNose.x - m_oLastDetectNose.width/2, m_oLastDetectNose.y - m_oLastDetectNose.height/2,
+                            m_oLastDetectNose.width * 2, m_oLastDetectNose.height * 2);
+            l_oRoi &= cv::Rect(0, 0, oRgbImg.cols, oRgbImg.rows);
+
+            if(l_oRoi.width >= m_oMinDetectNoseSize.width && l_oRoi.height >= m_oMinDetectNoseSize.height &&
+               m_CHaarCascadeNosePtr->detect(oRgbImg(l_oRoi), m_oRects))
+            {
+                m_oRects[0]    += l_oRoi.tl();
+                l_bNoseDetected = true;
+            }
+        }
+
+        if(!l_bNoseDetected)
+        {
+            l_bNoseDetected = m_CHaarCascadeNosePtr->detect(oRgbImg, m_oRects);
+        }
+
+    if(l_bNoseDetected)
     {
         m_oLastDetectNose = m_oRects[0];
     }
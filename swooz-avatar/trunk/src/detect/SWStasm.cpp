@@ -34,17 +34,57 @@
 #include "detect/SWStasm.h"
 #include "stdafx.h"
 
+#include <map>
+
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#if defined(_M_X64) || defined(__SSE2__)
+    #define SWSTASM_SSE
+    #include <emmintrin.h>
+#endif
+
 using namespace swDetect;
 using namespace swExcept;
 
+static boost::mutex g_oModelsMutex;                                         /**< protects g_mModels and the stasm config globals */
+static std::map<std::string, boost::weak_ptr<const SWStasmModels> > g_mModels; /**< models loaded, by config files paths */
+
+/**
+ * \brief Return the models of a pair of config files, they are read only if no other instance is using them.
+ * \param [in] sConfFile0Path : stasm config file 0 path
+ * \param [in] sConfFile1Path : stasm config file 1 path
+ */
+static SWStasmModelsPtr loadModels(const std::string &sConfFile0Path, const std::string &sConfFile1Path)
+{
+    // the stasm init reads the config files in globals, only one thread at a time
+    boost::mutex::scoped_lock l_oLock(g_oModelsMutex);
+
+    std::string l_sKey = sConfFile0Path + "|" + sConfFile1Path;
+    SWStasmModelsPtr l_pModels = g_mModels[l_sKey].lock();
+
+    if(!l_pModels)
+    {
+        boost::shared_ptr<SWStasmModels> l_pNewModels(new SWStasmModels());
+        l_pNewModels->m_i32ModelsNb = nInitAsmModels(l_pNewModels->m_aModels, sConfFile0Path.c_str(), sConfFile1Path.c_str());
+        l_pNewModels->m_dVjScale    = CONF_VjScale;
+
+        l_pModels         = l_pNewModels;
+        g_mModels[l_sKey] = l_pModels;
+    }
+
+    return l_pModels;
+}
+
 SWStasm::SWStasm(const std::string &sConfFile0Path, const std::string &sConfFile1Path) :
     m_sConfFile0(sConfFile0Path), m_sConfFile1(sConfFile1Path)
 {
 	// init result features points array
     m_oFeaturesPoints.assign(68, cv::Point2i(0,0));
 
-	// read and inits models
-	m_i32InitializedModels = nInitAsmModels(m_oModels, sConfFile0Path.c_str(), sConfFile1Path.c_str());	
+	// read and inits models, or share them with the other instances
+	m_pModels = loadModels(sConfFile0Path, sConfFile1Path);
+	m_i32InitializedModels = m_pModels->m_i32ModelsNb;
 	std::cout << "Number of stasm models initialized : " << m_i32InitializedModels << std::endl;
 	
 	if(m_i32InitializedModels != 2)
@@ -86,21 +126,72 @@ void SWStasm::convRectToStasmDetParams(const cv::Rect &oCurrAugmentedRectFace, c
 	oDetParams.height = l_oRectToUse.height;
 }
 
-void SWStasm::convMatToStasmImage(const cv::Mat &oCurrRgbMat, ImageT<RGB_TRIPLE> &oStasmImage)
+bool SWStasm::convMatToStasmGrayImage(const cv::Mat &oBgrMat, Image &oStasmGrayImage)
 {
-	// init data
-	for(int ii = 0; ii < oCurrRgbMat.rows ; ++ii)
-	{
-		for(int jj = 0; jj < oCurrRgbMat.cols; ++jj)
-		{
-			RGB_TRIPLE l_oRgb;
-			l_oRgb.Red  = oCurrRgbMat.at<cv::Vec<uchar, 3> >(ii,jj)[2];
-			l_oRgb.Green= oCurrRgbMat.at<cv::Vec<uchar, 3> >(ii,jj)[1];
-			l_oRgb.Blue = oCurrRgbMat.at<cv::Vec<uchar, 3> >(ii,jj)[0];
+    if(oBgrMat.type() != CV_8UC3)
+    {
+        std::cerr << "-ERROR : (SWStasm::convMatToStasmGrayImage) -> the input mat must be a CV_8UC3 bgr mat. " << std::endl;
+        return false;
+    }
 
-			oStasmImage(jj,oCurrRgbMat.rows-1 - ii) = l_oRgb;
-		}
-	}
+    oStasmGrayImage.dim(oBgrMat.cols, oBgrMat.rows);
+
+    // the rgb stasm image was filled with the rows flipped and ConvertRgbImageToGray flips them back,
+    // so the gray image rows are in the order of the mat rows.
+    // RgbToGray computes (299 R + 587 G + 114 B + 500) / 1000, the division is replaced by ((x >> 3) * 33555) >> 22
+    // which gives the same result for every possible x (x <= 255500)
+#ifdef SWSTASM_SSE
+    // 8 pixels per iteration : SSE2 has no byte shuffle, each pixel is read with a 4 bytes load (the 4th byte is masked),
+    // then 114 B + 587 G and 299 R + 500 are computed with _mm_madd_epi16 in 32 bits lanes.
+    // x >> 3 <= 31937 fits in 16 bits, ((x >> 3) * 33555) >> 22 is computed as _mm_mulhi_epu16 followed by a shift of 6.
+    const __m128i l_oByteMask   = _mm_set1_epi32(0xFF);
+    const __m128i l_oHighOne    = _mm_set1_epi32(1 << 16);
+    const __m128i l_oWeightsBG  = _mm_set1_epi32(114 | (587 << 16));
+    const __m128i l_oWeightsR1  = _mm_set1_epi32(299 | (500 << 16));
+    const __m128i l_oDivisor    = _mm_set1_epi16(static_cast<short>(33555));
+#endif
+
+    for(int ii = 0; ii < oBgrMat.rows; ++ii)
+    {
+        const uchar *l_pBgr  = oBgrMat.ptr<uchar>(ii);
+        byte *l_pGray        = oStasmGrayImage.buf + ii * oBgrMat.cols;
+        int jj = 0;
+
+#ifdef SWSTASM_SSE
+        // the 4 bytes load of the 8th pixel reads the first byte of the next pixel, which must be in the row
+        for(; jj + 8 < oBgrMat.cols; jj += 8, l_pBgr += 24)
+        {
+            int l_a8I32Pixels[8];
+            for(int kk = 0; kk < 8; ++kk)
+            {
+                memcpy(&l_a8I32Pixels[kk], l_pBgr + 3 * kk, 4);
+            }
+
+            __m128i l_aSums[2];
+            for(int kk = 0; kk < 2; ++kk)
+            {
+                __m128i l_oPixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(l_a8I32Pixels + 4 * kk));
+                __m128i l_oB      = _mm_and_si128(l_oPixels, l_oByteMask);
+                __m128i l_oG      = _mm_and_si128(_mm_srli_epi32(l_oPixels, 8),  l_oByteMask);
+                __m128i l_oR      = _mm_and_si128(_mm_srli_epi32(l_oPixels, 16), l_oByteMask);
+
+                __m128i l_oSum = _mm_add_epi32(_mm_madd_epi16(_mm_or_si128(l_oB, _mm_slli_epi32(l_oG, 16)), l_oWeightsBG),
+                                               _mm_madd_epi16(_mm_or_si128(l_oR, l_oHighOne), l_oWeightsR1));
+                l_aSums[kk] = _mm_srli_epi32(l_oSum, 3);
+            }
+
+            __m128i l_oGray = _mm_srli_epi16(_mm_mulhi_epu16(_mm_packs_epi32(l_aSums[0], l_aSums[1]), l_oDivisor), 6);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(l_pGray + jj), _mm_packus_epi16(l_oGray, l_oGray));
+        }
+#endif
+        for(; jj < oBgrMat.cols; ++jj, l_pBgr += 3)
+        {
+            uint l_ui32Sum = 114u * l_pBgr[0] + 587u * l_pBgr[1] + 299u * l_pBgr[2] + 500u;
+            l_pGray[jj]    = static_cast<byte>(((l_ui32Sum >> 3) * 33555u) >> 22);
+        }
+    }
+
+    return true;
 }
 
     
@@ -115,37 +206,30 @@ bool SWStasm::launchAsmSearch(const cv::Mat &oCurrRgbMat,  cv::Rect &oCurrFaceRe
 	try
 	{		
 		DET_PARAMS l_oDetParams;
-		cv::Mat l_oCurrRgbMatResized = oCurrRgbMat.clone();		
 
 		// init augmented face rectangle
 		cv::Rect l_oAugmentedFaceRect = oCurrFaceRect;
-		cv::Mat l_oFaceRgbMat;		
 		l_oAugmentedFaceRect.x       -= oCurrFaceRect.width /10;
 		l_oAugmentedFaceRect.y       -= oCurrFaceRect.height /10;
 		l_oAugmentedFaceRect.width   += oCurrFaceRect.width  /5;
 		l_oAugmentedFaceRect.height  += oCurrFaceRect.height /5;	
-		l_oFaceRgbMat = l_oCurrRgbMatResized.clone()(l_oAugmentedFaceRect);
-		
-		// conv opencv mat to stasm image
-		ImageT<RGB_TRIPLE> l_oStasmImage(l_oFaceRgbMat.cols, l_oFaceRgbMat.rows);
-		ImageT<unsigned char> l_oStasmGrayImage(l_oFaceRgbMat.cols, l_oFaceRgbMat.rows);
-
-		// convert cv::mat to stasm image
-		convMatToStasmImage(l_oFaceRgbMat, l_oStasmImage);
 
-		// convert to gray image
-		ConvertRgbImageToGray(l_oStasmGrayImage, l_oStasmImage);
+		// convert the face roi to a gray stasm image (the roi is only read, no copy needed)
+		if(!convMatToStasmGrayImage(oCurrRgbMat(l_oAugmentedFaceRect), m_oStasmGrayImage))
+		{
+			return false;
+		}
 
 		// conv opencv rect to stasm det_params
 		convRectToStasmDetParams(l_oAugmentedFaceRect, oCurrFaceRect, l_oDetParams);
 
-		SHAPE l_oDetAttr = m_oModels[0].VjAv;
+		SHAPE l_oDetAttr = m_pModels->m_aModels[0].VjAv;
 		SHAPE l_oStartShape, l_oShape;
 			
 		
 		// Align l_oDetParams to the face detector parameters and return it as StartShape
 		// This undoes AlignToDetFrame().  It ignores the eye positions, if any.
-		AlignStartShapeToDet(l_oStartShape, l_oDetParams, l_oDetAttr, CONF_VjScale);
+		AlignStartShapeToDet(l_oStartShape, l_oDetParams, l_oDetAttr, m_pModels->m_dVjScale);
 		
 		// Jitter points at 0,0 if any.
 		// In a shape, both x and y equal to 0 is taken by the stasm software to mean
@@ -159,7 +243,7 @@ bool SWStasm::launchAsmSearch(const cv::Mat &oCurrRgbMat,  cv::Rect &oCurrFaceRe
 			
 		for (int iiModel = 0; iiModel < m_i32InitializedModels; iiModel++)
 		{
-			ASM_MODEL *l_oModel = &m_oModels[iiModel];
+			const ASM_MODEL *l_oModel = &m_pModels->m_aModels[iiModel];
 				
 			// if (iiModel != 0)
 			if (m_bInitFirstShape)
@@ -172,11 +256,11 @@ bool SWStasm::launchAsmSearch(const cv::Mat &oCurrRgbMat,  cv::Rect &oCurrFaceRe
 			// using the start shape to approximate the face width.
 			double l_dImageScale = l_oModel->nStandardFaceWidth / xShapeExtent(l_oShape);
 			SHAPE l_oWorkingShape(l_oShape * l_dImageScale);   		// working shape
-			Image l_oWorkingImage(l_oStasmGrayImage);      	  		// working Img
-			
-			int l_i32NewWidth  = iround(l_oWorkingImage.width  * l_dImageScale);
-			int l_i32NewHeight = iround(l_oWorkingImage.height * l_dImageScale);
-			ScaleImage(l_oWorkingImage, l_i32NewWidth, l_i32NewHeight, IM_BILINEAR);
+
+			// working Img, scaled from the gray image in the kept buffers (no allocation if the sizes don't change)
+			int l_i32NewWidth  = iround(m_oStasmGrayImage.width  * l_dImageScale);
+			int l_i32NewHeight = iround(m_oStasmGrayImage.height * l_dImageScale);
+			ScaleImageInto(m_oWorkingImage, m_oScaleImage, m_oStasmGrayImage, l_i32NewWidth, l_i32NewHeight, IM_BILINEAR);
 
 			// dimKeep is needed when this model has different number
 			// of landmarks from previous model
@@ -189,15 +273,13 @@ bool SWStasm::launchAsmSearch(const cv::Mat &oCurrRgbMat,  cv::Rect &oCurrFaceRe
 			{
 				double l_dPyrScale =  pow(l_oModel->PyrRatio, iiLev );  // GetPyrScale(iiLev, pModel->PyrRatio);
 				
-				SEARCH_IMAGES l_oSearchImgs;   		  		// the images used during search
-				l_oSearchImgs.Img = l_oWorkingImage;      	        // l_oSearchImgs.Img gets scaled to this pyr lev
-				
-				ReduceImage(l_oSearchImgs.Img, l_dPyrScale, l_oModel->PyrReduceMethod);
+				SEARCH_IMAGES &l_oSearchImgs = m_oSearchImages;  	// the images used during search, kept between the levels and the searches
+				ReduceImageInto(l_oSearchImgs.Img, m_oScaleImage, m_oWorkingImage, l_dPyrScale, l_oModel->PyrReduceMethod); // scaled to this pyr lev
 				
 				InitGradsIfNeeded(l_oSearchImgs.Grads,   	        // get l_oSearchImgs.Grads
                 l_oModel->AsmLevs[iiLev].ProfSpecs, l_oSearchImgs.Img, static_cast<int>(l_oWorkingShape.nrows()));
 
-				AsmLevSearch(l_oWorkingShape, l_oSearchImgs, m_oModels[iiModel], iiLev, gLandTab);
+				AsmLevSearch(l_oWorkingShape, l_oSearchImgs, *l_oModel, iiLev, gLandTab, m_oWorkspace);
 
 				// use best shape from this iter as starting point for next
 				if (iiLev != 0) 
@@ -0,0 +1,479 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file emicp_cpu.cpp
+ * \brief CPU implementation of the EM-ICP registration of emicp.cu
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+#include <vector>
+#include <algorithm>
+
+#include "emicp/3dregistration.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+    #define EMICP_CPU_SSE
+    #include <emmintrin.h>
+#endif
+
+
+// The CUDA version stores the whole (Ysize x Xsize) matrix A, but every step of the softassign is done row by row :
+//  A(r,c)    = exp(-|X(c) - (R Y(r) + t)|^2 / sigma_p2)
+//  C(r)      = sum_c A(r,c) + exp(-d_02 / sigma_p2)
+//  A(r,c)    = sqrt(A(r,c) / C(r))
+//  lambda(r) = sum_c A(r,c)
+//  X'(r)     = sum_c A(r,c) X(c) / lambda(r)
+// so each thread only needs one row of A (Xsize floats), and the rows are distributed dynamically on the threads.
+
+// X is reordered in spatially coherent tiles of EMICP_TILE_SIZE points with their bounding box : when the whole box of a tile is
+// too far from the current Y point, all its exp(-d/sigma_p2) are null in float and the tile is skipped.
+#define EMICP_TILE_SIZE 32
+
+// below this value, expf(x) is considered as 0 (exp_ps returns 0)
+#define EMICP_EXP_MIN -87.f
+
+#ifdef EMICP_CPU_SSE
+
+/**
+ * \brief Compute exp(x) on 4 floats (cephes polynomial, relative error < 2e-7), exp(x) = 0 for x < -87.
+ */
+static inline __m128 exp_ps(__m128 x)
+{
+    const __m128 l_oZeroMask = _mm_cmpgt_ps(x, _mm_set1_ps(EMICP_EXP_MIN));
+
+    x = _mm_min_ps(x, _mm_set1_ps( 88.3762626647949f));
+    x = _mm_max_ps(x, _mm_set1_ps(EMICP_EXP_MIN));
+
+    // exp(x) = 2^n * exp(g), n = round(x / log(2))
+    __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+    __m128i emm0 = _mm_cvttps_epi32(fx);
+    __m128 tmp = _mm_cvtepi32_ps(emm0);
+    fx = _mm_sub_ps(tmp, _mm_and_ps(_mm_cmpgt_ps(tmp, fx), _mm_set1_ps(1.f))); // floor
+
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 z = _mm_mul_ps(x, x);
+    __m128 y = _mm_set1_ps(1.9875691500E-4f);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507E-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073E-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894E-2f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459E-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201E-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, z), _mm_add_ps(x, _mm_set1_ps(1.f)));
+
+    emm0 = _mm_cvttps_epi32(fx);
+    emm0 = _mm_slli_epi32(_mm_add_epi32(emm0, _mm_set1_epi32(0x7f)), 23);
+
+    return _mm_and_ps(_mm_mul_ps(y, _mm_castsi128_ps(emm0)), l_oZeroMask);
+}
+
+/**
+ * \brief Return the sum of the 4 floats.
+ */
+static inline float hsum_ps(const __m128 v)
+{
+    float l_a4F[4];
+    _mm_storeu_ps(l_a4F, v);
+    return (l_a4F[0] + l_a4F[1]) + (l_a4F[2] + l_a4F[3]);
+}
+
+#endif
+
+/**
+ * \struct SWAxisComparator
+ * \brief Compare the coordinates of two points on one axis.
+ */
+struct SWAxisComparator
+{
+    SWAxisComparator(const float *aFAxis) : m_aFAxis(aFAxis)
+    {}
+
+    bool operator()(const int i1, const int i2) const
+    {
+        return m_aFAxis[i1] < m_aFAxis[i2];
+    }
+
+    const float *m_aFAxis;
+};
+
+/**
+ * \brief Split recursively the points [i32Begin, i32End) of vOrder in tiles of EMICP_TILE_SIZE points (median split on the largest extent).
+ */
+static void buildTiles(const float *h_Xx, const float *h_Xy, const float *h_Xz, std::vector<int> &vOrder, const int i32Begin, const int i32End)
+{
+    if(i32End - i32Begin <= EMICP_TILE_SIZE)
+    {
+        return;
+    }
+
+    const float *l_aAxis[3] = {h_Xx, h_Xy, h_Xz};
+    float l_a3FMin[3] = {FLT_MAX, FLT_MAX, FLT_MAX}, l_a3FMax[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+    for(int ii = i32Begin; ii < i32End; ++ii)
+    {
+        for(int jj = 0; jj < 3; ++jj)
+        {
+            l_a3FMin[jj] = std::min(l_a3FMin[jj], l_aAxis[jj][vOrder[ii]]);
+            l_a3FMax[jj] = std::max(l_a3FMax[jj], l_aAxis[jj][vOrder[ii]]);
+        }
+    }
+
+    int l_i32Dim = 0;
+    for(int jj = 1; jj < 3; ++jj)
+    {
+        if(l_a3FMax[jj] - l_a3FMin[jj] > l_a3FMax[l_i32Dim] - l_a3FMin[l_i32Dim])
+        {
+            l_i32Dim = jj;
+        }
+    }
+
+    // the left part is a multiple of the tile size
+    const int l_i32TilesNb = (i32End - i32Begin + EMICP_TILE_SIZE - 1) / EMICP_TILE_SIZE;
+    const int l_i32Middle  = i32Begin + ((l_i32TilesNb + 1) / 2) * EMICP_TILE_SIZE;
+
+    std::nth_element(vOrder.begin() + i32Begin, vOrder.begin() + l_i32Middle, vOrder.begin() + i32End, SWAxisComparator(l_aAxis[l_i32Dim]));
+
+    buildTiles(h_Xx, h_Xy, h_Xz, vOrder, i32Begin, l_i32Middle);
+    buildTiles(h_Xx, h_Xy, h_Xz, vOrder, l_i32Middle, i32End);
+}
+
+/**
+ * \brief Compute exp(-d/sigma_p2) for the EMICP_TILE_SIZE points of a tile and return their sum.
+ */
+static inline float softassignTileExp(const float *h_Xx, const float *h_Xy, const float *h_Xz, const float *a3FY, const float fInvSigmaP2, float *aFRow)
+{
+#ifdef EMICP_CPU_SSE
+    const __m128 l_oYx = _mm_set1_ps(a3FY[0]), l_oYy = _mm_set1_ps(a3FY[1]), l_oYz = _mm_set1_ps(a3FY[2]);
+    const __m128 l_oMinusInvSigma = _mm_set1_ps(-fInvSigmaP2);
+    __m128 l_oSum = _mm_setzero_ps();
+
+    for(int c = 0; c < EMICP_TILE_SIZE; c += 4)
+    {
+        __m128 l_oDx = _mm_sub_ps(_mm_loadu_ps(h_Xx + c), l_oYx);
+        __m128 l_oDy = _mm_sub_ps(_mm_loadu_ps(h_Xy + c), l_oYy);
+        __m128 l_oDz = _mm_sub_ps(_mm_loadu_ps(h_Xz + c), l_oYz);
+        __m128 l_oDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l_oDx, l_oDx), _mm_mul_ps(l_oDy, l_oDy)), _mm_mul_ps(l_oDz, l_oDz));
+
+        __m128 l_oA = exp_ps(_mm_mul_ps(l_oDist, l_oMinusInvSigma));
+        _mm_storeu_ps(aFRow + c, l_oA);
+        l_oSum = _mm_add_ps(l_oSum, l_oA);
+    }
+
+    return hsum_ps(l_oSum);
+#else
+    float l_fSum = 0.f;
+
+    for(int c = 0; c < EMICP_TILE_SIZE; ++c)
+    {
+        float l_fDx = h_Xx[c] - a3FY[0], l_fDy = h_Xy[c] - a3FY[1], l_fDz = h_Xz[c] - a3FY[2];
+        float l_fExp = -(l_fDx*l_fDx + l_fDy*l_fDy + l_fDz*l_fDz) * fInvSigmaP2;
+        aFRow[c] = (l_fExp > EMICP_EXP_MIN) ? expf(l_fExp) : 0.f;
+        l_fSum += aFRow[c];
+    }
+
+    return l_fSum;
+#endif
+}
+
+/**
+ * \brief Accumulate sqrt(A(r,c)/C(r)), and sqrt(A(r,c)/C(r)) * X(c) for the EMICP_TILE_SIZE points of a tile.
+ */
+static inline void softassignTileWeights(const float *h_Xx, const float *h_Xy, const float *h_Xz, const float fInvC, const float *aFRow, float *a4FSums)
+{
+#ifdef EMICP_CPU_SSE
+    const __m128 l_oInvC = _mm_set1_ps(fInvC);
+    __m128 l_oLambda = _mm_setzero_ps(), l_oX = _mm_setzero_ps(), l_oY = _mm_setzero_ps(), l_oZ = _mm_setzero_ps();
+
+    for(int c = 0; c < EMICP_TILE_SIZE; c += 4)
+    {
+        __m128 l_oA = _mm_sqrt_ps(_mm_mul_ps(_mm_loadu_ps(aFRow + c), l_oInvC));
+        l_oLambda   = _mm_add_ps(l_oLambda, l_oA);
+        l_oX        = _mm_add_ps(l_oX, _mm_mul_ps(l_oA, _mm_loadu_ps(h_Xx + c)));
+        l_oY        = _mm_add_ps(l_oY, _mm_mul_ps(l_oA, _mm_loadu_ps(h_Xy + c)));
+        l_oZ        = _mm_add_ps(l_oZ, _mm_mul_ps(l_oA, _mm_loadu_ps(h_Xz + c)));
+    }
+
+    a4FSums[0] += hsum_ps(l_oLambda);
+    a4FSums[1] += hsum_ps(l_oX);
+    a4FSums[2] += hsum_ps(l_oY);
+    a4FSums[3] += hsum_ps(l_oZ);
+#else
+    for(int c = 0; c < EMICP_TILE_SIZE; ++c)
+    {
+        float l_fA = sqrtf(aFRow[c] * fInvC);
+        a4FSums[0] += l_fA;
+        a4FSums[1] += l_fA * h_Xx[c];
+        a4FSums[2] += l_fA * h_Xy[c];
+        a4FSums[3] += l_fA * h_Xz[c];
+    }
+#endif
+}
+
+/**
+ * \brief Compute one row of the softassign matrix and reduce it to lambda(r) and X'(r).
+ * \param [in]  i32TilesNb      : number of tiles of X
+ * \param [in]  h_Xx,h_Xy,h_Xz  : coordinates of X in the tiles order (padded to i32TilesNb * EMICP_TILE_SIZE)
+ * \param [in]  aFTilesBox      : bounding box of each tile [xmin,ymin,zmin,xmax,ymax,zmax]
+ * \param [in]  a3FY            : transformed point R Y(r) + t
+ * \param [in]  fInvSigmaP2     : 1 / sigma_p2
+ * \param [in]  fOutlier        : exp(-d_02 / sigma_p2)
+ * \param [in]  a3FXMean        : mean point of X (used when the row sum is null)
+ * \param [out] aFRow           : work buffer (i32TilesNb * EMICP_TILE_SIZE)
+ * \param [out] aI32ActiveTiles : work buffer (i32TilesNb)
+ * \param [out] fLambda         : lambda(r)
+ * \param [out] a3FXprime       : X'(r)
+ */
+static void softassignRow(const int i32TilesNb, const float *h_Xx, const float *h_Xy, const float *h_Xz, const float *aFTilesBox,
+                          const float *a3FY, const float fInvSigmaP2, const float fOutlier, const float *a3FXMean,
+                          float *aFRow, int *aI32ActiveTiles, float &fLambda, float *a3FXprime)
+{
+    // A(r,c) and C(r) on the tiles which are close enough
+    int l_i32ActiveTilesNb = 0;
+    float l_fC = 0.f;
+
+    for(int t = 0; t < i32TilesNb; ++t)
+    {
+        const float *l_aFBox = &aFTilesBox[6*t];
+        float l_fDx = std::max(0.f, std::max(l_aFBox[0] - a3FY[0], a3FY[0] - l_aFBox[3]));
+        float l_fDy = std::max(0.f, std::max(l_aFBox[1] - a3FY[1], a3FY[1] - l_aFBox[4]));
+        float l_fDz = std::max(0.f, std::max(l_aFBox[2] - a3FY[2], a3FY[2] - l_aFBox[5]));
+
+        if(-(l_fDx*l_fDx + l_fDy*l_fDy + l_fDz*l_fDz) * fInvSigmaP2 <= EMICP_EXP_MIN)
+        {
+            continue;
+        }
+
+        const int l_i32Offset = t * EMICP_TILE_SIZE;
+        l_fC += softassignTileExp(h_Xx + l_i32Offset, h_Xy + l_i32Offset, h_Xz + l_i32Offset, a3FY, fInvSigmaP2, aFRow + l_i32Offset);
+        aI32ActiveTiles[l_i32ActiveTilesNb++] = t;
+    }
+
+    l_fC += fOutlier;
+
+    if(l_fC <= 10e-7f)
+    {
+        // every element of the row is set to 1/Xsize in emicp.cu (ad hoc code to avoid 0 division)
+        fLambda = 1.f;
+        a3FXprime[0] = a3FXMean[0];
+        a3FXprime[1] = a3FXMean[1];
+        a3FXprime[2] = a3FXMean[2];
+        return;
+    }
+
+    // sqrt(A(r,c) / C(r)), lambda(r) and X'(r)
+    const float l_fInvC = 1.f / l_fC;
+    float l_a4FSums[4] = {0.f, 0.f, 0.f, 0.f};
+
+    for(int ii = 0; ii < l_i32ActiveTilesNb; ++ii)
+    {
+        const int l_i32Offset = aI32ActiveTiles[ii] * EMICP_TILE_SIZE;
+        softassignTileWeights(h_Xx + l_i32Offset, h_Xy + l_i32Offset, h_Xz + l_i32Offset, l_fInvC, aFRow + l_i32Offset, l_a4FSums);
+    }
+
+    fLambda = l_a4FSums[0];
+
+    if(l_a4FSums[0] > 0.f)
+    {
+        a3FXprime[0] = l_a4FSums[1] / l_a4FSums[0];
+        a3FXprime[1] = l_a4FSums[2] / l_a4FSums[0];
+        a3FXprime[2] = l_a4FSums[3] / l_a4FSums[0];
+    }
+    else
+    {
+        // only the outlier term is not null : the row has no weight in S (emicp.cu would produce a NaN here)
+        a3FXprime[0] = a3FXprime[1] = a3FXprime[2] = 0.f;
+    }
+}
+
+
+bool emicp_cpu(int Xsize, int Ysize,
+           const float* h_X,
+           const float* h_Y,
+           float* h_R, float* h_t,
+           registration::registrationParameters param)
+{
+    if(Xsize <= 0 || Ysize <= 0)
+    {
+        fprintf(stderr, "emicp_cpu : empty point set. \n");
+        return false;
+    }
+
+    float sigma_p2     = param.sigma_p2;
+    float sigma_inf    = param.sigma_inf;
+    float sigma_factor = param.sigma_factor;
+    float d_02         = param.d_02;
+
+    const float *h_Yx = &h_Y[Ysize*0], *h_Yy = &h_Y[Ysize*1], *h_Yz = &h_Y[Ysize*2];
+
+    // reorder X in tiles
+    const int l_i32TilesNb = (Xsize + EMICP_TILE_SIZE - 1) / EMICP_TILE_SIZE;
+    const int l_i32XPadded = l_i32TilesNb * EMICP_TILE_SIZE;
+
+    std::vector<int> l_vOrder(Xsize);
+    for(int ii = 0; ii < Xsize; ++ii)
+    {
+        l_vOrder[ii] = ii;
+    }
+    buildTiles(&h_X[Xsize*0], &h_X[Xsize*1], &h_X[Xsize*2], l_vOrder, 0, Xsize);
+
+    // the padding points are far enough to always have a null weight
+    std::vector<float> l_vX(3*l_i32XPadded, 1e10f), l_vTilesBox(6*l_i32TilesNb);
+    float *h_Xx = &l_vX[l_i32XPadded*0], *h_Xy = &l_vX[l_i32XPadded*1], *h_Xz = &l_vX[l_i32XPadded*2];
+
+    double l_a3DXMean[3] = {0.,0.,0.};
+    for(int ii = 0; ii < Xsize; ++ii)
+    {
+        h_Xx[ii] = h_X[Xsize*0 + l_vOrder[ii]];
+        h_Xy[ii] = h_X[Xsize*1 + l_vOrder[ii]];
+        h_Xz[ii] = h_X[Xsize*2 + l_vOrder[ii]];
+
+        l_a3DXMean[0] += h_Xx[ii]; l_a3DXMean[1] += h_Xy[ii]; l_a3DXMean[2] += h_Xz[ii];
+    }
+
+    // mean of X, used for the rows without any weight
+    float l_a3FXMean[3];
+    for(int ii = 0; ii < 3; ++ii)
+    {
+        l_a3FXMean[ii] = static_cast<float>(l_a3DXMean[ii] / Xsize);
+    }
+
+    for(int t = 0; t < l_i32TilesNb; ++t)
+    {
+        float *l_aFBox = &l_vTilesBox[6*t];
+        l_aFBox[0] = l_aFBox[1] = l_aFBox[2] =  FLT_MAX;
+        l_aFBox[3] = l_aFBox[4] = l_aFBox[5] = -FLT_MAX;
+
+        for(int ii = t * EMICP_TILE_SIZE; ii < std::min(Xsize, (t+1) * EMICP_TILE_SIZE); ++ii)
+        {
+            l_aFBox[0] = std::min(l_aFBox[0], h_Xx[ii]); l_aFBox[3] = std::max(l_aFBox[3], h_Xx[ii]);
+            l_aFBox[1] = std::min(l_aFBox[1], h_Xy[ii]); l_aFBox[4] = std::max(l_aFBox[4], h_Xy[ii]);
+            l_aFBox[2] = std::min(l_aFBox[2], h_Xz[ii]); l_aFBox[5] = std::max(l_aFBox[5], h_Xz[ii]);
+        }
+    }
+
+    std::vector<float> l_vLambda(Ysize), l_vXprime(3*Ysize);
+
+    // EM-ICP main loop, same annealing schedule than emicp.cu
+    while(sigma_p2 > sigma_inf)
+    {
+        const float l_fInvSigmaP2 = 1.f / sigma_p2;
+        const float l_fOutlier    = expf(-d_02 / sigma_p2);
+
+        float l_aFR[9], l_aFT[3];
+        for(int ii = 0; ii < 9; ++ii) l_aFR[ii] = h_R[ii];
+        for(int ii = 0; ii < 3; ++ii) l_aFT[ii] = h_t[ii];
+
+        // softassign : one row per Y point, each row is written in its own slot so the result does not depend on the threads number
+        #pragma omp parallel
+        {
+            std::vector<float> l_vRow(l_i32XPadded);
+            std::vector<int> l_vActiveTiles(l_i32TilesNb);
+
+            #pragma omp for schedule(dynamic, 32)
+            for(int r = 0; r < Ysize; ++r)
+            {
+                float l_a3FY[3];
+                l_a3FY[0] = l_aFR[0]*h_Yx[r] + l_aFR[1]*h_Yy[r] + l_aFR[2]*h_Yz[r] + l_aFT[0];
+                l_a3FY[1] = l_aFR[3]*h_Yx[r] + l_aFR[4]*h_Yy[r] + l_aFR[5]*h_Yz[r] + l_aFT[1];
+                l_a3FY[2] = l_aFR[6]*h_Yx[r] + l_aFR[7]*h_Yy[r] + l_aFR[8]*h_Yz[r] + l_aFT[2];
+
+                softassignRow(l_i32TilesNb, h_Xx, h_Xy, h_Xz, &l_vTilesBox[0], l_a3FY, l_fInvSigmaP2, l_fOutlier, l_a3FXMean,
+                              &l_vRow[0], &l_vActiveTiles[0], l_vLambda[r], &l_vXprime[3*r]);
+            }
+        }
+
+        // weighted centers of X' and Y
+        double l_dSumLambda = 0.;
+        double l_a3DXc[3] = {0.,0.,0.}, l_a3DYc[3] = {0.,0.,0.};
+
+        for(int r = 0; r < Ysize; ++r)
+        {
+            double l_dLambda = l_vLambda[r];
+            l_dSumLambda += l_dLambda;
+
+            l_a3DXc[0] += l_dLambda * l_vXprime[3*r];
+            l_a3DXc[1] += l_dLambda * l_vXprime[3*r+1];
+            l_a3DXc[2] += l_dLambda * l_vXprime[3*r+2];
+
+            l_a3DYc[0] += l_dLambda * h_Yx[r];
+            l_a3DYc[1] += l_dLambda * h_Yy[r];
+            l_a3DYc[2] += l_dLambda * h_Yz[r];
+        }
+
+        if(!(l_dSumLambda > 0.) || l_dSumLambda != l_dSumLambda)
+        {
+            fprintf(stderr, "emicp_cpu : invalid weights. \n");
+            return false;
+        }
+
+        float h_Xc[3], h_Yc[3];
+        for(int ii = 0; ii < 3; ++ii)
+        {
+            l_a3DXc[ii] /= l_dSumLambda;
+            l_a3DYc[ii] /= l_dSumLambda;
+            h_Xc[ii] = static_cast<float>(l_a3DXc[ii]);
+            h_Yc[ii] = static_cast<float>(l_a3DYc[ii]);
+        }
+
+        // S = (lambda .* (X' - Xc))^T * (Y - Yc), column major as the cublas result
+        double l_a9DS[9] = {0.,0.,0.,0.,0.,0.,0.,0.,0.};
+
+        for(int r = 0; r < Ysize; ++r)
+        {
+            double l_dLambda = l_vLambda[r];
+            double l_a3DXp[3] = {l_dLambda * (l_vXprime[3*r]   - l_a3DXc[0]),
+                                 l_dLambda * (l_vXprime[3*r+1] - l_a3DXc[1]),
+                                 l_dLambda * (l_vXprime[3*r+2] - l_a3DXc[2])};
+            double l_a3DYr[3] = {h_Yx[r] - l_a3DYc[0], h_Yy[r] - l_a3DYc[1], h_Yz[r] - l_a3DYc[2]};
+
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                for(int ii = 0; ii < 3; ++ii)
+                {
+                    l_a9DS[ii + 3*jj] += l_a3DXp[ii] * l_a3DYr[jj];
+                }
+            }
+        }
+
+        float h_S[9];
+        for(int ii = 0; ii < 9; ++ii)
+        {
+            h_S[ii] = static_cast<float>(l_a9DS[ii]);
+        }
+
+        // find RT from S
+        findRTfromS(h_Xc, h_Yc, h_S, h_R, h_t);
+
+        sigma_p2 *= sigma_factor;
+    }
+
+    return true;
+}
@@ -0,0 +1,55 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file emicp_device.cpp
+ * \brief Host side detection of the CUDA device used by emicp.cu
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#include "emicp/3dregistration.h"
+
+#ifdef SW_EMICP_CUDA
+    #include <cuda_runtime_api.h>
+#endif
+
+// SW_EMICP_CUDA is defined by the makefile when it is called with CUDA_FOUND=yes
+bool cudaDeviceAvailable()
+{
+#ifdef SW_EMICP_CUDA
+    int l_i32DevicesNb = 0;
+
+    if(cudaGetDeviceCount(&l_i32DevicesNb) != cudaSuccess)
+    {
+        return false;
+    }
+
+    return l_i32DevicesNb > 0;
+#else
+    // built without nvcc, emicp_cpu is the only emicp available
+    return false;
+#endif
+}
@@ -258,7 +258,7 @@ void SWGLMultiObjectWidget::addMesh(const QString &sPathMesh)
 {
     makeCurrent();
 
-    SWMeshPtr l_pMesh = SWMeshPtr(new swMesh::SWMesh(sPathMesh.toUtf8().constData()));
+    SWMeshPtr l_pMesh = SWMeshPtr(new swMesh::SWMesh(sPathMesh.toUtf8().constData(), true));
 
     swCloud::SWCloudBBox l_oBBox = l_pMesh->cloud()->bBox();
     if(l_oBBox.diagLength() > 100.f)
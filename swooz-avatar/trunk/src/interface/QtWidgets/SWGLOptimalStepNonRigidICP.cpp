@@ -71,6 +71,7 @@ SWGLOptimalStepNonRigidICP::SWGLOptimalStepNonRigidICP(QGLContext *context, QWid
 
         // OptimalStepNonRigidICP
             m_bUseLandMarks = true;
+            m_bUseSparseSolver = false;
 
         // translations
             m_fXTransTarget = m_fYTransTarget = m_fZTransTarget = 0.f;
@@ -198,6 +199,7 @@ double SWGLOptimalStepNonRigidICP::morph(cdouble dAlpha)
     double l_dBeta        = m_dBeta;
     double l_dGama        = m_dGama;
     double l_dUseLandmarks= m_bUseLandMarks;
+    bool l_bUseSparseSolver = m_bUseSparseSolver;
 
 //    qDebug() << "Start alpha : " << m_dStartAlpha << "\nAlpha : " << dAlpha << "\nBeta : " << m_dBeta << "\nGama : " << m_dGama << "\nUse landmarks : " << m_bUseLandMarks;
 //    qDebug() << "Min Alpha : " << m_dMinAlpha << "\nCoeff : " << m_dCoeffAlpha;
@@ -205,11 +207,13 @@ double SWGLOptimalStepNonRigidICP::morph(cdouble dAlpha)
     m_pParamMutex->unlock();
 
     initResolve();
-    double l_dDiff;
+    double l_dDiff = -1.0;
 
     m_infoDisplay3D = QString("Morphing in progress... (Alpha  : " + QString::number(dAlpha) + " -> " + QString::number(m_dMinAlpha) +  " Beta : " + QString::number(l_dBeta) + " Gama : " + QString::number(l_dGama) + ")");
     update();
 
+    m_pOSNRICP->setSolver(l_bUseSparseSolver ? swMesh::NRICP_SPARSE_CPU_SOLVER : swMesh::NRICP_DENSE_CUDA_SOLVER);
+
     try
     {
         l_dDiff = m_pOSNRICP->resolve(static_cast<float>(dAlpha), static_cast<float>(l_dBeta), static_cast<float>(l_dGama), l_dUseLandmarks);
@@ -219,6 +223,11 @@ double SWGLOptimalStepNonRigidICP::morph(cdouble dAlpha)
         std::cerr << e.what() << std::endl;
     }
 
+    if(l_dDiff < 0.0)
+    {
+        qWarning() << "The morphing resolution failed, the morphing is stopped. ";
+    }
+
 //    qDebug() << " end morph ->  " << dAlpha << " time : " << ((float)(clock() - l_oProgramTime) / CLOCKS_PER_SEC);
 
     return l_dDiff;
@@ -295,6 +304,13 @@ void SWGLOptimalStepNonRigidICP::setUseLandMarks(bool bVal)
     m_bUseLandMarks = bVal;
 }
 
+void SWGLOptimalStepNonRigidICP::setUseSparseSolver(bool bVal)
+{
+    m_pParamMutex->lock();
+    m_bUseSparseSolver = bVal;
+    m_pParamMutex->unlock();
+}
+
 void SWGLOptimalStepNonRigidICP::setVerticesNormalsSDisplay(bool bVal)
 {
     m_bVerticesNormalsSDisplay = bVal;
@@ -1441,7 +1457,7 @@ void SWGLOptimalStepNonRigidICP::setSourceMesh(const QString &sPathSource)
         m_sPathSourceMesh = sPathSource.toUtf8().constData(); // BUG : Qt version not compiled with std support, so toStdString crash, use toUtf8 instead
         m_pOSNRICP.reset();
         m_pSourceMesh.reset();
-        m_pSourceMesh = SWMeshPtr(new swMesh::SWMesh(m_sPathSourceMesh));
+        m_pSourceMesh = SWMeshPtr(new swMesh::SWMesh(m_sPathSourceMesh, true));
 
         std::vector<float> l_normal0;
         if(!m_pSourceMesh->vertexNormal(l_normal0,0))
@@ -1506,7 +1522,7 @@ void SWGLOptimalStepNonRigidICP::setTargetMesh(const QString &sPathTarget)
         m_sPathTargetMesh = sPathTarget.toUtf8().constData(); // BUG : Qt version not compiled with std support, so toStdString crash, use toUtf8 instead
         m_pOSNRICP.reset();
         m_pTargetMesh.reset();
-        m_pTargetMesh = SWMeshPtr(new swMesh::SWMesh(m_sPathTargetMesh));
+        m_pTargetMesh = SWMeshPtr(new swMesh::SWMesh(m_sPathTargetMesh, true));
 
         std::vector<float> l_normal0;
         if(!m_pTargetMesh->vertexNormal(l_normal0,0))
@@ -84,6 +84,9 @@ SWCreateAvatarWorker::SWCreateAvatarWorker(swDevice::SWKinect_thread *pRGBDDevic
     // init kinect thread used by the display widget
     if(m_pRGBDDeviceThread->init(0) != -1)
     {
+        // the avatar creation only uses the bgr image and the cloud map
+        m_pRGBDDeviceThread->setChannels(swDevice::KINECT_BGR_IMAGE | swDevice::KINECT_CLOUD_MAP);
+
         try
         {
             m_pRGBDDeviceThread->startListening();
@@ -140,15 +143,22 @@ void SWCreateAvatarWorker::doWork()
 
 
 
-        // retrieve kinect data
-            cv::Mat l_oBGR, l_oCloud;
-            l_oBGR   = m_pRGBDDeviceThread->bgrImage().clone();;
-            l_oCloud = m_pRGBDDeviceThread->cloudMap().clone();;
+        // retrieve kinect data, the frame is only read and is shared with the kinect thread without copy
+            swDevice::SWKinectFramePtr l_pFrame = m_pRGBDDeviceThread->frame();
+
+            if(!l_pFrame)
+            {
+                continue;
+            }
+
+            cv::Mat l_oBGR   = l_pFrame->m_oBgrImage;
+            cv::Mat l_oCloud = l_pFrame->m_oCloudMap;
 
-        // check size mat
+        // check size mat, the resized image is written in a buffer kept between the frames
            if(l_oBGR.rows != l_oCloud.rows)
            {
-               cv::resize(l_oBGR, l_oBGR, cv::Size(l_oCloud.cols,l_oCloud.rows));
+               cv::resize(l_pFrame->m_oBgrImage, m_oResizedBGR, cv::Size(l_oCloud.cols,l_oCloud.rows));
+               l_oBGR = m_oResizedBGR;
            }
 
         // main
@@ -303,17 +303,28 @@ void SWCreateAvatarInterface::updateDisplay()
         return;
     }
 
-    // get the current image from the kinect
-        cv::Mat l_oBGR, l_oCloud;
-        l_oBGR   = m_oKinectThread.bgrImage().clone();
-        l_oCloud = m_oKinectThread.cloudMap().clone();
+    // get the current frame from the kinect, the cloud is only read and is shared without copy
+        swDevice::SWKinectFramePtr l_pFrame = m_oKinectThread.frame();
 
-    // check size mat
-        if(l_oBGR.rows != l_oCloud.rows)
+        if(!l_pFrame)
         {
-           cv::resize(l_oBGR, l_oBGR, cv::Size(l_oCloud.cols,l_oCloud.rows));
+            return;
         }
 
+        cv::Mat l_oCloud = l_pFrame->m_oCloudMap;
+
+    // the rectangles are drawn on the image, so it is copied in the buffer kept between the frames
+        if(l_pFrame->m_oBgrImage.rows != l_oCloud.rows)
+        {
+           cv::resize(l_pFrame->m_oBgrImage, m_oFaceDetect, cv::Size(l_oCloud.cols,l_oCloud.rows));
+        }
+        else
+        {
+           l_pFrame->m_oBgrImage.copyTo(m_oFaceDetect);
+        }
+
+        cv::Mat l_oBGR = m_oFaceDetect;
+
     // remove background
         cv::Mat l_oBGRForeGround = swImage::swUtil::removeBackground(l_oBGR, l_oCloud);
 
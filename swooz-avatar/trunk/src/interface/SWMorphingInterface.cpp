@@ -104,6 +104,7 @@ SWMorphingInterface::SWMorphingInterface(QApplication *parent) : m_uiMorphing(ne
             m_uiMorphing->cbCorr->setChecked(true);
             m_uiMorphing->cbLandmarks->setChecked(true);
             m_uiMorphing->cbUseLandmarks->setChecked(true);
+            m_uiMorphing->cbSparseSolver->setChecked(false);
             m_uiMorphing->rbManual->setChecked(true);
 
         setStyleSheet("QGroupBox { color: blue; } ");
@@ -166,6 +167,7 @@ SWMorphingInterface::SWMorphingInterface(QApplication *parent) : m_uiMorphing(ne
         QObject::connect(m_uiMorphing->pbEraseLand,         SIGNAL(clicked()),      this,                         SLOT(eraseManuallyLandmarks()));
             // combobox
         QObject::connect(m_uiMorphing->cbUseLandmarks,      SIGNAL(clicked(bool)),  m_pGLOSNRICP, SLOT(setUseLandMarks(bool)));
+        QObject::connect(m_uiMorphing->cbSparseSolver,      SIGNAL(clicked(bool)),  m_pGLOSNRICP, SLOT(setUseSparseSolver(bool)));
         QObject::connect(m_uiMorphing->cbTemplateCloud,     SIGNAL(clicked(bool)),  m_pGLOSNRICP, SLOT(setCloudSDisplay(bool)));
         QObject::connect(m_uiMorphing->cbTargetCloud,       SIGNAL(clicked(bool)),  m_pGLOSNRICP, SLOT(setCloudTDisplay(bool)));
         QObject::connect(m_uiMorphing->cbTemplateMesh,      SIGNAL(clicked(bool)),  m_pGLOSNRICP, SLOT(setMeshSDisplay(bool)));
@@ -330,6 +332,7 @@ void SWMorphingInterface::unlockInterface()
     m_uiMorphing->pbSetTarget->setEnabled(true);
     m_uiMorphing->dsbFactor->setEnabled(true);
     m_uiMorphing->cbUseLandmarks->setEnabled(true);
+    m_uiMorphing->cbSparseSolver->setEnabled(true);
     m_uiMorphing->hsRotX->setEnabled(true);
     m_uiMorphing->hsRotY->setEnabled(true);
     m_uiMorphing->hsRotZ->setEnabled(true);
@@ -363,6 +366,7 @@ void SWMorphingInterface::lockInterface()
     m_uiMorphing->pbSetTarget->setDisabled(true);
     m_uiMorphing->dsbFactor->setDisabled(true);
     m_uiMorphing->cbUseLandmarks->setDisabled(true);
+    m_uiMorphing->cbSparseSolver->setDisabled(true);
     m_uiMorphing->hsRotX->setDisabled(true);
     m_uiMorphing->hsRotY->setDisabled(true);
     m_uiMorphing->hsRotZ->setDisabled(true);
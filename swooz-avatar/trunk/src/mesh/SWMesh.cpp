@@ -35,7 +35,10 @@
 #include <sstream>
 #include <string>
 
+#include <algorithm>
+
 #include "mesh/SWMesh.h"
+#include "mesh/SWObjLoader.h"
 #include "geometryUtility.h"
 
 using namespace swMesh;
@@ -46,137 +49,54 @@ using namespace std;
 SWMesh::SWMesh() : m_ui32EdgesNumber(0),  m_ui32TrianglesNumber(0)
 {}
 
-SWMesh::SWMesh(const std::string &sPathObjFile) : m_ui32TrianglesNumber(0), m_ui32EdgesNumber(0)
+SWMesh::SWMesh(const std::string &sPathObjFile, cbool bUseBinaryCache) : m_ui32TrianglesNumber(0), m_ui32EdgesNumber(0)
 {   
-    bool l_bIsNormal  = false;
-    bool l_bIsTexture = false;
     m_meshLoadSucess = false;
 
-    if(m_oCloud.loadObj(sPathObjFile))
-    {
-        ifstream l_oFileStream(sPathObjFile);
+    SWObjData l_oData;
+    bool l_bLoaded = false;
 
-        bool l_bFirstFace = true;
-        bool l_bEndFile   = false;
-        string l_sLine, l_sType = " ";
-        string l_sMTLNameFile   = " ";
+    if(bUseBinaryCache)
+    {
+        l_bLoaded = loadMeshCacheFile(meshCachePath(sPathObjFile), sPathObjFile, l_oData);
+    }
 
-        m_vVertexIdTriangle = vector<vector<uint> >(m_oCloud.size(), vector<uint>());
+    if(!l_bLoaded)
+    {
+        l_bLoaded = loadObjFile(sPathObjFile, l_oData);
 
-        while(!l_bEndFile)
+        if(l_bLoaded && bUseBinaryCache)
         {
-            l_oFileStream >> l_sType;
-
-            if(l_sType.size() > 0)
-            {
-                if(l_sType.at(0) == '#' || l_sType == "v") // ignore comments and vertices coordinates
-                {
-                    getline(l_oFileStream, l_sLine);
-                    l_sType = "";
-
-                }
-                else if(l_sType == "vt" || l_sType == "vn") // vt x y z       // vn x y z
-                {
-                    if(l_sType == "vn")
-                    {
-                        l_bIsNormal  = true;
-                    }
-                    if(l_sType == "vt" )
-                    {
-                        l_bIsTexture = true;
-                    }
-
-                    float l_fCoordX, l_fCoordY, l_fCoordZ;
-
-                    l_oFileStream >> l_fCoordX;
-                    l_oFileStream >> l_fCoordY;
-
-                    if(l_sType == "vt") // texture -> 2 coordinates
-                    {
-                        m_a2FTextures.push_back(l_fCoordX);
-                        m_a2FTextures.push_back(l_fCoordY);
-                    }
-                    else                // normal  -> 3 coordinates
-                    {
-                        l_oFileStream >> l_fCoordZ;
-
-                        m_a3FNormals.push_back(l_fCoordX);
-                        m_a3FNormals.push_back(l_fCoordY);
-                        m_a3FNormals.push_back(l_fCoordZ);
-                    }
+            saveMeshCacheFile(meshCachePath(sPathObjFile), sPathObjFile, l_oData);
+        }
+    }
 
-                    l_sType = "";
-                }
-                else if(l_sType == "f")
-                {                    
-                    // check if the obj file contains texture and normal coordinates
-                    if(l_bFirstFace)
-                    {
-                        checkObjFile(l_oFileStream, l_bIsTexture, l_bIsNormal);
-                        l_bFirstFace = false;
-                    }
+    if(l_bLoaded)
+    {
+        // the cloud takes the ownership of the planar arrays filled by the loader
+        m_oCloud.set(l_oData.m_ui32VerticesNumber, l_oData.m_aFCoords, l_oData.m_aUi8Colors);
+        l_oData.release();
 
-                    // check if the current f-line in the obj file contains 1 or two face
-//                    bool l_bQuadFace = isQuadFace(l_oFileStream);
+        m_a2FTextures.swap(l_oData.m_a2FTextures);
+        m_a3FNormals.swap(l_oData.m_a3FNormals);
+        m_aIdFaces.swap(l_oData.m_aIdFaces);
+        m_aIdTextures.swap(l_oData.m_aIdTextures);
+        m_aIdNormals.swap(l_oData.m_aIdNormals);
 
-                    vector<uint> l_aIdTriangle;                           
+        m_ui32TrianglesNumber = static_cast<uint>(m_aIdFaces.size()) / 3;
 
-                    for(uint ii = 0; ii < 3; ++ii) // f v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3
-                    {
-                        char l_cSeparator;
-                        uint l_ui32V1, l_ui32V2, l_ui32V3;                        
-
-                        l_oFileStream >> l_ui32V1;
-
-                        m_aIdFaces.push_back(l_ui32V1-1);
-                        l_aIdTriangle.push_back(l_ui32V1-1);
-
-                        m_vVertexIdTriangle[l_ui32V1-1].push_back(static_cast<uint>(m_aIdTriangles.size()));
-
-                        if(l_bIsNormal && !l_bIsTexture) // f v//vn
-                        {
-                            l_oFileStream >> l_cSeparator;
-                            l_oFileStream >> l_cSeparator;
-                            l_oFileStream >> l_ui32V3;
-                            m_aIdNormals.push_back(l_ui32V3-1);
-                        }
-                        else if(!l_bIsNormal && l_bIsTexture) // f v/vt
-                        {
-                            l_oFileStream >> l_cSeparator;
-                            l_oFileStream >> l_ui32V2;
-                            m_aIdTextures.push_back(l_ui32V2-1);
-                        }
-                        else if(l_bIsNormal && l_bIsTexture) // f v/vt/vn
-                        {
-                            l_oFileStream >> l_cSeparator;
-                            l_oFileStream >> l_ui32V2;
-                            m_aIdTextures.push_back(l_ui32V2-1);
-                            l_oFileStream >> l_cSeparator;
-                            l_oFileStream >> l_ui32V3;
-                            m_aIdNormals.push_back(l_ui32V3-1);
-                        }
-                    }
+        m_aIdTriangles = vector<vector<uint> >(m_ui32TrianglesNumber, vector<uint>(3));
 
-                    m_aIdTriangles.push_back(l_aIdTriangle);
-                    l_sType = "";
-                }
-                else if(l_sType == "mtllib")
-                {
-                    l_oFileStream >> l_sMTLNameFile;
-//                    std::cout << "file mtl : " << l_sMTLNameFile << std::endl;
-                    l_sType = "";
-                }
-            }
-            else
+        for(uint ii = 0; ii < m_ui32TrianglesNumber; ++ii)
+        {
+            for(uint jj = 0; jj < 3; ++jj)
             {
-                l_oFileStream.close();
-                l_bEndFile = true;
+                m_aIdTriangles[ii][jj] = m_aIdFaces[3*ii + jj];
             }
-        }        
-
-        m_ui32TrianglesNumber = static_cast<uint>(m_aIdFaces.size()) / 3;
+        }
 
         // build links data
+            buildVerticesCorners();
             buildEdgeVertexGraph();
             buildVerticesNeighbors();
 
@@ -229,11 +149,16 @@ SWMesh &SWMesh::operator=(const SWMesh &oMesh)
     m_aIdFaces          = oMesh.m_aIdFaces;
     m_aIdTextures       = oMesh.m_aIdTextures;
     m_aIdNormals        = oMesh.m_aIdNormals;
-    m_vVertexIdTriangle = oMesh.m_vVertexIdTriangle;
+
+    m_aUi32VertexCornersOffsets   = oMesh.m_aUi32VertexCornersOffsets;
+    m_aUi32VertexCorners          = oMesh.m_aUi32VertexCorners;
+    m_aUi32VertexNeighborsOffsets = oMesh.m_aUi32VertexNeighborsOffsets;
+    m_aUi32VertexNeighbors        = oMesh.m_aUi32VertexNeighbors;
 
     m_aIdTriangles      = oMesh.m_aIdTriangles;
     m_a2VertexLinks     = oMesh.m_a2VertexLinks;
-    m_a2VertexNeighbors = oMesh.m_a2VertexNeighbors;
+
+    m_aFNormalsCoords   = oMesh.m_aFNormalsCoords;
 
     return *this;
 }
@@ -257,7 +182,6 @@ void SWMesh::set(const std::vector<std::vector<float> > &v3FPoints,
 
     // set triangles
         m_aIdFaces = std::vector<uint>(v3UIFaces.size()*3);
-        m_vVertexIdTriangle = std::vector<std::vector<uint> >(m_aIdFaces.size(), vector<uint>());
         for(uint ii = 0; ii < v3UIFaces.size(); ++ii)
         {
             uint l_ui32V1, l_ui32V2, l_ui32V3;
@@ -273,11 +197,6 @@ void SWMesh::set(const std::vector<std::vector<float> > &v3FPoints,
             m_aIdFaces[ii*3+1]= l_ui32V2;
             m_aIdFaces[ii*3+2]= l_ui32V3;
 
-            uint l_ui32SizeIdTriangle = static_cast<uint>(m_aIdTriangles.size());
-            m_vVertexIdTriangle[l_ui32V1].push_back(l_ui32SizeIdTriangle);
-            m_vVertexIdTriangle[l_ui32V2].push_back(l_ui32SizeIdTriangle);
-            m_vVertexIdTriangle[l_ui32V3].push_back(l_ui32SizeIdTriangle);
-
             m_aIdTriangles.push_back(l_v3UIFaces);
         }
         m_ui32TrianglesNumber = static_cast<uint>(m_aIdFaces.size()) / 3;
@@ -292,6 +211,7 @@ void SWMesh::set(const std::vector<std::vector<float> > &v3FPoints,
         }
 
     // build links data
+        buildVerticesCorners();
         buildEdgeVertexGraph();
         buildVerticesNeighbors();
 
@@ -315,11 +235,16 @@ void SWMesh::clean()
     m_aIdFaces.clear();
     m_aIdTextures.clear();
     m_aIdNormals.clear();
-    m_vVertexIdTriangle.clear();
+
+    m_aUi32VertexCornersOffsets.clear();
+    m_aUi32VertexCorners.clear();
+    m_aUi32VertexNeighborsOffsets.clear();
+    m_aUi32VertexNeighbors.clear();
 
     m_aIdTriangles.clear();
     m_a2VertexLinks.clear();
-    m_a2VertexNeighbors.clear();
+
+    m_aFNormalsCoords.clear();
 
     m_ui32EdgesNumber     = 0;
     m_ui32TrianglesNumber = 0;
@@ -647,33 +572,17 @@ bool SWMesh::isTriangleOnABorder(cuint ui32IdTriangle)
 }
 
 
-uint SWMesh::idNearestPoint(cint i32IdSourcePoint,  SWMesh &oTarget)// const // TODO : octree ?
+uint SWMesh::idNearestPoint(cint i32IdSourcePoint,  SWMesh &oTarget)// const
 {
-
-    int     l_i32IdMin = -1;
-    float   l_fDistMax = FLT_MAX;
-
-
-    for(uint ii = 0; ii < oTarget.pointsNumber(); ++ii)
+    if(oTarget.pointsNumber() == 0)
     {
-        float l_fCurrSquareDist =
-                (oTarget.cloud()->coord(0)[ii] - cloud()->coord(0)[i32IdSourcePoint]) * (oTarget.cloud()->coord(0)[ii] - cloud()->coord(0)[i32IdSourcePoint]) +
-                (oTarget.cloud()->coord(1)[ii] - cloud()->coord(1)[i32IdSourcePoint]) * (oTarget.cloud()->coord(1)[ii] - cloud()->coord(1)[i32IdSourcePoint]) +
-                (oTarget.cloud()->coord(2)[ii] - cloud()->coord(2)[i32IdSourcePoint]) * (oTarget.cloud()->coord(2)[ii] - cloud()->coord(2)[i32IdSourcePoint]);
-
-        if(l_fCurrSquareDist < FLT_EPSILON)
-        {
-            return ii;
-        }
-
-        if(l_fCurrSquareDist < l_fDistMax)
-        {
-            l_fDistMax = l_fCurrSquareDist;
-            l_i32IdMin = ii;
-        }
+        return -1;
     }
 
-    return l_i32IdMin;
+    float l_a3FSourcePoint[3];
+    m_oCloud.point(l_a3FSourcePoint, i32IdSourcePoint);
+
+    return oTarget.cloud()->idNearestPoint(l_a3FSourcePoint);
 }
 
 std::vector<uint> SWMesh::vertexLinks(cuint ui32idVertex) const
@@ -686,18 +595,64 @@ swCloud::SWCloud *SWMesh::cloud()
     return &m_oCloud;
 }
 
-void SWMesh::updateNonOrientedTrianglesNormals()
+void SWMesh::updateTriangleNormal(cuint ui32IdTriangle)
 {
-    m_a3FNonOrientedTrianglesNormals.clear();
+    cfloat *l_aFX = m_oCloud.coord(0), *l_aFY = m_oCloud.coord(1), *l_aFZ = m_oCloud.coord(2);
+    const uint *l_aUi32IdTri = &m_aIdFaces[3*ui32IdTriangle];
 
-    for(uint ii = 0; ii < trianglesNumber(); ++ii)
+    swUtil::Vec3f l_vP1(l_aFX[l_aUi32IdTri[0]], l_aFY[l_aUi32IdTri[0]], l_aFZ[l_aUi32IdTri[0]]);
+    swUtil::Vec3f l_vP2(l_aFX[l_aUi32IdTri[1]], l_aFY[l_aUi32IdTri[1]], l_aFZ[l_aUi32IdTri[1]]);
+    swUtil::Vec3f l_vP3(l_aFX[l_aUi32IdTri[2]], l_aFY[l_aUi32IdTri[2]], l_aFZ[l_aUi32IdTri[2]]);
+
+    swUtil::Vec3f l_vNormal = swUtil::crossProduct(swUtil::vec(l_vP1, l_vP2), swUtil::vec(l_vP3, l_vP1));
+    swUtil::normalize(l_vNormal);
+    m_a3FNonOrientedTrianglesNormals[ui32IdTriangle] = l_vNormal;
+}
+
+void SWMesh::updateVertexNormal(cuint ui32IdVertex, const swUtil::Vec3f &oMeanPoint)
+{
+    swUtil::Vec3f l_v3FNormal(0.f, 0.f, 0.f);
+
+    // the first vertex of a triangle gives the orientation, the others follow the normal already accumulated
+    for(uint ii = m_aUi32VertexCornersOffsets[ui32IdVertex]; ii < m_aUi32VertexCornersOffsets[ui32IdVertex + 1]; ++ii)
     {
-        vector<float> l_vP1, l_vP2, l_vP3;
-        trianglePoints(l_vP1, l_vP2, l_vP3, ii);
+        cuint l_ui32Corner = m_aUi32VertexCorners[ii];
+        swUtil::Vec3f l_v3FCurrNormal = m_a3FNonOrientedTrianglesNormals[l_ui32Corner / 3];
+
+        if(l_ui32Corner % 3 != 0)
+        {
+            if(swUtil::dotProduct(l_v3FCurrNormal, l_v3FNormal) < 0)
+            {
+                swUtil::inverse(l_v3FCurrNormal);
+            }
+        }
+        swUtil::add(l_v3FNormal, l_v3FCurrNormal);
+    }
 
-        vector<float> l_vNormal = swUtil::crossProduct(swUtil::vec(l_vP1, l_vP2), swUtil::vec(l_vP3, l_vP1));
-        swUtil::normalize(l_vNormal);
-        m_a3FNonOrientedTrianglesNormals.push_back(l_vNormal);        
+    if(swUtil::norm(l_v3FNormal) <= 0.0) // in this case vertices doesn't belong to a triangle
+    {
+         swUtil::Vec3f currPoint(m_oCloud.coord(0)[ui32IdVertex], m_oCloud.coord(1)[ui32IdVertex], m_oCloud.coord(2)[ui32IdVertex]);
+         swUtil::add(l_v3FNormal, swUtil::vec(currPoint, oMeanPoint));
+    }
+
+    swUtil::normalize(l_v3FNormal);
+
+    m_a3FNonOrientedVerticesNormals[ui32IdVertex] = l_v3FNormal;
+    m_a3FNormals[3*ui32IdVertex]     = l_v3FNormal.x;
+    m_a3FNormals[3*ui32IdVertex + 1] = l_v3FNormal.y;
+    m_a3FNormals[3*ui32IdVertex + 2] = l_v3FNormal.z;
+}
+
+void SWMesh::updateNonOrientedTrianglesNormals()
+{
+    m_a3FNonOrientedTrianglesNormals.resize(trianglesNumber());
+
+    int l_i32TrianglesNumber = static_cast<int>(trianglesNumber());
+
+    #pragma omp parallel for
+    for(int ii = 0; ii < l_i32TrianglesNumber; ++ii)
+    {
+        updateTriangleNormal(ii);
     }
 }
 
@@ -705,59 +660,133 @@ void SWMesh::updateNonOrientedVerticesNormals()
 {
     if(m_a3FNonOrientedTrianglesNormals.size() > 0)
     {
-        // reset array
-            m_a3FNonOrientedVerticesNormals.clear();
+        if(m_aUi32VertexCornersOffsets.size() != pointsNumber() + 1)
+        {
+            buildVerticesCorners();
+        }
+
+        m_a3FNonOrientedVerticesNormals.resize(pointsNumber());
+        m_a3FNormals.resize(3 * pointsNumber());
 
         // compute mean point for particular cases
-            std::vector<float> l_v3FMeanPoint = m_oCloud.meanPoint();
+            swUtil::Vec3f l_v3FMeanPoint(m_oCloud.meanPoint());
 
-            m_a3FNonOrientedVerticesNormals = vector<vector<float> >(pointsNumber(), vector<float>(3,0.f));
+        int l_i32PointsNumber = static_cast<int>(pointsNumber());
 
-            for(uint ii = 0; ii < trianglesNumber(); ++ii)
+        #pragma omp parallel for
+        for(int ii = 0; ii < l_i32PointsNumber; ++ii)
+        {
+            updateVertexNormal(ii, l_v3FMeanPoint);
+        }
+    }
+    else
+    {
+        cerr << "Error : triangles normals mest be computed before vertices normals. " << endl; // TODO : throw
+    }
+}
+
+void SWMesh::updateNormals(cbool bOnlyMovedVertices)
+{
+    cuint l_ui32PointsNumber = pointsNumber();
+
+    if(!bOnlyMovedVertices || m_aFNormalsCoords.size() != 3 * l_ui32PointsNumber || !isTrianglesNormals() || !isVerticesNormals() ||
+            m_aUi32VertexCornersOffsets.size() != l_ui32PointsNumber + 1)
+    {
+        updateNonOrientedTrianglesNormals();
+        updateNonOrientedVerticesNormals();
+    }
+    else
+    {
+        // find the moved vertices and their triangles
+            std::vector<uint> l_vIdMovedVertices;
+            std::vector<uchar> l_vTrianglesToUpdate(trianglesNumber(), 0);
+
+            for(uint ii = 0; ii < l_ui32PointsNumber; ++ii)
             {
-                for(uint jj = 0; jj < 3; ++jj)
+                if(m_oCloud.coord(0)[ii] != m_aFNormalsCoords[ii] ||
+                   m_oCloud.coord(1)[ii] != m_aFNormalsCoords[l_ui32PointsNumber + ii] ||
+                   m_oCloud.coord(2)[ii] != m_aFNormalsCoords[2*l_ui32PointsNumber + ii])
                 {
-                    vector<float> l_v3FCurrNormal = m_a3FNonOrientedTrianglesNormals[ii];
+                    l_vIdMovedVertices.push_back(ii);
 
-                    if(jj >= 1)
+                    for(uint jj = m_aUi32VertexCornersOffsets[ii]; jj < m_aUi32VertexCornersOffsets[ii + 1]; ++jj)
                     {
-                        if(swUtil::dotProduct(l_v3FCurrNormal, m_a3FNonOrientedVerticesNormals[m_aIdTriangles[ii][jj]]) < 0)
-                        {
-                            swUtil::inverse(l_v3FCurrNormal);
-                        }
+                        l_vTrianglesToUpdate[m_aUi32VertexCorners[jj] / 3] = 1;
                     }
-                    swUtil::add(m_a3FNonOrientedVerticesNormals[m_aIdTriangles[ii][jj]], l_v3FCurrNormal);
                 }
             }
 
-            for(uint ii = 0; ii < pointsNumber(); ++ii)
+            if(l_vIdMovedVertices.size() == 0)
+            {
+                return;
+            }
+
+        // the vertices to update are the moved vertices and the vertices of the updated triangles
+            std::vector<uint> l_vIdTriangles;
+            std::vector<uchar> l_vVerticesToUpdate(l_ui32PointsNumber, 0);
+
+            for(uint ii = 0; ii < l_vIdMovedVertices.size(); ++ii)
+            {
+                l_vVerticesToUpdate[l_vIdMovedVertices[ii]] = 1;
+            }
+
+            for(uint ii = 0; ii < l_vTrianglesToUpdate.size(); ++ii)
             {
-                if(swUtil::norm(m_a3FNonOrientedVerticesNormals[ii]) <= 0.0) // in this case vertices doesn't belong to a triangle
+                if(l_vTrianglesToUpdate[ii])
                 {
-                     vector<float> currPoint;
-                     point(currPoint, ii);
-                     vector<float> currVector = swUtil::vec(currPoint, l_v3FMeanPoint);
-                     swUtil::add(m_a3FNonOrientedVerticesNormals[ii], currVector); // l_v3FMeanPoint
+                    l_vIdTriangles.push_back(ii);
+                    l_vVerticesToUpdate[m_aIdFaces[3*ii]]     = 1;
+                    l_vVerticesToUpdate[m_aIdFaces[3*ii + 1]] = 1;
+                    l_vVerticesToUpdate[m_aIdFaces[3*ii + 2]] = 1;
                 }
+            }
+
+            std::vector<uint> l_vIdVertices;
+            bool l_bIsolatedVertex = false;
 
-                swUtil::normalize(m_a3FNonOrientedVerticesNormals[ii]);
+            for(uint ii = 0; ii < l_ui32PointsNumber; ++ii)
+            {
+                if(l_vVerticesToUpdate[ii])
+                {
+                    l_vIdVertices.push_back(ii);
+                    l_bIsolatedVertex |= m_aUi32VertexCornersOffsets[ii] == m_aUi32VertexCornersOffsets[ii + 1];
+                }
             }
 
+        // update the normals
+            int l_i32TrianglesNumber = static_cast<int>(l_vIdTriangles.size());
+
+            #pragma omp parallel for
+            for(int ii = 0; ii < l_i32TrianglesNumber; ++ii)
+            {
+                updateTriangleNormal(l_vIdTriangles[ii]);
+            }
 
-        // udpate normals array with non-oriented vertices normals
-        m_a3FNormals.clear();
-        for(uint ii = 0; ii < m_a3FNonOrientedVerticesNormals.size(); ++ii)
+            swUtil::Vec3f l_v3FMeanPoint(0.f, 0.f, 0.f);
+            if(l_bIsolatedVertex)
+            {
+                l_v3FMeanPoint = swUtil::Vec3f(m_oCloud.meanPoint());
+            }
+
+            int l_i32VerticesNumber = static_cast<int>(l_vIdVertices.size());
+
+            #pragma omp parallel for
+            for(int ii = 0; ii < l_i32VerticesNumber; ++ii)
+            {
+                updateVertexNormal(l_vIdVertices[ii], l_v3FMeanPoint);
+            }
+    }
+
+    // keep the positions used for the normals
+        m_aFNormalsCoords.resize(3 * l_ui32PointsNumber);
+
+        if(l_ui32PointsNumber > 0)
         {
-            for(uint jj = 0; jj < m_a3FNonOrientedVerticesNormals[ii].size(); ++jj)
+            for(uint ii = 0; ii < 3; ++ii)
             {
-                m_a3FNormals.push_back(m_a3FNonOrientedVerticesNormals[ii][jj]);
+                std::copy(m_oCloud.coord(ii), m_oCloud.coord(ii) + l_ui32PointsNumber, m_aFNormalsCoords.begin() + ii * l_ui32PointsNumber);
             }
         }
-    }       
-    else
-    {
-        cerr << "Error : triangles normals mest be computed before vertices normals. " << endl; // TODO : throw
-    }
 }
 
 void SWMesh::buildEdgeVertexGraph()
@@ -838,102 +867,80 @@ void SWMesh::buildVerticesNeighbors()
         return;
     }
 
-    m_a2VertexNeighbors.clear();
-    m_a2VertexNeighbors = vector<vector<uint> >(pointsNumber(), vector<uint>());
+    // count the neighbors of each vertex
+        m_aUi32VertexNeighborsOffsets.assign(pointsNumber() + 1, 0);
 
-    for(uint ii = 0; ii < m_a2VertexLinks.size(); ++ii)
-    {
-        for(uint jj = 0; jj < m_a2VertexLinks[ii].size(); ++jj)
+        for(uint ii = 0; ii < m_a2VertexLinks.size(); ++ii)
         {
-            m_a2VertexNeighbors[ii].push_back(m_a2VertexLinks[ii][jj]);
-            m_a2VertexNeighbors[m_a2VertexLinks[ii][jj]].push_back(ii);
-        }
-    }
-
-}
+            m_aUi32VertexNeighborsOffsets[ii + 1] += static_cast<uint>(m_a2VertexLinks[ii].size());
 
+            for(uint jj = 0; jj < m_a2VertexLinks[ii].size(); ++jj)
+            {
+                ++m_aUi32VertexNeighborsOffsets[m_a2VertexLinks[ii][jj] + 1];
+            }
+        }
 
-bool SWMesh::vertexOnBorder(cuint ui32IdVertex)
-{
-    if(m_a2VertexNeighbors.size() == 0 )
-    {
-        cerr << "Error vertexOnBorder, SWMesh, buildVerticesNeighbors must be called before. " << endl;
-        return false;
-    }
+        for(uint ii = 0; ii < pointsNumber(); ++ii)
+        {
+            m_aUi32VertexNeighborsOffsets[ii + 1] += m_aUi32VertexNeighborsOffsets[ii];
+        }
 
-    if(ui32IdVertex > pointsNumber())
-    {
-        cerr << "Error : vertexOnBorder SWMesh : input id is invalid. " << endl;
-        return false;
-    }
+    // fill the rows
+        m_aUi32VertexNeighbors.resize(m_aUi32VertexNeighborsOffsets.back());
+        std::vector<uint> l_vFill(m_aUi32VertexNeighborsOffsets.begin(), m_aUi32VertexNeighborsOffsets.end() - 1);
 
-    return (m_vVertexIdTriangle[ui32IdVertex].size() != m_a2VertexNeighbors[ui32IdVertex].size());
+        for(uint ii = 0; ii < m_a2VertexLinks.size(); ++ii)
+        {
+            for(uint jj = 0; jj < m_a2VertexLinks[ii].size(); ++jj)
+            {
+                m_aUi32VertexNeighbors[l_vFill[ii]++] = m_a2VertexLinks[ii][jj];
+                m_aUi32VertexNeighbors[l_vFill[m_a2VertexLinks[ii][jj]]++] = ii;
+            }
+        }
 }
 
-
-bool SWMesh::isQuadFace(ifstream &l_oFileStream)
+void SWMesh::buildVerticesCorners()
 {
-    streampos  l_oPos = l_oFileStream.tellg();
-    string l_sLine;
-    getline(l_oFileStream, l_sLine);
-    l_oFileStream.seekg (l_oPos);
+    cuint l_ui32PointsNumber = pointsNumber();
 
-    int l_i32SpaceNumber = 0;
-    for(uint ii = 0; ii < l_sLine.size(); ++ii)
-    {
-        if(l_sLine[ii] == ' ')
+    // count the corners of each vertex
+        m_aUi32VertexCornersOffsets.assign(l_ui32PointsNumber + 1, 0);
+
+        for(uint ii = 0; ii < m_aIdFaces.size(); ++ii)
         {
-            ++l_i32SpaceNumber;
+            ++m_aUi32VertexCornersOffsets[m_aIdFaces[ii] + 1];
         }
-    }
 
-    if(l_i32SpaceNumber == 4)
-    {
-        return true;
-    }
+        for(uint ii = 0; ii < l_ui32PointsNumber; ++ii)
+        {
+            m_aUi32VertexCornersOffsets[ii + 1] += m_aUi32VertexCornersOffsets[ii];
+        }
 
-    return false;
-}
+    // fill the rows in the order of the corners, so each row is sorted by triangle id
+        m_aUi32VertexCorners.resize(m_aIdFaces.size());
+        std::vector<uint> l_vFill(m_aUi32VertexCornersOffsets.begin(), m_aUi32VertexCornersOffsets.end() - 1);
 
-void SWMesh::checkObjFile(ifstream &l_oFileStream, bool &bIsTextureCoords, bool &bIsNormals)
-{
-    streampos  l_oPos = l_oFileStream.tellg();
-    string l_sLine;
-    getline(l_oFileStream, l_sLine);
-    l_oFileStream.seekg (l_oPos);
+        for(uint ii = 0; ii < m_aIdFaces.size(); ++ii)
+        {
+            m_aUi32VertexCorners[l_vFill[m_aIdFaces[ii]]++] = ii;
+        }
+}
 
-    if(l_sLine.find('/') == std::string::npos) // case : f i
-    {
-        bIsNormals       = false;
-        bIsTextureCoords = false;
-        return;
-    }
 
-    if(l_sLine.find("//") != std::string::npos) // case : f i//i
+bool SWMesh::vertexOnBorder(cuint ui32IdVertex)
+{
+    if(m_aUi32VertexNeighborsOffsets.size() == 0 )
     {
-        bIsNormals       = true;
-        bIsTextureCoords = false;
-        return;
+        cerr << "Error vertexOnBorder, SWMesh, buildVerticesNeighbors must be called before. " << endl;
+        return false;
     }
 
-    char l_cSeparator;
-    uint l_ui32V1,l_ui32V2;
-    l_oFileStream >> l_ui32V1;
-    l_oFileStream >> l_cSeparator;
-    l_oFileStream >> l_ui32V2;
-    l_cSeparator  = ' ';
-    l_oFileStream >> l_cSeparator;
-
-    if(l_cSeparator == '/') // case : f i/i/i
-    {
-        bIsNormals       = true;
-        bIsTextureCoords = true;
-    }
-    else // case : f i/i
+    if(ui32IdVertex > pointsNumber())
     {
-        bIsNormals       = false;
-        bIsTextureCoords = true;
+        cerr << "Error : vertexOnBorder SWMesh : input id is invalid. " << endl;
+        return false;
     }
 
-    l_oFileStream.seekg (l_oPos);
+    return (m_aUi32VertexCornersOffsets[ui32IdVertex + 1] - m_aUi32VertexCornersOffsets[ui32IdVertex] !=
+            m_aUi32VertexNeighborsOffsets[ui32IdVertex + 1] - m_aUi32VertexNeighborsOffsets[ui32IdVertex]);
 }
@@ -0,0 +1,728 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWObjLoader.cpp
+ * \brief defines the obj file loader and the binary mesh cache
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#include "mesh/SWObjLoader.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <sys/stat.h>
+
+#include "boost/iostreams/device/mapped_file.hpp"
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+using namespace swMesh;
+using namespace std;
+
+#define SW_OBJ_MIN_CHUNK_SIZE 262144 /**< minimum size of a chunk parsed by a thread */
+
+/**
+ * \brief Type of a line of an obj file.
+ */
+enum SWObjLineType
+{
+    SW_OBJ_OTHER, SW_OBJ_VERTEX, SW_OBJ_TEXTURE, SW_OBJ_NORMAL, SW_OBJ_FACE
+};
+
+/**
+ * \brief Format of the vertices of the faces.
+ */
+enum SWObjFaceFormat
+{
+    SW_OBJ_FACE_UNKNOWN = -1, SW_OBJ_FACE_V = 0, SW_OBJ_FACE_V_VT = 1, SW_OBJ_FACE_V_VN = 2, SW_OBJ_FACE_V_VT_VN = 3
+};
+
+/**
+ * \brief Lines counters of a chunk, then offsets of the chunk in the final arrays.
+ */
+struct SWObjChunk
+{
+    const char *m_pBegin;       /**< first character of the chunk */
+    const char *m_pEnd;         /**< end of the chunk */
+    uint m_ui32Vertices;        /**< number of vertices, then offset of the vertices */
+    uint m_ui32Textures;        /**< number of textures coordinates, then offset */
+    uint m_ui32Normals;         /**< number of normals, then offset */
+    uint m_ui32Faces;           /**< number of faces, then offset */
+    uint m_ui32Colors;          /**< number of vertices with a color */
+    int m_i32FaceFormat;        /**< format of the first face of the chunk */
+    bool m_bValid;              /**< is the chunk valid ? */
+};
+
+
+static inline bool isBlank(cchar cC)
+{
+    return cC == ' ' || cC == '\t' || cC == '\r';
+}
+
+static SWObjLineType lineType(const char *pC, const char *pEnd, const char *&pData)
+{
+    while(pC < pEnd && isBlank(*pC))
+    {
+        ++pC;
+    }
+
+    SWObjLineType l_oType = SW_OBJ_OTHER;
+
+    if(pEnd - pC >= 2 && pC[0] == 'v' && isBlank(pC[1]))
+    {
+        l_oType = SW_OBJ_VERTEX;
+        pData   = pC + 1;
+    }
+    else if(pEnd - pC >= 3 && pC[0] == 'v' && pC[1] == 't' && isBlank(pC[2]))
+    {
+        l_oType = SW_OBJ_TEXTURE;
+        pData   = pC + 2;
+    }
+    else if(pEnd - pC >= 3 && pC[0] == 'v' && pC[1] == 'n' && isBlank(pC[2]))
+    {
+        l_oType = SW_OBJ_NORMAL;
+        pData   = pC + 2;
+    }
+    else if(pEnd - pC >= 2 && pC[0] == 'f' && isBlank(pC[1]))
+    {
+        l_oType = SW_OBJ_FACE;
+        pData   = pC + 1;
+    }
+
+    return l_oType;
+}
+
+static bool parseFloat(const char *&pC, const char *pEnd, float &fValue)
+{
+    static const double l_aDPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                       1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    while(pC < pEnd && isBlank(*pC))
+    {
+        ++pC;
+    }
+
+    const char *l_pStart = pC;
+
+    bool l_bNegative = false;
+    if(pC < pEnd && (*pC == '-' || *pC == '+'))
+    {
+        l_bNegative = (*pC == '-');
+        ++pC;
+    }
+
+    double l_dMantissa = 0.0;
+    int l_i32Exponent = 0, l_i32Digits = 0;
+
+    while(pC < pEnd && *pC >= '0' && *pC <= '9')
+    {
+        l_dMantissa = l_dMantissa * 10.0 + (*pC++ - '0');
+        ++l_i32Digits;
+    }
+
+    if(pC < pEnd && *pC == '.')
+    {
+        ++pC;
+        while(pC < pEnd && *pC >= '0' && *pC <= '9')
+        {
+            l_dMantissa = l_dMantissa * 10.0 + (*pC++ - '0');
+            --l_i32Exponent;
+            ++l_i32Digits;
+        }
+    }
+
+    if(l_i32Digits == 0)
+    {
+        pC = l_pStart;
+        return false;
+    }
+
+    if(pC < pEnd && (*pC == 'e' || *pC == 'E'))
+    {
+        const char *l_pExponent = pC++;
+        bool l_bNegativeExponent = false;
+
+        if(pC < pEnd && (*pC == '-' || *pC == '+'))
+        {
+            l_bNegativeExponent = (*pC == '-');
+            ++pC;
+        }
+
+        if(pC < pEnd && *pC >= '0' && *pC <= '9')
+        {
+            int l_i32Value = 0;
+            while(pC < pEnd && *pC >= '0' && *pC <= '9')
+            {
+                l_i32Value = l_i32Value * 10 + (*pC++ - '0');
+            }
+            l_i32Exponent += l_bNegativeExponent ? -l_i32Value : l_i32Value;
+        }
+        else
+        {
+            pC = l_pExponent;
+        }
+    }
+
+    // the powers of ten up to 1e22 are exact in double, the division gives the nearest double of the value
+    if(l_i32Exponent < 0)
+    {
+        l_dMantissa = (l_i32Exponent >= -22) ? l_dMantissa / l_aDPow10[-l_i32Exponent] : l_dMantissa * pow(10.0, l_i32Exponent);
+    }
+    else if(l_i32Exponent > 0)
+    {
+        l_dMantissa = (l_i32Exponent <= 22) ? l_dMantissa * l_aDPow10[l_i32Exponent] : l_dMantissa * pow(10.0, l_i32Exponent);
+    }
+
+    fValue = static_cast<float>(l_bNegative ? -l_dMantissa : l_dMantissa);
+
+    return true;
+}
+
+static bool parseIndex(const char *&pC, const char *pEnd, uint &ui32Index)
+{
+    if(pC >= pEnd || *pC < '0' || *pC > '9')
+    {
+        return false; // negative (relative) indices are not supported
+    }
+
+    ui32Index = 0;
+    while(pC < pEnd && *pC >= '0' && *pC <= '9')
+    {
+        ui32Index = ui32Index * 10 + (*pC++ - '0');
+    }
+
+    return ui32Index > 0;
+}
+
+/**
+ * \brief Parse a vertex of a face : "v", "v/vt", "v//vn" or "v/vt/vn", the id are converted to 0-based indices.
+ */
+static bool parseFaceVertex(const char *&pC, const char *pEnd, uint &ui32V, uint &ui32VT, uint &ui32VN, int &i32Format)
+{
+    ui32VT = ui32VN = 0;
+
+    while(pC < pEnd && isBlank(*pC))
+    {
+        ++pC;
+    }
+
+    if(!parseIndex(pC, pEnd, ui32V))
+    {
+        return false;
+    }
+
+    i32Format = SW_OBJ_FACE_V;
+
+    if(pC < pEnd && *pC == '/')
+    {
+        ++pC;
+
+        if(pC < pEnd && *pC == '/')
+        {
+            ++pC;
+            if(!parseIndex(pC, pEnd, ui32VN))
+            {
+                return false;
+            }
+            i32Format = SW_OBJ_FACE_V_VN;
+        }
+        else
+        {
+            if(!parseIndex(pC, pEnd, ui32VT))
+            {
+                return false;
+            }
+            i32Format = SW_OBJ_FACE_V_VT;
+
+            if(pC < pEnd && *pC == '/')
+            {
+                ++pC;
+                if(!parseIndex(pC, pEnd, ui32VN))
+                {
+                    return false;
+                }
+                i32Format = SW_OBJ_FACE_V_VT_VN;
+            }
+        }
+    }
+
+    --ui32V; --ui32VT; --ui32VN;
+
+    return pC == pEnd || isBlank(*pC);
+}
+
+static inline const char *lineEnd(const char *pC, const char *pEnd)
+{
+    const char *l_pEnd = static_cast<const char*>(memchr(pC, '\n', pEnd - pC));
+    return l_pEnd ? l_pEnd : pEnd;
+}
+
+static void countChunk(SWObjChunk &oChunk, cbool bVerticesOnly)
+{
+    oChunk.m_ui32Vertices  = oChunk.m_ui32Textures = oChunk.m_ui32Normals = oChunk.m_ui32Faces = oChunk.m_ui32Colors = 0;
+    oChunk.m_i32FaceFormat = SW_OBJ_FACE_UNKNOWN;
+    oChunk.m_bValid        = true;
+
+    for(const char *l_pC = oChunk.m_pBegin; l_pC < oChunk.m_pEnd;)
+    {
+        const char *l_pLineEnd = lineEnd(l_pC, oChunk.m_pEnd);
+        const char *l_pData;
+
+        switch(lineType(l_pC, l_pLineEnd, l_pData))
+        {
+            case SW_OBJ_VERTEX  : ++oChunk.m_ui32Vertices; break;
+            case SW_OBJ_TEXTURE : ++oChunk.m_ui32Textures; break;
+            case SW_OBJ_NORMAL  : ++oChunk.m_ui32Normals;  break;
+            case SW_OBJ_FACE    :
+                ++oChunk.m_ui32Faces;
+                if(oChunk.m_i32FaceFormat == SW_OBJ_FACE_UNKNOWN && !bVerticesOnly)
+                {
+                    uint l_ui32V, l_ui32VT, l_ui32VN;
+                    if(!parseFaceVertex(l_pData, l_pLineEnd, l_ui32V, l_ui32VT, l_ui32VN, oChunk.m_i32FaceFormat))
+                    {
+                        oChunk.m_bValid = false;
+                    }
+                }
+            break;
+            default : break;
+        }
+
+        l_pC = l_pLineEnd + 1;
+    }
+}
+
+static void parseChunk(SWObjChunk &oChunk, SWObjData &oData, cint i32FaceFormat, cbool bVerticesOnly)
+{
+    cuint l_ui32VerticesNumber = oData.m_ui32VerticesNumber;
+    cuint l_ui32TexturesNumber = static_cast<uint>(oData.m_a2FTextures.size() / 2);
+    cuint l_ui32NormalsNumber  = static_cast<uint>(oData.m_a3FNormals.size() / 3);
+    cbool l_bFaceTexture = (i32FaceFormat == SW_OBJ_FACE_V_VT || i32FaceFormat == SW_OBJ_FACE_V_VT_VN);
+    cbool l_bFaceNormal  = (i32FaceFormat == SW_OBJ_FACE_V_VN || i32FaceFormat == SW_OBJ_FACE_V_VT_VN);
+
+    uint l_ui32IdV = oChunk.m_ui32Vertices, l_ui32IdVT = oChunk.m_ui32Textures, l_ui32IdVN = oChunk.m_ui32Normals, l_ui32IdF = oChunk.m_ui32Faces;
+
+    for(const char *l_pC = oChunk.m_pBegin; l_pC < oChunk.m_pEnd && oChunk.m_bValid;)
+    {
+        const char *l_pLineEnd = lineEnd(l_pC, oChunk.m_pEnd);
+        const char *l_pData;
+
+        SWObjLineType l_oType = lineType(l_pC, l_pLineEnd, l_pData);
+
+        if(l_oType == SW_OBJ_VERTEX) // v x y z [r g b]
+        {
+            float l_aFValues[7];
+            int l_i32ValuesNb = 0;
+            while(l_i32ValuesNb < 7 && parseFloat(l_pData, l_pLineEnd, l_aFValues[l_i32ValuesNb]))
+            {
+                ++l_i32ValuesNb;
+            }
+
+            if(l_i32ValuesNb != 3 && l_i32ValuesNb != 6)
+            {
+                oChunk.m_bValid = false;
+                break;
+            }
+
+            for(int ii = 0; ii < 3; ++ii)
+            {
+                oData.m_aFCoords[ii * l_ui32VerticesNumber + l_ui32IdV] = l_aFValues[ii];
+            }
+
+            if(l_i32ValuesNb == 6)
+            {
+                for(int ii = 0; ii < 3; ++ii)
+                {
+                    oData.m_aUi8Colors[ii * l_ui32VerticesNumber + l_ui32IdV] = static_cast<uint8>(l_aFValues[3 + ii] * 255);
+                }
+                ++oChunk.m_ui32Colors;
+            }
+
+            ++l_ui32IdV;
+        }
+        else if(bVerticesOnly)
+        {}
+        else if(l_oType == SW_OBJ_TEXTURE) // vt u v
+        {
+            float *l_aFTexture = &oData.m_a2FTextures[2 * l_ui32IdVT++];
+            if(!parseFloat(l_pData, l_pLineEnd, l_aFTexture[0]) || !parseFloat(l_pData, l_pLineEnd, l_aFTexture[1]))
+            {
+                oChunk.m_bValid = false;
+            }
+        }
+        else if(l_oType == SW_OBJ_NORMAL) // vn x y z
+        {
+            float *l_aFNormal = &oData.m_a3FNormals[3 * l_ui32IdVN++];
+            if(!parseFloat(l_pData, l_pLineEnd, l_aFNormal[0]) || !parseFloat(l_pData, l_pLineEnd, l_aFNormal[1]) ||
+               !parseFloat(l_pData, l_pLineEnd, l_aFNormal[2]))
+            {
+                oChunk.m_bValid = false;
+            }
+        }
+        else if(l_oType == SW_OBJ_FACE) // f v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3
+        {
+            for(uint ii = 0; ii < 3; ++ii)
+            {
+                uint l_ui32V, l_ui32VT, l_ui32VN;
+                int l_i32Format;
+
+                if(!parseFaceVertex(l_pData, l_pLineEnd, l_ui32V, l_ui32VT, l_ui32VN, l_i32Format) ||
+                   l_i32Format != i32FaceFormat || l_ui32V >= l_ui32VerticesNumber ||
+                   (l_bFaceTexture && l_ui32VT >= l_ui32TexturesNumber) || (l_bFaceNormal && l_ui32VN >= l_ui32NormalsNumber))
+                {
+                    oChunk.m_bValid = false;
+                    break;
+                }
+
+                oData.m_aIdFaces[3 * l_ui32IdF + ii] = l_ui32V;
+
+                if(l_bFaceTexture)
+                {
+                    oData.m_aIdTextures[3 * l_ui32IdF + ii] = l_ui32VT;
+                }
+                if(l_bFaceNormal)
+                {
+                    oData.m_aIdNormals[3 * l_ui32IdF + ii] = l_ui32VN;
+                }
+            }
+
+            ++l_ui32IdF;
+        }
+
+        l_pC = l_pLineEnd + 1;
+    }
+}
+
+
+SWObjData::SWObjData() : m_ui32VerticesNumber(0), m_aFCoords(NULL), m_aUi8Colors(NULL)
+{}
+
+SWObjData::~SWObjData()
+{
+    delete[] m_aFCoords;
+    delete[] m_aUi8Colors;
+}
+
+void SWObjData::release()
+{
+    m_aFCoords   = NULL;
+    m_aUi8Colors = NULL;
+}
+
+
+bool swMesh::loadObjFile(const std::string &sPathObjFile, SWObjData &oData, cbool bVerticesOnly)
+{
+    boost::iostreams::mapped_file_source l_oFile;
+
+    try
+    {
+        l_oFile.open(sPathObjFile);
+    }
+    catch(const std::exception &)
+    {}
+
+    if(!l_oFile.is_open())
+    {
+        cerr << "Can't open obj file (swMesh::loadObjFile) : " << sPathObjFile << endl;
+        return false;
+    }
+
+    const char *l_pBegin = l_oFile.data();
+    const char *l_pEnd   = l_pBegin + l_oFile.size();
+
+    // cut the file in chunks at lines boundaries
+        int l_i32ChunksNb = 1;
+    #ifdef _OPENMP
+        l_i32ChunksNb = static_cast<int>(std::min<size_t>(omp_get_max_threads(), 1 + l_oFile.size() / SW_OBJ_MIN_CHUNK_SIZE));
+    #endif
+
+        std::vector<SWObjChunk> l_vChunks(l_i32ChunksNb);
+        l_vChunks[0].m_pBegin = l_pBegin;
+        for(int ii = 1; ii < l_i32ChunksNb; ++ii)
+        {
+            const char *l_pC = std::max(l_pBegin + (l_oFile.size() * ii) / l_i32ChunksNb, l_vChunks[ii-1].m_pBegin);
+            l_pC = (l_pC < l_pEnd) ? lineEnd(l_pC, l_pEnd) : l_pEnd;
+            l_vChunks[ii].m_pBegin  = (l_pC < l_pEnd) ? l_pC + 1 : l_pEnd;
+            l_vChunks[ii-1].m_pEnd  = l_vChunks[ii].m_pBegin;
+        }
+        l_vChunks[l_i32ChunksNb-1].m_pEnd = l_pEnd;
+
+    // count the lines of each chunk
+        #pragma omp parallel for
+        for(int ii = 0; ii < l_i32ChunksNb; ++ii)
+        {
+            countChunk(l_vChunks[ii], bVerticesOnly);
+        }
+
+    // compute the offsets of the chunks, the format of the faces is given by the first face of the file
+        uint l_ui32Vertices = 0, l_ui32Textures = 0, l_ui32Normals = 0, l_ui32Faces = 0;
+        int l_i32FaceFormat = SW_OBJ_FACE_UNKNOWN;
+
+        for(int ii = 0; ii < l_i32ChunksNb; ++ii)
+        {
+            SWObjChunk &l_oChunk = l_vChunks[ii];
+
+            if(!l_oChunk.m_bValid)
+            {
+                cerr << "Obj file not valid (swMesh::loadObjFile) : " << sPathObjFile << endl;
+                return false;
+            }
+
+            if(l_i32FaceFormat == SW_OBJ_FACE_UNKNOWN)
+            {
+                l_i32FaceFormat = l_oChunk.m_i32FaceFormat;
+            }
+
+            uint l_ui32Count;
+            l_ui32Count = l_oChunk.m_ui32Vertices; l_oChunk.m_ui32Vertices = l_ui32Vertices; l_ui32Vertices += l_ui32Count;
+            l_ui32Count = l_oChunk.m_ui32Textures; l_oChunk.m_ui32Textures = l_ui32Textures; l_ui32Textures += l_ui32Count;
+            l_ui32Count = l_oChunk.m_ui32Normals;  l_oChunk.m_ui32Normals  = l_ui32Normals;  l_ui32Normals  += l_ui32Count;
+            l_ui32Count = l_oChunk.m_ui32Faces;    l_oChunk.m_ui32Faces    = l_ui32Faces;    l_ui32Faces    += l_ui32Count;
+        }
+
+    // allocate the final arrays
+        delete[] oData.m_aFCoords;
+        delete[] oData.m_aUi8Colors;
+
+        oData.m_ui32VerticesNumber = l_ui32Vertices;
+        oData.m_aFCoords   = new float[3 * l_ui32Vertices];
+        oData.m_aUi8Colors = new uint8[3 * l_ui32Vertices];
+
+        if(bVerticesOnly)
+        {
+            l_ui32Textures = l_ui32Normals = l_ui32Faces = 0;
+        }
+
+        oData.m_a2FTextures.assign(2 * l_ui32Textures, 0.f);
+        oData.m_a3FNormals.assign(3 * l_ui32Normals, 0.f);
+        oData.m_aIdFaces.assign(3 * l_ui32Faces, 0);
+        oData.m_aIdTextures.assign((l_i32FaceFormat == SW_OBJ_FACE_V_VT || l_i32FaceFormat == SW_OBJ_FACE_V_VT_VN) ? 3 * l_ui32Faces : 0, 0);
+        oData.m_aIdNormals.assign((l_i32FaceFormat == SW_OBJ_FACE_V_VN || l_i32FaceFormat == SW_OBJ_FACE_V_VT_VN) ? 3 * l_ui32Faces : 0, 0);
+
+    // parse the chunks in the final arrays
+        #pragma omp parallel for
+        for(int ii = 0; ii < l_i32ChunksNb; ++ii)
+        {
+            parseChunk(l_vChunks[ii], oData, l_i32FaceFormat, bVerticesOnly);
+        }
+
+        uint l_ui32Colors = 0;
+        for(int ii = 0; ii < l_i32ChunksNb; ++ii)
+        {
+            if(!l_vChunks[ii].m_bValid)
+            {
+                cerr << "Obj file not valid (swMesh::loadObjFile) : " << sPathObjFile << endl;
+                return false;
+            }
+
+            l_ui32Colors += l_vChunks[ii].m_ui32Colors;
+        }
+
+    // the colors are kept only if all the vertices have one
+        if(l_ui32Colors != l_ui32Vertices)
+        {
+            memset(oData.m_aUi8Colors, 255, l_ui32Vertices);
+            memset(oData.m_aUi8Colors + l_ui32Vertices, 0, 2 * l_ui32Vertices);
+        }
+
+    return true;
+}
+
+std::string swMesh::meshCachePath(const std::string &sPathObjFile)
+{
+    size_t l_ui32Dot   = sPathObjFile.find_last_of('.');
+    size_t l_ui32Slash = sPathObjFile.find_last_of("/\\");
+
+    if(l_ui32Dot == std::string::npos || (l_ui32Slash != std::string::npos && l_ui32Dot < l_ui32Slash))
+    {
+        return sPathObjFile + SW_MESH_CACHE_EXTENSION;
+    }
+
+    return sPathObjFile.substr(0, l_ui32Dot) + SW_MESH_CACHE_EXTENSION;
+}
+
+/**
+ * \brief Retrieve the size and the modification time of a file.
+ */
+static bool fileStamp(const std::string &sPathFile, int64 &i64Size, int64 &i64Time)
+{
+    struct stat l_oStat;
+
+    if(stat(sPathFile.c_str(), &l_oStat) != 0)
+    {
+        return false;
+    }
+
+    i64Size = static_cast<int64>(l_oStat.st_size);
+    i64Time = static_cast<int64>(l_oStat.st_mtime);
+
+    return true;
+}
+
+template<typename T>
+static void readArray(std::ifstream &oFile, std::vector<T> &vArray, cuint ui32Size)
+{
+    vArray.resize(ui32Size);
+    if(ui32Size > 0)
+    {
+        oFile.read(reinterpret_cast<char*>(&vArray[0]), ui32Size * sizeof(T));
+    }
+}
+
+template<typename T>
+static void writeArray(std::ofstream &oFile, const std::vector<T> &vArray)
+{
+    if(vArray.size() > 0)
+    {
+        oFile.write(reinterpret_cast<const char*>(&vArray[0]), vArray.size() * sizeof(T));
+    }
+}
+
+bool swMesh::loadMeshCacheFile(const std::string &sPathCacheFile, const std::string &sPathObjFile, SWObjData &oData)
+{
+    std::ifstream l_oFile(sPathCacheFile.c_str(), std::ios::binary);
+
+    if(!l_oFile.is_open())
+    {
+        return false;
+    }
+
+    SWMeshCacheHeader l_oHeader;
+    l_oFile.read(reinterpret_cast<char*>(&l_oHeader), sizeof(SWMeshCacheHeader));
+
+    int64 l_i64ObjSize, l_i64ObjTime;
+
+    if(!l_oFile || strncmp(l_oHeader.m_aCMagic, SW_MESH_CACHE_MAGIC, 8) != 0 || l_oHeader.m_i32Version != SW_MESH_CACHE_VERSION)
+    {
+        cerr << "Mesh cache not valid, the obj file will be loaded (swMesh::loadMeshCacheFile) : " << sPathCacheFile << endl;
+        return false;
+    }
+
+    if(!fileStamp(sPathObjFile, l_i64ObjSize, l_i64ObjTime) || l_i64ObjSize != l_oHeader.m_i64ObjSize || l_i64ObjTime != l_oHeader.m_i64ObjTime)
+    {
+        return false; // the obj file has been modified
+    }
+
+    cuint l_ui32VerticesNumber = l_oHeader.m_ui32VerticesNumber;
+
+    delete[] oData.m_aFCoords;
+    delete[] oData.m_aUi8Colors;
+
+    oData.m_ui32VerticesNumber = l_ui32VerticesNumber;
+    oData.m_aFCoords   = new float[3 * l_ui32VerticesNumber];
+    oData.m_aUi8Colors = new uint8[3 * l_ui32VerticesNumber];
+
+    l_oFile.read(reinterpret_cast<char*>(oData.m_aFCoords), 3 * l_ui32VerticesNumber * sizeof(float));
+    l_oFile.read(reinterpret_cast<char*>(oData.m_aUi8Colors), 3 * l_ui32VerticesNumber * sizeof(uint8));
+
+    readArray(l_oFile, oData.m_a2FTextures, l_oHeader.m_ui32TexturesSize);
+    readArray(l_oFile, oData.m_a3FNormals,  l_oHeader.m_ui32NormalsSize);
+    readArray(l_oFile, oData.m_aIdFaces,    l_oHeader.m_ui32IdFacesSize);
+    readArray(l_oFile, oData.m_aIdTextures, l_oHeader.m_ui32IdTexturesSize);
+    readArray(l_oFile, oData.m_aIdNormals,  l_oHeader.m_ui32IdNormalsSize);
+
+    bool l_bValid = !l_oFile.fail() &&
+            (oData.m_aIdTextures.empty() || oData.m_aIdTextures.size() == oData.m_aIdFaces.size()) &&
+            (oData.m_aIdNormals.empty()  || oData.m_aIdNormals.size()  == oData.m_aIdFaces.size());
+
+    cuint l_ui32TexturesNumber = static_cast<uint>(oData.m_a2FTextures.size() / 2);
+    cuint l_ui32NormalsNumber  = static_cast<uint>(oData.m_a3FNormals.size() / 3);
+
+    for(uint ii = 0; ii < oData.m_aIdFaces.size() && l_bValid; ++ii)
+    {
+        l_bValid = oData.m_aIdFaces[ii] < l_ui32VerticesNumber;
+    }
+    for(uint ii = 0; ii < oData.m_aIdTextures.size() && l_bValid; ++ii)
+    {
+        l_bValid = oData.m_aIdTextures[ii] < l_ui32TexturesNumber;
+    }
+    for(uint ii = 0; ii < oData.m_aIdNormals.size() && l_bValid; ++ii)
+    {
+        l_bValid = oData.m_aIdNormals[ii] < l_ui32NormalsNumber;
+    }
+
+    if(!l_bValid)
+    {
+        cerr << "Mesh cache corrupted, the obj file will be loaded (swMesh::loadMeshCacheFile) : " << sPathCacheFile << endl;
+    }
+
+    return l_bValid;
+}
+
+bool swMesh::saveMeshCacheFile(const std::string &sPathCacheFile, const std::string &sPathObjFile, const SWObjData &oData)
+{
+    SWMeshCacheHeader l_oHeader;
+    memset(&l_oHeader, 0, sizeof(SWMeshCacheHeader));
+    strncpy(l_oHeader.m_aCMagic, SW_MESH_CACHE_MAGIC, 8);
+    l_oHeader.m_i32Version = SW_MESH_CACHE_VERSION;
+
+    if(!fileStamp(sPathObjFile, l_oHeader.m_i64ObjSize, l_oHeader.m_i64ObjTime))
+    {
+        cerr << "Can't read obj file (swMesh::saveMeshCacheFile) : " << sPathObjFile << endl;
+        return false;
+    }
+
+    l_oHeader.m_ui32VerticesNumber = oData.m_ui32VerticesNumber;
+    l_oHeader.m_ui32TexturesSize   = static_cast<uint>(oData.m_a2FTextures.size());
+    l_oHeader.m_ui32NormalsSize    = static_cast<uint>(oData.m_a3FNormals.size());
+    l_oHeader.m_ui32IdFacesSize    = static_cast<uint>(oData.m_aIdFaces.size());
+    l_oHeader.m_ui32IdTexturesSize = static_cast<uint>(oData.m_aIdTextures.size());
+    l_oHeader.m_ui32IdNormalsSize  = static_cast<uint>(oData.m_aIdNormals.size());
+
+    std::ofstream l_oFile(sPathCacheFile.c_str(), std::ios::binary | std::ios::trunc);
+
+    if(!l_oFile.is_open())
+    {
+        cerr << "Can't create mesh cache (swMesh::saveMeshCacheFile) : " << sPathCacheFile << endl;
+        return false;
+    }
+
+    l_oFile.write(reinterpret_cast<const char*>(&l_oHeader), sizeof(SWMeshCacheHeader));
+    l_oFile.write(reinterpret_cast<const char*>(oData.m_aFCoords), 3 * oData.m_ui32VerticesNumber * sizeof(float));
+    l_oFile.write(reinterpret_cast<const char*>(oData.m_aUi8Colors), 3 * oData.m_ui32VerticesNumber * sizeof(uint8));
+
+    writeArray(l_oFile, oData.m_a2FTextures);
+    writeArray(l_oFile, oData.m_a3FNormals);
+    writeArray(l_oFile, oData.m_aIdFaces);
+    writeArray(l_oFile, oData.m_aIdTextures);
+    writeArray(l_oFile, oData.m_aIdNormals);
+
+    if(!l_oFile.good())
+    {
+        l_oFile.close();
+        remove(sPathCacheFile.c_str());
+        cerr << "Error while writing mesh cache (swMesh::saveMeshCacheFile) : " << sPathCacheFile << endl;
+        return false;
+    }
+
+    return true;
+}
@@ -35,6 +35,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 // UTILITY
 #include <time.h>
@@ -93,17 +94,19 @@ SWOptimalStepNonRigidICP::SWOptimalStepNonRigidICP(const SWMesh &oSource, const
         m_fAngleMax = 50.f;
         m_fLastComputedCost = -1.f;
         m_fWeightVectorDistMax = 0.08f;
+        m_eSolver = NRICP_DENSE_CUDA_SOLVER;
 
     // read stasm correspondance files
         updateLandmarksWithSTASM();
 
     //  update triangles normals
         m_oTargetMesh.updateNonOrientedTrianglesNormals();
-        m_oSourceMesh.updateNonOrientedTrianglesNormals();
 
     // update vertices normals
         m_oTargetMesh.updateNonOrientedVerticesNormals();
-        m_oSourceMesh.updateNonOrientedVerticesNormals();
+
+    // update the source normals, the positions are kept for the incremental updates of the iterations
+        m_oSourceMesh.updateNormals();
 }
 
 
@@ -147,21 +150,24 @@ void SWOptimalStepNonRigidICP::updateLandmarksWithManualSelection(std::vector<in
 
 void SWOptimalStepNonRigidICP::updateSourceMeshNormals()
 {
-    m_oSourceMesh.updateNonOrientedTrianglesNormals();
-    m_oSourceMesh.updateNonOrientedVerticesNormals();
+    // only the normals around the vertices moved by the last resolve are computed
+    m_oSourceMesh.updateNormals(true);
 }
 
 void SWOptimalStepNonRigidICP::computeCorrespondences()
 {
     m_fMaxTemplateTargetDistance = 0.f;
 
+    std::vector<int> l_vIdNearestPoints;
+    m_oTargetMesh.cloud()->idNearestPoints(*m_oSourceMesh.cloud(), l_vIdNearestPoints);
+
     for(uint ii = 0; ii < m_oSourceMesh.pointsNumber(); ++ii)
     {
-        m_u[ii] = m_oSourceMesh.idNearestPoint(ii, m_oTargetMesh);
+        m_u[ii] = l_vIdNearestPoints[ii];
 
-        std::vector<float> l_vPtTemplate, l_vPtTarget;
-        m_oSourceMesh.point(l_vPtTemplate, ii);
-        m_oTargetMesh.point(l_vPtTarget, m_u[ii]);
+        swUtil::Vec3f l_vPtTemplate, l_vPtTarget;
+        m_oSourceMesh.point(&l_vPtTemplate.x, ii);
+        m_oTargetMesh.point(&l_vPtTarget.x, m_u[ii]);
 
         float l_fDist = swUtil::norm(swUtil::vec(l_vPtTemplate, l_vPtTarget));
 
@@ -186,9 +192,9 @@ void SWOptimalStepNonRigidICP::associateTextureCoordinates()
     for(uint ii = 0; ii < m_oSourceMesh.pointsNumber(); ++ii)
     {
         std::vector<float> l_targetTextureCoordinate;
-        std::vector<float> l_vPtTemplate, l_vPtTarget;
-        m_oSourceMesh.point(l_vPtTemplate, ii);
-        m_oTargetMesh.point(l_vPtTarget, m_u[ii]);
+        swUtil::Vec3f l_vPtTemplate, l_vPtTarget;
+        m_oSourceMesh.point(&l_vPtTemplate.x, ii);
+        m_oTargetMesh.point(&l_vPtTarget.x, m_u[ii]);
 
         float l_fDist = swUtil::norm(swUtil::vec(l_vPtTemplate, l_vPtTarget));
 
@@ -233,11 +239,9 @@ void SWOptimalStepNonRigidICP::computeDistanceWeights()
                 continue;
             }
 
-            std::vector<float> l_vXiViNormal;
-            m_oSourceMesh.vertexNormal(l_vXiViNormal , ii);
-
-            std::vector<float> l_vUiNormal;
-            m_oTargetMesh.vertexNormal(l_vUiNormal, m_u[ii]);
+            swUtil::Vec3f l_vXiViNormal, l_vUiNormal;
+            m_oSourceMesh.vertexNormal(&l_vXiViNormal.x, ii);
+            m_oTargetMesh.vertexNormal(&l_vUiNormal.x, m_u[ii]);
 
             float l_fAngle = static_cast<float>(swUtil::vectorAngle(l_vXiViNormal, l_vUiNormal));
 
@@ -253,11 +257,11 @@ void SWOptimalStepNonRigidICP::computeDistanceWeights()
         m_oProgramTime = clock();
 
     // 3) the line segment Xivi to ui intersects the deformed template
-        std::vector<float> l_vV1, l_vV2, l_vV3;
-        std::vector<float> l_vP, l_vD;
-        std::vector<float> l_vTriMiddle(3,0.f);
-        std::vector<float> l_vVec1, l_vVec2;
+        swUtil::Vec3f l_vV1, l_vV2, l_vV3;
+        swUtil::Vec3f l_vP, l_vD;
+        swUtil::Vec3f l_vTriMiddle;
         float l_fSquareWeightVectorDistMax = m_fWeightVectorDistMax*m_fWeightVectorDistMax;
+        float l_a9FTriangle[9];
 
         for(uint ii = 0; ii < m_oSourceMesh.pointsNumber(); ++ii)
         {
@@ -266,30 +270,29 @@ void SWOptimalStepNonRigidICP::computeDistanceWeights()
                 continue;
             }
 
-            m_oSourceMesh.point(l_vP, ii);
-            m_oTargetMesh.point(l_vD, m_u[ii]);
+            m_oSourceMesh.point(&l_vP.x, ii);
+            m_oTargetMesh.point(&l_vD.x, m_u[ii]);
 
             bool l_bIntersect = false;
 
             for(uint jj = 0; jj < m_oSourceMesh.trianglesNumber(); ++jj)
             {
-                m_oSourceMesh.trianglePoints(l_vV1, l_vV2, l_vV3, jj);
-
-                l_vTriMiddle[0] = (l_vV1[0] + l_vV2[0] + l_vV3[0])/3.f;
-                l_vTriMiddle[1] = (l_vV1[1] + l_vV2[1] + l_vV3[1])/3.f;
-                l_vTriMiddle[2] = (l_vV1[2] + l_vV2[2] + l_vV3[2])/3.f;
+                m_oSourceMesh.trianglePoints(l_a9FTriangle, jj);
+                l_vV1 = swUtil::Vec3f(&l_a9FTriangle[0]);
+                l_vV2 = swUtil::Vec3f(&l_a9FTriangle[3]);
+                l_vV3 = swUtil::Vec3f(&l_a9FTriangle[6]);
 
-                swUtil::vec(l_vP, l_vTriMiddle, l_vVec1);
-                swUtil::vec(l_vTriMiddle, l_vD, l_vVec2);
+                l_vTriMiddle = (l_vV1 + l_vV2 + l_vV3)/3.f;
 
-                if(swUtil::squareLength(l_vVec1) > l_fSquareWeightVectorDistMax && swUtil::squareLength(l_vVec2) > l_fSquareWeightVectorDistMax)
+                if(swUtil::squareLength(swUtil::vec(l_vP, l_vTriMiddle)) > l_fSquareWeightVectorDistMax &&
+                   swUtil::squareLength(swUtil::vec(l_vTriMiddle, l_vD)) > l_fSquareWeightVectorDistMax)
 //                if(swUtil::norm(l_vVec1) > m_fWeightVectorDistMax && swUtil::norm(l_vVec2) > m_fWeightVectorDistMax)
 //                if(swUtil::norm(swUtil::vec(l_vP,l_vTriMiddle)) > m_fWeightVectorDistMax && swUtil::norm(swUtil::vec(l_vTriMiddle,l_vD)) > m_fWeightVectorDistMax)
                 {
                     continue;
                 }
 
-                std::vector<float> l_intersectPoint;
+                swUtil::Vec3f l_intersectPoint;
                 if(swUtil::segmentTriangleIntersect(l_vP, l_vD, l_vV1, l_vV2, l_vV3,l_intersectPoint) == 1)
                 {
                     l_bIntersect = true;
@@ -361,11 +364,21 @@ float SWOptimalStepNonRigidICP::computeDiff(cv::Mat &newX)
 //        m_uC = m_u;
 //}
 
-float SWOptimalStepNonRigidICP::resolve(cfloat fAlpha, cfloat fBeta, cfloat fGama, cbool bUseLandMarks)
+void SWOptimalStepNonRigidICP::setSolver(const SWNRICPSolver eSolver)
+{
+    m_eSolver = eSolver;
+}
+
+SWNRICPSolver SWOptimalStepNonRigidICP::solver() const
+{
+    return m_eSolver;
+}
+
+void SWOptimalStepNonRigidICP::resolveDense(cfloat fAlpha, cfloat fBeta, cfloat fGama, cbool bUseLandMarks, cv::Mat &oNewX)
 {
     clock_t m_oProgramTime;
 
-    cv::Mat MG_A, WD, B, TAA, TAB, TAAInv, newX;
+    cv::Mat MG_A, WD, B, TAA, TAB, TAAInv;
 
     // #### MG
     m_oProgramTime = clock();
@@ -416,10 +429,237 @@ float SWOptimalStepNonRigidICP::resolve(cfloat fAlpha, cfloat fBeta, cfloat fGam
 
 //    // #### newX
     m_oProgramTime = clock();
-    swUtil::swCuda::matrixMultiplication(TAAInv, TAB, newX);
+    swUtil::swCuda::matrixMultiplication(TAAInv, TAB, oNewX);
 //    cout << " newX " << (float)(clock() - m_oProgramTime) / CLOCKS_PER_SEC  << std::endl;
     TAAInv.release();
     TAB.release();
+}
+
+void SWOptimalStepNonRigidICP::buildSparsePattern()
+{
+    int l_i32PointsNb = static_cast<int>(m_oSourceMesh.pointsNumber());
+
+    // retrieve the edges and the lower id neighbours of each vertex
+        m_vSparseEdges.clear();
+        m_vSparseEdges.reserve(2 * m_oSourceMesh.edgesNumber());
+        std::vector<std::vector<int> > l_vLowerNeighbours(l_i32PointsNb);
+
+        for(int ii = 0; ii < l_i32PointsNb; ++ii)
+        {
+            std::vector<uint> l_aVertexLinks = m_oSourceMesh.vertexLinks(ii);
+
+            for(uint jj = 0; jj < l_aVertexLinks.size(); ++jj)
+            {
+                int l_i32Link = static_cast<int>(l_aVertexLinks[jj]);
+                m_vSparseEdges.push_back(ii);
+                m_vSparseEdges.push_back(l_i32Link);
+
+                if(l_i32Link < ii)
+                {
+                    l_vLowerNeighbours[ii].push_back(l_i32Link);
+                }
+                else if(l_i32Link > ii)
+                {
+                    l_vLowerNeighbours[l_i32Link].push_back(ii);
+                }
+            }
+        }
+
+    // build the upper pattern of T(A)A
+    //  column 4v+c : rows 4u+c for each neighbour u < v (MG), then rows 4v ... 4v+c (diagonal block of WD)
+        m_oSparseTAA = SWSparseMatrix();
+        m_oSparseTAA.m_i32Size = 4 * l_i32PointsNb;
+        m_oSparseTAA.m_vColPtr.assign(m_oSparseTAA.m_i32Size + 1, 0);
+
+        for(int ii = 0; ii < l_i32PointsNb; ++ii)
+        {
+            std::vector<int> &l_vNeighbours = l_vLowerNeighbours[ii];
+            std::sort(l_vNeighbours.begin(), l_vNeighbours.end());
+            l_vNeighbours.erase(std::unique(l_vNeighbours.begin(), l_vNeighbours.end()), l_vNeighbours.end());
+
+            for(int c = 0; c < 4; ++c)
+            {
+                for(uint jj = 0; jj < l_vNeighbours.size(); ++jj)
+                {
+                    m_oSparseTAA.m_vRowId.push_back(4 * l_vNeighbours[jj] + c);
+                }
+
+                for(int r = 0; r <= c; ++r)
+                {
+                    m_oSparseTAA.m_vRowId.push_back(4 * ii + r);
+                }
+
+                m_oSparseTAA.m_vColPtr[4 * ii + c + 1] = static_cast<int>(m_oSparseTAA.m_vRowId.size());
+            }
+        }
+
+        m_oSparseTAA.m_vValues.assign(m_oSparseTAA.m_vRowId.size(), 0.0);
+
+    // store the values indices used when filling the matrix
+        m_vSparseBlockIndex.resize(10 * l_i32PointsNb);
+        for(int ii = 0, l_i32Id = 0; ii < l_i32PointsNb; ++ii)
+        {
+            for(int c = 0; c < 4; ++c)
+            {
+                for(int r = 0; r <= c; ++r, ++l_i32Id)
+                {
+                    m_vSparseBlockIndex[l_i32Id] = m_oSparseTAA.valueIndex(4 * ii + r, 4 * ii + c);
+                }
+            }
+        }
+
+        int l_i32EdgesNb = static_cast<int>(m_vSparseEdges.size() / 2);
+        m_vSparseEdgeIndex.resize(4 * l_i32EdgesNb);
+        for(int ii = 0; ii < l_i32EdgesNb; ++ii)
+        {
+            int l_i32Min = std::min(m_vSparseEdges[2 * ii], m_vSparseEdges[2 * ii + 1]);
+            int l_i32Max = std::max(m_vSparseEdges[2 * ii], m_vSparseEdges[2 * ii + 1]);
+
+            for(int c = 0; c < 4; ++c)
+            {
+                // -1 for degenerated edges (same vertex), the contributions cancel each other
+                m_vSparseEdgeIndex[4 * ii + c] = (l_i32Min == l_i32Max) ? -1 : m_oSparseTAA.valueIndex(4 * l_i32Min + c, 4 * l_i32Max + c);
+            }
+        }
+
+    // compute the ordering and the symbolic factorization, done once for the source mesh topology
+        m_oSparseLDLT.analyzePattern(m_oSparseTAA, 4);
+}
+
+bool SWOptimalStepNonRigidICP::resolveSparse(cfloat fAlpha, cfloat fBeta, cfloat fGama, cbool bUseLandMarks, cv::Mat &oNewX)
+{
+    if(!m_oSparseLDLT.isAnalyzed())
+    {
+        buildSparsePattern();
+    }
+
+    int l_i32PointsNb = static_cast<int>(m_oSourceMesh.pointsNumber());
+    int l_i32Size     = m_oSparseTAA.m_i32Size;
+    double *l_aDTAA   = &m_oSparseTAA.m_vValues[0];
+
+    m_oSparseTAA.setZero();
+    std::vector<double> l_vDTAB(3 * l_i32Size, 0.0); // 3 columns stored one after the other
+
+    // T(MG) MG : each edge row -alpha*g*Xi + alpha*g*Xj with g = (1,1,1,gama)
+        double l_aDG2[4];
+        l_aDG2[0] = l_aDG2[1] = l_aDG2[2] = static_cast<double>(fAlpha) * fAlpha;
+        l_aDG2[3] = l_aDG2[0] * fGama * fGama;
+
+        for(uint ii = 0; ii < m_vSparseEdgeIndex.size() / 4; ++ii)
+        {
+            int l_i32V1 = m_vSparseEdges[2 * ii], l_i32V2 = m_vSparseEdges[2 * ii + 1];
+
+            if(l_i32V1 == l_i32V2)
+            {
+                continue;
+            }
+
+            for(int c = 0; c < 4; ++c)
+            {
+                // diagonal values of the blocks are stored in position 0, 2, 5, 9
+                int l_i32DiagOffset = (c * (c + 3)) / 2;
+                l_aDTAA[m_vSparseBlockIndex[10 * l_i32V1 + l_i32DiagOffset]] += l_aDG2[c];
+                l_aDTAA[m_vSparseBlockIndex[10 * l_i32V2 + l_i32DiagOffset]] += l_aDG2[c];
+                l_aDTAA[m_vSparseEdgeIndex[4 * ii + c]] -= l_aDG2[c];
+            }
+        }
+
+    // landmarks replace the WD/WU rows of their source vertex
+        std::vector<int> l_vLandMarks(l_i32PointsNb, -1);
+        if(bUseLandMarks)
+        {
+            for(std::map<uint,uint>::const_iterator it = m_l.cbegin(); it != m_l.cend(); ++it)
+            {
+                if(static_cast<int>(it->first) < l_i32PointsNb)
+                {
+                    l_vLandMarks[it->first] = static_cast<int>(it->second);
+                }
+            }
+        }
+
+    // T(WD) WD and T(WD) WU
+        for(int ii = 0; ii < l_i32PointsNb; ++ii)
+        {
+            float l_aFSourcePt[3], l_aFTargetPt[3];
+            m_oSourceMesh.point(l_aFSourcePt, ii);
+
+            // the landmark target point is not weighted by beta, as in addLandMarks
+            double l_dWeight, l_dTargetWeight;
+            if(l_vLandMarks[ii] != -1)
+            {
+                l_dWeight       = fBeta;
+                l_dTargetWeight = 1.0;
+                m_oTargetMesh.point(l_aFTargetPt, l_vLandMarks[ii]);
+            }
+            else
+            {
+                l_dWeight       = m_w[ii];
+                l_dTargetWeight = m_w[ii];
+                m_oTargetMesh.point(l_aFTargetPt, m_u[ii]);
+            }
+
+            if(l_dWeight == 0.0)
+            {
+                continue;
+            }
+
+            double l_aDD[4] = {l_dWeight * l_aFSourcePt[0], l_dWeight * l_aFSourcePt[1], l_dWeight * l_aFSourcePt[2], l_dWeight};
+            double l_aDU[3] = {l_dTargetWeight * l_aFTargetPt[0], l_dTargetWeight * l_aFTargetPt[1], l_dTargetWeight * l_aFTargetPt[2]};
+
+            const int *l_aI32BlockIndex = &m_vSparseBlockIndex[10 * ii];
+            for(int c = 0, l_i32Id = 0; c < 4; ++c)
+            {
+                for(int r = 0; r <= c; ++r, ++l_i32Id)
+                {
+                    l_aDTAA[l_aI32BlockIndex[l_i32Id]] += l_aDD[r] * l_aDD[c];
+                }
+
+                for(int jj = 0; jj < 3; ++jj)
+                {
+                    l_vDTAB[jj * l_i32Size + 4 * ii + c] += l_aDD[c] * l_aDU[jj];
+                }
+            }
+        }
+
+    // factorize and solve the 3 right hand sides
+        if(!m_oSparseLDLT.factorize(m_oSparseTAA))
+        {
+            std::cerr << "resolveSparse : factorization failed. " << std::endl;
+            return false;
+        }
+
+        oNewX = cv::Mat(l_i32Size, 3, CV_32FC1);
+        for(int jj = 0; jj < 3; ++jj)
+        {
+            double *l_aDRhs = &l_vDTAB[jj * l_i32Size];
+            m_oSparseLDLT.solve(l_aDRhs);
+
+            for(int ii = 0; ii < l_i32Size; ++ii)
+            {
+                oNewX.at<float>(ii, jj) = static_cast<float>(l_aDRhs[ii]);
+            }
+        }
+
+    return true;
+}
+
+float SWOptimalStepNonRigidICP::resolve(cfloat fAlpha, cfloat fBeta, cfloat fGama, cbool bUseLandMarks)
+{
+    clock_t m_oProgramTime;
+    cv::Mat newX;
+
+    if(m_eSolver == NRICP_SPARSE_CPU_SOLVER)
+    {
+        if(!resolveSparse(fAlpha, fBeta, fGama, bUseLandMarks, newX))
+        {
+            std::cerr << "Error resolve : the sparse system can't be solved, the source mesh is not deformed. " << std::endl;
+            return -1.f;
+        }
+    }
+    else
+    {
+        resolveDense(fAlpha, fBeta, fGama, bUseLandMarks, newX);
+    }
 
     m_oProgramTime = clock();
     float l_fDiff = computeDiff(newX);
@@ -430,20 +670,14 @@ float SWOptimalStepNonRigidICP::resolve(cfloat fAlpha, cfloat fBeta, cfloat fGam
 
         for(uint ii = 0; ii < l_oSourceCloud->size(); ++ii)
         {
-            std::vector<float> l_vPt(3,0.f);
-            l_vPt[0] = l_oSourceCloud->coord(0)[ii];
-            l_vPt[1] = l_oSourceCloud->coord(1)[ii];
-            l_vPt[2] = l_oSourceCloud->coord(2)[ii];
+            swUtil::Vec3f l_vPt(l_oSourceCloud->coord(0)[ii], l_oSourceCloud->coord(1)[ii], l_oSourceCloud->coord(2)[ii]);
 
 
             float l_fCoeffReduc = 1.f;
 
             // test in order to limit back head deformation
             {
-                std::vector<float> l_vNearestPoint(3,0.f);
-                l_vNearestPoint[0] = l_oTargetCloud->coord(0)[m_u[ii]];
-                l_vNearestPoint[1] = l_oTargetCloud->coord(1)[m_u[ii]];
-                l_vNearestPoint[2] = l_oTargetCloud->coord(2)[m_u[ii]];
+                swUtil::Vec3f l_vNearestPoint(l_oTargetCloud->coord(0)[m_u[ii]], l_oTargetCloud->coord(1)[m_u[ii]], l_oTargetCloud->coord(2)[m_u[ii]]);
 
                 float l_fDistNearestPoint = swUtil::norm(swUtil::vec(l_vPt,l_vNearestPoint));
 
@@ -473,6 +707,8 @@ float SWOptimalStepNonRigidICP::resolve(cfloat fAlpha, cfloat fBeta, cfloat fGam
 
         }
 
+        l_oSourceCloud->invalidateSpatialIndex();
+
 //        std::cout << "MG  : " << MG_A.rows << " " << MG_A.cols << std::endl;
 //        std::cout << "WD  : " << WD.rows << " " << WD.cols << std::endl;
 //        std::cout << "B   : " << B.rows << " " << B.cols << std::endl;
@@ -0,0 +1,537 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWSparseLDLT.cpp
+ * \brief defines SWSparseMatrix and SWSparseLDLT
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#include "mesh/SWSparseLDLT.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+using namespace swMesh;
+
+
+namespace
+{
+    /**
+     * \brief Working data of the nested dissection
+     */
+    struct SWDissectionData
+    {
+        const std::vector<int> *m_pAdjPtr;
+        const std::vector<int> *m_pAdjId;
+        std::vector<int> m_vLabel;      /**< id of the sub-graph containing the vertex */
+        std::vector<int> m_vLevel;      /**< bfs level of the vertex */
+        std::vector<int> m_vQueue;      /**< bfs queue */
+        int m_i32LabelCounter;
+        std::vector<int> *m_pOrder;
+    };
+
+    /**
+     * \brief Reset the bfs levels of the input vertices.
+     */
+    void resetLevels(SWDissectionData &oData, const std::vector<int> &vSubset)
+    {
+        for(uint ii = 0; ii < vSubset.size(); ++ii)
+        {
+            oData.m_vLevel[vSubset[ii]] = -1;
+        }
+    }
+
+    /**
+     * \brief Breadth first search restricted to the not visited vertices with the input label (levels must have been reset).
+     * \return the number of visited vertices, the visited vertices are stored in m_vQueue
+     */
+    int bfs(SWDissectionData &oData, cint i32Start, cint i32Label)
+    {
+        int l_i32Head = 0, l_i32Tail = 0;
+        oData.m_vQueue[l_i32Tail++] = i32Start;
+        oData.m_vLevel[i32Start]    = 0;
+
+        while(l_i32Head < l_i32Tail)
+        {
+            int l_i32V = oData.m_vQueue[l_i32Head++];
+
+            for(int ii = (*oData.m_pAdjPtr)[l_i32V]; ii < (*oData.m_pAdjPtr)[l_i32V+1]; ++ii)
+            {
+                int l_i32W = (*oData.m_pAdjId)[ii];
+
+                if(oData.m_vLabel[l_i32W] == i32Label && oData.m_vLevel[l_i32W] == -1)
+                {
+                    oData.m_vLevel[l_i32W] = oData.m_vLevel[l_i32V] + 1;
+                    oData.m_vQueue[l_i32Tail++] = l_i32W;
+                }
+            }
+        }
+
+        return l_i32Tail;
+    }
+
+    /**
+     * \brief Recursive level set nested dissection : order the first part, then the second part, then the separator.
+     */
+    void dissect(SWDissectionData &oData, std::vector<int> &vSubset)
+    {
+        if(vSubset.size() <= 8)
+        {
+            oData.m_pOrder->insert(oData.m_pOrder->end(), vSubset.begin(), vSubset.end());
+            return;
+        }
+
+        int l_i32Label = ++oData.m_i32LabelCounter;
+        for(uint ii = 0; ii < vSubset.size(); ++ii)
+        {
+            oData.m_vLabel[vSubset[ii]] = l_i32Label;
+        }
+
+        resetLevels(oData, vSubset);
+        int l_i32Visited = bfs(oData, vSubset[0], l_i32Label);
+
+        // disconnected sub-graph : each component is ordered separately
+        if(l_i32Visited < static_cast<int>(vSubset.size()))
+        {
+            std::vector<std::vector<int> > l_vComponents(1, std::vector<int>(oData.m_vQueue.begin(), oData.m_vQueue.begin() + l_i32Visited));
+
+            for(uint ii = 0; ii < vSubset.size(); ++ii)
+            {
+                if(oData.m_vLevel[vSubset[ii]] == -1)
+                {
+                    int l_i32CompSize = bfs(oData, vSubset[ii], l_i32Label);
+                    l_vComponents.push_back(std::vector<int>(oData.m_vQueue.begin(), oData.m_vQueue.begin() + l_i32CompSize));
+                }
+            }
+
+            for(uint ii = 0; ii < l_vComponents.size(); ++ii)
+            {
+                dissect(oData, l_vComponents[ii]);
+            }
+            return;
+        }
+
+        // pseudo peripheral vertex
+        int l_i32Start = oData.m_vQueue[l_i32Visited-1];
+        int l_i32MaxLevel = oData.m_vLevel[l_i32Start];
+        for(int ii = 0; ii < 3; ++ii)
+        {
+            resetLevels(oData, vSubset);
+            bfs(oData, l_i32Start, l_i32Label);
+            int l_i32Last = oData.m_vQueue[vSubset.size()-1];
+            if(oData.m_vLevel[l_i32Last] <= l_i32MaxLevel)
+            {
+                break;
+            }
+            l_i32MaxLevel = oData.m_vLevel[l_i32Last];
+            l_i32Start    = l_i32Last;
+        }
+        resetLevels(oData, vSubset);
+        bfs(oData, l_i32Start, l_i32Label);
+        l_i32MaxLevel = oData.m_vLevel[oData.m_vQueue[vSubset.size()-1]];
+
+        if(l_i32MaxLevel < 2)
+        {
+            oData.m_pOrder->insert(oData.m_pOrder->end(), vSubset.begin(), vSubset.end());
+            return;
+        }
+
+        // the separator is the level splitting the vertices in two halves
+        std::vector<int> l_vLevelSize(l_i32MaxLevel + 1, 0);
+        for(uint ii = 0; ii < vSubset.size(); ++ii)
+        {
+            ++l_vLevelSize[oData.m_vLevel[vSubset[ii]]];
+        }
+
+        int l_i32SepLevel = 1, l_i32Count = l_vLevelSize[0];
+        while(l_i32SepLevel < l_i32MaxLevel - 1 && l_i32Count + l_vLevelSize[l_i32SepLevel] < static_cast<int>(vSubset.size()) / 2)
+        {
+            l_i32Count += l_vLevelSize[l_i32SepLevel++];
+        }
+
+        std::vector<int> l_vA, l_vB, l_vS;
+        for(uint ii = 0; ii < vSubset.size(); ++ii)
+        {
+            int l_i32V = vSubset[ii];
+            int l_i32Level = oData.m_vLevel[l_i32V];
+
+            if(l_i32Level < l_i32SepLevel)
+            {
+                l_vA.push_back(l_i32V);
+            }
+            else if(l_i32Level > l_i32SepLevel)
+            {
+                l_vB.push_back(l_i32V);
+            }
+            else
+            {
+                // a separator vertex with no neighbour in the second part doesn't separate anything
+                bool l_bSeparate = false;
+                for(int jj = (*oData.m_pAdjPtr)[l_i32V]; jj < (*oData.m_pAdjPtr)[l_i32V+1]; ++jj)
+                {
+                    int l_i32W = (*oData.m_pAdjId)[jj];
+                    if(oData.m_vLabel[l_i32W] == l_i32Label && oData.m_vLevel[l_i32W] == l_i32SepLevel + 1)
+                    {
+                        l_bSeparate = true;
+                        break;
+                    }
+                }
+
+                if(l_bSeparate)
+                {
+                    l_vS.push_back(l_i32V);
+                }
+                else
+                {
+                    l_vA.push_back(l_i32V);
+                }
+            }
+        }
+
+        dissect(oData, l_vA);
+        dissect(oData, l_vB);
+        oData.m_pOrder->insert(oData.m_pOrder->end(), l_vS.begin(), l_vS.end());
+    }
+}
+
+
+// ############################################# SWSparseMatrix
+
+int SWSparseMatrix::valueIndex(cint i32Row, cint i32Col) const
+{
+    std::vector<int>::const_iterator l_itBegin = m_vRowId.begin() + m_vColPtr[i32Col];
+    std::vector<int>::const_iterator l_itEnd   = m_vRowId.begin() + m_vColPtr[i32Col+1];
+    std::vector<int>::const_iterator l_it      = std::lower_bound(l_itBegin, l_itEnd, i32Row);
+
+    if(l_it == l_itEnd || *l_it != i32Row)
+    {
+        return -1;
+    }
+
+    return static_cast<int>(l_it - m_vRowId.begin());
+}
+
+void SWSparseMatrix::setZero()
+{
+    std::fill(m_vValues.begin(), m_vValues.end(), 0.0);
+}
+
+int SWSparseMatrix::nonZeros() const
+{
+    return static_cast<int>(m_vRowId.size());
+}
+
+
+// ############################################# SWSparseLDLT
+
+SWSparseLDLT::SWSparseLDLT() : m_bAnalyzed(false), m_i32Size(0)
+{}
+
+bool SWSparseLDLT::isAnalyzed() const
+{
+    return m_bAnalyzed;
+}
+
+int SWSparseLDLT::factorNonZeros() const
+{
+    return m_bAnalyzed ? m_vLp[m_i32Size] : 0;
+}
+
+void SWSparseLDLT::nestedDissection(const std::vector<int> &vAdjPtr, const std::vector<int> &vAdjId, std::vector<int> &vOrder)
+{
+    int l_i32VerticesNb = static_cast<int>(vAdjPtr.size()) - 1;
+
+    SWDissectionData l_oData;
+    l_oData.m_pAdjPtr = &vAdjPtr;
+    l_oData.m_pAdjId  = &vAdjId;
+    l_oData.m_vLabel.assign(l_i32VerticesNb, 0);
+    l_oData.m_vLevel.assign(l_i32VerticesNb, -1);
+    l_oData.m_vQueue.assign(l_i32VerticesNb, 0);
+    l_oData.m_i32LabelCounter = 0;
+    l_oData.m_pOrder = &vOrder;
+
+    vOrder.clear();
+    vOrder.reserve(l_i32VerticesNb);
+
+    std::vector<int> l_vAll(l_i32VerticesNb);
+    for(int ii = 0; ii < l_i32VerticesNb; ++ii)
+    {
+        l_vAll[ii] = ii;
+    }
+
+    dissect(l_oData, l_vAll);
+}
+
+void SWSparseLDLT::analyzePattern(const SWSparseMatrix &oA, cuint ui32BlockSize)
+{
+    m_i32Size = oA.m_i32Size;
+    int l_i32BlockSize = static_cast<int>(ui32BlockSize);
+    if(l_i32BlockSize < 1 || m_i32Size % l_i32BlockSize != 0)
+    {
+        l_i32BlockSize = 1;
+    }
+    int l_i32BlocksNb = m_i32Size / l_i32BlockSize;
+
+    // build the block adjacency graph
+        std::vector<std::vector<int> > l_vBlockLinks(l_i32BlocksNb);
+        std::vector<int> l_vMark(l_i32BlocksNb, -1);
+
+        for(int l_i32BJ = 0; l_i32BJ < l_i32BlocksNb; ++l_i32BJ)
+        {
+            for(int jj = l_i32BJ * l_i32BlockSize; jj < (l_i32BJ + 1) * l_i32BlockSize; ++jj)
+            {
+                for(int ii = oA.m_vColPtr[jj]; ii < oA.m_vColPtr[jj+1]; ++ii)
+                {
+                    int l_i32BI = oA.m_vRowId[ii] / l_i32BlockSize;
+
+                    if(l_i32BI != l_i32BJ && l_vMark[l_i32BI] != l_i32BJ)
+                    {
+                        l_vMark[l_i32BI] = l_i32BJ;
+                        l_vBlockLinks[l_i32BJ].push_back(l_i32BI);
+                        l_vBlockLinks[l_i32BI].push_back(l_i32BJ);
+                    }
+                }
+            }
+        }
+
+        std::vector<int> l_vAdjPtr(l_i32BlocksNb + 1, 0), l_vAdjId;
+        for(int ii = 0; ii < l_i32BlocksNb; ++ii)
+        {
+            l_vAdjPtr[ii+1] = l_vAdjPtr[ii] + static_cast<int>(l_vBlockLinks[ii].size());
+        }
+        l_vAdjId.reserve(l_vAdjPtr[l_i32BlocksNb]);
+        for(int ii = 0; ii < l_i32BlocksNb; ++ii)
+        {
+            l_vAdjId.insert(l_vAdjId.end(), l_vBlockLinks[ii].begin(), l_vBlockLinks[ii].end());
+        }
+        l_vBlockLinks.clear();
+
+    // fill reducing ordering
+        std::vector<int> l_vBlockOrder;
+        nestedDissection(l_vAdjPtr, l_vAdjId, l_vBlockOrder);
+
+        m_vPerm.resize(m_i32Size);
+        m_vPermInv.resize(m_i32Size);
+        for(int ii = 0; ii < l_i32BlocksNb; ++ii)
+        {
+            for(int jj = 0; jj < l_i32BlockSize; ++jj)
+            {
+                m_vPerm[ii * l_i32BlockSize + jj] = l_vBlockOrder[ii] * l_i32BlockSize + jj;
+            }
+        }
+        for(int ii = 0; ii < m_i32Size; ++ii)
+        {
+            m_vPermInv[m_vPerm[ii]] = ii;
+        }
+
+    // build the pattern of P A P^T (upper part)
+        std::vector<std::vector<std::pair<int,int> > > l_vCols(m_i32Size);
+        for(int jj = 0; jj < m_i32Size; ++jj)
+        {
+            for(int ii = oA.m_vColPtr[jj]; ii < oA.m_vColPtr[jj+1]; ++ii)
+            {
+                int l_i32NewRow = m_vPermInv[oA.m_vRowId[ii]];
+                int l_i32NewCol = m_vPermInv[jj];
+                if(l_i32NewRow > l_i32NewCol)
+                {
+                    std::swap(l_i32NewRow, l_i32NewCol);
+                }
+                l_vCols[l_i32NewCol].push_back(std::make_pair(l_i32NewRow, ii));
+            }
+        }
+
+        m_oPA.m_i32Size = m_i32Size;
+        m_oPA.m_vColPtr.assign(m_i32Size + 1, 0);
+        m_oPA.m_vRowId.resize(oA.m_vRowId.size());
+        m_oPA.m_vValues.assign(oA.m_vRowId.size(), 0.0);
+        m_vValueMap.resize(oA.m_vRowId.size());
+
+        for(int jj = 0; jj < m_i32Size; ++jj)
+        {
+            std::sort(l_vCols[jj].begin(), l_vCols[jj].end());
+            m_oPA.m_vColPtr[jj+1] = m_oPA.m_vColPtr[jj] + static_cast<int>(l_vCols[jj].size());
+
+            for(uint ii = 0; ii < l_vCols[jj].size(); ++ii)
+            {
+                int l_i32Id = m_oPA.m_vColPtr[jj] + ii;
+                m_oPA.m_vRowId[l_i32Id] = l_vCols[jj][ii].first;
+                m_vValueMap[l_vCols[jj][ii].second] = l_i32Id;
+            }
+        }
+
+    // symbolic factorization : elimination tree and column counts of L
+        m_vParent.assign(m_i32Size, -1);
+        m_vLnz.assign(m_i32Size, 0);
+        m_vFlag.assign(m_i32Size, -1);
+
+        for(int kk = 0; kk < m_i32Size; ++kk)
+        {
+            m_vFlag[kk] = kk;
+
+            for(int pp = m_oPA.m_vColPtr[kk]; pp < m_oPA.m_vColPtr[kk+1]; ++pp)
+            {
+                for(int ii = m_oPA.m_vRowId[pp]; ii < kk && m_vFlag[ii] != kk; ii = m_vParent[ii])
+                {
+                    if(m_vParent[ii] == -1)
+                    {
+                        m_vParent[ii] = kk;
+                    }
+
+                    ++m_vLnz[ii];
+                    m_vFlag[ii] = kk;
+                }
+            }
+        }
+
+        m_vLp.assign(m_i32Size + 1, 0);
+        for(int kk = 0; kk < m_i32Size; ++kk)
+        {
+            m_vLp[kk+1] = m_vLp[kk] + m_vLnz[kk];
+        }
+
+        m_vLi.resize(m_vLp[m_i32Size]);
+        m_vLx.resize(m_vLp[m_i32Size]);
+        m_vD.resize(m_i32Size);
+        m_vY.assign(m_i32Size, 0.0);
+        m_vX.resize(m_i32Size);
+        m_vPattern.resize(m_i32Size);
+
+    m_bAnalyzed = true;
+}
+
+bool SWSparseLDLT::factorize(const SWSparseMatrix &oA)
+{
+    if(!m_bAnalyzed || oA.m_vValues.size() != m_vValueMap.size())
+    {
+        std::cerr << "Error : SWSparseLDLT::factorize, analyzePattern must be called with the same pattern before. " << std::endl;
+        return false;
+    }
+
+    // scatter the values in the permuted matrix
+        for(uint ii = 0; ii < m_vValueMap.size(); ++ii)
+        {
+            m_oPA.m_vValues[m_vValueMap[ii]] = oA.m_vValues[ii];
+        }
+
+    // up-looking LDL^T, row kk of L is computed with a sparse triangular solve
+        for(int kk = 0; kk < m_i32Size; ++kk)
+        {
+            m_vY[kk] = 0.0;
+            int l_i32Top = m_i32Size;
+            m_vFlag[kk]  = kk;
+            m_vLnz[kk]   = 0;
+
+            for(int pp = m_oPA.m_vColPtr[kk]; pp < m_oPA.m_vColPtr[kk+1]; ++pp)
+            {
+                int ii = m_oPA.m_vRowId[pp];
+                m_vY[ii] += m_oPA.m_vValues[pp];
+
+                int l_i32Len = 0;
+                for(; m_vFlag[ii] != kk; ii = m_vParent[ii])
+                {
+                    m_vPattern[l_i32Len++] = ii;
+                    m_vFlag[ii] = kk;
+                }
+
+                while(l_i32Len > 0)
+                {
+                    m_vPattern[--l_i32Top] = m_vPattern[--l_i32Len];
+                }
+            }
+
+            m_vD[kk] = m_vY[kk];
+            m_vY[kk] = 0.0;
+
+            for(; l_i32Top < m_i32Size; ++l_i32Top)
+            {
+                int ii = m_vPattern[l_i32Top];
+                double l_dYi = m_vY[ii];
+                m_vY[ii] = 0.0;
+
+                int l_i32End = m_vLp[ii] + m_vLnz[ii];
+                for(int pp = m_vLp[ii]; pp < l_i32End; ++pp)
+                {
+                    m_vY[m_vLi[pp]] -= m_vLx[pp] * l_dYi;
+                }
+
+                double l_dLki = l_dYi / m_vD[ii];
+                m_vD[kk] -= l_dLki * l_dYi;
+                m_vLi[l_i32End] = kk;
+                m_vLx[l_i32End] = l_dLki;
+                ++m_vLnz[ii];
+            }
+
+            if(m_vD[kk] == 0.0)
+            {
+                std::cerr << "Error : SWSparseLDLT::factorize, singular matrix (pivot " << kk << "). " << std::endl;
+                return false;
+            }
+        }
+
+    return true;
+}
+
+void SWSparseLDLT::solve(double *aDRhs) const
+{
+    for(int ii = 0; ii < m_i32Size; ++ii)
+    {
+        m_vX[ii] = aDRhs[m_vPerm[ii]];
+    }
+
+    // L y = b
+    for(int jj = 0; jj < m_i32Size; ++jj)
+    {
+        double l_dXj = m_vX[jj];
+        for(int pp = m_vLp[jj]; pp < m_vLp[jj+1]; ++pp)
+        {
+            m_vX[m_vLi[pp]] -= m_vLx[pp] * l_dXj;
+        }
+    }
+
+    // D z = y
+    for(int jj = 0; jj < m_i32Size; ++jj)
+    {
+        m_vX[jj] /= m_vD[jj];
+    }
+
+    // L^T x = z
+    for(int jj = m_i32Size - 1; jj >= 0; --jj)
+    {
+        double l_dXj = m_vX[jj];
+        for(int pp = m_vLp[jj]; pp < m_vLp[jj+1]; ++pp)
+        {
+            l_dXj -= m_vLx[pp] * m_vX[m_vLi[pp]];
+        }
+        m_vX[jj] = l_dXj;
+    }
+
+    for(int ii = 0; ii < m_i32Size; ++ii)
+    {
+        aDRhs[m_vPerm[ii]] = m_vX[ii];
+    }
+}
@@ -55,15 +55,16 @@ static int nGetProfWidthFromModel (int iPoint, const ASM_LEVEL_DATA &AsmLev)
 // ix and iy are the offset and orthogonal offset wrt iPoint.
 
 static double GetProfDist (
-	const SEARCH_IMAGES &SearchImgs,         // in: all args
+	ASM_WORKSPACE &Ws,                       // io: scratch buffers
+	const SEARCH_IMAGES &SearchImgs,         // in: all the others
 	const int iPoint, const int ix, const int iy,
 	const ASM_LEVEL_DATA &AsmLev, const SHAPE &Shape,
 	const double SigmoidScale)
 {
-	// It is quicker to allocate Prof statically and call dim() each time because
+	// It is quicker to keep Prof in the workspace and call dim() each time because
 	// most of the time the dimension is the same as the previous profile
 	// (and so we avoid a malloc and free every time this routine is called).
-	static StasmVec Prof;
+	StasmVec &Prof = Ws.Prof;
 	Prof.dim(1, AsmLev.Profs[iPoint].ncols());
 
 	if (IS_2D(AsmLev.ProfSpecs[iPoint])) // two dimensional profile?
@@ -71,10 +72,10 @@ static double GetProfDist (
 		const int nProfWidth = nGetProfWidthFromModel(iPoint, AsmLev);
 		Get2dProf(Prof,
 		AsmLev.ProfSpecs[iPoint], SearchImgs.Grads,
-		Shape, iPoint, ix, iy, nProfWidth, SigmoidScale);
+		Shape, iPoint, ix, iy, nProfWidth, SigmoidScale, Ws.NormalizedProfLen);
 	}
 	else
-	    Get1dProf(Prof, AsmLev.ProfSpecs[iPoint], SearchImgs.Img, iPoint, ix);
+	    Get1dProf(Prof, AsmLev.ProfSpecs[iPoint], SearchImgs.Img, iPoint, ix, Ws);
 
 	Prof -= AsmLev.Profs[iPoint]; // for efficiency, use "-=" rather than "="
 	const StasmMat *pCovar = &AsmLev.Covars[iPoint];
@@ -88,6 +89,7 @@ static double GetProfDist (
 static void FindBestMatchingProf (
 	int &ixBest,     		    // out
 	int &iyBest,                        // out
+	ASM_WORKSPACE &Ws,                  // io: scratch buffers
 	int iPoint,                         // in
 	const SHAPE &Shape,                 // in
 	const LANDMARK LandTab[],           // in
@@ -102,7 +104,7 @@ static void FindBestMatchingProf (
 	if (IS_2D(ProfSpec))            // two dimensional profile?
 		nyMaxOffset = nPixSearch;   // if so, we need to offset in y dir also
 	else
-		PrepareProf1D(SearchImgs.Img, Shape, ProfSpec, LandTab, 
+		PrepareProf1D(Ws, SearchImgs.Img, Shape, ProfSpec, LandTab, 
 			      iPoint, nGetProfWidthFromModel(iPoint, Model) + 2 * nPixSearch,
 			      0, fExplicitPrevNext);
 
@@ -112,7 +114,7 @@ static void FindBestMatchingProf (
 	for (int iy = -nyMaxOffset; iy <= nyMaxOffset; iy++)
 		for (int ix = -nPixSearch; ix <= nPixSearch; ix++)
 		{
-			double Fit = GetProfDist(SearchImgs, iPoint, ix, iy,
+			double Fit = GetProfDist(Ws, SearchImgs, iPoint, ix, iy,
 						 Model, Shape, SigmoidScale);
 
 			// Test for a new best fit. We test using "<=" instead of just "<"
@@ -130,6 +132,7 @@ static void FindBestMatchingProf (
     
 static int GetSuggestedShape (
 	SHAPE& SuggestedShape,           	        // io
+	ASM_WORKSPACE &Ws,                              // io: scratch buffers
 	const SHAPE& Shape,                             // in
 	const SEARCH_IMAGES &SearchImgs,                // in
 	const ASM_LEVEL_DATA &Model,                    // in
@@ -147,7 +150,7 @@ static int GetSuggestedShape (
 		if (IS_2D(ProfSpec))         // two dimensional profile?
 			nPixSearch = nPixSearch2d;
 
-		FindBestMatchingProf(ixBest, iyBest,
+		FindBestMatchingProf(ixBest, iyBest, Ws,
 			iPoint, Shape, LandTab, SearchImgs, Model,
 			nPixSearch, SigmoidScale, fExplicitPrevNext);
 
@@ -187,17 +190,23 @@ static int GetSuggestedShape (
 	SEARCH_IMAGES &SearchImgs,  // in
 	const ASM_MODEL &Model,     // in
 	int iLev,                   // in
-	const LANDMARK LandTab[])   // in
+	const LANDMARK LandTab[],   // in
+	ASM_WORKSPACE &Ws)          // io: scratch buffers of this search
 {
 	int   iter = 0, nGoodLandmarks = 0;
-	SHAPE SuggestedShape(Shape);    // shape after profile matching
+	SHAPE &SuggestedShape = Ws.SuggestedShape;  // shape after profile matching
+	SuggestedShape.assign(Shape);
+
+	Ws.NormalizedProfLen = Model.NormalizedProfLen;
 
 	// The shape params, initialized to 0.  The original formulation called for
 	// this to be set to 0 each time we run the model but we get slightly
 	// better results if we remember the shape params from the previous run.
 	// Thus this is outside the loop.
 
-	StasmVec b(Model.EigVecs.nrows());
+	StasmVec &b = Ws.b;
+	b.dim(Model.EigVecs.nrows(), 1);
+	b = 0.0;
 
     int nPoints = static_cast<int>(Shape.nrows());
 
@@ -206,7 +215,7 @@ static int GetSuggestedShape (
 	{
 		// estimate the best SuggestedShape by profile matching the landmarks in Shape
 
-		nGoodLandmarks = GetSuggestedShape(SuggestedShape,
+		nGoodLandmarks = GetSuggestedShape(SuggestedShape, Ws,
 					       Shape, SearchImgs,
 					       Model.AsmLevs[iLev], LandTab,
 					       Model.nPixSearch, Model.nPixSearch2d,
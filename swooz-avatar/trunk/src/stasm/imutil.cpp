@@ -4,10 +4,10 @@
 
 //-----------------------------------------------------------------------------
 // Helper function for ScaleImage.  Actually a macro, for speed.
+// igPos, igPos1 and gFrac must be locals of the caller (not globals, so
+// images can be scaled by several threads at the same time).
 // using namespace swStasm;
 
-static int igPos, igPos1; double gFrac;
-
 #define INTERPOLATE_PIXEL(pIn, ix, Scale, Max)                          \
 {                                                                       \
 igPos = int(ix * Scale);                                                \
@@ -27,6 +27,8 @@ ScaleImage (Image &Img,                                                     // i
         const int nNewWidth, const int nNewHeight, const bool fBilinear)    // in
 {
 int   ix, iy;
+int   igPos, igPos1;    // used by INTERPOLATE_PIXEL
+double gFrac;           // ditto
 const int width = Img.width;
 const int height = Img.height;
 const double scaleX = (double)width /nNewWidth;
@@ -79,6 +81,73 @@ if (width != nNewWidth || height != nNewHeight)
     }
 }
 
+//-----------------------------------------------------------------------------
+// Like ScaleImage but the input image is not modified and the result is
+// written in OutImg, TmpImg holds the horizontal pass of the bilinear scaling.
+// The buffers of OutImg and TmpImg are reused when their size doesn't change,
+// so a caller keeping them between calls makes no allocation.
+// The pixels are the same as ScaleImage.
+
+void
+ScaleImageInto (Image &OutImg, Image &TmpImg,                                  // out, io: scratch
+        const Image &InImg,                                                     // in
+        const int nNewWidth, const int nNewHeight, const bool fBilinear)        // in
+{
+int   ix, iy;
+int   igPos, igPos1;    // used by INTERPOLATE_PIXEL
+double gFrac;           // ditto
+const int width = InImg.width;
+const int height = InImg.height;
+const double scaleX = (double)width /nNewWidth;
+const double scaleY = (double)height/nNewHeight;
+
+ASSERT(&OutImg != &InImg && &TmpImg != &InImg && &OutImg != &TmpImg);
+
+OutImg.dim(nNewWidth, nNewHeight);
+
+if (width == nNewWidth && height == nNewHeight)
+    memcpy(OutImg.buf, InImg.buf, width * height);
+else if (fBilinear)
+    {
+    // scale horizontally
+
+    TmpImg.dim(nNewWidth, height);
+    const byte *pIn = InImg.buf;
+    for (iy = 0; iy < height; iy++)
+        {
+        for (ix = 0; ix < nNewWidth; ix++)
+            {
+            INTERPOLATE_PIXEL(pIn, ix, scaleX, width);
+            TmpImg(iy + ix * height) = (byte)gFrac;
+            }
+        pIn += width;
+        }
+    // scale vertically
+
+    byte * const pOut = OutImg.buf;
+    pIn = TmpImg.buf;
+
+    for (iy = 0; iy < nNewWidth; iy++)
+        {
+        for (ix = 0; ix < nNewHeight; ix++)
+            {
+            INTERPOLATE_PIXEL(pIn, ix, scaleY, height);
+            pOut[iy + ix * nNewWidth] = (byte)gFrac;
+            }
+        pIn += height;
+        }
+    }
+else    // nearest pixel
+    {
+    for (iy = 0; iy < nNewHeight; iy++)
+        {
+        int iy1 = (iy * height) / nNewHeight;
+        for (ix = 0; ix < nNewWidth; ix++)
+            OutImg(ix, iy) = InImg((ix * width) / nNewWidth, iy1);
+        }
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 ReduceImage (Image &Img,                        // io
@@ -104,6 +173,36 @@ if (!fEqual(Scale, 1, 1e-6))    // only reduce if we have to
     }
 }
 
+//-----------------------------------------------------------------------------
+// Like ReduceImage but the input image is not modified, see ScaleImageInto
+
+void
+ReduceImageInto (Image &OutImg, Image &TmpImg,      // out, io: scratch
+                 const Image &InImg,                // in
+                 double Scale, int ReduceMethod)    // in
+{
+if (fEqual(Scale, 1, 1e-6))      // only reduce if we have to, else copy
+    ScaleImageInto(OutImg, TmpImg, InImg, InImg.width, InImg.height, IM_NEAREST_PIXEL);
+else
+    {
+    int nNewWidth = iround(InImg.width / Scale), nNewHeight = iround(InImg.height / Scale);
+    ASSERT(nNewWidth > 10 && nNewHeight > 10);  // 10 is rather arbitrary
+    switch (ReduceMethod)
+        {
+        case IM_NEAREST_PIXEL:
+            ScaleImageInto(OutImg, TmpImg, InImg, nNewWidth, nNewHeight, IM_NEAREST_PIXEL);
+            break;
+        case IM_BILINEAR:
+            ScaleImageInto(OutImg, TmpImg, InImg, nNewWidth, nNewHeight, IM_BILINEAR);
+            break;
+        case IM_AVERAGE_ALL:
+        default:
+            Err("ReduceImageInto: bad ReduceMethod");
+            break;
+        }
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 FillImage (Image &Img,      // io
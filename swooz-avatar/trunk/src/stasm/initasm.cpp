@@ -327,35 +327,37 @@ if (Mod1.nStartLev >= nLevs1)
 //-----------------------------------------------------------------------------
 // Init Models from the .asm and .conf files and global defines.
 // Returns the number of models, 1 or 2.
+//
+// The Models are read at each call (they used to be read only at the first
+// call, leaving the Models of the next callers uninitialized).
+// The config files are read in the CONF_ globals, so the calls must not be
+// made by several threads at the same time.
 
 int                                      // returns the number of models
 nInitAsmModels (ASM_MODEL  Models[],     // out: two ASM models
                 const char sConfFile0[], // in: 1st config filename
                 const char sConfFile1[]) // in: 2nd config filename, "" if none
 {
-static int nModels = 0;
-if (nModels == 0)                       // Models not yet initialized?
+int nModels = 0;
+ASSERT(sConfFile0 != NULL);
+ASSERT(sConfFile0[0]);
+int nLevs0;
+char sAsmFile0[SLEN];
+// if (VERBOSE_ASM_SEARCH)
+    // lprintf("\n");
+InitAsm(Models[0], nLevs0, sAsmFile0,
+        StasmConfTab, NELEMS(StasmConfTab), sConfFile0);
+nModels++;
+if (sConfFile1 && sConfFile1[0])    // stacked models?
     {
-    ASSERT(sConfFile0 != NULL);
-    ASSERT(sConfFile0[0]);
-    int nLevs0;
-    char sAsmFile0[SLEN];
-    // if (VERBOSE_ASM_SEARCH)
-        // lprintf("\n");
-    InitAsm(Models[0], nLevs0, sAsmFile0,
-            StasmConfTab, NELEMS(StasmConfTab), sConfFile0);
+    int nLevs1;
+    char sAsmFile1[SLEN];
+    InitAsm(Models[1], nLevs1, sAsmFile1,
+            StasmConfTab, NELEMS(StasmConfTab), sConfFile1);
+    CheckModelConsistency(Models[0], Models[1],
+                          nLevs0, nLevs1, sAsmFile0, sAsmFile1);
+    Models[1].nStartLev = CONF_n2ndModelStartLev;
     nModels++;
-    if (sConfFile1 && sConfFile1[0])    // stacked models?
-        {
-        int nLevs1;
-        char sAsmFile1[SLEN];
-        InitAsm(Models[1], nLevs1, sAsmFile1,
-                StasmConfTab, NELEMS(StasmConfTab), sConfFile1);
-        CheckModelConsistency(Models[0], Models[1],
-                              nLevs0, nLevs1, sAsmFile0, sAsmFile1);
-        Models[1].nStartLev = CONF_n2ndModelStartLev;
-        nModels++;
-        }
     }
 return nModels;
 }
@@ -56,33 +56,49 @@ return nRoot;
 }
 
 //-----------------------------------------------------------------------------
-// return normalized vector bisector of three ordered points
+// normalize the 2D vector x,y in place, zero length vectors are left unchanged
 
-static StasmVec
-GetBisector (const StasmVec &Prev, const StasmVec &This, const StasmVec &Next) // all in
+static inline void
+Normalize2dVec (double &x, double &y)           // io
 {
-static StasmVec p(2, ROWVEC), q(2, ROWVEC);  // static to reduce number of mallocs
-
-ASSERT(!(Prev(VX) == 0 && Prev(VY) == 0));
-ASSERT(!(This(VX) == 0 && This(VY) == 0));
-ASSERT(!(Next(VX) == 0 && Next(VY) == 0));
-
-static StasmVec d0; d0.assign(This); d0 -= Prev; d0.normalizeMe();
+const double Len = sqrt(x * x + y * y);
+if (!fEqual(Len, 0))
+    {
+    x /= Len;
+    y /= Len;
+    }
+}
 
-p(VX) = d0(VY);                                 // rotate 90 degrees
-p(VY) = -d0(VX);
+//-----------------------------------------------------------------------------
+// return normalized vector bisector of three ordered points
+// The points are given by their coordinates so no matrix is allocated,
+// this is called for each landmark of each search iteration.
 
-static StasmVec d1; d1.assign(Next); d1 -=This; d1.normalizeMe();
+static void
+GetBisector (double &xBisector, double &yBisector,  // out
+             double xPrev, double yPrev,            // in: all the others
+             double xThis, double yThis,
+             double xNext, double yNext)
+{
+ASSERT(!(xPrev == 0 && yPrev == 0));
+ASSERT(!(xThis == 0 && yThis == 0));
+ASSERT(!(xNext == 0 && yNext == 0));
 
-q(VX) = d1(VY);
-q(VY) = -d1(VX);
+double x0 = xThis - xPrev, y0 = yThis - yPrev;
+Normalize2dVec(x0, y0);
 
-StasmVec d(p); d += q; d.normalizeMe();
+double x1 = xNext - xThis, y1 = yNext - yThis;
+Normalize2dVec(x1, y1);
 
-if (fabs(d(VX)) < 1e-10 && fabs(d(VY)) < 1e-10) // are Prev and Next in same line?
-    return (This - Prev).normalize();           // yes, avoid numerical issues
+xBisector = y0 + y1;                            // sum of the vectors rotated by 90 degrees
+yBisector = -x0 - x1;
+Normalize2dVec(xBisector, yBisector);
 
-return d;
+if (fabs(xBisector) < 1e-10 && fabs(yBisector) < 1e-10) // are Prev and Next in same line?
+    {                                           // yes, avoid numerical issues
+    xBisector = x0;
+    yBisector = y0;
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -157,14 +173,11 @@ ASSERT(fPointUsed(Shape, iPoint));
 int iPrev, iNext;
 GetPrevNextLandmarks(iPrev, iNext,
                      Shape, iPoint, LandTab, fExplicitPrevNext);
-static StasmVec PrevRow; PrevRow.dim(Shape.ncols(), ROWVEC); PrevRow = Shape.row(iPrev);
-static StasmVec NextRow; NextRow.dim(Shape.ncols(), ROWVEC); NextRow = Shape.row(iNext);
-
-static StasmVec Whisker;
-Whisker.assign(GetBisector(PrevRow, Shape.row(iPoint), NextRow));
+GetBisector(DeltaX, DeltaY,
+            Shape(iPrev, VX),  Shape(iPrev, VY),
+            Shape(iPoint, VX), Shape(iPoint, VY),
+            Shape(iNext, VX),  Shape(iNext, VY));
 
-DeltaX = Whisker(VX);
-DeltaY = Whisker(VY);
 const double AbsDeltaX = fabs(DeltaX);
 const double AbsDeltaY = fabs(DeltaY);
 if (AbsDeltaX >= AbsDeltaY)
@@ -179,18 +192,6 @@ else
     }
 }
 
-//-----------------------------------------------------------------------------
-// variables for PrepareProf and GetProf routines
-
-// max number of elems in a profile including nPixSearch on each end
-static const int MAX_PROF_WIDTH_1D = 50;
-
-static StasmVec          gProf(MAX_PROF_WIDTH_1D, MAX_PROF_WIDTH_1D);
-static int          ngProfWidth;
-static int          igProfPoint;    // for sanity checking
-static const byte   *pgProfImage;   // ditto
-static unsigned     gSubProfSpec;   // ditto
-
 //-----------------------------------------------------------------------------
 // If you want multiple 1D profiles along one whisker, then
 //      i.  call PrepareProf1D once with nProfWidth set to the length
@@ -210,9 +211,12 @@ static unsigned     gSubProfSpec;   // ditto
 //
 // Note on direction of "previous":
 // if whisker is vertical, PrevPix is below this pixel
+//
+// The whole profile is kept in Ws.Prof1d for the following Get1dProf calls.
 
 void
-PrepareProf1D (const Image &Img,            // in: all
+PrepareProf1D (ASM_WORKSPACE &Ws,           // out: the whole profile
+               const Image &Img,            // in: all the others
                const StasmMat &Shape,
                unsigned SubProfSpec,
                const LANDMARK LandTab[],
@@ -225,10 +229,12 @@ ASSERT(!IS_2D(SubProfSpec));
 ASSERT(nProfWidth < MAX_PROF_WIDTH_1D);
 ASSERT((SubProfSpec & PROF_TBits) == PROF_Grad);
 
-ngProfWidth = nProfWidth;
-igProfPoint = iPoint;       // for sanity checking in Get1dProf later
-pgProfImage = Img.buf;      // ditto
-gSubProfSpec = SubProfSpec; // ditto
+Ws.nProf1dWidth = nProfWidth;
+Ws.iProf1dPoint = iPoint;       // for sanity checking in Get1dProf later
+Ws.pProf1dImage = Img.buf;      // ditto
+Ws.Prof1dSpec   = SubProfSpec;  // ditto
+
+double * const pProf = Ws.Prof1d.m->data; // for speed, access mat buf directly
 
 // number of profile sample points
 // nProfWidth is +-nSamplePoints and middle point
@@ -251,7 +257,7 @@ for (int iSample = -nSamplePoints; iSample <= nSamplePoints; iSample++)
     int ix = iGetX(x, iSample, 0, DeltaX, DeltaY);
     int iy = iGetY(y, iSample, 0, DeltaX, DeltaY);
     double Pix = iGetPixel(Img, ix, iy);
-    gProf(0, iSample + nSamplePoints) = Pix - PrevPix;
+    pProf[iSample + nSamplePoints] = Pix - PrevPix;
     PrevPix = Pix;
     }
 }
@@ -259,44 +265,53 @@ for (int iSample = -nSamplePoints; iSample <= nSamplePoints; iSample++)
 //-----------------------------------------------------------------------------
 static void
 Normalize1d (StasmVec &Prof,             // io
-             unsigned SubProfSpec)  // in
+             unsigned SubProfSpec,       // in
+             double NormalizedProfLen)   // in
 {
 ASSERT(!IS_2D(SubProfSpec));
 ASSERT((SubProfSpec & PROF_NormalizationField) == PROF_Flat);
 
-const double Sum = Prof.absSum() / (Prof.ncols() * CONF_NormalizedProfLen);
+const double Sum = Prof.absSum() / (Prof.ncols() * NormalizedProfLen);
 if (!fEqual(Sum, 0))
     Prof /= Sum;
 }
 
 //-----------------------------------------------------------------------------
-// Use this after preparing global vars by calling PrepareProf1D.
+// Use this after preparing the workspace by calling PrepareProf1D.
 // iOffset is offset along whisker from point, can be +ve or -ve.
 
 void
 Get1dProf (StasmVec &Prof,                                                   // out
-     unsigned SubProfSpec, const Image &Img, int iPoint, int iOffset)   // in
+     unsigned SubProfSpec, const Image &Img, int iPoint, int iOffset,   // in
+     const ASM_WORKSPACE &Ws)                                           // in
 {
 ASSERT(!IS_2D(SubProfSpec));
 ASSERT((SubProfSpec & PROF_FBit) == 0);
 
 // sanity checks -- make sure PrepareProf1D was called correctly
 
-ASSERT(iPoint == igProfPoint);
-ASSERT(Img.buf == pgProfImage);
-ASSERT(SubProfSpec == gSubProfSpec);
+ASSERT(iPoint == Ws.iProf1dPoint);
+ASSERT(Img.buf == Ws.pProf1dImage);
+ASSERT(SubProfSpec == Ws.Prof1dSpec);
 
 const int nProfWidth = static_cast<int>(Prof.ncols());      // +-nSamplePoints and middle point
-Prof = gProf.view(0,
-            ngProfWidth/2 + iOffset - nProfWidth/2, 1, nProfWidth);
+const int iStart = Ws.nProf1dWidth/2 + iOffset - nProfWidth/2;
+ASSERT(iStart >= 0 && iStart + nProfWidth <= Ws.nProf1dWidth);
+
+// copy the elems directly, a view would allocate its gsl_matrix struct
+const double * const pProf1d = Ws.Prof1d.m->data + iStart;
+double * const pProf = Prof.m->data;
+for (int i = 0; i < nProfWidth; i++)
+    pProf[i] = pProf1d[i];
 
-Normalize1d(Prof, SubProfSpec);
+Normalize1d(Prof, SubProfSpec, Ws.NormalizedProfLen);
 }
 
 //-----------------------------------------------------------------------------
 static void
 Normalize2d (StasmVec &Prof,                                     // io
-    const unsigned SubProfSpec, const double SigmoidScale)  // in
+    const unsigned SubProfSpec, const double SigmoidScale,  // in
+    const double NormalizedProfLen)                         // in
 {
 ASSERT(IS_2D(SubProfSpec));
 ASSERT((SubProfSpec & PROF_NormalizationField) == PROF_SigmAbsSum);
@@ -313,7 +328,7 @@ double * const pData = Prof.m->data; // for efficiency, access mat buf directly
 const double AbsSum = Prof.absSum();
 if (AbsSum != 0)
     {
-    const double Scale = nelems * CONF_NormalizedProfLen / AbsSum;
+    const double Scale = nelems * NormalizedProfLen / AbsSum;
     if (SigmoidScale == 0) // treat separately for speed
         {
         while (iCol < nelems)
@@ -421,7 +436,8 @@ Get2dProf (StasmVec &Prof,                                           // out
     const StasmMat &Grads,                                           // in
     const SHAPE &Shape, const int iPoint, const int ixOffset,   // in
     const int iyOffset, const int nProfWidth,                   // in
-    const double SigmoidScale)                                  // in
+    const double SigmoidScale,                                  // in
+    const double NormalizedProfLen)                             // in
 {
 ASSERT(IS_2D(ProfSpec));
 
@@ -429,7 +445,7 @@ Get2dProfFromGradMats(Prof,
                       ProfSpec, Grads, Shape, iPoint,
                       ixOffset, iyOffset, nProfWidth);
 
-Normalize2d(Prof, ProfSpec, SigmoidScale);
+Normalize2d(Prof, ProfSpec, SigmoidScale, NormalizedProfLen);
 }
 
 //-----------------------------------------------------------------------------
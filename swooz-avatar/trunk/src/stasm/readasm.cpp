@@ -97,6 +97,9 @@ AsmFileConfTab[10].p = &Asm.SigmoidScale;
 
 ReadConfTab(AsmFileConfTab, NELEMS(AsmFileConfTab), pAsmFile, sAsmFile);
 
+// keep the value with the model, the global is overwritten by the next model read
+Asm.NormalizedProfLen = CONF_NormalizedProfLen;
+
 if (Asm.fExplicitPrevNext && Asm.nPoints > ngElemsLandTab)
     Err("fExplicitPrevNext %d but nPoints %d is greater than ngElemsLandTab %d\n"
         "       Check %s",
@@ -44,14 +44,19 @@ using namespace swExcept;
 SWTrackFlow::SWTrackFlow(Size oWinSize, int i32MaxLvl) : m_oWinSize(oWinSize), m_i32Maxlvl(i32MaxLvl)
 {}
 
-bool SWTrackFlow::track(const Mat &oPreGray, const Mat &oGray,  const vector<Point2f> &vP2fPrePoints, const vector<Point2f> &vP2fPoints)
+bool SWTrackFlow::track(const Mat &oPreGray, const Mat &oGray,  const vector<Point2f> &vP2fPrePoints, vector<Point2f> &vP2fPoints)
 {
 	vector<uchar> l_vU8Status;
+	return track(oPreGray, oGray, vP2fPrePoints, vP2fPoints, l_vU8Status);
+}
+
+bool SWTrackFlow::track(const Mat &oPreGray, const Mat &oGray,  const vector<Point2f> &vP2fPrePoints, vector<Point2f> &vP2fPoints, vector<uchar> &vU8Status)
+{
 	vector<float> l_vFError;
 	
 	try
 	{
-		calcOpticalFlowPyrLK(oPreGray, oGray, vP2fPrePoints, vP2fPoints, l_vU8Status, l_vFError, m_oWinSize, m_i32Maxlvl);
+		calcOpticalFlowPyrLK(oPreGray, oGray, vP2fPrePoints, vP2fPoints, vU8Status, l_vFError, m_oWinSize, m_i32Maxlvl);
 	}
 	catch( const cv::Exception &e)
 	{
@@ -63,6 +63,7 @@ int main()
     }
 
     // start listening the kinect device
+    kinectDeviceT.setChannels(swDevice::KINECT_BGR_IMAGE);
     kinectDeviceT.startListening();
 
     while(!kinectDeviceT.isDataAvailable())
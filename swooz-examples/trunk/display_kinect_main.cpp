@@ -53,6 +53,8 @@ int main()
 
     char key = ' ';
 
+    kinectDevice.setChannels(swDevice::KINECT_BGR_IMAGE | swDevice::KINECT_CLOUD_MAP);
+
     // set the display loop
     while(key != 'q')
     {
@@ -54,23 +54,28 @@ int main()
     }
 
     // start listening the kinect device
+    kinectDeviceT.setChannels(swDevice::KINECT_BGR_IMAGE | swDevice::KINECT_CLOUD_MAP);
     kinectDeviceT.startListening();
 
-    while(!kinectDeviceT.isDataAvailable())
-    {
-        cv::waitKey(5);
-    }
-
     char key = ' ';
+    uint lastFrameId = 0;
 
     // set the display loop
     while(key != 'q')
     {
-        // display the kinect rgb image in the opencv window
-        cv::imshow("rgb_kinect" ,kinectDeviceT.bgrImage());
+        // wait for a new frame, the frame is shared with the kinect thread without copy
+        swDevice::SWKinectFramePtr frame = kinectDeviceT.waitFrame(lastFrameId);
+
+        if(frame)
+        {
+            lastFrameId = frame->m_ui32Id;
+
+            // display the kinect rgb image in the opencv window
+            cv::imshow("rgb_kinect" ,frame->m_oBgrImage);
 
-        // display the kinect cloud map in the opencv window
-        cv::imshow("cloud_map_kinect", kinectDeviceT.cloudMap());
+            // display the kinect cloud map in the opencv window
+            cv::imshow("cloud_map_kinect", frame->m_oCloudMap);
+        }
 
         // wait key event for escaping the loop
         key = cv::waitKey(5);
@@ -0,0 +1,130 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file emicp_parity_main.cpp
+ * \author Florian Lance
+ * \date 16/10/26
+ * \brief Compare the rigid motions computed by the CUDA and the CPU emicp on recorded clouds, and display the CPU frame rate.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <time.h>
+
+#include "cloud/SWAlignClouds.h"
+
+/**
+ * \brief Align the clouds with the input device.
+ * \param [in] oTarget      : target cloud
+ * \param [in] oTemplate    : template cloud
+ * \param [in] eDevice      : emicp device
+ * \param [in] i32RunsNb    : number of alignments used for the timing
+ * \param [out] aFRotation  : rotation matrix [9]
+ * \param [out] aFTranslation : translation [3]
+ * \return the mean time of an alignment in seconds
+ */
+static float align(const swCloud::SWCloud &oTarget, const swCloud::SWCloud &oTemplate, const swCloud::SWEmicpDevice eDevice, cint i32RunsNb,
+                   float *aFRotation, float *aFTranslation)
+{
+    swCloud::SWAlignClouds l_oAlignClouds;
+    l_oAlignClouds.setEmicpDevice(eDevice);
+
+    clock_t l_oTime = clock();
+
+    for(int ii = 0; ii < i32RunsNb; ++ii)
+    {
+        l_oAlignClouds.setClouds(oTarget, oTemplate);
+        l_oAlignClouds.alignClouds();
+    }
+
+    float l_fTime = static_cast<float>(clock() - l_oTime) / CLOCKS_PER_SEC / i32RunsNb;
+
+    l_oAlignClouds.rigidMotion(aFRotation, aFTranslation);
+
+    return l_fTime;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 3)
+    {
+        std::cerr << "Usage : emicp_parity target.obj template.obj [runs number] [tolerance] " << std::endl;
+        return -1;
+    }
+
+    int l_i32RunsNb = 10;
+    if(argc > 3)
+    {
+        l_i32RunsNb = std::max(1, atoi(argv[3]));
+    }
+
+    float l_fTolerance = 1e-3f;
+    if(argc > 4)
+    {
+        l_fTolerance = static_cast<float>(atof(argv[4]));
+    }
+
+    swCloud::SWCloud l_oTarget, l_oTemplate;
+    if(!l_oTarget.loadObj(argv[1]) || !l_oTemplate.loadObj(argv[2]))
+    {
+        std::cerr << "Error : cannot load the clouds. " << std::endl;
+        return -1;
+    }
+
+    std::cout << "Target   : " << l_oTarget.size() << " points. " << std::endl;
+    std::cout << "Template : " << l_oTemplate.size() << " points. " << std::endl;
+
+    float l_aFCudaR[9], l_aFCudaT[3], l_aFCpuR[9], l_aFCpuT[3];
+
+    float l_fCudaTime = align(l_oTarget, l_oTemplate, swCloud::EMICP_CUDA_DEVICE, l_i32RunsNb, l_aFCudaR, l_aFCudaT);
+    float l_fCpuTime  = align(l_oTarget, l_oTemplate, swCloud::EMICP_CPU_DEVICE,  l_i32RunsNb, l_aFCpuR,  l_aFCpuT);
+
+    float l_fMaxDiffR = 0.f, l_fMaxDiffT = 0.f;
+    for(int ii = 0; ii < 9; ++ii)
+    {
+        l_fMaxDiffR = std::max(l_fMaxDiffR, std::fabs(l_aFCudaR[ii] - l_aFCpuR[ii]));
+
+        if(ii < 3)
+        {
+            l_fMaxDiffT = std::max(l_fMaxDiffT, std::fabs(l_aFCudaT[ii] - l_aFCpuT[ii]));
+        }
+    }
+
+    std::cout << "CUDA emicp : " << l_fCudaTime * 1000.f << " ms (" << 1.f / l_fCudaTime << " Hz)" << std::endl;
+    std::cout << "CPU emicp  : " << l_fCpuTime  * 1000.f << " ms (" << 1.f / l_fCpuTime  << " Hz)" << std::endl;
+    std::cout << "Max rotation difference    : " << l_fMaxDiffR << std::endl;
+    std::cout << "Max translation difference : " << l_fMaxDiffT << std::endl;
+
+    if(l_fMaxDiffR > l_fTolerance || l_fMaxDiffT > l_fTolerance)
+    {
+        std::cerr << "Error : the CPU and CUDA rigid motions differ more than the tolerance (" << l_fTolerance << "). " << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
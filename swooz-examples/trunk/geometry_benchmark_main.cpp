@@ -0,0 +1,224 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file geometry_benchmark_main.cpp
+ * \author Florian Lance
+ * \date 16/10/26
+ * \brief Compare the per-vertex normals update done with the std::vector geometry functions and with swUtil::Vec3f,
+ *        and the incremental normals update of SWMesh with the full one.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <time.h>
+#include <algorithm>
+
+#include "mesh/SWMesh.h"
+#include "geometryUtility.h"
+
+/**
+ * \brief Normals update of SWMesh before the Vec3 types (one std::vector allocation per point and per operation).
+ * \param [in] oMesh            : mesh
+ * \param [in] vFaces           : id of the vertices of each triangle (starting from 1 like in SWMesh::set)
+ * \param [out] vVerticesNormals: non oriented vertices normals
+ */
+static void legacyNormals(const swMesh::SWMesh &oMesh, const std::vector<std::vector<uint> > &vFaces, std::vector<std::vector<float> > &vVerticesNormals)
+{
+    std::vector<std::vector<float> > l_vTrianglesNormals;
+
+    for(uint ii = 0; ii < oMesh.trianglesNumber(); ++ii)
+    {
+        std::vector<float> l_vP1, l_vP2, l_vP3;
+        oMesh.trianglePoints(l_vP1, l_vP2, l_vP3, ii);
+
+        std::vector<float> l_vNormal = swUtil::crossProduct(swUtil::vec(l_vP1, l_vP2), swUtil::vec(l_vP3, l_vP1));
+        swUtil::normalize(l_vNormal);
+        l_vTrianglesNormals.push_back(l_vNormal);
+    }
+
+    vVerticesNormals = std::vector<std::vector<float> >(oMesh.pointsNumber(), std::vector<float>(3,0.f));
+
+    for(uint ii = 0; ii < oMesh.trianglesNumber(); ++ii)
+    {
+        for(uint jj = 0; jj < 3; ++jj)
+        {
+            std::vector<float> l_v3FCurrNormal = l_vTrianglesNormals[ii];
+
+            if(jj >= 1)
+            {
+                if(swUtil::dotProduct(l_v3FCurrNormal, vVerticesNormals[vFaces[ii][jj]-1]) < 0)
+                {
+                    swUtil::inverse(l_v3FCurrNormal);
+                }
+            }
+            swUtil::add(vVerticesNormals[vFaces[ii][jj]-1], l_v3FCurrNormal);
+        }
+    }
+
+    for(uint ii = 0; ii < vVerticesNormals.size(); ++ii)
+    {
+        swUtil::normalize(vVerticesNormals[ii]);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int l_i32GridSize = 300, l_i32LoopsNb = 10;
+    if(argc > 1)
+    {
+        l_i32GridSize = atoi(argv[1]);
+    }
+    if(argc > 2)
+    {
+        l_i32LoopsNb = atoi(argv[2]);
+    }
+
+    if(l_i32GridSize < 2 || l_i32LoopsNb < 1)
+    {
+        std::cerr << "Usage : geometry_benchmark [grid size] [loops number] " << std::endl;
+        return -1;
+    }
+
+    // build a wavy grid mesh
+        std::vector<std::vector<float> > l_vPoints, l_vTextures;
+        std::vector<std::vector<uint> > l_vFaces;
+
+        for(int ii = 0; ii < l_i32GridSize; ++ii)
+        {
+            for(int jj = 0; jj < l_i32GridSize; ++jj)
+            {
+                std::vector<float> l_vPt(3);
+                l_vPt[0] = 0.01f * jj;
+                l_vPt[1] = 0.01f * ii;
+                l_vPt[2] = 0.05f * sin(0.1f * jj) * cos(0.1f * ii);
+                l_vPoints.push_back(l_vPt);
+            }
+        }
+
+        for(int ii = 0; ii < l_i32GridSize - 1; ++ii)
+        {
+            for(int jj = 0; jj < l_i32GridSize - 1; ++jj)
+            {
+                uint l_ui32Id = ii * l_i32GridSize + jj + 1;
+
+                std::vector<uint> l_vTri(3);
+                l_vTri[0] = l_ui32Id; l_vTri[1] = l_ui32Id + 1; l_vTri[2] = l_ui32Id + l_i32GridSize;
+                l_vFaces.push_back(l_vTri);
+                l_vTri[0] = l_ui32Id + 1; l_vTri[1] = l_ui32Id + l_i32GridSize + 1; l_vTri[2] = l_ui32Id + l_i32GridSize;
+                l_vFaces.push_back(l_vTri);
+            }
+        }
+
+        swMesh::SWMesh l_oMesh;
+        l_oMesh.set(l_vPoints, l_vFaces, l_vTextures);
+
+    std::cout << "Mesh : " << l_oMesh.pointsNumber() << " vertices, " << l_oMesh.trianglesNumber() << " triangles. " << std::endl;
+
+    // std::vector functions
+        std::vector<std::vector<float> > l_vLegacyNormals;
+
+        clock_t l_oTime = clock();
+        for(int ii = 0; ii < l_i32LoopsNb; ++ii)
+        {
+            legacyNormals(l_oMesh, l_vFaces, l_vLegacyNormals);
+        }
+        float l_fLegacyTime = static_cast<float>(clock() - l_oTime) / CLOCKS_PER_SEC / l_i32LoopsNb;
+
+    // Vec3 functions
+        l_oTime = clock();
+        for(int ii = 0; ii < l_i32LoopsNb; ++ii)
+        {
+            l_oMesh.updateNonOrientedTrianglesNormals();
+            l_oMesh.updateNonOrientedVerticesNormals();
+        }
+        float l_fVec3Time = static_cast<float>(clock() - l_oTime) / CLOCKS_PER_SEC / l_i32LoopsNb;
+
+    // compare the normals
+        float l_fMaxDiff = 0.f;
+        for(uint ii = 0; ii < l_oMesh.pointsNumber(); ++ii)
+        {
+            float l_a3FNormal[3];
+            l_oMesh.vertexNormal(l_a3FNormal, ii);
+
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                float l_fDiff = fabs(l_a3FNormal[jj] - l_vLegacyNormals[ii][jj]);
+                if(l_fDiff > l_fMaxDiff)
+                {
+                    l_fMaxDiff = l_fDiff;
+                }
+            }
+        }
+
+    std::cout << "std::vector normals update : " << l_fLegacyTime * 1000.f << " ms" << std::endl;
+    std::cout << "Vec3 normals update        : " << l_fVec3Time * 1000.f << " ms" << std::endl;
+    std::cout << "Max normal component difference : " << l_fMaxDiff << std::endl;
+
+    // incremental update after moving a small patch of the grid
+        l_oMesh.updateNormals();
+
+        int l_i32PatchSize = std::max(1, l_i32GridSize / 10);
+        float *l_aFZ = l_oMesh.cloud()->coord(2);
+        for(int ii = 0; ii < l_i32PatchSize; ++ii)
+        {
+            for(int jj = 0; jj < l_i32PatchSize; ++jj)
+            {
+                l_aFZ[ii * l_i32GridSize + jj] += 0.02f * sin(0.3f * (ii + jj));
+            }
+        }
+        l_oMesh.cloud()->invalidateSpatialIndex();
+
+        swMesh::SWMesh l_oFullMesh = l_oMesh;
+
+        l_oTime = clock();
+        l_oMesh.updateNormals(true);
+        float l_fIncrementalTime = static_cast<float>(clock() - l_oTime) / CLOCKS_PER_SEC;
+
+        l_oTime = clock();
+        l_oFullMesh.updateNormals();
+        float l_fFullTime = static_cast<float>(clock() - l_oTime) / CLOCKS_PER_SEC;
+
+        l_fMaxDiff = 0.f;
+        for(uint ii = 0; ii < l_oMesh.pointsNumber(); ++ii)
+        {
+            float l_a3FNormal[3], l_a3FFullNormal[3];
+            l_oMesh.vertexNormal(l_a3FNormal, ii);
+            l_oFullMesh.vertexNormal(l_a3FFullNormal, ii);
+
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                l_fMaxDiff = std::max(l_fMaxDiff, static_cast<float>(fabs(l_a3FNormal[jj] - l_a3FFullNormal[jj])));
+            }
+        }
+
+    std::cout << "Moved vertices : " << l_i32PatchSize * l_i32PatchSize << std::endl;
+    std::cout << "Full normals update        : " << l_fFullTime * 1000.f << " ms" << std::endl;
+    std::cout << "Incremental normals update : " << l_fIncrementalTime * 1000.f << " ms" << std::endl;
+    std::cout << "Max normal component difference : " << l_fMaxDiff << std::endl;
+
+    return 0;
+}
@@ -34,7 +34,7 @@
 #include <iostream>
 #include <time.h>
 #include "devices/rgbd/SWKinect_thread.h"
-#include "devices/rgbd/SWSaveKinectData.h"
+#include "devices/rgbd/SWSaveKinectData_thread.h"
 
 #include "boost/filesystem.hpp"
 
@@ -58,6 +58,7 @@ int main()
     }
 
     // start listening the kinect device
+    kinectDeviceT.setChannels(swDevice::KINECT_BGR_IMAGE | swDevice::KINECT_CLOUD_MAP);
     kinectDeviceT.startListening();
     while(!kinectDeviceT.isDataAvailable())
     {
@@ -72,11 +73,18 @@ int main()
     double maxSize   = 20.0; // maximum size in Go
     double fps       = 30.0; // fps
 
-    swDevice::SWSaveKinectData dataSaver(path, maxLength, maxSize);
+    // the frames are copied by the kinect thread and written by the writer thread of the saver
+    swDevice::SWSaveKinectData_thread dataSaver(path, maxLength, maxSize);
 
     bool saveVideoData = true;
     bool saveCloudData = true;
-    dataSaver.start(saveVideoData, saveCloudData);
+    if(!dataSaver.start(saveVideoData, saveCloudData))
+    {
+        std::cerr << "Error starting the saving. " << std::endl;
+        return -1;
+    }
+
+    kinectDeviceT.setRecorder(&dataSaver);
 
     char key = ' ';
 
@@ -90,8 +98,8 @@ int main()
         // display the kinect cloud map in the opencv window
         cv::imshow("cloud_map_kinect",kinectDeviceT.cloudMap());
 
-        // save current kinect frame
-        if(!dataSaver.save(kinectDeviceT.bgrImage(), kinectDeviceT.cloudMap()))
+        // check the saving
+        if(!dataSaver.isRecording())
         {
             break;
         }
@@ -110,11 +118,13 @@ int main()
         }
     }
 
-    // stop listening kinect data
+    // stop feeding the saver and listening kinect data
+    kinectDeviceT.setRecorder(NULL);
     kinectDeviceT.stopListening();
 
-    // stop the saving and create the data files
+    // write the remaining frames, stop the saving and close the data files
     dataSaver.stop();
+    dataSaver.displayCounters();
 
     // destroy windows
     cvDestroyWindow("rgb_kinect");
@@ -0,0 +1,147 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file kinect_simulator_benchmark_main.cpp
+ * \author Florian Lance
+ * \date 16/10/26
+ * \brief Headless benchmark of SWKinect_thread fed by a SWKinectSimulator : throughput, grab to consumption latency,
+ *        dropped frames and a checksum of the consumed frames (identical between two lock-step runs).
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+#include "devices/rgbd/SWKinect_thread.h"
+#include "devices/rgbd/SWKinectSimulator.h"
+#include "SWProfiler.h"
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage : kinect_simulator_benchmark <frames number> [realtime|fastest|lockstep] [head|mesh.obj|recording directory] [consumer work ms] " << std::endl;
+        return -1;
+    }
+
+    int l_i32FramesNb   = std::max(1, atoi(argv[1]));
+    std::string l_sRate = argc > 2 ? argv[2] : "lockstep";
+    std::string l_sSource = argc > 3 ? argv[3] : "head";
+    int l_i32WorkMs     = argc > 4 ? std::max(0, atoi(argv[4])) : 0;
+
+    // simulated device
+        boost::shared_ptr<swDevice::SWKinectSimulator> l_pSimulator(new swDevice::SWKinectSimulator(false));
+
+        if(l_sSource != "head")
+        {
+            bool l_bLoaded = (l_sSource.size() > 4 && l_sSource.substr(l_sSource.size() - 4) == ".obj") ?
+                        l_pSimulator->setMesh(l_sSource) : l_pSimulator->setRecording(l_sSource);
+
+            if(!l_bLoaded)
+            {
+                return -1;
+            }
+        }
+
+        swDevice::SWSimulationRate l_eRate = swDevice::SIMULATION_LOCK_STEP;
+        if(l_sRate == "realtime")
+        {
+            l_eRate = swDevice::SIMULATION_REAL_TIME;
+        }
+        else if(l_sRate == "fastest")
+        {
+            l_eRate = swDevice::SIMULATION_AS_FAST_AS_POSSIBLE;
+        }
+
+        l_pSimulator->setRate(l_eRate);
+        l_pSimulator->setFramesNumber(l_i32FramesNb);
+
+    // threaded module, used as by the trackers
+        swDevice::SWKinect_thread l_oKinectThread(l_pSimulator, l_eRate == swDevice::SIMULATION_LOCK_STEP);
+
+        if(l_oKinectThread.init(0) == -1)
+        {
+            return -1;
+        }
+
+        l_oKinectThread.setChannels(swDevice::KINECT_BGR_IMAGE | swDevice::KINECT_CLOUD_MAP);
+        l_oKinectThread.startListening();
+
+    // consume the frames
+        std::vector<double> l_vLatencies;
+        uint l_ui32LastId = 0, l_ui32ConsumedNb = 0, l_ui32SkippedNb = 0;
+        double l_dChecksum = 0.;
+        int64 l_i64Start = swUtil::SWProfiler::timeUs();
+
+        while(true)
+        {
+            swDevice::SWKinectFramePtr l_pFrame = l_oKinectThread.waitFrame(l_ui32LastId, 500);
+
+            if(!l_pFrame)
+            {
+                if(l_pSimulator->isEnded())
+                {
+                    break;
+                }
+                continue;
+            }
+
+            l_vLatencies.push_back((swUtil::SWProfiler::timeUs() - l_pFrame->m_i64GrabTime) * 0.001);
+            l_ui32SkippedNb += l_pFrame->m_ui32Id - l_ui32LastId - 1;
+            l_ui32LastId = l_pFrame->m_ui32Id;
+            ++l_ui32ConsumedNb;
+
+            cv::Scalar l_oBgrSum = cv::sum(l_pFrame->m_oBgrImage), l_oCloudSum = cv::sum(l_pFrame->m_oCloudMap);
+            l_dChecksum += l_oBgrSum[0] + l_oBgrSum[1] + l_oBgrSum[2] + l_oCloudSum[2];
+
+            if(l_i32WorkMs > 0)
+            {
+                boost::this_thread::sleep(boost::posix_time::milliseconds(l_i32WorkMs));
+            }
+        }
+
+        double l_dDuration = (swUtil::SWProfiler::timeUs() - l_i64Start) * 1e-6;
+
+        l_oKinectThread.stopListening();
+
+    if(l_vLatencies.empty())
+    {
+        std::cerr << "No frame consumed. " << std::endl;
+        return -1;
+    }
+
+    std::sort(l_vLatencies.begin(), l_vLatencies.end());
+
+    std::cout << "Rate : " << l_sRate << ", source : " << l_sSource << ", consumer work : " << l_i32WorkMs << " ms" << std::endl;
+    std::cout << "Frames consumed : " << l_ui32ConsumedNb << " / " << l_pSimulator->frameId() << ", skipped : " << l_ui32SkippedNb << std::endl;
+    std::cout << "Throughput : " << l_ui32ConsumedNb / l_dDuration << " fps" << std::endl;
+    std::cout << "Grab to consumption latency : p50 " << l_vLatencies[(l_vLatencies.size() - 1) / 2]
+              << " ms, p99 " << l_vLatencies[((l_vLatencies.size() - 1) * 99) / 100] << " ms, max " << l_vLatencies.back() << " ms" << std::endl;
+    std::cout.precision(15);
+    std::cout << "Checksum : " << l_dChecksum << std::endl;
+
+    return 0;
+}
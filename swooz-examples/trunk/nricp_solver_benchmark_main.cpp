@@ -0,0 +1,130 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file nricp_solver_benchmark_main.cpp
+ * \author Florian Lance
+ * \date 16/10/26
+ * \brief Compare the dense CUDA solver and the sparse CPU solver of the NRICP morphing on the same meshes.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <time.h>
+
+#include "mesh/SWOptimalStepNonRigidICP.h"
+#include "geometryUtility.h"
+
+/**
+ * \brief Run a morphing with the input solver and display the time of each step.
+ * \param [in] oTemplate    : template mesh
+ * \param [in] oTarget      : target mesh
+ * \param [in] eSolver      : solver to use
+ * \param [in] i32StepsNb   : number of alpha steps
+ * \param [out] oResult     : morphed template
+ * \return the total time of the resolutions in seconds
+ */
+static float morph(const swMesh::SWMesh &oTemplate, const swMesh::SWMesh &oTarget, const swMesh::SWNRICPSolver eSolver, cint i32StepsNb, swMesh::SWMesh &oResult)
+{
+    swMesh::SWOptimalStepNonRigidICP l_oNRICP(oTemplate, oTarget);
+    l_oNRICP.setSolver(eSolver);
+
+    float l_fAlpha = 50.f, l_fBeta = 1.f, l_fGama = 1.f, l_fTotalTime = 0.f;
+
+    for(int ii = 0; ii < i32StepsNb; ++ii, l_fAlpha *= 0.5f)
+    {
+        l_oNRICP.computeCorrespondences();
+        l_oNRICP.computeDistanceWeights();
+
+        clock_t l_oTime = clock();
+        float l_fDiff = l_oNRICP.resolve(l_fAlpha, l_fBeta, l_fGama, false);
+        float l_fTime = static_cast<float>(clock() - l_oTime) / CLOCKS_PER_SEC;
+        l_fTotalTime += l_fTime;
+
+        if(l_fDiff < 0.f)
+        {
+            std::cerr << "  alpha " << l_fAlpha << " -> resolution failed, morphing stopped. " << std::endl;
+            break;
+        }
+
+        std::cout << "  alpha " << l_fAlpha << " -> diff " << l_fDiff << " time " << l_fTime << " s" << std::endl;
+
+        l_oNRICP.updateSourceMeshNormals();
+    }
+
+    oResult = l_oNRICP.m_oSourceMesh;
+
+    return l_fTotalTime;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 3)
+    {
+        std::cerr << "Usage : nricp_solver_benchmark template.obj target.obj [alpha steps number] " << std::endl;
+        return -1;
+    }
+
+    int l_i32StepsNb = 5;
+    if(argc > 3)
+    {
+        l_i32StepsNb = atoi(argv[3]);
+    }
+
+    swMesh::SWMesh l_oTemplate(argv[1]);
+    swMesh::SWMesh l_oTarget(argv[2]);
+
+    std::cout << "Template : " << l_oTemplate.pointsNumber() << " vertices, " << l_oTemplate.edgesNumber() << " edges. " << std::endl;
+    std::cout << "Target   : " << l_oTarget.pointsNumber() << " vertices. " << std::endl;
+
+    swMesh::SWMesh l_oDenseResult, l_oSparseResult;
+
+    std::cout << "Dense CUDA solver : " << std::endl;
+    float l_fDenseTime = morph(l_oTemplate, l_oTarget, swMesh::NRICP_DENSE_CUDA_SOLVER, l_i32StepsNb, l_oDenseResult);
+
+    std::cout << "Sparse CPU solver : " << std::endl;
+    float l_fSparseTime = morph(l_oTemplate, l_oTarget, swMesh::NRICP_SPARSE_CPU_SOLVER, l_i32StepsNb, l_oSparseResult);
+
+    // compare the morphed vertices
+        float l_fMaxDist = 0.f;
+        for(uint ii = 0; ii < l_oDenseResult.pointsNumber(); ++ii)
+        {
+            std::vector<float> l_vDensePt, l_vSparsePt;
+            l_oDenseResult.point(l_vDensePt, ii);
+            l_oSparseResult.point(l_vSparsePt, ii);
+
+            float l_fDist = swUtil::norm(swUtil::vec(l_vDensePt, l_vSparsePt));
+            if(l_fDist > l_fMaxDist)
+            {
+                l_fMaxDist = l_fDist;
+            }
+        }
+
+    std::cout << "Dense total time  : " << l_fDenseTime << " s" << std::endl;
+    std::cout << "Sparse total time : " << l_fSparseTime << " s" << std::endl;
+    std::cout << "Max vertex distance between the two results : " << l_fMaxDist << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file stasm_benchmark_main.cpp
+ * \author Florian Lance
+ * \date 16/10/26
+ * \brief Compare the per-pixel conversion of a face crop to a stasm gray image with SWStasm::convMatToStasmGrayImage,
+ *        and measure SWStasm::launchAsmSearch end-to-end on recorded face crops.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+#include "detect/SWStasm.h"
+#include "SWProfiler.h"
+
+/**
+ * \brief Conversion used by SWStasm before convMatToStasmGrayImage (rgb stasm image filled pixel by pixel, then converted to gray).
+ * \param [in]  oBgrMat         : input bgr mat
+ * \param [out] oStasmGrayImage : gray stasm image
+ */
+static void legacyConversion(const cv::Mat &oBgrMat, Image &oStasmGrayImage)
+{
+    RgbImage l_oStasmImage(oBgrMat.cols, oBgrMat.rows);
+
+    for(int ii = 0; ii < oBgrMat.rows ; ++ii)
+    {
+        for(int jj = 0; jj < oBgrMat.cols; ++jj)
+        {
+            RGB_TRIPLE l_oRgb;
+            l_oRgb.Red  = oBgrMat.at<cv::Vec<uchar, 3> >(ii,jj)[2];
+            l_oRgb.Green= oBgrMat.at<cv::Vec<uchar, 3> >(ii,jj)[1];
+            l_oRgb.Blue = oBgrMat.at<cv::Vec<uchar, 3> >(ii,jj)[0];
+
+            l_oStasmImage(jj,oBgrMat.rows-1 - ii) = l_oRgb;
+        }
+    }
+
+    ConvertRgbImageToGray(oStasmGrayImage, l_oStasmImage);
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 3)
+    {
+        std::cerr << "Usage : stasm_benchmark <loops number> <face crop image 1> [face crop image 2] ... " << std::endl;
+        std::cerr << "        the face is expected to fill the center of each image (the images are processed in order as a sequence). " << std::endl;
+        return -1;
+    }
+
+    int l_i32LoopsNb = std::max(1, atoi(argv[1]));
+
+    // load the face crops
+        std::vector<cv::Mat> l_vFaceCrops;
+        for(int ii = 2; ii < argc; ++ii)
+        {
+            cv::Mat l_oImage = cv::imread(argv[ii], 1);
+
+            if(l_oImage.empty() || l_oImage.cols < 80 || l_oImage.rows < 80)
+            {
+                std::cerr << "Image ignored (can't be read or too small) : " << argv[ii] << std::endl;
+                continue;
+            }
+
+            l_vFaceCrops.push_back(l_oImage);
+        }
+
+        if(l_vFaceCrops.size() == 0)
+        {
+            std::cerr << "No face crop loaded. " << std::endl;
+            return -1;
+        }
+
+    std::cout << "Face crops : " << l_vFaceCrops.size() << ", loops : " << l_i32LoopsNb << std::endl;
+
+    // conversion to the stasm gray image
+        Image l_oLegacyGray, l_oFusedGray;
+        int64 l_i64LegacyTime = 0, l_i64FusedTime = 0;
+        int l_i32DifferentImages = 0;
+
+        for(int ii = 0; ii < l_i32LoopsNb; ++ii)
+        {
+            for(uint jj = 0; jj < l_vFaceCrops.size(); ++jj)
+            {
+                int64 l_i64Start = swUtil::SWProfiler::timeUs();
+                legacyConversion(l_vFaceCrops[jj], l_oLegacyGray);
+                int64 l_i64Middle = swUtil::SWProfiler::timeUs();
+                swDetect::SWStasm::convMatToStasmGrayImage(l_vFaceCrops[jj], l_oFusedGray);
+                int64 l_i64End = swUtil::SWProfiler::timeUs();
+
+                l_i64LegacyTime += l_i64Middle - l_i64Start;
+                l_i64FusedTime  += l_i64End - l_i64Middle;
+
+                if(ii == 0 && l_oLegacyGray != l_oFusedGray)
+                {
+                    ++l_i32DifferentImages;
+                }
+            }
+        }
+
+        double l_dConversionsNb = static_cast<double>(l_i32LoopsNb * l_vFaceCrops.size());
+
+    std::cout << "Per-pixel conversion : " << l_i64LegacyTime * 0.001 / l_dConversionsNb << " ms" << std::endl;
+    std::cout << "Fused conversion     : " << l_i64FusedTime  * 0.001 / l_dConversionsNb << " ms" << std::endl;
+    std::cout << "Different gray images : " << l_i32DifferentImages << std::endl;
+
+    // end-to-end search
+        swDetect::SWStasm l_oStasm;
+        std::vector<double> l_vSearchTimes;
+        int l_i32FailedSearches = 0;
+
+        for(int ii = 0; ii < l_i32LoopsNb; ++ii)
+        {
+            l_oStasm.resetParams();
+
+            for(uint jj = 0; jj < l_vFaceCrops.size(); ++jj)
+            {
+                const cv::Mat &l_oCrop = l_vFaceCrops[jj];
+
+                // the rectangle augmented by launchAsmSearch must stay in the image
+                cv::Rect l_oFaceRect(l_oCrop.cols/10, l_oCrop.rows/10, (l_oCrop.cols*3)/4, (l_oCrop.rows*3)/4);
+
+                int64 l_i64Start = swUtil::SWProfiler::timeUs();
+                try
+                {
+                    if(!l_oStasm.launchAsmSearch(l_oCrop, l_oFaceRect))
+                    {
+                        ++l_i32FailedSearches;
+                    }
+                }
+                catch(const std::exception &e)
+                {
+                    std::cerr << e.what() << std::endl;
+                    ++l_i32FailedSearches;
+                }
+
+                l_vSearchTimes.push_back((swUtil::SWProfiler::timeUs() - l_i64Start) * 0.001);
+            }
+        }
+
+        std::sort(l_vSearchTimes.begin(), l_vSearchTimes.end());
+        double l_dMean = 0.;
+        for(uint ii = 0; ii < l_vSearchTimes.size(); ++ii)
+        {
+            l_dMean += l_vSearchTimes[ii];
+        }
+        l_dMean /= l_vSearchTimes.size();
+
+    std::cout << "launchAsmSearch : mean " << l_dMean << " ms, p50 " << l_vSearchTimes[(l_vSearchTimes.size() - 1) / 2]
+              << " ms, max " << l_vSearchTimes.back() << " ms, failed searches : " << l_i32FailedSearches << std::endl;
+
+    return 0;
+}
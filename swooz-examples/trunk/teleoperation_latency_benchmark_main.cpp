@@ -0,0 +1,521 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file teleoperation_latency_benchmark_main.cpp
+ * \author Florian Lance
+ * \date 16/10/26
+ * \brief Replay of recorded tracking data files (SWFakeTracking format) through the tracking -> manipulation -> teleoperation chain,
+ *        reports the latency of each hop and the sensor to command latency (p50/p99) of each device lib path.
+ *
+ *  Each file is sent at its recorded times as the tracking module of its device does (typed message when the device has one for the stream,
+ *  the replay time of a sample being its capture time), optionally relayed as swooz-manipulation does, read with read(false) at the period
+ *  of the teleoperation modules and commanded by a rate thread at the period of the velocity controllers.
+ *  The ports are local to the process, unless -network is used (a yarp server is then needed and the latencies are published).
+ *  The replay time is sent as the capture time without processing before the sending : the wait of the device frames and the tracking
+ *  computation, counted in the capture_to_send hop of the real modules, are not part of the replayed latencies.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <yarp/os/Network.h>
+#include <yarp/os/RateThread.h>
+
+#include "SWTrackingLatency.h"
+
+/**
+ * \brief Streams of the replayed files.
+ */
+enum ReplayStream
+{
+    HEAD_STREAM, GAZE_STREAM, FACE_STREAM, HAND_STREAM
+};
+
+/**
+ * \brief A replayed file and its ports along the chain.
+ */
+struct SWReplayPath
+{
+    std::string m_sPath;                                    /**< latency path */
+    ReplayStream m_eStream;                                 /**< stream of the file */
+    int m_i32DeviceId;                                      /**< DeviceLib of the file */
+    std::vector<double> m_vTimes;                           /**< recorded times of the samples (s) */
+    std::vector<std::vector<double> > m_vVData;             /**< recorded values of the samples */
+
+    yarp::os::BufferedPort<yarp::os::Bottle> m_oTrackingPort;       /**< tracking module output */
+    yarp::os::BufferedPort<yarp::os::Bottle> m_oRelayInPort;        /**< manipulation input */
+    yarp::os::BufferedPort<yarp::os::Bottle> m_oRelayOutPort;       /**< manipulation output */
+    yarp::os::BufferedPort<yarp::os::Bottle> m_oTeleoperationPort;  /**< teleoperation module input */
+
+    std::vector<char> m_vRelayMessage;                      /**< message forwarded by the relay */
+    swTracking::SWCommandLatency m_oWaitingLatency;         /**< received sample waiting for the controller */
+};
+
+typedef boost::shared_ptr<SWReplayPath> SWReplayPathPtr;
+
+/**
+ * \brief Load a tracking data file : "device lib robot_part DEVICE_LIB" on the first line, then one sample per line "time(s) values...".
+ */
+bool loadReplayPath(const std::string &sFilePath, SWReplayPath &oPath)
+{
+    std::ifstream l_oFileStream(sFilePath.c_str());
+
+    if(!l_oFileStream.is_open())
+    {
+        std::cerr << "Can't open " << sFilePath << " file. " << std::endl;
+        return false;
+    }
+
+    std::string l_sDevice, l_sLib, l_sRobotPart, l_sLIB_DEVICE, l_sLine;
+    l_oFileStream >> l_sDevice >> l_sLib >> l_sRobotPart >> l_sLIB_DEVICE;
+    getline(l_oFileStream, l_sLine);
+
+    oPath.m_i32DeviceId = -1;
+    for(int ii = swTracking::RankFirst; ii <= swTracking::RankLast; ++ii)
+    {
+        if(swTracking::returnStringValue(ii) == l_sLIB_DEVICE)
+        {
+            oPath.m_i32DeviceId = ii;
+            break;
+        }
+    }
+
+    if(oPath.m_i32DeviceId == -1)
+    {
+        std::cerr << "Unknown device lib " << l_sLIB_DEVICE << " in " << sFilePath << std::endl;
+        return false;
+    }
+
+    std::string l_sStream = "head";
+    oPath.m_eStream = HEAD_STREAM;
+    if(l_sRobotPart.find("gaze") != std::string::npos)
+    {
+        l_sStream = "gaze";
+        oPath.m_eStream = GAZE_STREAM;
+    }
+    else if(l_sRobotPart.find("face") != std::string::npos)
+    {
+        l_sStream = "face";
+        oPath.m_eStream = FACE_STREAM;
+    }
+    else if(l_sRobotPart.find("arm") != std::string::npos || l_sRobotPart.find("hand") != std::string::npos)
+    {
+        l_sStream = "hand";
+        oPath.m_eStream = HAND_STREAM;
+    }
+    oPath.m_sPath = swTracking::latencyPath(l_sStream, oPath.m_i32DeviceId);
+
+    while(getline(l_oFileStream, l_sLine))
+    {
+        std::istringstream l_oLineStream(l_sLine);
+        double l_dTime, l_dValue;
+
+        if(!(l_oLineStream >> l_dTime))
+        {
+            continue;
+        }
+
+        oPath.m_vTimes.push_back(l_dTime);
+        oPath.m_vVData.push_back(std::vector<double>());
+
+        while(l_oLineStream >> l_dValue)
+        {
+            oPath.m_vVData.back().push_back(l_dValue);
+        }
+    }
+
+    if(oPath.m_vTimes.empty())
+    {
+        std::cerr << "No sample in " << sFilePath << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Send a sample as the tracking module : a typed message, or the bottle of values if the device has no message of this type.
+ */
+template<typename T>
+void sendSample(SWReplayPath &oPath, cuint ui32Sample, cint64 i64CaptureTime)
+{
+    yarp::os::Bottle l_oValues;
+    l_oValues.addInt(oPath.m_i32DeviceId);
+    for(uint ii = 0; ii < oPath.m_vVData[ui32Sample].size(); ++ii)
+    {
+        l_oValues.addDouble(oPath.m_vVData[ui32Sample][ii]);
+    }
+
+    yarp::os::Bottle &l_oBottle = oPath.m_oTrackingPort.prepare();
+    T l_oMessage;
+
+    if(swTracking::readMessage(l_oValues, l_oMessage))
+    {
+        l_oMessage.m_oHeader.m_ui32Sequence  = ui32Sample;
+        l_oMessage.m_oHeader.m_i64SourceTime = i64CaptureTime;
+        swTracking::writeMessage(l_oBottle, l_oMessage);
+    }
+    else
+    {
+        l_oBottle = l_oValues;
+    }
+
+    oPath.m_oTrackingPort.write();
+}
+
+/**
+ * \brief Read the last sample received by the teleoperation module and record its hops.
+ * \return false if no sample has been received
+ */
+template<typename T>
+bool receiveSample(SWReplayPath &oPath, swTracking::SWLatencyMonitor &oMonitor, swTracking::SWCommandLatency &oLatency)
+{
+    yarp::os::Bottle *l_pBottle = oPath.m_oTeleoperationPort.read(false);
+
+    if(!l_pBottle)
+    {
+        return false;
+    }
+
+    int64 l_i64ReceiveTime = swTracking::messageTimeUs();
+    T l_oMessage;
+    swTracking::readMessageDevice(*l_pBottle, l_oMessage);
+
+    oMonitor.recordMessage(oPath.m_sPath, l_oMessage.m_oHeader, l_i64ReceiveTime);
+    oLatency.received(oPath.m_sPath, l_oMessage.m_oHeader, l_i64ReceiveTime);
+
+    return true;
+}
+
+/**
+ * \brief Tracking module : send the samples of a file at their recorded times.
+ */
+void replay(SWReplayPath *pPath, cint64 i64StartTime)
+{
+    for(uint ii = 0; ii < pPath->m_vTimes.size(); ++ii)
+    {
+        int64 l_i64CaptureTime = i64StartTime + static_cast<int64>((pPath->m_vTimes[ii] - pPath->m_vTimes[0]) * 1000000.);
+        int64 l_i64Wait = l_i64CaptureTime - swTracking::messageTimeUs();
+
+        if(l_i64Wait > 0)
+        {
+            boost::this_thread::sleep(boost::posix_time::microseconds(l_i64Wait));
+        }
+
+        switch(pPath->m_eStream)
+        {
+            case HEAD_STREAM : sendSample<swTracking::SWHeadPoseMessage>(*pPath, ii, l_i64CaptureTime);         break;
+            case GAZE_STREAM : sendSample<swTracking::SWGazeMessage>(*pPath, ii, l_i64CaptureTime);             break;
+            case FACE_STREAM : sendSample<swTracking::SWFaceLandmarksMessage>(*pPath, ii, l_i64CaptureTime);    break;
+            case HAND_STREAM : sendSample<swTracking::SWHandSkeletonMessage>(*pPath, ii, l_i64CaptureTime);     break;
+        }
+    }
+}
+
+/**
+ * \brief Manipulation module : forward the received bottles of each path every period, as SWManipulationWorker.
+ */
+void relay(std::vector<SWReplayPathPtr> *pPaths, cint i32PeriodMs, volatile bool *pStop)
+{
+    while(!*pStop)
+    {
+        for(uint ii = 0; ii < pPaths->size(); ++ii)
+        {
+            SWReplayPath &l_oPath = *(*pPaths)[ii];
+            yarp::os::Bottle *l_pBottle = l_oPath.m_oRelayInPort.read(false);
+
+            if(!l_pBottle)
+            {
+                continue;
+            }
+
+            yarp::os::Bottle &l_oBottle = l_oPath.m_oRelayOutPort.prepare();
+            swTracking::SWTrackingMessageHeader l_oHeader;
+            const char *l_pMessage = swTracking::messageData(*l_pBottle, l_oHeader);
+
+            if(l_pMessage)
+            {
+                l_oPath.m_vRelayMessage.assign(l_pMessage, l_pMessage + l_oHeader.m_ui32Size);
+                swTracking::relayMessage(l_oBottle, &l_oPath.m_vRelayMessage[0]);
+            }
+            else
+            {
+                l_oBottle = *l_pBottle;
+            }
+
+            l_oPath.m_oRelayOutPort.write();
+        }
+
+        boost::this_thread::sleep(boost::posix_time::milliseconds(i32PeriodMs));
+    }
+}
+
+/**
+ * \brief Velocity controller : the received samples are commanded at each run, as SWHeadVelocityController.
+ */
+class SWReplayController : public yarp::os::RateThread
+{
+    public :
+
+        SWReplayController(std::vector<SWReplayPathPtr> &vPaths, swTracking::SWLatencyMonitor &oMonitor, cint i32PeriodMs)
+            : RateThread(i32PeriodMs), m_vPaths(vPaths), m_oMonitor(oMonitor)
+        {}
+
+        void setWaiting(SWReplayPath &oPath, const swTracking::SWCommandLatency &oLatency)
+        {
+            m_oMutex.lock();
+                oPath.m_oWaitingLatency = oLatency;
+            m_oMutex.unlock();
+        }
+
+        void run()
+        {
+            for(uint ii = 0; ii < m_vPaths.size(); ++ii)
+            {
+                m_oMutex.lock();
+                    swTracking::SWCommandLatency l_oLatency = m_vPaths[ii]->m_oWaitingLatency;
+                    m_vPaths[ii]->m_oWaitingLatency = swTracking::SWCommandLatency();
+                m_oMutex.unlock();
+
+                l_oLatency.commanded(m_oMonitor);
+            }
+        }
+
+    private :
+
+        std::vector<SWReplayPathPtr> &m_vPaths;
+        swTracking::SWLatencyMonitor &m_oMonitor;
+        yarp::os::Mutex m_oMutex;
+};
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage : teleoperation_latency_benchmark <tracking data file> [tracking data files...] [-relay <period ms>] [-module <period ms>] [-controller <period ms>] [-network]" << std::endl;
+        std::cerr << "        -relay      : relay the messages as swooz-manipulation (10 ms by default when used)" << std::endl;
+        std::cerr << "        -module     : period of the teleoperation module reading the ports (10 ms by default)" << std::endl;
+        std::cerr << "        -controller : period of the velocity controller (10 ms by default)" << std::endl;
+        std::cerr << "        -network    : use the yarp server and publish the latencies on /benchmark/teleoperation/latency" << std::endl;
+        return -1;
+    }
+
+    std::vector<std::string> l_vFiles;
+    int l_i32RelayPeriod = 0, l_i32ModulePeriod = 10, l_i32ControllerPeriod = 10;
+    bool l_bNetwork = false;
+
+    for(int ii = 1; ii < argc; ++ii)
+    {
+        std::string l_sArg(argv[ii]);
+        bool l_bValue = ii + 1 < argc && argv[ii+1][0] != '-';
+
+        if(l_sArg == "-relay")
+        {
+            l_i32RelayPeriod = l_bValue ? std::max(1, atoi(argv[++ii])) : 10;
+        }
+        else if(l_sArg == "-module" && l_bValue)
+        {
+            l_i32ModulePeriod = std::max(1, atoi(argv[++ii]));
+        }
+        else if(l_sArg == "-controller" && l_bValue)
+        {
+            l_i32ControllerPeriod = std::max(1, atoi(argv[++ii]));
+        }
+        else if(l_sArg == "-network")
+        {
+            l_bNetwork = true;
+        }
+        else
+        {
+            l_vFiles.push_back(l_sArg);
+        }
+    }
+
+    // yarp ports
+        yarp::os::Network l_oYarp;
+        if(l_bNetwork)
+        {
+            if(!l_oYarp.checkNetwork())
+            {
+                std::cerr << "-ERROR: Problem connecting to YARP server" << std::endl;
+                return -1;
+            }
+        }
+        else
+        {
+            yarp::os::Network::setLocalMode(true);
+        }
+
+    // load the files and connect their ports
+        std::vector<SWReplayPathPtr> l_vPaths;
+
+        for(uint ii = 0; ii < l_vFiles.size(); ++ii)
+        {
+            SWReplayPathPtr l_pPath(new SWReplayPath());
+
+            if(!loadReplayPath(l_vFiles[ii], *l_pPath))
+            {
+                return -1;
+            }
+
+            std::ostringstream l_oId;
+            l_oId << ii;
+            std::string l_sTracking         = "/benchmark/tracking/" + l_oId.str();
+            std::string l_sTeleoperation    = "/benchmark/teleoperation/" + l_oId.str();
+            std::string l_sRelayIn          = "/benchmark/manipulation/in" + l_oId.str();
+            std::string l_sRelayOut         = "/benchmark/manipulation/out" + l_oId.str();
+
+            l_pPath->m_oTrackingPort.open(l_sTracking.c_str());
+            l_pPath->m_oTeleoperationPort.open(l_sTeleoperation.c_str());
+
+            if(l_i32RelayPeriod > 0)
+            {
+                l_pPath->m_oRelayInPort.open(l_sRelayIn.c_str());
+                l_pPath->m_oRelayOutPort.open(l_sRelayOut.c_str());
+                yarp::os::Network::connect(l_sTracking.c_str(), l_sRelayIn.c_str());
+                yarp::os::Network::connect(l_sRelayOut.c_str(), l_sTeleoperation.c_str());
+            }
+            else
+            {
+                yarp::os::Network::connect(l_sTracking.c_str(), l_sTeleoperation.c_str());
+            }
+
+            std::cout << l_vFiles[ii] << " : " << l_pPath->m_sPath << ", " << l_pPath->m_vTimes.size() << " samples" << std::endl;
+            l_vPaths.push_back(l_pPath);
+        }
+
+        swTracking::SWLatencyMonitor l_oMonitor;
+        if(l_bNetwork)
+        {
+            l_oMonitor.open("/benchmark/teleoperation/latency");
+        }
+
+    // start the chain
+        volatile bool l_bStop = false;
+        boost::thread l_oRelayThread;
+        if(l_i32RelayPeriod > 0)
+        {
+            l_oRelayThread = boost::thread(relay, &l_vPaths, l_i32RelayPeriod, &l_bStop);
+        }
+
+        SWReplayController l_oController(l_vPaths, l_oMonitor, l_i32ControllerPeriod);
+        l_oController.start();
+
+        int64 l_i64StartTime = swTracking::messageTimeUs() + 100000;
+        boost::thread_group l_oReplayThreads;
+        for(uint ii = 0; ii < l_vPaths.size(); ++ii)
+        {
+            l_oReplayThreads.create_thread(boost::bind(replay, l_vPaths[ii].get(), l_i64StartTime));
+        }
+
+        double l_dDuration = 0.;
+        for(uint ii = 0; ii < l_vPaths.size(); ++ii)
+        {
+            l_dDuration = std::max(l_dDuration, l_vPaths[ii]->m_vTimes.back() - l_vPaths[ii]->m_vTimes.front());
+        }
+        int64 l_i64EndTime = l_i64StartTime + static_cast<int64>(l_dDuration * 1000000.) + 500000;
+
+    // teleoperation module
+        while(swTracking::messageTimeUs() < l_i64EndTime)
+        {
+            for(uint ii = 0; ii < l_vPaths.size(); ++ii)
+            {
+                SWReplayPath &l_oPath = *l_vPaths[ii];
+                swTracking::SWCommandLatency l_oLatency;
+                bool l_bReceived = false;
+
+                switch(l_oPath.m_eStream)
+                {
+                    case HEAD_STREAM : l_bReceived = receiveSample<swTracking::SWHeadPoseMessage>(l_oPath, l_oMonitor, l_oLatency);       break;
+                    case GAZE_STREAM : l_bReceived = receiveSample<swTracking::SWGazeMessage>(l_oPath, l_oMonitor, l_oLatency);           break;
+                    case FACE_STREAM : l_bReceived = receiveSample<swTracking::SWFaceLandmarksMessage>(l_oPath, l_oMonitor, l_oLatency);  break;
+                    case HAND_STREAM : l_bReceived = receiveSample<swTracking::SWHandSkeletonMessage>(l_oPath, l_oMonitor, l_oLatency);   break;
+                }
+
+                if(l_bReceived)
+                {
+                    l_oController.setWaiting(l_oPath, l_oLatency);
+                }
+            }
+
+            l_oMonitor.publish();
+            boost::this_thread::sleep(boost::posix_time::milliseconds(l_i32ModulePeriod));
+        }
+
+    // stop the chain
+        l_oReplayThreads.join_all();
+        l_oController.stop();
+        l_bStop = true;
+        l_oRelayThread.join();
+
+        l_oMonitor.publish(true);
+
+        for(uint ii = 0; ii < l_vPaths.size(); ++ii)
+        {
+            l_vPaths[ii]->m_oTrackingPort.close();
+            l_vPaths[ii]->m_oRelayInPort.close();
+            l_vPaths[ii]->m_oRelayOutPort.close();
+            l_vPaths[ii]->m_oTeleoperationPort.close();
+        }
+        l_oMonitor.close();
+
+    // results
+        std::cout << std::endl << "Relay : " << (l_i32RelayPeriod > 0 ? "yes" : "no") << ", module period : " << l_i32ModulePeriod
+                  << " ms, controller period : " << l_i32ControllerPeriod << " ms" << std::endl << std::endl;
+        l_oMonitor.display(std::cout);
+        std::cout << std::endl;
+
+        for(uint ii = 0; ii < l_vPaths.size(); ++ii)
+        {
+            swTracking::SWLatencyHistogram l_oHistogram;
+            std::cout << l_vPaths[ii]->m_sPath << " sensor to command latency : ";
+
+            if(l_oMonitor.histogram(l_vPaths[ii]->m_sPath, "capture_to_command", l_oHistogram))
+            {
+                std::cout << "p50 " << l_oHistogram.percentile(50.) << " ms, p99 " << l_oHistogram.percentile(99.) << " ms (" << l_oHistogram.count() << " commands)" << std::endl;
+            }
+            else if(l_oMonitor.histogram(l_vPaths[ii]->m_sPath, "receive_to_command", l_oHistogram))
+            {
+                std::cout << "not available (bottles of values without times), receive to command p50 " << l_oHistogram.percentile(50.)
+                          << " ms, p99 " << l_oHistogram.percentile(99.) << " ms" << std::endl;
+            }
+            else
+            {
+                std::cout << "no command" << std::endl;
+            }
+        }
+
+    return 0;
+}
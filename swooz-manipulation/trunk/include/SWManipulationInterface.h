@@ -82,6 +82,8 @@ struct SWBottleContent
 {
     int idLib;
     std::vector<double> dValues;
+    std::vector<char> vMessage; /**< received typed message (see SWTrackingMessage.h), its payload values are replaced by dValues when sent
+                                   (see swTracking::legacyValuesIndices), empty for a bottle of values */
 
     void display() const
     {
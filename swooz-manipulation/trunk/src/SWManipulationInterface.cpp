@@ -34,6 +34,7 @@
 #include "SWManipulationInterface.h"
 #include <commonTypes.h>
 #include "SWTrackingDevice.h"
+#include "SWTrackingMessage.h"
 
 // MOC
 #include "moc_SWManipulationInterface.cpp"
@@ -278,12 +279,32 @@ void SWManipulationWorker::startLoop()
                         yarp::os::Bottle &l_oBottle = m_vManipulationOUTPort[ii]->prepare();
                         l_oBottle.clear();
 
-                         // device lib id
-                        l_oBottle.addInt(m_vBottlesContent[ii].idLib);
+                        std::vector<char> &l_vMessage = m_vBottlesContent[ii].vMessage;
 
-                        for(uint jj = 0; jj < m_vBottlesContent[ii].dValues.size(); ++jj)
+                        if(l_vMessage.size() > 0)
                         {
-                            l_oBottle.addDouble(m_vBottlesContent[ii].dValues[jj]);
+                            // typed message : the modified values replace their payload values, the source time is kept
+                            swTracking::SWTrackingMessageHeader l_oHeader;
+                            std::memcpy(&l_oHeader, &l_vMessage[0], sizeof(swTracking::SWTrackingMessageHeader));
+                            std::vector<uint> l_vUi32Indices = swTracking::legacyValuesIndices(l_oHeader);
+
+                            for(uint jj = 0; jj < l_vUi32Indices.size() && jj < m_vBottlesContent[ii].dValues.size(); ++jj)
+                            {
+                                std::memcpy(&l_vMessage[sizeof(swTracking::SWTrackingMessageHeader) + l_vUi32Indices[jj] * sizeof(double)],
+                                            &m_vBottlesContent[ii].dValues[jj], sizeof(double));
+                            }
+
+                            swTracking::relayMessage(l_oBottle, &l_vMessage[0]);
+                        }
+                        else
+                        {
+                            // device lib id
+                            l_oBottle.addInt(m_vBottlesContent[ii].idLib);
+
+                            for(uint jj = 0; jj < m_vBottlesContent[ii].dValues.size(); ++jj)
+                            {
+                                l_oBottle.addDouble(m_vBottlesContent[ii].dValues[jj]);
+                            }
                         }
 
                         m_vManipulationOUTPort[ii]->write();
@@ -326,7 +347,7 @@ void SWManipulationWorker::stopLoop()
 
 void SWManipulationWorker::applyDampingOnBottle(SWBottleContent &oBottleContent, QVector<double> vDDamping)
 {
-    for(uint ii = 0; ii < oBottleContent.dValues.size(); ++ii)
+    for(uint ii = 0; ii < oBottleContent.dValues.size() && ii < static_cast<uint>(vDDamping.size()); ++ii)
     {
         oBottleContent.dValues[ii] *= vDDamping[ii];
     }
@@ -334,7 +355,7 @@ void SWManipulationWorker::applyDampingOnBottle(SWBottleContent &oBottleContent,
 
 void SWManipulationWorker::applyShiftOnBottle(SWBottleContent &oBottleContent, QVector<double> vDShifts)
 {
-    for(uint ii = 0; ii < oBottleContent.dValues.size(); ++ii)
+    for(uint ii = 0; ii < oBottleContent.dValues.size() && ii < static_cast<uint>(vDShifts.size()); ++ii)
     {
         oBottleContent.dValues[ii] += vDShifts[ii];
     }
@@ -352,7 +373,27 @@ bool SWManipulationWorker::retrieveBottleContent(SWBottleContent &oBottleContent
         return false;
     }
 
+    // typed message : the payload values are copied without parsing, in the order of the bottles of values (the modifiers are set by index)
+    swTracking::SWTrackingMessageHeader l_oHeader;
+    const char *l_pMessage = swTracking::messageData(*l_pIN, l_oHeader);
+
+    if(l_pMessage)
+    {
+        oBottleContent.idLib = l_oHeader.m_i32DeviceId;
+        oBottleContent.vMessage.assign(l_pMessage, l_pMessage + l_oHeader.m_ui32Size);
+        std::vector<uint> l_vUi32Indices = swTracking::legacyValuesIndices(l_oHeader);
+        oBottleContent.dValues.resize(l_vUi32Indices.size());
+
+        for(uint ii = 0; ii < l_vUi32Indices.size(); ++ii)
+        {
+            std::memcpy(&oBottleContent.dValues[ii], l_pMessage + sizeof(swTracking::SWTrackingMessageHeader) + l_vUi32Indices[ii] * sizeof(double), sizeof(double));
+        }
+
+        return true;
+    }
+
     oBottleContent.idLib = l_pIN->get(0).asInt();
+    oBottleContent.vMessage.clear();
     std::vector<double> l_vDValues;
     for(int ii = 1; ii < l_pIN->size(); ++ii)
     {
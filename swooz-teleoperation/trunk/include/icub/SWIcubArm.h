@@ -39,6 +39,8 @@
 
 // SWOOZ
 #include "commonTypes.h"
+#include "SWTrackingMessage.h"
+#include "SWTrackingLatency.h"
 
 // YARP
 #include <yarp/os/Network.h>
@@ -94,8 +96,15 @@ namespace swTeleop
             /**
              * @brief setNewCommand
              * @param vArmCommand
+             * @param oHandLatency : times of the hand message used by the command, recorded at its first velocity move
              */
-            void setJoints(const yarp::sig::Vector &vJoints);
+            void setJoints(const yarp::sig::Vector &vJoints, const swTracking::SWCommandLatency &oHandLatency = swTracking::SWCommandLatency());
+
+            /**
+             * @brief setLatencyMonitor
+             * @param pLatencyMonitor : monitor recording the command latencies, NULL for no recording
+             */
+            void setLatencyMonitor(swTracking::SWLatencyMonitor *pLatencyMonitor);
 
             /**
              * @brief enable arm parts
@@ -117,6 +126,9 @@ namespace swTeleop
             yarp::sig::Vector m_vLastArmJoint;             /**< ... */
 
             std::vector<double> m_vArmJointVelocityK;      /**< ... */
+
+            swTracking::SWLatencyMonitor *m_pLatencyMonitor;    /**< monitor of the command latencies */
+            swTracking::SWCommandLatency m_oHandLatency;        /**< hand message waiting for its velocity move */
     };
 
     /**
@@ -176,18 +188,18 @@ namespace swTeleop
         private :
 
             /**
-             * @brief Compute the arm/hand angles values with an input hand yarp bottle
-             * @param [in] handBottle    : hand yarp bottle pointer
+             * @brief Compute the arm/hand angles values with an input hand message
+             * @param [in] oHand         : hand skeleton message
              * @param [out] vHandAngles  : hand angles array
              */
-            void computeHandAngles(yarp::os::Bottle* handBottle,std::vector<double> &vHandAngles);
+            void computeHandAngles(const swTracking::SWHandSkeletonMessage &oHand, std::vector<double> &vHandAngles);
 
             /**
-             * @brief Compute the finger angles values with an input hand finger yarp bottle
-             * @param [in] handFingerBottle : hand fingers  yarp bottle pointer
+             * @brief Compute the finger angles values with an input hand message
+             * @param [in] oHand            : hand skeleton message
              * @param [out] vFingerAngles   : finger angles array
              */
-            void computeFingerAngles(yarp::os::Bottle* handFingerBottle,std::vector<double> &vFingerAngles);
+            void computeFingerAngles(const swTracking::SWHandSkeletonMessage &oHand, std::vector<double> &vFingerAngles);
 
             bool m_bInitialized;                /**< is the module initialized */
             bool m_bIsRunning;                  /**< is the module running */
@@ -246,6 +258,8 @@ namespace swTeleop
             std::string m_sHandFingersTrackerPortName;                              /**< name of the hand fingers tracker port */
             yarp::os::BufferedPort<yarp::os::Bottle> m_oHandTrackerPort;            /**< Hand yarp tracker port  */
             yarp::os::BufferedPort<yarp::os::Bottle> m_oHandFingersTrackerPort;     /**< Hand fingers yarp tracker port  */
+            //  latency
+            swTracking::SWLatencyMonitor m_oLatencyMonitor;                         /**< latencies of the received messages, published on the latency port */
 
 
 
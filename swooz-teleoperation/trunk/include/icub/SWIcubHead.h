@@ -39,6 +39,7 @@
 
 // SWOOZ
 #include "commonTypes.h"
+#include "SWTrackingLatency.h"
 
 // YARP
 #include <yarp/os/Network.h>
@@ -151,8 +152,17 @@ namespace swTeleop
             /**
              * @brief setNewCommand
              * @param vHeadCommand
+             * @param oHeadLatency : times of the head message used by the command, recorded at its first velocity move
+             * @param oGazeLatency : times of the gaze message used by the command, recorded at its first velocity move
              */
-            void setJoints(const yarp::sig::Vector &vJoints);
+            void setJoints(const yarp::sig::Vector &vJoints, const swTracking::SWCommandLatency &oHeadLatency = swTracking::SWCommandLatency(),
+                           const swTracking::SWCommandLatency &oGazeLatency = swTracking::SWCommandLatency());
+
+            /**
+             * @brief setLatencyMonitor
+             * @param pLatencyMonitor : monitor recording the command latencies, NULL for no recording
+             */
+            void setLatencyMonitor(swTracking::SWLatencyMonitor *pLatencyMonitor);
 
             /**
              * @brief enableHead
@@ -188,6 +198,10 @@ namespace swTeleop
             std::vector<double> m_vHeadJointVelocityK;      /**< ... */
             std::vector<double> m_vMinJoints;
             std::vector<double> m_vMaxJoints;
+
+            swTracking::SWLatencyMonitor *m_pLatencyMonitor;    /**< monitor of the command latencies */
+            swTracking::SWCommandLatency m_oHeadLatency;        /**< head message waiting for its velocity move */
+            swTracking::SWCommandLatency m_oGazeLatency;        /**< gaze message waiting for its velocity move */
     };
 
     /**
@@ -345,6 +359,8 @@ namespace swTeleop
             std::string m_sGazeRemotePortName;      /**< name of the Gaze remote port */
             std::string m_sGazeControlName;         /**< Gaze control name */
             yarp::os::BufferedPort<yarp::os::Bottle> m_oGazeTrackerPort; /**< gaze yarp tracker port  */
+            //  latency
+            swTracking::SWLatencyMonitor m_oLatencyMonitor;  /**< latencies of the received messages, published on the latency port */
 
             // head control
             yarp::os::Property m_oHeadOptions;              /**< robot interfaces for head/gaze movements */
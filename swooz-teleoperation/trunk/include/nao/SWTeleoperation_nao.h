@@ -40,6 +40,7 @@
 
 // SWOOZ
 #include "commonTypes.h"
+#include "SWTrackingLatency.h"
 
 // YARP
 #include <yarp/os/Network.h>
@@ -197,6 +198,7 @@ class SWTeleoperation_nao : public RFModule
         yarp::os::BufferedPort<yarp::os::Bottle> m_oFaceTrackerPort; /**< Face yarp tracker port */
         yarp::os::BufferedPort<yarp::os::Bottle> m_oLeftArmTrackerPort; /**< Left Arm yarp tracker port  */
         yarp::os::BufferedPort<yarp::os::Bottle> m_oRightArmTrackerPort; /**< Right Arm yarp tracker port  */
+        swTracking::SWLatencyMonitor m_oLatencyMonitor; /**< latencies of the received messages, published on the latency port */
 
         ALMotionProxy *m_oRobotMotionProxy;
 };
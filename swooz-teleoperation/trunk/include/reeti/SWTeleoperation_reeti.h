@@ -38,6 +38,8 @@
 
 #include "urbi/uclient.hh"
 
+#include "SWTrackingLatency.h"
+
 
 using namespace yarp::os;
 using namespace yarp::sig;
@@ -211,6 +213,7 @@ class SWTeleoperation_reeti : public RFModule
 	yarp::os::BufferedPort<yarp::os::Bottle> m_oHeadTrackerPort; /**< head yarp tracker port  */
         yarp::os::BufferedPort<yarp::os::Bottle> m_oFaceTrackerPort; /**< Face yarp tracker port */
 	yarp::os::BufferedPort<yarp::os::Bottle> m_oGazeTrackerPort; /**< Gaze yarp tracker port */
+	swTracking::SWLatencyMonitor m_oLatencyMonitor; /**< latencies of the received messages, published on the latency port */
 	
        // Urbi client
        UClient* m_pClient;
@@ -201,6 +201,11 @@ bool swTeleop::SWIcubArm::init( yarp::os::ResourceFinder &oRf, bool bLeftArm)
             return (m_bInitialized=false);
         }
 
+        if(!m_oLatencyMonitor.open("/teleoperation/" + m_sRobotName + "/" + m_sArm + "_arm/latency"))
+        {
+            std::cerr << "-WARNING: the latencies will not be published." << std::endl;
+        }
+
     // retrieve Torso number of joints
         m_pIArmPosition->getAxes(&m_i32ArmJointsNb);
 
@@ -215,6 +220,7 @@ bool swTeleop::SWIcubArm::init( yarp::os::ResourceFinder &oRf, bool bLeftArm)
     // init controller
         m_pVelocityController = new swTeleop::SWArmVelocityController(m_pIArmEncoders, m_pIArmVelocity, m_pIArmControlMode, m_vArmJointVelocityK, m_i32RateVelocityControl);
         m_pVelocityController->enable(m_bArmHandActivated, m_bFingersActivated);
+        m_pVelocityController->setLatencyMonitor(&m_oLatencyMonitor);
 
         // display parameters
             std::cout << std::endl << std::endl;
@@ -235,7 +241,7 @@ bool swTeleop::SWIcubArm::init( yarp::os::ResourceFinder &oRf, bool bLeftArm)
     return (m_bIsRunning=m_bInitialized=true);
 }
 
-void swTeleop::SWIcubArm::computeHandAngles(yarp::os::Bottle* handBottle,std::vector<double> &vHandAngles)
+void swTeleop::SWIcubArm::computeHandAngles(const swTracking::SWHandSkeletonMessage &oHand, std::vector<double> &vHandAngles)
 {
     vHandAngles = std::vector<double>(4,0.);
 
@@ -243,12 +249,12 @@ void swTeleop::SWIcubArm::computeHandAngles(yarp::os::Bottle* handBottle,std::ve
         std::vector<double> l_vArmDirection(3,0.), l_vHandDirection(3,0.),l_vHandDirectionE(3,0.), l_vHandPalmCoord(3,0.), l_vHandPalmNormal(3,0.), l_vHandPalmNormalE(3,0.);
         for(int ii = 0; ii < 3; ++ii)
         {
-            l_vArmDirection[ii]     = handBottle->get(1 + ii).asDouble();
-            l_vHandDirection[ii]    = handBottle->get(4 + ii).asDouble();
-            l_vHandDirectionE[ii]   = handBottle->get(7 + ii).asDouble();
-            l_vHandPalmCoord[ii]    = handBottle->get(10 + ii).asDouble();
-            l_vHandPalmNormal[ii]   = handBottle->get(13 + ii).asDouble();
-            l_vHandPalmNormalE[ii]  = handBottle->get(16 + ii).asDouble();
+            l_vArmDirection[ii]     = oHand.m_aDArmDirection[ii];
+            l_vHandDirection[ii]    = oHand.m_aDHandDirection[ii];
+            l_vHandDirectionE[ii]   = oHand.m_aDHandDirectionAngles[ii];
+            l_vHandPalmCoord[ii]    = oHand.m_aDPalmPosition[ii];
+            l_vHandPalmNormal[ii]   = oHand.m_aDPalmNormal[ii];
+            l_vHandPalmNormalE[ii]  = oHand.m_aDPalmNormalAngles[ii];
         }
 
     // convert to vec3D
@@ -407,7 +413,7 @@ void swTeleop::SWIcubArm::computeHandAngles(yarp::os::Bottle* handBottle,std::ve
         vHandAngles[0] = l_dAngle;
 }
 
-void swTeleop::SWIcubArm::computeFingerAngles(yarp::os::Bottle *handFingersBottle, std::vector<double> &vFingerAngles)
+void swTeleop::SWIcubArm::computeFingerAngles(const swTracking::SWHandSkeletonMessage &oHand, std::vector<double> &vFingerAngles)
 {
     // arm joint 0 hand_finger
     // arm joint 1 thumb_oppose
@@ -428,8 +434,8 @@ void swTeleop::SWIcubArm::computeFingerAngles(yarp::os::Bottle *handFingersBottl
         std::vector<cv::Vec3d> l_vecMiddleDirections(4,   cv::Vec3d(0.,0.,0.));
         std::vector<cv::Vec3d> l_vecRingDirections(4,     cv::Vec3d(0.,0.,0.));
         std::vector<cv::Vec3d> l_vecPinkyDirections(4,    cv::Vec3d(0.,0.,0.));
-        cv::Vec3d l_vecHandNormal    = cv::normalize(cv::Vec3d(handFingersBottle->get(13).asDouble(), handFingersBottle->get(14).asDouble(), handFingersBottle->get(15).asDouble()));
-        cv::Vec3d l_vecHandDirection = cv::normalize(cv::Vec3d(handFingersBottle->get(4).asDouble(), handFingersBottle->get(5).asDouble(), handFingersBottle->get(6).asDouble()));
+        cv::Vec3d l_vecHandNormal    = cv::normalize(cv::Vec3d(oHand.m_aDPalmNormal[0], oHand.m_aDPalmNormal[1], oHand.m_aDPalmNormal[2]));
+        cv::Vec3d l_vecHandDirection = cv::normalize(cv::Vec3d(oHand.m_aDHandDirection[0], oHand.m_aDHandDirection[1], oHand.m_aDHandDirection[2]));
 
         for(int ii = 0; ii < 4; ++ii)
         {
@@ -437,13 +443,13 @@ void swTeleop::SWIcubArm::computeFingerAngles(yarp::os::Bottle *handFingersBottl
             {
                 if(ii < 3)
                 {
-                    l_vecThumbDirections[ii][jj] = handFingersBottle->get(19 + ii * 3 + jj).asDouble();
+                    l_vecThumbDirections[ii][jj] = oHand.m_aDBones[0][1 + ii][jj]; // proximal, intermediate, distal
                 }
 
-                l_vecIndexDirections[ii][jj] = handFingersBottle->get(28 + ii * 3 + jj).asDouble();
-                l_vecMiddleDirections[ii][jj] = handFingersBottle->get(40 + ii * 3 + jj).asDouble();
-                l_vecRingDirections[ii][jj] = handFingersBottle->get(52 + ii * 3 + jj).asDouble();
-                l_vecPinkyDirections[ii][jj] = handFingersBottle->get(64 + ii * 3 + jj).asDouble();
+                l_vecIndexDirections[ii][jj]  = oHand.m_aDBones[1][ii][jj];
+                l_vecMiddleDirections[ii][jj] = oHand.m_aDBones[2][ii][jj];
+                l_vecRingDirections[ii][jj]   = oHand.m_aDBones[3][ii][jj];
+                l_vecPinkyDirections[ii][jj]  = oHand.m_aDBones[4][ii][jj];
             }
 
             if(l_vecThumbDirections[ii][0] != 0 && l_vecThumbDirections[ii][1] != 0 && l_vecThumbDirections[ii][2] != 0)
@@ -772,6 +778,7 @@ bool swTeleop::SWIcubArm::checkBottles()
 
     // defines bottles
         yarp::os::Bottle *l_pHandTarget = NULL;//, *l_pHandCartesianTarget = NULL; // *l_pFingersTarget = NULL, *l_pArmTarget = NULL,
+        swTracking::SWCommandLatency l_oHandLatency;
 
 
         l_pHandTarget = m_oHandFingersTrackerPort.read(false);
@@ -779,7 +786,13 @@ bool swTeleop::SWIcubArm::checkBottles()
 
         if(l_pHandTarget)
         {
-            int l_deviceId = l_pHandTarget->get(0).asInt();
+            int64 l_i64ReceiveTime = swTracking::messageTimeUs();
+            swTracking::SWHandSkeletonMessage l_oHand;
+            int l_deviceId = swTracking::readMessageDevice(*l_pHandTarget, l_oHand);
+
+            std::string l_sPath = swTracking::latencyPath(m_sArm + "_hand", l_deviceId);
+            m_oLatencyMonitor.recordMessage(l_sPath, l_oHand.m_oHeader, l_i64ReceiveTime);
+            l_oHandLatency.received(l_sPath, l_oHand.m_oHeader, l_i64ReceiveTime);
 
             // arm joint 0 shoulder_pitch
             // arm joint 1 shoulder_roll
@@ -815,7 +828,7 @@ bool swTeleop::SWIcubArm::checkBottles()
 
                         std::vector<double> l_vHandAngles;
 //                        std::cout << "computeHandAngles  ";
-                        computeHandAngles(l_pHandTarget, l_vHandAngles);
+                        computeHandAngles(l_oHand, l_vHandAngles);
 //                        std::cout << "-> end  |";
 
                         for(uint ii = 0; ii < l_vHandAngles.size(); ++ii)
@@ -825,7 +838,7 @@ bool swTeleop::SWIcubArm::checkBottles()
 
                         std::vector<double> l_vFingerAngles;
 //                        std::cout << "computeFingerAngles  ";
-                        computeFingerAngles(l_pHandTarget, l_vFingerAngles);
+                        computeFingerAngles(l_oHand, l_vFingerAngles);
 //                        std::cout << "-> end  |";
 
                         for(uint ii = 0; ii < l_vFingerAngles.size(); ++ii)
@@ -837,34 +850,34 @@ bool swTeleop::SWIcubArm::checkBottles()
 		case swTracking::OPENNI_LIB :
 		{
 			
-			std::vector<double> l_pointTorso(3);
+			swUtil::Vec3d l_pointTorso;
 				l_pointTorso[0] = l_pHandTarget->get(1).asDouble();
 				l_pointTorso[1] = l_pHandTarget->get(2).asDouble();
 				l_pointTorso[2] = l_pHandTarget->get(3).asDouble();
-			std::vector<double> l_pointNeck(3);
+			swUtil::Vec3d l_pointNeck;
 				l_pointNeck[0] = l_pHandTarget->get(4).asDouble();
 				l_pointNeck[1] = l_pHandTarget->get(5).asDouble();
 				l_pointNeck[2] = l_pHandTarget->get(6).asDouble();
-			std::vector<double> l_pointShoulder(3);
+			swUtil::Vec3d l_pointShoulder;
 				l_pointShoulder[0] = l_pHandTarget->get(7).asDouble();
 				l_pointShoulder[1] = l_pHandTarget->get(8).asDouble();
 				l_pointShoulder[2] = l_pHandTarget->get(9).asDouble();
-			std::vector<double> l_pointElbow(3);
+			swUtil::Vec3d l_pointElbow;
 				l_pointElbow[0] = l_pHandTarget->get(10).asDouble();
 				l_pointElbow[1] = l_pHandTarget->get(11).asDouble();
 				l_pointElbow[2] = l_pHandTarget->get(12).asDouble();
-			std::vector<double> l_pointHand(3);
+			swUtil::Vec3d l_pointHand;
 				l_pointHand[0] = l_pHandTarget->get(13).asDouble();
 				l_pointHand[1] = l_pHandTarget->get(14).asDouble();
 				l_pointHand[2] = l_pHandTarget->get(15).asDouble();
 
-			std::vector<double> l_vecTorso = swUtil::vec(l_pointNeck, l_pointTorso);
-			std::vector<double> l_vecForearm = swUtil::vec(l_pointElbow, l_pointHand);
-			std::vector<double> l_vecShoulder = swUtil::vec(l_pointShoulder, l_pointNeck);
-			std::vector<double> l_vecArm = swUtil::vec( l_pointShoulder, l_pointElbow);
+			swUtil::Vec3d l_vecTorso = swUtil::vec(l_pointNeck, l_pointTorso);
+			swUtil::Vec3d l_vecForearm = swUtil::vec(l_pointElbow, l_pointHand);
+			swUtil::Vec3d l_vecShoulder = swUtil::vec(l_pointShoulder, l_pointNeck);
+			swUtil::Vec3d l_vecArm = swUtil::vec( l_pointShoulder, l_pointElbow);
 
-			std::vector<double> l_rpyShoulder = swUtil::computeRollPitchYaw(l_vecArm, l_vecTorso);
-			std::vector<double> l_rpyElbow = swUtil::computeRollPitchYaw(l_vecForearm, l_vecArm);
+			swUtil::Vec3d l_rpyShoulder = swUtil::computeRollPitchYaw(l_vecArm, l_vecTorso);
+			swUtil::Vec3d l_rpyElbow = swUtil::computeRollPitchYaw(l_vecForearm, l_vecArm);
 
 			//~ l_vArmJoints[0] = swUtil::degree180(l_rpyShoulder[1] - 180.);
 			//~ l_vArmJoints[1] = swUtil::degree180(- l_rpyShoulder[0] - 180.);
@@ -873,12 +886,12 @@ bool swTeleop::SWIcubArm::checkBottles()
 			
 			//~ l_vArmJoints[3] = swUtil::vectorAngle(l_vecForearm, l_vecArm);
 			
-			std::vector<double> l_vecArm_roll(3);
+			swUtil::Vec3d l_vecArm_roll;
 			l_vecArm_roll[0] = 0; l_vecArm_roll[1] = l_vecArm[1]; l_vecArm_roll[2] = l_vecArm[2]; 
 			l_vArmJoints[0] = -swUtil::vectorAngle(l_vecTorso, l_vecArm_roll);
 			
 			
-			std::vector<double> l_vecArm_pitch(3);
+			swUtil::Vec3d l_vecArm_pitch;
 			l_vecArm_pitch[0] =  l_vecArm[0]; l_vecArm_pitch[1] = l_vecArm[1]; l_vecArm_pitch[2] = 0; 
 			l_vArmJoints[1] = swUtil::vectorAngle(l_vecTorso, l_vecArm_pitch);
 			
@@ -931,7 +944,7 @@ bool swTeleop::SWIcubArm::checkBottles()
         if(l_pHandTarget)
         {
 //            std::cout << "send joints " << std::endl;
-            m_pVelocityController->setJoints(l_vArmJoints);
+            m_pVelocityController->setJoints(l_vArmJoints, l_oHandLatency);
 
             if(!m_pVelocityController->isRunning())
             {                
@@ -939,6 +952,9 @@ bool swTeleop::SWIcubArm::checkBottles()
             }
         }
 
+    // publish the latencies
+        m_oLatencyMonitor.publish();
+
     return true;
 }
 
@@ -975,6 +991,7 @@ bool swTeleop::SWIcubArm::close()
             m_oHandTrackerPort.close();
             m_oHandFingersTrackerPort.close();
         }
+        m_oLatencyMonitor.close();
 	
 	m_pIArmEncoders = NULL;
 	m_pIArmPosition = NULL;
@@ -1012,6 +1029,7 @@ bool swTeleop::SWIcubArm::interruptModule()
             m_oHandFingersTrackerPort.interrupt();
             m_oHandTrackerPort.interrupt();
         }
+        m_oLatencyMonitor.interrupt();
 
     std::cout << "--Interrupting the iCub Arm Teleoperation module..." << std::endl;
 
@@ -1021,7 +1039,7 @@ bool swTeleop::SWIcubArm::interruptModule()
 
 swTeleop::SWArmVelocityController::SWArmVelocityController(yarp::dev::IEncoders *pIArmEncoders, yarp::dev::IVelocityControl *pIArmVelocity, yarp::dev::IControlMode2    *pIArmControlMode,
                                                      std::vector<double> &vArmJointVelocityK, int i32Rate)
-    : RateThread(i32Rate), m_bArmHandEnabled(false), m_bFingersEnabled(false), m_vArmJointVelocityK(vArmJointVelocityK)
+    : RateThread(i32Rate), m_bArmHandEnabled(false), m_bFingersEnabled(false), m_vArmJointVelocityK(vArmJointVelocityK), m_pLatencyMonitor(NULL)
 {
 
     if(pIArmEncoders)
@@ -1049,6 +1067,8 @@ void swTeleop::SWArmVelocityController::run()
 //    std::cout << "start run ";
     m_oMutex.lock();
         yarp::sig::Vector l_vArmJoints = m_vLastArmJoint; // Check values with Joint before
+        swTracking::SWCommandLatency l_oHandLatency = m_oHandLatency;
+        m_oHandLatency = swTracking::SWCommandLatency();
     m_oMutex.unlock();
 
     yarp::sig::Vector l_vEncoders, l_vCommand;
@@ -1083,6 +1103,12 @@ void swTeleop::SWArmVelocityController::run()
             m_pIArmVelocity->velocityMove(ii, l_vCommand[ii]);
         }
     }
+
+    // latency of the received message commanded for the first time
+    if(m_pLatencyMonitor && (m_bArmHandEnabled || m_bFingersEnabled))
+    {
+        l_oHandLatency.commanded(*m_pLatencyMonitor);
+    }
 //    std::cout << " - end run |";
 }
 
@@ -1094,14 +1120,24 @@ void swTeleop::SWArmVelocityController::enable(cbool bArmHandActivated, cbool bF
     m_oMutex.unlock();
 }
 
-void swTeleop::SWArmVelocityController::setJoints(const yarp::sig::Vector &vJoints)
+void swTeleop::SWArmVelocityController::setJoints(const yarp::sig::Vector &vJoints, const swTracking::SWCommandLatency &oHandLatency)
 {
 
     m_oMutex.lock();
         m_vLastArmJoint = vJoints;
+
+        if(oHandLatency.isWaiting())
+        {
+            m_oHandLatency = oHandLatency;
+        }
     m_oMutex.unlock();
 }
 
+void swTeleop::SWArmVelocityController::setLatencyMonitor(swTracking::SWLatencyMonitor *pLatencyMonitor)
+{
+    m_pLatencyMonitor = pLatencyMonitor;
+}
+
 
 
 
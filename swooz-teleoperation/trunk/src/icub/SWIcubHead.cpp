@@ -35,6 +35,7 @@
 
 #include "geometryUtility.h"
 #include "SWTrackingDevice.h"
+#include "SWTrackingMessage.h"
 
 #include "icub/SWIcubHead.h"
 //#include "icub/SWiCubFaceMotion.h"
@@ -196,6 +197,7 @@ bool swTeleop::SWIcubHead::init( yarp::os::ResourceFinder &oRf)
         m_sFaceTrackerPortName  = "/teleoperation/" + m_sRobotName + "/face";
         m_sEyelidInputPortName  = "/" + m_sRobotName + "/face/raw/in";
         m_sEyelidOutputPortName = "/teleoperation/" + m_sRobotName + "/eyelids/out";
+        std::string l_sLatencyPortName = "/teleoperation/" + m_sRobotName + "/head/latency";
 
     // open ports
         if(m_bHeadActivated)
@@ -235,6 +237,11 @@ bool swTeleop::SWIcubHead::init( yarp::os::ResourceFinder &oRf)
             }
         }
 
+        if(!m_oLatencyMonitor.open(l_sLatencyPortName))
+        {
+            std::cerr << "-WARNING: the latencies will not be published." << std::endl;
+        }
+
     //  attach to port
         if(m_bLEDActivated)
         {
@@ -257,6 +264,7 @@ bool swTeleop::SWIcubHead::init( yarp::os::ResourceFinder &oRf)
         m_pVelocityController->enableHead(m_bHeadActivated);
         m_pVelocityController->enableGaze(m_bGazeActivated);
         m_pVelocityController->setMinMaxJoints(m_vHeadMinJoint, m_vHeadMaxJoint);
+        m_pVelocityController->setLatencyMonitor(&m_oLatencyMonitor);
 
     // display parameters
         std::cout << std::endl << std::endl;
@@ -304,6 +312,7 @@ bool swTeleop::SWIcubHead::checkBottles()
 
     // defines bottles
         Bottle *l_pHeadTarget = NULL, *l_pFaceTarget = NULL, *l_pGazeTarget = NULL;
+        swTracking::SWCommandLatency l_oHeadLatency, l_oGazeLatency, l_oFaceLatency;
 
     // read head command
         if(m_bHeadActivated)
@@ -312,7 +321,13 @@ bool swTeleop::SWIcubHead::checkBottles()
 
             if(l_pHeadTarget)
             {
-                int l_deviceId = l_pHeadTarget->get(0).asInt();
+                int64 l_i64ReceiveTime = swTracking::messageTimeUs();
+                swTracking::SWHeadPoseMessage l_oHeadPose;
+                int l_deviceId = swTracking::readMessageDevice(*l_pHeadTarget, l_oHeadPose);
+
+                std::string l_sPath = swTracking::latencyPath("head", l_deviceId);
+                m_oLatencyMonitor.recordMessage(l_sPath, l_oHeadPose.m_oHeader, l_i64ReceiveTime);
+                l_oHeadLatency.received(l_sPath, l_oHeadPose.m_oHeader, l_i64ReceiveTime);
 
                 switch(l_deviceId)
                 {
@@ -339,9 +354,9 @@ bool swTeleop::SWIcubHead::checkBottles()
                     break;
                     case swTracking::FOREST_LIB :
                         {
-                            l_vHeadJoints[0] = -l_pHeadTarget->get(1).asDouble(); //head rotation "yes" [-40 30]
-                            l_vHeadJoints[1] = -l_pHeadTarget->get(3).asDouble(); //head rotation [-70 60]
-                            l_vHeadJoints[2] = l_pHeadTarget->get(2).asDouble(); //head rotation "no" [-55 55]
+                            l_vHeadJoints[0] = -l_oHeadPose.m_aDRotation[0]; //head rotation "yes" [-40 30]
+                            l_vHeadJoints[1] = -l_oHeadPose.m_aDRotation[2]; //head rotation [-70 60]
+                            l_vHeadJoints[2] = l_oHeadPose.m_aDRotation[1]; //head rotation "no" [-55 55]
                         }
                     break;
                     case swTracking::COREDATA_LIB :
@@ -353,21 +368,21 @@ bool swTeleop::SWIcubHead::checkBottles()
                     break;
                     case swTracking::EMICP_LIB :
                         {
-                            l_vHeadJoints[0] = -l_pHeadTarget->get(4).asDouble(); // up/down head
-                            l_vHeadJoints[1] = -l_pHeadTarget->get(6).asDouble(); // left/right head
-                            l_vHeadJoints[2] = -l_pHeadTarget->get(5).asDouble(); // head
+                            l_vHeadJoints[0] = -l_oHeadPose.m_aDRotation[0]; // up/down head
+                            l_vHeadJoints[1] = -l_oHeadPose.m_aDRotation[2]; // left/right head
+                            l_vHeadJoints[2] = -l_oHeadPose.m_aDRotation[1]; // head
                         }
                     break;
                     case swTracking::FACESHIFT_LIB :
                         {
-                            l_vHeadJoints[0] = -swUtil::rad2Deg(l_pHeadTarget->get(4).asDouble()); // up/down head
-                            l_vHeadJoints[1] = swUtil::rad2Deg(l_pHeadTarget->get(6).asDouble()); // left/right head
-                            l_vHeadJoints[2] = swUtil::rad2Deg(l_pHeadTarget->get(5).asDouble()); // head
+                            l_vHeadJoints[0] = -swUtil::rad2Deg(l_oHeadPose.m_aDRotation[0]); // up/down head
+                            l_vHeadJoints[1] = swUtil::rad2Deg(l_oHeadPose.m_aDRotation[2]); // left/right head
+                            l_vHeadJoints[2] = swUtil::rad2Deg(l_oHeadPose.m_aDRotation[1]); // head
                         }
                     break;
                     case swTracking::OPENNI_LIB :
                     {
-                        std::vector<double> l_pointNeck(3), l_pointHead(3), l_pointLShoulder(3), l_pointRShoulder(3);
+                        swUtil::Vec3d l_pointNeck, l_pointHead, l_pointLShoulder, l_pointRShoulder;
                         l_pointNeck[0] = l_pHeadTarget->get(1).asDouble();
                         l_pointNeck[1] = l_pHeadTarget->get(2).asDouble();
                         l_pointNeck[2] = l_pHeadTarget->get(3).asDouble();
@@ -381,9 +396,9 @@ bool swTeleop::SWIcubHead::checkBottles()
                         l_pointRShoulder[1] = l_pHeadTarget->get(11).asDouble();
                         l_pointRShoulder[2] = l_pHeadTarget->get(12).asDouble();
 
-                        std::vector<double> l_vecClavicles  = swUtil::vec(l_pointLShoulder,	l_pointRShoulder);
-                        std::vector<double> l_vecHead       = swUtil::vec(l_pointNeck,		l_pointHead);
-                        std::vector<double> l_rpyHead = swUtil::computeRollPitchYaw(l_vecHead, l_vecClavicles);
+                        swUtil::Vec3d l_vecClavicles  = swUtil::vec(l_pointLShoulder,	l_pointRShoulder);
+                        swUtil::Vec3d l_vecHead       = swUtil::vec(l_pointNeck,		l_pointHead);
+                        swUtil::Vec3d l_rpyHead = swUtil::computeRollPitchYaw(l_vecHead, l_vecClavicles);
 
                         l_vHeadJoints[0] = -l_rpyHead[1];
                         l_vHeadJoints[1] = -l_rpyHead[0];
@@ -421,16 +436,22 @@ bool swTeleop::SWIcubHead::checkBottles()
 
             if(l_pGazeTarget)
             {
-                int l_deviceId = l_pGazeTarget->get(0).asInt();
+                int64 l_i64ReceiveTime = swTracking::messageTimeUs();
+                swTracking::SWGazeMessage l_oGaze;
+                int l_deviceId = swTracking::readMessageDevice(*l_pGazeTarget, l_oGaze);
+
+                std::string l_sPath = swTracking::latencyPath("gaze", l_deviceId);
+                m_oLatencyMonitor.recordMessage(l_sPath, l_oGaze.m_oHeader, l_i64ReceiveTime);
+                l_oGazeLatency.received(l_sPath, l_oGaze.m_oHeader, l_i64ReceiveTime);
 
                 switch(l_deviceId)
                 {
                     case swTracking::FACESHIFT_LIB :
                     {
 
-                        l_vHeadJoints[3] = -(l_pGazeTarget->get(1).asDouble() + l_pGazeTarget->get(3).asDouble())*0.5; // up/down eye [-35; +15]
-                        l_vHeadJoints[4] = -(l_pGazeTarget->get(2).asDouble() + l_pGazeTarget->get(4).asDouble())*0.5; // version angle [-50; 52] = (L+R)/2
-                        l_vHeadJoints[5] =  -l_pGazeTarget->get(2).asDouble() + l_pGazeTarget->get(4).asDouble();     // vergence angle [0 90] = R-L
+                        l_vHeadJoints[3] = -(l_oGaze.m_dLeftPitch + l_oGaze.m_dRightPitch)*0.5; // up/down eye [-35; +15]
+                        l_vHeadJoints[4] = -(l_oGaze.m_dLeftYaw + l_oGaze.m_dRightYaw)*0.5;     // version angle [-50; 52] = (L+R)/2
+                        l_vHeadJoints[5] =  -l_oGaze.m_dLeftYaw + l_oGaze.m_dRightYaw;          // vergence angle [0 90] = R-L
                     }
                     break;
                     case swTracking::DUMMY_LIB :
@@ -578,7 +599,13 @@ bool swTeleop::SWIcubHead::checkBottles()
 
             if(l_pFaceTarget)
             {
-                int l_deviceId = l_pFaceTarget->get(0).asInt();
+                int64 l_i64ReceiveTime = swTracking::messageTimeUs();
+                swTracking::SWFaceLandmarksMessage l_oFace;
+                int l_deviceId = swTracking::readMessageDevice(*l_pFaceTarget, l_oFace);
+
+                std::string l_sPath = swTracking::latencyPath("face", l_deviceId);
+                m_oLatencyMonitor.recordMessage(l_sPath, l_oFace.m_oHeader, l_i64ReceiveTime);
+                l_oFaceLatency.received(l_sPath, l_oFace.m_oHeader, l_i64ReceiveTime);
 
                 switch(l_deviceId)
                 {
@@ -613,14 +640,12 @@ bool swTeleop::SWIcubHead::checkBottles()
                     //           26 nose_tip
                     //           27 chin
 
-                        std::vector<double> l_vMouthInnerUp(3,0.0);
-                        l_vMouthInnerUp[0] = l_pFaceTarget->get(46).asDouble();
-                        l_vMouthInnerUp[1] = l_pFaceTarget->get(47).asDouble();
-                        l_vMouthInnerUp[2] = l_pFaceTarget->get(48).asDouble();
-                        std::vector<double> l_vMouthInnerDown(3,0.0);
-                        l_vMouthInnerDown[0] = l_pFaceTarget->get(37).asDouble();
-                        l_vMouthInnerDown[1] = l_pFaceTarget->get(38).asDouble();
-                        l_vMouthInnerDown[2] = l_pFaceTarget->get(39).asDouble();
+                        swUtil::Vec3d l_vMouthInnerUp, l_vMouthInnerDown;
+                        for(int ii = 0; ii < 3; ++ii)
+                        {
+                            l_vMouthInnerUp[ii]   = l_oFace.m_aDLandmarks[15][ii];
+                            l_vMouthInnerDown[ii] = l_oFace.m_aDLandmarks[12][ii];
+                        }
 
                         double l_dLipsDistance = swUtil::norm(swUtil::vec(l_vMouthInnerUp,l_vMouthInnerDown));
                         std::string l_sMouthCmd("M08");
@@ -682,6 +707,9 @@ bool swTeleop::SWIcubHead::checkBottles()
                     break;
                 }
 
+                // the LED commands are sent directly
+                l_oFaceLatency.commanded(m_oLatencyMonitor);
+
                 m_dLEDTimeLastBottle = -1.;
             }
             else // manage timeout and reset position
@@ -716,7 +744,7 @@ bool swTeleop::SWIcubHead::checkBottles()
 
         if(l_pHeadTarget || l_pGazeTarget)
         {
-            m_pVelocityController->setJoints(l_vHeadJoints);
+            m_pVelocityController->setJoints(l_vHeadJoints, l_oHeadLatency, l_oGazeLatency);
 
             if(!m_pVelocityController->isRunning())
             {
@@ -724,6 +752,9 @@ bool swTeleop::SWIcubHead::checkBottles()
             }
         }
 
+    // publish the latencies
+        m_oLatencyMonitor.publish();
+
     return true;
 }
 
@@ -814,6 +845,7 @@ bool swTeleop::SWIcubHead::close()
             m_oFaceTrackerPort.close();
             m_oFaceHandlerPort.close();
         }
+        m_oLatencyMonitor.close();
 	
 	
 	
@@ -868,6 +900,7 @@ bool swTeleop::SWIcubHead::interruptModule()
             m_oFaceTrackerPort.interrupt();
             m_oFaceHandlerPort.interrupt();
         }
+        m_oLatencyMonitor.interrupt();
 
     std::cout << "--Interrupting the iCub Head Teleoperation module..." << std::endl;
 
@@ -887,7 +920,7 @@ std::string swTeleop::SWIcubHead::eyesOpeningCode(cdouble dEyeLids, cdouble dMin
 
 swTeleop::SWHeadVelocityController::SWHeadVelocityController(yarp::dev::IEncoders *pIHeadEncoders, yarp::dev::IVelocityControl *pIHeadVelocity, yarp::dev::IControlMode2    *pIHeadControlMode,
                                                      std::vector<double> &vHeadJointVelocityK, int i32Rate)
-    : RateThread(i32Rate), m_bHeadEnabled(false), m_bGazeEnabled(false) , m_vHeadJointVelocityK(vHeadJointVelocityK)
+    : RateThread(i32Rate), m_bHeadEnabled(false), m_bGazeEnabled(false) , m_vHeadJointVelocityK(vHeadJointVelocityK), m_pLatencyMonitor(NULL)
 {   
     if(pIHeadEncoders)
     {
@@ -913,6 +946,8 @@ void swTeleop::SWHeadVelocityController::run()
         bool l_bHeadEnabled = m_bHeadEnabled;
         bool l_bGazeEnabled = m_bGazeEnabled;
         yarp::sig::Vector l_vHeadJoints = m_vLastHeadJoint;
+        swTracking::SWCommandLatency l_oHeadLatency = m_oHeadLatency, l_oGazeLatency = m_oGazeLatency;
+        m_oHeadLatency = m_oGazeLatency = swTracking::SWCommandLatency();
     m_oMutex.unlock();
 
     yarp::sig::Vector l_vEncoders, l_vCommand;
@@ -971,6 +1006,19 @@ void swTeleop::SWHeadVelocityController::run()
                     m_pIHeadVelocity->velocityMove(ii, l_vCommand[ii]);
                 }
             }
+
+        // latencies of the received messages commanded for the first time
+            if(m_pLatencyMonitor)
+            {
+                if(l_bHeadEnabled)
+                {
+                    l_oHeadLatency.commanded(*m_pLatencyMonitor);
+                }
+                if(l_bGazeEnabled)
+                {
+                    l_oGazeLatency.commanded(*m_pLatencyMonitor);
+                }
+            }
 }
 
 
@@ -994,13 +1042,28 @@ void swTeleop::SWHeadVelocityController::setMinMaxJoints(const std::vector<doubl
     m_vMaxJoints = vMaxJoints;
 }
 
-void swTeleop::SWHeadVelocityController::setJoints(const yarp::sig::Vector &vJoints)
+void swTeleop::SWHeadVelocityController::setJoints(const yarp::sig::Vector &vJoints, const swTracking::SWCommandLatency &oHeadLatency,
+                                                   const swTracking::SWCommandLatency &oGazeLatency)
 {
     m_oMutex.lock();
         m_vLastHeadJoint = vJoints;
+
+        if(oHeadLatency.isWaiting())
+        {
+            m_oHeadLatency = oHeadLatency;
+        }
+        if(oGazeLatency.isWaiting())
+        {
+            m_oGazeLatency = oGazeLatency;
+        }
     m_oMutex.unlock();
 }
 
+void swTeleop::SWHeadVelocityController::setLatencyMonitor(swTracking::SWLatencyMonitor *pLatencyMonitor)
+{
+    m_pLatencyMonitor = pLatencyMonitor;
+}
+
 
 swTeleop::SWIcubFaceLabLEDCommand::SWIcubFaceLabLEDCommand()
 {
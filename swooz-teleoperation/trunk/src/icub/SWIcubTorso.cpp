@@ -254,7 +254,7 @@ bool swTeleop::SWIcubTorso::checkBottles()
                     break;
                     case swTracking::OPENNI_LIB:
                     {
-                        std::vector<double> l_pointTorso(3), l_pointNeck(3), l_pointLShoulder(3), l_pointRShoulder(3);
+                        swUtil::Vec3d l_pointTorso, l_pointNeck, l_pointLShoulder, l_pointRShoulder;
                         l_pointTorso[0] = l_pTorsoTarget->get(1).asDouble();
                         l_pointTorso[1] = l_pTorsoTarget->get(2).asDouble();
                         l_pointTorso[2] = l_pTorsoTarget->get(3).asDouble();
@@ -268,23 +268,23 @@ bool swTeleop::SWIcubTorso::checkBottles()
                         l_pointRShoulder[1] = l_pTorsoTarget->get(11).asDouble();
                         l_pointRShoulder[2] = l_pTorsoTarget->get(12).asDouble();
 
-                        std::vector<double> l_vecTorso      = swUtil::vec(l_pointTorso, l_pointNeck);
-                        std::vector<double> l_vecClavicles  = swUtil::vec(l_pointLShoulder, l_pointRShoulder);
-                        std::vector<double> l_rpyTorso      = swUtil::computeRollPitchYaw(l_vecTorso, l_vecClavicles);
+                        swUtil::Vec3d l_vecTorso      = swUtil::vec(l_pointTorso, l_pointNeck);
+                        swUtil::Vec3d l_vecClavicles  = swUtil::vec(l_pointLShoulder, l_pointRShoulder);
+                        swUtil::Vec3d l_rpyTorso      = swUtil::computeRollPitchYaw(l_vecTorso, l_vecClavicles);
 
                         l_vTorsoJoints[0] = -l_rpyTorso[2];
                         l_vTorsoJoints[1] = l_rpyTorso[0];
                         //~ l_vTorsoJoints[2] = l_rpyTorso[1];
 			
 			
-			std::vector<double> l_pointXaxis(3), l_pointYaxis(3), l_pointZaxis(3), l_pointOrigin(3);
+			swUtil::Vec3d l_pointXaxis, l_pointYaxis, l_pointZaxis, l_pointOrigin;
 			l_pointOrigin[0] = 0.0; l_pointOrigin[1] = 0.0; l_pointOrigin[2] = 0.0; 
 			l_pointXaxis[0] = 1.0; l_pointXaxis[1] = 0.0; l_pointXaxis[2] = 0.0; 
 			l_pointYaxis[0] = 0.0; l_pointYaxis[1] = 1.0; l_pointYaxis[2] = 0.0; 
 			l_pointZaxis[0] = 0.0; l_pointZaxis[1] = 0.0; l_pointZaxis[2] = 1.0; 
-			std::vector<double> l_vecXAxis  = swUtil::vec(l_pointOrigin, l_pointXaxis);
-			std::vector<double> l_vecYAxis  = swUtil::vec(l_pointOrigin, l_pointYaxis);
-			std::vector<double> l_vecZAxis  = swUtil::vec(l_pointOrigin, l_pointZaxis);
+			swUtil::Vec3d l_vecXAxis  = swUtil::vec(l_pointOrigin, l_pointXaxis);
+			swUtil::Vec3d l_vecYAxis  = swUtil::vec(l_pointOrigin, l_pointYaxis);
+			swUtil::Vec3d l_vecZAxis  = swUtil::vec(l_pointOrigin, l_pointZaxis);
 						
 			if (l_vecClavicles[2]>0)
 			{
@@ -33,6 +33,7 @@
 #include "nao/SWTeleoperation_nao.h"
 
 #include "SWTrackingDevice.h"
+#include "SWTrackingMessage.h"
 
 #include <sstream>
 #include <vector>
@@ -163,6 +164,11 @@ bool SWTeleoperation_nao::configure(ResourceFinder &oRf)
             return false;
         }
 
+        if(!m_oLatencyMonitor.open("/teleoperation/nao/latency"))
+        {
+            std::cerr << "-WARNING: the latencies will not be published." << std::endl;
+        }
+
         try
         {
             m_oRobotMotionProxy = new ALMotionProxy(m_sRobotAddress);
@@ -233,6 +239,7 @@ bool SWTeleoperation_nao::interruptModule()
     m_oLeftArmTrackerPort.interrupt();
     m_oRightArmTrackerPort.interrupt();
     m_oFaceTrackerPort.interrupt();
+    m_oLatencyMonitor.interrupt();
 
     std::cout << "--Interrupting the nao Teleoperation module..." << std::endl;
     return true;
@@ -343,6 +350,7 @@ bool SWTeleoperation_nao::close()
     m_oLeftArmTrackerPort.close();
     m_oRightArmTrackerPort.close();
     m_oFaceTrackerPort.close();
+    m_oLatencyMonitor.close();
 
     // set stiffnesses
     if(m_bHeadActivated)
@@ -412,6 +420,7 @@ bool SWTeleoperation_nao::updateModule()
     Bottle *l_pHeadTarget = NULL, *l_pTorsoTarget = NULL, *l_pLeftArmTarget = NULL, *l_pRightArmTarget = NULL, *l_pFaceTarget = NULL;
 
     bool l_bHeadCapture = false, l_bTorsoCapture = false, l_bLeftArmCapture = false, l_bRightArmCapture = false, l_bFaceCapture = false;
+    swTracking::SWCommandLatency l_oHeadLatency, l_oRightArmLatency;
 
     // read head commands
     if(m_bHeadActivated)
@@ -420,7 +429,14 @@ bool SWTeleoperation_nao::updateModule()
 
         if(l_pHeadTarget)
         {
-            int l_deviceId = l_pHeadTarget->get(0).asInt();
+            int64 l_i64ReceiveTime = swTracking::messageTimeUs();
+            swTracking::SWHeadPoseMessage l_oHeadPose;
+            int l_deviceId = swTracking::readMessageDevice(*l_pHeadTarget, l_oHeadPose);
+
+            std::string l_sPath = swTracking::latencyPath("head", l_deviceId);
+            m_oLatencyMonitor.recordMessage(l_sPath, l_oHeadPose.m_oHeader, l_i64ReceiveTime);
+            l_oHeadLatency.received(l_sPath, l_oHeadPose.m_oHeader, l_i64ReceiveTime);
+
             switch(l_deviceId)
             {
                 case swTracking::OPENNI_LIB :
@@ -450,8 +466,8 @@ bool SWTeleoperation_nao::updateModule()
                 break;
                 case swTracking::FOREST_LIB :
                 {                
-                    l_headAngles[0] = swUtil::deg2rad(-l_pHeadTarget->get(2).asDouble());  // HeadYaw -5?
-                    l_headAngles[1] = swUtil::deg2rad(l_pHeadTarget->get(1).asDouble() );  // HeadPitch  -5?
+                    l_headAngles[0] = swUtil::deg2rad(-l_oHeadPose.m_aDRotation[1]);  // HeadYaw -5?
+                    l_headAngles[1] = swUtil::deg2rad(l_oHeadPose.m_aDRotation[0]);   // HeadPitch  -5?
                 }
                 break;
             }
@@ -574,7 +590,13 @@ bool SWTeleoperation_nao::updateModule()
 
         if(l_pRightArmTarget)
         {
-            int l_deviceId = l_pRightArmTarget->get(0).asInt();
+            int64 l_i64ReceiveTime = swTracking::messageTimeUs();
+            swTracking::SWHandSkeletonMessage l_oHand;
+            int l_deviceId = swTracking::readMessageDevice(*l_pRightArmTarget, l_oHand);
+
+            std::string l_sPath = swTracking::latencyPath("right_arm", l_deviceId);
+            m_oLatencyMonitor.recordMessage(l_sPath, l_oHand.m_oHeader, l_i64ReceiveTime);
+            l_oRightArmLatency.received(l_sPath, l_oHand.m_oHeader, l_i64ReceiveTime);
 
             switch(l_deviceId)
             {
@@ -586,12 +608,12 @@ bool SWTeleoperation_nao::updateModule()
                     std::vector<double> l_vArmDirection(3,0.), l_vHandDirection(3,0.),l_vHandDirectionE(3,0.), l_vHandPalmCoord(3,0.), l_vHandPalmNormal(3,0.), l_vHandPalmNormalE(3,0.);
                     for(int ii = 0; ii < 3; ++ii)
                     {
-                        l_vArmDirection[ii]     = l_pRightArmTarget->get(1 + ii).asDouble();
-                        l_vHandDirection[ii]    = l_pRightArmTarget->get(4 + ii).asDouble();
-                        l_vHandDirectionE[ii]   = l_pRightArmTarget->get(7 + ii).asDouble();
-                        l_vHandPalmCoord[ii]    = l_pRightArmTarget->get(10 + ii).asDouble();
-                        l_vHandPalmNormal[ii]   = l_pRightArmTarget->get(13 + ii).asDouble();
-                        l_vHandPalmNormalE[ii]  = l_pRightArmTarget->get(16 + ii).asDouble();
+                        l_vArmDirection[ii]     = l_oHand.m_aDArmDirection[ii];
+                        l_vHandDirection[ii]    = l_oHand.m_aDHandDirection[ii];
+                        l_vHandDirectionE[ii]   = l_oHand.m_aDHandDirectionAngles[ii];
+                        l_vHandPalmCoord[ii]    = l_oHand.m_aDPalmPosition[ii];
+                        l_vHandPalmNormal[ii]   = l_oHand.m_aDPalmNormal[ii];
+                        l_vHandPalmNormalE[ii]  = l_oHand.m_aDPalmNormalAngles[ii];
                     }
 
                     // convert to vec3D
@@ -744,6 +766,7 @@ bool SWTeleoperation_nao::updateModule()
     {
 //        m_oRobotMotionProxy->setAngles(AL::ALValue("Head"), m_aHeadAngles, static_cast<float>(m_dJointVelocityValue));
         m_oRobotMotionProxy->setAngles(l_headNames, l_headAngles, static_cast<float>(m_dJointVelocityValue));
+        l_oHeadLatency.commanded(m_oLatencyMonitor);
     }
 
     if (l_bTorsoCapture)
@@ -759,8 +782,12 @@ bool SWTeleoperation_nao::updateModule()
     if (l_bRightArmCapture)
     {       
         m_oRobotMotionProxy->setAngles(AL::ALValue("RArm"), m_aRArmAngles, static_cast<float>(m_dJointVelocityValue));
+        l_oRightArmLatency.commanded(m_oLatencyMonitor);
     }
 
+    // publish the latencies
+    m_oLatencyMonitor.publish();
+
     std::cout << " <-u\n";
 
     return true;
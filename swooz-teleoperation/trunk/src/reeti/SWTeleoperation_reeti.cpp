@@ -8,10 +8,12 @@
 #include "reeti/SWTeleoperation_reeti.h"
 
 #include "SWTrackingDevice.h"
+#include "SWTrackingMessage.h"
 
 
 #include <cmath>
 #include <iostream>
+#include <algorithm>
 
 #include "geometryUtility.h"
 
@@ -135,6 +137,11 @@ bool SWTeleoperation_reeti::configure(ResourceFinder &oRf)
             return false;
         }
 
+	if(!m_oLatencyMonitor.open("/teleoperation/" + m_sRobotName + "/latency"))
+	{
+		std::cerr << "-WARNING: the latencies will not be published." << std::endl;
+	}
+
 	// creates an urbi client to send commands to the Reeti robot
 	m_pClient=new UClient(m_sRobotAddress, m_i32RobotPort);
 
@@ -154,6 +161,7 @@ bool SWTeleoperation_reeti::interruptModule()
 	m_oHeadTrackerPort.interrupt();
 	m_oFaceTrackerPort.interrupt();
 	m_oGazeTrackerPort.interrupt();
+	m_oLatencyMonitor.interrupt();
 
 	std::cout << "--Interrupting the reeti Teleoperation module..." << std::endl;
 	return true;
@@ -221,6 +229,7 @@ bool SWTeleoperation_reeti::close()
 	m_oHeadTrackerPort.close();
 	m_oFaceTrackerPort.close();
 	m_oGazeTrackerPort.close();
+	m_oLatencyMonitor.close();
   
 	// close urbi m_pClient
 	m_pClient->close();
@@ -245,6 +254,7 @@ bool SWTeleoperation_reeti::updateModule()
 	
 	// defines bottles
 	Bottle *l_pHeadTarget = NULL, *l_pFaceTarget = NULL, *l_pGazeTarget = NULL;
+	swTracking::SWCommandLatency l_oHeadLatency, l_oGazeLatency, l_oFaceLatency;
 	
 	// defines joint values (by default = to neutral position)
 	double l_dNeckRotatValueJoint = m_dNeckRotatNeuValueJoint;
@@ -274,7 +284,13 @@ bool SWTeleoperation_reeti::updateModule()
 		{
 			//std::cout << "Head Bottle received" << std::endl;
 				
-			int l_deviceId = l_pHeadTarget->get(0).asInt();
+			int64 l_i64ReceiveTime = swTracking::messageTimeUs();
+			swTracking::SWHeadPoseMessage l_oHeadPose;
+			int l_deviceId = swTracking::readMessageDevice(*l_pHeadTarget, l_oHeadPose);
+
+			std::string l_sPath = swTracking::latencyPath("head", l_deviceId);
+			m_oLatencyMonitor.recordMessage(l_sPath, l_oHeadPose.m_oHeader, l_i64ReceiveTime);
+			l_oHeadLatency.received(l_sPath, l_oHeadPose.m_oHeader, l_i64ReceiveTime);
 			
 			switch(l_deviceId)
 			{
@@ -294,9 +310,9 @@ bool SWTeleoperation_reeti::updateModule()
 				break;
 				case swTracking::FOREST_LIB :
 				{
-					l_vHeadJoints[0] = -l_pHeadTarget->get(1).asDouble(); //head rotation "yes" 
-					l_vHeadJoints[1] = -l_pHeadTarget->get(3).asDouble(); //head rotation
-					l_vHeadJoints[2] = -l_pHeadTarget->get(2).asDouble(); //head rotation "no"
+					l_vHeadJoints[0] = -l_oHeadPose.m_aDRotation[0]; //head rotation "yes" 
+					l_vHeadJoints[1] = -l_oHeadPose.m_aDRotation[2]; //head rotation
+					l_vHeadJoints[2] = -l_oHeadPose.m_aDRotation[1]; //head rotation "no"
 				}
 				break;
 				case swTracking::COREDATA_LIB :
@@ -308,16 +324,16 @@ bool SWTeleoperation_reeti::updateModule()
 				break;
 				case swTracking::EMICP_LIB :
 				{
-					l_vHeadJoints[0] = -l_pHeadTarget->get(4).asDouble(); 
-					l_vHeadJoints[1] = -l_pHeadTarget->get(6).asDouble(); 
-					l_vHeadJoints[2] = -l_pHeadTarget->get(5).asDouble();
+					l_vHeadJoints[0] = -l_oHeadPose.m_aDRotation[0]; 
+					l_vHeadJoints[1] = -l_oHeadPose.m_aDRotation[2]; 
+					l_vHeadJoints[2] = -l_oHeadPose.m_aDRotation[1];
 				}
 				break;
 				case swTracking::FACESHIFT_LIB :
 				{
-					l_vHeadJoints[0] = -swUtil::rad2Deg(l_pHeadTarget->get(4).asDouble()); 
-					l_vHeadJoints[1] = -swUtil::rad2Deg(l_pHeadTarget->get(6).asDouble());
-					l_vHeadJoints[2] = swUtil::rad2Deg(l_pHeadTarget->get(5).asDouble());
+					l_vHeadJoints[0] = -swUtil::rad2Deg(l_oHeadPose.m_aDRotation[0]); 
+					l_vHeadJoints[1] = -swUtil::rad2Deg(l_oHeadPose.m_aDRotation[2]);
+					l_vHeadJoints[2] = swUtil::rad2Deg(l_oHeadPose.m_aDRotation[1]);
 				}
 				break;
 				case swTracking::OPENNI_LIB :
@@ -373,7 +389,13 @@ bool SWTeleoperation_reeti::updateModule()
 
 		if(l_pGazeTarget)
 		{
-		    	int l_deviceId = l_pGazeTarget->get(0).asInt();
+			int64 l_i64ReceiveTime = swTracking::messageTimeUs();
+			swTracking::SWGazeMessage l_oGaze;
+			int l_deviceId = swTracking::readMessageDevice(*l_pGazeTarget, l_oGaze);
+
+			std::string l_sPath = swTracking::latencyPath("gaze", l_deviceId);
+			m_oLatencyMonitor.recordMessage(l_sPath, l_oGaze.m_oHeader, l_i64ReceiveTime);
+			l_oGazeLatency.received(l_sPath, l_oGaze.m_oHeader, l_i64ReceiveTime);
 
 			switch(l_deviceId)
 			{
@@ -381,14 +403,14 @@ bool SWTeleoperation_reeti::updateModule()
 				case swTracking::FACESHIFT_LIB :
 				{
 					//tilt
-					l_dRightEyeTiltValueJoint =  -l_pGazeTarget->get(3).asDouble() * m_dRightEyeTiltCoeffValueJoint + m_dRightEyeTiltNeuValueJoint; 
-					l_dLeftEyeTiltValueJoint =  -l_pGazeTarget->get(1).asDouble() * m_dLeftEyeTiltCoeffValueJoint + m_dLeftEyeTiltNeuValueJoint; 
+					l_dRightEyeTiltValueJoint =  -l_oGaze.m_dRightPitch * m_dRightEyeTiltCoeffValueJoint + m_dRightEyeTiltNeuValueJoint; 
+					l_dLeftEyeTiltValueJoint =  -l_oGaze.m_dLeftPitch * m_dLeftEyeTiltCoeffValueJoint + m_dLeftEyeTiltNeuValueJoint; 
 					//pan
-					l_dRightEyePanValueJoint =  l_pGazeTarget->get(4).asDouble() * m_dRightEyePanCoeffValueJoint + m_dRightEyePanNeuValueJoint;
-					l_dLeftEyePanValueJoint =  l_pGazeTarget->get(2).asDouble() * m_dLeftEyePanCoeffValueJoint + m_dLeftEyePanNeuValueJoint;
-					//blink
-					l_dRightEyeLidValueJoint=  m_dRightEyeLidNeuValueJoint - l_pGazeTarget->get(6).asDouble()*100; 
-					l_dLeftEyeLidValueJoint =  m_dRightEyeLidNeuValueJoint - l_pGazeTarget->get(5).asDouble()*100; 
+					l_dRightEyePanValueJoint =  l_oGaze.m_dRightYaw * m_dRightEyePanCoeffValueJoint + m_dRightEyePanNeuValueJoint;
+					l_dLeftEyePanValueJoint =  l_oGaze.m_dLeftYaw * m_dLeftEyePanCoeffValueJoint + m_dLeftEyePanNeuValueJoint;
+					//blink (not tracked : eyes open)
+					l_dRightEyeLidValueJoint=  m_dRightEyeLidNeuValueJoint - std::max(l_oGaze.m_dRightBlink, 0.)*100; 
+					l_dLeftEyeLidValueJoint =  m_dRightEyeLidNeuValueJoint - std::max(l_oGaze.m_dLeftBlink, 0.)*100; 
 					
 				}
 				break;
@@ -514,6 +536,8 @@ bool SWTeleoperation_reeti::updateModule()
 		if(l_pFaceTarget)
 		{
 			int l_deviceId = l_pFaceTarget->get(0).asInt();
+			l_oFaceLatency.received(swTracking::latencyPath("face", l_deviceId), swTracking::messageTimeUs());
+
 			switch(l_deviceId)
 			{
 				//std::cout << "Face bottle received" << std::endl;				
@@ -680,6 +704,7 @@ bool SWTeleoperation_reeti::updateModule()
 		//~ std::cout << cmd_neckTilt<< std::endl;
 		//~ std::cout << cmd_neckPan<< std::endl;
 		//std::cout << "-->Head command sent!" << std::endl;
+		l_oHeadLatency.commanded(m_oLatencyMonitor);
 	}
 	// face
 	if(m_bFaceActivated)
@@ -703,6 +728,7 @@ bool SWTeleoperation_reeti::updateModule()
 		m_pClient->send("%s", cmd_rightEar.c_str());
 
 		//std::cout << "-->Face command sent!" << std::endl;
+		l_oFaceLatency.commanded(m_oLatencyMonitor);
 	}
 	// gaze
 	if(m_bGazeActivated)
@@ -728,8 +754,12 @@ bool SWTeleoperation_reeti::updateModule()
 		m_pClient->send("%s", cmd_leftEyeLid.c_str());
 
 		//std::cout << "-->Gaze command sent!" << std::endl;
+		l_oGazeLatency.commanded(m_oLatencyMonitor);
 	}
 
+	// publish the latencies
+	m_oLatencyMonitor.publish();
+
 	return true;
 }
 
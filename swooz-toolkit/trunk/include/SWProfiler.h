@@ -0,0 +1,234 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWProfiler.h
+ * \brief Defines SWProfiler and SWScopedTimer, a per-stage latency instrumentation of the pipelines.
+ * \author Florian Lance
+ * \date 16/10/26
+ *
+ *  Each thread records its stages in its own ring of events (no lock after the first event of the thread), the rings are
+ *  read when exporting a Chrome trace ("chrome://tracing") or computing the stages statistics. The times are given by a
+ *  steady wall clock in microseconds.
+ *
+ *  The profiler is disabled by default and can be enabled at run time with setEnabled or by setting the environment
+ *  variable SWOOZ_PROFILER to 1, a disabled timer only reads a flag.
+ */
+
+#ifndef _SWPROFILER_
+#define _SWPROFILER_
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include "commonTypes.h"
+
+#define SW_PROFILER_RING_SIZE 4096 /**< number of events kept for each thread */
+
+namespace swUtil
+{
+    /**
+     * \struct SWProfileEvent
+     * \brief A recorded stage.
+     */
+    struct SWProfileEvent
+    {
+        const char *m_sStage;   /**< stage name (must be a string literal) */
+        int64 m_i64Start;       /**< start time (us) */
+        int64 m_i64End;         /**< end time (us) */
+    };
+
+    /**
+     * \struct SWProfileStats
+     * \brief Statistics of a stage over the events kept in the rings.
+     */
+    struct SWProfileStats
+    {
+        std::string m_sStage;   /**< stage name */
+        int m_i32Count;         /**< number of events */
+        double m_dMean;         /**< mean duration (ms) */
+        double m_dP50;          /**< median duration (ms) */
+        double m_dP99;          /**< 99th percentile duration (ms) */
+        double m_dMax;          /**< maximum duration (ms) */
+    };
+
+    /**
+     * \class SWProfiler
+     * \brief Collect the stages recorded by the SWScopedTimer of all the threads.
+     */
+    class SWProfiler
+    {
+        public :
+
+            /**
+             * \brief Return the profiler of the process.
+             */
+            static SWProfiler &instance();
+
+            /**
+             * \brief Return a steady time in microseconds (the origin is not specified).
+             */
+            static int64 timeUs();
+
+            /**
+             * \brief Is the recording enabled ?
+             */
+            static bool isEnabled();
+
+            /**
+             * \brief Enable or disable the recording.
+             * \param [in] bEnabled : new state
+             */
+            void setEnabled(cbool bEnabled);
+
+            /**
+             * \brief Record a stage in the ring of the calling thread.
+             * \param [in] sStage   : stage name (must be a string literal)
+             * \param [in] i64Start : start time (us)
+             * \param [in] i64End   : end time (us)
+             */
+            void record(const char *sStage, cint64 i64Start, cint64 i64End);
+
+            /**
+             * \brief Name the calling thread in the Chrome trace.
+             * \param [in] sName : thread name
+             */
+            void setThreadName(const std::string &sName);
+
+            /**
+             * \brief Compute the statistics of each stage over the events kept in the rings.
+             * \param [out] vStats  : statistics sorted by stage name
+             */
+            void stats(std::vector<SWProfileStats> &vStats) const;
+
+            /**
+             * \brief Display the statistics of each stage.
+             */
+            void displayStats() const;
+
+            /**
+             * \brief Save the events kept in the rings in a Chrome trace file (json).
+             * \param [in] sPath : path of the file
+             * \return false if the file can't be written
+             */
+            bool saveChromeTrace(const std::string &sPath) const;
+
+        private :
+
+            /**
+             * \brief SWProfiler constructor.
+             */
+            SWProfiler();
+
+            /**
+             * \brief Copy the events kept in the rings.
+             * \param [out] vEvents     : events of all the threads
+             * \param [out] vThreadIds  : thread index of each event
+             */
+            void collect(std::vector<SWProfileEvent> &vEvents, std::vector<int> &vThreadIds) const;
+
+            SWProfiler(const SWProfiler &);
+            SWProfiler &operator=(const SWProfiler &);
+
+            static volatile bool m_bEnabled;    /**< is the recording enabled ? */
+    };
+
+    /**
+     * \class SWScopedTimer
+     * \brief Record the time spent between its construction and its destruction as a stage.
+     *
+     *  For a sequence of stages in the same scope, next ends the current stage and starts a new one :
+     *  \code
+     *      swUtil::SWScopedTimer l_oTimer("head/background_removal");
+     *      ...
+     *      l_oTimer.next("head/face_detection");
+     *      ...
+     *  \endcode
+     */
+    class SWScopedTimer
+    {
+        public :
+
+            /**
+             * \brief SWScopedTimer constructor, start the stage.
+             * \param [in] sStage : stage name (must be a string literal)
+             */
+            explicit SWScopedTimer(const char *sStage) : m_sStage(sStage), m_i64Start(SWProfiler::isEnabled() ? SWProfiler::timeUs() : -1)
+            {}
+
+            /**
+             * \brief SWScopedTimer destructor, end the current stage.
+             */
+            ~SWScopedTimer()
+            {
+                stop();
+            }
+
+            /**
+             * \brief End the current stage and start a new one.
+             * \param [in] sStage : stage name (must be a string literal)
+             */
+            void next(const char *sStage)
+            {
+                int64 l_i64Time = -1;
+
+                if(m_i64Start >= 0)
+                {
+                    l_i64Time = SWProfiler::timeUs();
+                    SWProfiler::instance().record(m_sStage, m_i64Start, l_i64Time);
+                }
+                else if(SWProfiler::isEnabled())
+                {
+                    l_i64Time = SWProfiler::timeUs();
+                }
+
+                m_sStage   = sStage;
+                m_i64Start = l_i64Time;
+            }
+
+            /**
+             * \brief End the current stage, nothing is recorded after.
+             */
+            void stop()
+            {
+                if(m_i64Start >= 0)
+                {
+                    SWProfiler::instance().record(m_sStage, m_i64Start, SWProfiler::timeUs());
+                    m_i64Start = -1;
+                }
+            }
+
+        private :
+
+            SWScopedTimer(const SWScopedTimer &);
+            SWScopedTimer &operator=(const SWScopedTimer &);
+
+            const char *m_sStage;   /**< current stage name */
+            int64 m_i64Start;       /**< start time of the current stage, -1 if not recording */
+    };
+};
+
+#endif
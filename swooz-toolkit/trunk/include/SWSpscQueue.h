@@ -0,0 +1,149 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWSpscQueue.h
+ * \brief Defines SWSpscQueue, a bounded lock-free queue between two threads.
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#ifndef _SWSPSCQUEUE_
+#define _SWSPSCQUEUE_
+
+#include <vector>
+#include <iostream>
+
+#include "commonTypes.h"
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+    // x86 and x64 keep the order of the stores and of the loads, only the compiler must not reorder them
+    #define SW_RING_BARRIER() _ReadWriteBarrier()
+#else
+    #define SW_RING_BARRIER() __sync_synchronize()
+#endif
+
+namespace swUtil
+{
+    /**
+     * \class SWSpscQueue
+     * \brief Bounded lock-free queue with a single producer thread and a single consumer thread.
+     *
+     *  The elements are copied in a ring of preallocated slots, a slot keeps its element until the producer reuses it
+     *  (a cv::Mat or a shared pointer stays referenced until then). push and pop never block, the caller decides
+     *  to wait, to retry or to drop when the queue is full or empty.
+     */
+    template<typename T>
+    class SWSpscQueue
+    {
+        public :
+
+            /**
+             * \brief SWSpscQueue constructor.
+             * \param [in] ui32Capacity : maximum number of elements in the queue
+             */
+            explicit SWSpscQueue(cuint ui32Capacity) : m_vRing(ui32Capacity > 0 ? ui32Capacity : 1), m_ui32PushedId(0), m_ui32PoppedId(0)
+            {}
+
+            /**
+             * \brief Push a copy of an element, must only be called by the producer thread.
+             * \param [in] oElement : element to push
+             * \return false if the queue is full (the element is not pushed)
+             */
+            bool push(const T &oElement)
+            {
+                uint l_ui32PushedId = m_ui32PushedId;
+
+                if(l_ui32PushedId - m_ui32PoppedId >= m_vRing.size())
+                {
+                    return false;
+                }
+
+                // the slot must not be filled before the consumer has released it
+                SW_RING_BARRIER();
+                m_vRing[l_ui32PushedId % m_vRing.size()] = oElement;
+
+                // the element must be visible before the new index
+                SW_RING_BARRIER();
+                m_ui32PushedId = l_ui32PushedId + 1;
+
+                return true;
+            }
+
+            /**
+             * \brief Pop the oldest element, must only be called by the consumer thread.
+             * \param [out] oElement : popped element
+             * \return false if the queue is empty
+             */
+            bool pop(T &oElement)
+            {
+                uint l_ui32PoppedId = m_ui32PoppedId;
+
+                if(l_ui32PoppedId == m_ui32PushedId)
+                {
+                    return false;
+                }
+
+                // the element must not be read before the index
+                SW_RING_BARRIER();
+                oElement = m_vRing[l_ui32PoppedId % m_vRing.size()];
+
+                // the slot must be read before being released
+                SW_RING_BARRIER();
+                m_ui32PoppedId = l_ui32PoppedId + 1;
+
+                return true;
+            }
+
+            /**
+             * \brief Number of elements waiting in the queue (approximate if called during a push or a pop).
+             */
+            uint size() const
+            {
+                return m_ui32PushedId - m_ui32PoppedId;
+            }
+
+            /**
+             * \brief Maximum number of elements in the queue.
+             */
+            uint capacity() const
+            {
+                return static_cast<uint>(m_vRing.size());
+            }
+
+        private :
+
+            SWSpscQueue(const SWSpscQueue &);
+            SWSpscQueue &operator=(const SWSpscQueue &);
+
+            std::vector<T> m_vRing;         /**< preallocated slots */
+
+            volatile uint m_ui32PushedId;   /**< number of elements pushed, only modified by the producer */
+            volatile uint m_ui32PoppedId;   /**< number of elements popped, only modified by the consumer */
+    };
+};
+
+#endif
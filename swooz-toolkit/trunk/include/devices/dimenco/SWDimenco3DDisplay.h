@@ -47,6 +47,9 @@
 
 /**
  * @brief The SWDimenco3DDisplay class
+ *
+ * refresh composes the rgb image and the disparity in one pass, directly at their final positions in a persistent
+ * output frame (padded rgb | padded disparity, one zero line after each line, 3D header in the blue bytes of the first line).
  */
 class SWDimenco3DDisplay
 {
@@ -92,15 +95,15 @@ class SWDimenco3DDisplay
 
         /**
          * @brief refresh
-         * @param rgbImg
-         * @param depthImg
+         * @param rgbImg    : bgr image (CV_8UC3), smaller than the display image
+         * @param depthImg  : normalized depth (CV_32FC1, see SWKinect::normalizedDepthMap), smaller than the display image
          */
 		void refresh(const cv::Mat& rgbImg, const cv::Mat& depthImg);
 
         /**
-         * @brief depth2disparity
-         * @param depthImg
-         * @param disparityImg
+         * @brief depth2disparity, with the look-up table built by init
+         * @param depthImg      : normalized depth (CV_32FC1)
+         * @param disparityImg  : disparity copied in each channel (CV_8UC3, same size)
          */
 		void depth2disparity(const cv::Mat& depthImg, cv::Mat& disparityImg);
 
@@ -127,7 +130,7 @@ class SWDimenco3DDisplay
 		void addZeroLines(const cv::Mat& inputImg, cv::Mat& outputImg);
 
         /**
-         * @brief add3DHeader
+         * @brief add3DHeader, write the header bits encoded once in the blue bytes of the first line
          * @param img
          */
 		void add3DHeader( cv::Mat& img );
@@ -139,6 +142,24 @@ class SWDimenco3DDisplay
          * @param len
          */
 		void embedBlueBit7B(unsigned char *data, unsigned char *hd, int len);
+
+	private :
+
+        /**
+         * @brief buildDisparityLut, disparity of each quantized normalized depth with the display constants
+         */
+        void buildDisparityLut();
+
+        /**
+         * @brief encode3DHeader, values of the blue bytes carrying the 3D header
+         */
+        void encode3DHeader();
+
+        cv::Mat m_oOutputFrame;                 /**< persistent output frame (2 * displayImgWidth, 2 * displayImgHeight, CV_8UC3) */
+        cv::Size m_oRgbSize;                    /**< size of the previous rgb image, the output frame is cleared when it changes */
+        cv::Size m_oDepthSize;                  /**< size of the previous depth image, the output frame is cleared when it changes */
+        std::vector<uchar> m_vDisparityLut;     /**< disparity of each quantized normalized depth */
+        std::vector<uchar> m_vHeaderBlueBytes;  /**< blue bytes of the header, one every two pixels of the first line */
 };
 
 #endif
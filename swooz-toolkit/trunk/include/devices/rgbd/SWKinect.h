@@ -39,12 +39,29 @@
 #include "commonTypes.h"
 
 #include <iostream>
+#include <vector>
 
 namespace swDevice
 {
+    /**
+     * \brief Channels retrieved by SWKinect::grab, can be combined.
+     */
+    enum SWKinectChannel
+    {
+        KINECT_DEPTH_MAP            = 1,    /**< depthMap */
+        KINECT_DISPARITY_MAP        = 2,    /**< disparityMap */
+        KINECT_BGR_IMAGE            = 4,    /**< bgrImage */
+        KINECT_CLOUD_MAP            = 8,    /**< cloudMap */
+        KINECT_GRAY_IMAGE           = 16,   /**< grayImage */
+        KINECT_NORMALIZED_DEPTH_MAP = 32,   /**< normalizedDepthMap (the depth map is retrieved too) */
+        KINECT_ALL_CHANNELS         = 63    /**< all the channels */
+    };
+
     /**
      * \class SWKinect
      * \brief A hight level interface for getting data from a kinect/xtion device.
+     *
+     * init, grab, sizeFrame and fps are virtual so that a simulated device (see SWKinectSimulator) can replace the sensor.
      */
     class SWKinect
     {
@@ -58,6 +75,7 @@ namespace swDevice
             int  m_i32XCalibrate;           /**< the X offset that must be applied to the rgb data to fit the depth data */
             int  m_i32YCalibrate;           /**< the Y offset that must be applied to the rgb data to fit the depth data */
             int  m_i32CaptureMode;          /**< kinect capture video mode */
+            int  m_i32Channels;             /**< channels retrieved at each grab (SWKinectChannel combination) */
 
             cv::Mat disparityMap; 	/**< Disparity map CV_CAP_OPENNI_DISPARITY_MAP   : Disparity in pixels (CV_8UC1) */
             cv::Mat cloudMap;       /**< Cloud map     CV_CAP_OPENNI_POINT_CLOUD_MAP : XYZ in meters       (CV_32FC3)*/
@@ -82,7 +100,7 @@ namespace swDevice
              * \return 0 if the device contains image generator, else -1
              * \throw kinectInitError
              */
-            int init(cint i32CaptureMode = 0);
+            virtual int init(cint i32CaptureMode = 0);
 
             /**
              * \brief Set the recalibration between the rgb data and the depth data.
@@ -93,14 +111,28 @@ namespace swDevice
             void setRecalibration(cbool bRecalib, cint i32XCalibrate, cint i32YCalibrate);
 
             /**
-             * \brief Grab a new frame from the device, init must have been called before.
+             * \brief Set the channels retrieved at each grab, the mats of the other channels are released.
+             * \param [in] i32Channels : SWKinectChannel combination (KINECT_ALL_CHANNELS by default)
+             */
+            void setChannels(cint i32Channels);
+
+            /**
+             * \brief Return the channels retrieved at each grab.
+             * \return SWKinectChannel combination
+             */
+            int channels() const;
+
+            /**
+             * \brief Grab a new frame from the device and retrieve the channels set with setChannels, init must have been called before.
+             *
+             * The mats of the retrieved channels are valid until the next grab (they may point to the buffers of the capture).
              * \return 0 if the new frame is correctly grabbed, else return -1
              * \throw kinectInitError, kinectGrabError
              */
-            int grab(void);
+            virtual int grab(void);
 
             /**
-             * \brief Recalibrate the rgb data with the calibration parameters.
+             * \brief Recalibrate the rgb data with the calibration parameters (the bgr image is shifted by the offsets, the uncovered borders are black).
              */
             void recalibrate();
 
@@ -110,20 +142,31 @@ namespace swDevice
              * in order to be certain to get the good value, retrieve the size from the SWKinect cv::Mat after a grab.
              * \return the cv size value
              */
-            cv::Size sizeFrame();
+            virtual cv::Size sizeFrame();
 
             /**
              * \brief Get the number of frame per second for the current kinect video mode
              * Warning : may not necessary return the correct fps with devices like the ASUS xtion pro.
              * \return the fps number
              */
-            int fps();
+            virtual int fps();
 
-            // TODO Coment normalize stuff
-            int minDepthValue;
-            int maxDepthValue ;
-            cv::Mat normalizedDepthMap;
+            int minDepthValue;              /**< depth normalized to 0 (mm) */
+            int maxDepthValue ;             /**< depth normalized to 1 (mm) */
+            cv::Mat normalizedDepthMap;     /**< Normalized depth map : depth between minDepthValue and maxDepthValue mapped to [0,1] (CV_32FC1) */
+
+            /**
+             * \brief Compute normalizedDepthMap from depthMap, with a look-up table rebuilt only when minDepthValue or maxDepthValue change.
+             */
             void normalizeDepthImage(void);
+
+        private :
+
+            cv::Mat m_oRecalibratedBgrImage;    /**< recalibrated bgr image buffer, shared by bgrImage after a recalibration */
+
+            std::vector<float> m_vDepthLut;     /**< normalized value of each depth */
+            int m_i32LutMinDepth;               /**< minDepthValue used for m_vDepthLut */
+            int m_i32LutMaxDepth;               /**< maxDepthValue used for m_vDepthLut */
     };
 }
 
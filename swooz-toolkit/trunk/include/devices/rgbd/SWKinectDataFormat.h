@@ -0,0 +1,151 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWKinectDataFormat.h
+ * \brief Defines the cloud recording file format used by SWSaveKinectData and SWLoadKinectData.
+ * \author Florian Lance
+ * \date 16/10/26
+ *
+ *  File "cloud.swk" :
+ *      - SWKinectFileHeader
+ *      - frames : SWKinectFrameHeader followed by m_ui32PayloadSize bytes
+ *      - index  : SWKinectIndexHeader followed by m_i32FramesNb SWKinectIndexEntry (written by SWSaveKinectData::stop)
+ *      - SWKinectFileTrailer
+ *
+ *  The frames are appended, so the file grows with the recording. If the recording has not been stopped properly
+ *  the index and the trailer are missing, the loader then rebuilds the index by reading the frames headers.
+ *
+ *  Frame codecs :
+ *      - SW_KINECT_DEPTH_CODEC  : the depth is stored in millimeters, coded with a left pixel prediction and a Rice code
+ *        (one parameter per row), x and y are computed from the depth with the projection of the frame :
+ *        x = (p0 * u + p1) * z, y = (p2 * v + p3) * z. Used when the depth of the cloud is made of millimeters values
+ *        (which is the case of the kinect) and when the projection reproduces x and y (error < SW_KINECT_PROJECTION_TOLERANCE).
+ *      - SW_KINECT_POINTS_CODEC : the valid points are stored as [id, x, y, z], used for the other clouds.
+ */
+
+#ifndef _SWKINECTDATAFORMAT_
+#define _SWKINECTDATAFORMAT_
+
+#include <vector>
+#include <iostream>
+
+#include "opencv2/core/core.hpp"
+
+#include "commonTypes.h"
+
+#define SW_KINECT_FILE_MAGIC    "SWKCLOUD"
+#define SW_KINECT_FILE_VERSION  1
+#define SW_KINECT_FRAME_MAGIC   0x4D415246 /**< "FRAM" */
+#define SW_KINECT_INDEX_MAGIC   0x58444E49 /**< "INDX" */
+#define SW_KINECT_TRAILER_MAGIC 0x444E454B /**< "KEND" */
+
+#define SW_KINECT_DEPTH_CODEC   0
+#define SW_KINECT_POINTS_CODEC  1
+
+#define SW_KINECT_PROJECTION_TOLERANCE 0.0001f /**< maximum error (m) of the projection for x and y with the depth codec */
+
+namespace swDevice
+{
+    /**
+     * \struct SWKinectFileHeader
+     * \brief Header of a cloud recording file.
+     */
+    struct SWKinectFileHeader
+    {
+        char m_aCMagic[8];          /**< SW_KINECT_FILE_MAGIC */
+        int m_i32Version;           /**< SW_KINECT_FILE_VERSION */
+        int m_i32Reserved;          /**< unused */
+    };
+
+    /**
+     * \struct SWKinectFrameHeader
+     * \brief Header of a recorded cloud.
+     */
+    struct SWKinectFrameHeader
+    {
+        uint m_ui32Magic;           /**< SW_KINECT_FRAME_MAGIC */
+        int m_i32Frame;             /**< id of the frame */
+        float m_fTime;              /**< time since the start of the recording (s) */
+        int m_i32Codec;             /**< SW_KINECT_DEPTH_CODEC or SW_KINECT_POINTS_CODEC */
+        int m_i32Width;             /**< width of the cloud map */
+        int m_i32Height;            /**< height of the cloud map */
+        float m_a4FProjection[4];   /**< projection used by the depth codec */
+        uint m_ui32PayloadSize;     /**< size of the coded cloud */
+    };
+
+    /**
+     * \struct SWKinectIndexHeader
+     * \brief Header of the index of the frames.
+     */
+    struct SWKinectIndexHeader
+    {
+        uint m_ui32Magic;           /**< SW_KINECT_INDEX_MAGIC */
+        int m_i32FramesNb;          /**< number of entries */
+    };
+
+    /**
+     * \struct SWKinectIndexEntry
+     * \brief Position of a frame in the file.
+     */
+    struct SWKinectIndexEntry
+    {
+        int64 m_i64Offset;          /**< offset of the frame header from the beginning of the file */
+        float m_fTime;              /**< time of the frame */
+        int m_i32Frame;             /**< id of the frame */
+    };
+
+    /**
+     * \struct SWKinectFileTrailer
+     * \brief End of a cloud recording file.
+     */
+    struct SWKinectFileTrailer
+    {
+        int64 m_i64IndexOffset;     /**< offset of the index header */
+        int m_i32FramesNb;          /**< number of frames */
+        uint m_ui32Magic;           /**< SW_KINECT_TRAILER_MAGIC */
+    };
+
+    /**
+     * \brief Code a cloud map.
+     * \param [in] oCloud       : cloud map (cv::Vec3f)
+     * \param [in] fMinDist     : minimum depth of the saved points
+     * \param [in] fMaxDist     : maximum depth of the saved points
+     * \param [out] oHeader     : frame header (codec, size, projection and payload size are set)
+     * \param [out] vPayload    : coded cloud
+     */
+    void encodeKinectCloud(const cv::Mat &oCloud, cfloat fMinDist, cfloat fMaxDist, SWKinectFrameHeader &oHeader, std::vector<uchar> &vPayload);
+
+    /**
+     * \brief Decode a cloud map.
+     * \param [in] oHeader      : frame header
+     * \param [in] aUi8Payload  : coded cloud
+     * \param [out] oCloud      : cloud map (cv::Vec3f), the points not saved are set to 0
+     * \return false if the payload is corrupted
+     */
+    bool decodeKinectCloud(const SWKinectFrameHeader &oHeader, const uchar *aUi8Payload, cv::Mat &oCloud);
+};
+
+#endif
@@ -0,0 +1,245 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWKinectSimulator.h
+ * \brief Defines SWKinectSimulator
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#ifndef _SWKINECTSIMULATOR_
+#define _SWKINECTSIMULATOR_
+
+#include "devices/rgbd/SWKinect.h"
+
+#include "boost/shared_ptr.hpp"
+
+namespace swDevice
+{
+    class SWLoadKinectData;
+
+    /**
+     * \brief Pace of the frames produced by SWKinectSimulator.
+     */
+    enum SWSimulationRate
+    {
+        SIMULATION_REAL_TIME,           /**< frames produced at the recording times, or at the fps of the capture mode */
+        SIMULATION_AS_FAST_AS_POSSIBLE, /**< no waiting between the frames */
+        SIMULATION_LOCK_STEP            /**< no waiting in the device, SWKinect_thread waits for the consumption of each frame */
+    };
+
+    /**
+     * \class SWKinectSimulator
+     * \brief A virtual rgbd device replacing the sensor behind SWKinect (and then SWKinect_thread).
+     *
+     *  The frames are replayed from a SWSaveKinectData recording, or rendered on the CPU from a mesh (an avatar obj file or
+     *  a procedural head) moved by a scripted head motion in front of a wall. The content of a frame only depends on its id,
+     *  two runs produce the same frames whatever the rate and the consumers. The bgr image and the cloud map are always produced,
+     *  the depth, disparity, gray and normalized depth maps are computed from them only when their channel is asked.
+     *
+     *  SWKinect_thread uses a simulator instead of the sensor when the SWOOZ_RGBD_SIMULATOR environment variable is set (see fromEnvironment).
+     */
+    class SWKinectSimulator : public SWKinect
+    {
+        public:
+
+            /**
+             * \brief SWKinectSimulator constructor, the default source is the procedural head.
+             * \param [in] bVerbose : display informations
+             */
+            SWKinectSimulator(bool bVerbose = true);
+
+            /**
+             * \brief SWKinectSimulator destructor.
+             */
+            virtual ~SWKinectSimulator(void);
+
+            /**
+             * \brief Create a simulator from the environment variables, return a NULL pointer if SWOOZ_RGBD_SIMULATOR is not set.
+             *
+             *  SWOOZ_RGBD_SIMULATOR        : recording directory, obj file, or "head" for the procedural head
+             *  SWOOZ_RGBD_SIMULATOR_RATE   : "realtime" (default), "fastest" or "lockstep"
+             *  SWOOZ_RGBD_SIMULATOR_FRAMES : number of frames before the end of the simulation (0 by default, see setFramesNumber)
+             *  SWOOZ_RGBD_SIMULATOR_MOTION : head motion script file (see setMotionScript)
+             * \param [in] bVerbose : display informations
+             * \return the simulator
+             */
+            static boost::shared_ptr<SWKinectSimulator> fromEnvironment(bool bVerbose = true);
+
+            /**
+             * \brief Replay a SWSaveKinectData recording (bgr.avi and cloud files).
+             * \param [in] sRecordingPath : directory of the recording
+             * \return false if the recording can't be loaded
+             */
+            bool setRecording(const std::string &sRecordingPath);
+
+            /**
+             * \brief Render a mesh, the texture of the material (map_Kd) is used if available.
+             * \param [in] sObjPath : obj file path, empty for the procedural head
+             * \return false if the mesh can't be loaded
+             */
+            bool setMesh(const std::string &sObjPath);
+
+            /**
+             * \brief Set the head motion of the rendered mesh.
+             * \param [in] sScriptPath : text file with one key pose per line : "time(s) pitch yaw roll(degrees) tx ty tz(meters)",
+             *                           the poses are linearly interpolated and the script is looped, empty for the default sinusoidal motion
+             * \return false if the file can't be read
+             */
+            bool setMotionScript(const std::string &sScriptPath);
+
+            /**
+             * \brief Set the pace of the frames.
+             * \param [in] eRate : simulation rate
+             */
+            void setRate(const SWSimulationRate eRate);
+
+            /**
+             * \brief Return the pace of the frames.
+             */
+            SWSimulationRate rate() const;
+
+            /**
+             * \brief Set the number of frames produced before the end of the simulation.
+             * \param [in] ui32FramesNb : 0 to stop at the end of the recording (never for a rendered mesh), else the recording is looped
+             */
+            void setFramesNumber(cuint ui32FramesNb);
+
+            /**
+             * \brief Is the simulation ended ? (grab returns -1 without exception)
+             */
+            bool isEnded() const;
+
+            /**
+             * \brief Return the number of frames produced.
+             */
+            uint frameId() const;
+
+            /**
+             * \brief Return the head pose of a rendered frame (ground truth for the trackers).
+             * \param [in]  ui32FrameId     : id of the frame (starting at 0)
+             * \param [out] oRotation       : pitch, yaw, roll (degrees)
+             * \param [out] oTranslation    : position of the center of the mesh in the cloud map coordinates (meters)
+             * \return false if the frames are replayed from a recording
+             */
+            bool headPose(cuint ui32FrameId, cv::Vec3f &oRotation, cv::Vec3f &oTranslation) const;
+
+            /**
+             * \brief Init the simulated device.
+             * \param [in] i32CaptureMode : kinect video mode, defines the frame size (QVGA for 3 and 4, else VGA) and the fps
+             * \return 0
+             */
+            virtual int init(cint i32CaptureMode = 0);
+
+            /**
+             * \brief Produce the next frame, init must have been called before.
+             * \return 0 if the new frame is produced, -1 if the simulation is ended
+             * \throw kinectInitError
+             */
+            virtual int grab(void);
+
+            /**
+             * \brief Get the frame size of the simulated video mode (the size of a replayed recording is the recorded one).
+             */
+            virtual cv::Size sizeFrame();
+
+            /**
+             * \brief Get the number of frame per second of the simulated video mode.
+             */
+            virtual int fps();
+
+        private :
+
+            /**
+             * \brief (Re)open the recording from its first frame.
+             */
+            void openRecording();
+
+            /**
+             * \brief Read the next frame of the recording, reopened when looped.
+             * \param [out] dTime : time of the frame since the start of the simulation (s)
+             * \return false if the recording is ended
+             */
+            bool grabRecording(double &dTime);
+
+            /**
+             * \brief Render the mesh at the head pose of a frame in bgrImage and cloudMap.
+             * \param [in] ui32FrameId : id of the frame
+             */
+            void render(cuint ui32FrameId);
+
+            /**
+             * \brief Compute the asked channels which are not produced directly from the bgr image and the cloud map.
+             */
+            void computeChannels();
+
+            /**
+             * \brief Build the procedural head mesh.
+             */
+            void buildProceduralHead();
+
+            /**
+             * \brief Time of a frame since the start of the simulation (s).
+             */
+            double frameTime(cuint ui32FrameId) const;
+
+            // simulation
+            SWSimulationRate m_eRate;           /**< pace of the frames */
+            uint m_ui32FramesNb;                /**< number of frames before the end, 0 for the end of the recording */
+            uint m_ui32FrameId;                 /**< number of frames produced */
+            bool m_bEnded;                      /**< is the simulation ended ? */
+            int64 m_i64StartTime;               /**< time of the first frame (us), -1 before the first grab */
+            cv::Size m_oFrameSize;              /**< size of the simulated video mode */
+            int m_i32Fps;                       /**< fps of the simulated video mode */
+
+            // recording
+            std::string m_sRecordingPath;                       /**< recording directory, empty if the mesh is rendered */
+            boost::shared_ptr<SWLoadKinectData> m_pRecording;   /**< recording loader */
+            uint m_ui32RecordingFrame;                          /**< id of the next frame in the current pass of the recording */
+            double m_dRecordingOffset;                          /**< time of the start of the current pass (s) */
+            double m_dLastRecordingTime;                        /**< time of the last replayed frame (s) */
+
+            // mesh
+            std::vector<cv::Vec3f> m_vMeshVertices;     /**< vertices centered on the mesh (meters, y up, face towards -z) */
+            std::vector<cv::Vec3b> m_vMeshColors;       /**< bgr color of the vertices, used without texture */
+            std::vector<cv::Vec2f> m_vMeshUV;           /**< texture coordinates */
+            std::vector<cv::Vec3i> m_vMeshTriangles;    /**< vertex ids of the triangles */
+            std::vector<cv::Vec3i> m_vMeshTrianglesUV;  /**< texture coordinates ids of the triangles */
+            cv::Mat m_oMeshTexture;                     /**< texture (bgr), empty for the vertex colors */
+
+            // motion
+            std::vector<float> m_vMotionTimes;          /**< times of the key poses (s) */
+            std::vector<cv::Vec3f> m_vMotionRotations;  /**< rotations of the key poses (degrees) */
+            std::vector<cv::Vec3f> m_vMotionTranslations;  /**< translations of the key poses (meters) */
+
+            // rendering buffers
+            cv::Mat m_oZBuffer;                         /**< depth of the rendered pixels (meters) */
+            std::vector<cv::Vec3f> m_vTransformed;      /**< vertices in the cloud map coordinates */
+            std::vector<cv::Vec3f> m_vProjected;        /**< projected vertices (u, v, z) */
+    };
+}
+
+#endif
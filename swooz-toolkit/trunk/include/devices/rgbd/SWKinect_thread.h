@@ -33,14 +33,44 @@
 #ifndef _SWKINECT_THREAD_
 #define _SWKINECT_THREAD_
 
+#include <time.h>
+
 #include "SWKinect.h"
 #include "devices/SWDevice_thread.h"
 
 namespace swDevice
 {
+	class SWSaveKinectData_thread;
+
+	/**
+	 * \struct SWKinectFrame
+	 * \brief The data of a kinect grab, shared without copy between the listening thread and the consumers.
+	 *
+	 * A published frame is never modified : the listening thread reuses its buffers only when no consumer
+	 * holds the frame or one of its cv::Mat anymore. The consumers must not write in the mats.
+	 */
+	struct SWKinectFrame
+	{
+		uint m_ui32Id;			/**< sequence number of the frame, starting at 1 */
+		clock_t m_oTime;		/**< clock() value at the grab */
+		int64 m_i64GrabTime;		/**< time at the end of the grab (us, see swUtil::SWProfiler::timeUs) */
+		int m_i32Channels;		/**< channels retrieved (SWKinectChannel combination), the mats of the other channels are empty */
+
+		cv::Mat m_oDisparityMap; 	/**< Disparity map CV_CAP_OPENNI_DISPARITY_MAP   : Disparity in pixels (CV_8UC1) */
+		cv::Mat m_oCloudMap; 	 	/**< Cloud map     CV_CAP_OPENNI_POINT_CLOUD_MAP : XYZ in meters       (CV_32FC3)*/
+		cv::Mat m_oBgrImage;	 	/**< BGR image	   CV_CAP_OPENNI_BGR_IMAGE       : rgb color pixels    (CV_8UC3) */
+		cv::Mat m_oDepthMap;	 	/**< Depth map	   CV_CAP_OPENNI_DEPTH_MAP       : Depth values in mm  (CV_16UC1)*/
+		cv::Mat m_oGrayImage;	 	/**< Gray image    CV_CAP_OPENNI_GRAY_IMAGE	 : gray image		(CV_8UC1) */
+	};
+
+	typedef boost::shared_ptr<const SWKinectFrame> SWKinectFramePtr; /**< immutable shared kinect frame */
+
 	/**
 	 * \class SWKinect_thread
 	 * \brief A threaded kinect module.
+	 *
+	 * The device is a SWKinect, or a SWKinectSimulator when the SWOOZ_RGBD_SIMULATOR environment variable is set
+	 * (see SWKinectSimulator::fromEnvironment), so that the consumers run unchanged without sensor.
 	 */	
 	class SWKinect_thread : public SWDevice_thread
 	{
@@ -51,6 +81,13 @@ namespace swDevice
              * \param [in] bVerbose : display informations
 			 */	
             SWKinect_thread(bool bVerbose = true);
+
+			/**
+			 * \brief SWKinect_thread constructor with a given device (a SWKinectSimulator for example).
+			 * \param [in] pDevice   : device grabbed by the listening thread
+			 * \param [in] bLockStep : see setLockStep
+			 */
+			SWKinect_thread(boost::shared_ptr<SWKinect> pDevice, cbool bLockStep = false);
 		
 			/**
 			 * \brief SWKinect_thread destructor.
@@ -82,6 +119,42 @@ namespace swDevice
 			 * \param [in] i32YCalibrate : set the Y offset
 			 */				
 			void setRecalibration(cbool bRecalib, cint i32XCalibrate, cint i32YCalibrate);
+
+			/**
+			 * \brief Set the channels retrieved by the listening thread, the consumers declare the channels they use.
+			 * \param [in] i32Channels : SWKinectChannel combination, all the channels of SWKinectFrame by default
+			 *                           (KINECT_NORMALIZED_DEPTH_MAP is ignored, the bgr image and the cloud map are added while a recorder is set)
+			 */
+			void setChannels(cint i32Channels);
+
+			/**
+			 * \brief Enable the lock-step mode : the listening thread grabs a new frame only when the previous one has been
+			 *        returned by frame or waitFrame (or the accessors). Used with a simulated device for deterministic runs.
+			 * \param [in] bLockStep : enable or disable the lock-step mode
+			 */
+			void setLockStep(cbool bLockStep);
+
+			/**
+			 * \brief Set a recorder fed with every grabbed frame (bgr image and cloud map) by the listening thread.
+			 * \param [in] pRecorder : started recorder, NULL to stop feeding it (must be done before stopping the recorder)
+			 *
+			 * The listening thread becomes the only producer of the recorder, save must not be called from another thread.
+			 */
+			void setRecorder(SWSaveKinectData_thread *pRecorder);
+
+			/**
+			 * \brief Get the last grabbed frame without copying it.
+			 * \return the frame, or a NULL pointer if no data is available
+			 */
+			SWKinectFramePtr frame();
+
+			/**
+			 * \brief Wait for a frame more recent than the input one.
+			 * \param [in] ui32LastId   : sequence number of the last frame processed by the caller (0 for the first call)
+			 * \param [in] i32TimeOutMs : maximum waiting time in milliseconds
+			 * \return the last grabbed frame, or a NULL pointer if the timeout is reached or if the listening is stopped
+			 */
+			SWKinectFramePtr waitFrame(cuint ui32LastId, cint i32TimeOutMs = 1000);
 			
 			/**
 			 * \brief Safe accessor for kinect disparityMap.
@@ -142,21 +215,37 @@ namespace swDevice
 		
 		private :
 
-			cv::Mat m_oDisparityMap; /**< Disparity map CV_CAP_OPENNI_DISPARITY_MAP   : Disparity in pixels (CV_8UC1) */
-			cv::Mat m_oCloudMap; 	 /**< Cloud map     CV_CAP_OPENNI_POINT_CLOUD_MAP : XYZ in meters       (CV_32FC3)*/
-			cv::Mat m_oBgrImage;	 /**< BGR image	    CV_CAP_OPENNI_BGR_IMAGE       : rgb color pixels    (CV_8UC3) */
-			cv::Mat m_oDepthMap;	 /**< Depth map	    CV_CAP_OPENNI_DEPTH_MAP       : Depth values in mm  (CV_16UC1)*/
-			cv::Mat m_oGrayImage;	 /**< Gray image    CV_CAP_OPENNI_GRAY_IMAGE	  : gray image		(CV_8UC1) */		
-			
 			/**
 			 * \brief Work thread.
 			 */		
 			void doWork();
+
+			/**
+			 * \brief Get a frame of the pool which is not used anymore by the consumers, or a new one.
+			 * \return frame to fill
+			 */
+			boost::shared_ptr<SWKinectFrame> availableFrame();
+
+			/**
+			 * \brief Mark the last frame as consumed, m_oMutex must be locked.
+			 */
+			void consumed();
+
+			int m_i32Channels;					/**< channels asked by the consumers */
+			uint m_ui32FrameId;					/**< sequence number of the last frame */
+			bool m_bLockStep;					/**< wait for the consumption of each frame before grabbing the next one ? */
+			uint m_ui32ConsumedId;					/**< sequence number of the last frame returned to a consumer */
+			boost::condition_variable m_oConsumedCondition;		/**< notified when a frame is returned to a consumer in lock-step mode */
+			boost::shared_ptr<SWKinectFrame> m_pFrame;		/**< last frame */
+			std::vector<boost::shared_ptr<SWKinectFrame> > m_vFramePool;	/**< frames reused by the listening thread */
+			boost::condition_variable m_oFrameCondition;		/**< notified at each new frame */
 		
 			bool m_bInitialized;	/**< is the module initialized ? */
 			bool m_bDataAvailable;	/**< is the data available ? */
+
+			SWSaveKinectData_thread *m_pRecorder; /**< recorder fed by the listening thread */
 		
-			SWKinect m_oKinect; 	/**< kinect module */
+			boost::shared_ptr<SWKinect> m_pKinect; 	/**< kinect module, or simulated device */
 	};
 };
 
@@ -46,14 +46,17 @@
 
 // SWOOZ
 #include "SWExceptions.h"
+#include "devices/rgbd/SWKinectDataFormat.h"
 
 
-namespace swDevice // TODO : document data format
+namespace swDevice
 {
     /**
      * \class SWLoadKinectData
      * \brief This class allows to load kinect data in realtime. (see SWSaveKinectData)
      *
+     *  The clouds are read from the "cloud.swk" file (see SWKinectDataFormat.h) which allows random access,
+     *  or from the mapped files of the previous recordings format.
      */
     class SWLoadKinectData
     {
@@ -94,13 +97,46 @@ namespace swDevice // TODO : document data format
              */
             bool grabCloud(cv::Mat &oCloud);
 
+            /**
+             * \brief Return the number of recorded clouds, -1 if unknown (previous recordings format).
+             */
+            int cloudFramesNumber() const;
+
+            /**
+             * \brief Return the recording time of a cloud.
+             * \param [in] i32Frame : id of the cloud
+             * \return the time since the start of the recording in seconds, -1 if unknown
+             */
+            float cloudTime(cint i32Frame) const;
+
+            /**
+             * \brief Set the next cloud to be grabbed, the video is moved to the same frame.
+             * \param [in] i32Frame : id of the cloud
+             * \return false if the cloud does not exist, if the recording is not a "cloud.swk" file or if the video cannot be moved
+             */
+            bool seekCloud(cint i32Frame);
+
 
         private :
 
+            /**
+             * \brief Open the "cloud.swk" file and read its index, or rebuild it if the recording was not stopped properly.
+             * \return false if the file cannot be read
+             */
+            bool openCloudFile();
+
+            /**
+             * \brief Grab the next cloud of the "cloud.swk" file.
+             */
+            bool grabCompressedCloud(cv::Mat &oCloud);
+
+
             bool m_bInit;                    /**< is the data initialized ? */
             bool m_bIsCloudData;             /**< is cloud data available ?*/
             bool m_bIsVideoData;             /**< is video data available ? */
 
+            bool m_bIsCompressedCloudData;   /**< is the cloud data in the "cloud.swk" file ? */
+
             std::string m_sLoadingPath;  	 /**< loading path for mapped files */
 
             cv::VideoCapture m_oVideoCapture;/**< video capture */
@@ -130,6 +166,11 @@ namespace swDevice // TODO : document data format
             float   *m_oCloudData;          /**< cloud data number pointer */
             float   *m_oCloudTimeKinect;    /**< cloud time number pointer */
 
+            // cloud file
+            std::ifstream m_oCloudFile;                     /**< "cloud.swk" file */
+            std::vector<SWKinectIndexEntry> m_vCloudIndex;  /**< position of the clouds in the file */
+            std::vector<uchar> m_vPayload;                  /**< coded cloud buffer */
+
     };
 
 };
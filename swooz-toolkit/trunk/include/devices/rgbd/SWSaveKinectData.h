@@ -36,8 +36,8 @@
 
 // UTILITY
 #include <string>
+#include <fstream>
 #include <time.h>
-#include <boost/iostreams/device/mapped_file.hpp>
 
 // OPENCV
 #include "opencvUtility.h"
@@ -45,6 +45,7 @@
 
 // SWOOZ
 #include "SWExceptions.h"
+#include "devices/rgbd/SWKinectDataFormat.h"
 
 
 namespace swDevice
@@ -53,9 +54,9 @@ namespace swDevice
 	 * \class SWSaveKinectData
 	 * \brief This class allows to save kinect data in realtime.
 	 *  
-     *  Video kinect data is saved in an avi file and cloud kinect data in mapped files.
+     *  Video kinect data is saved in an avi file and cloud kinect data in a growing compressed file (see SWKinectDataFormat.h).
 	 */	
-    class SWSaveKinectData // TODO : document data format
+    class SWSaveKinectData
 	{
 
 		public :
@@ -64,7 +65,7 @@ namespace swDevice
 			 * \brief SWSaveKinectData constructor.
 			 * \param [in] sSavingPath 	: path where the data will be saved
 			 * \param [in] dMaxLenght 	: maximum length of the saving
-             * \param [in] dMaxSize 	: maximum size of the saving in Go (counting all mapped files)
+             * \param [in] dMaxSize 	: maximum size of the cloud saving in Go
              * \param [in] dMinDist 	: minimum distance for a point of the input kinect cloud to be saved
              * \param [in] dMaxDist 	: maximum distance for a point of the input kinect cloud to be saved
 			 */
@@ -105,8 +106,31 @@ namespace swDevice
              */
             bool save(const cv::Mat &oData);
 
+            /**
+             * \brief Save the input data captured at the input time.
+             * \param [in] oData1 	: cloud point mat (cv::Vec3f) or bgr image mat (cv::Vec3b)
+             * \param [in] oData2 	: cloud point mat (cv::Vec3f) or bgr image mat (cv::Vec3b)
+             * \param [in] oFrameTime : clock() value at the capture of the data
+             * \return false it the recording is ended, else return true
+             */
+            bool save(const cv::Mat &oData1, const cv::Mat &oData2, const clock_t oFrameTime);
+
+            /**
+             * \brief Save the input data captured at the input time.
+             * \param [in] oData 	: cloud point mat (cv::Vec3f) or rgb image mat (cv::Vec3b)
+             * \param [in] oFrameTime : clock() value at the capture of the data
+             * \return false it the recording is ended, else return true
+             */
+            bool save(const cv::Mat &oData, const clock_t oFrameTime);
+
+            /**
+             * \brief Indicates if the recording is running.
+             * \return true if start has been called and the recording is not ended
+             */
+            bool isRecording() const;
+
 			/**
-			 * \brief Stop the saving (mapped data files closed).
+			 * \brief Stop the saving (index of the clouds written and files closed).
 			 */			
 			void stop();
 
@@ -122,8 +146,9 @@ namespace swDevice
             /**
              * \brief Save cloud input data.
              * \param [in] oCloud 	: cloud point mat (cv::Vec3f)
+             * \param [in] oFrameTime : clock() value at the capture of the cloud
              */
-            void saveCloud(const cv::Mat &oCloud);
+            void saveCloud(const cv::Mat &oCloud, const clock_t oFrameTime);
 
 		
 		private :
@@ -132,45 +157,24 @@ namespace swDevice
             bool m_bSaveVideoData;          /**< is the video data will be saved ? */
             bool m_bSaveCloudData;          /**< is the cloud data will be saved ? */		
 
-            double m_dMaxSize;              /**< maximum size of the saving (counting all mapped files) */
+            double m_dMaxSize;              /**< maximum size of the cloud saving */
             double m_dMaxLength;            /**< maximum length of the saving */
             double m_dMinDist;              /**< minimum distance for a point of the input kinect cloud to be saved */
             double m_dMaxDist;              /**< maximum distance for a point of the input kinect cloud to be saved */
 		
-            std::string m_sSavingPath;  	/**< saving path for mapped files */
+            std::string m_sSavingPath;  	/**< saving path for the files */
 
             clock_t m_oProgramTime;         /**< starting time of the record */
 
             // opencv writer parameters
             cv::VideoWriter m_oVideoWriter;	/**< video writer for saving kinect rgb data */
 
-            // mapped files parameters
-            //      numbers
-            int m_i32NumPoint;                      /**< current number of saved cloud points */
-            int m_i32NumFile;                       /**< current number of data and index mapped file */
-            int m_i32NumCloud;                      /**< current number of saved cloud */
-            int m_i32CurrentDataSizeWritten;        /**< current size already written in the data mapped file */
-            int m_i32CurrentIndexSizeWritten;       /**< current size already written in the index mapped file */
-            int m_i32NumFrame;                      /**< total number of saved cloud */
-            long long m_lCurrentTotalSizeWritten;   /**< total current size already written in the data mapped file */
-            //      params files
-            boost::iostreams::mapped_file_params m_oCloudDataFileParams;        /**< cloud data mapped param file  */
-            boost::iostreams::mapped_file_params m_oCloudIndexFileParams;       /**< cloud index mapped param file  */
-            boost::iostreams::mapped_file_params m_oCloudHeaderFileParams;      /**< cloud header mapped param file */
-            boost::iostreams::mapped_file_params m_oCloudSizeFileParams;        /**< cloud size mapped param file  */
-            boost::iostreams::mapped_file_params m_oCloudTimeKinectFileParams;  /**< cloud time mapped param file  */
-            //      sink files
-            boost::iostreams::mapped_file_sink m_oCloudDataFile;                /**< cloud data mapped file  */
-            boost::iostreams::mapped_file_sink m_oCloudIndexFile;               /**< cloud index mapped file  */
-            boost::iostreams::mapped_file_sink m_oCloudSizeFile;                /**< cloud header mapped file */
-            boost::iostreams::mapped_file_sink m_oCloudTimeKinectFile;          /**< cloud size mapped file  */
-            boost::iostreams::mapped_file_sink m_oCloudHeaderFile;              /**< cloud time mapped file  */
-            //      data pointers
-            int     *m_i32HeaderNumber;     /**< cloud head number pointer */
-            int     *m_oCloudSize;          /**< cloud size number pointer */
-            int     *m_oCloudIndex;     	/**< cloud index number pointer */
-            float   *m_oCloudData;          /**< cloud data number pointer */
-            float   *m_oCloudTimeKinect;    /**< cloud time number pointer */
+            // cloud file
+            int m_i32NumFrame;                              /**< total number of saved cloud */
+            long long m_lCurrentTotalSizeWritten;           /**< total current size already written in the cloud file */
+            std::ofstream m_oCloudFile;                     /**< cloud file */
+            std::vector<SWKinectIndexEntry> m_vCloudIndex;  /**< position of the saved clouds in the file */
+            std::vector<uchar> m_vPayload;                  /**< coded cloud buffer */
 	};
 };
 
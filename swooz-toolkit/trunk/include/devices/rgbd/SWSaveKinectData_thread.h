@@ -0,0 +1,182 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWSaveKinectData_thread.h
+ * \brief Defines SWSaveKinectData_thread
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#ifndef _SWSAVEKINECTDATA_THREAD_
+#define _SWSAVEKINECTDATA_THREAD_
+
+#include <vector>
+
+#include "boost/thread.hpp"
+
+#include "devices/rgbd/SWSaveKinectData.h"
+#include "SWSpscQueue.h"
+
+namespace swDevice
+{
+    /**
+     * \class SWSaveKinectData_thread
+     * \brief Save kinect data in a dedicated writer thread.
+     *
+     *  The frames given to save are copied in a ring of preallocated buffers, the writer thread encodes them with a
+     *  SWSaveKinectData (MJPG video and compressed clouds). The ring is lock-free with a single producer and a single
+     *  consumer : save must always be called from the same thread (for example the grabbing thread of SWKinect_thread,
+     *  see SWKinect_thread::setRecorder). When the ring is full the new frame is dropped and counted instead of
+     *  blocking the capture.
+     */
+    class SWSaveKinectData_thread
+    {
+        public :
+
+            /**
+             * \brief SWSaveKinectData_thread constructor.
+             * \param [in] sSavingPath 	: path where the data will be saved
+             * \param [in] dMaxLength 	: maximum length of the saving
+             * \param [in] dMaxSize 	: maximum size of the cloud saving in Go
+             * \param [in] dMinDist 	: minimum distance for a point of the input kinect cloud to be saved
+             * \param [in] dMaxDist 	: maximum distance for a point of the input kinect cloud to be saved
+             * \param [in] i32RingSize  : number of preallocated frames between the capture and the writer thread
+             */
+            SWSaveKinectData_thread(const std::string &sSavingPath, const double dMaxLength = 60.0, const double dMaxSize = 20,
+                                    const double dMinDist = 0.4f, const double dMaxDist = 2.f, cint i32RingSize = 16);
+
+            /**
+             * \brief SWSaveKinectData_thread destructor, the frames remaining in the ring are written.
+             */
+            ~SWSaveKinectData_thread();
+
+            /**
+             * \brief Start the saving and the writer thread.
+             * \param [in] bSaveVideoData 	: is the video data will be saved ?
+             * \param [in] bSaveCloudData 	: is the cloud data will be saved ?
+             * \return false if the files can't be created
+             */
+            bool start(const bool bSaveVideoData = true, const bool bSaveCloudData = true);
+
+            /**
+             * \brief Push the input data in the ring.
+             * \param [in] oData1 	: cloud point mat (cv::Vec3f) or bgr image mat (cv::Vec3b)
+             * \param [in] oData2 	: cloud point mat (cv::Vec3f) or bgr image mat (cv::Vec3b)
+             * \return false if the recording is ended, else return true (even if the frame has been dropped)
+             */
+            bool save(const cv::Mat &oData1, const cv::Mat &oData2);
+
+            /**
+             * \brief Push the input data in the ring.
+             * \param [in] oData 	: cloud point mat (cv::Vec3f) or bgr image mat (cv::Vec3b)
+             * \return false if the recording is ended, else return true (even if the frame has been dropped)
+             */
+            bool save(const cv::Mat &oData);
+
+            /**
+             * \brief Write the frames remaining in the ring, stop the writer thread and close the files.
+             */
+            void stop();
+
+            /**
+             * \brief Indicates if the recording is running.
+             * \return false if the recording has not been started or is ended (time's up, size reached, writing error)
+             */
+            bool isRecording() const;
+
+            /**
+             * \brief Number of frames pushed in the ring.
+             */
+            int pushedFramesNumber() const;
+
+            /**
+             * \brief Number of frames dropped because the ring was full.
+             */
+            int droppedFramesNumber() const;
+
+            /**
+             * \brief Number of frames written by the writer thread.
+             */
+            int writtenFramesNumber() const;
+
+            /**
+             * \brief Maximum number of frames waiting in the ring since the start, a value close to the ring size means
+             *        that the writer thread can't follow the capture.
+             */
+            int maxQueuedFramesNumber() const;
+
+            /**
+             * \brief Display the drop and backpressure counters.
+             */
+            void displayCounters() const;
+
+        private :
+
+            /**
+             * \brief Writer thread.
+             */
+            void doWork();
+
+            /**
+             * \brief Push a frame in the ring.
+             * \param [in] pBgr     : bgr image mat, NULL if no image
+             * \param [in] pCloud   : cloud point mat, NULL if no cloud
+             * \return false if the recording is ended
+             */
+            bool push(const cv::Mat *pBgr, const cv::Mat *pCloud);
+
+            /**
+             * \struct SWKinectFrameSlot
+             * \brief A preallocated frame of the ring.
+             */
+            struct SWKinectFrameSlot
+            {
+                bool m_bBgr;            /**< is the slot containing a bgr image ? */
+                bool m_bCloud;          /**< is the slot containing a cloud ? */
+                clock_t m_oTime;        /**< capture time */
+                cv::Mat m_oBgr;         /**< bgr image (CV_8UC3) */
+                cv::Mat m_oCloud;       /**< cloud map (CV_32FC3) */
+            };
+
+            SWSaveKinectData m_oSaver;                      /**< saver used by the writer thread */
+
+            std::vector<SWKinectFrameSlot> m_vRing;         /**< preallocated frames */
+
+            volatile uint m_ui32PushedId;                   /**< number of frames pushed, only modified by the producer */
+            volatile uint m_ui32WrittenId;                  /**< number of frames consumed, only modified by the writer thread */
+
+            volatile bool m_bWriting;                       /**< is the writer thread running ? */
+            volatile bool m_bRecording;                     /**< is the saver still recording ? */
+
+            int m_i32DroppedFrames;                         /**< frames dropped because the ring was full */
+            int m_i32MaxQueuedFrames;                       /**< maximum number of frames waiting in the ring */
+            volatile int m_i32WrittenFrames;                /**< frames written by the saver */
+
+            boost::shared_ptr<boost::thread> m_pWriterThread;   /**< writer thread */
+    };
+};
+
+#endif
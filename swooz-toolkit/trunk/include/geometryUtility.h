@@ -342,6 +342,386 @@ namespace swUtil
     {
         return angle > 180 ? degree180(angle - 360) : (angle <= -180 ? degree180(angle + 360) : angle);
     }
+
+    /**
+     * \struct Vec3
+     * \brief Fixed size 3D vector, replaces the 3-size std::vector in the per vertex computations (no heap allocation).
+     *
+     *  The components are contiguous and without padding, an array of Vec3<float> has the same layout as the
+     *  [x0, y0, z0, x1, y1, z1, ...] arrays of the meshes.
+     */
+    template <typename T>
+    struct Vec3
+    {
+        T x; /**< x component */
+        T y; /**< y component */
+        T z; /**< z component */
+
+        /**
+         * \brief Default constructor, the components are not initialized (like a built-in type).
+         */
+        Vec3() {}
+
+        /**
+         * \brief Constructor with the components.
+         */
+        Vec3(const T tX, const T tY, const T tZ) : x(tX), y(tY), z(tZ) {}
+
+        /**
+         * \brief Constructor with a 3-size array.
+         */
+        explicit Vec3(const T *aT) : x(aT[0]), y(aT[1]), z(aT[2]) {}
+
+        /**
+         * \brief Constructor with a 3-size std::vector.
+         */
+        explicit Vec3(const std::vector<T> &vT) : x(vT[0]), y(vT[1]), z(vT[2]) {}
+
+        T &operator[](cuint ui32Id)             { return (&x)[ui32Id]; }
+        const T &operator[](cuint ui32Id) const { return (&x)[ui32Id]; }
+
+        /**
+         * \brief Convert to a 3-size std::vector (for the interfaces still using them).
+         */
+        std::vector<T> toVector() const
+        {
+            std::vector<T> l_vT(3);
+            l_vT[0] = x; l_vT[1] = y; l_vT[2] = z;
+            return l_vT;
+        }
+
+        Vec3 operator-() const                  { return Vec3(-x, -y, -z); }
+        Vec3 operator+(const Vec3 &oV) const    { return Vec3(x + oV.x, y + oV.y, z + oV.z); }
+        Vec3 operator-(const Vec3 &oV) const    { return Vec3(x - oV.x, y - oV.y, z - oV.z); }
+        Vec3 operator*(const T tVal) const      { return Vec3(x * tVal, y * tVal, z * tVal); }
+        Vec3 operator/(const T tVal) const      { return Vec3(x / tVal, y / tVal, z / tVal); }
+
+        Vec3 &operator+=(const Vec3 &oV)        { x += oV.x; y += oV.y; z += oV.z; return *this; }
+        Vec3 &operator-=(const Vec3 &oV)        { x -= oV.x; y -= oV.y; z -= oV.z; return *this; }
+        Vec3 &operator*=(const T tVal)          { x *= tVal; y *= tVal; z *= tVal; return *this; }
+        Vec3 &operator/=(const T tVal)          { x /= tVal; y /= tVal; z /= tVal; return *this; }
+    };
+
+    typedef Vec3<float>  Vec3f; /**< float 3D vector */
+    typedef Vec3<double> Vec3d; /**< double 3D vector */
+
+    /**
+     * \struct Mat3
+     * \brief Fixed size 3x3 matrix, row major.
+     */
+    template <typename T>
+    struct Mat3
+    {
+        T m[9]; /**< coefficients [r0c0, r0c1, r0c2, r1c0, ...] */
+
+        /**
+         * \brief Default constructor, the coefficients are not initialized.
+         */
+        Mat3() {}
+
+        /**
+         * \brief Constructor with a 9-size row major array.
+         */
+        explicit Mat3(const T *aT)
+        {
+            for(int ii = 0; ii < 9; ++ii)
+            {
+                m[ii] = aT[ii];
+            }
+        }
+
+        /**
+         * \brief Return the identity matrix.
+         */
+        static Mat3 identity()
+        {
+            Mat3 l_oMat;
+            for(int ii = 0; ii < 9; ++ii)
+            {
+                l_oMat.m[ii] = (ii % 4 == 0) ? T(1) : T(0);
+            }
+            return l_oMat;
+        }
+
+        T &operator()(cuint ui32Row, cuint ui32Col)             { return m[3*ui32Row + ui32Col]; }
+        const T &operator()(cuint ui32Row, cuint ui32Col) const { return m[3*ui32Row + ui32Col]; }
+
+        Vec3<T> operator*(const Vec3<T> &oV) const
+        {
+            return Vec3<T>(m[0]*oV.x + m[1]*oV.y + m[2]*oV.z,
+                           m[3]*oV.x + m[4]*oV.y + m[5]*oV.z,
+                           m[6]*oV.x + m[7]*oV.y + m[8]*oV.z);
+        }
+
+        Mat3 operator*(const Mat3 &oM) const
+        {
+            Mat3 l_oMat;
+            for(int ii = 0; ii < 3; ++ii)
+            {
+                for(int jj = 0; jj < 3; ++jj)
+                {
+                    l_oMat.m[3*ii + jj] = m[3*ii]*oM.m[jj] + m[3*ii + 1]*oM.m[3 + jj] + m[3*ii + 2]*oM.m[6 + jj];
+                }
+            }
+            return l_oMat;
+        }
+
+        /**
+         * \brief Return the transposed matrix (the inverse for a rotation matrix).
+         */
+        Mat3 transpose() const
+        {
+            Mat3 l_oMat;
+            for(int ii = 0; ii < 3; ++ii)
+            {
+                for(int jj = 0; jj < 3; ++jj)
+                {
+                    l_oMat.m[3*jj + ii] = m[3*ii + jj];
+                }
+            }
+            return l_oMat;
+        }
+    };
+
+    typedef Mat3<float>  Mat3f; /**< float 3x3 matrix */
+    typedef Mat3<double> Mat3d; /**< double 3x3 matrix */
+
+    /**
+     * \struct Quaternion
+     * \brief Rotation quaternion w + xi + yj + zk.
+     */
+    template <typename T>
+    struct Quaternion
+    {
+        T w; /**< real part */
+        T x; /**< i component */
+        T y; /**< j component */
+        T z; /**< k component */
+
+        /**
+         * \brief Default constructor, the components are not initialized.
+         */
+        Quaternion() {}
+
+        /**
+         * \brief Constructor with the components.
+         */
+        Quaternion(const T tW, const T tX, const T tY, const T tZ) : w(tW), x(tX), y(tY), z(tZ) {}
+
+        /**
+         * \brief Build the rotation around an axis.
+         * \param [in] oAxis    : normalized axis
+         * \param [in] tAngle   : angle in radians
+         */
+        static Quaternion fromAxisAngle(const Vec3<T> &oAxis, const T tAngle)
+        {
+            T l_tSin = static_cast<T>(sin(tAngle * 0.5));
+            return Quaternion(static_cast<T>(cos(tAngle * 0.5)), oAxis.x * l_tSin, oAxis.y * l_tSin, oAxis.z * l_tSin);
+        }
+
+        Quaternion operator*(const Quaternion &oQ) const
+        {
+            return Quaternion(w*oQ.w - x*oQ.x - y*oQ.y - z*oQ.z,
+                              w*oQ.x + x*oQ.w + y*oQ.z - z*oQ.y,
+                              w*oQ.y - x*oQ.z + y*oQ.w + z*oQ.x,
+                              w*oQ.z + x*oQ.y - y*oQ.x + z*oQ.w);
+        }
+
+        Quaternion conjugate() const
+        {
+            return Quaternion(w, -x, -y, -z);
+        }
+
+        void normalize()
+        {
+            T l_tNorm = static_cast<T>(sqrt(w*w + x*x + y*y + z*z));
+            w /= l_tNorm; x /= l_tNorm; y /= l_tNorm; z /= l_tNorm;
+        }
+
+        /**
+         * \brief Return the rotation matrix of the normalized quaternion.
+         */
+        Mat3<T> toMat3() const
+        {
+            Mat3<T> l_oMat;
+            l_oMat.m[0] = 1 - 2*(y*y + z*z); l_oMat.m[1] = 2*(x*y - w*z);     l_oMat.m[2] = 2*(x*z + w*y);
+            l_oMat.m[3] = 2*(x*y + w*z);     l_oMat.m[4] = 1 - 2*(x*x + z*z); l_oMat.m[5] = 2*(y*z - w*x);
+            l_oMat.m[6] = 2*(x*z - w*y);     l_oMat.m[7] = 2*(y*z + w*x);     l_oMat.m[8] = 1 - 2*(x*x + y*y);
+            return l_oMat;
+        }
+
+        /**
+         * \brief Rotate the input vector with the normalized quaternion.
+         */
+        Vec3<T> rotate(const Vec3<T> &oV) const
+        {
+            // v + 2w(q x v) + 2q x (q x v)
+            Vec3<T> l_oQ(x, y, z);
+            Vec3<T> l_oT(2*(l_oQ.y*oV.z - l_oQ.z*oV.y), 2*(l_oQ.z*oV.x - l_oQ.x*oV.z), 2*(l_oQ.x*oV.y - l_oQ.y*oV.x));
+            return oV + l_oT * w + Vec3<T>(l_oQ.y*l_oT.z - l_oQ.z*l_oT.y, l_oQ.z*l_oT.x - l_oQ.x*l_oT.z, l_oQ.x*l_oT.y - l_oQ.y*l_oT.x);
+        }
+    };
+
+    typedef Quaternion<float>  Quaternionf; /**< float quaternion */
+    typedef Quaternion<double> Quaterniond; /**< double quaternion */
+
+    // ############################################# Vec3 versions of the std::vector functions
+
+    template <typename T>
+    inline void inverse(Vec3<T> &v)
+    {
+        v = -v;
+    }
+
+    template <typename T>
+    inline void add(Vec3<T> &v1, const Vec3<T> &v2)
+    {
+        v1 += v2;
+    }
+
+    template <typename T>
+    inline Vec3<T> mul(const Vec3<T> &v, const T dVal)
+    {
+        return v * dVal;
+    }
+
+    template <typename T>
+    inline Vec3<T> vec(const Vec3<T> &v1, const Vec3<T> &v2)
+    {
+        return v2 - v1;
+    }
+
+    template <typename T>
+    inline T squareLength(const Vec3<T> &v)
+    {
+        return v.x * v.x + v.y * v.y + v.z * v.z;
+    }
+
+    template <typename T>
+    inline T norm(const Vec3<T> &v)
+    {
+        return sqrt(squareLength(v));
+    }
+
+    template <typename T>
+    inline void normalize(Vec3<T> &v)
+    {
+        v /= norm(v);
+    }
+
+    template <typename T>
+    inline T dotProduct(const Vec3<T> &v1, const Vec3<T> &v2)
+    {
+        return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+    }
+
+    /**
+     * \brief Cross product with the same orientation as the std::vector version : return v2 x v1.
+     */
+    template <typename T>
+    inline Vec3<T> crossProduct(const Vec3<T> &v1, const Vec3<T> &v2)
+    {
+        return Vec3<T>(v2.y * v1.z - v2.z * v1.y,
+                       v2.z * v1.x - v2.x * v1.z,
+                       v2.x * v1.y - v2.y * v1.x);
+    }
+
+    template <typename T>
+    inline double vectorAngle(const Vec3<T> &v1, const Vec3<T> &v2)
+    {
+        return acos(dotProduct(v1,v2)/((double)norm(v1)*(double)norm(v2))) * 180.0 / PI;
+    }
+
+    /**
+     * \brief Vec3 version of segmentTriangleIntersect, see the std::vector version.
+     */
+    template <typename T>
+    static int segmentTriangleIntersect(const Vec3<T> &vP,  const Vec3<T> &vD,
+                                        const Vec3<T> &vV0, const Vec3<T> &vV1, const Vec3<T> &vV2, Vec3<T> &intersectPoint)
+    {
+        Vec3<T> l_vU = vec(vV0, vV1); // triangle vectors
+        Vec3<T> l_vV = vec(vV0, vV2);
+        Vec3<T> l_vN = crossProduct(l_vU, l_vV);
+
+        if(l_vN.x == 0.0 && l_vN.y == 0.0 && l_vN.z == 0.0)
+        {
+            return -1; // triangle is degenerate
+        }
+
+        Vec3<T> l_vDir = vec(vP, vD); // ray direction vector
+        Vec3<T> l_vW0  = vec(vV0, vP);
+
+        T l_TA = - dotProduct(l_vN, l_vW0);
+        T l_TB =   dotProduct(l_vN, l_vDir);
+
+        if(fabs(l_TB) < 0.00000001) // ray is  parallel to triangle plane
+        {
+            if(l_TA == 0)
+            {
+                return 0; // ray lies in triangle plane
+            }
+            else
+            {
+                return 2; // ray disjoint from plane
+            }
+        }
+
+        // get intersect point of ray with triangle plane
+        T l_TR = l_TA / l_TB;
+
+        if(l_TR < 0.0 || l_TR > 1.0) // ray goes away from triangle or segment too short
+        {
+            return 0; // no intersect
+        }
+
+        intersectPoint = l_vDir * l_TR + vP; // intersect point of ray and plane
+
+        // is I inside T?
+        T l_TUU = dotProduct(l_vU, l_vU);
+        T l_TUV = dotProduct(l_vU, l_vV);
+        T l_TVV = dotProduct(l_vV, l_vV);
+
+        Vec3<T> l_vW = intersectPoint - vV0;
+
+        T l_TWU = dotProduct(l_vW, l_vU);
+        T l_TWV = dotProduct(l_vW, l_vV);
+        T l_TD  = l_TUV * l_TUV - l_TUU * l_TVV;
+
+        // get and test parametric coords
+        T l_TS = (l_TUV * l_TWV - l_TVV * l_TWU) / l_TD;
+        if(l_TS <= 0.0 || l_TS >= 1.0)
+        {
+            return 0; // intersection point is outside
+        }
+        T l_TT = (l_TUV * l_TWU - l_TUU * l_TWV) / l_TD;
+        if(l_TT <= 0.0 || (l_TS + l_TT >= 1.0))
+        {
+            return 0; // intersection point is outside
+        }
+
+        return 1; // intersection point is inside
+    }
+
+    /*
+     * \brief Vec3 version of computeRollPitchYaw, see the std::vector version.
+     * \return [roll, pitch, yaw] in degrees
+     */
+    template <typename T>
+    Vec3<T> computeRollPitchYaw(const Vec3<T> &vecAxis, const Vec3<T> &vecRotation)
+    {
+        const Vec3<T> vecUp(0, 1, 0);
+        const Vec3<T> vecLeft(1, 0, 0);
+
+        const Vec3<T> vecAxisX(0, vecAxis.y, vecAxis.z);
+        const Vec3<T> vecAxisZ(vecAxis.x, vecAxis.y, 0);
+
+        Vec3<T> roll_pitch_yaw;
+        roll_pitch_yaw.y = static_cast<T>((vecAxisX.z >= 0 ? -1 : 1) * vectorAngle(vecAxisX, vecUp));
+        roll_pitch_yaw.x = static_cast<T>((vecAxisZ.x >= 0 ? -1 : 1) * vectorAngle(vecAxisZ, vecUp));
+        roll_pitch_yaw.z = static_cast<T>((vecRotation.y >= 0 ? 1 : -1) * vectorAngle(vecRotation, vecLeft));
+
+        return roll_pitch_yaw;
+    }
 }
 
 #endif
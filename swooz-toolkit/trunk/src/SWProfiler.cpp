@@ -0,0 +1,315 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWProfiler.cpp
+ * \brief Defines SWProfiler
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#include "SWProfiler.h"
+#include "SWSpscQueue.h"
+
+#include <map>
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "boost/thread.hpp"
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+using namespace swUtil;
+
+/**
+ * \struct SWProfilerRing
+ * \brief Events of a thread, written only by this thread.
+ */
+struct SWProfilerRing
+{
+    SWProfileEvent m_aEvents[SW_PROFILER_RING_SIZE];    /**< last events */
+    volatile uint m_ui32PushedNb;                       /**< number of events recorded since the creation of the ring */
+    int m_i32Id;                                        /**< thread index in the trace */
+    std::string m_sName;                                /**< thread name */
+};
+
+static void noRingCleanup(SWProfilerRing *) {} // the rings are kept after the end of their thread to be exported
+
+static boost::mutex g_oRingsMutex;                                  /**< protects g_vRings */
+static std::vector<SWProfilerRing*> g_vRings;                       /**< rings of all the threads */
+static boost::thread_specific_ptr<SWProfilerRing> g_pThreadRing(noRingCleanup); /**< ring of the current thread */
+
+/**
+ * \brief Return the ring of the calling thread, created at the first call.
+ */
+static SWProfilerRing *threadRing()
+{
+    SWProfilerRing *l_pRing = g_pThreadRing.get();
+
+    if(!l_pRing)
+    {
+        l_pRing = new SWProfilerRing();
+        l_pRing->m_ui32PushedNb = 0;
+
+        boost::mutex::scoped_lock l_oLock(g_oRingsMutex);
+        l_pRing->m_i32Id = static_cast<int>(g_vRings.size());
+        g_vRings.push_back(l_pRing);
+        g_pThreadRing.reset(l_pRing);
+    }
+
+    return l_pRing;
+}
+
+static bool environmentEnabled()
+{
+    const char *l_sValue = getenv("SWOOZ_PROFILER");
+    return l_sValue != NULL && strcmp(l_sValue, "0") != 0;
+}
+
+volatile bool SWProfiler::m_bEnabled = environmentEnabled();
+
+SWProfiler::SWProfiler()
+{}
+
+SWProfiler &SWProfiler::instance()
+{
+    static SWProfiler l_oProfiler;
+    return l_oProfiler;
+}
+
+int64 SWProfiler::timeUs()
+{
+#if defined(_WIN32)
+    static LARGE_INTEGER l_oFrequency = {0};
+    if(l_oFrequency.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&l_oFrequency);
+    }
+
+    LARGE_INTEGER l_oCounter;
+    QueryPerformanceCounter(&l_oCounter);
+
+    return (l_oCounter.QuadPart / l_oFrequency.QuadPart) * 1000000 + ((l_oCounter.QuadPart % l_oFrequency.QuadPart) * 1000000) / l_oFrequency.QuadPart;
+#else
+    timespec l_oTime;
+    clock_gettime(CLOCK_MONOTONIC, &l_oTime);
+
+    return static_cast<int64>(l_oTime.tv_sec) * 1000000 + l_oTime.tv_nsec / 1000;
+#endif
+}
+
+bool SWProfiler::isEnabled()
+{
+    return m_bEnabled;
+}
+
+void SWProfiler::setEnabled(cbool bEnabled)
+{
+    m_bEnabled = bEnabled;
+}
+
+void SWProfiler::record(const char *sStage, cint64 i64Start, cint64 i64End)
+{
+    SWProfilerRing *l_pRing = threadRing();
+    uint l_ui32PushedNb     = l_pRing->m_ui32PushedNb;
+
+    SWProfileEvent &l_oEvent = l_pRing->m_aEvents[l_ui32PushedNb % SW_PROFILER_RING_SIZE];
+    l_oEvent.m_sStage  = sStage;
+    l_oEvent.m_i64Start= i64Start;
+    l_oEvent.m_i64End  = i64End;
+
+    // the event must be written before the new count is visible
+    SW_RING_BARRIER();
+    l_pRing->m_ui32PushedNb = l_ui32PushedNb + 1;
+}
+
+void SWProfiler::setThreadName(const std::string &sName)
+{
+    SWProfilerRing *l_pRing = threadRing();
+
+    boost::mutex::scoped_lock l_oLock(g_oRingsMutex);
+    l_pRing->m_sName = sName;
+}
+
+void SWProfiler::collect(std::vector<SWProfileEvent> &vEvents, std::vector<int> &vThreadIds) const
+{
+    vEvents.clear();
+    vThreadIds.clear();
+
+    boost::mutex::scoped_lock l_oLock(g_oRingsMutex);
+
+    for(uint ii = 0; ii < g_vRings.size(); ++ii)
+    {
+        SWProfilerRing *l_pRing = g_vRings[ii];
+
+        uint l_ui32PushedNb = l_pRing->m_ui32PushedNb;
+        SW_RING_BARRIER();
+
+        uint l_ui32First = l_ui32PushedNb > SW_PROFILER_RING_SIZE ? l_ui32PushedNb - SW_PROFILER_RING_SIZE : 0;
+        size_t l_ui32Offset = vEvents.size();
+
+        for(uint jj = l_ui32First; jj < l_ui32PushedNb; ++jj)
+        {
+            vEvents.push_back(l_pRing->m_aEvents[jj % SW_PROFILER_RING_SIZE]);
+        }
+
+        // the thread may have overwritten the oldest events during the copy, they are discarded, with the slot of the
+        // event l_ui32NewPushedNb which may be in writing (the copy of this slot may be torn)
+        SW_RING_BARRIER();
+        uint l_ui32NewPushedNb = l_pRing->m_ui32PushedNb;
+
+        if(l_ui32NewPushedNb + 1 - l_ui32First > SW_PROFILER_RING_SIZE)
+        {
+            uint l_ui32Overwritten = std::min<uint>(l_ui32NewPushedNb + 1 - l_ui32First - SW_PROFILER_RING_SIZE, l_ui32PushedNb - l_ui32First);
+            vEvents.erase(vEvents.begin() + l_ui32Offset, vEvents.begin() + l_ui32Offset + l_ui32Overwritten);
+        }
+
+        vThreadIds.resize(vEvents.size(), l_pRing->m_i32Id);
+    }
+}
+
+void SWProfiler::stats(std::vector<SWProfileStats> &vStats) const
+{
+    std::vector<SWProfileEvent> l_vEvents;
+    std::vector<int> l_vThreadIds;
+    collect(l_vEvents, l_vThreadIds);
+
+    std::map<std::string, std::vector<double> > l_mDurations;
+    for(uint ii = 0; ii < l_vEvents.size(); ++ii)
+    {
+        l_mDurations[l_vEvents[ii].m_sStage].push_back((l_vEvents[ii].m_i64End - l_vEvents[ii].m_i64Start) * 0.001);
+    }
+
+    vStats.clear();
+    for(std::map<std::string, std::vector<double> >::iterator it = l_mDurations.begin(); it != l_mDurations.end(); ++it)
+    {
+        std::vector<double> &l_vDurations = it->second;
+        std::sort(l_vDurations.begin(), l_vDurations.end());
+
+        SWProfileStats l_oStats;
+        l_oStats.m_sStage   = it->first;
+        l_oStats.m_i32Count = static_cast<int>(l_vDurations.size());
+        l_oStats.m_dMean    = 0.;
+        for(uint ii = 0; ii < l_vDurations.size(); ++ii)
+        {
+            l_oStats.m_dMean += l_vDurations[ii];
+        }
+        l_oStats.m_dMean /= l_vDurations.size();
+
+        // nearest rank percentiles
+        l_oStats.m_dP50 = l_vDurations[(l_vDurations.size() * 50 + 99)/100 - 1];
+        l_oStats.m_dP99 = l_vDurations[(l_vDurations.size() * 99 + 99)/100 - 1];
+        l_oStats.m_dMax = l_vDurations.back();
+
+        vStats.push_back(l_oStats);
+    }
+}
+
+void SWProfiler::displayStats() const
+{
+    std::vector<SWProfileStats> l_vStats;
+    stats(l_vStats);
+
+    for(uint ii = 0; ii < l_vStats.size(); ++ii)
+    {
+        std::cout << l_vStats[ii].m_sStage << " : " << l_vStats[ii].m_i32Count << " events, mean " << l_vStats[ii].m_dMean << " ms, p50 "
+                  << l_vStats[ii].m_dP50 << " ms, p99 " << l_vStats[ii].m_dP99 << " ms, max " << l_vStats[ii].m_dMax << " ms" << std::endl;
+    }
+}
+
+/**
+ * \brief Write a json string (the quotes and the backslashes are escaped).
+ */
+static void writeJsonString(std::ofstream &oFile, const std::string &sString)
+{
+    oFile << '"';
+    for(uint ii = 0; ii < sString.size(); ++ii)
+    {
+        if(sString[ii] == '"' || sString[ii] == '\\')
+        {
+            oFile << '\\';
+        }
+        oFile << sString[ii];
+    }
+    oFile << '"';
+}
+
+bool SWProfiler::saveChromeTrace(const std::string &sPath) const
+{
+    std::ofstream l_oFile(sPath.c_str());
+
+    if(!l_oFile.is_open())
+    {
+        std::cerr << "Error : saveChromeTrace SWProfiler, can't open file : " << sPath << std::endl;
+        return false;
+    }
+
+    std::vector<SWProfileEvent> l_vEvents;
+    std::vector<int> l_vThreadIds;
+    collect(l_vEvents, l_vThreadIds);
+
+    l_oFile << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool l_bFirst = true;
+
+    // threads names
+    {
+        boost::mutex::scoped_lock l_oLock(g_oRingsMutex);
+
+        for(uint ii = 0; ii < g_vRings.size(); ++ii)
+        {
+            if(g_vRings[ii]->m_sName.size() > 0)
+            {
+                l_oFile << (l_bFirst ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << g_vRings[ii]->m_i32Id << ",\"args\":{\"name\":";
+                writeJsonString(l_oFile, g_vRings[ii]->m_sName);
+                l_oFile << "}}";
+                l_bFirst = false;
+            }
+        }
+    }
+
+    // complete events
+    for(uint ii = 0; ii < l_vEvents.size(); ++ii)
+    {
+        l_oFile << (l_bFirst ? "" : ",") << "\n{\"name\":";
+        writeJsonString(l_oFile, l_vEvents[ii].m_sStage);
+        l_oFile << ",\"cat\":\"swooz\",\"ph\":\"X\",\"pid\":1,\"tid\":" << l_vThreadIds[ii]
+                << ",\"ts\":" << l_vEvents[ii].m_i64Start << ",\"dur\":" << (l_vEvents[ii].m_i64End - l_vEvents[ii].m_i64Start) << "}";
+        l_bFirst = false;
+    }
+
+    l_oFile << "\n]}\n";
+
+    return l_oFile.good();
+}
@@ -28,6 +28,25 @@
 
 #include "devices/rgbd/SWKinect.h"
 
+#include <cstring>
+
+#define SW_DIMENCO_LUT_SIZE     4096    /**< number of quantized normalized depths in the disparity look-up table */
+#define SW_DIMENCO_HEADER_BITS  192     /**< number of bits of the 3D header (24 bytes) */
+
+/**
+ * @brief Index of a normalized depth in the disparity look-up table, the depths out of [0,1] (and NaN) are clamped.
+ */
+static inline int disparityLutIndex(const float fDepth)
+{
+	float l_fIndex = fDepth * (SW_DIMENCO_LUT_SIZE - 1);
+
+	if(l_fIndex > 0.f)
+	{
+		return l_fIndex < SW_DIMENCO_LUT_SIZE - 1 ? static_cast<int>(l_fIndex + 0.5f) : SW_DIMENCO_LUT_SIZE - 1;
+	}
+
+	return 0;
+}
 	
 SWDimenco3DDisplay::~SWDimenco3DDisplay(void)
 {
@@ -83,6 +102,14 @@ int SWDimenco3DDisplay::init(int msize) //the buffer
 		}
 	}
 	
+	// display dependent data computed once
+	buildDisparityLut();
+	encode3DHeader();
+
+	m_oOutputFrame = cv::Mat(cv::Size(displayImgWidth*2, displayImgHeight*2), CV_8UC3, cv::Scalar::all(0));
+	m_oRgbSize     = cv::Size();
+	m_oDepthSize   = cv::Size();
+
 	// creates a full screen cv window
 	cv::namedWindow("dimenco3D", CV_WINDOW_NORMAL);
 	cv::setWindowProperty("dimenco3D", CV_WND_PROP_FULLSCREEN ,CV_WINDOW_FULLSCREEN );
@@ -97,39 +124,68 @@ int SWDimenco3DDisplay::init(int msize) //the buffer
 
 void SWDimenco3DDisplay::refresh(const cv::Mat& rgbImg, const cv::Mat& depthImg)
 {
-	// retrieves information on RGB original image
-	//cvtColor(rgbImg, m_rgbImg, CV_BGR2RGB );
+	// retrieves information on RGB and depth original images
 	m_rgbImg = rgbImg;
 	originalRGBImgWidth = rgbImg.cols;
 	originalRGBImgHeight= rgbImg.rows;
-		
-	// creates a padded RGB image
-	cv::Mat paddedRGBImg( cv::Size(displayImgWidth, displayImgHeight), CV_8UC3, cv::Scalar::all(0) );
-	padImageBorder( rgbImg, paddedRGBImg );
-	//~ cv::imshow("zero",paddedRGBImg );
-	// retrieves information on Depth image
 	m_depthImg = depthImg;
 	originalDepthImgWidth = depthImg.cols;
 	originalDepthImgHeight= depthImg.rows;
-		
-	// converts the depth image into a disparity image
-	cv::Mat disparityImg(cv::Size(originalDepthImgWidth, originalDepthImgHeight), CV_8UC3, cv::Scalar::all(0));
-	depth2disparity(depthImg, disparityImg);
-	
-	// creates a padded Disparity Image
-	cv::Mat paddedDisparityImg( cv::Size(displayImgWidth, displayImgHeight), CV_8UC3, cv::Scalar::all(0) );
-	padImageBorder( disparityImg, paddedDisparityImg );
 
-	// concats the RGB and Disparity images
-	cv::Mat rgbdImg( cv::Size( paddedRGBImg.cols+paddedDisparityImg.cols, paddedRGBImg.rows ), CV_8UC3 );
-	concatRGBDImages( paddedRGBImg, paddedDisparityImg, rgbdImg );
+	if(m_oOutputFrame.empty())
+	{
+		std::cerr << "-ERROR : SWDimenco3DDisplay::refresh, the display is not initialized. " << std::endl;
+		return;
+	}
+
+	if(rgbImg.type() != CV_8UC3 || depthImg.type() != CV_32FC1 ||
+	   rgbImg.cols > displayImgWidth || rgbImg.rows > displayImgHeight || depthImg.cols > displayImgWidth || depthImg.rows > displayImgHeight)
+	{
+		std::cerr << "-ERROR : SWDimenco3DDisplay::refresh, invalid input images (CV_8UC3 rgb and CV_32FC1 depth smaller than the display expected). " << std::endl;
+		return;
+	}
+
+	// the padding and the zero lines are never written, the output frame is cleared only when the input sizes change
+	if(rgbImg.size() != m_oRgbSize || depthImg.size() != m_oDepthSize)
+	{
+		m_oOutputFrame.setTo(cv::Scalar::all(0));
+		m_oRgbSize   = rgbImg.size();
+		m_oDepthSize = depthImg.size();
+	}
+
+	// clears the previous fps text, which may be in the padding
+	m_oOutputFrame(cv::Rect(0, 20, 300, 40)).setTo(cv::Scalar::all(0));
 
-	// adds zero lines for even rows
-	cv::Mat zeroAddedRGBDImg( cv::Size(rgbdImg.cols, rgbdImg.rows*2), CV_8UC3, cv::Scalar::all(0) );
-	addZeroLines( rgbdImg, zeroAddedRGBDImg);
+	// copies the rgb lines at their padded position on the even lines of the left half
+	int l_i32RgbX = (displayImgWidth  - rgbImg.cols)/2;
+	int l_i32RgbY = (displayImgHeight - rgbImg.rows)/2;
+
+	for(int ii = 0; ii < rgbImg.rows; ++ii)
+	{
+		memcpy(m_oOutputFrame.ptr<uchar>(2*(l_i32RgbY + ii)) + 3*l_i32RgbX, rgbImg.ptr<uchar>(ii), 3*rgbImg.cols);
+	}
+
+	// converts the depth with the look-up table at the padded position on the even lines of the right half
+	int l_i32DepthX = displayImgWidth + (displayImgWidth - depthImg.cols)/2;
+	int l_i32DepthY = (displayImgHeight - depthImg.rows)/2;
+	const uchar *l_pLut = &m_vDisparityLut[0];
+
+	for(int ii = 0; ii < depthImg.rows; ++ii)
+	{
+		const float *l_pDepth = depthImg.ptr<float>(ii);
+		uchar *l_pDisparity   = m_oOutputFrame.ptr<uchar>(2*(l_i32DepthY + ii)) + 3*l_i32DepthX;
+
+		for(int jj = 0; jj < depthImg.cols; ++jj, l_pDisparity += 3)
+		{
+			uchar l_ui8Disparity = l_pLut[disparityLutIndex(l_pDepth[jj])];
+			l_pDisparity[0] = l_ui8Disparity;
+			l_pDisparity[1] = l_ui8Disparity;
+			l_pDisparity[2] = l_ui8Disparity;
+		}
+	}
 
 	// adds the 3D header, this way the display will interpret the image as 3D
-	add3DHeader( zeroAddedRGBDImg ); //be aware of the Mat, the rgb order is actually bgr;
+	add3DHeader( m_oOutputFrame ); //be aware of the Mat, the rgb order is actually bgr;
 
 	// determines the fps
 	static double freq = cv::getTickFrequency();
@@ -137,9 +193,8 @@ void SWDimenco3DDisplay::refresh(const cv::Mat& rgbImg, const cv::Mat& depthImg)
 	int64 fps = static_cast<int64>(freq/(cv::getTickCount() - tm) );
 	tm = cv::getTickCount();
 
-	cv::putText( zeroAddedRGBDImg, "fps: " + swUtil::int2string(static_cast<int>(fps)), cv::Point( 15,50), cv::FONT_HERSHEY_SIMPLEX, 1, RED, 3 );
-	cv::imshow("dimenco3D",zeroAddedRGBDImg );
-	
+	cv::putText( m_oOutputFrame, "fps: " + swUtil::int2string(static_cast<int>(fps)), cv::Point( 15,50), cv::FONT_HERSHEY_SIMPLEX, 1, RED, 3 );
+	cv::imshow("dimenco3D", m_oOutputFrame );
 }
 
 void SWDimenco3DDisplay::depth2disparity(const cv::Mat& depthImg, cv::Mat& disparityImg)
@@ -149,24 +204,27 @@ void SWDimenco3DDisplay::depth2disparity(const cv::Mat& depthImg, cv::Mat& dispa
 	
 	for (int l_row=0; l_row<numRows; l_row++)
 	{
+		const float *l_pDepth = depthImg.ptr<float>(l_row);
+		cv::Vec3b *l_pDisparity = disparityImg.ptr<cv::Vec3b>(l_row);
+
 		for (int l_col=0; l_col<numCols; l_col++)
 		{
-			double depthValue = depthImg.at<float>(l_row,l_col);
-			int disparity = static_cast<int>(floor(M*(1 - vz/(depthValue - Zd + vz))+C));
-			
-			//~ if (l_row==numRows/2 && l_col==numCols/2)
-				//~ std::cout << "disparity = " <<disparity <<std::endl;
-			
-			for(int k=0; k<disparityImg.channels(); k++) //all channels
-			{
-				disparityImg.at<cv::Vec3b>(l_row,l_col)[k] = disparity;
-			}
-			
+			uchar disparity = m_vDisparityLut[disparityLutIndex(l_pDepth[l_col])];
+			l_pDisparity[l_col] = cv::Vec3b(disparity, disparity, disparity);
 		}
 	}
-	
-//   cv::flip(disparityImg, disparityImg, 0);
-	
+}
+
+void SWDimenco3DDisplay::buildDisparityLut()
+{
+	// D(Z) = M * (1-(vz/(Z-Zd+vz))) + C, for the center of each quantized depth
+	m_vDisparityLut.resize(SW_DIMENCO_LUT_SIZE);
+
+	for(int ii = 0; ii < SW_DIMENCO_LUT_SIZE; ++ii)
+	{
+		double depthValue = static_cast<double>(ii) / (SW_DIMENCO_LUT_SIZE - 1);
+		m_vDisparityLut[ii] = cv::saturate_cast<uchar>(static_cast<int>(floor(M*(1 - vz/(depthValue - Zd + vz))+C)));
+	}
 }
 	
 	
@@ -195,6 +253,26 @@ void SWDimenco3DDisplay::addZeroLines(const cv::Mat& inputImg, cv::Mat& outputIm
 
 void SWDimenco3DDisplay::add3DHeader( cv::Mat& img )
 {
+	if(m_vHeaderBlueBytes.empty())
+	{
+		encode3DHeader();
+	}
+
+	// one blue byte every two pixels, as written by embedBlueBit7B
+	unsigned char *data = img.ptr();
+	for(uint ii = 0; ii < m_vHeaderBlueBytes.size(); ++ii)
+	{
+		data[ii*6] = m_vHeaderBlueBytes[ii];
+	}
+}
+
+void SWDimenco3DDisplay::encode3DHeader()
+{
+	// the header is embedded once in a scratch line
+	std::vector<unsigned char> l_vLine(32 * 8 * 6, 0); // large enough for the two headers
+	unsigned char *l_pLine = &l_vLine[0];
+	int l_i32BitsNb = SW_DIMENCO_HEADER_BITS;
+
     if (true)
 	{
 		unsigned char hd[24];
@@ -224,7 +302,7 @@ void SWDimenco3DDisplay::add3DHeader( cv::Mat& img )
 		hd[22] = 0x33;
 		hd[23] = 0x84;
 		//int len = x * 2 * (y * 2 - 1) * 3;
-		embedBlueBit7B(img.ptr(), hd, 24);
+		embedBlueBit7B(l_pLine, hd, 24);
 	}
 	else
 	{	
@@ -273,7 +351,14 @@ void SWDimenco3DDisplay::add3DHeader( cv::Mat& img )
 		// embed the header
 		/* please note that this is just the first header part! */
 		/* we do not copy the 2nd part because it is sufficient for the use of 2D+Depth format*/
-		embedBlueBit7B(img.ptr(), hd, 32);
+		embedBlueBit7B(l_pLine, hd, 32);
+		l_i32BitsNb = 32 * 8;
+	}
+
+	m_vHeaderBlueBytes.resize(l_i32BitsNb);
+	for(int ii = 0; ii < l_i32BitsNb; ++ii)
+	{
+		m_vHeaderBlueBytes[ii] = l_vLine[ii*6];
 	}
 }
 
@@ -336,6 +421,7 @@ int main(int argc, char* argv[])
 
     // initialization
     swKinect.init(0);
+    swKinect.setChannels(swDevice::KINECT_BGR_IMAGE | swDevice::KINECT_NORMALIZED_DEPTH_MAP);
     swDimenco.init(monitorSize);
 
     for (;;)
@@ -38,7 +38,7 @@ using namespace std;
 using namespace swDevice;
 using namespace swExcept;
 
-SWKinect::SWKinect(bool bVerbose) : m_bVerbose(bVerbose)
+SWKinect::SWKinect(bool bVerbose) : m_bVerbose(bVerbose), m_i32Channels(KINECT_ALL_CHANNELS), m_i32LutMinDepth(0), m_i32LutMaxDepth(0)
 {
 	// this should be adjusted through a config file
 	minDepthValue = 400; // in mm
@@ -152,6 +152,43 @@ void SWKinect::setRecalibration(cbool bRecalib, cint i32XCalibrate, cint i32YCal
 	m_i32YCalibrate	= i32YCalibrate;
 }
 
+void SWKinect::setChannels(cint i32Channels)
+{
+    m_i32Channels = i32Channels & KINECT_ALL_CHANNELS;
+
+    // the mats of the channels not retrieved anymore are released
+    if(!(m_i32Channels & (KINECT_DEPTH_MAP | KINECT_NORMALIZED_DEPTH_MAP)))
+    {
+        depthMap.release();
+    }
+    if(!(m_i32Channels & KINECT_DISPARITY_MAP))
+    {
+        disparityMap.release();
+    }
+    if(!(m_i32Channels & KINECT_BGR_IMAGE))
+    {
+        bgrImage.release();
+        m_oRecalibratedBgrImage.release();
+    }
+    if(!(m_i32Channels & KINECT_CLOUD_MAP))
+    {
+        cloudMap.release();
+    }
+    if(!(m_i32Channels & KINECT_GRAY_IMAGE))
+    {
+        grayImage.release();
+    }
+    if(!(m_i32Channels & KINECT_NORMALIZED_DEPTH_MAP))
+    {
+        normalizedDepthMap.release();
+    }
+}
+
+int SWKinect::channels() const
+{
+    return m_i32Channels;
+}
+
 int SWKinect::grab(void)
 {
     if(!m_bKinectInitalized)
@@ -169,107 +206,85 @@ int SWKinect::grab(void)
     }
     else
     {
-		// CV_CAP_OPENNI_DEPTH_MAP 	
-		// CV_CAP_OPENNI_POINT_CLOUD_MAP 	
-		// CV_CAP_OPENNI_DISPARITY_MAP 	
-		// CV_CAP_OPENNI_DISPARITY_MAP_32F 	
-		// CV_CAP_OPENNI_VALID_DEPTH_MASK 	
-		// CV_CAP_OPENNI_BGR_IMAGE 	
-		// CV_CAP_OPENNI_GRAY_IMAGE 		
-		
-		// Depth Image
-        m_oCapture.retrieve(depthMap,     CV_CAP_OPENNI_DEPTH_MAP);
-		// Disparity Image
-        m_oCapture.retrieve(disparityMap, CV_CAP_OPENNI_DISPARITY_MAP); // CV_CAP_OPENNI_DISPARITY_MAP_32F
-		// RGB Image
-        m_oCapture.retrieve(bgrImage,     CV_CAP_OPENNI_BGR_IMAGE);
-		// Cloud map
-        m_oCapture.retrieve(cloudMap,     CV_CAP_OPENNI_POINT_CLOUD_MAP);
-
-		// gray image
-        m_oCapture.retrieve(grayImage,    CV_CAP_OPENNI_GRAY_IMAGE);
-		
-		if(m_bRecalibrate && (m_i32XCalibrate != 0 || m_i32YCalibrate != 0))
-		{
-			recalibrate();
-		}
-	}
+        // CV_CAP_OPENNI_DEPTH_MAP
+        // CV_CAP_OPENNI_POINT_CLOUD_MAP
+        // CV_CAP_OPENNI_DISPARITY_MAP
+        // CV_CAP_OPENNI_DISPARITY_MAP_32F
+        // CV_CAP_OPENNI_VALID_DEPTH_MASK
+        // CV_CAP_OPENNI_BGR_IMAGE
+        // CV_CAP_OPENNI_GRAY_IMAGE
+
+        // the openni capture converts each retrieved channel, only the channels used are retrieved
+        if(m_i32Channels & (KINECT_DEPTH_MAP | KINECT_NORMALIZED_DEPTH_MAP))
+        {
+            m_oCapture.retrieve(depthMap,     CV_CAP_OPENNI_DEPTH_MAP);
+        }
+        if(m_i32Channels & KINECT_DISPARITY_MAP)
+        {
+            m_oCapture.retrieve(disparityMap, CV_CAP_OPENNI_DISPARITY_MAP); // CV_CAP_OPENNI_DISPARITY_MAP_32F
+        }
+        if(m_i32Channels & KINECT_BGR_IMAGE)
+        {
+            m_oCapture.retrieve(bgrImage,     CV_CAP_OPENNI_BGR_IMAGE);
 
+            if(m_bRecalibrate && (m_i32XCalibrate != 0 || m_i32YCalibrate != 0))
+            {
+                recalibrate();
+            }
+        }
+        if(m_i32Channels & KINECT_CLOUD_MAP)
+        {
+            m_oCapture.retrieve(cloudMap,     CV_CAP_OPENNI_POINT_CLOUD_MAP);
+        }
+        if(m_i32Channels & KINECT_GRAY_IMAGE)
+        {
+            m_oCapture.retrieve(grayImage,    CV_CAP_OPENNI_GRAY_IMAGE);
+        }
+    }
 
     // create normalized depth map (for dimenco)
-    normalizeDepthImage();
-	
-	return 0;
+    if(m_i32Channels & KINECT_NORMALIZED_DEPTH_MAP)
+    {
+        normalizeDepthImage();
+    }
+
+    return 0;
 }
 
 void SWKinect::recalibrate()
 {
-	cv::Scalar l_oBlack(0,0,0), l_oCurrColor;
-	cv::Mat l_oNewBgrImage(cv::Size(bgrImage.size()), CV_8UC3, l_oBlack);
-	
-	for(int ii = 0; ii < l_oNewBgrImage.rows; ++ii)
-	{
-		for(int jj = 0; jj < l_oNewBgrImage.cols; ++jj)
-		{		
-			int l_i32CurrII;
-			int l_i32CurrJJ;
-			bool l_bPaintBlack = false;			
-
-			if(m_i32XCalibrate < 0)
-			{
-				if( jj < l_oNewBgrImage.cols + m_i32XCalibrate-1)
-				{
-					l_i32CurrJJ = jj - m_i32XCalibrate;					
-				}
-				else
-				{
-					l_bPaintBlack = true;
-				}
-			}
-			else
-			{
-				if( jj > m_i32XCalibrate)
-				{
-					l_i32CurrJJ = jj - m_i32XCalibrate;
-				}	
-				else
-				{
-					l_bPaintBlack = true;
-				}				
-			}
-			
-			if(m_i32YCalibrate < 0)
-			{
-				if( ii < l_oNewBgrImage.rows + m_i32YCalibrate-1)
-				{
-					l_i32CurrII = ii - m_i32YCalibrate;				
-				}
-				else
-				{
-					l_bPaintBlack = true;
-				}				
-			}
-			else
-			{
-				if( ii > m_i32YCalibrate)
-				{
-					l_i32CurrII = ii - m_i32YCalibrate;
-				}		
-				else
-				{
-					l_bPaintBlack = true;
-				}				
-			}			
-			
-			if(!l_bPaintBlack)
-			{					
-				l_oNewBgrImage.at<cv::Vec3b> (ii,jj) = bgrImage.at<cv::Vec3b>(l_i32CurrII,l_i32CurrJJ);					
-			}			
-		}
-	}
-	
-	
-	bgrImage = l_oNewBgrImage.clone();
+    // the pixel (ii,jj) of the new image is the pixel (ii - m_i32YCalibrate, jj - m_i32XCalibrate) of the grabbed image
+    int l_i32Width  = bgrImage.cols - abs(m_i32XCalibrate);
+    int l_i32Height = bgrImage.rows - abs(m_i32YCalibrate);
+
+    // bgrImage points to the buffer of the capture, the recalibrated image has its own buffer reused at each grab
+    m_oRecalibratedBgrImage.create(bgrImage.size(), bgrImage.type());
+
+    if(l_i32Width <= 0 || l_i32Height <= 0)
+    {
+        m_oRecalibratedBgrImage.setTo(cv::Scalar(0,0,0));
+        bgrImage = m_oRecalibratedBgrImage;
+        return;
+    }
+
+    cv::Rect l_oSource(std::max(0, -m_i32XCalibrate), std::max(0, -m_i32YCalibrate), l_i32Width, l_i32Height);
+    cv::Rect l_oDestination(std::max(0, m_i32XCalibrate), std::max(0, m_i32YCalibrate), l_i32Width, l_i32Height);
+
+    bgrImage(l_oSource).copyTo(m_oRecalibratedBgrImage(l_oDestination));
+
+    // paint the uncovered borders in black
+    if(m_i32YCalibrate != 0)
+    {
+        int l_i32Row = m_i32YCalibrate > 0 ? 0 : l_i32Height;
+        m_oRecalibratedBgrImage(cv::Rect(0, l_i32Row, bgrImage.cols, abs(m_i32YCalibrate))).setTo(cv::Scalar(0,0,0));
+    }
+    if(m_i32XCalibrate != 0)
+    {
+        int l_i32Col = m_i32XCalibrate > 0 ? 0 : l_i32Width;
+        m_oRecalibratedBgrImage(cv::Rect(l_i32Col, 0, abs(m_i32XCalibrate), bgrImage.rows)).setTo(cv::Scalar(0,0,0));
+    }
+
+    bgrImage = m_oRecalibratedBgrImage;
 }
 
 cv::Size SWKinect::sizeFrame()
@@ -284,25 +299,50 @@ int SWKinect::fps()
 
 void SWKinect::normalizeDepthImage(void)
 {
-	normalizedDepthMap = Mat(depthMap.rows, depthMap.cols, CV_32FC1);
-	
-	for (int l_row=0; l_row<depthMap.rows; l_row++)
-	{
-		for (int l_col =0; l_col<depthMap.cols; l_col++)
-		{
-			if (depthMap.at<unsigned short>(l_row,l_col) <= minDepthValue)
-			{
-				normalizedDepthMap.at<float>(l_row,l_col) = 0.0f;
-			}
-			if (depthMap.at<unsigned short>(l_row,l_col) >= maxDepthValue)
-			{
-				normalizedDepthMap.at<float>(l_row,l_col) = 1.0f;
-			}
-			if (depthMap.at<unsigned short>(l_row,l_col) < maxDepthValue && depthMap.at<unsigned short>(l_row,l_col) > minDepthValue)
-			{
-				normalizedDepthMap.at<float>(l_row,l_col) = ((float)depthMap.at<unsigned short>(l_row,l_col) - minDepthValue) / (maxDepthValue-minDepthValue);
-			}
-		}
-	}
-//    std::cout << "normalizedDepthMap.at<float>(l_row,l_col) = " <<normalizedDepthMap.at<float>(depthMap.rows/2,depthMap.cols/2) <<std::endl;
+    // the look-up table covers all the 16 bits depths
+    if(m_vDepthLut.size() == 0 || m_i32LutMinDepth != minDepthValue || m_i32LutMaxDepth != maxDepthValue)
+    {
+        m_vDepthLut.resize(65536);
+
+        for(int ii = 0; ii < 65536; ++ii)
+        {
+            if(ii <= minDepthValue)
+            {
+                m_vDepthLut[ii] = 0.0f;
+            }
+            else if(ii >= maxDepthValue)
+            {
+                m_vDepthLut[ii] = 1.0f;
+            }
+            else
+            {
+                m_vDepthLut[ii] = ((float)ii - minDepthValue) / (maxDepthValue-minDepthValue);
+            }
+        }
+
+        m_i32LutMinDepth = minDepthValue;
+        m_i32LutMaxDepth = maxDepthValue;
+    }
+
+    normalizedDepthMap.create(depthMap.rows, depthMap.cols, CV_32FC1);
+
+    const float *l_aLut = &m_vDepthLut[0];
+    int l_i32Rows = depthMap.rows, l_i32Cols = depthMap.cols;
+
+    if(depthMap.isContinuous() && normalizedDepthMap.isContinuous())
+    {
+        l_i32Cols *= l_i32Rows;
+        l_i32Rows  = 1;
+    }
+
+    for(int l_row = 0; l_row < l_i32Rows; ++l_row)
+    {
+        const ushort *l_aDepth      = depthMap.ptr<ushort>(l_row);
+        float        *l_aNormalized = normalizedDepthMap.ptr<float>(l_row);
+
+        for(int l_col = 0; l_col < l_i32Cols; ++l_col)
+        {
+            l_aNormalized[l_col] = l_aLut[l_aDepth[l_col]];
+        }
+    }
 }
@@ -0,0 +1,428 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWKinectDataFormat.cpp
+ * \brief Defines the cloud recording codecs
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#include "devices/rgbd/SWKinectDataFormat.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+using namespace swDevice;
+
+#define SW_RICE_ESCAPE 24       /**< unary length from which the value is written with SW_RICE_ESCAPE_BITS bits */
+#define SW_RICE_ESCAPE_BITS 18  /**< bits of an escaped value (zigzag of a 17 bits residual) */
+
+namespace
+{
+    /**
+     * \class SWBitWriter
+     * \brief Append bits to a bytes vector, first bits in the low bits of the bytes.
+     */
+    class SWBitWriter
+    {
+        public :
+
+            SWBitWriter(std::vector<uchar> &vBuffer) : m_vBuffer(vBuffer), m_ui64Acc(0), m_i32Bits(0) {}
+
+            /**
+             * \brief Write the i32Nb low bits of ui32Bits (i32Nb <= 32).
+             */
+            void put(cuint ui32Bits, cint i32Nb)
+            {
+                m_ui64Acc |= static_cast<uint64>(ui32Bits) << m_i32Bits;
+                m_i32Bits += i32Nb;
+
+                while(m_i32Bits >= 8)
+                {
+                    m_vBuffer.push_back(static_cast<uchar>(m_ui64Acc & 0xFF));
+                    m_ui64Acc >>= 8;
+                    m_i32Bits -= 8;
+                }
+            }
+
+            /**
+             * \brief Write the remaining bits.
+             */
+            void flush()
+            {
+                if(m_i32Bits > 0)
+                {
+                    m_vBuffer.push_back(static_cast<uchar>(m_ui64Acc & 0xFF));
+                }
+
+                m_ui64Acc = 0;
+                m_i32Bits = 0;
+            }
+
+        private :
+
+            std::vector<uchar> &m_vBuffer;  /**< output buffer */
+            uint64 m_ui64Acc;               /**< bits not written yet */
+            int m_i32Bits;                  /**< number of bits in m_ui64Acc */
+    };
+
+    /**
+     * \class SWBitReader
+     * \brief Read bits written by SWBitWriter.
+     */
+    class SWBitReader
+    {
+        public :
+
+            SWBitReader(const uchar *aUi8Data, const size_t ui32Size) : m_aUi8Data(aUi8Data), m_ui32Size(ui32Size), m_ui32Pos(0), m_ui64Acc(0), m_i32Bits(0), m_bOverflow(false) {}
+
+            /**
+             * \brief Read i32Nb bits (i32Nb <= 32).
+             */
+            uint get(cint i32Nb)
+            {
+                while(m_i32Bits < i32Nb)
+                {
+                    if(m_ui32Pos >= m_ui32Size)
+                    {
+                        m_bOverflow = true;
+                        return 0;
+                    }
+
+                    m_ui64Acc |= static_cast<uint64>(m_aUi8Data[m_ui32Pos++]) << m_i32Bits;
+                    m_i32Bits += 8;
+                }
+
+                uint l_ui32Bits = static_cast<uint>(m_ui64Acc & ((static_cast<uint64>(1) << i32Nb) - 1));
+                m_ui64Acc >>= i32Nb;
+                m_i32Bits -= i32Nb;
+
+                return l_ui32Bits;
+            }
+
+            /**
+             * \brief Is the end of the data has been read ?
+             */
+            bool overflow() const
+            {
+                return m_bOverflow;
+            }
+
+        private :
+
+            const uchar *m_aUi8Data;        /**< input data */
+            size_t m_ui32Size;              /**< size of the data */
+            size_t m_ui32Pos;               /**< next byte to read */
+            uint64 m_ui64Acc;               /**< bits not read yet */
+            int m_i32Bits;                  /**< number of bits in m_ui64Acc */
+            bool m_bOverflow;               /**< end of data reached */
+    };
+
+    /**
+     * \brief Fit the projection x = (p0 * u + p1) * z, y = (p2 * v + p3) * z on the saved points of the cloud and check
+     *        that it reproduces the points with the millimeters depth.
+     * \return true if the depth codec can be used
+     */
+    bool fitProjection(const cv::Mat &oCloud, const std::vector<ushort> &vDepth, float *a4FProjection)
+    {
+        double l_dN = 0., l_dSu = 0., l_dSuu = 0., l_dSx = 0., l_dSux = 0., l_dSv = 0., l_dSvv = 0., l_dSy = 0., l_dSvy = 0.;
+
+        for(int ii = 0; ii < oCloud.rows; ++ii)
+        {
+            const cv::Vec3f *l_pRow = oCloud.ptr<cv::Vec3f>(ii);
+            const ushort *l_pDepth  = &vDepth[ii * oCloud.cols];
+
+            for(int jj = 0; jj < oCloud.cols; ++jj)
+            {
+                if(l_pDepth[jj] == 0)
+                {
+                    continue;
+                }
+
+                double l_dXZ = l_pRow[jj][0] / l_pRow[jj][2];
+                double l_dYZ = l_pRow[jj][1] / l_pRow[jj][2];
+
+                l_dN   += 1.;
+                l_dSu  += jj;   l_dSuu += static_cast<double>(jj) * jj;
+                l_dSv  += ii;   l_dSvv += static_cast<double>(ii) * ii;
+                l_dSx  += l_dXZ; l_dSux += jj * l_dXZ;
+                l_dSy  += l_dYZ; l_dSvy += ii * l_dYZ;
+            }
+        }
+
+        double l_dDetU = l_dN * l_dSuu - l_dSu * l_dSu;
+        double l_dDetV = l_dN * l_dSvv - l_dSv * l_dSv;
+
+        if(l_dN < 2. || std::fabs(l_dDetU) < 1e-12 || std::fabs(l_dDetV) < 1e-12)
+        {
+            a4FProjection[0] = a4FProjection[1] = a4FProjection[2] = a4FProjection[3] = 0.f;
+            return l_dN == 0.;
+        }
+
+        a4FProjection[0] = static_cast<float>((l_dN * l_dSux - l_dSu * l_dSx) / l_dDetU);
+        a4FProjection[1] = static_cast<float>((l_dSx - a4FProjection[0] * l_dSu) / l_dN);
+        a4FProjection[2] = static_cast<float>((l_dN * l_dSvy - l_dSv * l_dSy) / l_dDetV);
+        a4FProjection[3] = static_cast<float>((l_dSy - a4FProjection[2] * l_dSv) / l_dN);
+
+        // check the reconstruction, same computing than the decoding
+        for(int ii = 0; ii < oCloud.rows; ++ii)
+        {
+            const cv::Vec3f *l_pRow = oCloud.ptr<cv::Vec3f>(ii);
+            const ushort *l_pDepth  = &vDepth[ii * oCloud.cols];
+            float l_fYZ = a4FProjection[2] * ii + a4FProjection[3];
+
+            for(int jj = 0; jj < oCloud.cols; ++jj)
+            {
+                if(l_pDepth[jj] == 0)
+                {
+                    continue;
+                }
+
+                float l_fZ = l_pDepth[jj] * 0.001f;
+
+                if(std::fabs((a4FProjection[0] * jj + a4FProjection[1]) * l_fZ - l_pRow[jj][0]) > SW_KINECT_PROJECTION_TOLERANCE ||
+                   std::fabs(l_fYZ * l_fZ - l_pRow[jj][1]) > SW_KINECT_PROJECTION_TOLERANCE)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+void swDevice::encodeKinectCloud(const cv::Mat &oCloud, cfloat fMinDist, cfloat fMaxDist, SWKinectFrameHeader &oHeader, std::vector<uchar> &vPayload)
+{
+    cint l_i32Width  = oCloud.cols;
+    cint l_i32Height = oCloud.rows;
+
+    oHeader.m_i32Width  = l_i32Width;
+    oHeader.m_i32Height = l_i32Height;
+    vPayload.clear();
+
+    // millimeters depth of the saved points, 0 for the others
+    std::vector<ushort> l_vDepth(l_i32Width * l_i32Height, 0);
+    bool l_bMillimeters = true;
+
+    for(int ii = 0; ii < l_i32Height; ++ii)
+    {
+        const cv::Vec3f *l_pRow = oCloud.ptr<cv::Vec3f>(ii);
+        ushort *l_pDepth        = &l_vDepth[ii * l_i32Width];
+
+        for(int jj = 0; jj < l_i32Width; ++jj)
+        {
+            float l_fZ = l_pRow[jj][2];
+
+            if(l_fZ > fMinDist && l_fZ < fMaxDist)
+            {
+                float l_fMM = std::floor(l_fZ * 1000.f + 0.5f);
+
+                if(l_fMM < 1.f || l_fMM > 65535.f || static_cast<ushort>(l_fMM) * 0.001f != l_fZ)
+                {
+                    l_bMillimeters = false;
+                }
+
+                l_pDepth[jj] = static_cast<ushort>(std::min(std::max(l_fMM, 1.f), 65535.f));
+            }
+        }
+    }
+
+    if(l_bMillimeters && fitProjection(oCloud, l_vDepth, oHeader.m_a4FProjection))
+    {
+        // depth codec : left (or up for the first column) prediction, zigzag residuals, Rice code with one parameter per row
+        oHeader.m_i32Codec = SW_KINECT_DEPTH_CODEC;
+        vPayload.reserve(l_i32Width * l_i32Height / 2);
+
+        SWBitWriter l_oWriter(vPayload);
+        std::vector<uint> l_vResiduals(l_i32Width);
+
+        for(int ii = 0; ii < l_i32Height; ++ii)
+        {
+            const ushort *l_pDepth = &l_vDepth[ii * l_i32Width];
+            int l_i32Prediction    = (ii > 0) ? l_vDepth[(ii-1) * l_i32Width] : 0;
+            uint64 l_ui64Sum = 0;
+
+            for(int jj = 0; jj < l_i32Width; ++jj)
+            {
+                int l_i32Residual  = static_cast<int>(l_pDepth[jj]) - l_i32Prediction;
+                l_vResiduals[jj]   = (static_cast<uint>(l_i32Residual) << 1) ^ static_cast<uint>(l_i32Residual >> 31);
+                l_ui64Sum         += l_vResiduals[jj];
+                l_i32Prediction    = l_pDepth[jj];
+            }
+
+            int l_i32K = 0;
+            while(l_i32K < 16 && (static_cast<uint64>(l_i32Width) << l_i32K) < l_ui64Sum)
+            {
+                ++l_i32K;
+            }
+            l_oWriter.put(l_i32K, 5);
+
+            for(int jj = 0; jj < l_i32Width; ++jj)
+            {
+                uint l_ui32Q = l_vResiduals[jj] >> l_i32K;
+
+                if(l_ui32Q < SW_RICE_ESCAPE)
+                {
+                    l_oWriter.put((1u << l_ui32Q) - 1, l_ui32Q + 1);
+                    l_oWriter.put(l_vResiduals[jj] & ((1u << l_i32K) - 1), l_i32K);
+                }
+                else
+                {
+                    l_oWriter.put((1u << SW_RICE_ESCAPE) - 1, SW_RICE_ESCAPE);
+                    l_oWriter.put(l_vResiduals[jj], SW_RICE_ESCAPE_BITS);
+                }
+            }
+        }
+
+        l_oWriter.flush();
+    }
+    else
+    {
+        // points codec : [id, x, y, z] of the saved points
+        oHeader.m_i32Codec = SW_KINECT_POINTS_CODEC;
+        oHeader.m_a4FProjection[0] = oHeader.m_a4FProjection[1] = oHeader.m_a4FProjection[2] = oHeader.m_a4FProjection[3] = 0.f;
+
+        for(int ii = 0; ii < l_i32Width * l_i32Height; ++ii)
+        {
+            if(l_vDepth[ii] == 0)
+            {
+                continue;
+            }
+
+            const cv::Vec3f &l_oPoint = oCloud.at<cv::Vec3f>(ii);
+            size_t l_ui32Pos = vPayload.size();
+            vPayload.resize(l_ui32Pos + sizeof(int) + 3 * sizeof(float));
+
+            memcpy(&vPayload[l_ui32Pos], &ii, sizeof(int));
+            memcpy(&vPayload[l_ui32Pos + sizeof(int)], &l_oPoint[0], 3 * sizeof(float));
+        }
+    }
+
+    oHeader.m_ui32PayloadSize = static_cast<uint>(vPayload.size());
+}
+
+bool swDevice::decodeKinectCloud(const SWKinectFrameHeader &oHeader, const uchar *aUi8Payload, cv::Mat &oCloud)
+{
+    cint l_i32Width  = oHeader.m_i32Width;
+    cint l_i32Height = oHeader.m_i32Height;
+
+    if(l_i32Width <= 0 || l_i32Height <= 0)
+    {
+        return false;
+    }
+
+    oCloud = cv::Mat(l_i32Height, l_i32Width, CV_32FC3, cv::Scalar(0.f,0.f,0.f));
+
+    if(oHeader.m_i32Codec == SW_KINECT_DEPTH_CODEC)
+    {
+        SWBitReader l_oReader(aUi8Payload, oHeader.m_ui32PayloadSize);
+        std::vector<ushort> l_vPreviousRow(l_i32Width, 0);
+        const float *l_aFP = oHeader.m_a4FProjection;
+
+        for(int ii = 0; ii < l_i32Height; ++ii)
+        {
+            cv::Vec3f *l_pRow = oCloud.ptr<cv::Vec3f>(ii);
+            int l_i32K = static_cast<int>(l_oReader.get(5));
+            int l_i32Prediction = l_vPreviousRow[0];
+            float l_fYZ = l_aFP[2] * ii + l_aFP[3];
+
+            if(l_i32K > 16)
+            {
+                return false;
+            }
+
+            for(int jj = 0; jj < l_i32Width; ++jj)
+            {
+                uint l_ui32Q = 0;
+                while(l_ui32Q < SW_RICE_ESCAPE && l_oReader.get(1))
+                {
+                    ++l_ui32Q;
+                }
+
+                uint l_ui32Value;
+                if(l_ui32Q < SW_RICE_ESCAPE)
+                {
+                    l_ui32Value = (l_ui32Q << l_i32K) | l_oReader.get(l_i32K);
+                }
+                else
+                {
+                    l_ui32Value = l_oReader.get(SW_RICE_ESCAPE_BITS);
+                }
+
+                if(l_oReader.overflow())
+                {
+                    return false;
+                }
+
+                int l_i32Depth = l_i32Prediction + static_cast<int>((l_ui32Value >> 1) ^ (0u - (l_ui32Value & 1)));
+
+                if(l_i32Depth < 0 || l_i32Depth > 65535)
+                {
+                    return false;
+                }
+
+                l_vPreviousRow[jj] = static_cast<ushort>(l_i32Depth);
+                l_i32Prediction    = l_i32Depth;
+
+                if(l_i32Depth > 0)
+                {
+                    float l_fZ = static_cast<ushort>(l_i32Depth) * 0.001f;
+                    l_pRow[jj] = cv::Vec3f((l_aFP[0] * jj + l_aFP[1]) * l_fZ, l_fYZ * l_fZ, l_fZ);
+                }
+            }
+        }
+
+        return true;
+    }
+    else if(oHeader.m_i32Codec == SW_KINECT_POINTS_CODEC)
+    {
+        cuint l_ui32PointSize = sizeof(int) + 3 * sizeof(float);
+
+        if(oHeader.m_ui32PayloadSize % l_ui32PointSize != 0)
+        {
+            return false;
+        }
+
+        for(uint ii = 0; ii < oHeader.m_ui32PayloadSize; ii += l_ui32PointSize)
+        {
+            int l_i32Id;
+            memcpy(&l_i32Id, aUi8Payload + ii, sizeof(int));
+
+            if(l_i32Id < 0 || l_i32Id >= l_i32Width * l_i32Height)
+            {
+                return false;
+            }
+
+            memcpy(&oCloud.at<cv::Vec3f>(l_i32Id)[0], aUi8Payload + ii + sizeof(int), 3 * sizeof(float));
+        }
+
+        return true;
+    }
+
+    return false;
+}
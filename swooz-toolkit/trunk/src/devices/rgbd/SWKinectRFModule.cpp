@@ -39,6 +39,7 @@ using namespace yarp::os;
 bool SWKinectRFModule::configure()
 {
     m_kinectThread.init(0);
+    m_kinectThread.setChannels(swDevice::KINECT_BGR_IMAGE | swDevice::KINECT_DEPTH_MAP);
     m_kinectThread.startListening();
 
     m_rgbPort.open("/tracking/image:o");
@@ -50,11 +51,14 @@ bool SWKinectRFModule::configure()
 
 bool SWKinectRFModule::updateModule()
 {
-    cv::Mat rgb   = m_kinectThread.bgrImage().clone();
-    cv::Mat depth = m_kinectThread.depthMap().clone();
+    // the frame is only read, no copy needed
+    swDevice::SWKinectFramePtr frame = m_kinectThread.frame();
 
-    if(rgb.rows > 0)
+    if(frame && frame->m_oBgrImage.rows > 0)
     {
+        const cv::Mat &rgb   = frame->m_oBgrImage;
+        const cv::Mat &depth = frame->m_oDepthMap;
+
         m_rgb = m_rgbPort.prepare();
 
         m_rgb.resize(rgb.rows, rgb.cols);
@@ -0,0 +1,869 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWKinectSimulator.cpp
+ * \brief Defines SWKinectSimulator
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#include "devices/rgbd/SWKinectSimulator.h"
+#include "devices/rgbd/SWLoadKinectData.h"
+
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "boost/thread.hpp"
+
+#include "SWExceptions.h"
+#include "SWProfiler.h"
+
+using namespace cv;
+using namespace std;
+using namespace swDevice;
+using namespace swExcept;
+
+#define SW_SIMULATOR_FOCAL          525.f           /**< focal of the kinect depth camera in VGA (pixels) */
+#define SW_SIMULATOR_MESH_HEIGHT    0.24f           /**< height of the rendered mesh (meters) */
+#define SW_SIMULATOR_WALL_DEPTH     2.f             /**< depth of the wall behind the mesh (meters) */
+#define SW_SIMULATOR_BASELINE_FOCAL (75.f * 575.f)  /**< baseline (mm) * focal (pixels) used by openni for the disparity map */
+
+static const double SW_SIMULATOR_PI = 3.14159265358979323846;
+
+static const Vec3b SW_SIMULATOR_SKIN_COLOR(125, 155, 210);  /**< bgr color of the vertices without texture */
+static const Vec3b SW_SIMULATOR_WALL_COLOR(95, 100, 105);   /**< bgr color of the wall */
+
+
+SWKinectSimulator::SWKinectSimulator(bool bVerbose) : SWKinect(bVerbose), m_eRate(SIMULATION_REAL_TIME), m_ui32FramesNb(0), m_ui32FrameId(0),
+    m_bEnded(false), m_i64StartTime(-1), m_oFrameSize(640, 480), m_i32Fps(30), m_ui32RecordingFrame(0), m_dRecordingOffset(0.), m_dLastRecordingTime(0.)
+{
+    buildProceduralHead();
+}
+
+SWKinectSimulator::~SWKinectSimulator(void)
+{}
+
+boost::shared_ptr<SWKinectSimulator> SWKinectSimulator::fromEnvironment(bool bVerbose)
+{
+    const char *l_sSource = getenv("SWOOZ_RGBD_SIMULATOR");
+
+    if(!l_sSource || string(l_sSource).empty())
+    {
+        return boost::shared_ptr<SWKinectSimulator>();
+    }
+
+    boost::shared_ptr<SWKinectSimulator> l_pSimulator(new SWKinectSimulator(bVerbose));
+
+    // source
+        string l_sSourcePath(l_sSource);
+        string l_sExtension = l_sSourcePath.size() > 4 ? l_sSourcePath.substr(l_sSourcePath.size() - 4) : "";
+        std::transform(l_sExtension.begin(), l_sExtension.end(), l_sExtension.begin(), ::tolower);
+
+        bool l_bLoaded = true;
+        if(l_sSourcePath != "head")
+        {
+            l_bLoaded = (l_sExtension == ".obj") ? l_pSimulator->setMesh(l_sSourcePath) : l_pSimulator->setRecording(l_sSourcePath);
+        }
+
+        if(!l_bLoaded)
+        {
+            cerr << "-ERROR : SWKinectSimulator::fromEnvironment, invalid SWOOZ_RGBD_SIMULATOR source : " << l_sSourcePath << endl;
+            return boost::shared_ptr<SWKinectSimulator>();
+        }
+
+    // rate
+        const char *l_sRate = getenv("SWOOZ_RGBD_SIMULATOR_RATE");
+        if(l_sRate)
+        {
+            string l_sRateName(l_sRate);
+
+            if(l_sRateName == "fastest")
+            {
+                l_pSimulator->setRate(SIMULATION_AS_FAST_AS_POSSIBLE);
+            }
+            else if(l_sRateName == "lockstep")
+            {
+                l_pSimulator->setRate(SIMULATION_LOCK_STEP);
+            }
+            else if(l_sRateName != "realtime")
+            {
+                cerr << "-WARNING : SWKinectSimulator::fromEnvironment, unknown SWOOZ_RGBD_SIMULATOR_RATE " << l_sRateName << ", realtime used. " << endl;
+            }
+        }
+
+    // frames number
+        const char *l_sFramesNb = getenv("SWOOZ_RGBD_SIMULATOR_FRAMES");
+        if(l_sFramesNb)
+        {
+            l_pSimulator->setFramesNumber(static_cast<uint>(std::max(0, atoi(l_sFramesNb))));
+        }
+
+    // motion
+        const char *l_sMotion = getenv("SWOOZ_RGBD_SIMULATOR_MOTION");
+        if(l_sMotion && !l_pSimulator->setMotionScript(l_sMotion))
+        {
+            return boost::shared_ptr<SWKinectSimulator>();
+        }
+
+    if(bVerbose)
+    {
+        cout << "Simulated rgbd device, source : " << l_sSourcePath << " rate : " << (l_sRate ? l_sRate : "realtime") << endl;
+    }
+
+    return l_pSimulator;
+}
+
+bool SWKinectSimulator::setRecording(const std::string &sRecordingPath)
+{
+    m_sRecordingPath = sRecordingPath;
+
+    // SWLoadKinectData appends the file names to the path
+    if(!m_sRecordingPath.empty() && m_sRecordingPath[m_sRecordingPath.size()-1] != '/' && m_sRecordingPath[m_sRecordingPath.size()-1] != '\\')
+    {
+        m_sRecordingPath += '/';
+    }
+
+    // SWLoadKinectData::start doesn't report its failures, a first frame is read to check the recording
+    Mat l_oFirstFrame;
+    openRecording();
+    if(!m_pRecording->grabVideo(l_oFirstFrame))
+    {
+        cerr << "-ERROR : SWKinectSimulator::setRecording, cannot load the recording " << sRecordingPath << endl;
+        m_sRecordingPath.clear();
+        m_pRecording.reset();
+        return false;
+    }
+
+    openRecording();
+
+    return true;
+}
+
+bool SWKinectSimulator::setMesh(const std::string &sObjPath)
+{
+    m_sRecordingPath.clear();
+    m_pRecording.reset();
+
+    if(sObjPath.empty())
+    {
+        buildProceduralHead();
+        return true;
+    }
+
+    ifstream l_oFile(sObjPath.c_str());
+    if(!l_oFile.is_open())
+    {
+        cerr << "-ERROR : SWKinectSimulator::setMesh, cannot open " << sObjPath << endl;
+        return false;
+    }
+
+    string l_sDirectory = sObjPath.substr(0, sObjPath.find_last_of("/\\") + 1);
+    string l_sTexturePath;
+
+    vector<Vec3f> l_vVertices;
+    vector<Vec2f> l_vUV;
+    vector<Vec3i> l_vTriangles, l_vTrianglesUV;
+
+    string l_sLine;
+    while(getline(l_oFile, l_sLine))
+    {
+        istringstream l_oLine(l_sLine);
+        string l_sType;
+        l_oLine >> l_sType;
+
+        if(l_sType == "v")
+        {
+            Vec3f l_oVertex;
+            l_oLine >> l_oVertex[0] >> l_oVertex[1] >> l_oVertex[2];
+            l_vVertices.push_back(l_oVertex);
+        }
+        else if(l_sType == "vt")
+        {
+            Vec2f l_oUV;
+            l_oLine >> l_oUV[0] >> l_oUV[1];
+            l_vUV.push_back(l_oUV);
+        }
+        else if(l_sType == "f")
+        {
+            // corners "v", "v/vt", "v/vt/vn" or "v//vn", 1-based or negative (relative) ids, polygons triangulated as fans
+            vector<int> l_vCornerVertices, l_vCornerUV;
+            string l_sCorner;
+
+            while(l_oLine >> l_sCorner)
+            {
+                int l_i32Vertex = atoi(l_sCorner.c_str()), l_i32UV = 0;
+                size_t l_ui32Slash = l_sCorner.find('/');
+                if(l_ui32Slash != string::npos && l_ui32Slash + 1 < l_sCorner.size() && l_sCorner[l_ui32Slash + 1] != '/')
+                {
+                    l_i32UV = atoi(l_sCorner.c_str() + l_ui32Slash + 1);
+                }
+
+                l_vCornerVertices.push_back(l_i32Vertex < 0 ? static_cast<int>(l_vVertices.size()) + l_i32Vertex : l_i32Vertex - 1);
+                l_vCornerUV.push_back(l_i32UV < 0 ? static_cast<int>(l_vUV.size()) + l_i32UV : l_i32UV - 1);
+            }
+
+            for(int ii = 1; ii + 1 < static_cast<int>(l_vCornerVertices.size()); ++ii)
+            {
+                l_vTriangles.push_back(Vec3i(l_vCornerVertices[0], l_vCornerVertices[ii], l_vCornerVertices[ii+1]));
+                l_vTrianglesUV.push_back(Vec3i(l_vCornerUV[0], l_vCornerUV[ii], l_vCornerUV[ii+1]));
+            }
+        }
+        else if(l_sType == "mtllib")
+        {
+            string l_sMaterialName;
+            l_oLine >> l_sMaterialName;
+
+            ifstream l_oMaterialFile((l_sDirectory + l_sMaterialName).c_str());
+            string l_sMaterialLine;
+            while(getline(l_oMaterialFile, l_sMaterialLine) && l_sTexturePath.empty())
+            {
+                istringstream l_oMaterialLine(l_sMaterialLine);
+                string l_sKey, l_sTextureName;
+                l_oMaterialLine >> l_sKey >> l_sTextureName;
+
+                if(l_sKey == "map_Kd" && !l_sTextureName.empty())
+                {
+                    l_sTexturePath = l_sDirectory + l_sTextureName;
+                }
+            }
+        }
+    }
+
+    // remove the triangles with invalid ids
+        cint l_i32VerticesNb = static_cast<int>(l_vVertices.size()), l_i32UVNb = static_cast<int>(l_vUV.size());
+        m_vMeshTriangles.clear();
+        m_vMeshTrianglesUV.clear();
+
+        for(uint ii = 0; ii < l_vTriangles.size(); ++ii)
+        {
+            bool l_bValid = true, l_bValidUV = true;
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                l_bValid   = l_bValid   && l_vTriangles[ii][jj]   >= 0 && l_vTriangles[ii][jj]   < l_i32VerticesNb;
+                l_bValidUV = l_bValidUV && l_vTrianglesUV[ii][jj] >= 0 && l_vTrianglesUV[ii][jj] < l_i32UVNb;
+            }
+
+            if(l_bValid)
+            {
+                m_vMeshTriangles.push_back(l_vTriangles[ii]);
+                m_vMeshTrianglesUV.push_back(l_bValidUV ? l_vTrianglesUV[ii] : Vec3i(-1,-1,-1));
+            }
+        }
+
+        if(m_vMeshTriangles.empty())
+        {
+            cerr << "-ERROR : SWKinectSimulator::setMesh, no triangle in " << sObjPath << endl;
+            buildProceduralHead();
+            return false;
+        }
+
+    // center the mesh and scale it to the size of a head
+        Vec3f l_oMin = l_vVertices[0], l_oMax = l_vVertices[0];
+        for(uint ii = 1; ii < l_vVertices.size(); ++ii)
+        {
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                l_oMin[jj] = std::min(l_oMin[jj], l_vVertices[ii][jj]);
+                l_oMax[jj] = std::max(l_oMax[jj], l_vVertices[ii][jj]);
+            }
+        }
+
+        Vec3f l_oCenter = (l_oMin + l_oMax) * 0.5f;
+        float l_fHeight = l_oMax[1] - l_oMin[1];
+        float l_fScale  = l_fHeight > 0.f ? SW_SIMULATOR_MESH_HEIGHT / l_fHeight : 1.f;
+
+        m_vMeshVertices.resize(l_vVertices.size());
+        for(uint ii = 0; ii < l_vVertices.size(); ++ii)
+        {
+            m_vMeshVertices[ii] = (l_vVertices[ii] - l_oCenter) * l_fScale;
+        }
+
+        m_vMeshColors.assign(m_vMeshVertices.size(), SW_SIMULATOR_SKIN_COLOR);
+        m_vMeshUV = l_vUV;
+
+    // texture
+        m_oMeshTexture.release();
+        if(!l_sTexturePath.empty())
+        {
+            m_oMeshTexture = imread(l_sTexturePath, 1);
+
+            if(m_oMeshTexture.empty())
+            {
+                cerr << "-WARNING : SWKinectSimulator::setMesh, cannot load the texture " << l_sTexturePath << ", vertex colors used. " << endl;
+            }
+        }
+
+    if(m_bVerbose)
+    {
+        cout << "Simulated mesh : " << m_vMeshVertices.size() << " vertices, " << m_vMeshTriangles.size() << " triangles, "
+             << (m_oMeshTexture.empty() ? "no texture" : l_sTexturePath) << endl;
+    }
+
+    return true;
+}
+
+bool SWKinectSimulator::setMotionScript(const std::string &sScriptPath)
+{
+    m_vMotionTimes.clear();
+    m_vMotionRotations.clear();
+    m_vMotionTranslations.clear();
+
+    if(sScriptPath.empty())
+    {
+        return true;
+    }
+
+    ifstream l_oFile(sScriptPath.c_str());
+    if(!l_oFile.is_open())
+    {
+        cerr << "-ERROR : SWKinectSimulator::setMotionScript, cannot open " << sScriptPath << endl;
+        return false;
+    }
+
+    string l_sLine;
+    while(getline(l_oFile, l_sLine))
+    {
+        if(l_sLine.empty() || l_sLine[0] == '#')
+        {
+            continue;
+        }
+
+        istringstream l_oLine(l_sLine);
+        float l_fTime;
+        Vec3f l_oRotation, l_oTranslation;
+
+        if(!(l_oLine >> l_fTime >> l_oRotation[0] >> l_oRotation[1] >> l_oRotation[2] >> l_oTranslation[0] >> l_oTranslation[1] >> l_oTranslation[2]))
+        {
+            continue;
+        }
+
+        if(!m_vMotionTimes.empty() && l_fTime <= m_vMotionTimes.back())
+        {
+            cerr << "-WARNING : SWKinectSimulator::setMotionScript, the key pose at " << l_fTime << "s is not increasing in time, ignored. " << endl;
+            continue;
+        }
+
+        m_vMotionTimes.push_back(l_fTime);
+        m_vMotionRotations.push_back(l_oRotation);
+        m_vMotionTranslations.push_back(l_oTranslation);
+    }
+
+    if(m_vMotionTimes.empty())
+    {
+        cerr << "-ERROR : SWKinectSimulator::setMotionScript, no key pose in " << sScriptPath << endl;
+        return false;
+    }
+
+    return true;
+}
+
+void SWKinectSimulator::setRate(const SWSimulationRate eRate)
+{
+    m_eRate = eRate;
+}
+
+SWSimulationRate SWKinectSimulator::rate() const
+{
+    return m_eRate;
+}
+
+void SWKinectSimulator::setFramesNumber(cuint ui32FramesNb)
+{
+    m_ui32FramesNb = ui32FramesNb;
+}
+
+bool SWKinectSimulator::isEnded() const
+{
+    return m_bEnded;
+}
+
+uint SWKinectSimulator::frameId() const
+{
+    return m_ui32FrameId;
+}
+
+bool SWKinectSimulator::headPose(cuint ui32FrameId, cv::Vec3f &oRotation, cv::Vec3f &oTranslation) const
+{
+    if(!m_sRecordingPath.empty())
+    {
+        return false;
+    }
+
+    double l_dTime = frameTime(ui32FrameId);
+
+    if(m_vMotionTimes.empty())
+    {
+        // default motion : the periods are chosen so that the pose doesn't repeat before a long time
+        oRotation    = Vec3f(static_cast<float>(15. * sin(2. * SW_SIMULATOR_PI * l_dTime / 6.)),
+                             static_cast<float>(30. * sin(2. * SW_SIMULATOR_PI * l_dTime / 4.)),
+                             static_cast<float>(10. * sin(2. * SW_SIMULATOR_PI * l_dTime / 5.)));
+        oTranslation = Vec3f(static_cast<float>(0.05 * sin(2. * SW_SIMULATOR_PI * l_dTime / 7.)),
+                             static_cast<float>(0.03 * sin(2. * SW_SIMULATOR_PI * l_dTime / 9.)),
+                             static_cast<float>(0.9  + 0.1 * sin(2. * SW_SIMULATOR_PI * l_dTime / 11.)));
+        return true;
+    }
+
+    // scripted motion, looped
+    double l_dDuration = m_vMotionTimes.back();
+    if(l_dDuration > 0.)
+    {
+        l_dTime = fmod(l_dTime, l_dDuration);
+    }
+
+    if(l_dTime <= m_vMotionTimes.front() || m_vMotionTimes.size() == 1)
+    {
+        oRotation    = m_vMotionRotations.front();
+        oTranslation = m_vMotionTranslations.front();
+        return true;
+    }
+
+    uint l_ui32Key = 1;
+    while(l_ui32Key < m_vMotionTimes.size() - 1 && m_vMotionTimes[l_ui32Key] < l_dTime)
+    {
+        ++l_ui32Key;
+    }
+
+    float l_fRatio = static_cast<float>((l_dTime - m_vMotionTimes[l_ui32Key-1]) / (m_vMotionTimes[l_ui32Key] - m_vMotionTimes[l_ui32Key-1]));
+    l_fRatio = std::min(1.f, std::max(0.f, l_fRatio));
+
+    oRotation    = m_vMotionRotations[l_ui32Key-1]    * (1.f - l_fRatio) + m_vMotionRotations[l_ui32Key]    * l_fRatio;
+    oTranslation = m_vMotionTranslations[l_ui32Key-1] * (1.f - l_fRatio) + m_vMotionTranslations[l_ui32Key] * l_fRatio;
+
+    return true;
+}
+
+int SWKinectSimulator::init(cint i32CaptureMode)
+{
+    m_i32CaptureMode = i32CaptureMode;
+
+    if(m_i32CaptureMode > 4 || m_i32CaptureMode < 0)
+    {
+        cerr << "Kinect, invalid capture mode. Parameter set to 0. " << endl;
+        m_i32CaptureMode = 0;
+    }
+
+    m_oFrameSize = (m_i32CaptureMode == 3 || m_i32CaptureMode == 4) ? Size(320, 240) : Size(640, 480);
+    m_i32Fps     = (m_i32CaptureMode == 1) ? 15 : ((m_i32CaptureMode == 4) ? 60 : 30);
+
+    m_ui32FrameId       = 0;
+    m_bEnded            = false;
+    m_i64StartTime      = -1;
+    m_dRecordingOffset  = 0.;
+    m_dLastRecordingTime= 0.;
+
+    if(!m_sRecordingPath.empty())
+    {
+        openRecording();
+    }
+
+    if(m_bVerbose)
+    {
+        cout << "Simulated device : " << m_oFrameSize.width << "x" << m_oFrameSize.height << " " << m_i32Fps << " fps, "
+             << (m_sRecordingPath.empty() ? "rendered mesh" : m_sRecordingPath) << endl;
+    }
+
+    m_bKinectInitalized = true;
+
+    return 0;
+}
+
+int SWKinectSimulator::grab(void)
+{
+    if(!m_bKinectInitalized)
+    {
+        cerr << "Simulated device not initialized, grab failed. " << endl;
+        throw kinectInitError();
+        return -1;
+    }
+
+    if(m_bEnded || (m_ui32FramesNb > 0 && m_ui32FrameId >= m_ui32FramesNb))
+    {
+        m_bEnded = true;
+        return -1;
+    }
+
+    // produce the frame
+        double l_dTime;
+
+        if(m_sRecordingPath.empty())
+        {
+            render(m_ui32FrameId);
+            l_dTime = frameTime(m_ui32FrameId);
+        }
+        else if(!grabRecording(l_dTime))
+        {
+            m_bEnded = true;
+            return -1;
+        }
+
+        computeChannels();
+
+    // wait for the time of the frame
+        if(m_eRate == SIMULATION_REAL_TIME)
+        {
+            int64 l_i64FrameTime = static_cast<int64>(l_dTime * 1e6);
+
+            if(m_i64StartTime < 0)
+            {
+                m_i64StartTime = swUtil::SWProfiler::timeUs() - l_i64FrameTime;
+            }
+
+            int64 l_i64Delay = m_i64StartTime + l_i64FrameTime - swUtil::SWProfiler::timeUs();
+            if(l_i64Delay > 0)
+            {
+                boost::this_thread::sleep(boost::posix_time::microseconds(l_i64Delay));
+            }
+        }
+
+    ++m_ui32FrameId;
+
+    return 0;
+}
+
+cv::Size SWKinectSimulator::sizeFrame()
+{
+    if(!m_sRecordingPath.empty() && !bgrImage.empty())
+    {
+        return bgrImage.size();
+    }
+
+    return m_oFrameSize;
+}
+
+int SWKinectSimulator::fps()
+{
+    return m_i32Fps;
+}
+
+void SWKinectSimulator::openRecording()
+{
+    m_pRecording = boost::shared_ptr<SWLoadKinectData>(new SWLoadKinectData(m_sRecordingPath));
+    m_pRecording->start();
+    m_ui32RecordingFrame = 0;
+}
+
+bool SWKinectSimulator::grabRecording(double &dTime)
+{
+    for(int l_i32Pass = 0; l_i32Pass < 2; ++l_i32Pass)
+    {
+        if(m_pRecording && m_pRecording->grabVideo(bgrImage) && m_pRecording->grabCloud(cloudMap))
+        {
+            float l_fTime = m_pRecording->cloudTime(m_ui32RecordingFrame);
+            dTime = m_dRecordingOffset + (l_fTime >= 0.f ? l_fTime : m_ui32RecordingFrame / static_cast<double>(m_i32Fps));
+            m_dLastRecordingTime = dTime;
+            ++m_ui32RecordingFrame;
+
+            return true;
+        }
+
+        // end of the recording, looped only if a number of frames is asked
+        if(m_ui32FramesNb == 0 || m_ui32RecordingFrame == 0)
+        {
+            return false;
+        }
+
+        openRecording();
+        m_dRecordingOffset = m_dLastRecordingTime + 1. / m_i32Fps;
+    }
+
+    return false;
+}
+
+void SWKinectSimulator::render(cuint ui32FrameId)
+{
+    Vec3f l_oRotation, l_oTranslation;
+    headPose(ui32FrameId, l_oRotation, l_oTranslation);
+
+    // rotation : roll * yaw * pitch
+        float l_fPitch = static_cast<float>(l_oRotation[0] * SW_SIMULATOR_PI / 180.);
+        float l_fYaw   = static_cast<float>(l_oRotation[1] * SW_SIMULATOR_PI / 180.);
+        float l_fRoll  = static_cast<float>(l_oRotation[2] * SW_SIMULATOR_PI / 180.);
+
+        Matx33f l_oRx(1.f, 0.f, 0.f,   0.f, cos(l_fPitch), -sin(l_fPitch),   0.f, sin(l_fPitch), cos(l_fPitch));
+        Matx33f l_oRy(cos(l_fYaw), 0.f, sin(l_fYaw),   0.f, 1.f, 0.f,   -sin(l_fYaw), 0.f, cos(l_fYaw));
+        Matx33f l_oRz(cos(l_fRoll), -sin(l_fRoll), 0.f,   sin(l_fRoll), cos(l_fRoll), 0.f,   0.f, 0.f, 1.f);
+        Matx33f l_oR = l_oRz * l_oRy * l_oRx;
+
+    // camera
+        cint   l_i32Width  = m_oFrameSize.width, l_i32Height = m_oFrameSize.height;
+        cfloat l_fFocal    = SW_SIMULATOR_FOCAL * l_i32Width / 640.f;
+        cfloat l_fCx       = (l_i32Width  - 1) * 0.5f;
+        cfloat l_fCy       = (l_i32Height - 1) * 0.5f;
+
+    // background
+        m_oZBuffer.create(l_i32Height, l_i32Width, CV_32FC1);
+        m_oZBuffer.setTo(Scalar(SW_SIMULATOR_WALL_DEPTH));
+        bgrImage.create(l_i32Height, l_i32Width, CV_8UC3);
+        bgrImage.setTo(Scalar(SW_SIMULATOR_WALL_COLOR[0], SW_SIMULATOR_WALL_COLOR[1], SW_SIMULATOR_WALL_COLOR[2]));
+
+    // transform and project the vertices
+        m_vTransformed.resize(m_vMeshVertices.size());
+        m_vProjected.resize(m_vMeshVertices.size());
+
+        for(uint ii = 0; ii < m_vMeshVertices.size(); ++ii)
+        {
+            Vec3f l_oPoint = l_oR * m_vMeshVertices[ii] + l_oTranslation;
+            m_vTransformed[ii] = l_oPoint;
+
+            if(l_oPoint[2] > 0.05f)
+            {
+                m_vProjected[ii] = Vec3f(l_fCx + l_fFocal * l_oPoint[0] / l_oPoint[2], l_fCy - l_fFocal * l_oPoint[1] / l_oPoint[2], l_oPoint[2]);
+            }
+            else
+            {
+                m_vProjected[ii] = Vec3f(0.f, 0.f, -1.f);
+            }
+        }
+
+    // rasterize the triangles in the z-buffer, perspective correct interpolation and flat shading
+        bool l_bTextured = !m_oMeshTexture.empty();
+
+        for(uint ii = 0; ii < m_vMeshTriangles.size(); ++ii)
+        {
+            const Vec3i &l_oIds = m_vMeshTriangles[ii];
+            const Vec3f &l_oA = m_vProjected[l_oIds[0]], &l_oB = m_vProjected[l_oIds[1]], &l_oC = m_vProjected[l_oIds[2]];
+
+            if(l_oA[2] <= 0.f || l_oB[2] <= 0.f || l_oC[2] <= 0.f)
+            {
+                continue;
+            }
+
+            float l_fArea = (l_oB[0] - l_oA[0]) * (l_oC[1] - l_oA[1]) - (l_oB[1] - l_oA[1]) * (l_oC[0] - l_oA[0]);
+            if(fabs(l_fArea) < 1e-6f)
+            {
+                continue;
+            }
+
+            int l_i32XMin = std::max(0,                 static_cast<int>(floor(std::min(l_oA[0], std::min(l_oB[0], l_oC[0])))));
+            int l_i32XMax = std::min(l_i32Width - 1,    static_cast<int>(ceil (std::max(l_oA[0], std::max(l_oB[0], l_oC[0])))));
+            int l_i32YMin = std::max(0,                 static_cast<int>(floor(std::min(l_oA[1], std::min(l_oB[1], l_oC[1])))));
+            int l_i32YMax = std::min(l_i32Height - 1,   static_cast<int>(ceil (std::max(l_oA[1], std::max(l_oB[1], l_oC[1])))));
+
+            if(l_i32XMin > l_i32XMax || l_i32YMin > l_i32YMax)
+            {
+                continue;
+            }
+
+            Vec3f l_oNormal = (m_vTransformed[l_oIds[1]] - m_vTransformed[l_oIds[0]]).cross(m_vTransformed[l_oIds[2]] - m_vTransformed[l_oIds[0]]);
+            float l_fNorm   = static_cast<float>(norm(l_oNormal));
+            float l_fShade  = 0.35f + 0.65f * (l_fNorm > 0.f ? fabs(l_oNormal[2]) / l_fNorm : 1.f);
+
+            const Vec3i &l_oUVIds   = m_vMeshTrianglesUV[ii];
+            bool l_bTriangleTexture = l_bTextured && l_oUVIds[0] >= 0;
+
+            for(int l_i32Y = l_i32YMin; l_i32Y <= l_i32YMax; ++l_i32Y)
+            {
+                float *l_pZBuffer = m_oZBuffer.ptr<float>(l_i32Y);
+                Vec3b *l_pBgr     = bgrImage.ptr<Vec3b>(l_i32Y);
+                float l_fY        = static_cast<float>(l_i32Y);
+
+                for(int l_i32X = l_i32XMin; l_i32X <= l_i32XMax; ++l_i32X)
+                {
+                    float l_fX  = static_cast<float>(l_i32X);
+                    float l_fW0 = ((l_oB[0] - l_fX) * (l_oC[1] - l_fY) - (l_oB[1] - l_fY) * (l_oC[0] - l_fX)) / l_fArea;
+                    float l_fW1 = ((l_oC[0] - l_fX) * (l_oA[1] - l_fY) - (l_oC[1] - l_fY) * (l_oA[0] - l_fX)) / l_fArea;
+                    float l_fW2 = 1.f - l_fW0 - l_fW1;
+
+                    if(l_fW0 < 0.f || l_fW1 < 0.f || l_fW2 < 0.f)
+                    {
+                        continue;
+                    }
+
+                    float l_fQ0 = l_fW0 / l_oA[2], l_fQ1 = l_fW1 / l_oB[2], l_fQ2 = l_fW2 / l_oC[2];
+                    float l_fZ  = 1.f / (l_fQ0 + l_fQ1 + l_fQ2);
+
+                    if(l_fZ >= l_pZBuffer[l_i32X])
+                    {
+                        continue;
+                    }
+                    l_pZBuffer[l_i32X] = l_fZ;
+
+                    Vec3f l_oColor;
+                    if(l_bTriangleTexture)
+                    {
+                        Vec2f l_oUV = (m_vMeshUV[l_oUVIds[0]] * l_fQ0 + m_vMeshUV[l_oUVIds[1]] * l_fQ1 + m_vMeshUV[l_oUVIds[2]] * l_fQ2) * l_fZ;
+                        int l_i32U = std::min(m_oMeshTexture.cols - 1, std::max(0, static_cast<int>(l_oUV[0] * (m_oMeshTexture.cols - 1) + 0.5f)));
+                        int l_i32V = std::min(m_oMeshTexture.rows - 1, std::max(0, static_cast<int>((1.f - l_oUV[1]) * (m_oMeshTexture.rows - 1) + 0.5f)));
+                        l_oColor = Vec3f(m_oMeshTexture.at<Vec3b>(l_i32V, l_i32U));
+                    }
+                    else
+                    {
+                        l_oColor = (Vec3f(m_vMeshColors[l_oIds[0]]) * l_fQ0 + Vec3f(m_vMeshColors[l_oIds[1]]) * l_fQ1 + Vec3f(m_vMeshColors[l_oIds[2]]) * l_fQ2) * l_fZ;
+                    }
+
+                    l_pBgr[l_i32X] = Vec3b(saturate_cast<uchar>(l_oColor[0] * l_fShade),
+                                           saturate_cast<uchar>(l_oColor[1] * l_fShade),
+                                           saturate_cast<uchar>(l_oColor[2] * l_fShade));
+                }
+            }
+        }
+
+    // back-project the z-buffer in the cloud map
+        cloudMap.create(l_i32Height, l_i32Width, CV_32FC3);
+
+        for(int l_i32Y = 0; l_i32Y < l_i32Height; ++l_i32Y)
+        {
+            const float *l_pZBuffer = m_oZBuffer.ptr<float>(l_i32Y);
+            Vec3f *l_pCloud         = cloudMap.ptr<Vec3f>(l_i32Y);
+
+            for(int l_i32X = 0; l_i32X < l_i32Width; ++l_i32X)
+            {
+                float l_fZ = l_pZBuffer[l_i32X];
+                l_pCloud[l_i32X] = Vec3f((l_i32X - l_fCx) * l_fZ / l_fFocal, -(l_i32Y - l_fCy) * l_fZ / l_fFocal, l_fZ);
+            }
+        }
+}
+
+void SWKinectSimulator::computeChannels()
+{
+    bool l_bDepth = (m_i32Channels & (KINECT_DEPTH_MAP | KINECT_NORMALIZED_DEPTH_MAP)) != 0;
+    bool l_bDisparity = (m_i32Channels & KINECT_DISPARITY_MAP) != 0;
+
+    if(l_bDepth)
+    {
+        depthMap.create(cloudMap.size(), CV_16UC1);
+    }
+    if(l_bDisparity)
+    {
+        disparityMap.create(cloudMap.size(), CV_8UC1);
+    }
+
+    if(l_bDepth || l_bDisparity)
+    {
+        for(int l_i32Y = 0; l_i32Y < cloudMap.rows; ++l_i32Y)
+        {
+            const Vec3f *l_pCloud = cloudMap.ptr<Vec3f>(l_i32Y);
+            ushort *l_pDepth      = l_bDepth     ? depthMap.ptr<ushort>(l_i32Y)    : NULL;
+            uchar  *l_pDisparity  = l_bDisparity ? disparityMap.ptr<uchar>(l_i32Y) : NULL;
+
+            for(int l_i32X = 0; l_i32X < cloudMap.cols; ++l_i32X)
+            {
+                float l_fDepth = l_pCloud[l_i32X][2] * 1000.f; // mm
+
+                if(l_pDepth)
+                {
+                    l_pDepth[l_i32X] = l_fDepth > 0.f ? saturate_cast<ushort>(l_fDepth) : 0;
+                }
+                if(l_pDisparity)
+                {
+                    l_pDisparity[l_i32X] = l_fDepth > 0.f ? saturate_cast<uchar>(SW_SIMULATOR_BASELINE_FOCAL / l_fDepth) : 0;
+                }
+            }
+        }
+    }
+
+    if(m_i32Channels & KINECT_GRAY_IMAGE)
+    {
+        cvtColor(bgrImage, grayImage, CV_BGR2GRAY);
+    }
+
+    if(m_i32Channels & KINECT_NORMALIZED_DEPTH_MAP)
+    {
+        normalizeDepthImage();
+    }
+}
+
+void SWKinectSimulator::buildProceduralHead()
+{
+    cint l_i32Rings = 64, l_i32Segments = 96;
+    cfloat l_fA = 0.075f, l_fB = 0.11f, l_fC = 0.095f; // half width, half height, half depth (meters)
+
+    m_vMeshVertices.clear();
+    m_vMeshColors.clear();
+    m_vMeshUV.clear();
+    m_vMeshTriangles.clear();
+    m_vMeshTrianglesUV.clear();
+    m_oMeshTexture.release();
+
+    // ellipsoid, the face is towards -z, with a nose and dark spots for the eyes, the eyebrows, the mouth and the hair
+    for(int ii = 0; ii <= l_i32Rings; ++ii)
+    {
+        float l_fTheta = static_cast<float>(SW_SIMULATOR_PI * ii / l_i32Rings);
+
+        for(int jj = 0; jj < l_i32Segments; ++jj)
+        {
+            float l_fPhi = static_cast<float>(2. * SW_SIMULATOR_PI * jj / l_i32Segments);
+
+            float l_fX =  l_fA * sin(l_fTheta) * sin(l_fPhi);
+            float l_fY =  l_fB * cos(l_fTheta);
+            float l_fZ = -l_fC * sin(l_fTheta) * cos(l_fPhi);
+            bool l_bFront = cos(l_fPhi) > 0.f;
+
+            if(l_bFront)
+            {
+                float l_fNoseX = l_fX / 0.014f, l_fNoseY = (l_fY + 0.005f) / 0.03f;
+                l_fZ -= 0.025f * exp(-(l_fNoseX * l_fNoseX + l_fNoseY * l_fNoseY));
+            }
+
+            Vec3b l_oColor = SW_SIMULATOR_SKIN_COLOR;
+            float l_fEyeX  = (fabs(l_fX) - 0.03f) / 0.012f, l_fEyeY = (l_fY - 0.02f) / 0.008f;
+            float l_fBrowX = (fabs(l_fX) - 0.03f) / 0.02f,  l_fBrowY = (l_fY - 0.04f) / 0.005f;
+            float l_fMouthX = l_fX / 0.028f, l_fMouthY = (l_fY + 0.05f) / 0.008f;
+
+            if(l_fY > 0.07f || (!l_bFront && l_fY > -0.02f))
+            {
+                l_oColor = Vec3b(30, 40, 55);
+            }
+            else if(l_fEyeX * l_fEyeX + l_fEyeY * l_fEyeY < 1.f)
+            {
+                l_oColor = Vec3b(35, 35, 35);
+            }
+            else if(l_fBrowX * l_fBrowX + l_fBrowY * l_fBrowY < 1.f)
+            {
+                l_oColor = Vec3b(30, 45, 60);
+            }
+            else if(l_fMouthX * l_fMouthX + l_fMouthY * l_fMouthY < 1.f)
+            {
+                l_oColor = Vec3b(70, 70, 160);
+            }
+
+            m_vMeshVertices.push_back(Vec3f(l_fX, l_fY, l_fZ));
+            m_vMeshColors.push_back(l_oColor);
+        }
+    }
+
+    for(int ii = 0; ii < l_i32Rings; ++ii)
+    {
+        for(int jj = 0; jj < l_i32Segments; ++jj)
+        {
+            int l_i32Id00 =  ii      * l_i32Segments + jj,  l_i32Id01 =  ii      * l_i32Segments + (jj + 1) % l_i32Segments;
+            int l_i32Id10 = (ii + 1) * l_i32Segments + jj,  l_i32Id11 = (ii + 1) * l_i32Segments + (jj + 1) % l_i32Segments;
+
+            m_vMeshTriangles.push_back(Vec3i(l_i32Id00, l_i32Id10, l_i32Id11));
+            m_vMeshTriangles.push_back(Vec3i(l_i32Id00, l_i32Id11, l_i32Id01));
+            m_vMeshTrianglesUV.push_back(Vec3i(-1,-1,-1));
+            m_vMeshTrianglesUV.push_back(Vec3i(-1,-1,-1));
+        }
+    }
+}
+
+double SWKinectSimulator::frameTime(cuint ui32FrameId) const
+{
+    return ui32FrameId / static_cast<double>(m_i32Fps);
+}
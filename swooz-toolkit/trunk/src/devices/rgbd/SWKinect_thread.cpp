@@ -31,15 +31,36 @@
  */
 
 #include "devices/rgbd/SWKinect_thread.h"
+#include "devices/rgbd/SWSaveKinectData_thread.h"
+#include "devices/rgbd/SWKinectSimulator.h"
 
 #include "SWExceptions.h"
+#include "SWProfiler.h"
 
 using namespace cv;
 using namespace std;
 using namespace swDevice;
 using namespace swExcept;
 
-SWKinect_thread::SWKinect_thread(bool bVerbose) : m_oKinect(SWKinect(bVerbose)),m_bInitialized(false), m_bDataAvailable(false)
+SWKinect_thread::SWKinect_thread(bool bVerbose) : m_bInitialized(false), m_bDataAvailable(false), m_pRecorder(NULL),
+    m_i32Channels(KINECT_ALL_CHANNELS & ~KINECT_NORMALIZED_DEPTH_MAP), m_ui32FrameId(0), m_bLockStep(false), m_ui32ConsumedId(0)
+{
+    // the simulated device replaces the sensor when asked by the environment
+    boost::shared_ptr<SWKinectSimulator> l_pSimulator = SWKinectSimulator::fromEnvironment(bVerbose);
+
+    if(l_pSimulator)
+    {
+        m_pKinect   = l_pSimulator;
+        m_bLockStep = (l_pSimulator->rate() == SIMULATION_LOCK_STEP);
+    }
+    else
+    {
+        m_pKinect = boost::shared_ptr<SWKinect>(new SWKinect(bVerbose));
+    }
+}
+
+SWKinect_thread::SWKinect_thread(boost::shared_ptr<SWKinect> pDevice, cbool bLockStep) : m_pKinect(pDevice), m_bInitialized(false), m_bDataAvailable(false),
+    m_pRecorder(NULL), m_i32Channels(KINECT_ALL_CHANNELS & ~KINECT_NORMALIZED_DEPTH_MAP), m_ui32FrameId(0), m_bLockStep(bLockStep), m_ui32ConsumedId(0)
 {}
 
 SWKinect_thread::~SWKinect_thread(void)
@@ -54,7 +75,7 @@ int SWKinect_thread::init(cint i32CaptureMode)
 {
     try
     {
-        m_oKinect.init(i32CaptureMode);
+        m_pKinect->init(i32CaptureMode);
     }
     catch( const swKinectError &e)
     {
@@ -71,7 +92,26 @@ int SWKinect_thread::init(cint i32CaptureMode)
 void SWKinect_thread::setRecalibration(cbool bRecalib, cint i32XCalibrate, cint i32YCalibrate)
 {
 	boost::lock_guard<boost::mutex> lock(m_oMutex);
-	m_oKinect.setRecalibration(bRecalib, i32XCalibrate, i32YCalibrate);
+	m_pKinect->setRecalibration(bRecalib, i32XCalibrate, i32YCalibrate);
+}
+
+void SWKinect_thread::setChannels(cint i32Channels)
+{
+	boost::lock_guard<boost::mutex> lock(m_oMutex);
+	m_i32Channels = i32Channels & ~KINECT_NORMALIZED_DEPTH_MAP;
+}
+
+void SWKinect_thread::setLockStep(cbool bLockStep)
+{
+	boost::lock_guard<boost::mutex> lock(m_oMutex);
+	m_bLockStep = bLockStep;
+	m_oConsumedCondition.notify_all();
+}
+
+void SWKinect_thread::setRecorder(SWSaveKinectData_thread *pRecorder)
+{
+	boost::lock_guard<boost::mutex> lock(m_oMutex);
+	m_pRecorder = pRecorder;
 }
 
 void SWKinect_thread::startListening()
@@ -89,7 +129,7 @@ void SWKinect_thread::startListening()
 
 			if(l_i32WaitTimeOut % 10 == 0)
 			{
-                if(m_oKinect.m_bVerbose)
+                if(m_pKinect->m_bVerbose)
                     std::cout << "Waiting  for kinect data... " << std::endl;
 			}
 			if(l_i32WaitTimeOut > 500)
@@ -101,7 +141,7 @@ void SWKinect_thread::startListening()
 			++l_i32WaitTimeOut;
 		}
 
-        if(m_oKinect.m_bVerbose)
+        if(m_pKinect->m_bVerbose)
             std::cout << "Kinect data available. " << std::endl;
 	}
 	else
@@ -116,8 +156,26 @@ void SWKinect_thread::stopListening()
 	if(m_bListening)
 	{
         m_bListening 	 = false;
-        m_bDataAvailable = false;
         m_pListeningThread->join();
+
+        boost::lock_guard<boost::mutex> lock(m_oMutex);
+        m_bDataAvailable = false;
+        m_pFrame.reset();
+	}
+}
+
+/**
+ * \brief Copy a retrieved channel in the buffer of a frame, or release the buffer if the channel is not retrieved.
+ */
+static void copyChannel(const cv::Mat &oChannel, cint i32Retrieved, cv::Mat &oFrameMat)
+{
+	if(i32Retrieved)
+	{
+		oChannel.copyTo(oFrameMat);
+	}
+	else
+	{
+		oFrameMat.release();
 	}
 }
 
@@ -125,62 +183,184 @@ void SWKinect_thread::doWork()
 {
 	while(m_bListening)
     {
-		if(m_oKinect.grab() != -1)
+		// retrieve only the channels used by the consumers and the recorder
 		{
-			boost::lock_guard<boost::mutex> lock(m_oMutex);
-			m_oDisparityMap 	= m_oKinect.disparityMap.clone();
-            m_oCloudMap         = m_oKinect.cloudMap.clone();
-            m_oBgrImage         = m_oKinect.bgrImage.clone();
-            m_oDepthMap         = m_oKinect.depthMap.clone();
-			m_oGrayImage		= m_oKinect.grayImage.clone();	
-			m_bDataAvailable	= true;
+			boost::unique_lock<boost::mutex> lock(m_oMutex);
+
+			// in lock-step mode, the last frame must have been consumed before grabbing the next one
+			while(m_bListening && m_bLockStep && m_ui32ConsumedId < m_ui32FrameId)
+			{
+				m_oConsumedCondition.timed_wait(lock, boost::posix_time::milliseconds(100));
+			}
+
+			if(!m_bListening)
+			{
+				break;
+			}
+
+			int l_i32Channels = m_i32Channels | (m_pRecorder ? (KINECT_BGR_IMAGE | KINECT_CLOUD_MAP) : 0);
+
+			if(l_i32Channels != m_pKinect->channels())
+			{
+				m_pKinect->setChannels(l_i32Channels);
+			}
+		}
+
+		if(m_pKinect->grab() != -1)
+		{
+			// fill a free frame of the pool outside the lock, the buffers are reused (the mats of the kinect point to the capture buffers)
+			boost::shared_ptr<SWKinectFrame> l_pFrame = availableFrame();
+			int l_i32Channels = m_pKinect->channels();
+			copyChannel(m_pKinect->disparityMap, l_i32Channels & KINECT_DISPARITY_MAP, l_pFrame->m_oDisparityMap);
+			copyChannel(m_pKinect->cloudMap,     l_i32Channels & KINECT_CLOUD_MAP,     l_pFrame->m_oCloudMap);
+			copyChannel(m_pKinect->bgrImage,     l_i32Channels & KINECT_BGR_IMAGE,     l_pFrame->m_oBgrImage);
+			copyChannel(m_pKinect->depthMap,     l_i32Channels & KINECT_DEPTH_MAP,     l_pFrame->m_oDepthMap);
+			copyChannel(m_pKinect->grayImage,    l_i32Channels & KINECT_GRAY_IMAGE,    l_pFrame->m_oGrayImage);
+			l_pFrame->m_i32Channels = l_i32Channels;
+			l_pFrame->m_oTime = clock();
+			l_pFrame->m_i64GrabTime = swUtil::SWProfiler::timeUs();
+
+			{
+				boost::lock_guard<boost::mutex> lock(m_oMutex);
+				l_pFrame->m_ui32Id	= ++m_ui32FrameId;
+				m_pFrame		= l_pFrame;
+				m_bDataAvailable	= true;
+
+				// the copy in the ring of the recorder doesn't wait for the writing (a recorder set during the grab is fed from the next frame)
+				cint l_i32RecordedChannels = KINECT_BGR_IMAGE | KINECT_CLOUD_MAP;
+				if(m_pRecorder && (l_i32Channels & l_i32RecordedChannels) == l_i32RecordedChannels &&
+				   !m_pRecorder->save(l_pFrame->m_oBgrImage, l_pFrame->m_oCloudMap))
+				{
+					m_pRecorder = NULL;
+				}
+			}
+
+			m_oFrameCondition.notify_all();
+		}
+		else
+		{
+			// the simulated device is ended
+			boost::this_thread::sleep(boost::posix_time::milliseconds(10));
 		}
 	}
+
+	m_oFrameCondition.notify_all();
 }
 
-bool SWKinect_thread::isDataAvailable()
+/**
+ * \brief Indicates if the buffers of a cv::Mat are shared with another header.
+ */
+static bool isMatShared(const cv::Mat &oMat)
+{
+	return oMat.refcount && *oMat.refcount > 1;
+}
+
+boost::shared_ptr<SWKinectFrame> SWKinect_thread::availableFrame()
+{
+	// the last published frame is held by m_pFrame, so it is never reused here. A frame is free when the pool is its
+	// only owner and when no cv::Mat returned by the accessors shares its buffers.
+	for(uint ii = 0; ii < m_vFramePool.size(); ++ii)
+	{
+		const boost::shared_ptr<SWKinectFrame> &l_pFrame = m_vFramePool[ii];
+
+		if(l_pFrame.unique() && !isMatShared(l_pFrame->m_oDisparityMap) && !isMatShared(l_pFrame->m_oCloudMap) &&
+		   !isMatShared(l_pFrame->m_oBgrImage) && !isMatShared(l_pFrame->m_oDepthMap) && !isMatShared(l_pFrame->m_oGrayImage))
+		{
+			return l_pFrame;
+		}
+	}
+
+	boost::shared_ptr<SWKinectFrame> l_pFrame(new SWKinectFrame);
+
+	// frames kept for a long time by the consumers are not added to the pool
+	if(m_vFramePool.size() < 8)
+	{
+		m_vFramePool.push_back(l_pFrame);
+	}
+
+	return l_pFrame;
+}
+
+SWKinectFramePtr SWKinect_thread::frame()
 {
 	boost::lock_guard<boost::mutex> lock(m_oMutex);
-	return m_bDataAvailable;
+	consumed();
+	return m_pFrame;
 }
 
-cv::Mat SWKinect_thread::cloudMap()
+void SWKinect_thread::consumed()
 {
+	if(m_pFrame && m_ui32ConsumedId < m_pFrame->m_ui32Id)
 	{
-		boost::lock_guard<boost::mutex> lock(m_oMutex);
+		m_ui32ConsumedId = m_pFrame->m_ui32Id;
 
-		if(m_bDataAvailable)
+		if(m_bLockStep)
 		{
-            return m_oCloudMap;
+			m_oConsumedCondition.notify_all();
 		}
 	}
+}
+
+SWKinectFramePtr SWKinect_thread::waitFrame(cuint ui32LastId, cint i32TimeOutMs)
+{
+	boost::unique_lock<boost::mutex> lock(m_oMutex);
+
+	boost::system_time l_oTimeOut = boost::get_system_time() + boost::posix_time::milliseconds(i32TimeOutMs);
+
+	while(m_bListening && m_ui32FrameId <= ui32LastId)
+	{
+		if(!m_oFrameCondition.timed_wait(lock, l_oTimeOut))
+		{
+			return SWKinectFramePtr();
+		}
+	}
+
+	if(m_ui32FrameId <= ui32LastId)
+	{
+		return SWKinectFramePtr();
+	}
+
+	consumed();
+	return m_pFrame;
+}
+
+bool SWKinect_thread::isDataAvailable()
+{
+	boost::lock_guard<boost::mutex> lock(m_oMutex);
+	return m_bDataAvailable;
+}
+
+cv::Mat SWKinect_thread::cloudMap()
+{
+	SWKinectFramePtr l_pFrame = frame();
+
+	if(l_pFrame)
+	{
+		return l_pFrame->m_oCloudMap;
+	}
 	
 	return cv::Mat(640, 480, CV_32FC3);
 }
 
 cv::Mat SWKinect_thread::bgrImage()
 {
+	SWKinectFramePtr l_pFrame = frame();
+
+	if(l_pFrame)
 	{
-		boost::lock_guard<boost::mutex> lock(m_oMutex);
-	
-		if(m_bDataAvailable)
-		{
-            return m_oBgrImage;
-		}
+		return l_pFrame->m_oBgrImage;
 	}
 	
-	return cv::Mat(m_oKinect.sizeFrame(), CV_8UC3);
+	return cv::Mat(m_pKinect->sizeFrame(), CV_8UC3);
 }
 
 cv::Mat SWKinect_thread::depthMap()
 {
+	SWKinectFramePtr l_pFrame = frame();
+
+	if(l_pFrame)
 	{
-		boost::lock_guard<boost::mutex> lock(m_oMutex);
-	
-		if(m_bDataAvailable)
-		{
-            return m_oDepthMap;
-		}
+		return l_pFrame->m_oDepthMap;
 	}
 	
 	return cv::Mat(640, 480, CV_16UC1);
@@ -188,13 +368,11 @@ cv::Mat SWKinect_thread::depthMap()
 
 cv::Mat SWKinect_thread::disparityMap()
 {
+	SWKinectFramePtr l_pFrame = frame();
+
+	if(l_pFrame)
 	{
-		boost::lock_guard<boost::mutex> lock(m_oMutex);
-	
-		if(m_bDataAvailable)
-		{
-            return m_oDisparityMap;
-		}
+		return l_pFrame->m_oDisparityMap;
 	}
 	
 	return cv::Mat(640, 480, CV_8UC1);
@@ -202,30 +380,28 @@ cv::Mat SWKinect_thread::disparityMap()
 
 cv::Mat SWKinect_thread::grayImage()
 {
+	SWKinectFramePtr l_pFrame = frame();
+
+	if(l_pFrame)
 	{
-		boost::lock_guard<boost::mutex> lock(m_oMutex);
-	
-		if(m_bDataAvailable)
-		{
-            return m_oGrayImage;
-		}
+		return l_pFrame->m_oGrayImage;
 	}
 	
-	return cv::Mat(m_oKinect.sizeFrame(), CV_8UC1);
+	return cv::Mat(m_pKinect->sizeFrame(), CV_8UC1);
 }
 
 
 cv::Size SWKinect_thread::sizeFrame()
 {
-	return cv::Size((int)m_oKinect.m_oCapture.get(CV_CAP_PROP_FRAME_WIDTH), (int)m_oKinect.m_oCapture.get(CV_CAP_PROP_FRAME_HEIGHT));
+	return m_pKinect->sizeFrame();
 }
 
 int SWKinect_thread::fps()
 {
-	return (int)m_oKinect.m_oCapture.get(CV_CAP_PROP_FPS);
+	return m_pKinect->fps();
 }
 
 int SWKinect_thread::captureMode()
 {
-	return m_oKinect.m_i32CaptureMode;
+	return m_pKinect->m_i32CaptureMode;
 }
@@ -32,10 +32,12 @@
 
 #include "devices/rgbd/SWLoadKinectData.h"
 
+#include <cstring>
+
 
 using namespace swDevice;
 
-SWLoadKinectData::SWLoadKinectData(const std::string &sLoadingPath) : m_bInit(false), m_sLoadingPath(sLoadingPath)
+SWLoadKinectData::SWLoadKinectData(const std::string &sLoadingPath) : m_bInit(false), m_bIsCompressedCloudData(false), m_sLoadingPath(sLoadingPath)
 {
     m_i32NumFile  = 0;
     m_i32NumPoint = 0;
@@ -78,6 +80,7 @@ SWLoadKinectData::~SWLoadKinectData()
 void SWLoadKinectData::start()
 {
     {
+        std::ifstream l_oCloud    (m_sLoadingPath + "cloud.swk",        std::ifstream::in);
         std::ifstream l_oFluxIndex(m_sLoadingPath + "index0.raw",       std::ifstream::in);
         std::ifstream l_oFluxData (m_sLoadingPath + "points0.raw",      std::ifstream::in);
         std::ifstream l_oSize     (m_sLoadingPath + "size.raw",         std::ifstream::in);
@@ -85,7 +88,8 @@ void SWLoadKinectData::start()
         std::ifstream l_oTime     (m_sLoadingPath + "timeKinect.raw",   std::ifstream::in);
         std::ifstream l_oVideo    (m_sLoadingPath + "bgr.avi",          std::ifstream::in);
 
-        m_bIsCloudData = l_oFluxIndex.good() && l_oFluxData.good() && l_oSize.good() && l_oHeader.good() && l_oTime.good();
+        m_bIsCompressedCloudData = l_oCloud.good();
+        m_bIsCloudData = m_bIsCompressedCloudData || (l_oFluxIndex.good() && l_oFluxData.good() && l_oSize.good() && l_oHeader.good() && l_oTime.good());
         m_bIsVideoData = l_oVideo.good();
     }
 
@@ -116,7 +120,15 @@ void SWLoadKinectData::start()
             }
         }
 
-        if(m_bIsCloudData)
+        if(m_bIsCompressedCloudData)
+        {
+            if(!openCloudFile())
+            {
+                m_oCloudFile.close();
+                throw std::exception();
+            }
+        }
+        else if(m_bIsCloudData)
         {
             try
             {
@@ -152,7 +164,11 @@ void SWLoadKinectData::stop()
 {
     if(m_bInit)
     {
-        if(m_bIsCloudData)
+        if(m_bIsCompressedCloudData)
+        {
+            m_oCloudFile.close();
+        }
+        else if(m_bIsCloudData)
         {
             m_oCloudHeaderFile.close();
             m_oCloudTimeKinectFile.close();
@@ -212,6 +228,11 @@ bool SWLoadKinectData::grabCloud(cv::Mat &oCloud)
         return false;
     }
 
+    if(m_bIsCompressedCloudData)
+    {
+        return grabCompressedCloud(oCloud);
+    }
+
     cv::Scalar l_oScalPoint(0.f,0.f,0.f,0.f);
     oCloud = cv::Mat(cv::Size(640,480), CV_32FC3, l_oScalPoint); // init the cloud map
 
@@ -276,3 +297,166 @@ bool SWLoadKinectData::grabCloud(cv::Mat &oCloud)
 
     return true;
 }
+
+bool SWLoadKinectData::openCloudFile()
+{
+    m_oCloudFile.open((m_sLoadingPath + "cloud.swk").c_str(), std::ios::in | std::ios::binary);
+    m_vCloudIndex.clear();
+    m_i32NumFrame = 0;
+
+    SWKinectFileHeader l_oHeader;
+    m_oCloudFile.read(reinterpret_cast<char*>(&l_oHeader), sizeof(SWKinectFileHeader));
+
+    if(!m_oCloudFile.good() || memcmp(l_oHeader.m_aCMagic, SW_KINECT_FILE_MAGIC, 8) != 0 || l_oHeader.m_i32Version != SW_KINECT_FILE_VERSION)
+    {
+        std::cerr << "Invalid cloud file " << m_sLoadingPath << "cloud.swk. " << std::endl;
+        return false;
+    }
+
+    // read the index from the trailer
+    m_oCloudFile.seekg(0, std::ios::end);
+    int64 l_i64FileSize = static_cast<int64>(m_oCloudFile.tellg());
+
+    if(l_i64FileSize >= static_cast<int64>(sizeof(SWKinectFileHeader) + sizeof(SWKinectFileTrailer)))
+    {
+        SWKinectFileTrailer l_oTrailer;
+        m_oCloudFile.seekg(l_i64FileSize - sizeof(SWKinectFileTrailer));
+        m_oCloudFile.read(reinterpret_cast<char*>(&l_oTrailer), sizeof(SWKinectFileTrailer));
+
+        if(m_oCloudFile.good() && l_oTrailer.m_ui32Magic == SW_KINECT_TRAILER_MAGIC && l_oTrailer.m_i32FramesNb >= 0 &&
+           l_oTrailer.m_i64IndexOffset + static_cast<int64>(sizeof(SWKinectIndexHeader) + l_oTrailer.m_i32FramesNb * sizeof(SWKinectIndexEntry)) <= l_i64FileSize)
+        {
+            SWKinectIndexHeader l_oIndexHeader;
+            m_oCloudFile.seekg(l_oTrailer.m_i64IndexOffset);
+            m_oCloudFile.read(reinterpret_cast<char*>(&l_oIndexHeader), sizeof(SWKinectIndexHeader));
+
+            if(m_oCloudFile.good() && l_oIndexHeader.m_ui32Magic == SW_KINECT_INDEX_MAGIC && l_oIndexHeader.m_i32FramesNb == l_oTrailer.m_i32FramesNb)
+            {
+                m_vCloudIndex.resize(l_oIndexHeader.m_i32FramesNb);
+
+                if(!m_vCloudIndex.empty())
+                {
+                    m_oCloudFile.read(reinterpret_cast<char*>(&m_vCloudIndex[0]), m_vCloudIndex.size() * sizeof(SWKinectIndexEntry));
+                }
+
+                if(m_oCloudFile.good())
+                {
+                    return true;
+                }
+            }
+        }
+    }
+
+    // no valid index : the recording has not been stopped, rebuild the index from the frames headers
+    std::cout << "No index in the cloud file, the index is rebuilt. " << std::endl;
+    m_vCloudIndex.clear();
+    m_oCloudFile.clear();
+
+    int64 l_i64Offset = sizeof(SWKinectFileHeader);
+    while(l_i64Offset + static_cast<int64>(sizeof(SWKinectFrameHeader)) <= l_i64FileSize)
+    {
+        SWKinectFrameHeader l_oFrameHeader;
+        m_oCloudFile.seekg(l_i64Offset);
+        m_oCloudFile.read(reinterpret_cast<char*>(&l_oFrameHeader), sizeof(SWKinectFrameHeader));
+
+        if(!m_oCloudFile.good() || l_oFrameHeader.m_ui32Magic != SW_KINECT_FRAME_MAGIC ||
+           l_i64Offset + static_cast<int64>(sizeof(SWKinectFrameHeader) + l_oFrameHeader.m_ui32PayloadSize) > l_i64FileSize)
+        {
+            break; // end of the frames or truncated frame
+        }
+
+        SWKinectIndexEntry l_oEntry;
+        l_oEntry.m_i64Offset = l_i64Offset;
+        l_oEntry.m_fTime     = l_oFrameHeader.m_fTime;
+        l_oEntry.m_i32Frame  = l_oFrameHeader.m_i32Frame;
+        m_vCloudIndex.push_back(l_oEntry);
+
+        l_i64Offset += sizeof(SWKinectFrameHeader) + l_oFrameHeader.m_ui32PayloadSize;
+    }
+
+    m_oCloudFile.clear();
+
+    return true;
+}
+
+bool SWLoadKinectData::grabCompressedCloud(cv::Mat &oCloud)
+{
+    if(m_i32NumFrame >= static_cast<int>(m_vCloudIndex.size()))
+    {
+        std::cout << "No more cloud data to grab, end of the loading." << std::endl;
+        stop();
+        return false;
+    }
+
+    SWKinectFrameHeader l_oHeader;
+    m_oCloudFile.seekg(m_vCloudIndex[m_i32NumFrame].m_i64Offset);
+    m_oCloudFile.read(reinterpret_cast<char*>(&l_oHeader), sizeof(SWKinectFrameHeader));
+
+    m_vPayload.resize(l_oHeader.m_ui32PayloadSize);
+    if(!m_vPayload.empty())
+    {
+        m_oCloudFile.read(reinterpret_cast<char*>(&m_vPayload[0]), m_vPayload.size());
+    }
+
+    if(!m_oCloudFile.good() || l_oHeader.m_ui32Magic != SW_KINECT_FRAME_MAGIC ||
+       !decodeKinectCloud(l_oHeader, m_vPayload.empty() ? NULL : &m_vPayload[0], oCloud))
+    {
+        std::cerr << "Corrupted cloud " << m_i32NumFrame << " in the cloud file, loading stopped." << std::endl;
+        stop();
+        return false;
+    }
+
+    ++m_i32NumFrame;
+
+    return true;
+}
+
+int SWLoadKinectData::cloudFramesNumber() const
+{
+    if(!m_bIsCompressedCloudData)
+    {
+        return -1;
+    }
+
+    return static_cast<int>(m_vCloudIndex.size());
+}
+
+float SWLoadKinectData::cloudTime(cint i32Frame) const
+{
+    if(!m_bIsCompressedCloudData || i32Frame < 0 || i32Frame >= static_cast<int>(m_vCloudIndex.size()))
+    {
+        return -1.f;
+    }
+
+    return m_vCloudIndex[i32Frame].m_fTime;
+}
+
+bool SWLoadKinectData::seekCloud(cint i32Frame)
+{
+    if(!m_bInit || !m_bIsCompressedCloudData)
+    {
+        std::cerr << "SWLoadKinectData::seekCloud : random access is only available for the cloud.swk recordings. " << std::endl;
+        return false;
+    }
+
+    if(i32Frame < 0 || i32Frame >= static_cast<int>(m_vCloudIndex.size()))
+    {
+        std::cerr << "SWLoadKinectData::seekCloud : invalid cloud id " << i32Frame << std::endl;
+        return false;
+    }
+
+    // the video and the clouds are recorded together, the video must follow the seek to stay synchronized
+    if(m_bIsVideoData)
+    {
+        if(!m_oVideoCapture.set(CV_CAP_PROP_POS_FRAMES, static_cast<double>(i32Frame)) ||
+            static_cast<int>(m_oVideoCapture.get(CV_CAP_PROP_POS_FRAMES)) != i32Frame)
+        {
+            std::cerr << "SWLoadKinectData::seekCloud : cannot seek the video to the frame " << i32Frame << ", the cloud is not moved. " << std::endl;
+            return false;
+        }
+    }
+
+    m_i32NumFrame = i32Frame;
+
+    return true;
+}
@@ -32,44 +32,15 @@
 
 #include "devices/rgbd/SWSaveKinectData.h"
 
+#include <cstring>
+
 using namespace swDevice;
 
 SWSaveKinectData::SWSaveKinectData(const std::string &sSavingPath, const double dMaxLength, const double dMaxSize, const double dMinDist, const double dMaxDist) :
     m_bInit(false), m_sSavingPath(sSavingPath), m_dMaxLength(dMaxLength), m_dMaxSize(dMaxSize), m_dMinDist(dMinDist), m_dMaxDist(dMaxDist)
 {
-    m_i32NumFile  = 0;
-    m_i32NumPoint = 0;
-    m_i32NumFile  = 0;
-    m_i32NumCloud = 0;
     m_i32NumFrame = 0;
-    m_i32CurrentDataSizeWritten  = 0;
-    m_i32CurrentIndexSizeWritten = 0;
     m_lCurrentTotalSizeWritten   = 0;
-
-    // ########################################### mapped file sizes
-
-    // 351 mo for data file / 117 for index file -> theses values can be reduced if crashs arise
-    m_oCloudIndexFileParams.new_file_size     = 30000000 *     sizeof(int);     // equiv. 40s, 30 frames/s, 25k points, 1 int
-    m_oCloudDataFileParams.new_file_size      = 30000000 * 3 * sizeof(float);   // equiv. 40s, 30 frames/s, 25k points, 3 float
-    m_oCloudSizeFileParams.new_file_size      = 500000   *     sizeof(int);     // equiv. 1 size/cloud during 4 hours at 30 fps
-    m_oCloudTimeKinectFileParams.new_file_size= 500000   *     sizeof(float);   // equiv. 1 time/cloud during 4 hours at 30 fps
-    m_oCloudHeaderFileParams.new_file_size    =(1 + 300) *     sizeof(int);     // equiv. 1 int for stocking the number of files (max 300), 300 for the numbers of cloud for each file
-
-    // ########################################### mapped file paths
-
-    m_oCloudIndexFileParams.path     =   m_sSavingPath + "index0.raw";
-    m_oCloudDataFileParams.path      =   m_sSavingPath + "points0.raw";
-    m_oCloudSizeFileParams.path      =   m_sSavingPath + "size.raw";
-    m_oCloudTimeKinectFileParams.path=   m_sSavingPath + "timeKinect.raw";
-    m_oCloudHeaderFileParams.path    =   m_sSavingPath + "header.raw";
-
-    // ########################################### mapped file pointers
-
-    m_i32HeaderNumber   	= NULL;
-    m_oCloudData 	    	= NULL;
-    m_oCloudIndex           = NULL;
-    m_oCloudTimeKinect      = NULL;
-    m_oCloudSize            = NULL;
 }
 
 SWSaveKinectData::~SWSaveKinectData()
@@ -109,33 +80,27 @@ void SWSaveKinectData::start(const bool bSaveVideoData, const bool bSaveCloudDat
 
         if(m_bSaveCloudData)
         {
-            try
-            {
-                // open mapped files
-                m_oCloudHeaderFile.open     (m_oCloudHeaderFileParams);
-                m_oCloudTimeKinectFile.open (m_oCloudTimeKinectFileParams);
-                m_oCloudIndexFile.open      (m_oCloudIndexFileParams);
-                m_oCloudDataFile.open       (m_oCloudDataFileParams);
-                m_oCloudSizeFile.open       (m_oCloudSizeFileParams);
-
-                //  init data mapped files pointers
-                m_i32HeaderNumber   	= (int *)	m_oCloudHeaderFile.data();
-                m_i32HeaderNumber[0] 	= 1;
-                m_oCloudData 	    	= (float*)  m_oCloudDataFile.data();
-                m_oCloudIndex           = (int*)    m_oCloudIndexFile.data();
-                m_oCloudTimeKinect      = (float*)  m_oCloudTimeKinectFile.data();
-                m_oCloudSize            = (int*)    m_oCloudSizeFile.data();
-
-                m_oProgramTime = clock();
-            }
-            catch(boost::exception&)
+            // open the cloud file, the frames will be appended
+            m_oCloudFile.open((m_sSavingPath + "cloud.swk").c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+            SWKinectFileHeader l_oHeader;
+            memcpy(l_oHeader.m_aCMagic, SW_KINECT_FILE_MAGIC, 8);
+            l_oHeader.m_i32Version  = SW_KINECT_FILE_VERSION;
+            l_oHeader.m_i32Reserved = 0;
+            m_oCloudFile.write(reinterpret_cast<const char*>(&l_oHeader), sizeof(SWKinectFileHeader));
+
+            if(!m_oCloudFile.good())
             {
-                m_bInit = false;
-                std::cerr << "Fail opening boost mapped files. " << std::endl;
+                std::cerr << "Fail opening cloud file " << m_sSavingPath << "cloud.swk. " << std::endl;
                 throw std::exception();
             }
+
+            m_i32NumFrame = 0;
+            m_lCurrentTotalSizeWritten = sizeof(SWKinectFileHeader);
+            m_vCloudIndex.clear();
         }
 
+        m_oProgramTime = clock();
         m_bInit = true;
     }
     catch(std::exception&)
@@ -151,6 +116,21 @@ void SWSaveKinectData::setStartTime(const clock_t oStartTime)
 }
 
 bool SWSaveKinectData::save(const cv::Mat &oData1, const cv::Mat &oData2)
+{
+    return save(oData1, oData2, clock());
+}
+
+bool SWSaveKinectData::save(const cv::Mat &oData)
+{
+    return save(oData, clock());
+}
+
+bool SWSaveKinectData::isRecording() const
+{
+    return m_bInit;
+}
+
+bool SWSaveKinectData::save(const cv::Mat &oData1, const cv::Mat &oData2, const clock_t oFrameTime)
 {
     if(!m_bInit)
     {
@@ -169,12 +149,12 @@ bool SWSaveKinectData::save(const cv::Mat &oData1, const cv::Mat &oData2)
     if(oData1.depth() == CV_8U && oData2.depth() == CV_32F)
     {
         saveVideo(oData1);
-        saveCloud(oData2);
+        saveCloud(oData2, oFrameTime);
     }
     else if(oData1.depth() == CV_32F && oData2.depth() == CV_8U)
     {
         saveVideo(oData2);
-        saveCloud(oData1);
+        saveCloud(oData1, oFrameTime);
     }
     else
     {
@@ -183,7 +163,7 @@ bool SWSaveKinectData::save(const cv::Mat &oData1, const cv::Mat &oData2)
         return false;
     }
 
-    if(m_dMaxLength < (float)(clock() - m_oProgramTime)/ CLOCKS_PER_SEC)
+    if(m_dMaxLength < (float)(oFrameTime - m_oProgramTime)/ CLOCKS_PER_SEC)
     {
         std::cout << "Time's up, end of the recording." << std::endl;
         stop();
@@ -201,7 +181,7 @@ bool SWSaveKinectData::save(const cv::Mat &oData1, const cv::Mat &oData2)
 }
 
 
-bool SWSaveKinectData::save(const cv::Mat &oData)
+bool SWSaveKinectData::save(const cv::Mat &oData, const clock_t oFrameTime)
 {
     if(!m_bInit)
     {
@@ -223,7 +203,7 @@ bool SWSaveKinectData::save(const cv::Mat &oData)
     }
     else if(oData.depth() == CV_32F)
     {
-        saveCloud(oData);
+        saveCloud(oData, oFrameTime);
     }
     else
     {
@@ -232,7 +212,7 @@ bool SWSaveKinectData::save(const cv::Mat &oData)
         return true;
     }
 
-    if(m_dMaxLength < (float)(clock() - m_oProgramTime)/ CLOCKS_PER_SEC)
+    if(m_dMaxLength < (float)(oFrameTime - m_oProgramTime)/ CLOCKS_PER_SEC)
     {
         std::cout << "Time's up, end of the recording." << std::endl;
         stop();
@@ -262,97 +242,73 @@ void SWSaveKinectData::saveVideo(const cv::Mat &oBgr)
     }
 }
 
-void SWSaveKinectData::saveCloud(const cv::Mat &oCloud)
+void SWSaveKinectData::saveCloud(const cv::Mat &oCloud, const clock_t oFrameTime)
 {
-    // save kinect time
-    m_oCloudTimeKinect[m_i32NumFrame] = (float)(clock() - m_oProgramTime)/ CLOCKS_PER_SEC;
-
-    // save cloud points
-    int l_i32NumPointsToAdd = 0;
-    for(int ii = 0; ii < oCloud.rows * oCloud.cols; ++ii)
+    if(!m_oCloudFile.is_open())
     {
-        cv::Point3f l_p3fCurrPoint = oCloud.at<cv::Point3f>(ii);
-
-        if(l_p3fCurrPoint.z > m_dMinDist && l_p3fCurrPoint.z < m_dMaxDist)
-        {
-            m_oCloudData[3*(l_i32NumPointsToAdd+m_i32NumPoint)]   = l_p3fCurrPoint.x;
-            m_oCloudData[3*(l_i32NumPointsToAdd+m_i32NumPoint)+1] = l_p3fCurrPoint.y;
-            m_oCloudData[3*(l_i32NumPointsToAdd+m_i32NumPoint)+2] = l_p3fCurrPoint.z;
-
-            m_oCloudIndex[l_i32NumPointsToAdd + m_i32NumPoint]      = ii;
-            ++l_i32NumPointsToAdd;
-        }
+        return;
     }
 
-    // save cloud size
-    m_oCloudSize[m_i32NumFrame] = l_i32NumPointsToAdd;
-
-    // update mapped files parameters
-    m_i32NumPoint += l_i32NumPointsToAdd;
-    ++m_i32NumCloud;
-    ++m_i32HeaderNumber[m_i32NumFile + 1];
-    ++m_i32NumFrame;
-
-    int l_i32CurrentDataSize      = 3 * sizeof(float) * l_i32NumPointsToAdd;
-    int l_i32CurrentIndexSize     =     sizeof(int)   * l_i32NumPointsToAdd;
-    m_i32CurrentDataSizeWritten  += l_i32CurrentDataSize;
-    m_i32CurrentIndexSizeWritten += l_i32CurrentIndexSize;
-    m_lCurrentTotalSizeWritten   += l_i32CurrentDataSize + l_i32CurrentIndexSize;
-
-    // check if new mapped files must be created
-    if((m_i32CurrentDataSizeWritten  + 5 * l_i32CurrentDataSize   > m_oCloudDataFileParams.new_file_size) ||
-       (m_i32CurrentIndexSizeWritten + 5 * l_i32CurrentIndexSize > m_oCloudIndexFileParams.new_file_size))
+    // code the cloud
+    SWKinectFrameHeader l_oHeader;
+    l_oHeader.m_ui32Magic = SW_KINECT_FRAME_MAGIC;
+    l_oHeader.m_i32Frame  = m_i32NumFrame;
+    l_oHeader.m_fTime     = (float)(oFrameTime - m_oProgramTime)/ CLOCKS_PER_SEC;
+    encodeKinectCloud(oCloud, static_cast<float>(m_dMinDist), static_cast<float>(m_dMaxDist), l_oHeader, m_vPayload);
+
+    // append it to the file
+    SWKinectIndexEntry l_oEntry;
+    l_oEntry.m_i64Offset = m_lCurrentTotalSizeWritten;
+    l_oEntry.m_fTime     = l_oHeader.m_fTime;
+    l_oEntry.m_i32Frame  = m_i32NumFrame;
+
+    m_oCloudFile.write(reinterpret_cast<const char*>(&l_oHeader), sizeof(SWKinectFrameHeader));
+    if(!m_vPayload.empty())
     {
-        std::cout << "Mapped file num " << m_i32NumFile++ << " full, create a new file. " << std::endl;
-
-        // reset numbers of points and index and data/index sizes
-        m_i32NumPoint = 0;
-        m_i32NumCloud = 0;
-        m_i32CurrentDataSizeWritten  = 0;
-        m_i32CurrentIndexSizeWritten = 0;
-
-        // set num file string
-        std::ostringstream l_osNumFile;
-        l_osNumFile.str("");
-        l_osNumFile.clear();
-        l_osNumFile << m_i32NumFile;
-
-        // close mapped files
-        m_oCloudDataFile.close();
-        m_oCloudIndexFile.close();
-
-        // set the new path
-        m_oCloudDataFileParams.path  = m_sSavingPath + "points" + l_osNumFile.str() + ".raw";
-        m_oCloudIndexFileParams.path = m_sSavingPath + "index"  + l_osNumFile.str() + ".raw";
-
-        ++m_i32HeaderNumber[0];
+        m_oCloudFile.write(reinterpret_cast<const char*>(&m_vPayload[0]), m_vPayload.size());
+    }
 
-        try
-        {
-            m_oCloudDataFile.open (m_oCloudDataFileParams);
-            m_oCloudIndexFile.open(m_oCloudIndexFileParams);
-            m_oCloudData  = (float*) m_oCloudDataFile.data();
-            m_oCloudIndex = (int*)   m_oCloudIndexFile.data();
-        }
-        catch(boost::exception&)
-        {
-            std::cerr << "Fail opening new boost mapped files. Recording stopped.  " << std::endl;
-            stop();
-        }
+    if(!m_oCloudFile.good())
+    {
+        std::cerr << "Fail writing the cloud file. Recording stopped.  " << std::endl;
+        stop();
+        return;
     }
+
+    m_vCloudIndex.push_back(l_oEntry);
+    m_lCurrentTotalSizeWritten += sizeof(SWKinectFrameHeader) + m_vPayload.size();
+    ++m_i32NumFrame;
 }
 
 void SWSaveKinectData::stop()
 {
     if(m_bInit)
     {
-        if(m_bSaveCloudData)
+        if(m_bSaveCloudData && m_oCloudFile.is_open())
         {
-            m_oCloudHeaderFile.close();
-            m_oCloudTimeKinectFile.close();
-            m_oCloudIndexFile.close();
-            m_oCloudDataFile.close();
-            m_oCloudSizeFile.close();
+            // write the index of the clouds and the trailer
+            SWKinectIndexHeader l_oIndexHeader;
+            l_oIndexHeader.m_ui32Magic   = SW_KINECT_INDEX_MAGIC;
+            l_oIndexHeader.m_i32FramesNb = static_cast<int>(m_vCloudIndex.size());
+
+            SWKinectFileTrailer l_oTrailer;
+            l_oTrailer.m_i64IndexOffset = m_lCurrentTotalSizeWritten;
+            l_oTrailer.m_i32FramesNb    = l_oIndexHeader.m_i32FramesNb;
+            l_oTrailer.m_ui32Magic      = SW_KINECT_TRAILER_MAGIC;
+
+            m_oCloudFile.write(reinterpret_cast<const char*>(&l_oIndexHeader), sizeof(SWKinectIndexHeader));
+            if(!m_vCloudIndex.empty())
+            {
+                m_oCloudFile.write(reinterpret_cast<const char*>(&m_vCloudIndex[0]), m_vCloudIndex.size() * sizeof(SWKinectIndexEntry));
+            }
+            m_oCloudFile.write(reinterpret_cast<const char*>(&l_oTrailer), sizeof(SWKinectFileTrailer));
+
+            if(!m_oCloudFile.good())
+            {
+                std::cerr << "Fail writing the index of the cloud file, it will be rebuilt at the loading. " << std::endl;
+            }
+
+            m_oCloudFile.close();
         }
 
         m_bInit = false;
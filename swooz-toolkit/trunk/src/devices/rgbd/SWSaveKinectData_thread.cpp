@@ -0,0 +1,257 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWSaveKinectData_thread.cpp
+ * \brief Defines SWSaveKinectData_thread
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#include "devices/rgbd/SWSaveKinectData_thread.h"
+
+#include <algorithm>
+
+using namespace swDevice;
+
+SWSaveKinectData_thread::SWSaveKinectData_thread(const std::string &sSavingPath, const double dMaxLength, const double dMaxSize,
+                                                 const double dMinDist, const double dMaxDist, cint i32RingSize) :
+    m_oSaver(sSavingPath, dMaxLength, dMaxSize, dMinDist, dMaxDist), m_vRing(std::max(2, i32RingSize)),
+    m_ui32PushedId(0), m_ui32WrittenId(0), m_bWriting(false), m_bRecording(false),
+    m_i32DroppedFrames(0), m_i32MaxQueuedFrames(0), m_i32WrittenFrames(0)
+{}
+
+SWSaveKinectData_thread::~SWSaveKinectData_thread()
+{
+    stop();
+}
+
+bool SWSaveKinectData_thread::start(const bool bSaveVideoData, const bool bSaveCloudData)
+{
+    stop();
+
+    m_oSaver.start(bSaveVideoData, bSaveCloudData);
+
+    if(!m_oSaver.isRecording())
+    {
+        return false;
+    }
+
+    // allocate the ring once, the copies of the frames will then reuse the buffers
+    for(uint ii = 0; ii < m_vRing.size(); ++ii)
+    {
+        m_vRing[ii].m_bBgr   = false;
+        m_vRing[ii].m_bCloud = false;
+        m_vRing[ii].m_oBgr.create(480, 640, CV_8UC3);
+        m_vRing[ii].m_oCloud.create(480, 640, CV_32FC3);
+    }
+
+    m_ui32PushedId       = 0;
+    m_ui32WrittenId      = 0;
+    m_i32DroppedFrames   = 0;
+    m_i32MaxQueuedFrames = 0;
+    m_i32WrittenFrames   = 0;
+
+    m_bRecording    = true;
+    m_bWriting      = true;
+    m_pWriterThread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&SWSaveKinectData_thread::doWork, this)));
+
+    return true;
+}
+
+bool SWSaveKinectData_thread::save(const cv::Mat &oData1, const cv::Mat &oData2)
+{
+    if(oData1.depth() == CV_8U && oData2.depth() == CV_32F)
+    {
+        return push(&oData1, &oData2);
+    }
+    else if(oData1.depth() == CV_32F && oData2.depth() == CV_8U)
+    {
+        return push(&oData2, &oData1);
+    }
+
+    std::cerr << "Error : parameters mat depth SWSaveKinectData_thread::save. Recording stopped. " << std::endl;
+    m_bRecording = false;
+
+    return false;
+}
+
+bool SWSaveKinectData_thread::save(const cv::Mat &oData)
+{
+    if(oData.depth() == CV_8U)
+    {
+        return push(&oData, NULL);
+    }
+    else if(oData.depth() == CV_32F)
+    {
+        return push(NULL, &oData);
+    }
+
+    std::cerr << "Error : parameters mat depth SWSaveKinectData_thread::save. Recording stopped. " << std::endl;
+    m_bRecording = false;
+
+    return false;
+}
+
+bool SWSaveKinectData_thread::push(const cv::Mat *pBgr, const cv::Mat *pCloud)
+{
+    if(!m_bRecording)
+    {
+        return false;
+    }
+
+    uint l_ui32PushedId = m_ui32PushedId;
+    uint l_ui32Queued   = l_ui32PushedId - m_ui32WrittenId;
+
+    if(l_ui32Queued >= m_vRing.size())
+    {
+        // the writer thread is late, the capture must not wait
+        ++m_i32DroppedFrames;
+        return true;
+    }
+
+    // the slot must not be filled before the writer thread has released it
+    SW_RING_BARRIER();
+
+    SWKinectFrameSlot &l_oSlot = m_vRing[l_ui32PushedId % m_vRing.size()];
+    l_oSlot.m_oTime  = clock();
+    l_oSlot.m_bBgr   = pBgr   != NULL;
+    l_oSlot.m_bCloud = pCloud != NULL;
+
+    if(pBgr)
+    {
+        pBgr->copyTo(l_oSlot.m_oBgr);
+    }
+    if(pCloud)
+    {
+        pCloud->copyTo(l_oSlot.m_oCloud);
+    }
+
+    // the content of the slot must be visible before the new index
+    SW_RING_BARRIER();
+    m_ui32PushedId = l_ui32PushedId + 1;
+
+    m_i32MaxQueuedFrames = std::max(m_i32MaxQueuedFrames, static_cast<int>(l_ui32Queued + 1));
+
+    return true;
+}
+
+void SWSaveKinectData_thread::doWork()
+{
+    while(true)
+    {
+        bool l_bWriting = m_bWriting;
+        SW_RING_BARRIER();
+
+        uint l_ui32WrittenId = m_ui32WrittenId;
+
+        if(l_ui32WrittenId == m_ui32PushedId)
+        {
+            if(!l_bWriting)
+            {
+                break; // stop has been called and the ring is empty
+            }
+
+            boost::this_thread::sleep(boost::posix_time::milliseconds(2));
+            continue;
+        }
+
+        SW_RING_BARRIER();
+
+        SWKinectFrameSlot &l_oSlot = m_vRing[l_ui32WrittenId % m_vRing.size()];
+
+        if(m_bRecording)
+        {
+            bool l_bSaved;
+
+            if(l_oSlot.m_bBgr && l_oSlot.m_bCloud)
+            {
+                l_bSaved = m_oSaver.save(l_oSlot.m_oBgr, l_oSlot.m_oCloud, l_oSlot.m_oTime);
+            }
+            else
+            {
+                l_bSaved = m_oSaver.save(l_oSlot.m_bBgr ? l_oSlot.m_oBgr : l_oSlot.m_oCloud, l_oSlot.m_oTime);
+            }
+
+            if(l_bSaved)
+            {
+                ++m_i32WrittenFrames;
+            }
+            else
+            {
+                // the saver stops itself when the time or the size limit is reached or after an error
+                m_bRecording = false;
+            }
+        }
+
+        // the slot is released after the saving
+        SW_RING_BARRIER();
+        m_ui32WrittenId = l_ui32WrittenId + 1;
+    }
+}
+
+void SWSaveKinectData_thread::stop()
+{
+    if(m_pWriterThread)
+    {
+        m_bWriting = false;
+        m_pWriterThread->join();
+        m_pWriterThread.reset();
+    }
+
+    m_oSaver.stop();
+    m_bRecording = false;
+}
+
+bool SWSaveKinectData_thread::isRecording() const
+{
+    return m_bRecording;
+}
+
+int SWSaveKinectData_thread::pushedFramesNumber() const
+{
+    return static_cast<int>(m_ui32PushedId);
+}
+
+int SWSaveKinectData_thread::droppedFramesNumber() const
+{
+    return m_i32DroppedFrames;
+}
+
+int SWSaveKinectData_thread::writtenFramesNumber() const
+{
+    return m_i32WrittenFrames;
+}
+
+int SWSaveKinectData_thread::maxQueuedFramesNumber() const
+{
+    return m_i32MaxQueuedFrames;
+}
+
+void SWSaveKinectData_thread::displayCounters() const
+{
+    std::cout << "Frames pushed : " << pushedFramesNumber() << " written : " << writtenFramesNumber() << " dropped : " << droppedFramesNumber()
+              << " max queued : " << maxQueuedFramesNumber() << "/" << m_vRing.size() << std::endl;
+}
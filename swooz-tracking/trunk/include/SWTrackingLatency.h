@@ -0,0 +1,470 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWTrackingLatency.h
+ * \brief Defines SWLatencyHistogram, SWLatencyMonitor and SWCommandLatency, latencies of the typed messages from the capture to the robot command.
+ * \author Florian Lance
+ * \date 16/10/26
+ *
+ *  The latencies are computed from the times of the message header (see SWTrackingMessage.h), for each path (stream and device lib)
+ *  and each hop :
+ *      capture_to_send     : capture of the data -> first sending by the tracking module, the wait of the device frames before their
+ *                            processing included (the EMICP source time is the grab time of the kinect frame)
+ *      relay               : first sending -> last sending by the relays (swooz-manipulation), only for the relayed messages
+ *      transport           : last sending -> reception by the teleoperation module
+ *      capture_to_receive  : capture of the data -> reception by the teleoperation module
+ *      receive_to_command  : reception -> first robot command using the received data
+ *      capture_to_command  : capture of the data -> first robot command (motion-to-actuation latency)
+ *
+ *  The bottles of values have no times, only their receive_to_command hop is measured.
+ */
+
+#ifndef _SWTRACKINGLATENCY_
+#define _SWTRACKINGLATENCY_
+
+#include <map>
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include "SWTrackingMessage.h"
+
+#include <yarp/os/BufferedPort.h>
+#include <yarp/os/Mutex.h>
+
+#define SW_LATENCY_BIN_WIDTH        100     /**< width of the histograms bins (us) */
+#define SW_LATENCY_BINS_NB          5000    /**< number of bins of the histograms, the latencies above 500 ms are counted in the overflow */
+#define SW_LATENCY_PUBLISH_PERIOD   1.      /**< default period of the monitoring port bottles (s) */
+
+namespace swTracking
+{
+    /**
+     * \brief Return the latency path of a stream.
+     * \param [in] sStream     : stream name (head, gaze, face, hand...)
+     * \param [in] i32DeviceId : DeviceLib of the sender
+     */
+    inline std::string latencyPath(const std::string &sStream, cint i32DeviceId)
+    {
+        return sStream + "/" + returnStringValue(i32DeviceId);
+    }
+
+    /**
+     * \class SWLatencyHistogram
+     * \brief Histogram of latencies with fixed width bins.
+     */
+    class SWLatencyHistogram
+    {
+        public :
+
+            /**
+             * \brief SWLatencyHistogram constructor.
+             * \param [in] i64BinWidthUs : width of the bins (us)
+             * \param [in] ui32BinsNb    : number of bins
+             */
+            SWLatencyHistogram(cint64 i64BinWidthUs = SW_LATENCY_BIN_WIDTH, cuint ui32BinsNb = SW_LATENCY_BINS_NB)
+                : m_i64BinWidthUs(i64BinWidthUs), m_vBins(ui32BinsNb, 0), m_ui32OverflowNb(0), m_ui32Count(0), m_i64SumUs(0), m_i64MaxUs(0)
+            {}
+
+            /**
+             * \brief Add a latency, the negative latencies (clocks of different computers) are counted as 0.
+             * \param [in] i64LatencyUs : latency (us)
+             */
+            void add(cint64 i64LatencyUs)
+            {
+                int64 l_i64LatencyUs = i64LatencyUs > 0 ? i64LatencyUs : 0;
+                size_t l_ui32Bin = static_cast<size_t>(l_i64LatencyUs / m_i64BinWidthUs);
+
+                if(l_ui32Bin < m_vBins.size())
+                {
+                    ++m_vBins[l_ui32Bin];
+                }
+                else
+                {
+                    ++m_ui32OverflowNb;
+                }
+
+                ++m_ui32Count;
+                m_i64SumUs += l_i64LatencyUs;
+                m_i64MaxUs  = l_i64LatencyUs > m_i64MaxUs ? l_i64LatencyUs : m_i64MaxUs;
+            }
+
+            /**
+             * \brief Return the number of latencies added.
+             */
+            uint count() const
+            {
+                return m_ui32Count;
+            }
+
+            /**
+             * \brief Return a percentile of the latencies (ms), the upper bound of its bin (the maximum latency if it is in the overflow).
+             * \param [in] dPercent : percentile [0 100]
+             */
+            double percentile(cdouble dPercent) const
+            {
+                if(m_ui32Count == 0)
+                {
+                    return 0.;
+                }
+
+                uint l_ui32Rank = static_cast<uint>(dPercent * 0.01 * (m_ui32Count - 1)) + 1, l_ui32Sum = 0;
+
+                for(size_t ii = 0; ii < m_vBins.size(); ++ii)
+                {
+                    l_ui32Sum += m_vBins[ii];
+
+                    if(l_ui32Sum >= l_ui32Rank)
+                    {
+                        double l_dUpperBound = 0.001 * (ii + 1) * m_i64BinWidthUs;
+                        return l_dUpperBound < maximum() ? l_dUpperBound : maximum();
+                    }
+                }
+
+                return maximum();
+            }
+
+            /**
+             * \brief Return the mean of the latencies (ms).
+             */
+            double mean() const
+            {
+                return m_ui32Count > 0 ? 0.001 * m_i64SumUs / m_ui32Count : 0.;
+            }
+
+            /**
+             * \brief Return the maximum latency (ms).
+             */
+            double maximum() const
+            {
+                return 0.001 * m_i64MaxUs;
+            }
+
+            /**
+             * \brief Add the non empty bins to a bottle : (lower bound of the bin (ms), count) pairs, the overflow is added with the maximum latency.
+             * \param [out] oBottle : bottle to fill
+             */
+            void addBins(yarp::os::Bottle &oBottle) const
+            {
+                for(size_t ii = 0; ii < m_vBins.size(); ++ii)
+                {
+                    if(m_vBins[ii] > 0)
+                    {
+                        oBottle.addDouble(0.001 * ii * m_i64BinWidthUs);
+                        oBottle.addInt(static_cast<int>(m_vBins[ii]));
+                    }
+                }
+
+                if(m_ui32OverflowNb > 0)
+                {
+                    oBottle.addDouble(maximum());
+                    oBottle.addInt(static_cast<int>(m_ui32OverflowNb));
+                }
+            }
+
+        private :
+
+            int64 m_i64BinWidthUs;      /**< width of the bins (us) */
+            std::vector<uint> m_vBins;  /**< number of latencies of each bin */
+            uint m_ui32OverflowNb;      /**< number of latencies above the last bin */
+            uint m_ui32Count;           /**< number of latencies */
+            int64 m_i64SumUs;           /**< sum of the latencies (us) */
+            int64 m_i64MaxUs;           /**< maximum latency (us) */
+    };
+
+    /**
+     * \class SWLatencyMonitor
+     * \brief Latency histograms of the received messages for each path and hop, published on a monitoring port.
+     *
+     *  Each bottle of the monitoring port contains one list per path and hop :
+     *  (path hop count p50 p99 max mean (bins...)), the times in ms, the bins as in SWLatencyHistogram::addBins.
+     *  The histograms are cumulated since the opening. The record functions are thread safe.
+     */
+    class SWLatencyMonitor
+    {
+        public :
+
+            /**
+             * \brief SWLatencyMonitor constructor.
+             */
+            SWLatencyMonitor() : m_bOpened(false), m_dPublishPeriod(SW_LATENCY_PUBLISH_PERIOD), m_dLastPublishTime(-1.)
+            {}
+
+            /**
+             * \brief SWLatencyMonitor destructor.
+             */
+            ~SWLatencyMonitor()
+            {
+                close();
+            }
+
+            /**
+             * \brief Open the monitoring port, the latencies are recorded even if the port is not opened.
+             * \param [in] sPortName      : name of the monitoring port
+             * \param [in] dPublishPeriod : minimum time between two bottles (s)
+             * \return false if the port can't be opened
+             */
+            bool open(const std::string &sPortName, cdouble dPublishPeriod = SW_LATENCY_PUBLISH_PERIOD)
+            {
+                m_dPublishPeriod = dPublishPeriod;
+
+                if(!m_oPort.open(sPortName.c_str()))
+                {
+                    std::cerr << "-ERROR : SWLatencyMonitor::open, unable to open the latency port " << sPortName << std::endl;
+                    return (m_bOpened = false);
+                }
+
+                return (m_bOpened = true);
+            }
+
+            /**
+             * \brief Interrupt the monitoring port.
+             */
+            void interrupt()
+            {
+                if(m_bOpened)
+                {
+                    m_oPort.interrupt();
+                }
+            }
+
+            /**
+             * \brief Close the monitoring port.
+             */
+            void close()
+            {
+                if(m_bOpened)
+                {
+                    m_oPort.close();
+                    m_bOpened = false;
+                }
+            }
+
+            /**
+             * \brief Record a latency.
+             * \param [in] sPath        : path of the message (see latencyPath)
+             * \param [in] sHop         : hop name
+             * \param [in] i64LatencyUs : latency (us)
+             */
+            void record(const std::string &sPath, const std::string &sHop, cint64 i64LatencyUs)
+            {
+                m_oMutex.lock();
+                    m_mHistograms[std::make_pair(sPath, sHop)].add(i64LatencyUs);
+                m_oMutex.unlock();
+            }
+
+            /**
+             * \brief Record the hops of a received message.
+             * \param [in] sPath          : path of the message (see latencyPath)
+             * \param [in] oHeader        : header of the message
+             * \param [in] i64ReceiveTime : reception time (us, see messageTimeUs)
+             * \return false if the message has no times (bottle of values)
+             */
+            bool recordMessage(const std::string &sPath, const SWTrackingMessageHeader &oHeader, cint64 i64ReceiveTime)
+            {
+                if(oHeader.m_i64SourceTime <= 0 || oHeader.m_i64SendTime <= 0)
+                {
+                    return false;
+                }
+
+                record(sPath, "capture_to_send", oHeader.m_i64SendTime - oHeader.m_ui32RelayTime - oHeader.m_i64SourceTime);
+
+                if(oHeader.m_ui32RelayTime > 0)
+                {
+                    record(sPath, "relay", oHeader.m_ui32RelayTime);
+                }
+
+                record(sPath, "transport",          i64ReceiveTime - oHeader.m_i64SendTime);
+                record(sPath, "capture_to_receive", i64ReceiveTime - oHeader.m_i64SourceTime);
+
+                return true;
+            }
+
+            /**
+             * \brief Publish the histograms on the monitoring port if the publish period is elapsed.
+             * \param [in] bForce : publish whatever the period
+             * \return true if a bottle has been written
+             */
+            bool publish(cbool bForce = false)
+            {
+                double l_dTime = yarp::os::Time::now();
+
+                if(!m_bOpened || (!bForce && m_dLastPublishTime >= 0. && l_dTime - m_dLastPublishTime < m_dPublishPeriod))
+                {
+                    return false;
+                }
+
+                m_dLastPublishTime = l_dTime;
+
+                yarp::os::Bottle &l_oBottle = m_oPort.prepare();
+                l_oBottle.clear();
+
+                m_oMutex.lock();
+                    for(std::map<std::pair<std::string,std::string>, SWLatencyHistogram>::const_iterator it = m_mHistograms.begin(); it != m_mHistograms.end(); ++it)
+                    {
+                        yarp::os::Bottle &l_oHop = l_oBottle.addList();
+                        l_oHop.addString(it->first.first.c_str());
+                        l_oHop.addString(it->first.second.c_str());
+                        l_oHop.addInt(static_cast<int>(it->second.count()));
+                        l_oHop.addDouble(it->second.percentile(50.));
+                        l_oHop.addDouble(it->second.percentile(99.));
+                        l_oHop.addDouble(it->second.maximum());
+                        l_oHop.addDouble(it->second.mean());
+                        it->second.addBins(l_oHop.addList());
+                    }
+                m_oMutex.unlock();
+
+                m_oPort.write();
+
+                return true;
+            }
+
+            /**
+             * \brief Copy the histogram of a path and hop.
+             * \param [in]  sPath      : path of the message (see latencyPath)
+             * \param [in]  sHop       : hop name
+             * \param [out] oHistogram : histogram
+             * \return false if no latency has been recorded for this path and hop
+             */
+            bool histogram(const std::string &sPath, const std::string &sHop, SWLatencyHistogram &oHistogram)
+            {
+                bool l_bFound = false;
+
+                m_oMutex.lock();
+                    std::map<std::pair<std::string,std::string>, SWLatencyHistogram>::const_iterator it = m_mHistograms.find(std::make_pair(sPath, sHop));
+                    if(it != m_mHistograms.end())
+                    {
+                        oHistogram = it->second;
+                        l_bFound   = true;
+                    }
+                m_oMutex.unlock();
+
+                return l_bFound;
+            }
+
+            /**
+             * \brief Display the count, the p50, the p99 and the maximum of each path and hop.
+             * \param [in] oStream : output stream
+             */
+            void display(std::ostream &oStream)
+            {
+                m_oMutex.lock();
+                    for(std::map<std::pair<std::string,std::string>, SWLatencyHistogram>::const_iterator it = m_mHistograms.begin(); it != m_mHistograms.end(); ++it)
+                    {
+                        oStream << it->first.first << " " << it->first.second << " : " << it->second.count() << " samples, p50 " << it->second.percentile(50.)
+                                << " ms, p99 " << it->second.percentile(99.) << " ms, max " << it->second.maximum() << " ms" << std::endl;
+                    }
+                m_oMutex.unlock();
+            }
+
+        private :
+
+            bool m_bOpened;                 /**< is the monitoring port opened ? */
+            double m_dPublishPeriod;        /**< minimum time between two bottles (s) */
+            double m_dLastPublishTime;      /**< time of the last bottle (s), -1 before the first one */
+
+            yarp::os::Mutex m_oMutex;                                                           /**< protects the histograms */
+            std::map<std::pair<std::string,std::string>, SWLatencyHistogram> m_mHistograms;     /**< histograms by path and hop */
+            yarp::os::BufferedPort<yarp::os::Bottle> m_oPort;                                   /**< monitoring port */
+    };
+
+    /**
+     * \class SWCommandLatency
+     * \brief Times of the last received message of a path, waiting for its first robot command.
+     */
+    class SWCommandLatency
+    {
+        public :
+
+            /**
+             * \brief SWCommandLatency constructor, nothing waiting.
+             */
+            SWCommandLatency() : m_i64SourceTime(0), m_i64ReceiveTime(-1)
+            {}
+
+            /**
+             * \brief Set a received message as waiting for its command.
+             * \param [in] sPath          : path of the message (see latencyPath)
+             * \param [in] oHeader        : header of the message (set to 0 for a bottle of values)
+             * \param [in] i64ReceiveTime : reception time (us, see messageTimeUs)
+             */
+            void received(const std::string &sPath, const SWTrackingMessageHeader &oHeader, cint64 i64ReceiveTime)
+            {
+                m_sPath          = sPath;
+                m_i64SourceTime  = oHeader.m_i64SourceTime;
+                m_i64ReceiveTime = i64ReceiveTime;
+            }
+
+            /**
+             * \brief Set a received bottle of values (without times) as waiting for its command.
+             * \param [in] sPath          : path of the bottle (see latencyPath)
+             * \param [in] i64ReceiveTime : reception time (us, see messageTimeUs)
+             */
+            void received(const std::string &sPath, cint64 i64ReceiveTime)
+            {
+                m_sPath          = sPath;
+                m_i64SourceTime  = 0;
+                m_i64ReceiveTime = i64ReceiveTime;
+            }
+
+            /**
+             * \brief Is a received message waiting for its command ?
+             */
+            bool isWaiting() const
+            {
+                return m_i64ReceiveTime >= 0;
+            }
+
+            /**
+             * \brief Record the command hops of the waiting message at the current time, nothing is waiting afterwards.
+             * \param [in,out] oMonitor : monitor of the latencies
+             */
+            void commanded(SWLatencyMonitor &oMonitor)
+            {
+                if(!isWaiting())
+                {
+                    return;
+                }
+
+                int64 l_i64CommandTime = messageTimeUs();
+                oMonitor.record(m_sPath, "receive_to_command", l_i64CommandTime - m_i64ReceiveTime);
+
+                if(m_i64SourceTime > 0)
+                {
+                    oMonitor.record(m_sPath, "capture_to_command", l_i64CommandTime - m_i64SourceTime);
+                }
+
+                m_i64ReceiveTime = -1;
+            }
+
+        private :
+
+            std::string m_sPath;        /**< path of the waiting message */
+            int64 m_i64SourceTime;      /**< capture time of the waiting message (us), 0 if unknown */
+            int64 m_i64ReceiveTime;     /**< reception time of the waiting message (us), -1 if nothing is waiting */
+    };
+}
+
+#endif
@@ -0,0 +1,520 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWTrackingMessage.h
+ * \brief Typed binary messages sent by the tracking modules to the teleoperation modules
+ * \author Florian Lance
+ * \date 16/10/26
+ *
+ *  Each stream (head pose, gaze, face landmarks, hand skeleton) has a fixed layout message : a SWTrackingMessageHeader followed
+ *  by a payload made only of doubles, in the native units of the device (see the tracking module of the device).
+ *  A message is sent as a bottle containing a single blob, it is decoded with one copy, without parsing the values.
+ *  The payloads being arrays of doubles, a relay (swooz-manipulation) can modify the values without knowing the message type,
+ *  it accesses them with legacyValuesIndices to keep the indices of the previous bottles of values (its damping and shift modifiers are set by index).
+ *
+ *  The layout is the little-endian memory layout of the structures (all the swooz computers are x86).
+ *  The times are in microseconds on the message clock (see messageTimeUs), comparable between the modules of the same computer,
+ *  and between computers when their clocks are synchronized.
+ *
+ *  readMessage also accepts the previous bottles of values ([device id, values...]) sent by the devices having a typed message,
+ *  so the consumers only read the named fields.
+ */
+
+#ifndef _SWTRACKINGMESSAGE_
+#define _SWTRACKINGMESSAGE_
+
+#include <cstring>
+#include <vector>
+
+#include "commonTypes.h"
+#include "SWTrackingDevice.h"
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Value.h>
+#include <yarp/os/Time.h>
+
+#define SW_TRACKING_MESSAGE_MAGIC   0x4d545753  /**< "SWTM" */
+#define SW_TRACKING_MESSAGE_VERSION 1           /**< to increment when a layout is modified */
+#define SW_FACE_LANDMARKS_MAX       128         /**< maximum number of landmarks of a face message */
+
+namespace swTracking
+{
+    /**
+     * \brief Types of the typed messages.
+     */
+    enum MessageType
+    {
+        HEAD_POSE_MESSAGE = 1, GAZE_MESSAGE, FACE_LANDMARKS_MESSAGE, HAND_SKELETON_MESSAGE
+    };
+
+    #pragma pack(push, 1)
+
+    /**
+     * \brief Header of all the typed messages (40 bytes).
+     */
+    struct SWTrackingMessageHeader
+    {
+        uint32 m_ui32Magic;         /**< SW_TRACKING_MESSAGE_MAGIC */
+        uint16 m_ui16Version;       /**< SW_TRACKING_MESSAGE_VERSION */
+        uint16 m_ui16Type;          /**< MessageType */
+        uint32 m_ui32Size;          /**< size of the message, header included (bytes) */
+        int32  m_i32DeviceId;       /**< DeviceLib */
+        uint32 m_ui32Sequence;      /**< message id, incremented by the sender */
+        uint32 m_ui32RelayTime;     /**< time spent between the first sending and the last sending by the relays (us), 0 if sent directly */
+        int64  m_i64SourceTime;     /**< capture time of the data used by the message (us) */
+        int64  m_i64SendTime;       /**< time of the last sending of the message (us) */
+    };
+
+    /**
+     * \brief Head pose (FACESHIFT_LIB, EMICP_LIB, FOREST_LIB).
+     *
+     *  The FOREST_LIB bottles of values had only the rotation, the relays don't see the translation (see legacyValuesIndices).
+     */
+    struct SWHeadPoseMessage
+    {
+        enum { Type = HEAD_POSE_MESSAGE };
+
+        SWTrackingMessageHeader m_oHeader;  /**< header */
+        double m_aDTranslation[3];          /**< head translation x y z */
+        double m_aDRotation[3];             /**< head rotation : quaternion x y z (FACESHIFT_LIB), rotation angles (EMICP_LIB, FOREST_LIB, degrees) */
+    };
+
+    /**
+     * \brief Eyes gaze (FACESHIFT_LIB).
+     */
+    struct SWGazeMessage
+    {
+        enum { Type = GAZE_MESSAGE };
+
+        SWTrackingMessageHeader m_oHeader;  /**< header */
+        double m_dLeftPitch;                /**< left eye pitch */
+        double m_dLeftYaw;                  /**< left eye yaw */
+        double m_dRightPitch;               /**< right eye pitch */
+        double m_dRightYaw;                 /**< right eye yaw */
+        double m_dLeftBlink;                /**< left eye blink [0 1], -1 if not tracked */
+        double m_dRightBlink;               /**< right eye blink [0 1], -1 if not tracked */
+    };
+
+    /**
+     * \brief Face landmarks (FACESHIFT_LIB markers), only the used landmarks are sent.
+     */
+    struct SWFaceLandmarksMessage
+    {
+        enum { Type = FACE_LANDMARKS_MESSAGE };
+
+        SWTrackingMessageHeader m_oHeader;              /**< header */
+        double m_aDLandmarks[SW_FACE_LANDMARKS_MAX][3]; /**< landmarks x y z, see landmarksNumber */
+    };
+
+    /**
+     * \brief Hand skeleton (LEAP_LIB).
+     *
+     *  The bottles of values had no thumb metacarpal, the relays don't see it (see legacyValuesIndices).
+     */
+    struct SWHandSkeletonMessage
+    {
+        enum { Type = HAND_SKELETON_MESSAGE };
+
+        SWTrackingMessageHeader m_oHeader;  /**< header */
+        double m_aDArmDirection[3];         /**< arm direction x y z */
+        double m_aDHandDirection[3];        /**< hand direction x y z */
+        double m_aDHandDirectionAngles[3];  /**< hand direction pitch roll yaw (radians) */
+        double m_aDPalmPosition[3];         /**< palm center x y z (mm) */
+        double m_aDPalmNormal[3];           /**< palm normal x y z */
+        double m_aDPalmNormalAngles[3];     /**< palm normal pitch roll yaw (radians) */
+        double m_aDBones[5][4][3];          /**< bones directions x y z : [thumb index middle ring pinky][metacarpal proximal intermediate distal] */
+    };
+
+    #pragma pack(pop)
+
+    /**
+     * \brief Return the current time of the message clock.
+     * \param [in] i64AgeUs : age of the data (us), subtracted from the current time
+     * \return the time (us)
+     */
+    inline int64 messageTimeUs(cint64 i64AgeUs = 0)
+    {
+        return static_cast<int64>(yarp::os::Time::now() * 1000000.) - i64AgeUs;
+    }
+
+    /**
+     * \brief Init a message : payload set to 0 and header filled.
+     * \param [out] oMessage        : message to init
+     * \param [in]  i32DeviceId     : DeviceLib of the sender
+     * \param [in]  ui32Sequence    : message id
+     * \param [in]  i64SourceTime   : capture time of the data (us, see messageTimeUs)
+     */
+    template<typename T>
+    inline void initMessage(T &oMessage, cint32 i32DeviceId, cuint32 ui32Sequence, cint64 i64SourceTime)
+    {
+        std::memset(&oMessage, 0, sizeof(T));
+
+        SWTrackingMessageHeader &l_oHeader = oMessage.m_oHeader;
+        l_oHeader.m_ui32Magic       = SW_TRACKING_MESSAGE_MAGIC;
+        l_oHeader.m_ui16Version     = SW_TRACKING_MESSAGE_VERSION;
+        l_oHeader.m_ui16Type        = T::Type;
+        l_oHeader.m_ui32Size        = sizeof(T);
+        l_oHeader.m_i32DeviceId     = i32DeviceId;
+        l_oHeader.m_ui32Sequence    = ui32Sequence;
+        l_oHeader.m_i64SourceTime   = i64SourceTime;
+    }
+
+    /**
+     * \brief Set the number of landmarks of a face message (the message size is reduced to the used landmarks).
+     */
+    inline void setLandmarksNumber(SWFaceLandmarksMessage &oMessage, cuint ui32LandmarksNb)
+    {
+        uint l_ui32LandmarksNb = ui32LandmarksNb < SW_FACE_LANDMARKS_MAX ? ui32LandmarksNb : SW_FACE_LANDMARKS_MAX;
+        oMessage.m_oHeader.m_ui32Size = static_cast<uint32>(sizeof(SWTrackingMessageHeader) + l_ui32LandmarksNb * 3 * sizeof(double));
+    }
+
+    /**
+     * \brief Return the number of landmarks of a face message.
+     */
+    inline uint landmarksNumber(const SWFaceLandmarksMessage &oMessage)
+    {
+        return static_cast<uint>((oMessage.m_oHeader.m_ui32Size - sizeof(SWTrackingMessageHeader)) / (3 * sizeof(double)));
+    }
+
+    /**
+     * \brief Replace the content of a bottle by a message, its send time is set to the current time.
+     * \param [out] oBottle     : bottle to send
+     * \param [in,out] oMessage : message, initialized with initMessage
+     */
+    template<typename T>
+    inline void writeMessage(yarp::os::Bottle &oBottle, T &oMessage)
+    {
+        oMessage.m_oHeader.m_i64SendTime = messageTimeUs();
+
+        oBottle.clear();
+        oBottle.add(yarp::os::Value::makeBlob(&oMessage, static_cast<int>(oMessage.m_oHeader.m_ui32Size)));
+    }
+
+    /**
+     * \brief Replace the content of a bottle by a received message forwarded by a relay (swooz-manipulation).
+     *
+     *  The time since the previous sending is added to the relay time and the send time is set to the current time,
+     *  the source time is kept.
+     * \param [out] oBottle     : bottle to send
+     * \param [in,out] pMessage : message data, checked with messageData
+     */
+    inline void relayMessage(yarp::os::Bottle &oBottle, char *pMessage)
+    {
+        SWTrackingMessageHeader &l_oHeader = *reinterpret_cast<SWTrackingMessageHeader*>(pMessage);
+
+        int64 l_i64Now = messageTimeUs();
+        if(l_oHeader.m_i64SendTime > 0 && l_i64Now > l_oHeader.m_i64SendTime)
+        {
+            l_oHeader.m_ui32RelayTime += static_cast<uint32>(l_i64Now - l_oHeader.m_i64SendTime);
+        }
+        l_oHeader.m_i64SendTime = l_i64Now;
+
+        oBottle.clear();
+        oBottle.add(yarp::os::Value::makeBlob(pMessage, static_cast<int>(l_oHeader.m_ui32Size)));
+    }
+
+    /**
+     * \brief Return the indices of the payload doubles in the order of the values of the bottles sent before the typed messages,
+     *        the payload values not sent in these bottles are not returned.
+     * \param [in] oHeader : header of the message, checked with messageData
+     * \return the indices (in doubles from the start of the payload)
+     */
+    inline std::vector<uint> legacyValuesIndices(const SWTrackingMessageHeader &oHeader)
+    {
+        uint l_ui32ValuesNb = static_cast<uint>((oHeader.m_ui32Size - sizeof(SWTrackingMessageHeader)) / sizeof(double));
+        uint l_ui32First = 0, l_ui32SkipBegin = 0, l_ui32SkipEnd = 0;
+
+        if(oHeader.m_ui16Type == HEAD_POSE_MESSAGE && oHeader.m_i32DeviceId == FOREST_LIB)
+        {
+            l_ui32First = 3; // m_aDRotation
+        }
+        else if(oHeader.m_ui16Type == HAND_SKELETON_MESSAGE)
+        {
+            l_ui32SkipBegin = 18; // m_aDBones[0][0], thumb metacarpal
+            l_ui32SkipEnd   = 21;
+        }
+
+        std::vector<uint> l_vUi32Indices;
+        for(uint ii = l_ui32First; ii < l_ui32ValuesNb; ++ii)
+        {
+            if(ii < l_ui32SkipBegin || ii >= l_ui32SkipEnd)
+            {
+                l_vUi32Indices.push_back(ii);
+            }
+        }
+
+        return l_vUi32Indices;
+    }
+
+    /**
+     * \brief Return the message blob of a bottle and check its header.
+     * \param [in]  oBottle : received bottle
+     * \param [out] oHeader : header of the message
+     * \return the message data, NULL if the bottle doesn't contain a valid typed message
+     */
+    inline const char *messageData(const yarp::os::Bottle &oBottle, SWTrackingMessageHeader &oHeader)
+    {
+        if(oBottle.size() != 1 || !oBottle.get(0).isBlob())
+        {
+            return NULL;
+        }
+
+        const yarp::os::Value &l_oBlob = oBottle.get(0);
+        size_t l_ui32Length = l_oBlob.asBlobLength();
+
+        if(l_ui32Length < sizeof(SWTrackingMessageHeader))
+        {
+            return NULL;
+        }
+
+        std::memcpy(&oHeader, l_oBlob.asBlob(), sizeof(SWTrackingMessageHeader));
+
+        if(oHeader.m_ui32Magic != SW_TRACKING_MESSAGE_MAGIC || oHeader.m_ui16Version != SW_TRACKING_MESSAGE_VERSION || oHeader.m_ui32Size != l_ui32Length ||
+           (oHeader.m_ui32Size - sizeof(SWTrackingMessageHeader)) % sizeof(double) != 0)
+        {
+            return NULL;
+        }
+
+        return l_oBlob.asBlob();
+    }
+
+    /**
+     * \brief Decode a typed message.
+     * \param [in]  oBottle  : received bottle
+     * \param [out] oMessage : decoded message
+     * \return false if the bottle doesn't contain a valid message of this type
+     */
+    template<typename T>
+    inline bool decodeMessage(const yarp::os::Bottle &oBottle, T &oMessage)
+    {
+        SWTrackingMessageHeader l_oHeader;
+        const char *l_pData = messageData(oBottle, l_oHeader);
+
+        if(!l_pData || l_oHeader.m_ui16Type != T::Type || l_oHeader.m_ui32Size > sizeof(T))
+        {
+            return false;
+        }
+
+        // the face messages are sent with only their used landmarks
+        if(l_oHeader.m_ui32Size != sizeof(T) && static_cast<int>(T::Type) != FACE_LANDMARKS_MESSAGE)
+        {
+            return false;
+        }
+
+        std::memcpy(&oMessage, l_pData, l_oHeader.m_ui32Size);
+        std::memset(reinterpret_cast<char*>(&oMessage) + l_oHeader.m_ui32Size, 0, sizeof(T) - l_oHeader.m_ui32Size);
+
+        return true;
+    }
+
+    /**
+     * \brief Convert a bottle of values sent before the typed messages, the values are read by index only here.
+     * \return false if the device doesn't send this type of message
+     */
+    inline bool decodeLegacyMessage(const yarp::os::Bottle &oBottle, SWHeadPoseMessage &oMessage)
+    {
+        int l_i32DeviceId = oBottle.get(0).asInt();
+        initMessage(oMessage, l_i32DeviceId, 0, 0);
+
+        switch(l_i32DeviceId)
+        {
+            case FACESHIFT_LIB :
+            case EMICP_LIB :
+                if(oBottle.size() < 7)
+                {
+                    return false;
+                }
+                for(int ii = 0; ii < 3; ++ii)
+                {
+                    oMessage.m_aDTranslation[ii] = oBottle.get(1 + ii).asDouble();
+                    oMessage.m_aDRotation[ii]    = oBottle.get(4 + ii).asDouble();
+                }
+            return true;
+            case FOREST_LIB :
+                if(oBottle.size() < 4)
+                {
+                    return false;
+                }
+                for(int ii = 0; ii < 3; ++ii)
+                {
+                    oMessage.m_aDRotation[ii] = oBottle.get(1 + ii).asDouble();
+                }
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * \brief Convert a bottle of values sent before the typed messages.
+     */
+    inline bool decodeLegacyMessage(const yarp::os::Bottle &oBottle, SWGazeMessage &oMessage)
+    {
+        initMessage(oMessage, oBottle.get(0).asInt(), 0, 0);
+
+        if(oMessage.m_oHeader.m_i32DeviceId != FACESHIFT_LIB || oBottle.size() < 5)
+        {
+            return false;
+        }
+
+        oMessage.m_dLeftPitch   = oBottle.get(1).asDouble();
+        oMessage.m_dLeftYaw     = oBottle.get(2).asDouble();
+        oMessage.m_dRightPitch  = oBottle.get(3).asDouble();
+        oMessage.m_dRightYaw    = oBottle.get(4).asDouble();
+        oMessage.m_dLeftBlink   = oBottle.size() > 6 ? oBottle.get(5).asDouble() : -1.;
+        oMessage.m_dRightBlink  = oBottle.size() > 6 ? oBottle.get(6).asDouble() : -1.;
+
+        return true;
+    }
+
+    /**
+     * \brief Convert a bottle of values sent before the typed messages.
+     */
+    inline bool decodeLegacyMessage(const yarp::os::Bottle &oBottle, SWFaceLandmarksMessage &oMessage)
+    {
+        initMessage(oMessage, oBottle.get(0).asInt(), 0, 0);
+
+        if(oMessage.m_oHeader.m_i32DeviceId != FACESHIFT_LIB)
+        {
+            return false;
+        }
+
+        uint l_ui32LandmarksNb = static_cast<uint>((oBottle.size() - 1) / 3);
+        setLandmarksNumber(oMessage, l_ui32LandmarksNb);
+        l_ui32LandmarksNb = landmarksNumber(oMessage);
+
+        for(uint ii = 0; ii < l_ui32LandmarksNb; ++ii)
+        {
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                oMessage.m_aDLandmarks[ii][jj] = oBottle.get(1 + ii * 3 + jj).asDouble();
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Convert a bottle of values sent before the typed messages (hand, or hand and fingers).
+     *
+     *  The thumb had only 3 bones in these bottles, they are set as the proximal, intermediate and distal bones.
+     */
+    inline bool decodeLegacyMessage(const yarp::os::Bottle &oBottle, SWHandSkeletonMessage &oMessage)
+    {
+        initMessage(oMessage, oBottle.get(0).asInt(), 0, 0);
+
+        if(oMessage.m_oHeader.m_i32DeviceId != LEAP_LIB || oBottle.size() < 19)
+        {
+            return false;
+        }
+
+        for(int ii = 0; ii < 3; ++ii)
+        {
+            oMessage.m_aDArmDirection[ii]        = oBottle.get(1 + ii).asDouble();
+            oMessage.m_aDHandDirection[ii]       = oBottle.get(4 + ii).asDouble();
+            oMessage.m_aDHandDirectionAngles[ii] = oBottle.get(7 + ii).asDouble();
+            oMessage.m_aDPalmPosition[ii]        = oBottle.get(10 + ii).asDouble();
+            oMessage.m_aDPalmNormal[ii]          = oBottle.get(13 + ii).asDouble();
+            oMessage.m_aDPalmNormalAngles[ii]    = oBottle.get(16 + ii).asDouble();
+        }
+
+        if(oBottle.size() < 76)
+        {
+            return true;
+        }
+
+        for(int ii = 0; ii < 3; ++ii)
+        {
+            for(int jj = 0; jj < 3; ++jj)
+            {
+                oMessage.m_aDBones[0][1 + ii][jj] = oBottle.get(19 + ii * 3 + jj).asDouble();
+            }
+        }
+
+        for(int ll = 1; ll < 5; ++ll)
+        {
+            for(int ii = 0; ii < 4; ++ii)
+            {
+                for(int jj = 0; jj < 3; ++jj)
+                {
+                    oMessage.m_aDBones[ll][ii][jj] = oBottle.get(28 + (ll - 1) * 12 + ii * 3 + jj).asDouble();
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Read a message from a received bottle : a typed message, or a bottle of values of a device having this type of message.
+     * \param [in]  oBottle  : received bottle
+     * \param [out] oMessage : message
+     * \return false if the bottle can't be read as this type of message (device without typed message), the bottle must be read by index
+     */
+    template<typename T>
+    inline bool readMessage(const yarp::os::Bottle &oBottle, T &oMessage)
+    {
+        if(decodeMessage(oBottle, oMessage))
+        {
+            return true;
+        }
+
+        if(oBottle.size() < 2 || !oBottle.get(0).isInt())
+        {
+            return false;
+        }
+
+        return decodeLegacyMessage(oBottle, oMessage);
+    }
+
+    /**
+     * \brief Read a received bottle and return the device which sent it.
+     *
+     *  The devices having this type of message are read with readMessage, the other ones must be read by index from the bottle.
+     * \param [in]  oBottle  : received bottle
+     * \param [out] oMessage : message, set to 0 if the bottle can't be read as this type of message
+     * \return the device id (DeviceLib), -1 for an invalid typed message
+     */
+    template<typename T>
+    inline int readMessageDevice(const yarp::os::Bottle &oBottle, T &oMessage)
+    {
+        if(readMessage(oBottle, oMessage))
+        {
+            return oMessage.m_oHeader.m_i32DeviceId;
+        }
+
+        initMessage(oMessage, -1, 0, 0);
+
+        if(oBottle.size() > 0 && oBottle.get(0).isInt())
+        {
+            return oBottle.get(0).asInt();
+        }
+
+        return -1;
+    }
+}
+
+#endif
@@ -39,6 +39,9 @@
 // LEAP
 #include "devices/leap/SWLeap.h"
 
+// TRACKING
+#include "SWTrackingMessage.h"
+
 // YARP
 
 #include <yarp/dev/all.h>
@@ -53,8 +56,9 @@
  * \class SWLeapTracking
  * \brief This module sends leap data...
  *
- * Bottles contents :
+ * Ports contents :
  *
+ *  left_arm/hand, left_arm/hand_fingers, right_arm/hand, right_arm/hand_fingers : swTracking::SWHandSkeletonMessage
  *
  */
 class SWLeapTracking : public yarp::os::RFModule
@@ -99,6 +103,14 @@ class SWLeapTracking : public yarp::os::RFModule
          */
         void initLeap();
 
+        /**
+         * \brief Fill the hand skeleton message of a hand with the last grabbed Leap data.
+         * \param [in]  bLeftHand       : left or right hand
+         * \param [in]  i64SourceTime   : grab time (us, see swTracking::messageTimeUs)
+         * \param [out] oMessage        : hand message
+         */
+        void handMessage(cbool bLeftHand, cint64 i64SourceTime, swTracking::SWHandSkeletonMessage &oMessage);
+
         /**
          * \brief Called periodically every getPeriod() seconds
          * \return true
@@ -127,6 +139,7 @@ class SWLeapTracking : public yarp::os::RFModule
         yarp::os::BufferedPort<yarp::os::Bottle> m_oHandTrackingPortLeft;           /**< ... */
 
         swDevice::SWLeap m_oLeap;         /**< Leap device */ 
+        uint m_ui32MessageId;             /**< id of the last sent messages */
 		
 };
 
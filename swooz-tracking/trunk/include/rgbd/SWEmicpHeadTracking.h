@@ -52,6 +52,11 @@
 // EMICP
 #include "cloud/SWCaptureHeadMotion.h"
 
+// UTILITY
+#include "SWProfiler.h"
+#include "SWSpscQueue.h"
+#include "boost/thread.hpp"
+
 // YARP
 #include <yarp/dev/all.h>
 #include <yarp/os/all.h>
@@ -72,6 +77,11 @@ namespace Ui {
  * \brief  Worker used in the emicp head tracking interface
  * \author Florian Lance
  * \date 10/12/13
+ *
+ *  The tracking is a two stages pipeline : a detection thread waits for the kinect frames and runs the face detection and
+ *  the cloud building (SWCaptureHeadMotion::detectHead) while the worker thread aligns the previous frame
+ *  (SWCaptureHeadMotion::alignHead) and sends the results. The stages are connected by a bounded lock-free queue, the
+ *  detection waits when the queue is full so the results are sent in the frames order with a bounded delay.
  */
 class SWEmicpHeadTrackingWorker : public QObject
 {
@@ -165,6 +175,21 @@ class SWEmicpHeadTrackingWorker : public QObject
 
     private :
 
+        /**
+         * \brief Send the per-stage latency statistics of the profiler on the profile port.
+         */
+        void sendProfileStats();
+
+        /**
+         * \brief Detection stage of the pipeline, run by m_pDetectionThread.
+         */
+        void doDetection();
+
+        /**
+         * \brief Stop and join the detection thread, the queued detections are discarded.
+         */
+        void stopDetection();
+
         bool m_bIsRGBDDeviceInitialized;/**< is rgbd device initialized ? */
         bool m_bVerbose;                /**< verbose info display ? */
         bool m_bDoWork;                 /**< do the work ? */
@@ -173,10 +198,12 @@ class SWEmicpHeadTrackingWorker : public QObject
         int m_i32Fps;                   /**< refresh rate of updateModule calling */
 
         std::string m_sHeadTrackingPortName;    /**< yarp head tracking port name */
+        std::string m_sProfilePortName;         /**< yarp latency statistics port name */
 
         swDevice::SWKinectParams m_CKinectParams;      /**< kinect video params */
 
         yarp::os::BufferedPort<yarp::os::Bottle> m_oHeadTrackingPort;   /**< yarp head tracking port */
+        yarp::os::BufferedPort<yarp::os::Bottle> m_oProfilePort;        /**< yarp latency statistics port (one [stage count p50 p99 mean] list per stage, ms) */
 
         QReadWriteLock                  m_oLoopMutex;           /**< loop mutex */
         QReadWriteLock                  m_oParametersMutex;     /**< parameters mutex */
@@ -191,6 +218,10 @@ class SWEmicpHeadTrackingWorker : public QObject
         swCloud::SWRigidMotion          m_oCurrentRigidMotion;  /**< current rigid motion */
         swDevice::SWKinect_thread       m_oKinectThread;        /**< rgbd device */
         swCloud::SWCaptureHeadMotion    m_oCaptureHeadMotion;   /**< capture head motion module */
+
+        volatile bool m_bDetectionRunning;                                      /**< is the detection thread running ? */
+        boost::shared_ptr<boost::thread> m_pDetectionThread;                    /**< detection stage thread */
+        swUtil::SWSpscQueue<swCloud::SWHeadDetection> m_oDetectionQueue;        /**< detections waiting for the alignment stage */
 };
 
 
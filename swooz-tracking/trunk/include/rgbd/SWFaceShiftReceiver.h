@@ -0,0 +1,139 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWFaceShiftReceiver.h
+ * \brief Defines SWFaceShiftReceiver
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#ifndef _SWFACESHIFTRECEIVER_
+#define _SWFACESHIFTRECEIVER_
+
+// FACESHIFT
+#include "rgbd/faceshift/fsbinarystream.h"
+#include <WinSock2.h>
+
+// BOOST
+#include "boost/thread.hpp"
+
+// SWOOZ
+#include "commonTypes.h"
+
+
+/**
+ * \class SWFaceShiftReceiver
+ * \brief Receive the faceShift stream in a dedicated thread and keep only the last tracking state.
+ *
+ *  The socket is non-blocking : the thread waits for data with select, reads all the available bytes and decodes the tracking states
+ *  in place (fs::fsBinaryStream::decode_tracking_state). Three fsTrackingData are exchanged between the thread and the reader (decoded,
+ *  latest, read), so the blendshapes and markers vectors are neither copied nor reallocated once their sizes are reached. They are
+ *  emptied before each decoding, a tracking state without blendshapes or markers block doesn't keep the ones of a previous state.
+ */
+class SWFaceShiftReceiver
+{
+    public :
+
+        /**
+         * \brief SWFaceShiftReceiver constructor.
+         */
+        SWFaceShiftReceiver();
+
+        /**
+         * \brief SWFaceShiftReceiver destructor, stop the reception.
+         */
+        ~SWFaceShiftReceiver();
+
+        /**
+         * \brief Connect to faceShift and start the reception thread.
+         * \param [in] sHost    : faceShift address
+         * \param [in] i32Port  : faceShift port
+         * \return false if the connection failed
+         */
+        bool start(const std::string &sHost = "127.0.0.1", cint i32Port = 33433);
+
+        /**
+         * \brief Stop the reception thread and close the connection.
+         */
+        void stop();
+
+        /**
+         * \brief Is the connection alive ?
+         */
+        bool isConnected() const;
+
+        /**
+         * \brief Exchange the last received tracking state with oData.
+         * \param [in,out] oData            : replaced by the last received tracking state, its previous buffers are reused by the reception
+         * \param [out] i64ReceptionTime    : reception time of the tracking state (us, see swUtil::SWProfiler::timeUs)
+         * \return false if no tracking state has been received since the previous call (oData is not modified)
+         */
+        bool latestTrackingData(fs::fsTrackingData &oData, int64 &i64ReceptionTime);
+
+        /**
+         * \brief Return the reception counters.
+         * \param [out] ui32ReceivedNb  : number of tracking states received
+         * \param [out] ui32DroppedNb   : number of tracking states replaced by a more recent one before being read
+         */
+        void counters(uint &ui32ReceivedNb, uint &ui32DroppedNb);
+
+    private :
+
+        /**
+         * \brief Reception loop.
+         */
+        void receive();
+
+        /**
+         * \brief Make the decoded tracking state the latest one.
+         * \param [in] i64ReceptionTime : reception time (us)
+         */
+        void publish(cint64 i64ReceptionTime);
+
+        SWFaceShiftReceiver(const SWFaceShiftReceiver &);
+        SWFaceShiftReceiver &operator=(const SWFaceShiftReceiver &);
+
+        SOCKET m_oSocket;                       /**< faceShift socket */
+        bool m_bWinsockStarted;                 /**< has WSAStartup been called ? */
+        volatile bool m_bConnected;             /**< is the connection alive ? */
+        volatile bool m_bStop;                  /**< ask the reception thread to stop */
+        boost::thread m_oThread;                /**< reception thread */
+
+        // reception thread
+        fs::fsBinaryStream m_oParser;           /**< stream parser */
+        fs::fsTrackingData m_oDecodedData;      /**< tracking state being decoded */
+        std::vector<char> m_vReceptionBuffer;   /**< socket reception buffer */
+
+        // shared
+        boost::mutex m_oDataMutex;              /**< protects the members below */
+        fs::fsTrackingData m_oLatestData;       /**< last decoded tracking state */
+        bool m_bNewData;                        /**< has m_oLatestData not been read yet ? */
+        int64 m_i64LatestTime;                  /**< reception time of m_oLatestData (us) */
+        uint m_ui32ReceivedNb;                  /**< number of tracking states received */
+        uint m_ui32DroppedNb;                   /**< number of tracking states never read */
+};
+
+#endif
@@ -38,8 +38,7 @@
 #include "SWExceptions.h"
 
 // FACESHIFT
-#include "rgbd/faceshift/fsbinarystream.h"
-#include <WinSock2.h>
+#include "rgbd/SWFaceShiftReceiver.h"
 #include <WS2tcpip.h>
 #include <tchar.h>
 #include <Windows.h>
@@ -55,34 +54,16 @@
 
 /**
  * \class SWFaceShiftTracking
- * \brief This module sends faceShift data (head,gaze) on two yarp ports
+ * \brief This module sends faceShift data (head,gaze,face,coeffs) on four yarp ports
  *
- * Bottles contents :
+ * The faceShift stream is received in a dedicated thread (SWFaceShiftReceiver), each period only the last received tracking state is sent.
  *
- * Head :
+ * Ports contents :
  *
- *  device id : FACESHIFT_LIB  / get(0).asInt()
- *
- *   translation
- *       Tx / get(1).asDouble()
- *       Ty / get(2).asDouble()
- *       Tz / get(3).asDouble()
- *   rotation (quaternions)
- *       Rx / get(4).asDouble()
- *       Ry / get(5).asDouble()
- *       Rz / get(6).asDouble()
- *
- * Gaze :
- *
- *  device id : FACESHIFT_LIB  / get(0).asInt()
- *
- *  left eye
- *      pitch / get(1).asDouble()
- *      yaw   / get(2).asDouble()
- *
- *  right eye
- *      pitch / get(3).asDouble()
- *      yaw   / get(4).asDouble()
+ *  head   : swTracking::SWHeadPoseMessage (translation, rotation quaternion x y z)
+ *  gaze   : swTracking::SWGazeMessage (eyes pitch/yaw, blink coefficients)
+ *  face   : swTracking::SWFaceLandmarksMessage (faceShift markers)
+ *  coeffs : bottle, device id FACESHIFT_LIB / get(0).asInt(), then the blendshapes coefficients
  *
  */
 class SWFaceShiftTracking : public yarp::os::RFModule
@@ -153,11 +134,9 @@ class SWFaceShiftTracking : public yarp::os::RFModule
 	yarp::os::BufferedPort<yarp::os::Bottle> m_oCoeffsTrackingPort;   /**< yarp face tracking port */
 
         // faceshift
-        SOCKET ConnectSocket;                   /**< faceshift socket */
-        int iResult;                            /**< result reception message */
-        int recvbuflen;                         /**< reception buffer */
-        fs::fsBinaryStream parserIn;            /**< parser input */
-        fs::fsMsgPtr msg;                       /**< message input */
+        SWFaceShiftReceiver m_oReceiver;        /**< faceshift stream receiver */
+        fs::fsTrackingData m_oTrackingData;     /**< last tracking state, exchanged with the receiver each period */
+        uint m_ui32MessageId;                   /**< id of the last sent messages */
 };
 
 
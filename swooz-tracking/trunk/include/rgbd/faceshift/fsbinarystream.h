@@ -373,6 +373,13 @@ public:
       * After pushing data, you can try to extract messages from the stream. Process messages until a null pointer is returned.
       **/
     fsMsgPtr get_message();
+    /**
+      * Alternative to get_message without allocation, for the clients only interested in the tracking states. A tracking state message is
+      * decoded in place into data (its vectors are only reallocated when they grow), the other messages are skipped.
+      * Returns 1 if data has been updated, 0 if another message has been skipped, -1 if no full message is available or if the stream is invalid.
+      * data can be partially modified when the stream becomes invalid.
+      **/
+    int decode_tracking_state(fsTrackingData &data);
     /**
       * When an invalid message is received, the valid field is set to false. No attempt is made to recover from the problem, you will have to disconnect.
       **/
@@ -5,7 +5,27 @@
 
 #include "CRTree.h"
 #include <stdio.h>
+#include <string.h>
 #include <vector>
+#include <iostream>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+// Packed forest file : header, trees headers, then for each tree its table and its leafs, each array aligned on PACKED_FOREST_ALIGN bytes
+#define PACKED_FOREST_MAGIC "SWFOREST"
+#define PACKED_FOREST_VERSION 2
+#define PACKED_FOREST_ALIGN 64
+#define PACKED_FOREST_EXTENSION ".swforest"
+
+struct PackedForestHeader {
+
+	char magic[8];
+	int version;
+	// sizeof(int), sizeof(LeafNode) of the writer
+	int intSize;
+	int leafSize;
+	int ntrees;
+
+};
 
 class CRForest {
   public:
@@ -19,6 +39,8 @@ class CRForest {
       for(std::vector<CRTree*>::iterator it = vTrees.begin(); it != vTrees.end(); ++it)
     	  delete *it; // delete pointers
       vTrees.clear(); // specialized routine for clearing trees
+      if(packedFile.is_open())
+    	  packedFile.close(); // the trees must be deleted before
     }
 
     // Set/Get functions
@@ -30,11 +52,27 @@ class CRForest {
 
     std::vector< const LeafNode* > regressionIntegral( const std::vector< cv::Mat >& patch, const cv::Mat& nonZeros, const cv::Rect& roi ) const;
 
+    // Prepare the flattened trees for integral images with the input step (in elements)
+    void setIntegralStep(int step);
+
+    // Send a batch of n patches down all the trees, the leaf of the patch p for the tree t is leaves[t*n + p]
+    void regressionBatch( const double* const* patch, const double* nonZeros, const int* origins, int n, int* nodes, const LeafNode** leaves ) const;
+
 	bool loadForest(const char* filename);
 
+	// Write all the trees in a single packed file
+	bool savePackedForest(const char* filename) const;
+
+	// Map a packed file written by savePackedForest, the trees use the mapped data in place.
+	// If treespath is set, the file is rejected when one of the binary trees changed since the conversion.
+	bool loadPackedForest(const char* filename, const char* treespath = 0);
+
     // Trees
     std::vector<CRTree*> vTrees;
 
+    // Mapped packed forest file
+    boost::iostreams::mapped_file_source packedFile;
+
 
 };
 
@@ -47,6 +85,18 @@ inline std::vector<const LeafNode*> CRForest::regressionIntegral( const std::vec
 	return res;
 }
 
+inline void CRForest::setIntegralStep(int step) {
+
+	for(int i=0; i<(int)vTrees.size(); ++i)
+		vTrees[i]->setIntegralStep(step);
+}
+
+inline void CRForest::regressionBatch( const double* const* patch, const double* nonZeros, const int* origins, int n, int* nodes, const LeafNode** leaves ) const {
+
+	for(int i=0; i<(int)vTrees.size(); ++i)
+		vTrees[i]->regressionBatch(patch, nonZeros, origins, n, nodes, leaves + i*n);
+}
+
 
 inline bool CRForest::loadForest(const char* filename) {
 
@@ -60,5 +110,131 @@ inline bool CRForest::loadForest(const char* filename) {
 	return success;
 }
 
+inline bool CRForest::savePackedForest(const char* filename) const {
+
+	FILE* fp = fopen(filename,"wb");
+	if(!fp) {
+		std::cerr << "Cannot write the packed forest " << filename << std::endl;
+		return false;
+	}
+
+	PackedForestHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, PACKED_FOREST_MAGIC, 8);
+	header.version  = PACKED_FOREST_VERSION;
+	header.intSize  = sizeof(int);
+	header.leafSize = sizeof(LeafNode);
+	header.ntrees   = (int)vTrees.size();
+
+	// compute the aligned offsets of the arrays
+	std::vector<PackedTreeHeader> trees(vTrees.size());
+	size_t offset = sizeof(PackedForestHeader) + trees.size() * sizeof(PackedTreeHeader);
+
+	for(unsigned int i=0; i<vTrees.size(); ++i) {
+
+		vTrees[i]->packedHeader(trees[i]);
+
+		offset = (offset + PACKED_FOREST_ALIGN - 1) / PACKED_FOREST_ALIGN * PACKED_FOREST_ALIGN;
+		trees[i].nodesOffset = (unsigned int)offset;
+		offset += trees[i].num_nodes * TEST_DIM * sizeof(int);
+
+		offset = (offset + PACKED_FOREST_ALIGN - 1) / PACKED_FOREST_ALIGN * PACKED_FOREST_ALIGN;
+		trees[i].leavesOffset = (unsigned int)offset;
+		offset += trees[i].num_leaf * sizeof(LeafNode);
+	}
+
+	bool success = true;
+	success &= ( fwrite( &header, sizeof(header), 1, fp) == 1 );
+	if(!trees.empty())
+		success &= ( fwrite( &trees[0], sizeof(PackedTreeHeader), trees.size(), fp) == trees.size() );
+
+	const char padding[PACKED_FOREST_ALIGN] = {0};
+
+	for(unsigned int i=0; i<vTrees.size() && success; ++i) {
+
+		size_t pad = trees[i].nodesOffset - (size_t)ftell(fp);
+		success &= ( fwrite( padding, 1, pad, fp) == pad );
+		success &= ( fwrite( vTrees[i]->getTreeTable(), sizeof(int) * TEST_DIM, trees[i].num_nodes, fp) == (size_t)trees[i].num_nodes );
+
+		pad = trees[i].leavesOffset - (size_t)ftell(fp);
+		success &= ( fwrite( padding, 1, pad, fp) == pad );
+		success &= ( fwrite( vTrees[i]->getLeafs(), sizeof(LeafNode), trees[i].num_leaf, fp) == (size_t)trees[i].num_leaf );
+	}
+
+	fclose(fp);
+
+	if(!success)
+		std::cerr << "Error while writing the packed forest " << filename << std::endl;
+
+	return success;
+}
+
+inline bool CRForest::loadPackedForest(const char* filename, const char* treespath) {
+
+	try {
+		packedFile.open(filename);
+	}
+	catch(const std::exception&) {
+		return false;
+	}
+
+	const char* data = packedFile.data();
+	size_t size = packedFile.size();
+
+	const PackedForestHeader* header = (const PackedForestHeader*)data;
+
+	if( size < sizeof(PackedForestHeader) || memcmp(header->magic, PACKED_FOREST_MAGIC, 8) != 0 ||
+		header->version != PACKED_FOREST_VERSION || header->intSize != sizeof(int) || header->leafSize != sizeof(LeafNode) ||
+		header->ntrees != (int)vTrees.size() ||
+		size < sizeof(PackedForestHeader) + header->ntrees * sizeof(PackedTreeHeader) ) {
+
+		std::cerr << "Invalid packed forest " << filename << " (version, type sizes or number of trees)" << std::endl;
+		packedFile.close();
+		return false;
+	}
+
+	std::cout << "Load packed forest " << filename << " " << std::flush;
+
+	const PackedTreeHeader* trees = (const PackedTreeHeader*)(data + sizeof(PackedForestHeader));
+
+	// a binary tree retrained after the conversion makes the packed file stale, the missing binary trees are not checked
+	if(treespath) {
+
+		char buffer[200];
+		for(int i=0; i<header->ntrees; ++i) {
+
+			long long binSize, binTime;
+			sprintf_s(buffer,"%s%03d.bin",treespath,i);
+
+			if( CRTree::fileStamp(buffer, binSize, binTime) && (binSize != trees[i].binSize || binTime != trees[i].binTime) ) {
+
+				std::cerr << "The packed forest " << filename << " does not match the tree " << buffer << " (changed since the conversion), convert the trees again with SWForestConverter" << std::endl;
+				packedFile.close();
+				return false;
+			}
+		}
+	}
+
+	bool success = true;
+	for(unsigned int i=0; i<vTrees.size() && success; ++i) {
+		vTrees[i] = new CRTree();
+		success &= vTrees[i]->mapTree(trees[i], data, size);
+	}
+
+	if(!success) {
+
+		for(unsigned int i=0; i<vTrees.size(); ++i) {
+			delete vTrees[i];
+			vTrees[i] = 0;
+		}
+		packedFile.close();
+		return false;
+	}
+
+	std::cout << " done " << std::endl;
+
+	return true;
+}
+
 
 #endif
@@ -17,12 +17,15 @@ class CRForestEstimator {
 
 public:
 
-	CRForestEstimator(){ crForest = 0; };
+	CRForestEstimator(){ crForest = 0; flatForest = true; };
 
 	~CRForestEstimator(){ if(crForest) delete crForest; };
 
 	bool loadForest(const char* treespath, int ntrees = 0);
 
+	// Use the flattened trees and the parallel patch voting (default), else use the original sequential traversal
+	void setFlatForest(bool flat){ flatForest = flat; };
+
 	void estimate( const cv::Mat & im3D, //input: 3d image (x,y,z coordinates for each pixel)
                    std::vector< cv::Vec<float,POSE_SIZE> >& means, //output: heads' centers and orientations (x,y,z,pitch,yaw,roll)
                    std::vector< std::vector< Vote > >& clusters, //all clusters
@@ -41,8 +44,19 @@ private:
 
 	cv::Rect getBoundingBox(const cv::Mat& im3D);
 
+	// Send the patches of the bounding box down the trees one after the other
+	void sequentialVoting( const cv::Mat* channels, const cv::Mat& depthInt, const cv::Mat& maskIntegral, const cv::Rect& bbox,
+						   int stride, float max_variance, float prob_th, std::vector< Vote >& votes );
+
+	// Send the patches of the bounding box down the flattened trees, the rows are processed in parallel
+	// and the votes are concatenated in the same order than the sequential traversal
+	void parallelVoting( const cv::Mat* channels, const cv::Mat& depthInt, const cv::Mat& maskIntegral, const cv::Rect& bbox,
+						 int stride, float max_variance, float prob_th, std::vector< Vote >& votes );
+
 	CRForest* crForest;
 
+	bool flatForest;
+
 };
 
 
@@ -8,7 +8,7 @@
 #define AVG_FACE_DIAMETER 236.4f
 #define AVG_FACE_DIAMETER2 55884.96f
 
-// Structure for the leafs
+// Structure for the leafs, plain floats so that the leafs of a packed forest file can be used in place
 class LeafNode {
 
 public:
@@ -19,22 +19,52 @@ public:
 	// Probability of belonging to a head
 	float pfg;
 	// mean vector
-	cv::Mat mean;
+	float mean[POSE_SIZE];
 	// trace of the covariance matrix
 	float trace;
 
 };
 
+// Header of a tree in a packed forest file (see CRForest::savePackedForest)
+struct PackedTreeHeader {
+
+	int max_depth;
+	int num_nodes;
+	int num_leaf;
+	int pwidth;
+	int pheight;
+	int no_chans;
+	// offsets of the tree table and of the leafs from the beginning of the file
+	unsigned int nodesOffset;
+	unsigned int leavesOffset;
+	// size and modification time of the binary tree file the tree was converted from
+	long long binSize;
+	long long binTime;
+
+};
+
 class CRTree {
 
 public:
 
-	CRTree() {};
+	CRTree() : treetable(0), leaf(0), mapped(false), binSize(0), binTime(0), integralStep(0) {};
 
-	~CRTree() { delete [] leaf; delete[] treetable; }
+	~CRTree() { if(!mapped){ delete [] leaf; delete[] treetable; } }
 
 	bool loadTree(const char* filename);
 
+	// Use the tree table and the leafs of a packed forest file in place, the data must remain mapped during the tree life
+	bool mapTree(const PackedTreeHeader& header, const char* data, size_t size);
+
+	// Fill the header of the tree for a packed forest file, the offsets are not set
+	void packedHeader(PackedTreeHeader& header) const;
+
+	// Size and modification time of a file, false if the file can't be read
+	static bool fileStamp(const char* filename, long long& size, long long& time);
+
+	const int* getTreeTable() const {return treetable;}
+	const LeafNode* getLeafs() const {return leaf;}
+
 	int getDepth() const {return max_depth;}
 	int getPatchWidth() const {return m_pwidth;}
 	int getPatchHeight() const {return m_pheight;}
@@ -42,6 +72,17 @@ public:
 
 	const LeafNode* regressionIntegral(const std::vector< cv::Mat >&, const cv::Mat& nonZeros, const cv::Rect& roi);
 
+	// Set the step (in elements) of the integral images given to regressionBatch.
+	// Must be called before regressionBatch, outside of any parallel region.
+	void setIntegralStep(int step);
+
+	// Send a batch of patches down the tree, all the patches go down one level at each pass.
+	// The nodes are read in place in the tree table, so a mapped packed forest is not copied.
+	// origins : offsets of the patches top left corners in the integral images
+	// nodes   : buffer of n ints used for the traversal
+	// leaves  : output leaves of the n patches
+	void regressionBatch(const double* const* patch, const double* nonZeros, const int* origins, int n, int* nodes, const LeafNode** leaves) const;
+
 
 private:
 
@@ -62,6 +103,16 @@ private:
 	//leafs as vector
 	LeafNode* leaf;
 
+	// are the tree table and the leafs owned by a mapped file ?
+	bool mapped;
+
+	// size and modification time of the binary tree file
+	long long binSize;
+	long long binTime;
+
+	// step of the integral images given to regressionBatch
+	int integralStep;
+
 };
 
 inline const LeafNode* CRTree::regressionIntegral(const std::vector< cv::Mat >& patch, const cv::Mat& nonZeros, const cv::Rect& roi) {
@@ -112,4 +163,52 @@ inline const LeafNode* CRTree::regressionIntegral(const std::vector< cv::Mat >&
 
 }
 
+inline void CRTree::regressionBatch(const double* const* patch, const double* nonZeros, const int* origins, int n, int* nodes, const LeafNode** leaves) const {
+
+	const int step = integralStep;
+
+	for(int i=0; i<n; ++i)
+		nodes[i] = 0;
+
+	// at most one pass per level of the tree
+	for(int level=0; level<=max_depth; ++level) {
+
+		int active = 0;
+
+		for(int i=0; i<n; ++i) {
+
+			const int* pnode = &treetable[nodes[i]*TEST_DIM];
+
+			if(pnode[0] >= 0)
+				continue;
+
+			const double* ptC = patch[pnode[9]] + origins[i];
+			const double* ptM = nonZeros + origins[i];
+
+			// corners (y1,x1) (y2,x2) (y2,x1) (y1,x2) of the two rectangles, relative to the top left corner of the patch
+			int xa1 = pnode[1];		int xa2 = xa1 + pnode[5];
+			int ya1 = pnode[2]*step;	int ya2 = ya1 + pnode[6]*step;
+			int xb1 = pnode[3];		int xb2 = xb1 + pnode[7];
+			int yb1 = pnode[4]*step;	int yb2 = yb1 + pnode[8]*step;
+
+			double mz1 = ( ptC[ya1+xa1] + ptC[ya2+xa2] - ptC[ya2+xa1] - ptC[ya1+xa2] )/
+						 (double)MAX(1, ptM[ya1+xa1] + ptM[ya2+xa2] - ptM[ya2+xa1] - ptM[ya1+xa2]);
+
+			double mz2 = ( ptC[yb1+xb1] + ptC[yb2+xb2] - ptC[yb2+xb1] - ptC[yb1+xb2] )/
+						 (double)MAX(1, ptM[yb1+xb1] + ptM[yb2+xb2] - ptM[yb2+xb1] - ptM[yb1+xb2]);
+
+			//the test result sends the patch to one of the children nodes
+			nodes[i] = 2*nodes[i] + 1 + ( (mz1 - mz2) >= (double)pnode[10] );
+			++active;
+		}
+
+		if(active == 0)
+			break;
+	}
+
+	for(int i=0; i<n; ++i)
+		leaves[i] = &leaf[ treetable[nodes[i]*TEST_DIM] ];
+
+}
+
 
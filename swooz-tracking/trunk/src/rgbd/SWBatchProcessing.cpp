@@ -0,0 +1,693 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWBatchProcessing.cpp
+ * \author Florian Lance
+ * \date 16/10/26
+ * \brief Process offline a kinect recording saved with SWSaveKinectData : the frames are read by chunks of consecutive frames
+ *        which are shared between worker threads, each worker runs the head pose forest, the emicp head motion and the stasm
+ *        landmarks on the frames of its chunks, and the results are saved in a columnar file.
+ *
+ *  Results file (little endian) :
+ *      - char[8] SW_BATCH_FILE_MAGIC
+ *      - int32 number of rows (one row per frame), int32 number of columns
+ *      - for each column : char[32] name, int32 type (0 : int32, 1 : float32), int32 number of components
+ *      - the data of each column one after the other, rows * components values
+ *
+ *  Columns :
+ *      - frame             : id of the frame in the recording
+ *      - time              : recording time of the frame (s), -1 if unknown (recordings previous to the "cloud.swk" format)
+ *      - forest_heads      : number of heads found by the forest
+ *      - forest_pose       : x, y, z (mm), pitch, yaw, roll (degrees) of the first head
+ *      - emicp_status      : -1 no result, 0 reference frame, 1 valid head motion
+ *      - emicp_rotation    : rotation matrix of the head motion (row major)
+ *      - emicp_translation : translation of the head motion
+ *      - emicp_angles      : rotation angles of the head motion
+ *      - stasm_valid       : 1 if the stasm search succeeded
+ *      - stasm_points      : x, y of the 68 stasm points (pixels)
+ *
+ *  All the workers align the faces on the same reference cloud (the first face detected in the recording). The face tracking and the
+ *  stasm shape are reset at the beginning of each chunk and the emicp smoothing is disabled, so a chunk doesn't depend on the previous
+ *  ones, the columns can be smoothed afterwards.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <deque>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include "rgbd/forest/CRForestEstimator.h"
+#include "devices/rgbd/SWLoadKinectData.h"
+#include "cloud/SWCaptureHeadMotion.h"
+#include "detect/SWStasm.h"
+#include "opencvUtility.h"
+#include "SWProfiler.h"
+
+#define SW_BATCH_FILE_MAGIC     "SWBATCH1"
+#define SW_BATCH_STASM_POINTS   68
+
+/**
+ * \struct SWBatchFrame
+ * \brief A recorded frame.
+ */
+struct SWBatchFrame
+{
+    int m_i32Frame;     /**< id of the frame */
+    float m_fTime;      /**< recording time (s) */
+    cv::Mat m_oBgr;     /**< bgr image */
+    cv::Mat m_oCloud;   /**< cloud map (cv::Vec3f) */
+};
+
+typedef boost::shared_ptr<std::vector<SWBatchFrame> > SWBatchChunkPtr; /**< consecutive frames processed by the same worker */
+
+/**
+ * \struct SWBatchResult
+ * \brief Results of a frame, a row of the results file.
+ */
+struct SWBatchResult
+{
+    int m_i32Frame;                                     /**< id of the frame */
+    float m_fTime;                                      /**< recording time (s) */
+    int m_i32ForestHeads;                               /**< number of heads found by the forest */
+    float m_a6FForestPose[6];                           /**< pose of the first head */
+    int m_i32EmicpStatus;                               /**< result of SWCaptureHeadMotion::alignHead, -1 if not computed */
+    float m_a9FEmicpRotation[9];                        /**< rotation matrix */
+    float m_a3FEmicpTranslation[3];                     /**< translation */
+    float m_a3FEmicpAngles[3];                          /**< rotation angles */
+    int m_i32StasmValid;                                /**< has the stasm search succeeded ? */
+    float m_aFStasmPoints[2*SW_BATCH_STASM_POINTS];     /**< stasm points */
+};
+
+/**
+ * \struct SWBatchColumn
+ * \brief Column of the results file.
+ */
+struct SWBatchColumn
+{
+    const char *m_sName;    /**< name */
+    int m_i32Type;          /**< 0 : int32, 1 : float32 */
+    int m_i32Components;    /**< number of values per row */
+    size_t m_ui32Offset;    /**< offset of the values in SWBatchResult */
+};
+
+static const SWBatchColumn g_aColumns[] =
+{
+    {"frame",               0, 1,                           offsetof(SWBatchResult, m_i32Frame)},
+    {"time",                1, 1,                           offsetof(SWBatchResult, m_fTime)},
+    {"forest_heads",        0, 1,                           offsetof(SWBatchResult, m_i32ForestHeads)},
+    {"forest_pose",         1, 6,                           offsetof(SWBatchResult, m_a6FForestPose)},
+    {"emicp_status",        0, 1,                           offsetof(SWBatchResult, m_i32EmicpStatus)},
+    {"emicp_rotation",      1, 9,                           offsetof(SWBatchResult, m_a9FEmicpRotation)},
+    {"emicp_translation",   1, 3,                           offsetof(SWBatchResult, m_a3FEmicpTranslation)},
+    {"emicp_angles",        1, 3,                           offsetof(SWBatchResult, m_a3FEmicpAngles)},
+    {"stasm_valid",         0, 1,                           offsetof(SWBatchResult, m_i32StasmValid)},
+    {"stasm_points",        1, 2*SW_BATCH_STASM_POINTS,     offsetof(SWBatchResult, m_aFStasmPoints)}
+};
+
+/**
+ * \struct SWBatchParams
+ * \brief Parameters of the processing.
+ */
+struct SWBatchParams
+{
+    std::string m_sTreesPath;   /**< path of the forest, empty if the forest is not used */
+    int m_i32TreesNb;           /**< number of trees */
+    int m_i32Stride;            /**< forest stride */
+    int m_i32MaxZ;              /**< maximum depth used by the forest (mm) */
+};
+
+/**
+ * \class SWBatchQueue
+ * \brief Bounded queue of chunks between the reader and the workers.
+ */
+class SWBatchQueue
+{
+    public :
+
+        /**
+         * \brief SWBatchQueue constructor.
+         * \param [in] ui32Capacity : maximum number of chunks waiting in the queue
+         */
+        SWBatchQueue(cuint ui32Capacity) : m_ui32Capacity(ui32Capacity > 0 ? ui32Capacity : 1), m_bClosed(false)
+        {}
+
+        /**
+         * \brief Push a chunk, wait if the queue is full.
+         */
+        void push(const SWBatchChunkPtr &pChunk)
+        {
+            boost::mutex::scoped_lock l_oLock(m_oMutex);
+
+            while(m_dChunks.size() >= m_ui32Capacity)
+            {
+                m_oNotFull.wait(l_oLock);
+            }
+
+            m_dChunks.push_back(pChunk);
+            m_oNotEmpty.notify_one();
+        }
+
+        /**
+         * \brief Pop a chunk, wait if the queue is empty.
+         * \return false if the queue is empty and closed
+         */
+        bool pop(SWBatchChunkPtr &pChunk)
+        {
+            boost::mutex::scoped_lock l_oLock(m_oMutex);
+
+            while(m_dChunks.empty() && !m_bClosed)
+            {
+                m_oNotEmpty.wait(l_oLock);
+            }
+
+            if(m_dChunks.empty())
+            {
+                return false;
+            }
+
+            pChunk = m_dChunks.front();
+            m_dChunks.pop_front();
+            m_oNotFull.notify_one();
+
+            return true;
+        }
+
+        /**
+         * \brief No more chunks will be pushed, the workers stop when the queue is empty.
+         */
+        void close()
+        {
+            boost::mutex::scoped_lock l_oLock(m_oMutex);
+            m_bClosed = true;
+            m_oNotEmpty.notify_all();
+        }
+
+    private :
+
+        uint m_ui32Capacity;                        /**< maximum number of chunks in the queue */
+        bool m_bClosed;                             /**< has the reading ended ? */
+        std::deque<SWBatchChunkPtr> m_dChunks;      /**< waiting chunks */
+        boost::mutex m_oMutex;                      /**< protects the queue */
+        boost::condition_variable m_oNotEmpty;      /**< signaled when a chunk is pushed or when the queue is closed */
+        boost::condition_variable m_oNotFull;       /**< signaled when a chunk is popped */
+};
+
+/**
+ * \class SWBatchResults
+ * \brief Results of all the frames, filled by the workers.
+ */
+class SWBatchResults
+{
+    public :
+
+        /**
+         * \brief Store the results of a chunk.
+         */
+        void store(const std::vector<SWBatchResult> &vResults)
+        {
+            boost::mutex::scoped_lock l_oLock(m_oMutex);
+
+            for(uint ii = 0; ii < vResults.size(); ++ii)
+            {
+                uint l_ui32Row = static_cast<uint>(vResults[ii].m_i32Frame);
+
+                if(l_ui32Row >= m_vResults.size())
+                {
+                    m_vResults.resize(l_ui32Row + 1);
+                }
+
+                m_vResults[l_ui32Row] = vResults[ii];
+            }
+        }
+
+        /**
+         * \brief Results sorted by frame, must be called after the end of the workers.
+         */
+        const std::vector<SWBatchResult> &results() const
+        {
+            return m_vResults;
+        }
+
+    private :
+
+        boost::mutex m_oMutex;                      /**< protects m_vResults */
+        std::vector<SWBatchResult> m_vResults;      /**< results sorted by frame */
+};
+
+/**
+ * \brief Convert a kinect cloud map (meters, y up) to the 3D image used by the forest (millimeters, y down).
+ * \param [in] oCloud  : cloud map (cv::Vec3f)
+ * \param [in] i32MaxZ : maximum depth in millimeters
+ * \param [out] oIm3D  : 3D image
+ */
+static void cloudTo3DImage(const cv::Mat &oCloud, cint i32MaxZ, cv::Mat &oIm3D)
+{
+    oIm3D.create(oCloud.rows, oCloud.cols, CV_32FC3);
+
+    for(int ii = 0; ii < oCloud.rows; ++ii)
+    {
+        const cv::Vec3f *l_pCloudRow = oCloud.ptr<cv::Vec3f>(ii);
+        cv::Vec3f *l_pIm3DRow        = oIm3D.ptr<cv::Vec3f>(ii);
+
+        for(int jj = 0; jj < oCloud.cols; ++jj)
+        {
+            float l_fZ = l_pCloudRow[jj][2] * 1000.f;
+
+            if(l_fZ > 0.f && l_fZ < i32MaxZ)
+            {
+                l_pIm3DRow[jj] = cv::Vec3f(l_pCloudRow[jj][0] * 1000.f, -l_pCloudRow[jj][1] * 1000.f, l_fZ);
+            }
+            else
+            {
+                l_pIm3DRow[jj] = cv::Vec3f(0.f,0.f,0.f);
+            }
+        }
+    }
+}
+
+/**
+ * \class SWBatchWorker
+ * \brief Process the chunks popped from the queue, each worker has its own forest, head motion and stasm instances.
+ */
+class SWBatchWorker
+{
+    public :
+
+        /**
+         * \brief SWBatchWorker constructor.
+         * \param [in] oParams          : processing parameters
+         * \param [in] oReference       : detection used as reference cloud for the head motion (not used if i32ReferenceFrame < 0)
+         * \param [in] i32ReferenceFrame: id of the reference frame, -1 if no face has been detected in the recording
+         */
+        SWBatchWorker(const SWBatchParams &oParams, const swCloud::SWHeadDetection &oReference, cint i32ReferenceFrame) :
+            m_oParams(oParams), m_bForestLoaded(false), m_i32ReferenceFrame(i32ReferenceFrame)
+        {
+            // the chunks are independent, the head motion is not smoothed
+            m_oHeadMotion.setParameters(0.3, 0.3, 0.1, 0);
+            // the workers already use all the cores, the emicp is computed on the CPU by each worker
+            m_oHeadMotion.setEmicpDevice(swCloud::EMICP_CPU_DEVICE);
+
+            if(m_i32ReferenceFrame >= 0)
+            {
+                swCloud::SWRigidMotion l_oRigidMotion;
+                m_oHeadMotion.alignHead(l_oRigidMotion, oReference);
+            }
+        }
+
+        /**
+         * \brief Load the forest.
+         * \return false if the forest can't be loaded
+         */
+        bool init()
+        {
+            if(m_oParams.m_sTreesPath.size() == 0)
+            {
+                return true;
+            }
+
+            m_bForestLoaded = m_oForest.loadForest(m_oParams.m_sTreesPath.c_str(), m_oParams.m_i32TreesNb);
+
+            return m_bForestLoaded;
+        }
+
+        /**
+         * \brief Process the chunks until the queue is closed and empty.
+         * \param [in] oQueue    : chunks queue
+         * \param [out] oResults : results of all the frames
+         */
+        void run(SWBatchQueue &oQueue, SWBatchResults &oResults)
+        {
+            #ifdef _OPENMP
+                // the forest voting and the emicp stay in the worker thread
+                omp_set_num_threads(1);
+            #endif
+
+            SWBatchChunkPtr l_pChunk;
+            std::vector<SWBatchResult> l_vResults;
+
+            while(oQueue.pop(l_pChunk))
+            {
+                m_oHeadMotion.resetDetection();
+                m_oStasm.resetParams();
+
+                l_vResults.resize(l_pChunk->size());
+
+                for(uint ii = 0; ii < l_pChunk->size(); ++ii)
+                {
+                    processFrame((*l_pChunk)[ii], l_vResults[ii]);
+                }
+
+                oResults.store(l_vResults);
+            }
+        }
+
+    private :
+
+        /**
+         * \brief Process a frame.
+         * \param [in] oFrame   : frame
+         * \param [out] oResult : results of the frame
+         */
+        void processFrame(const SWBatchFrame &oFrame, SWBatchResult &oResult)
+        {
+            memset(&oResult, 0, sizeof(SWBatchResult));
+            oResult.m_i32Frame       = oFrame.m_i32Frame;
+            oResult.m_fTime          = oFrame.m_fTime;
+            oResult.m_i32EmicpStatus = -1;
+
+            swUtil::SWScopedTimer l_oTimer("batch/forest");
+
+            // head pose forest
+                if(m_bForestLoaded)
+                {
+                    cloudTo3DImage(oFrame.m_oCloud, m_oParams.m_i32MaxZ, m_oIm3D);
+
+                    std::vector< cv::Vec<float,POSE_SIZE> > l_vMeans;
+                    std::vector< std::vector< Vote > > l_vClusters;
+                    std::vector< Vote > l_vVotes;
+                    m_oForest.estimate(m_oIm3D, l_vMeans, l_vClusters, l_vVotes, m_oParams.m_i32Stride, 1000.f, 1.f, 1.f, 6.f, false, 400);
+
+                    oResult.m_i32ForestHeads = static_cast<int>(l_vMeans.size());
+
+                    if(l_vMeans.size() > 0)
+                    {
+                        for(int ii = 0; ii < 6; ++ii)
+                        {
+                            oResult.m_a6FForestPose[ii] = l_vMeans[0][ii];
+                        }
+                    }
+                }
+
+            // emicp head motion
+                l_oTimer.next("batch/emicp");
+                swCloud::SWHeadDetection l_oDetection;
+
+                if(m_oHeadMotion.detectHead(oFrame.m_oBgr, oFrame.m_oCloud, l_oDetection) && m_i32ReferenceFrame >= 0)
+                {
+                    if(oFrame.m_i32Frame == m_i32ReferenceFrame)
+                    {
+                        oResult.m_i32EmicpStatus = 0;
+                    }
+                    else
+                    {
+                        swCloud::SWRigidMotion l_oRigidMotion;
+                        oResult.m_i32EmicpStatus = m_oHeadMotion.alignHead(l_oRigidMotion, l_oDetection);
+
+                        if(oResult.m_i32EmicpStatus == 1)
+                        {
+                            memcpy(oResult.m_a9FEmicpRotation,    l_oRigidMotion.m_aFRotation,    9 * sizeof(float));
+                            memcpy(oResult.m_a3FEmicpTranslation, l_oRigidMotion.m_aFTranslation, 3 * sizeof(float));
+                            memcpy(oResult.m_a3FEmicpAngles,      l_oRigidMotion.m_aFRotAngles,   3 * sizeof(float));
+                        }
+                    }
+                }
+
+            // stasm landmarks on the detected face
+                l_oTimer.next("batch/stasm");
+
+                if(l_oDetection.m_bValid)
+                {
+                    cv::Rect l_oFaceRect = l_oDetection.m_oFaceRect;
+                    cv::Rect l_oAugmentedFaceRect(l_oFaceRect.x - l_oFaceRect.width/10, l_oFaceRect.y - l_oFaceRect.height/10,
+                                                  l_oFaceRect.width + l_oFaceRect.width/5, l_oFaceRect.height + l_oFaceRect.height/5);
+                    cv::Mat l_oBgr = oFrame.m_oBgr;
+
+                    if(swUtil::isInside(l_oAugmentedFaceRect, l_oBgr) && m_oStasm.launchAsmSearch(l_oBgr, l_oFaceRect))
+                    {
+                        oResult.m_i32StasmValid = 1;
+
+                        for(uint ii = 0; ii < m_oStasm.m_oFeaturesPoints.size() && ii < SW_BATCH_STASM_POINTS; ++ii)
+                        {
+                            oResult.m_aFStasmPoints[2*ii]   = static_cast<float>(m_oStasm.m_oFeaturesPoints[ii].x);
+                            oResult.m_aFStasmPoints[2*ii+1] = static_cast<float>(m_oStasm.m_oFeaturesPoints[ii].y);
+                        }
+                    }
+                }
+        }
+
+        SWBatchWorker(const SWBatchWorker &);
+        SWBatchWorker &operator=(const SWBatchWorker &);
+
+        SWBatchParams m_oParams;                        /**< processing parameters */
+
+        bool m_bForestLoaded;                           /**< is the forest used ? */
+        int m_i32ReferenceFrame;                        /**< id of the reference frame of the head motion */
+
+        cv::Mat m_oIm3D;                                /**< 3D image of the forest */
+        CRForestEstimator m_oForest;                    /**< head pose forest */
+        swCloud::SWCaptureHeadMotion m_oHeadMotion;     /**< emicp head motion */
+        swDetect::SWStasm m_oStasm;                     /**< stasm landmarks */
+};
+
+typedef boost::shared_ptr<SWBatchWorker> SWBatchWorkerPtr;
+
+/**
+ * \brief Find the first frame of the recording with a detected face, used as reference for the head motion of all the workers.
+ * \param [in] sKinectDataPath  : path of the recording
+ * \param [out] oReference      : detection of the reference frame
+ * \return the id of the reference frame, -1 if no face has been detected
+ */
+static int findReferenceFrame(const std::string &sKinectDataPath, swCloud::SWHeadDetection &oReference)
+{
+    swDevice::SWLoadKinectData l_oLoader(sKinectDataPath);
+    l_oLoader.start();
+
+    swCloud::SWCaptureHeadMotion l_oHeadMotion;
+
+    cv::Mat l_oBgr, l_oCloud;
+    for(int l_i32Frame = 0; l_oLoader.grabVideo(l_oBgr) && l_oLoader.grabCloud(l_oCloud); ++l_i32Frame)
+    {
+        if(l_oHeadMotion.detectHead(l_oBgr, l_oCloud, oReference))
+        {
+            l_oLoader.stop();
+            return l_i32Frame;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * \brief Save the results in the columnar file.
+ * \param [in] sPath    : path of the file
+ * \param [in] vResults : results sorted by frame
+ * \return false if the file can't be written
+ */
+static bool saveResults(const std::string &sPath, const std::vector<SWBatchResult> &vResults)
+{
+    std::ofstream l_oFile(sPath.c_str(), std::ios::out | std::ios::binary);
+
+    if(!l_oFile.is_open())
+    {
+        std::cerr << "Error : can't open the results file : " << sPath << std::endl;
+        return false;
+    }
+
+    int l_i32RowsNb    = static_cast<int>(vResults.size());
+    int l_i32ColumnsNb = static_cast<int>(sizeof(g_aColumns) / sizeof(SWBatchColumn));
+
+    l_oFile.write(SW_BATCH_FILE_MAGIC, 8);
+    l_oFile.write(reinterpret_cast<const char*>(&l_i32RowsNb),    sizeof(int));
+    l_oFile.write(reinterpret_cast<const char*>(&l_i32ColumnsNb), sizeof(int));
+
+    for(int ii = 0; ii < l_i32ColumnsNb; ++ii)
+    {
+        char l_aCName[32];
+        memset(l_aCName, 0, 32);
+        strncpy(l_aCName, g_aColumns[ii].m_sName, 31);
+
+        l_oFile.write(l_aCName, 32);
+        l_oFile.write(reinterpret_cast<const char*>(&g_aColumns[ii].m_i32Type),       sizeof(int));
+        l_oFile.write(reinterpret_cast<const char*>(&g_aColumns[ii].m_i32Components), sizeof(int));
+    }
+
+    for(int ii = 0; ii < l_i32ColumnsNb; ++ii)
+    {
+        for(int jj = 0; jj < l_i32RowsNb; ++jj)
+        {
+            l_oFile.write(reinterpret_cast<const char*>(&vResults[jj]) + g_aColumns[ii].m_ui32Offset, g_aColumns[ii].m_i32Components * 4);
+        }
+    }
+
+    return l_oFile.good();
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 5)
+    {
+        std::cerr << "Usage : SWBatchProcessing kinect_data_path results_file trees_path trees_number [threads number] [chunk size] [stride] [max depth (mm)] " << std::endl;
+        std::cerr << "        trees_path : - to disable the head pose forest " << std::endl;
+        return -1;
+    }
+
+    std::string l_sKinectDataPath(argv[1]), l_sResultsPath(argv[2]);
+
+    SWBatchParams l_oParams;
+    l_oParams.m_sTreesPath = std::string(argv[3]) == "-" ? std::string() : std::string(argv[3]);
+    l_oParams.m_i32TreesNb = atoi(argv[4]);
+    l_oParams.m_i32Stride  = 5;
+    l_oParams.m_i32MaxZ    = 2000;
+
+    int l_i32ThreadsNb = std::max(1, static_cast<int>(boost::thread::hardware_concurrency()));
+    int l_i32ChunkSize = 15; // period of the full face detections of SWFaceDetection::trackFace
+
+    if(argc > 5)
+    {
+        l_i32ThreadsNb = std::max(1, atoi(argv[5]));
+    }
+    if(argc > 6)
+    {
+        l_i32ChunkSize = std::max(1, atoi(argv[6]));
+    }
+    if(argc > 7)
+    {
+        l_oParams.m_i32Stride = std::max(1, atoi(argv[7]));
+    }
+    if(argc > 8)
+    {
+        l_oParams.m_i32MaxZ = atoi(argv[8]);
+    }
+
+    int64 l_i64Start = swUtil::SWProfiler::timeUs();
+
+    // reference of the head motion
+        swCloud::SWHeadDetection l_oReference;
+        int l_i32ReferenceFrame = findReferenceFrame(l_sKinectDataPath, l_oReference);
+
+        if(l_i32ReferenceFrame < 0)
+        {
+            std::cerr << "No face detected in the recording, the head motion will not be computed. " << std::endl;
+        }
+        else
+        {
+            std::cout << "Head motion reference frame : " << l_i32ReferenceFrame << std::endl;
+        }
+
+    // workers
+        std::vector<SWBatchWorkerPtr> l_vWorkers;
+        for(int ii = 0; ii < l_i32ThreadsNb; ++ii)
+        {
+            l_vWorkers.push_back(SWBatchWorkerPtr(new SWBatchWorker(l_oParams, l_oReference, l_i32ReferenceFrame)));
+
+            if(!l_vWorkers.back()->init())
+            {
+                std::cerr << "Error : cannot load the forest. " << std::endl;
+                return -1;
+            }
+        }
+
+    // a few chunks are read in advance, the other ones are being processed
+        SWBatchQueue l_oQueue(std::max(1, l_i32ThreadsNb / 2));
+        SWBatchResults l_oResults;
+
+        boost::thread_group l_oThreads;
+        for(int ii = 0; ii < l_i32ThreadsNb; ++ii)
+        {
+            l_oThreads.create_thread(boost::bind(&SWBatchWorker::run, l_vWorkers[ii].get(), boost::ref(l_oQueue), boost::ref(l_oResults)));
+        }
+
+    // read the recording
+        swDevice::SWLoadKinectData l_oLoader(l_sKinectDataPath);
+        l_oLoader.start();
+
+        int l_i32FramesNb = 0;
+        float l_fRecordingTime = -1.f;
+        SWBatchChunkPtr l_pChunk(new std::vector<SWBatchFrame>());
+        cv::Mat l_oBgr;
+
+        while(true)
+        {
+            SWBatchFrame l_oFrame;
+
+            if(!l_oLoader.grabVideo(l_oBgr) || !l_oLoader.grabCloud(l_oFrame.m_oCloud))
+            {
+                break;
+            }
+
+            l_oFrame.m_i32Frame = l_i32FramesNb++;
+            l_oFrame.m_fTime    = l_oLoader.cloudTime(l_oFrame.m_i32Frame);
+            l_oFrame.m_oBgr     = l_oBgr.clone(); // the capture reuses its buffer
+            l_fRecordingTime    = l_oFrame.m_fTime;
+
+            l_pChunk->push_back(l_oFrame);
+
+            if(static_cast<int>(l_pChunk->size()) == l_i32ChunkSize)
+            {
+                l_oQueue.push(l_pChunk);
+                l_pChunk = SWBatchChunkPtr(new std::vector<SWBatchFrame>());
+            }
+        }
+
+        if(l_pChunk->size() > 0)
+        {
+            l_oQueue.push(l_pChunk);
+        }
+
+        l_oQueue.close();
+        l_oThreads.join_all();
+
+    if(l_i32FramesNb == 0)
+    {
+        std::cerr << "Error : no frame loaded from " << l_sKinectDataPath << std::endl;
+        return -1;
+    }
+
+    double l_dProcessingTime = (swUtil::SWProfiler::timeUs() - l_i64Start) * 0.000001;
+
+    std::cout << "Frames : " << l_i32FramesNb << ", threads : " << l_i32ThreadsNb << ", chunk size : " << l_i32ChunkSize << std::endl;
+    std::cout << "Processing time : " << l_dProcessingTime << " s (" << l_i32FramesNb / l_dProcessingTime << " frames/s)";
+    if(l_fRecordingTime > 0.f)
+    {
+        std::cout << ", recording time : " << l_fRecordingTime << " s";
+    }
+    std::cout << std::endl;
+
+    if(swUtil::SWProfiler::isEnabled())
+    {
+        swUtil::SWProfiler::instance().displayStats();
+    }
+
+    if(!saveResults(l_sResultsPath, l_oResults.results()))
+    {
+        return -1;
+    }
+
+    std::cout << "Results saved in " << l_sResultsPath << std::endl;
+
+    return 0;
+}
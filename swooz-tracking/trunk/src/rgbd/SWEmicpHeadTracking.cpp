@@ -32,10 +32,13 @@
 
 #include "rgbd/SWEmicpHeadTracking.h"
 #include "SWTrackingDevice.h"
+#include "SWTrackingMessage.h"
 #include "interface/SWConvQtOpencv.h"
 #include "cloud/SWImageProcessing.h"
 #include "moc_SWEmicpHeadTracking.cpp"
 
+#include <cstdlib>
+
 
 // OPENCV
 #include "opencvUtility.h"
@@ -50,13 +53,15 @@ using namespace swExcept;
 
 SWEmicpHeadTrackingWorker::SWEmicpHeadTrackingWorker() : m_oCaptureHeadMotion(swCloud::SWCaptureHeadMotion(20,20)),
     m_bIsRGBDDeviceInitialized(true), m_bVerbose(false), m_bDoWork(true), m_i32Fps(100), m_pCurrentFaceRect(NULL), m_pCurrentNoseRect(NULL),
-    m_pCurrentRigidMotion(NULL), m_pCurrCloud(NULL),m_pReferenceCloud(NULL), m_bWorkStopped(true)
+    m_pCurrentRigidMotion(NULL), m_pCurrCloud(NULL),m_pReferenceCloud(NULL), m_bWorkStopped(true), m_bDetectionRunning(false), m_oDetectionQueue(2)
 {        
     // set yarp port name
         std::string l_sDeviceName   = "rgbd";
         std::string l_sLibraryName  = "emicp";
         m_sHeadTrackingPortName     =  "/tracking/" + l_sDeviceName + "/"+ l_sLibraryName + "/head";
         m_oHeadTrackingPort.open(m_sHeadTrackingPortName.c_str());
+        m_sProfilePortName          = m_sHeadTrackingPortName + "/profile";
+        m_oProfilePort.open(m_sProfilePortName.c_str());
 
     // init rgbd device
         if(m_oKinectThread.init(0) == -1)
@@ -66,6 +71,9 @@ SWEmicpHeadTrackingWorker::SWEmicpHeadTrackingWorker() : m_oCaptureHeadMotion(sw
 
         if(m_bIsRGBDDeviceInitialized)
         {
+            // the head tracking only uses the bgr image and the cloud map
+            m_oKinectThread.setChannels(swDevice::KINECT_BGR_IMAGE | swDevice::KINECT_CLOUD_MAP);
+
             try
             {
                 m_oKinectThread.startListening();
@@ -97,6 +105,7 @@ SWEmicpHeadTrackingWorker::SWEmicpHeadTrackingWorker() : m_oCaptureHeadMotion(sw
 
 SWEmicpHeadTrackingWorker::~SWEmicpHeadTrackingWorker()
 {
+    stopDetection();
     m_oKinectThread.stopListening();
     deleteAndNullify(m_pReferenceCloud);
     deleteAndNullify(m_pCurrCloud);
@@ -127,50 +136,46 @@ void SWEmicpHeadTrackingWorker::doWork()
     m_bDoWork     = true;
     m_bWorkStopped= false;
 
+    swUtil::SWProfiler::instance().setThreadName("emicp head alignment");
+    int l_i32FramesNb = 0;
+    uint l_ui32LastFrameId = 0;
+
+    // start the detection stage
+        m_bDetectionRunning = true;
+        m_pDetectionThread  = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&SWEmicpHeadTrackingWorker::doDetection, this)));
 
     while(l_bContinueLoop)
     {
-        // start timer
-            clock_t l_oFirstTime = clock();
-
-        // wait (necessary to get the events)
-            QTime l_oDieTime = QTime::currentTime().addMSecs(3);
-            while( QTime::currentTime() < l_oDieTime)
-            {
-                QCoreApplication::processEvents(QEventLoop::AllEvents, 3);
-            }
+        // process the interface events (necessary to get the stop signal)
+            QCoreApplication::processEvents();
 
-        // tracking
-            cv::Mat l_oBGR   = m_oKinectThread.bgrImage();
+        // check if the loop must be stopped
+            m_oLoopMutex.lockForRead();
+                l_bContinueLoop = m_bDoWork;
+            m_oLoopMutex.unlock();
 
-            for(int ii = 0; ii < l_oBGR.rows/5; ++ii)
+        // retrieve the next detection
+            swCloud::SWHeadDetection l_oDetection;
+            if(!m_oDetectionQueue.pop(l_oDetection))
             {
-                for(int jj = 0; jj < l_oBGR.cols; ++jj)
-                {
-                    l_oBGR.at<cv::Vec3b>(ii,jj)                   = cv::Vec3b(0,0,0);
-                    l_oBGR.at<cv::Vec3b>(l_oBGR.rows - 1 - ii,jj) = cv::Vec3b(0,0,0);
-                }
+                boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+                continue;
             }
 
-            cv::Mat l_oCloud = m_oKinectThread.cloudMap();
-
-        // resize the rgb mat
-            if(m_CKinectParams.m_oOriginalSize != m_CKinectParams.m_oVideoSize)
+            if(l_oDetection.m_ui32FrameId <= l_ui32LastFrameId)
             {
-                cv::resize(l_oBGR, l_oBGR, m_CKinectParams.m_oVideoSize);
+                std::cerr << "ERROR : Emicp head tracking, detection of frame " << l_oDetection.m_ui32FrameId << " received after frame " << l_ui32LastFrameId << ", ignored. " << std::endl;
+                continue;
             }
+            l_ui32LastFrameId = l_oDetection.m_ui32FrameId;
 
-        // check if the loop must be stopped
-            m_oLoopMutex.lockForRead();
-                l_bContinueLoop = m_bDoWork;
-            m_oLoopMutex.unlock();
+            swUtil::SWScopedTimer l_oFrameTimer("head/alignment_stage");
 
         // launch head motion computing
-            cv::Mat l_oRGBDetect;
             swCloud::SWRigidMotion l_oRigidMotion;
 
             m_oParametersMutex.lockForRead();
-                int l_i32Res = m_oCaptureHeadMotion.computeHeadMotion(l_oRigidMotion, l_oBGR, l_oCloud, l_oRGBDetect);
+                int l_i32Res = m_oCaptureHeadMotion.alignHead(l_oRigidMotion, l_oDetection);
             m_oParametersMutex.unlock();
 
             if(l_i32Res == -1)
@@ -181,31 +186,35 @@ void SWEmicpHeadTrackingWorker::doWork()
             m_oCurrentRigidMotion = l_oRigidMotion;
 
         // send yarp data
-            // head bottle
-            Bottle &l_oHeadBottle = m_oHeadTrackingPort.prepare();
-            l_oHeadBottle.clear();
-
-                // device lib id
-                l_oHeadBottle.addInt(swTracking::EMICP_LIB); //head : EMICP_LIB id / get(0).asInt()
-
-                // head translation
-                l_oHeadBottle.addDouble(m_oCurrentRigidMotion.m_aFTranslation[0]); //head: Tx / get(1).asDouble()
-                l_oHeadBottle.addDouble(m_oCurrentRigidMotion.m_aFTranslation[1]); //head: Ty / get(2).asDouble()
-                l_oHeadBottle.addDouble(m_oCurrentRigidMotion.m_aFTranslation[2]); //head: Tz / get(3).asDouble()
+            // head message, the source time is the grab time of the kinect frame (the detection queue is counted in capture_to_send)
+            swTracking::SWHeadPoseMessage l_oHeadPose;
+            swTracking::initMessage(l_oHeadPose, swTracking::EMICP_LIB, l_oDetection.m_ui32FrameId,
+                                    swTracking::messageTimeUs(swUtil::SWProfiler::timeUs() - l_oDetection.m_i64CaptureTime));
 
-                // head rotation
-                l_oHeadBottle.addDouble(m_oCurrentRigidMotion.m_aFRotAngles[0]); //head: Rx / get(4).asDouble()
-                l_oHeadBottle.addDouble(m_oCurrentRigidMotion.m_aFRotAngles[1]); //head: Ry / get(5).asDouble()
-                l_oHeadBottle.addDouble(m_oCurrentRigidMotion.m_aFRotAngles[2]); //head: Rz / get(6).asDouble()
+                for(int ii = 0; ii < 3; ++ii)
+                {
+                    l_oHeadPose.m_aDTranslation[ii] = m_oCurrentRigidMotion.m_aFTranslation[ii]; // head translation
+                    l_oHeadPose.m_aDRotation[ii]    = m_oCurrentRigidMotion.m_aFRotAngles[ii];   // head rotation (degrees)
+                }
 
                 if(m_bVerbose)
                 {
-                    std::cout << "TR : " << l_oHeadBottle.get(1).asDouble() << " " << l_oHeadBottle.get(2).asDouble() << " " << l_oHeadBottle.get(3).asDouble() << std::endl;
-                    std::cout << "RO : " << l_oHeadBottle.get(3).asDouble() << " " << l_oHeadBottle.get(4).asDouble() << " " << l_oHeadBottle.get(5).asDouble() << std::endl << std::endl;
+                    std::cout << "TR : " << l_oHeadPose.m_aDTranslation[0] << " " << l_oHeadPose.m_aDTranslation[1] << " " << l_oHeadPose.m_aDTranslation[2] << std::endl;
+                    std::cout << "RO : " << l_oHeadPose.m_aDRotation[0] << " " << l_oHeadPose.m_aDRotation[1] << " " << l_oHeadPose.m_aDRotation[2] << std::endl << std::endl;
                 }
 
+            swTracking::writeMessage(m_oHeadTrackingPort.prepare(), l_oHeadPose);
             m_oHeadTrackingPort.write();
 
+            // compute total delay between the getting of the kinect data and the send of the bottle conainting the rigid motion
+                int64 l_i64SentTime = swUtil::SWProfiler::timeUs();
+                float l_fDelay = static_cast<float>(l_i64SentTime - l_oDetection.m_i64CaptureTime) * 0.000001f;
+
+                if(swUtil::SWProfiler::isEnabled())
+                {
+                    swUtil::SWProfiler::instance().record("head/end_to_end", l_oDetection.m_i64CaptureTime, l_i64SentTime);
+                }
+
             // display
             if(l_i32Res == 0)
             {
@@ -260,14 +269,111 @@ void SWEmicpHeadTrackingWorker::doWork()
                 m_pCurrentRigidMotion = new swCloud::SWRigidMotion(m_oCurrentRigidMotion);
                 emit sendRigidMotion(m_pCurrentRigidMotion);
 
-            // compute total delay between the getting of the kinect data and the send of the bottle conainting the rigid motion
-                float l_fDelay = (float)(clock() - l_oFirstTime) / CLOCKS_PER_SEC;
-
             // send the delay to be displayed in a widget
                 emit sendDelay(l_fDelay);
+
+            // send the latency statistics
+                l_oFrameTimer.stop();
+                if(swUtil::SWProfiler::isEnabled() && ++l_i32FramesNb % 30 == 0)
+                {
+                    sendProfileStats();
+                }
     }
+
+    stopDetection();
+
     m_oCaptureHeadMotion.reset();
     m_bWorkStopped = true;
+
+    // save the trace of the session if asked
+        const char *l_sTracePath = getenv("SWOOZ_PROFILER_TRACE");
+        if(swUtil::SWProfiler::isEnabled() && l_sTracePath != NULL)
+        {
+            swUtil::SWProfiler::instance().saveChromeTrace(l_sTracePath);
+        }
+}
+
+void SWEmicpHeadTrackingWorker::doDetection()
+{
+    swUtil::SWProfiler::instance().setThreadName("emicp head detection");
+
+    uint l_ui32LastFrameId = 0;
+
+    while(m_bDetectionRunning)
+    {
+        // wait for a new kinect frame
+            swDevice::SWKinectFramePtr l_pFrame = m_oKinectThread.waitFrame(l_ui32LastFrameId, 100);
+
+            if(!l_pFrame)
+            {
+                continue;
+            }
+
+            swCloud::SWHeadDetection l_oDetection;
+            l_oDetection.m_ui32FrameId    = l_pFrame->m_ui32Id;
+            l_oDetection.m_i64CaptureTime = l_pFrame->m_i64GrabTime; // the wait of the frame before its detection is part of the end to end latency
+            l_ui32LastFrameId             = l_pFrame->m_ui32Id;
+
+            swUtil::SWScopedTimer l_oTimer("head/frame_preparation");
+
+        // hide the top and the bottom of the image (the shared frame must not be modified)
+            cv::Mat l_oBGR = l_pFrame->m_oBgrImage.clone();
+            l_oBGR.rowRange(0, l_oBGR.rows/5).setTo(cv::Scalar(0,0,0));
+            l_oBGR.rowRange(l_oBGR.rows - l_oBGR.rows/5, l_oBGR.rows).setTo(cv::Scalar(0,0,0));
+
+        // resize the rgb mat
+            if(m_CKinectParams.m_oOriginalSize != m_CKinectParams.m_oVideoSize)
+            {
+                cv::resize(l_oBGR, l_oBGR, m_CKinectParams.m_oVideoSize);
+            }
+
+            l_oTimer.stop();
+
+        // detect the face and build the face cloud
+            m_oCaptureHeadMotion.detectHead(l_oBGR, l_pFrame->m_oCloudMap, l_oDetection);
+
+        // wait for the alignment stage if it is late
+            while(!m_oDetectionQueue.push(l_oDetection) && m_bDetectionRunning)
+            {
+                boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+            }
+    }
+}
+
+void SWEmicpHeadTrackingWorker::stopDetection()
+{
+    m_bDetectionRunning = false;
+
+    if(m_pDetectionThread)
+    {
+        m_pDetectionThread->join();
+        m_pDetectionThread.reset();
+    }
+
+    swCloud::SWHeadDetection l_oDetection;
+    while(m_oDetectionQueue.pop(l_oDetection))
+    {}
+}
+
+void SWEmicpHeadTrackingWorker::sendProfileStats()
+{
+    std::vector<swUtil::SWProfileStats> l_vStats;
+    swUtil::SWProfiler::instance().stats(l_vStats);
+
+    Bottle &l_oProfileBottle = m_oProfilePort.prepare();
+    l_oProfileBottle.clear();
+
+        for(uint ii = 0; ii < l_vStats.size(); ++ii)
+        {
+            Bottle &l_oStageBottle = l_oProfileBottle.addList();
+            l_oStageBottle.addString(l_vStats[ii].m_sStage.c_str()); // stage name / get(0).asString()
+            l_oStageBottle.addInt(l_vStats[ii].m_i32Count);          // number of events / get(1).asInt()
+            l_oStageBottle.addDouble(l_vStats[ii].m_dP50);           // p50 (ms) / get(2).asDouble()
+            l_oStageBottle.addDouble(l_vStats[ii].m_dP99);           // p99 (ms) / get(3).asDouble()
+            l_oStageBottle.addDouble(l_vStats[ii].m_dMean);          // mean (ms) / get(4).asDouble()
+        }
+
+    m_oProfilePort.write();
 }
 
 
@@ -282,9 +388,11 @@ void SWEmicpHeadTrackingWorker::stopWork()
 void SWEmicpHeadTrackingWorker::clean()
 {
     m_oHeadTrackingPort.interrupt();
+    m_oProfilePort.interrupt();
 
     m_oKinectThread.stopListening();
     m_oHeadTrackingPort.close();
+    m_oProfilePort.close();
 
     Network::fini();
 }
@@ -391,6 +499,8 @@ SWEmicpHeadTrackingInterface::SWEmicpHeadTrackingInterface() : m_uiMainWindow(ne
         // init kinect thread used by the display widget
             if(m_oKinectThread.init(0) != -1)
             {
+                m_oKinectThread.setChannels(swDevice::KINECT_BGR_IMAGE | swDevice::KINECT_CLOUD_MAP);
+
                 try
                 {
                     m_oKinectThread.startListening();
@@ -0,0 +1,274 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWFaceShiftReceiver.cpp
+ * \brief Defines SWFaceShiftReceiver
+ * \author Florian Lance
+ * \date 16/10/26
+ */
+
+#include "rgbd/SWFaceShiftReceiver.h"
+
+#include <iostream>
+
+#include "SWProfiler.h"
+
+#define SW_FACESHIFT_RECEPTION_BUFFER 65536 /**< size of the socket reception buffer */
+#define SW_FACESHIFT_SELECT_TIMEOUT   100   /**< maximum waiting time for data before checking the stop flag (ms) */
+
+/**
+ * \brief Exchange two tracking states, the vectors are swapped without copy.
+ */
+static void swapTrackingData(fs::fsTrackingData &oData1, fs::fsTrackingData &oData2)
+{
+    std::swap(oData1.m_timestamp,           oData2.m_timestamp);
+    std::swap(oData1.m_trackingSuccessful,  oData2.m_trackingSuccessful);
+    std::swap(oData1.m_headRotation,        oData2.m_headRotation);
+    std::swap(oData1.m_headTranslation,     oData2.m_headTranslation);
+    std::swap(oData1.m_eyeGazeLeftPitch,    oData2.m_eyeGazeLeftPitch);
+    std::swap(oData1.m_eyeGazeLeftYaw,      oData2.m_eyeGazeLeftYaw);
+    std::swap(oData1.m_eyeGazeRightPitch,   oData2.m_eyeGazeRightPitch);
+    std::swap(oData1.m_eyeGazeRightYaw,     oData2.m_eyeGazeRightYaw);
+    oData1.m_coeffs.swap(oData2.m_coeffs);
+    oData1.m_markers.swap(oData2.m_markers);
+}
+
+/**
+ * \brief Empty the blendshapes and markers of a reused tracking state, their memory is kept.
+ *
+ *  A tracking state only fills the blocks it contains, the vectors of a previous state must not be kept when a block is missing.
+ */
+static void clearTrackingVectors(fs::fsTrackingData &oData)
+{
+    oData.m_coeffs.clear();
+    oData.m_markers.clear();
+}
+
+SWFaceShiftReceiver::SWFaceShiftReceiver() : m_oSocket(INVALID_SOCKET), m_bWinsockStarted(false), m_bConnected(false), m_bStop(false),
+    m_vReceptionBuffer(SW_FACESHIFT_RECEPTION_BUFFER), m_bNewData(false), m_i64LatestTime(0), m_ui32ReceivedNb(0), m_ui32DroppedNb(0)
+{}
+
+SWFaceShiftReceiver::~SWFaceShiftReceiver()
+{
+    stop();
+}
+
+bool SWFaceShiftReceiver::start(const std::string &sHost, cint i32Port)
+{
+    stop();
+
+    WSADATA l_oWsaData;
+    if(WSAStartup(MAKEWORD(2,2), &l_oWsaData) != 0)
+    {
+        std::cerr << "-ERROR : SWFaceShiftReceiver::start, WSAStartup failed. " << std::endl;
+        return false;
+    }
+    m_bWinsockStarted = true;
+
+    if(LOBYTE(l_oWsaData.wVersion) != 2 || HIBYTE(l_oWsaData.wVersion) != 2)
+    {
+        std::cerr << "-ERROR : SWFaceShiftReceiver::start, winsock 2.2 not available. " << std::endl;
+        stop();
+        return false;
+    }
+
+    m_oSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if(m_oSocket == INVALID_SOCKET)
+    {
+        std::cerr << "-ERROR : SWFaceShiftReceiver::start, socket creation failed. " << std::endl;
+        stop();
+        return false;
+    }
+
+    struct sockaddr_in l_oService;
+    l_oService.sin_family       = AF_INET;
+    l_oService.sin_addr.s_addr  = inet_addr(sHost.c_str());
+    l_oService.sin_port         = htons(static_cast<u_short>(i32Port));
+
+    if(connect(m_oSocket, (SOCKADDR*) &l_oService, sizeof(l_oService)) == SOCKET_ERROR)
+    {
+        std::cerr << "-ERROR : SWFaceShiftReceiver::start, cannot connect to faceShift " << sHost << ":" << i32Port << std::endl;
+        stop();
+        return false;
+    }
+
+    // the reception thread never blocks in recv
+    u_long l_ui32NonBlocking = 1;
+    if(ioctlsocket(m_oSocket, FIONBIO, &l_ui32NonBlocking) == SOCKET_ERROR)
+    {
+        std::cerr << "-ERROR : SWFaceShiftReceiver::start, cannot set the socket non-blocking. " << std::endl;
+        stop();
+        return false;
+    }
+
+    m_oParser.clear();
+    m_bNewData   = false;
+    m_bStop      = false;
+    m_bConnected = true;
+    m_oThread    = boost::thread(&SWFaceShiftReceiver::receive, this);
+
+    return true;
+}
+
+void SWFaceShiftReceiver::stop()
+{
+    m_bStop = true;
+    m_oThread.join();
+
+    if(m_oSocket != INVALID_SOCKET)
+    {
+        closesocket(m_oSocket);
+        m_oSocket = INVALID_SOCKET;
+    }
+
+    if(m_bWinsockStarted)
+    {
+        WSACleanup();
+        m_bWinsockStarted = false;
+    }
+
+    m_bConnected = false;
+}
+
+bool SWFaceShiftReceiver::isConnected() const
+{
+    return m_bConnected;
+}
+
+bool SWFaceShiftReceiver::latestTrackingData(fs::fsTrackingData &oData, int64 &i64ReceptionTime)
+{
+    boost::mutex::scoped_lock l_oLock(m_oDataMutex);
+
+    if(!m_bNewData)
+    {
+        return false;
+    }
+
+    swapTrackingData(oData, m_oLatestData);
+    i64ReceptionTime = m_i64LatestTime;
+    m_bNewData = false;
+
+    return true;
+}
+
+void SWFaceShiftReceiver::counters(uint &ui32ReceivedNb, uint &ui32DroppedNb)
+{
+    boost::mutex::scoped_lock l_oLock(m_oDataMutex);
+
+    ui32ReceivedNb = m_ui32ReceivedNb;
+    ui32DroppedNb  = m_ui32DroppedNb;
+}
+
+void SWFaceShiftReceiver::publish(cint64 i64ReceptionTime)
+{
+    boost::mutex::scoped_lock l_oLock(m_oDataMutex);
+
+    // the previous latest state buffers are reused for the next decoding
+    swapTrackingData(m_oDecodedData, m_oLatestData);
+
+    if(m_bNewData)
+    {
+        ++m_ui32DroppedNb;
+    }
+
+    m_bNewData      = true;
+    m_i64LatestTime = i64ReceptionTime;
+    ++m_ui32ReceivedNb;
+}
+
+void SWFaceShiftReceiver::receive()
+{
+    while(!m_bStop)
+    {
+        // wait for data
+            fd_set l_oReadSet;
+            FD_ZERO(&l_oReadSet);
+            FD_SET(m_oSocket, &l_oReadSet);
+
+            timeval l_oTimeout;
+            l_oTimeout.tv_sec  = 0;
+            l_oTimeout.tv_usec = SW_FACESHIFT_SELECT_TIMEOUT * 1000;
+
+            int l_i32Ready = select(0, &l_oReadSet, NULL, NULL, &l_oTimeout);
+
+            if(l_i32Ready == SOCKET_ERROR)
+            {
+                std::cerr << "-ERROR : SWFaceShiftReceiver, select failed : " << WSAGetLastError() << std::endl;
+                break;
+            }
+            if(l_i32Ready == 0)
+            {
+                continue;
+            }
+
+        // read all the available data
+            bool l_bClosed = false;
+
+            while(true)
+            {
+                int l_i32Size = recv(m_oSocket, &m_vReceptionBuffer[0], static_cast<int>(m_vReceptionBuffer.size()), 0);
+
+                if(l_i32Size > 0)
+                {
+                    m_oParser.received(l_i32Size, &m_vReceptionBuffer[0]);
+                    continue;
+                }
+
+                l_bClosed = (l_i32Size == 0 || WSAGetLastError() != WSAEWOULDBLOCK);
+                break;
+            }
+
+            int64 l_i64ReceptionTime = swUtil::SWProfiler::timeUs();
+
+        // decode the tracking states
+            int l_i32Result;
+            do
+            {
+                clearTrackingVectors(m_oDecodedData);
+                l_i32Result = m_oParser.decode_tracking_state(m_oDecodedData);
+
+                if(l_i32Result == 1)
+                {
+                    publish(l_i64ReceptionTime);
+                }
+            }
+            while(l_i32Result >= 0);
+
+            if(!m_oParser.valid())
+            {
+                std::cerr << "-ERROR : parser in invalid state. " << std::endl;
+                m_oParser.clear();
+            }
+
+            if(l_bClosed)
+            {
+                std::cerr << "-ERROR : SWFaceShiftReceiver, the connection with faceShift has been closed. " << std::endl;
+                break;
+            }
+    }
+
+    m_bConnected = false;
+}
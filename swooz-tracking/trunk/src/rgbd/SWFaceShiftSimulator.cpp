@@ -0,0 +1,289 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWFaceShiftSimulator.cpp
+ * \author Florian Lance
+ * \date 16/10/26
+ * \brief Stream synthetic faceShift tracking states on a local socket, to run SWFaceShiftTracking without the faceShift application,
+ *        or to measure the latency and the throughput of SWFaceShiftReceiver with an in-process consumer.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "rgbd/SWFaceShiftReceiver.h"
+#include "SWProfiler.h"
+
+#define SW_SIMULATOR_COEFFS_NB  51  /**< number of blendshapes of the default faceShift rig */
+#define SW_SIMULATOR_MARKERS_NB 28  /**< number of default faceShift markers */
+
+/**
+ * \brief Fill a synthetic tracking state, the timestamp is the sending time.
+ * \param [in]  ui32Id  : id of the tracking state
+ * \param [out] oData   : tracking state
+ */
+static void simulateTrackingData(cuint ui32Id, fs::fsTrackingData &oData)
+{
+    float l_fT = ui32Id * 0.02f;
+
+    oData.m_timestamp           = swUtil::SWProfiler::timeUs() * 0.001;
+    oData.m_trackingSuccessful  = true;
+
+    oData.m_headTranslation.x = 5.f * sin(l_fT);
+    oData.m_headTranslation.y = 3.f * sin(l_fT * 0.7f);
+    oData.m_headTranslation.z = 600.f;
+
+    float l_fAngle = 0.3f * sin(l_fT * 0.5f);
+    oData.m_headRotation.x = 0.f;
+    oData.m_headRotation.y = sin(l_fAngle * 0.5f);
+    oData.m_headRotation.z = 0.f;
+    oData.m_headRotation.w = cos(l_fAngle * 0.5f);
+
+    oData.m_eyeGazeLeftPitch  = oData.m_eyeGazeRightPitch = 10.f * sin(l_fT * 1.3f);
+    oData.m_eyeGazeLeftYaw    = oData.m_eyeGazeRightYaw   = 15.f * sin(l_fT * 0.9f);
+
+    oData.m_coeffs.resize(SW_SIMULATOR_COEFFS_NB);
+    for(uint ii = 0; ii < oData.m_coeffs.size(); ++ii)
+    {
+        oData.m_coeffs[ii] = 0.5f + 0.5f * sin(l_fT + ii * 0.1f);
+    }
+
+    oData.m_markers.resize(SW_SIMULATOR_MARKERS_NB);
+    for(uint ii = 0; ii < oData.m_markers.size(); ++ii)
+    {
+        oData.m_markers[ii].x = ii * 2.f + sin(l_fT);
+        oData.m_markers[ii].y = ii * 1.f + cos(l_fT);
+        oData.m_markers[ii].z = 600.f;
+    }
+}
+
+/**
+ * \brief Send the tracking states to the client at a fixed rate.
+ * \param [in] oClient      : client socket
+ * \param [in] dRate        : sending rate (Hz), 0 to send as fast as possible
+ * \param [in] dDuration    : streaming duration (s)
+ * \param [out] ui32SentNb  : number of tracking states sent
+ */
+static void stream(SOCKET oClient, const double dRate, const double dDuration, uint &ui32SentNb)
+{
+    fs::fsTrackingData l_oData;
+    std::string l_sMessage;
+
+    int64 l_i64Start = swUtil::SWProfiler::timeUs();
+    int64 l_i64End   = l_i64Start + static_cast<int64>(dDuration * 1000000.);
+    ui32SentNb = 0;
+
+    while(swUtil::SWProfiler::timeUs() < l_i64End)
+    {
+        // wait for the sending time of the tracking state
+            if(dRate > 0.)
+            {
+                int64 l_i64SendingTime = l_i64Start + static_cast<int64>(ui32SentNb * 1000000. / dRate);
+                int64 l_i64Delay       = l_i64SendingTime - swUtil::SWProfiler::timeUs();
+
+                if(l_i64Delay > 0)
+                {
+                    boost::this_thread::sleep(boost::posix_time::microseconds(l_i64Delay));
+                }
+            }
+
+        // encode and send it
+            simulateTrackingData(ui32SentNb, l_oData);
+            l_sMessage.clear();
+            fs::fsBinaryStream::encode_message(l_sMessage, l_oData);
+
+            const char *l_pMessage = l_sMessage.data();
+            int l_i32Remaining     = static_cast<int>(l_sMessage.size());
+
+            while(l_i32Remaining > 0)
+            {
+                int l_i32Sent = send(oClient, l_pMessage, l_i32Remaining, 0);
+
+                if(l_i32Sent == SOCKET_ERROR)
+                {
+                    std::cerr << "-ERROR : send failed, the client has been disconnected. " << std::endl;
+                    return;
+                }
+
+                l_pMessage     += l_i32Sent;
+                l_i32Remaining -= l_i32Sent;
+            }
+
+            ++ui32SentNb;
+    }
+}
+
+/**
+ * \brief Display the mean and some percentiles of a set of values.
+ * \param [in] sName    : name of the values
+ * \param [in] vValues  : values (sorted in place)
+ */
+static void displayPercentiles(const std::string &sName, std::vector<double> &vValues)
+{
+    if(vValues.size() == 0)
+    {
+        std::cout << sName << " : no value. " << std::endl;
+        return;
+    }
+
+    std::sort(vValues.begin(), vValues.end());
+
+    double l_dMean = 0.;
+    for(uint ii = 0; ii < vValues.size(); ++ii)
+    {
+        l_dMean += vValues[ii];
+    }
+    l_dMean /= vValues.size();
+
+    std::cout << sName << " : mean " << l_dMean << " ms, p50 " << vValues[(vValues.size() - 1) / 2]
+              << " ms, p99 " << vValues[((vValues.size() - 1) * 99) / 100] << " ms, max " << vValues.back() << " ms" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help"))
+    {
+        std::cerr << "Usage : SWFaceShiftSimulator [rate (Hz, 0 : as fast as possible)] [duration (s)] [port] [consumer rate (Hz)]" << std::endl;
+        std::cerr << "        without consumer rate, waits for a client (SWFaceShiftTracking) and streams to it (default : 60 Hz, 60 s, port 33433), " << std::endl;
+        std::cerr << "        with a consumer rate, streams to an in-process SWFaceShiftReceiver read at this rate and displays the latencies. " << std::endl;
+        return -1;
+    }
+
+    double l_dRate          = argc > 1 ? std::max(0., atof(argv[1])) : 60.;
+    double l_dDuration      = argc > 2 ? atof(argv[2]) : 60.;
+    int    l_i32Port        = argc > 3 ? atoi(argv[3]) : 33433;
+    double l_dConsumerRate  = argc > 4 ? atof(argv[4]) : 0.;
+    bool   l_bBench         = l_dConsumerRate > 0.;
+
+    // init winsock and listen
+        WSADATA l_oWsaData;
+        if(WSAStartup(MAKEWORD(2,2), &l_oWsaData) != 0)
+        {
+            std::cerr << "-ERROR : WSAStartup failed. " << std::endl;
+            return -1;
+        }
+
+        SOCKET l_oListenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+        struct sockaddr_in l_oService;
+        l_oService.sin_family       = AF_INET;
+        l_oService.sin_addr.s_addr  = inet_addr("127.0.0.1");
+        l_oService.sin_port         = htons(static_cast<u_short>(l_i32Port));
+
+        if(l_oListenSocket == INVALID_SOCKET ||
+           bind(l_oListenSocket, (SOCKADDR*) &l_oService, sizeof(l_oService)) == SOCKET_ERROR ||
+           listen(l_oListenSocket, 1) == SOCKET_ERROR)
+        {
+            std::cerr << "-ERROR : cannot listen on port " << l_i32Port << std::endl;
+            closesocket(l_oListenSocket);
+            WSACleanup();
+            return -1;
+        }
+
+    // the in-process receiver connects before the accept (the connection waits in the listen backlog)
+        SWFaceShiftReceiver l_oReceiver;
+        if(l_bBench && !l_oReceiver.start("127.0.0.1", l_i32Port))
+        {
+            closesocket(l_oListenSocket);
+            WSACleanup();
+            return -1;
+        }
+
+        std::cout << "Waiting for a client on port " << l_i32Port << "..." << std::endl;
+        SOCKET l_oClientSocket = accept(l_oListenSocket, NULL, NULL);
+        closesocket(l_oListenSocket);
+
+        if(l_oClientSocket == INVALID_SOCKET)
+        {
+            std::cerr << "-ERROR : accept failed. " << std::endl;
+            WSACleanup();
+            return -1;
+        }
+
+        // the tracking states are small, they must not wait to be grouped
+        BOOL l_bNoDelay = TRUE;
+        setsockopt(l_oClientSocket, IPPROTO_TCP, TCP_NODELAY, (const char*)&l_bNoDelay, sizeof(l_bNoDelay));
+
+    std::cout << "Streaming at " << (l_dRate > 0. ? l_dRate : 0.) << " Hz (0 : as fast as possible) during " << l_dDuration << " s" << std::endl;
+
+    uint l_ui32SentNb = 0;
+    int64 l_i64Start = swUtil::SWProfiler::timeUs();
+    boost::thread l_oStreamThread(stream, l_oClientSocket, l_dRate, l_dDuration, boost::ref(l_ui32SentNb));
+
+    // in-process consumer, reads the last tracking state at its own rate like SWFaceShiftTracking::updateModule
+        std::vector<double> l_vReceptionLatencies, l_vSampleAges;
+
+        if(l_bBench)
+        {
+            fs::fsTrackingData l_oData;
+            int64 l_i64ReceptionTime;
+            uint l_ui32ReadNb = 0;
+
+            while(!l_oStreamThread.timed_join(boost::posix_time::microseconds(0)))
+            {
+                int64 l_i64ReadTime = l_i64Start + static_cast<int64>(l_ui32ReadNb++ * 1000000. / l_dConsumerRate);
+                int64 l_i64Delay    = l_i64ReadTime - swUtil::SWProfiler::timeUs();
+                if(l_i64Delay > 0)
+                {
+                    boost::this_thread::sleep(boost::posix_time::microseconds(l_i64Delay));
+                }
+
+                if(l_oReceiver.latestTrackingData(l_oData, l_i64ReceptionTime))
+                {
+                    int64 l_i64Now = swUtil::SWProfiler::timeUs();
+                    l_vReceptionLatencies.push_back(l_i64ReceptionTime * 0.001 - l_oData.m_timestamp);
+                    l_vSampleAges.push_back(l_i64Now * 0.001 - l_oData.m_timestamp);
+                }
+            }
+        }
+
+    l_oStreamThread.join();
+    double l_dElapsed = (swUtil::SWProfiler::timeUs() - l_i64Start) * 0.000001;
+
+    std::cout << "Tracking states sent : " << l_ui32SentNb << " (" << l_ui32SentNb / l_dElapsed << " per second)" << std::endl;
+
+    if(l_bBench)
+    {
+        // let the receiver decode the last states
+        boost::this_thread::sleep(boost::posix_time::milliseconds(200));
+
+        uint l_ui32ReceivedNb, l_ui32DroppedNb;
+        l_oReceiver.counters(l_ui32ReceivedNb, l_ui32DroppedNb);
+        l_oReceiver.stop();
+
+        std::cout << "Tracking states received : " << l_ui32ReceivedNb << ", read : " << l_vSampleAges.size()
+                  << ", replaced before being read : " << l_ui32DroppedNb << std::endl;
+        displayPercentiles("Sending to reception     ", l_vReceptionLatencies);
+        displayPercentiles("Sending to consumer read ", l_vSampleAges);
+    }
+
+    closesocket(l_oClientSocket);
+    WSACleanup();
+
+    return 0;
+}
@@ -32,18 +32,16 @@
 
 #include "rgbd/SWFaceShiftTracking.h"
 #include "SWTrackingDevice.h"
+#include "SWTrackingMessage.h"
 
 #include "commonTypes.h"
+#include "SWProfiler.h"
 
 using namespace yarp::os;
 using namespace yarp::dev;
 using namespace yarp::sig;
 
-#define DEFAULT_BUFLEN 1024
-
-char recvbuf[DEFAULT_BUFLEN];
-
-SWFaceShiftTracking::SWFaceShiftTracking() : m_i32Fps(30)
+SWFaceShiftTracking::SWFaceShiftTracking() : m_i32Fps(30), m_ui32MessageId(0)
 {
     std::string l_sDeviceName  = "rgbd";
     std::string l_sLibraryName = "faceshift";
@@ -77,8 +75,15 @@ bool SWFaceShiftTracking::isFaceShiftInitialized() const
 bool SWFaceShiftTracking::close()
 {
     // clean faceShift
-    closesocket(ConnectSocket);
-    WSACleanup();
+    m_oReceiver.stop();
+
+    if(swUtil::SWProfiler::isEnabled())
+    {
+        uint l_ui32ReceivedNb, l_ui32DroppedNb;
+        m_oReceiver.counters(l_ui32ReceivedNb, l_ui32DroppedNb);
+        std::cout << "faceShift tracking states received : " << l_ui32ReceivedNb << ", replaced before being sent : " << l_ui32DroppedNb << std::endl;
+        swUtil::SWProfiler::instance().displayStats();
+    }
 
     // close yarp port
     m_oHeadTrackingPort.close();
@@ -102,57 +107,7 @@ bool SWFaceShiftTracking::configure(ResourceFinder &oRf)
 
 void SWFaceShiftTracking::initFaceShift()
 {
-    int err = 0;
-    recvbuflen = DEFAULT_BUFLEN;
-
-    WSADATA wsaData;
-    WORD wVersionRequested;
-    struct sockaddr_in clientService;
-    ConnectSocket = INVALID_SOCKET;
-
-    wVersionRequested = MAKEWORD(2,2);
-    err = WSAStartup(wVersionRequested, &wsaData);
-
-    m_bIsFaceShiftInitialized = true;
-
-    if (err != 0)
-    {
-        m_bIsFaceShiftInitialized = false;
-    }
-
-    if(LOBYTE(wsaData.wVersion) != 2 || HIBYTE(wsaData.wVersion) != 2)
-    {
-        WSACleanup();
-        m_bIsFaceShiftInitialized = false;
-    }
-
-    // Create a SOCKET for connecting to server
-    ConnectSocket = socket(AF_INET,SOCK_STREAM,IPPROTO_TCP);
-    if (ConnectSocket == INVALID_SOCKET)
-    {
-        WSACleanup();
-        m_bIsFaceShiftInitialized = false;
-    }
-
-    // The sockaddr_in structure specifies the address family,
-    // IP address, and port of the server to be connected to.
-    clientService.sin_family = AF_INET;
-    clientService.sin_addr.s_addr = inet_addr( "127.0.0.1" );
-    clientService.sin_port = htons( 33433 );
-
-    iResult = connect( ConnectSocket, (SOCKADDR*) &clientService, sizeof(clientService));
-    if ( iResult == SOCKET_ERROR)
-    {
-        closesocket (ConnectSocket);
-        WSACleanup();
-        m_bIsFaceShiftInitialized = false;
-    }
-
-    if (ConnectSocket == INVALID_SOCKET)
-    {
-        closesocket(ConnectSocket);
-        WSACleanup();
-    }
+    m_bIsFaceShiftInitialized = m_oReceiver.start("127.0.0.1", 33433);
 }
 
 double SWFaceShiftTracking::getPeriod()
@@ -173,83 +128,70 @@ bool SWFaceShiftTracking::updateModule()
         return false;
     }
 
-    bool l_bTrackingSuccessful = false;
-    fs::fsTrackingData data;
-
-    //  grab faceShift data
+    //  retrieve the last faceShift tracking state
+    int64 l_i64ReceptionTime;
+    if(!m_oReceiver.latestTrackingData(m_oTrackingData, l_i64ReceptionTime))
     {
-        iResult = recv(ConnectSocket, recvbuf, recvbuflen, 0);
-
-        if ( iResult > 0 )
-        {
-            parserIn.received(iResult, recvbuf);
-            while(msg=parserIn.get_message())
-            {
-                if(dynamic_cast<fs::fsMsgTrackingState*>(msg.get()))
-                {
-                    fs::fsMsgTrackingState *ts = dynamic_cast<fs::fsMsgTrackingState*>(msg.get());
-                    fs::fsTrackingData &dataTracking = ts->tracking_data();
-                    l_bTrackingSuccessful = dataTracking.m_trackingSuccessful;
-
-                    data = dataTracking;
-                }
-            }
-        }
-        if(!parserIn.valid())
+        if(!m_oReceiver.isConnected())
         {
-            std::cerr << "-ERROR : parser in invalid state. " << std::endl;
-            parserIn.clear();
+            std::cerr << "-ERROR : connection with faceShift lost. " << std::endl;
+            return false;
         }
+
+        return true;
     }
 
+    const fs::fsTrackingData &data = m_oTrackingData;
+    bool l_bTrackingSuccessful = data.m_trackingSuccessful;
+
     if(l_bTrackingSuccessful)
     {
-        // head bottle
-        Bottle &l_oHeadBottle = m_oHeadTrackingPort.prepare();
-        l_oHeadBottle.clear();
+        // the capture time of the tracking state is unknown, its reception time is used
+        int64 l_i64SourceTime = swTracking::messageTimeUs(swUtil::SWProfiler::timeUs() - l_i64ReceptionTime);
+        ++m_ui32MessageId;
 
-            // device lib id
-            l_oHeadBottle.addInt(swTracking::FACESHIFT_LIB); //head : FACESHIFT_LIB id / get(0).asInt()
+        // head message
+        swTracking::SWHeadPoseMessage l_oHeadPose;
+        swTracking::initMessage(l_oHeadPose, swTracking::FACESHIFT_LIB, m_ui32MessageId, l_i64SourceTime);
 
             // head translation
-            l_oHeadBottle.addDouble(data.m_headTranslation.x); //head: Tx / get(1).asDouble()
-            l_oHeadBottle.addDouble(data.m_headTranslation.y); //head: Ty / get(2).asDouble()
-            l_oHeadBottle.addDouble(data.m_headTranslation.z); //head: Tz / get(3).asDouble()
+            l_oHeadPose.m_aDTranslation[0] = data.m_headTranslation.x;
+            l_oHeadPose.m_aDTranslation[1] = data.m_headTranslation.y;
+            l_oHeadPose.m_aDTranslation[2] = data.m_headTranslation.z;
 
-            // head rotation
-            l_oHeadBottle.addDouble(data.m_headRotation.x); //head: Rx / get(4).asDouble()
-            l_oHeadBottle.addDouble(data.m_headRotation.y); //head: Ry / get(5).asDouble()
-            l_oHeadBottle.addDouble(data.m_headRotation.z); //head: Rz / get(6).asDouble()
+            // head rotation (quaternion x y z)
+            l_oHeadPose.m_aDRotation[0] = data.m_headRotation.x;
+            l_oHeadPose.m_aDRotation[1] = data.m_headRotation.y;
+            l_oHeadPose.m_aDRotation[2] = data.m_headRotation.z;
 
+        swTracking::writeMessage(m_oHeadTrackingPort.prepare(), l_oHeadPose);
         m_oHeadTrackingPort.write();
 
 
-        // gaze bottle
-        Bottle &l_oGazeBottle = m_oGazeTrackingPort.prepare();
-        l_oGazeBottle.clear();
-
-            // device lib id
-            l_oGazeBottle.addInt(swTracking::FACESHIFT_LIB); //gaze : FACESHIFT_LIB id / get(0).asInt()
+        // gaze message
+        swTracking::SWGazeMessage l_oGaze;
+        swTracking::initMessage(l_oGaze, swTracking::FACESHIFT_LIB, m_ui32MessageId, l_i64SourceTime);
 
             // left eye
-            l_oGazeBottle.addDouble(data.m_eyeGazeLeftPitch);    //gaze : left pitch / get(1).asDouble()
-            l_oGazeBottle.addDouble(data.m_eyeGazeLeftYaw);      //gaze : left yaw   / get(2).asDouble()
+            l_oGaze.m_dLeftPitch  = data.m_eyeGazeLeftPitch;
+            l_oGaze.m_dLeftYaw    = data.m_eyeGazeLeftYaw;
 
             // right eye
-            l_oGazeBottle.addDouble(data.m_eyeGazeRightPitch);   //gaze : right pitch / get(3).asDouble()
-            l_oGazeBottle.addDouble(data.m_eyeGazeRightYaw);     //gaze : right yaw / get(4).asDouble()
+            l_oGaze.m_dRightPitch = data.m_eyeGazeRightPitch;
+            l_oGaze.m_dRightYaw   = data.m_eyeGazeRightYaw;
 
-		l_oGazeBottle.addDouble(data.m_coeffs[0]); // blink left
-		l_oGazeBottle.addDouble(data.m_coeffs[1]); // blink right
-	     
-        m_oGazeTrackingPort.write();
+            // blink
+            l_oGaze.m_dLeftBlink  = data.m_coeffs.size() > 1 ? data.m_coeffs[0] : -1.;
+            l_oGaze.m_dRightBlink = data.m_coeffs.size() > 1 ? data.m_coeffs[1] : -1.;
 
+        swTracking::writeMessage(m_oGazeTrackingPort.prepare(), l_oGaze);
+        m_oGazeTrackingPort.write();
 
-        Bottle &l_oFaceBottle = m_oFaceTrackingPort.prepare();
-        l_oFaceBottle.clear();
 
-            // device lib id
-            l_oFaceBottle.addInt(swTracking::FACESHIFT_LIB); // face : FACESHIT_LIB id / get(0).asInt()
+        // face message
+        swTracking::SWFaceLandmarksMessage l_oFace;
+        swTracking::initMessage(l_oFace, swTracking::FACESHIFT_LIB, m_ui32MessageId, l_i64SourceTime);
+        swTracking::setLandmarksNumber(l_oFace, static_cast<uint>(data.m_markers.size()));
 
             // default faceshift markers
 //           0 brow_left_center
@@ -280,13 +222,14 @@ bool SWFaceShiftTracking::updateModule()
 //           25 mouth_up_right_2
 //           26 nose_tip
 //           27 chin
-            for(uint ii = 0; ii < data.m_markers.size(); ++ii)
+            for(uint ii = 0; ii < swTracking::landmarksNumber(l_oFace); ++ii)
             {
-                l_oFaceBottle.addDouble(data.m_markers[ii].x); // face : marker ii x / get(1 + x * 3).asDouble()
-                l_oFaceBottle.addDouble(data.m_markers[ii].y); // face : marker ii y / get(2 + x * 3).asDouble()
-                l_oFaceBottle.addDouble(data.m_markers[ii].z); // face : marker ii z / get(3 + x * 3).asDouble()
+                l_oFace.m_aDLandmarks[ii][0] = data.m_markers[ii].x;
+                l_oFace.m_aDLandmarks[ii][1] = data.m_markers[ii].y;
+                l_oFace.m_aDLandmarks[ii][2] = data.m_markers[ii].z;
             }
 
+        swTracking::writeMessage(m_oFaceTrackingPort.prepare(), l_oFace);
         m_oFaceTrackingPort.write();
 	    
 	    
@@ -303,6 +246,11 @@ bool SWFaceShiftTracking::updateModule()
 
         m_oCoeffsTrackingPort.write();
 
+        // age of the tracking state when sent
+        if(swUtil::SWProfiler::isEnabled())
+        {
+            swUtil::SWProfiler::instance().record("faceshift/reception_to_send", l_i64ReceptionTime, swUtil::SWProfiler::timeUs());
+        }
     }
 
     return true;
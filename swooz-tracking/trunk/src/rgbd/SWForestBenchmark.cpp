@@ -0,0 +1,168 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWForestBenchmark.cpp
+ * \author Florian Lance
+ * \date 16/10/26
+ * \brief Replay kinect data saved with SWSaveKinectData through the head pose forest, compare the sequential
+ *        and the flattened/parallel voting and display the estimation frame rate of each one.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <time.h>
+
+#include "rgbd/forest/CRForestEstimator.h"
+#include "devices/rgbd/SWLoadKinectData.h"
+
+/**
+ * \brief Convert a kinect cloud map (meters, y up) to the 3D image used by the forest (millimeters, y down).
+ * \param [in] oCloud  : cloud map (cv::Vec3f)
+ * \param [in] i32MaxZ : maximum depth in millimeters
+ * \param [out] oIm3D  : 3D image
+ */
+static void cloudTo3DImage(const cv::Mat &oCloud, cint i32MaxZ, cv::Mat &oIm3D)
+{
+    oIm3D.create(oCloud.rows, oCloud.cols, CV_32FC3);
+
+    for(int ii = 0; ii < oCloud.rows; ++ii)
+    {
+        const cv::Vec3f *l_pCloudRow = oCloud.ptr<cv::Vec3f>(ii);
+        cv::Vec3f *l_pIm3DRow        = oIm3D.ptr<cv::Vec3f>(ii);
+
+        for(int jj = 0; jj < oCloud.cols; ++jj)
+        {
+            float l_fZ = l_pCloudRow[jj][2] * 1000.f;
+
+            if(l_fZ > 0.f && l_fZ < i32MaxZ)
+            {
+                l_pIm3DRow[jj] = cv::Vec3f(l_pCloudRow[jj][0] * 1000.f, -l_pCloudRow[jj][1] * 1000.f, l_fZ);
+            }
+            else
+            {
+                l_pIm3DRow[jj] = cv::Vec3f(0.f,0.f,0.f);
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 4)
+    {
+        std::cerr << "Usage : SWForestBenchmark trees_path trees_number kinect_data_path [stride] [max depth (mm)] " << std::endl;
+        return -1;
+    }
+
+    int l_i32TreesNb = atoi(argv[2]);
+    int l_i32Stride  = 5;
+    int l_i32MaxZ    = 2000;
+
+    if(argc > 4)
+    {
+        l_i32Stride = std::max(1, atoi(argv[4]));
+    }
+    if(argc > 5)
+    {
+        l_i32MaxZ = atoi(argv[5]);
+    }
+
+    CRForestEstimator l_oEstimator;
+    if(!l_oEstimator.loadForest(argv[1], l_i32TreesNb))
+    {
+        std::cerr << "Error : cannot load the forest. " << std::endl;
+        return -1;
+    }
+
+    swDevice::SWLoadKinectData l_oLoader(argv[3]);
+    l_oLoader.start();
+
+    int l_i32FramesNb = 0, l_i32VotesDiff = 0, l_i32HeadsDiff = 0;
+    float l_fMaxMeanDiff = 0.f;
+    double l_dSequentialTime = 0.0, l_dFlatTime = 0.0;
+
+    cv::Mat l_oCloud, l_oIm3D;
+    while(l_oLoader.grabCloud(l_oCloud))
+    {
+        cloudTo3DImage(l_oCloud, l_i32MaxZ, l_oIm3D);
+
+        std::vector< cv::Vec<float,POSE_SIZE> > l_vSequentialMeans, l_vFlatMeans;
+        std::vector< std::vector< Vote > > l_vSequentialClusters, l_vFlatClusters;
+        std::vector< Vote > l_vSequentialVotes, l_vFlatVotes;
+
+        l_oEstimator.setFlatForest(false);
+        clock_t l_oTime = clock();
+        l_oEstimator.estimate(l_oIm3D, l_vSequentialMeans, l_vSequentialClusters, l_vSequentialVotes, l_i32Stride);
+        l_dSequentialTime += static_cast<double>(clock() - l_oTime) / CLOCKS_PER_SEC;
+
+        l_oEstimator.setFlatForest(true);
+        l_oTime = clock();
+        l_oEstimator.estimate(l_oIm3D, l_vFlatMeans, l_vFlatClusters, l_vFlatVotes, l_i32Stride);
+        l_dFlatTime += static_cast<double>(clock() - l_oTime) / CLOCKS_PER_SEC;
+
+        // the votes are produced in the same order, so the heads must be the same
+        if(l_vSequentialVotes.size() != l_vFlatVotes.size())
+        {
+            ++l_i32VotesDiff;
+        }
+
+        if(l_vSequentialMeans.size() != l_vFlatMeans.size())
+        {
+            ++l_i32HeadsDiff;
+        }
+        else
+        {
+            for(uint ii = 0; ii < l_vFlatMeans.size(); ++ii)
+            {
+                for(int jj = 0; jj < POSE_SIZE; ++jj)
+                {
+                    l_fMaxMeanDiff = std::max(l_fMaxMeanDiff, std::fabs(l_vSequentialMeans[ii][jj] - l_vFlatMeans[ii][jj]));
+                }
+            }
+        }
+
+        ++l_i32FramesNb;
+    }
+
+    l_oLoader.stop();
+
+    if(l_i32FramesNb == 0)
+    {
+        std::cerr << "Error : no frame loaded from " << argv[3] << std::endl;
+        return -1;
+    }
+
+    std::cout << "Frames : " << l_i32FramesNb << " stride : " << l_i32Stride << std::endl;
+    std::cout << "Sequential voting : " << 1000.0 * l_dSequentialTime / l_i32FramesNb << " ms (" << l_i32FramesNb / l_dSequentialTime << " Hz)" << std::endl;
+    std::cout << "Flat voting       : " << 1000.0 * l_dFlatTime / l_i32FramesNb << " ms (" << l_i32FramesNb / l_dFlatTime << " Hz)" << std::endl;
+    std::cout << "Frames with a different votes number : " << l_i32VotesDiff << std::endl;
+    std::cout << "Frames with a different heads number : " << l_i32HeadsDiff << std::endl;
+    std::cout << "Max head pose difference : " << l_fMaxMeanDiff << std::endl;
+
+    return (l_i32VotesDiff == 0 && l_i32HeadsDiff == 0) ? 0 : 1;
+}
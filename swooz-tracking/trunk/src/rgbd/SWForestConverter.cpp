@@ -0,0 +1,125 @@
+/*******************************************************************************
+**                                                                            **
+**  SWoOz is a software platform written in C++ used for behavioral           **
+**  experiments based on interactions between people and robots               **
+**  or 3D avatars.                                                            **
+**                                                                            **
+**  This program is free software: you can redistribute it and/or modify      **
+**  it under the terms of the GNU Lesser General Public License as published  **
+**  by the Free Software Foundation, either version 3 of the License, or      **
+**  (at your option) any later version.                                       **
+**                                                                            **
+**  This program is distributed in the hope that it will be useful,           **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of            **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             **
+**  GNU Lesser General Public License for more details.                       **
+**                                                                            **
+**  You should have received a copy of the GNU Lesser General Public License  **
+**  along with Foobar.  If not, see <http://www.gnu.org/licenses/>.           **
+**                                                                            **
+** *****************************************************************************
+**          Authors: Guillaume Gibert, Florian Lance                          **
+**  Website/Contact: http://swooz.free.fr/                                    **
+**       Repository: https://github.com/GuillaumeGibert/swooz                 **
+********************************************************************************/
+
+/**
+ * \file SWForestConverter.cpp
+ * \author Florian Lance
+ * \date 16/10/26
+ * \brief Convert the binary trees of a head pose forest (tree000.bin, tree001.bin, ...) in a single packed file
+ *        which is mapped in place by CRForestEstimator::loadForest.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <time.h>
+
+#include "rgbd/forest/CRForest.h"
+
+/**
+ * \brief Check that the trees of the two forests have the same tables and leafs.
+ * \param [in] oForest1 : first forest
+ * \param [in] oForest2 : second forest
+ * \return true if the forests are the same
+ */
+static bool compareForests(const CRForest &oForest1, const CRForest &oForest2)
+{
+    if(oForest1.getSize() != oForest2.getSize())
+    {
+        return false;
+    }
+
+    for(int ii = 0; ii < oForest1.getSize(); ++ii)
+    {
+        PackedTreeHeader l_oHeader1, l_oHeader2;
+        oForest1.vTrees[ii]->packedHeader(l_oHeader1);
+        oForest2.vTrees[ii]->packedHeader(l_oHeader2);
+
+        if(memcmp(&l_oHeader1, &l_oHeader2, sizeof(PackedTreeHeader)) != 0 ||
+           memcmp(oForest1.vTrees[ii]->getTreeTable(), oForest2.vTrees[ii]->getTreeTable(), l_oHeader1.num_nodes * TEST_DIM * sizeof(int)) != 0 ||
+           memcmp(oForest1.vTrees[ii]->getLeafs(), oForest2.vTrees[ii]->getLeafs(), l_oHeader1.num_leaf * sizeof(LeafNode)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 3)
+    {
+        std::cerr << "Usage : SWForestConverter trees_path trees_number [output file] " << std::endl;
+        std::cerr << "        by default the output file is trees_path" << PACKED_FOREST_EXTENSION << ", the file used by SWTrackingHeadForest. " << std::endl;
+        return -1;
+    }
+
+    int l_i32TreesNb = atoi(argv[2]);
+    std::string l_sOutput = std::string(argv[1]) + PACKED_FOREST_EXTENSION;
+    if(argc > 3)
+    {
+        l_sOutput = argv[3];
+    }
+
+    // load the binary trees
+    clock_t l_oTime = clock();
+    CRForest l_oForest(l_i32TreesNb);
+    if(!l_oForest.loadForest(argv[1]))
+    {
+        std::cerr << "Error : cannot load the trees " << argv[1] << std::endl;
+        return -1;
+    }
+    float l_fBinTime = static_cast<float>(clock() - l_oTime) / CLOCKS_PER_SEC;
+
+    // write the packed file
+    if(!l_oForest.savePackedForest(l_sOutput.c_str()))
+    {
+        return -1;
+    }
+
+    // map it and check the content
+    l_oTime = clock();
+    CRForest l_oPackedForest(l_i32TreesNb);
+    if(!l_oPackedForest.loadPackedForest(l_sOutput.c_str(), argv[1]))
+    {
+        std::cerr << "Error : cannot map the packed forest " << l_sOutput << std::endl;
+        return -1;
+    }
+    float l_fPackedTime = static_cast<float>(clock() - l_oTime) / CLOCKS_PER_SEC;
+
+    if(!compareForests(l_oForest, l_oPackedForest))
+    {
+        std::cerr << "Error : the packed forest differs from the binary trees. " << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed forest written : " << l_sOutput << std::endl;
+    std::cout << "Binary trees loading time  : " << l_fBinTime << " s" << std::endl;
+    std::cout << "Packed forest mapping time : " << l_fPackedTime << " s" << std::endl;
+
+    return 0;
+}
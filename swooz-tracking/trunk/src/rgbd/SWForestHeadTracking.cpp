@@ -25,6 +25,7 @@
 
 #include "rgbd/SWForestHeadTracking.h"
 #include "SWTrackingDevice.h"
+#include "SWTrackingMessage.h"
 
 
 /*
@@ -85,6 +86,7 @@ std::string configfileName;
 // yarp ports & bottle
 std::string headTrackingPortName;
 yarp::os::BufferedPort<yarp::os::Bottle> headTrackingPort;
+unsigned int g_messageId = 0;
 
 // Path to trees
 string g_treepath;
@@ -351,6 +353,7 @@ bool read_data( ){
 bool process() {
 
     read_data( );
+    int64 sourceTime = swTracking::messageTimeUs();
 
     g_means.clear();
     g_votes.clear();
@@ -376,12 +379,14 @@ bool process() {
         return true;
     }
 
-    Bottle &target=headTrackingPort.prepare();
-        target.clear();
-        target.addInt(swTracking::FOREST_LIB); // device lib id
-        target.addDouble(g_means[0][3]);
-        target.addDouble(g_means[0][4]);
-        target.addDouble(g_means[0][5]);
+    swTracking::SWHeadPoseMessage headPose;
+    swTracking::initMessage(headPose, swTracking::FOREST_LIB, ++g_messageId, sourceTime);
+        for(int i = 0; i < 3; ++i)
+        {
+            headPose.m_aDTranslation[i] = g_means[0][i];    // head center (mm)
+            headPose.m_aDRotation[i]    = g_means[0][3 + i]; // pitch yaw roll (degrees)
+        }
+    swTracking::writeMessage(headTrackingPort.prepare(), headPose);
     headTrackingPort.write();
 
     return true;
@@ -200,7 +200,7 @@ bool SWOpenNITracking::updateModule()
 	yarp::os::Bottle &l_iCubEncodersBottle = m_oiCubEncodersTrackingPort.prepare();
         l_iCubEncodersBottle.clear();
 	//head
-	std::vector<double> l_vPointNeck(3), l_vPointHead(3), l_vPointTorso(3), l_vPointLShoulder(3), l_vPointRShoulder(3), l_vPointLElbow(3), l_vPointRElbow(3), l_vPointLHand(3), l_vPointRHand(3);
+	swUtil::Vec3d l_vPointNeck, l_vPointHead, l_vPointTorso, l_vPointLShoulder, l_vPointRShoulder, l_vPointLElbow, l_vPointRElbow, l_vPointLHand, l_vPointRHand;
 		l_vPointNeck[0] = l_pointNeck.X;
 		l_vPointNeck[1] = l_pointNeck.Y;
 		l_vPointNeck[2] = l_pointNeck.Z;
@@ -214,9 +214,9 @@ bool SWOpenNITracking::updateModule()
 		l_vPointRShoulder[1] = l_pointRShoulder.Y;
 		l_vPointRShoulder[2] = l_pointRShoulder.Z;
 
-		std::vector<double> l_vecClavicles  = swUtil::vec(l_vPointLShoulder,	l_vPointRShoulder);
-		std::vector<double> l_vecHead       = swUtil::vec(l_vPointNeck,		l_vPointHead);
-		std::vector<double> l_rpyHead = swUtil::computeRollPitchYaw(l_vecHead, l_vecClavicles);
+		swUtil::Vec3d l_vecClavicles  = swUtil::vec(l_vPointLShoulder,	l_vPointRShoulder);
+		swUtil::Vec3d l_vecHead       = swUtil::vec(l_vPointNeck,		l_vPointHead);
+		swUtil::Vec3d l_rpyHead = swUtil::computeRollPitchYaw(l_vecHead, l_vecClavicles);
 		
 	l_iCubEncodersBottle.addDouble(-l_rpyHead[1]);
 	l_iCubEncodersBottle.addDouble(-l_rpyHead[0]);
@@ -230,21 +230,21 @@ bool SWOpenNITracking::updateModule()
 	l_vPointTorso[0] = l_pointTorso.X;
 	l_vPointTorso[1] = l_pointTorso.Y;
         l_vPointTorso[2] = l_pointTorso.Z;
-	std::vector<double> l_vecTorso      = swUtil::vec(l_vPointTorso, l_vPointNeck);
-	std::vector<double> l_rpyTorso      = swUtil::computeRollPitchYaw(l_vecTorso, l_vecClavicles);
+	swUtil::Vec3d l_vecTorso      = swUtil::vec(l_vPointTorso, l_vPointNeck);
+	swUtil::Vec3d l_rpyTorso      = swUtil::computeRollPitchYaw(l_vecTorso, l_vecClavicles);
 	
 	 l_vTorsoJoints[0] = -l_rpyTorso[2];
 	l_vTorsoJoints[1] = l_rpyTorso[0];
 	//~ l_vTorsoJoints[2] = l_rpyTorso[1];
 			
-	std::vector<double> l_pointXaxis(3), l_pointYaxis(3), l_pointZaxis(3), l_pointOrigin(3);
+	swUtil::Vec3d l_pointXaxis, l_pointYaxis, l_pointZaxis, l_pointOrigin;
 	l_pointOrigin[0] = 0.0; l_pointOrigin[1] = 0.0; l_pointOrigin[2] = 0.0; 
 	l_pointXaxis[0] = 1.0; l_pointXaxis[1] = 0.0; l_pointXaxis[2] = 0.0; 
 	l_pointYaxis[0] = 0.0; l_pointYaxis[1] = 1.0; l_pointYaxis[2] = 0.0; 
 	l_pointZaxis[0] = 0.0; l_pointZaxis[1] = 0.0; l_pointZaxis[2] = 1.0; 
-	std::vector<double> l_vecXAxis  = swUtil::vec(l_pointOrigin, l_pointXaxis);
-	std::vector<double> l_vecYAxis  = swUtil::vec(l_pointOrigin, l_pointYaxis);
-	std::vector<double> l_vecZAxis  = swUtil::vec(l_pointOrigin, l_pointZaxis);
+	swUtil::Vec3d l_vecXAxis  = swUtil::vec(l_pointOrigin, l_pointXaxis);
+	swUtil::Vec3d l_vecYAxis  = swUtil::vec(l_pointOrigin, l_pointYaxis);
+	swUtil::Vec3d l_vecZAxis  = swUtil::vec(l_pointOrigin, l_pointZaxis);
 				
 	if (l_vecClavicles[2]>0)
 	{
@@ -284,17 +284,17 @@ bool SWOpenNITracking::updateModule()
 	l_vPointLHand[2] = l_pointLHand.Z;
 	
 	l_vecTorso      = swUtil::vec(l_vPointNeck, l_vPointTorso);
-	std::vector<double> l_vecLForearm = swUtil::vec(l_vPointLElbow, l_vPointLHand);
-	std::vector<double> l_vecLShoulder = swUtil::vec(l_vPointLShoulder, l_vPointNeck);
-	std::vector<double> l_vecLArm = swUtil::vec( l_vPointLShoulder, l_vPointLElbow);
+	swUtil::Vec3d l_vecLForearm = swUtil::vec(l_vPointLElbow, l_vPointLHand);
+	swUtil::Vec3d l_vecLShoulder = swUtil::vec(l_vPointLShoulder, l_vPointNeck);
+	swUtil::Vec3d l_vecLArm = swUtil::vec( l_vPointLShoulder, l_vPointLElbow);
 
-	std::vector<double> l_rpyLShoulder = swUtil::computeRollPitchYaw(l_vecLArm, l_vecTorso);
-	std::vector<double> l_rpyLElbow = swUtil::computeRollPitchYaw(l_vecLForearm, l_vecLArm);
-	std::vector<double> l_vecLArm_roll(3);
+	swUtil::Vec3d l_rpyLShoulder = swUtil::computeRollPitchYaw(l_vecLArm, l_vecTorso);
+	swUtil::Vec3d l_rpyLElbow = swUtil::computeRollPitchYaw(l_vecLForearm, l_vecLArm);
+	swUtil::Vec3d l_vecLArm_roll;
 	l_vecLArm_roll[0] = 0; l_vecLArm_roll[1] = l_vecLArm[1]; l_vecLArm_roll[2] = l_vecLArm[2]; 
 	l_vLArmJoints[0] = -swUtil::vectorAngle(l_vecTorso, l_vecLArm_roll);
 	
-	std::vector<double> l_vecLArm_pitch(3);
+	swUtil::Vec3d l_vecLArm_pitch;
 	l_vecLArm_pitch[0] =  l_vecLArm[0]; l_vecLArm_pitch[1] = l_vecLArm[1]; l_vecLArm_pitch[2] = 0; 
 	l_vLArmJoints[1] = swUtil::vectorAngle(l_vecTorso, l_vecLArm_pitch);
 	
@@ -317,17 +317,17 @@ bool SWOpenNITracking::updateModule()
 	l_vPointRHand[2] = l_pointRHand.Z;
 	
 	l_vecTorso      = swUtil::vec(l_vPointNeck, l_vPointTorso);
-	std::vector<double> l_vecRForearm = swUtil::vec(l_vPointRElbow, l_vPointRHand);
-	std::vector<double> l_vecRShoulder = swUtil::vec(l_vPointRShoulder, l_vPointNeck);
-	std::vector<double> l_vecRArm = swUtil::vec( l_vPointRShoulder, l_vPointRElbow);
+	swUtil::Vec3d l_vecRForearm = swUtil::vec(l_vPointRElbow, l_vPointRHand);
+	swUtil::Vec3d l_vecRShoulder = swUtil::vec(l_vPointRShoulder, l_vPointNeck);
+	swUtil::Vec3d l_vecRArm = swUtil::vec( l_vPointRShoulder, l_vPointRElbow);
 
-	std::vector<double> l_rpyRShoulder = swUtil::computeRollPitchYaw(l_vecRArm, l_vecTorso);
-	std::vector<double> l_rpyRElbow = swUtil::computeRollPitchYaw(l_vecRForearm, l_vecRArm);
-	std::vector<double> l_vecRArm_roll(3);
+	swUtil::Vec3d l_rpyRShoulder = swUtil::computeRollPitchYaw(l_vecRArm, l_vecTorso);
+	swUtil::Vec3d l_rpyRElbow = swUtil::computeRollPitchYaw(l_vecRForearm, l_vecRArm);
+	swUtil::Vec3d l_vecRArm_roll;
 	l_vecRArm_roll[0] = 0; l_vecRArm_roll[1] = l_vecRArm[1]; l_vecRArm_roll[2] = l_vecRArm[2]; 
 	l_vRArmJoints[0] = -swUtil::vectorAngle(l_vecTorso, l_vecRArm_roll);
 	
-	std::vector<double> l_vecRArm_pitch(3);
+	swUtil::Vec3d l_vecRArm_pitch;
 	l_vecRArm_pitch[0] =  l_vecRArm[0]; l_vecRArm_pitch[1] = l_vecRArm[1]; l_vecRArm_pitch[2] = 0; 
 	l_vRArmJoints[1] = swUtil::vectorAngle(l_vecTorso, l_vecRArm_pitch);
 	
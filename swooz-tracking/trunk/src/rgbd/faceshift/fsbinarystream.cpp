@@ -353,6 +353,53 @@ fsMsgPtr fsBinaryStream::get_message() {
     return fsMsgPtr();
 }
 
+int fsBinaryStream::decode_tracking_state(fsTrackingData &data) {
+    if( !m_valid ) return -1;
+    BlockHeader super_block;
+    if( !headerAvailable(super_block, m_buffer, m_start, m_end) ) return -1;
+    if (!is_valid_msg(super_block.id)) { LOG_RELEASE_ERROR("Invalid superblock id"); m_valid = false; return -1; }
+    if( !blockAvailable(              m_buffer, m_start, m_end) ) return -1;
+    skipHeader(m_start);
+    long super_block_data_start = m_start;
+    int result = 0;
+    if( super_block.id != fsMsg::MSG_OUT_TRACKING_STATE ) {
+        m_start += super_block.size; // skip the message
+    } else {
+        BlockHeader sub_block;
+        uint16_t num_blocks = 0;
+        if( !read_pod(num_blocks, m_buffer, m_start) ) { LOG_RELEASE_ERROR("Could not read num_blocks"); m_valid = false; return -1; }
+        for(int i = 0; i < num_blocks; i++) {
+            if( !headerAvailable(sub_block, m_buffer, m_start, m_end) ) { LOG_RELEASE_ERROR("could not read sub-header %d", i); m_valid = false; return -1; }
+            if( !blockAvailable(            m_buffer, m_start, m_end) ) { LOG_RELEASE_ERROR("could not read sub-block %d",  i); m_valid = false; return -1; }
+            skipHeader(m_start);
+            long sub_block_data_start = m_start;
+            bool success = true;
+            switch(sub_block.id) {
+            case BLOCKID_INFO:        success &= decodeInfo(       data, m_buffer, m_start); break;
+            case BLOCKID_POSE:        success &= decodePose(       data, m_buffer, m_start); break;
+            case BLOCKID_BLENDSHAPES: success &= decodeBlendshapes(data, m_buffer, m_start); break;
+            case BLOCKID_EYES:        success &= decodeEyeGaze(    data, m_buffer, m_start); break;
+            case BLOCKID_MARKERS:     success &= decodeMarkers(    data, m_buffer, m_start); break;
+            default:
+                LOG_RELEASE_ERROR("Unexpected subblock id %d", sub_block.id);
+                m_valid = false; return -1;
+            }
+            if(!success || uint64_t(m_start-sub_block_data_start) != sub_block.size) {
+                LOG_RELEASE_ERROR("Could not decode subblock with id %d", sub_block.id);
+                m_valid = false; return -1;
+            }
+        }
+        if( uint64_t(m_start-super_block_data_start) != super_block.size ) {
+            LOG_RELEASE_ERROR("Unexpected number of bytes consumed %d instead of %d", m_start-super_block_data_start, super_block.size);
+            m_valid = false; return -1;
+        }
+        result = 1;
+    }
+    // all the received data has been consumed, the next data will be written at the beginning of the buffer
+    if( m_start == m_end ) { m_start = 0; m_end = 0; }
+    return result;
+}
+
 static void encodeInfo(std::string &buffer, const fsTrackingData & _trackingData) {
     BlockHeader header(BLOCKID_INFO, sizeof(double) + 1);
     write_pod(buffer, header);
@@ -5,6 +5,7 @@
 
 #include "rgbd/forest/CRForestEstimator.h"
 #include <vector>
+#include <string>
 #include <iostream>
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
@@ -16,6 +17,12 @@ bool CRForestEstimator::loadForest(const char* treespath, int ntrees){
 
 	// Init forest with number of trees
 	crForest = new CRForest( ntrees );
+
+	// Map the packed forest if it has been generated (see SWForestConverter) from the current trees, else load the trees one by one
+	std::string packedPath = std::string(treespath) + PACKED_FOREST_EXTENSION;
+	if( crForest->loadPackedForest( packedPath.c_str(), treespath ) )
+		return true;
+
 	// Load forest
 	if( !crForest->loadForest( treespath ) )
 		return false;
@@ -61,51 +68,16 @@ Rect CRForestEstimator::getBoundingBox(const Mat& im3D){
 
 }
 
-void CRForestEstimator::estimate( const Mat & im3D,
-								   std::vector< cv::Vec<float,6> >& means, //output
-                                   std::vector< std::vector< Vote > >& clusters, //all clusters
-                                   std::vector< Vote >& votes, //all votes
-                                   int stride,
-                                   float max_variance,
-                                   float prob_th,
-                                   float larger_radius_ratio,
-                                   float smaller_radius_ratio,
-                                   bool verbose , int threshold ){
-
-    unsigned int max_clusters = 20;
-    int max_ms_iterations = 10;
+void CRForestEstimator::sequentialVoting( const Mat* channels, const Mat& depthInt, const Mat& maskIntegral, const Rect& bbox,
+										  int stride, float max_variance, float prob_th, std::vector< Vote >& votes ){
 
 	int p_width = crForest->getPatchWidth();
 	int p_height = crForest->getPatchHeight();
 
-	//get bounding box around the data in the image
-	Rect bbox = getBoundingBox(im3D);
-
-	Mat* channels = new Mat[3];
-	split(im3D, channels);
-	
-	//vector<Mat> channels;
-	//split(im3D, channels);
-
-	int rows = im3D.rows;
-	int cols = im3D.cols;
-
-	//integral image of the depth channel
-	Mat depthInt( rows+1, cols+1, CV_64FC1);
-	integral( channels[2], depthInt );
-
 	//feature channels vector, in our case it contains only the depth integral image, but it could have other channels (e.g., greyscale)
 	std::vector< cv::Mat > featureChans;
 	featureChans.push_back(depthInt);
 
-	//mask
-    Mat mask( rows, cols, CV_32FC1); mask.setTo(0);
-	cv::threshold( channels[2], mask, 10, 1, THRESH_BINARY);
-
-	//integral image of the mask
-	Mat maskIntegral( rows+1, cols+1, CV_64FC1); maskIntegral.setTo(0);
-	integral( mask, maskIntegral );
-
 	//defines the test patch
     Rect roi = Rect(0,0,p_width,p_height);
 
@@ -116,12 +88,12 @@ void CRForestEstimator::estimate( const Mat & im3D,
     //process each patch
     for(roi.y=bbox.y; roi.y<bbox.y+bbox.height-p_height; roi.y+=stride) {
 
-    	float* rowX = channels[0].ptr<float>(roi.y + half_h);
-    	float* rowY = channels[1].ptr<float>(roi.y + half_h);
-    	float* rowZ = channels[2].ptr<float>(roi.y + half_h);
+    	const float* rowX = channels[0].ptr<float>(roi.y + half_h);
+    	const float* rowY = channels[1].ptr<float>(roi.y + half_h);
+    	const float* rowZ = channels[2].ptr<float>(roi.y + half_h);
 
-    	double* maskIntY1 = maskIntegral.ptr<double>(roi.y);
-    	double* maskIntY2 = maskIntegral.ptr<double>(roi.y + roi.height);
+    	const double* maskIntY1 = maskIntegral.ptr<double>(roi.y);
+    	const double* maskIntY2 = maskIntegral.ptr<double>(roi.y + roi.height);
 
         for(roi.x=bbox.x; roi.x<bbox.x+bbox.width-p_width; roi.x+=stride) {
 
@@ -146,14 +118,14 @@ void CRForestEstimator::estimate( const Mat & im3D,
                 Vote v;
 
                 //add the 3D location under the patch center to the vote for the head center
-                v.vote[0] = leaves[t]->mean.at<float>(0) + rowX[roi.x + half_w];
-                v.vote[1] = leaves[t]->mean.at<float>(1) + rowY[roi.x + half_w];
-                v.vote[2] = leaves[t]->mean.at<float>(2) + rowZ[roi.x + half_w];
+                v.vote[0] = leaves[t]->mean[0] + rowX[roi.x + half_w];
+                v.vote[1] = leaves[t]->mean[1] + rowY[roi.x + half_w];
+                v.vote[2] = leaves[t]->mean[2] + rowZ[roi.x + half_w];
 
                 //angles, leave as in the leaf
-                v.vote[3] = leaves[t]->mean.at<float>(3);
-                v.vote[4] = leaves[t]->mean.at<float>(4);
-                v.vote[5] = leaves[t]->mean.at<float>(5);
+                v.vote[3] = leaves[t]->mean[3];
+                v.vote[4] = leaves[t]->mean[4];
+                v.vote[5] = leaves[t]->mean[5];
 
                 v.trace = &(leaves[t]->trace);
                 v.conf = &(leaves[t]->pfg);
@@ -165,6 +137,167 @@ void CRForestEstimator::estimate( const Mat & im3D,
 
     } // end for y
 
+}
+
+void CRForestEstimator::parallelVoting( const Mat* channels, const Mat& depthInt, const Mat& maskIntegral, const Rect& bbox,
+										int stride, float max_variance, float prob_th, std::vector< Vote >& votes ){
+
+	int p_width = crForest->getPatchWidth();
+	int p_height = crForest->getPatchHeight();
+	int ntrees = crForest->getSize();
+
+	int min_no_pixels = p_width*p_height/10;
+	int half_w = p_width/2;
+	int half_h = p_height/2;
+
+	//both integral images have the same size, the offsets of the flattened trees are shared
+	int step = (int)depthInt.step1();
+	crForest->setIntegralStep(step);
+
+	const double* featureChans[1] = { depthInt.ptr<double>(0) };
+	const double* maskInt = maskIntegral.ptr<double>(0);
+
+	int nrows = 0;
+	for(int y=bbox.y; y<bbox.y+bbox.height-p_height; y+=stride)
+		++nrows;
+
+	std::vector< std::vector< Vote > > rowVotes(nrows);
+
+	#pragma omp parallel
+	{
+		std::vector<int> origins, centers, nodes;
+		std::vector<const LeafNode*> leaves;
+
+		#pragma omp for schedule(dynamic)
+		for(int r=0; r<nrows; ++r) {
+
+			int y = bbox.y + r*stride;
+
+			const float* rowX = channels[0].ptr<float>(y + half_h);
+			const float* rowY = channels[1].ptr<float>(y + half_h);
+			const float* rowZ = channels[2].ptr<float>(y + half_h);
+
+			const double* maskIntY1 = maskIntegral.ptr<double>(y);
+			const double* maskIntY2 = maskIntegral.ptr<double>(y + p_height);
+
+			//select the patches of the row
+			origins.clear();
+			centers.clear();
+
+			for(int x=bbox.x; x<bbox.x+bbox.width-p_width; x+=stride) {
+
+				//discard if the middle of the patch does not have depth data
+				if( rowZ[x + half_w] <= 0.f )
+					continue;
+
+				//discard if the patch is filled with data for less than 10%
+				if( (maskIntY1[x] + maskIntY2[x + p_width] - maskIntY1[x + p_width] - maskIntY2[x]) <= min_no_pixels )
+					continue;
+
+				origins.push_back(y*step + x);
+				centers.push_back(x + half_w);
+			}
+
+			int n = (int)origins.size();
+			if(n == 0)
+				continue;
+
+			//send all the patches of the row down the trees
+			nodes.resize(n);
+			leaves.resize(n*ntrees);
+			crForest->regressionBatch( featureChans, maskInt, &origins[0], n, &nodes[0], &leaves[0] );
+
+			std::vector< Vote >& row = rowVotes[r];
+
+			//same order than the sequential traversal : patch then tree
+			for(int p=0; p<n; ++p) {
+
+				for(int t=0; t<ntrees; ++t) {
+
+					const LeafNode* l = leaves[t*n + p];
+
+					//discard bad votes
+					if ( l->pfg < prob_th || l->trace > max_variance )
+						continue;
+
+					const float* mean = l->mean;
+
+					Vote v;
+
+					//add the 3D location under the patch center to the vote for the head center
+					v.vote[0] = mean[0] + rowX[centers[p]];
+					v.vote[1] = mean[1] + rowY[centers[p]];
+					v.vote[2] = mean[2] + rowZ[centers[p]];
+
+					//angles, leave as in the leaf
+					v.vote[3] = mean[3];
+					v.vote[4] = mean[4];
+					v.vote[5] = mean[5];
+
+					v.trace = &(l->trace);
+					v.conf = &(l->pfg);
+
+					row.push_back(v);
+				}
+			}
+
+		} // end for rows
+	}
+
+	size_t total = votes.size();
+	for(int r=0; r<nrows; ++r)
+		total += rowVotes[r].size();
+
+	votes.reserve(total);
+	for(int r=0; r<nrows; ++r)
+		votes.insert(votes.end(), rowVotes[r].begin(), rowVotes[r].end());
+
+}
+
+void CRForestEstimator::estimate( const Mat & im3D,
+								   std::vector< cv::Vec<float,6> >& means, //output
+                                   std::vector< std::vector< Vote > >& clusters, //all clusters
+                                   std::vector< Vote >& votes, //all votes
+                                   int stride,
+                                   float max_variance,
+                                   float prob_th,
+                                   float larger_radius_ratio,
+                                   float smaller_radius_ratio,
+                                   bool verbose , int threshold ){
+
+    unsigned int max_clusters = 20;
+    int max_ms_iterations = 10;
+
+	//get bounding box around the data in the image
+	Rect bbox = getBoundingBox(im3D);
+
+	Mat* channels = new Mat[3];
+	split(im3D, channels);
+	
+	//vector<Mat> channels;
+	//split(im3D, channels);
+
+	int rows = im3D.rows;
+	int cols = im3D.cols;
+
+	//integral image of the depth channel
+	Mat depthInt( rows+1, cols+1, CV_64FC1);
+	integral( channels[2], depthInt );
+
+	//mask
+    Mat mask( rows, cols, CV_32FC1); mask.setTo(0);
+	cv::threshold( channels[2], mask, 10, 1, THRESH_BINARY);
+
+	//integral image of the mask
+	Mat maskIntegral( rows+1, cols+1, CV_64FC1); maskIntegral.setTo(0);
+	integral( mask, maskIntegral );
+
+    //process each patch
+    if(flatForest)
+        parallelVoting( channels, depthInt, maskIntegral, bbox, stride, max_variance, prob_th, votes );
+    else
+        sequentialVoting( channels, depthInt, maskIntegral, bbox, stride, max_variance, prob_th, votes );
+
     if(verbose)
         cout << endl << "votes : " << votes.size() << endl;
 
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <sys/stat.h>
 #include "rgbd/forest/CRTree.h"
 
 
@@ -53,11 +54,9 @@ bool CRTree::loadTree(const char* filename) {
 	LeafNode* ptLN = &leaf[0];
     for(int l=0; l<num_leaf; ++l, ++ptLN) {
 
-		ptLN->mean.create(POSE_SIZE, 1, CV_32FC1); ptLN->mean.setTo(0);
-
 		success &= ( fread( &dummy,			sizeof(int), 1, fp) == 1);
 		success &= ( fread( &(ptLN->pfg),    sizeof(float), 1, fp) == 1);
-		success &= ( fread( ptLN->mean.data, sizeof(float), POSE_SIZE, fp) == POSE_SIZE );
+		success &= ( fread( ptLN->mean, sizeof(float), POSE_SIZE, fp) == POSE_SIZE );
 		success &= ( fread( &(ptLN->trace),    sizeof(float), 1, fp) == 1);
 
 	}
@@ -65,8 +64,74 @@ bool CRTree::loadTree(const char* filename) {
 	fclose(fp);
 	std::cout << " done " << endl;
 
+	// stored in the packed forest to detect a tree retrained after the conversion
+	success &= fileStamp(filename, binSize, binTime);
+
 	return success;
 
 }
 
+bool CRTree::mapTree(const PackedTreeHeader& header, const char* data, size_t size) {
+
+	if( header.num_nodes != (int)pow(2.0,int(header.max_depth+1))-1 ||
+		header.nodesOffset % sizeof(int) != 0 || header.leavesOffset % sizeof(float) != 0 ||
+		(size_t)header.nodesOffset + (size_t)header.num_nodes * TEST_DIM * sizeof(int) > size ||
+		(size_t)header.leavesOffset + (size_t)header.num_leaf * sizeof(LeafNode) > size ) {
+
+		cerr << "Invalid packed tree header" << endl;
+		return false;
+	}
+
+	max_depth  = header.max_depth;
+	num_nodes  = header.num_nodes;
+	num_leaf   = header.num_leaf;
+	m_pwidth   = header.pwidth;
+	m_pheight  = header.pheight;
+	m_no_chans = header.no_chans;
+
+	treetable = (int*)(data + header.nodesOffset);
+	leaf      = (LeafNode*)(data + header.leavesOffset);
+	mapped    = true;
+	binSize   = header.binSize;
+	binTime   = header.binTime;
+
+	return true;
+
+}
+
+void CRTree::packedHeader(PackedTreeHeader& header) const {
+
+	header.max_depth = max_depth;
+	header.num_nodes = num_nodes;
+	header.num_leaf  = num_leaf;
+	header.pwidth    = m_pwidth;
+	header.pheight   = m_pheight;
+	header.no_chans  = m_no_chans;
+	header.nodesOffset  = 0;
+	header.leavesOffset = 0;
+	header.binSize = binSize;
+	header.binTime = binTime;
+
+}
+
+bool CRTree::fileStamp(const char* filename, long long& size, long long& time) {
+
+	struct stat st;
+
+	if(stat(filename, &st) != 0)
+		return false;
+
+	size = (long long)st.st_size;
+	time = (long long)st.st_mtime;
+
+	return true;
+
+}
+
+void CRTree::setIntegralStep(int step) {
+
+	integralStep = step;
+
+}
+
 